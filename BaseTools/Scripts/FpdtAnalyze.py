@@ -0,0 +1,473 @@
+## @file
+# Analyze the boot performance records of the Firmware Basic Boot Performance
+# Table, as written by the "dp -o FILE" shell command.
+#
+# The table is built by DxeCorePerformanceLib from its own records and from
+# the records of PeiPerformanceLib. This tool pairs the start and end records,
+# reports the time of each phase and module, the serial critical path through
+# the dispatchers, and compares the boots of two builds.
+#
+# Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+'''
+FpdtAnalyze
+'''
+from __future__ import print_function
+
+import argparse
+import json
+import math
+import struct
+import sys
+import uuid
+
+#
+# Globals for help information
+#
+__prog__        = 'FpdtAnalyze'
+__copyright__   = 'Copyright (c) 2024, Intel Corporation. All rights reserved.'
+__description__ = 'Analyze and compare Firmware Basic Boot Performance Tables written by "dp -o".\n'
+
+#
+# Layout of BOOT_PERFORMANCE_TABLE, see MdeModulePkg/Include/Guid/FirmwarePerformance.h
+# and MdeModulePkg/Include/Guid/ExtendedFirmwarePerformance.h
+#
+FBPT_SIGNATURE      = b'FBPT'
+TABLE_HEADER        = struct.Struct ('<4sI')
+RECORD_HEADER       = struct.Struct ('<HBB')
+BASIC_BOOT_RECORD   = struct.Struct ('<HBBI5Q')
+EVENT_RECORD        = struct.Struct ('<HBBHIQ16s')
+
+FPDT_GUID_EVENT_TYPE              = 0x1010
+FPDT_DYNAMIC_STRING_EVENT_TYPE    = 0x1011
+FPDT_DUAL_GUID_STRING_EVENT_TYPE  = 0x1012
+FPDT_GUID_QWORD_EVENT_TYPE        = 0x1013
+FPDT_GUID_QWORD_STRING_EVENT_TYPE = 0x1014
+
+#
+# Progress identifiers, see MdePkg/Include/Library/PerformanceLib.h
+#
+PERF_EVENT_ID             = 0x00
+PERF_EVENTSIGNAL_START_ID = 0x10
+PERF_CROSSMODULE_START_ID = 0x50
+
+MODULE_TOKENS = {
+    0x01: 'StartImage:',
+    0x03: 'LoadImage:',
+    0x05: 'DB:Start:',
+    0x07: 'DB:Support:',
+    0x09: 'DB:Stop:',
+    }
+
+PHASE_TOKENS = ('SEC', 'PEI', 'DXE', 'BDS')
+
+class Measurement:
+    '''
+    A measurement built from a start record and its end record, or from a
+    single record. Times are in nanoseconds.
+    '''
+    def __init__ (self, Token, Guid, Name, Identifier, Start, End):
+        self.Token      = Token
+        self.Guid       = Guid
+        self.Name       = Name
+        self.Identifier = Identifier
+        self.Start      = Start
+        self.End        = End
+        self.Phase      = None
+        self.Children   = []
+
+    @property
+    def Duration (self):
+        if self.End is None or self.Start is None:
+            return 0
+        return max (self.End - self.Start, 0)
+
+    @property
+    def Key (self):
+        '''
+        Identify the measurement across boots.
+        '''
+        if self.Token == self.Name:
+            return '{Phase} {Token}'.format (Phase = self.Phase or '-', Token = self.Token)
+        return '{Phase} {Token} {Name}'.format (Phase = self.Phase or '-', Token = self.Token, Name = self.Name)
+
+    @property
+    def SelfTime (self):
+        return max (self.Duration - sum (Child.Duration for Child in self.Children), 0)
+
+def ReadGuidXref (File):
+    '''
+    Read the GUID to module name mapping of the Guid.xref file of a build.
+    '''
+    Names = {}
+    for Line in File:
+        Fields = Line.split ()
+        if len (Fields) >= 2:
+            try:
+                Names[str (uuid.UUID (Fields[0])).upper ()] = Fields[1]
+            except ValueError:
+                pass
+    return Names
+
+def IsStartId (Identifier):
+    if Identifier >= PERF_EVENTSIGNAL_START_ID:
+        return (Identifier & 0x000F) == 0
+    return (Identifier & 0x0001) != 0
+
+def ParseTable (Data):
+    '''
+    Return the basic boot record and the list of performance records of a
+    boot performance table.
+    '''
+    if len (Data) < TABLE_HEADER.size + BASIC_BOOT_RECORD.size:
+        raise ValueError ('file too small for a boot performance table')
+    Signature, Length = TABLE_HEADER.unpack_from (Data, 0)
+    if Signature != FBPT_SIGNATURE:
+        raise ValueError ('no FBPT signature')
+    Length = min (Length, len (Data))
+    Fields = BASIC_BOOT_RECORD.unpack_from (Data, TABLE_HEADER.size)
+    BasicBoot = dict (zip (
+                  ('ResetEnd', 'OsLoaderLoadImageStart', 'OsLoaderStartImageStart',
+                   'ExitBootServicesEntry', 'ExitBootServicesExit'),
+                  Fields[4:]
+                  ))
+    Records = []
+    Offset = TABLE_HEADER.size + BASIC_BOOT_RECORD.size
+    while Offset + RECORD_HEADER.size <= Length:
+        Type, RecordLength, _ = RECORD_HEADER.unpack_from (Data, Offset)
+        if RecordLength < RECORD_HEADER.size or Offset + RecordLength > Length:
+            break
+        if Type in (FPDT_GUID_EVENT_TYPE, FPDT_DYNAMIC_STRING_EVENT_TYPE, FPDT_DUAL_GUID_STRING_EVENT_TYPE,
+                    FPDT_GUID_QWORD_EVENT_TYPE, FPDT_GUID_QWORD_STRING_EVENT_TYPE) and RecordLength >= EVENT_RECORD.size:
+            _, _, _, Identifier, _, Timestamp, Guid = EVENT_RECORD.unpack_from (Data, Offset)
+            Rest = Data[Offset + EVENT_RECORD.size:Offset + RecordLength]
+            Qword = None
+            if Type == FPDT_DUAL_GUID_STRING_EVENT_TYPE:
+                Rest = Rest[16:]
+            elif Type in (FPDT_GUID_QWORD_EVENT_TYPE, FPDT_GUID_QWORD_STRING_EVENT_TYPE):
+                Qword = struct.unpack_from ('<Q', Rest)[0] if len (Rest) >= 8 else None
+                Rest = Rest[8:]
+            String = None
+            if Type in (FPDT_DYNAMIC_STRING_EVENT_TYPE, FPDT_DUAL_GUID_STRING_EVENT_TYPE, FPDT_GUID_QWORD_STRING_EVENT_TYPE):
+                String = Rest.split (b'\0')[0].decode ('ascii', 'replace')
+            Records.append ({
+              'Type':       Type,
+              'Identifier': Identifier,
+              'Timestamp':  Timestamp,
+              'Guid':       str (uuid.UUID (bytes_le = Guid)).upper (),
+              'Qword':      Qword,
+              'String':     String
+              })
+        Offset += RecordLength
+    return BasicBoot, Records
+
+def BuildMeasurements (Records, GuidNames):
+    '''
+    Pair the start and end records like the dp command does: an end record
+    closes the last open start record of the same kind, module and name.
+    '''
+    Measurements = []
+    Open = {}
+    for Record in Records:
+        Identifier = Record['Identifier']
+        Guid = Record['Guid']
+        if Identifier == PERF_EVENT_ID:
+            Family = Identifier
+        elif IsStartId (Identifier):
+            Family = Identifier
+        else:
+            Family = Identifier - 1
+        if Family in MODULE_TOKENS:
+            Token = MODULE_TOKENS[Family]
+        else:
+            Token = Record['String'] or '0x{Id:x}'.format (Id = Identifier)
+        #
+        # The module records are named by their module, the phase records by
+        # their string, and the other records by their string and module.
+        #
+        if Family == PERF_CROSSMODULE_START_ID:
+            Name = Token
+        elif Family in MODULE_TOKENS:
+            Name = GuidNames.get (Guid) or Record['String'] or Guid
+        else:
+            Name = GuidNames.get (Guid) or Guid
+        PairKey = (Family, Guid if Family != PERF_CROSSMODULE_START_ID else None, Token, Record['Qword'])
+
+        if Identifier == PERF_EVENT_ID:
+            Measurements.append (Measurement (Token, Guid, Name, Identifier, Record['Timestamp'], Record['Timestamp']))
+        elif IsStartId (Identifier):
+            Item = Measurement (Token, Guid, Name, Identifier, Record['Timestamp'], None)
+            Measurements.append (Item)
+            Open.setdefault (PairKey, []).append (Item)
+        else:
+            Pending = Open.get (PairKey)
+            if not Pending and Record['Qword'] is not None:
+                #
+                # The DB:Start: start record may have been logged without the
+                # controller handle.
+                #
+                Pending = Open.get ((Family, Guid, Token, None))
+            if Pending:
+                Item = Pending.pop ()
+                Item.End = Record['Timestamp']
+                if Record['String'] and Item.Name == Item.Guid and Family in MODULE_TOKENS:
+                    Item.Name = Record['String']
+    return [Item for Item in Measurements if Item.End is not None]
+
+def AssignPhases (Measurements):
+    '''
+    Tag each measurement with the phase it starts in, and return the phases.
+    '''
+    Phases = sorted (
+               [Item for Item in Measurements if Item.Identifier == PERF_CROSSMODULE_START_ID and Item.Token in PHASE_TOKENS],
+               key = lambda Item: Item.Start
+               )
+    for Item in Measurements:
+        for Phase in Phases:
+            if Phase.Start <= Item.Start <= Phase.End:
+                Item.Phase = Phase.Token
+    for Phase in Phases:
+        Phase.Phase = Phase.Token
+    return Phases
+
+def BuildTree (Measurements, Phases):
+    '''
+    Nest the measurements of each phase by their intervals, and return the top
+    level measurements of each phase. The dispatchers run the modules one at a
+    time on the boot processor, so the top level measurements of a phase are
+    its serial critical path, and the time between them is spent in the core.
+    '''
+    TopLevel = {}
+    for Phase in Phases:
+        Items = sorted (
+                  [Item for Item in Measurements if Item.Phase == Phase.Token and Item is not Phase and Item.Identifier != PERF_EVENT_ID],
+                  key = lambda Item: (Item.Start, -Item.End)
+                  )
+        Stack = []
+        Top = []
+        for Item in Items:
+            while Stack and Item.Start >= Stack[-1].End:
+                Stack.pop ()
+            if Stack and Item.End <= Stack[-1].End:
+                Stack[-1].Children.append (Item)
+            elif not Stack:
+                Top.append (Item)
+            else:
+                #
+                # Overlapping without nesting, such as an event signaled from
+                # a module and ending after it. Keep it out of the path.
+                #
+                continue
+            Stack.append (Item)
+        TopLevel[Phase.Token] = Top
+    return TopLevel
+
+def LoadBoot (File, GuidNames):
+    BasicBoot, Records = ParseTable (File.read ())
+    Measurements = BuildMeasurements (Records, GuidNames)
+    Phases = AssignPhases (Measurements)
+    TopLevel = BuildTree (Measurements, Phases)
+    return {
+      'Name':         File.name,
+      'BasicBoot':    BasicBoot,
+      'Measurements': Measurements,
+      'Phases':       Phases,
+      'TopLevel':     TopLevel
+      }
+
+def Ms (Nanoseconds):
+    return Nanoseconds / 1000000.0
+
+def Durations (Boot):
+    '''
+    Return the total duration of each measurement key, and of each phase and of
+    the core time between the modules of each phase.
+    '''
+    Result = {}
+    for Item in Boot['Measurements']:
+        if Item.Identifier == PERF_EVENT_ID:
+            continue
+        Result[Item.Key] = Result.get (Item.Key, 0) + Item.Duration
+    for Phase in Boot['Phases']:
+        Result['{Phase} core'.format (Phase = Phase.Token)] = CoreTime (Phase, Boot['TopLevel'][Phase.Token])
+    return Result
+
+def CoreTime (Phase, Top):
+    return max (Phase.Duration - sum (Item.Duration for Item in Top), 0)
+
+def Report (Boot, Count, Output):
+    print ('Boot performance of {Name}'.format (Name = Boot['Name']), file = Output)
+    if Boot['BasicBoot']['ResetEnd']:
+        print ('  ResetEnd                  {Time:12.3f} ms'.format (Time = Ms (Boot['BasicBoot']['ResetEnd'])), file = Output)
+    for Phase in Boot['Phases']:
+        print ('  {Phase:<25} {Time:12.3f} ms'.format (Phase = Phase.Token, Time = Ms (Phase.Duration)), file = Output)
+
+    for Phase in Boot['Phases']:
+        Top = Boot['TopLevel'][Phase.Token]
+        print ('\nCritical path of {Phase}: {Count} steps, {Core:.3f} ms in the core'.format (
+                 Phase = Phase.Token,
+                 Count = len (Top),
+                 Core = Ms (CoreTime (Phase, Top))
+                 ), file = Output)
+        for Item in sorted (Top, key = lambda Item: -Item.Duration)[:Count]:
+            Share = 100.0 * Item.Duration / Phase.Duration if Phase.Duration else 0
+            print ('  {Time:12.3f} ms {Share:5.1f}%  self {Self:10.3f} ms  {Token} {Name}'.format (
+                     Time = Ms (Item.Duration),
+                     Share = Share,
+                     Self = Ms (Item.SelfTime),
+                     Token = Item.Token,
+                     Name = Item.Name
+                     ), file = Output)
+
+    Modules = {}
+    for Item in Boot['Measurements']:
+        if Item.Token in MODULE_TOKENS.values ():
+            Entry = Modules.setdefault ((Item.Phase, Item.Name), {})
+            Entry[Item.Token] = Entry.get (Item.Token, 0) + Item.Duration
+    print ('\nModules', file = Output)
+    for (Phase, Name), Entry in sorted (Modules.items (), key = lambda Pair: -sum (Pair[1].values ()))[:Count]:
+        Details = ', '.join ('{Token} {Time:.3f}'.format (Token = Token, Time = Ms (Time)) for Token, Time in sorted (Entry.items ()))
+        print ('  {Time:12.3f} ms  {Phase:<4} {Name} ({Details})'.format (
+                 Time = Ms (sum (Entry.values ())),
+                 Phase = Phase or '-',
+                 Name = Name,
+                 Details = Details
+                 ), file = Output)
+
+def Statistics (Values):
+    Mean = sum (Values) / len (Values)
+    if len (Values) < 2:
+        return Mean, 0.0
+    Variance = sum ((Value - Mean) ** 2 for Value in Values) / (len (Values) - 1)
+    return Mean, math.sqrt (Variance)
+
+def Diff (BaseBoots, NewBoots, Args, Output):
+    '''
+    Compare the durations of the base and new boots. A key regresses when its
+    mean grows by more than both the absolute and the relative thresholds, and
+    when there are several boots on each side, when the Welch t statistic of
+    the difference exceeds the t threshold, so that the noise of the boot
+    times is not reported.
+    '''
+    BaseDurations = [Durations (Boot) for Boot in BaseBoots]
+    NewDurations = [Durations (Boot) for Boot in NewBoots]
+    Keys = set ()
+    for Item in BaseDurations + NewDurations:
+        Keys.update (Item.keys ())
+
+    Changes = []
+    for Key in Keys:
+        Base = [Item.get (Key, 0) for Item in BaseDurations]
+        New = [Item.get (Key, 0) for Item in NewDurations]
+        BaseMean, BaseDev = Statistics (Base)
+        NewMean, NewDev = Statistics (New)
+        Delta = NewMean - BaseMean
+        if abs (Delta) < Args.Absolute * 1000:
+            continue
+        if BaseMean > 0 and abs (Delta) * 100.0 < Args.Relative * BaseMean:
+            continue
+        T = None
+        if len (Base) > 1 and len (New) > 1:
+            Error = math.sqrt (BaseDev ** 2 / len (Base) + NewDev ** 2 / len (New))
+            T = abs (Delta) / Error if Error > 0 else float ('inf')
+            if T < Args.TThreshold:
+                continue
+        Changes.append ((Delta, Key, BaseMean, NewMean, T))
+
+    Regressions = 0
+    print ('{Base} base boots, {New} new boots'.format (Base = len (BaseBoots), New = len (NewBoots)), file = Output)
+    for Delta, Key, BaseMean, NewMean, T in sorted (Changes, key = lambda Change: -Change[0]):
+        if Delta > 0:
+            Regressions += 1
+        print ('  {Kind:<10} {Delta:+12.3f} ms  {Base:12.3f} -> {New:12.3f} ms{T}  {Key}'.format (
+                 Kind = 'REGRESSION' if Delta > 0 else 'improved',
+                 Delta = Ms (Delta),
+                 Base = Ms (BaseMean),
+                 New = Ms (NewMean),
+                 T = '  t={T:.1f}'.format (T = T) if T is not None else '',
+                 Key = Key
+                 ), file = Output)
+    if not Changes:
+        print ('  no significant change', file = Output)
+    return Regressions
+
+def Trace (Boot, Output):
+    '''
+    Write the measurements in the Chrome trace event JSON format.
+    '''
+    Events = []
+    for Item in Boot['Measurements']:
+        Event = {
+          'name': '{Token} {Name}'.format (Token = Item.Token, Name = Item.Name),
+          'cat':  Item.Phase or 'Other',
+          'ts':   Item.Start / 1000.0,
+          'pid':  1,
+          'tid':  0 if Item.Identifier == PERF_CROSSMODULE_START_ID else 1
+          }
+        if Item.Identifier == PERF_EVENT_ID:
+            Event.update ({'ph': 'i', 's': 'p'})
+        else:
+            Event.update ({'ph': 'X', 'dur': Item.Duration / 1000.0})
+        Events.append (Event)
+    json.dump ({'traceEvents': Events}, Output, indent = 1)
+    Output.write ('\n')
+
+if __name__ == '__main__':
+    #
+    # Create command line argument parser object
+    #
+    parser = argparse.ArgumentParser (prog = __prog__,
+                                      description = __description__ + __copyright__,
+                                      conflict_handler = 'resolve')
+    Common = argparse.ArgumentParser (add_help = False)
+    Common.add_argument ("-g", "--guid-xref", dest = 'GuidXref', type = argparse.FileType ('r'),
+                         help = "Guid.xref file of the build, to name the modules.")
+    Common.add_argument ("-o", "--output", dest = 'OutputFile', type = argparse.FileType ('w'),
+                         default = sys.stdout,
+                         help = "Output file. Default is the console.")
+    Commands = parser.add_subparsers (dest = 'Command')
+    Commands.required = True
+
+    ReportParser = Commands.add_parser ('report', parents = [Common], help = 'Report the phases, the critical path and the modules of a boot.')
+    ReportParser.add_argument ("InputFile", type = argparse.FileType ('rb'),
+                               help = "Boot performance table written by dp -o.")
+    ReportParser.add_argument ("-n", "--count", dest = 'Count', type = int, default = 20,
+                               help = "Number of lines of each section. Default is 20.")
+
+    TraceParser = Commands.add_parser ('trace', parents = [Common], help = 'Convert a boot to the Chrome trace event JSON format.')
+    TraceParser.add_argument ("InputFile", type = argparse.FileType ('rb'),
+                              help = "Boot performance table written by dp -o.")
+
+    DiffParser = Commands.add_parser ('diff', parents = [Common], help = 'Compare the boots of two builds. The exit code is 1 if a regression is found.')
+    DiffParser.add_argument ("--base", dest = 'Base', type = argparse.FileType ('rb'), nargs = '+', required = True,
+                             help = "Boot performance tables of the base build.")
+    DiffParser.add_argument ("--new", dest = 'New', type = argparse.FileType ('rb'), nargs = '+', required = True,
+                             help = "Boot performance tables of the new build.")
+    DiffParser.add_argument ("--absolute", dest = 'Absolute', type = float, default = 1000.0,
+                             help = "Smallest change reported, in microseconds. Default is 1000.")
+    DiffParser.add_argument ("--relative", dest = 'Relative', type = float, default = 5.0,
+                             help = "Smallest change reported, in percent of the base. Default is 5.")
+    DiffParser.add_argument ("--t-threshold", dest = 'TThreshold', type = float, default = 3.0,
+                             help = "Smallest Welch t statistic reported when there are several boots on each side. Default is 3.")
+
+    #
+    # Parse command line arguments
+    #
+    args = parser.parse_args ()
+
+    GuidNames = ReadGuidXref (args.GuidXref) if args.GuidXref else {}
+    try:
+        if args.Command == 'report':
+            Report (LoadBoot (args.InputFile, GuidNames), args.Count, args.OutputFile)
+        elif args.Command == 'trace':
+            Trace (LoadBoot (args.InputFile, GuidNames), args.OutputFile)
+        else:
+            BaseBoots = [LoadBoot (File, GuidNames) for File in args.Base]
+            NewBoots = [LoadBoot (File, GuidNames) for File in args.New]
+            if Diff (BaseBoots, NewBoots, args, args.OutputFile) != 0:
+                sys.exit (1)
+    except ValueError as Error:
+        print ('{Prog}: error: {Error}'.format (Prog = __prog__, Error = Error))
+        sys.exit (1)
@@ -0,0 +1,185 @@
+## @file
+# Convert the trace buffers written by the TraceBufferDump application to the
+# Chrome trace event JSON format, which is loaded by chrome://tracing and by
+# the Perfetto UI.
+#
+# Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+'''
+TraceBufferDecode
+'''
+from __future__ import print_function
+
+import argparse
+import json
+import struct
+import sys
+
+#
+# Globals for help information
+#
+__prog__        = 'TraceBufferDecode'
+__copyright__   = 'Copyright (c) 2024, Intel Corporation. All rights reserved.'
+__description__ = 'Convert the trace buffers of TraceLib to the Chrome trace event JSON format.\n'
+
+#
+# Layout of EDKII_TRACE_BUFFER and EDKII_TRACE_RECORD, see
+# MdeModulePkg/Include/Guid/TraceBuffer.h
+#
+TRACE_BUFFER_SIGNATURE = 0x42435254  # 'TRCB'
+TRACE_BUFFER_HEADER    = struct.Struct ('<8I3Q')
+TRACE_RECORD           = struct.Struct ('<QIHBBQQ')
+
+PHASE_NAMES = {1: 'PEI', 2: 'DXE', 3: 'MM'}
+
+#
+# Chrome trace event phase of each EDKII_TRACE_TYPE_*.
+#
+TYPE_PHASES = {0: 'i', 1: 'B', 2: 'E', 3: 'C'}
+
+#
+# TRACE_CATEGORY_* bits, see MdeModulePkg/Include/Library/TraceLib.h
+#
+CATEGORY_NAMES = {
+    0x00000001: 'Protocol',
+    0x00000002: 'Memory',
+    0x00000004: 'Event',
+    0x00000008: 'Image',
+    0x00000010: 'StatusCode',
+    0x00000020: 'Performance',
+    0x00000040: 'Mm',
+    }
+
+def ReadNames (File):
+    '''
+    Read the names of the events. Each line holds a category, either a name of
+    CATEGORY_NAMES or a number, the event identifier and the event name.
+    '''
+    Categories = {Name.lower (): Bit for Bit, Name in CATEGORY_NAMES.items ()}
+    Names = {}
+    for Line in File:
+        Line = Line.split ('#')[0].strip ()
+        if not Line:
+            continue
+        Fields = Line.split (None, 2)
+        if len (Fields) != 3:
+            raise ValueError ('invalid line: {Line}'.format (Line = Line))
+        Category = Categories.get (Fields[0].lower ())
+        if Category is None:
+            Category = int (Fields[0], 0)
+        Names[(Category, int (Fields[1], 0))] = Fields[2]
+    return Names
+
+def ReadTraceBuffers (Data):
+    '''
+    Split the file into its trace buffers. Return a list of (header, records)
+    tuples, the header being a dictionary.
+    '''
+    Buffers = []
+    Offset = 0
+    while Offset + TRACE_BUFFER_HEADER.size <= len (Data):
+        Fields = TRACE_BUFFER_HEADER.unpack_from (Data, Offset)
+        Header = dict (zip (
+                   ('Signature', 'HeaderSize', 'RecordSize', 'Phase', 'Capacity',
+                    'Count', 'Dropped', 'Reserved', 'Frequency', 'StartValue', 'EndValue'),
+                   Fields
+                   ))
+        if Header['Signature'] != TRACE_BUFFER_SIGNATURE or Header['RecordSize'] < TRACE_RECORD.size:
+            raise ValueError ('invalid trace buffer at offset 0x{Offset:x}'.format (Offset = Offset))
+        Offset += Header['HeaderSize']
+        Count = min (Header['Count'], Header['Capacity'])
+        if Offset + Count * Header['RecordSize'] > len (Data):
+            raise ValueError ('truncated trace buffer at offset 0x{Offset:x}'.format (Offset = Offset))
+        Records = []
+        for Index in range (Count):
+            Records.append (TRACE_RECORD.unpack_from (Data, Offset + Index * Header['RecordSize']))
+        Offset += Count * Header['RecordSize']
+        Buffers.append ((Header, Records))
+    return Buffers
+
+def Microseconds (Header, Timestamp):
+    '''
+    Convert a performance counter value to microseconds since the start value
+    of the counter. The counter may count down.
+    '''
+    if Header['Frequency'] == 0:
+        return 0
+    if Header['EndValue'] >= Header['StartValue']:
+        Ticks = Timestamp - Header['StartValue']
+    else:
+        Ticks = Header['StartValue'] - Timestamp
+    return Ticks * 1000000.0 / Header['Frequency']
+
+def ConvertTraceBuffers (Buffers, Names):
+    '''
+    Return the Chrome trace events of the records of the trace buffers.
+    '''
+    Events = []
+    for Header, Records in Buffers:
+        Pid = Header['Phase']
+        Events.append ({
+          'name': 'process_name',
+          'ph':   'M',
+          'pid':  Pid,
+          'args': {'name': PHASE_NAMES.get (Pid, 'Phase {Pid}'.format (Pid = Pid))}
+          })
+        if Header['Dropped'] != 0:
+            print (
+              '{Prog}: {Phase} trace buffer full, {Dropped} records dropped'.format (
+                Prog = __prog__,
+                Phase = PHASE_NAMES.get (Pid, Pid),
+                Dropped = Header['Dropped']
+                ),
+              file = sys.stderr
+              )
+        for Timestamp, Category, Event, Type, _, Arg0, Arg1 in sorted (Records, key = lambda Record: Record[0]):
+            CategoryName = CATEGORY_NAMES.get (Category, '0x{Category:x}'.format (Category = Category))
+            Name = Names.get ((Category, Event), '{Category}:0x{Event:x}'.format (Category = CategoryName, Event = Event))
+            TraceEvent = {
+              'name': Name,
+              'cat':  CategoryName,
+              'ph':   TYPE_PHASES.get (Type, 'i'),
+              'ts':   Microseconds (Header, Timestamp),
+              'pid':  Pid,
+              'tid':  0
+              }
+            if Type == 3:
+                TraceEvent['args'] = {Name: Arg0}
+            else:
+                TraceEvent['args'] = {'Arg0': '0x{Arg:x}'.format (Arg = Arg0), 'Arg1': '0x{Arg:x}'.format (Arg = Arg1)}
+                if Type == 0:
+                    TraceEvent['s'] = 't'
+            Events.append (TraceEvent)
+    return Events
+
+if __name__ == '__main__':
+    #
+    # Create command line argument parser object
+    #
+    parser = argparse.ArgumentParser (prog = __prog__,
+                                      description = __description__ + __copyright__,
+                                      conflict_handler = 'resolve')
+    parser.add_argument ("InputFile", type = argparse.FileType ('rb'),
+                         help = "Trace buffers written by the TraceBufferDump application.")
+    parser.add_argument ("-o", "--output", dest = 'OutputFile', type = argparse.FileType ('w'),
+                         default = sys.stdout,
+                         help = "Chrome trace event JSON file. Default is the console.")
+    parser.add_argument ("-n", "--names", dest = 'NamesFile', type = argparse.FileType ('r'),
+                         help = "File naming the events, each line holding a category, an event identifier and a name.")
+
+    #
+    # Parse command line arguments
+    #
+    args = parser.parse_args ()
+
+    try:
+        Names = ReadNames (args.NamesFile) if args.NamesFile else {}
+        Buffers = ReadTraceBuffers (args.InputFile.read ())
+    except ValueError as Error:
+        print ('{Prog}: error: {Error}'.format (Prog = __prog__, Error = Error))
+        sys.exit (1)
+
+    json.dump ({'traceEvents': ConvertTraceBuffers (Buffers, Names)}, args.OutputFile, indent = 1)
+    args.OutputFile.write ('\n')
@@ -22,11 +22,21 @@
 #include "Sdk/C/LzmaDec.h"
 #include "Sdk/C/LzmaEnc.h"
 #include "Sdk/C/Bra.h"
+#include "Sdk/C/CpuArch.h"
 #include "CommonLib.h"
 #include "ParseInf.h"
 
 #define LZMA_HEADER_SIZE (LZMA_PROPS_SIZE + 8)
 
+//
+// Layout of the LZMA chunked section payload, see LZMA_CHUNKED_HEADER and
+// LZMA_CHUNK_ENTRY in MdeModulePkg/Include/Guid/LzmaDecompress.h.
+//
+#define LZMA_CHUNKED_SIGNATURE          0x4B435A4C  // 'L', 'Z', 'C', 'K'
+#define LZMA_CHUNKED_HEADER_SIZE        16
+#define LZMA_CHUNK_ENTRY_SIZE           8
+#define LZMA_CHUNKED_DEFAULT_CHUNK_SIZE (1 << 20)
+
 typedef enum {
   NoConverter,
   X86Converter,
@@ -41,13 +51,15 @@ const char *kInvalidParamValMessage = "Invalid parameter value";
 
 static BoolInt mQuietMode = False;
 static CONVERTER_TYPE mConType = NoConverter;
+static BoolInt mChunked = False;
+static UINT64 mChunkSize = LZMA_CHUNKED_DEFAULT_CHUNK_SIZE;
 
 UINT64 mDictionarySize = 28;
 UINT64 mCompressionMode = 2;
 
 #define UTILITY_NAME "LzmaCompress"
 #define UTILITY_MAJOR_VERSION 0
-#define UTILITY_MINOR_VERSION 2
+#define UTILITY_MINOR_VERSION 3
 #define INTEL_COPYRIGHT \
   "Copyright (c) 2009-2018, Intel Corporation. All rights reserved."
 void PrintHelp(char *buffer)
@@ -60,6 +72,8 @@ void PrintHelp(char *buffer)
              "  -d: decode file\n"
              "  -o FileName, --output FileName: specify the output filename\n"
              "  --f86: enable converter for x86 code\n"
+             "  --chunked: encode/decode a table of independently compressed chunks\n"
+             "  --chunk-size Size: set the uncompressed chunk size, default: 0x100000 (1MB)\n"
              "  -v, --verbose: increase output messages\n"
              "  -q, --quiet: reduce output messages\n"
              "  --debug [0-9]: set debug level\n"
@@ -174,6 +188,91 @@ Done:
   return res;
 }
 
+static SRes EncodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize, CLzmaEncProps *props)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  size_t outPos;
+  size_t tableSize;
+  UInt32 chunkCount;
+  UInt32 index;
+
+  if (inSize == 0)
+    return SZ_ERROR_INPUT_EOF;
+
+  if (fileSize > 0xFFFFFFFF)
+    return SZ_ERROR_PARAM;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkCount = (UInt32)((inSize + mChunkSize - 1) / mChunkSize);
+  tableSize = LZMA_CHUNKED_HEADER_SIZE + (size_t)chunkCount * LZMA_CHUNK_ENTRY_SIZE;
+
+  // we allocate 105% of original size + 64KB per chunk for output buffer
+  outSize = tableSize + inSize / 20 * 21 + (size_t)chunkCount * (LZMA_HEADER_SIZE + (1 << 16));
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  SetUi32(outBuffer, LZMA_CHUNKED_SIGNATURE);
+  SetUi32(outBuffer + 4, chunkCount);
+  SetUi32(outBuffer + 8, (UInt32)mChunkSize);
+  SetUi32(outBuffer + 12, (UInt32)inSize);
+
+  //
+  // Every chunk is a complete LZMA stream, so that the firmware can decode
+  // the chunks in any order and on different processors.
+  //
+  res = SZ_OK;
+  outPos = tableSize;
+  for (index = 0; index < chunkCount; index++) {
+    size_t chunkStart = (size_t)index * (size_t)mChunkSize;
+    size_t chunkLength = inSize - chunkStart;
+    size_t outSizeProcessed = outSize - outPos - LZMA_HEADER_SIZE;
+    size_t outPropsSize = LZMA_PROPS_SIZE;
+    int i;
+
+    if (chunkLength > mChunkSize)
+      chunkLength = (size_t)mChunkSize;
+
+    for (i = 0; i < 8; i++)
+      outBuffer[outPos + LZMA_PROPS_SIZE + i] = (Byte)((UInt64)chunkLength >> (8 * i));
+
+    res = LzmaEncode(outBuffer + outPos + LZMA_HEADER_SIZE, &outSizeProcessed,
+        inBuffer + chunkStart, chunkLength,
+        props, outBuffer + outPos, &outPropsSize, 0,
+        NULL, &g_Alloc, &g_Alloc);
+
+    if (res != SZ_OK)
+      goto Done;
+
+    SetUi32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + index * LZMA_CHUNK_ENTRY_SIZE, (UInt32)outPos);
+    SetUi32(outBuffer + LZMA_CHUNKED_HEADER_SIZE + index * LZMA_CHUNK_ENTRY_SIZE + 4, (UInt32)(LZMA_HEADER_SIZE + outSizeProcessed));
+    outPos += LZMA_HEADER_SIZE + outSizeProcessed;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outPos) != outPos)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 static SRes Decode(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
 {
   SRes res;
@@ -238,6 +337,85 @@ Done:
   return res;
 }
 
+static SRes DecodeChunked(ISeqOutStream *outStream, ISeqInStream *inStream, UInt64 fileSize)
+{
+  SRes res;
+  size_t inSize = (size_t)fileSize;
+  Byte *inBuffer = 0;
+  Byte *outBuffer = 0;
+  size_t outSize;
+  UInt32 chunkCount;
+  UInt32 chunkSize;
+  UInt32 index;
+  ELzmaStatus status;
+
+  if (inSize < LZMA_CHUNKED_HEADER_SIZE)
+    return SZ_ERROR_INPUT_EOF;
+
+  inBuffer = (Byte *)MyAlloc(inSize);
+  if (inBuffer == 0)
+    return SZ_ERROR_MEM;
+
+  if (SeqInStream_Read(inStream, inBuffer, inSize) != SZ_OK) {
+    res = SZ_ERROR_READ;
+    goto Done;
+  }
+
+  chunkCount = GetUi32(inBuffer + 4);
+  chunkSize = GetUi32(inBuffer + 8);
+  outSize = GetUi32(inBuffer + 12);
+  if ((GetUi32(inBuffer) != LZMA_CHUNKED_SIGNATURE) || (chunkSize == 0) ||
+      (chunkCount != (outSize + chunkSize - 1) / chunkSize) ||
+      (chunkCount > (inSize - LZMA_CHUNKED_HEADER_SIZE) / LZMA_CHUNK_ENTRY_SIZE)) {
+    res = SZ_ERROR_DATA;
+    goto Done;
+  }
+
+  if (outSize == 0) {
+    res = SZ_OK;
+    goto Done;
+  }
+
+  outBuffer = (Byte *)MyAlloc(outSize);
+  if (outBuffer == 0) {
+    res = SZ_ERROR_MEM;
+    goto Done;
+  }
+
+  res = SZ_OK;
+  for (index = 0; index < chunkCount; index++) {
+    size_t chunkOffset = GetUi32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + index * LZMA_CHUNK_ENTRY_SIZE);
+    size_t chunkLength = GetUi32(inBuffer + LZMA_CHUNKED_HEADER_SIZE + index * LZMA_CHUNK_ENTRY_SIZE + 4);
+    size_t outStart = (size_t)index * chunkSize;
+    size_t decodedSize = outSize - outStart;
+    size_t inSizePure;
+
+    if ((chunkLength < LZMA_HEADER_SIZE) || (chunkOffset > inSize) || (chunkLength > inSize - chunkOffset)) {
+      res = SZ_ERROR_DATA;
+      goto Done;
+    }
+
+    if (decodedSize > chunkSize)
+      decodedSize = chunkSize;
+
+    inSizePure = chunkLength - LZMA_HEADER_SIZE;
+    res = LzmaDecode(outBuffer + outStart, &decodedSize, inBuffer + chunkOffset + LZMA_HEADER_SIZE, &inSizePure,
+        inBuffer + chunkOffset, LZMA_PROPS_SIZE, LZMA_FINISH_END, &status, &g_Alloc);
+
+    if (res != SZ_OK)
+      goto Done;
+  }
+
+  if (outStream->Write(outStream, outBuffer, outSize) != outSize)
+    res = SZ_ERROR_WRITE;
+
+Done:
+  MyFree(outBuffer);
+  MyFree(inBuffer);
+
+  return res;
+}
+
 int main2(int numArgs, const char *args[], char *rs)
 {
   CFileSeqInStream inStream;
@@ -272,6 +450,17 @@ int main2(int numArgs, const char *args[], char *rs)
       modeWasSet = True;
     } else if (strcmp(args[param], "--f86") == 0) {
       mConType = X86Converter;
+    } else if (strcmp(args[param], "--chunked") == 0) {
+      mChunked = True;
+    } else if (strcmp(args[param], "--chunk-size") == 0) {
+      if (numArgs < (param + 2)) {
+        return PrintUserError(rs);
+      }
+      if ((AsciiStringToUint64(args[++param], FALSE, &mChunkSize) != EFI_SUCCESS) ||
+          (mChunkSize == 0) || (mChunkSize > 0xFFFFFFFF)) {
+        return PrintError(rs, kInvalidParamValMessage);
+      }
+      mChunked = True;
     } else if (strcmp(args[param], "-o") == 0 ||
                strcmp(args[param], "--output") == 0) {
       if (numArgs < (param + 2)) {
@@ -342,6 +531,10 @@ int main2(int numArgs, const char *args[], char *rs)
     return PrintUserError(rs);
   }
 
+  if (mChunked && (mConType != NoConverter)) {
+    return PrintError(rs, "--chunked can not be combined with --f86");
+  }
+
   {
     size_t t4 = sizeof(UInt32);
     size_t t8 = sizeof(UInt64);
@@ -364,14 +557,22 @@ int main2(int numArgs, const char *args[], char *rs)
     if (!mQuietMode) {
       printf("Encoding\n");
     }
-    res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    if (mChunked) {
+      res = EncodeChunked(&outStream.vt, &inStream.vt, fileSize, &props);
+    } else {
+      res = Encode(&outStream.vt, &inStream.vt, fileSize, &props);
+    }
   }
   else
   {
     if (!mQuietMode) {
       printf("Decoding\n");
     }
-    res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    if (mChunked) {
+      res = DecodeChunked(&outStream.vt, &inStream.vt, fileSize);
+    } else {
+      res = Decode(&outStream.vt, &inStream.vt, fileSize);
+    }
   }
 
   File_Close(&outStream.file);
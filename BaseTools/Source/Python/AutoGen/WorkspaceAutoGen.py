@@ -899,6 +899,7 @@ class WorkspaceAutoGen(AutoGen):
             FdsCommandDict["quiet"] = True
 
         FdsCommandDict["GenfdsMultiThread"] = GlobalData.gEnableGenfdsMultiThread
+        FdsCommandDict["thread_number"] = GlobalData.gThreadNumber
         if GlobalData.gIgnoreSource:
             FdsCommandDict["IgnoreSources"] = True
 
@@ -119,6 +119,8 @@ gModuleAllCacheStatus = None
 gModuleCacheHit = None
 
 gEnableGenfdsMultiThread = True
+# Maximum number of concurrent threads, passed to GenFds through FdsCommandDict
+gThreadNumber = 1
 gSikpAutoGenCache = set()
 # Common lock for the file access in multiple process AutoGens
 file_lock = None
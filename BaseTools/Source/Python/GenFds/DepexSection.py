@@ -76,7 +76,8 @@ class DepexSection (DepexSectionClassObject):
 
             for Exp in ExpList:
                 if Exp.upper() not in ('AND', 'OR', 'NOT', 'TRUE', 'FALSE', 'SOR', 'BEFORE', 'AFTER', 'END'):
-                    GuidStr = self.__FindGuidValue(Exp)
+                    with GenFdsGlobalVariable.DatabaseLock:
+                        GuidStr = self.__FindGuidValue(Exp)
                     if GuidStr is None:
                         EdkLogger.error("GenFds", RESOURCE_NOT_AVAILABLE,
                                         "Depex GUID %s could not be found in build DB! (ModuleName: %s)" % (Exp, ModuleName))
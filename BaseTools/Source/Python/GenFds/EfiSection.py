@@ -91,7 +91,8 @@ class EfiSection (EfiSectionClassObject):
             elif os.path.exists(Filename):
                 FileList.append(Filename)
             elif IsMakefile:
-                SuffixMap = FfsInf.GetFinalTargetSuffixMap()
+                with GenFdsGlobalVariable.DatabaseLock:
+                    SuffixMap = FfsInf.GetFinalTargetSuffixMap()
                 if '.depex' in SuffixMap:
                     FileList.append(Filename)
         else:
@@ -19,6 +19,7 @@ from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from .Ffs import SectionSuffix,FdfFvFileTypeToFileType
 import subprocess
 import sys
+import copy
 from pathlib import Path
 from . import Section
 from . import RuleSimpleFile
@@ -449,8 +450,9 @@ class FfsInfStatement(FfsInfStatementClassObject):
         #
         if Dict is None:
             Dict = {}
-        self.__InfParse__(Dict, IsGenFfs=True)
-        Arch = self.GetCurrentArch()
+        with GenFdsGlobalVariable.DatabaseLock:
+            self.__InfParse__(Dict, IsGenFfs=True)
+            Arch = self.GetCurrentArch()
         SrcFile = mws.join( GenFdsGlobalVariable.WorkSpaceDir, self.InfFileName);
         DestFile = os.path.join( self.OutputPath, self.ModuleGuid + '.ffs')
 
@@ -493,8 +495,11 @@ class FfsInfStatement(FfsInfStatementClassObject):
         #
         # Convert Fv File Type for PI1.1 SMM driver.
         #
+        # The rule is shared by all the modules using it, convert a copy of it.
+        #
         if self.ModuleType == SUP_MODULE_DXE_SMM_DRIVER and int(self.PiSpecVersion, 16) >= 0x0001000A:
             if Rule.FvFileType == 'DRIVER':
+                Rule = copy.copy(Rule)
                 Rule.FvFileType = 'SMM'
         #
         # Framework SMM Driver has no SMM FV file type
@@ -951,6 +956,7 @@ class FfsInfStatement(FfsInfStatementClassObject):
             #
             if self.ModuleType == SUP_MODULE_DXE_SMM_DRIVER and int(self.PiSpecVersion, 16) >= 0x0001000A:
                 if Sect.SectionType == BINARY_FILE_TYPE_DXE_DEPEX:
+                    Sect = copy.copy(Sect)
                     Sect.SectionType = BINARY_FILE_TYPE_SMM_DEPEX
             #
             # Framework SMM Driver has no SMM_DEPEX section type
@@ -977,13 +983,16 @@ class FfsInfStatement(FfsInfStatementClassObject):
             if not HasGeneratedFlag:
                 UniVfrOffsetFileSection = ""
                 ModuleFileName = mws.join(GenFdsGlobalVariable.WorkSpaceDir, self.InfFileName)
-                InfData = GenFdsGlobalVariable.WorkSpace.BuildObject[PathClass(ModuleFileName), self.CurrentArch]
+                with GenFdsGlobalVariable.DatabaseLock:
+                    InfData = GenFdsGlobalVariable.WorkSpace.BuildObject[PathClass(ModuleFileName), self.CurrentArch]
+                    SourceList = InfData.Sources
+                    BuildType = InfData.BuildType
                 #
                 # Search the source list in InfData to find if there are .vfr file exist.
                 #
                 VfrUniBaseName = {}
                 VfrUniOffsetList = []
-                for SourceFile in InfData.Sources:
+                for SourceFile in SourceList:
                     if SourceFile.Type.upper() == ".VFR" :
                         #
                         # search the .map file to find the offset of vfr binary in the PE32+/TE file.
@@ -998,7 +1007,7 @@ class FfsInfStatement(FfsInfStatementClassObject):
 
                 if len(VfrUniBaseName) > 0:
                     if IsMakefile:
-                        if InfData.BuildType != 'UEFI_HII':
+                        if BuildType != 'UEFI_HII':
                             UniVfrOffsetFileName = os.path.join(self.OutputPath, self.BaseName + '.offset')
                             UniVfrOffsetFileSection = os.path.join(self.OutputPath, self.BaseName + 'Offset' + '.raw')
                             UniVfrOffsetFileNameList = []
@@ -13,8 +13,10 @@ from __future__ import absolute_import
 import Common.LongFilePathOs as os
 import subprocess
 from io import BytesIO
+from concurrent.futures import ThreadPoolExecutor
 from struct import *
 from . import FfsFileStatement
+from . import FfsInfStatement
 from .GenFdsGlobalVariable import GenFdsGlobalVariable
 from Common.Misc import SaveFileOnChange, PackGUID
 from Common.LongFilePathSupport import CopyLongFilePath
@@ -118,13 +120,15 @@ class FV (object):
                                             TAB_LINE_BREAK)
 
         # Process Modules in FfsList
+        FfsToGenList = []
         for FfsFile in self.FfsList:
             if Flag:
                 if isinstance(FfsFile, FfsFileStatement.FileStatement):
                     continue
             if GenFdsGlobalVariable.EnableGenfdsMultiThread and GenFdsGlobalVariable.ModuleFile and GenFdsGlobalVariable.ModuleFile.Path.find(os.path.normpath(FfsFile.InfFileName)) == -1:
                 continue
-            FileName = FfsFile.GenFfs(MacroDict, FvParentAddr=BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)
+            FfsToGenList.append(FfsFile)
+        for FileName in self._GenFfsFiles(FfsToGenList, MacroDict, BaseAddress, Flag):
             FfsFileList.append(FileName)
             if not Flag:
                 self.FvInfFile.append("EFI_FILE_NAME = " + \
@@ -233,6 +237,40 @@ class FV (object):
                 GenFdsGlobalVariable.ErrorLogger("Failed to generate %s FV file." %self.UiFvName)
         return FvOutputFile
 
+    ## _GenFfsFiles()
+    #
+    #   Generate the FFS files of FV. When GenFds generates the FFS files of the
+    #   modules itself, instead of make, and more than one thread is allowed, the
+    #   INF modules are generated concurrently once the FILE statements, which
+    #   may generate nested FVs and update the macros, have been generated in order.
+    #
+    #   @param  self        The object pointer
+    #   @param  FfsList     FFS statements to generate
+    #   @param  MacroDict   macro value pair
+    #   @param  BaseAddress base address of FV
+    #   @param  Flag        whether to generate the makefile commands only
+    #   @retval list        Generated FFS file paths, in the order of FfsList
+    #
+    def _GenFfsFiles(self, FfsList, MacroDict, BaseAddress, Flag):
+        FileNameList = [None] * len(FfsList)
+        ParallelList = []
+        for Index, FfsFile in enumerate(FfsList):
+            if not Flag and not GenFdsGlobalVariable.EnableGenfdsMultiThread and GenFdsGlobalVariable.ThreadNumber > 1 \
+               and isinstance(FfsFile, FfsInfStatement.FfsInfStatement):
+                ParallelList.append(Index)
+                continue
+            FileNameList[Index] = FfsFile.GenFfs(MacroDict, FvParentAddr=BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)
+
+        if len(ParallelList) == 1:
+            Index = ParallelList[0]
+            FileNameList[Index] = FfsList[Index].GenFfs(MacroDict, FvParentAddr=BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)
+        elif ParallelList:
+            with ThreadPoolExecutor(max_workers=GenFdsGlobalVariable.ThreadNumber) as Executor:
+                FutureList = [(Index, Executor.submit(FfsList[Index].GenFfs, dict(MacroDict), FvParentAddr=BaseAddress, IsMakefile=Flag, FvName=self.UiFvName)) for Index in ParallelList]
+                for Index, Future in FutureList:
+                    FileNameList[Index] = Future.result()
+        return FileNameList
+
     ## _GetBlockSize()
     #
     #   Calculate FV's block size
@@ -18,6 +18,7 @@ from glob import glob
 from struct import unpack
 from linecache import getlines
 from io import BytesIO
+from multiprocessing import cpu_count
 
 import Common.LongFilePathOs as os
 from Common.TargetTxtClassObject import TargetTxtDict,gDefaultTargetTxtFile
@@ -94,6 +95,8 @@ def resetFdsGlobalVariable():
     GenFdsGlobalVariable.CopyList   = []
     GenFdsGlobalVariable.ModuleFile = ''
     GenFdsGlobalVariable.EnableGenfdsMultiThread = True
+    GenFdsGlobalVariable.ThreadNumber = 1
+    GenFdsGlobalVariable.OutputCacheDir = ''
 
     GenFdsGlobalVariable.LargeFileInFvFlags = []
     GenFdsGlobalVariable.EFI_FIRMWARE_FILE_SYSTEM3_GUID = '5473C07A-3DCB-4dca-BD6F-1E9689E7349A'
@@ -142,6 +145,10 @@ def GenFdsApi(FdsCommandDict, WorkSpaceDataBase=None):
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = True
             else:
                 GenFdsGlobalVariable.EnableGenfdsMultiThread = False
+            if FdsCommandDict.get("thread_number") is not None:
+                GenFdsGlobalVariable.ThreadNumber = FdsCommandDict.get("thread_number")
+                if GenFdsGlobalVariable.ThreadNumber == 0:
+                    GenFdsGlobalVariable.ThreadNumber = cpu_count()
         os.chdir(GenFdsGlobalVariable.WorkSpaceDir)
 
         # set multiple workspace
@@ -407,6 +414,7 @@ def OptionsToCommandDict(Options):
     FdsCommandDict["debug"] = Options.debug
     FdsCommandDict["Workspace"] = Options.Workspace
     FdsCommandDict["GenfdsMultiThread"] = not Options.NoGenfdsMultiThread
+    FdsCommandDict["thread_number"] = Options.ThreadNumber
     FdsCommandDict["fdf_file"] = [PathClass(Options.filename)] if Options.filename else []
     FdsCommandDict["build_target"] = Options.BuildTarget
     FdsCommandDict["toolchain_tag"] = Options.ToolChain
@@ -465,6 +473,8 @@ def myOptionParser():
     Parser.add_option("--pcd", action="append", dest="OptionPcd", help="Set PCD value by command line. Format: \"PcdName=Value\" ")
     Parser.add_option("--genfds-multi-thread", action="store_true", dest="GenfdsMultiThread", default=True, help="Enable GenFds multi thread to generate ffs file.")
     Parser.add_option("--no-genfds-multi-thread", action="store_true", dest="NoGenfdsMultiThread", default=False, help="Disable GenFds multi thread to generate ffs file.")
+    Parser.add_option("-n", "--thread-number", type="int", dest="ThreadNumber", help="Build the FFS files of the modules of an FV with the specified number of threads, with --no-genfds-multi-thread. Zero means the number of processors. Default is 1.",
+                      action="callback", callback=SingleCheckCallback)
 
     Options, _ = Parser.parse_args()
     return Options
@@ -14,7 +14,11 @@ from __future__ import absolute_import
 
 import Common.LongFilePathOs as os
 import sys
+import shutil
+import hashlib
 from sys import stdout
+from os import getpid
+from threading import RLock, get_ident
 from subprocess import PIPE,Popen
 from struct import Struct
 from array import array
@@ -29,6 +33,7 @@ from AutoGen.BuildEngine import ToolBuildRule
 import Common.DataType as DataType
 from Common.Misc import PathClass,CreateDirectory
 from Common.LongFilePathSupport import OpenLongFilePath as open
+from Common.LongFilePathSupport import CopyLongFilePath
 from Common.MultipleWorkspace import MultipleWorkspace as mws
 import Common.GlobalData as GlobalData
 from Common.BuildToolError import *
@@ -74,6 +79,28 @@ class GenFdsGlobalVariable:
     ModuleFile = ''
     EnableGenfdsMultiThread = True
 
+    #
+    # Number of threads used to generate the FFS files of the modules of one FV when
+    # GenFds builds them itself, i.e. when EnableGenfdsMultiThread is False. Otherwise
+    # make builds them. The workspace database is not thread safe, so module
+    # information is parsed under DatabaseLock.
+    #
+    ThreadNumber = 1
+    DatabaseLock = RLock()
+
+    #
+    # Outputs of the compression tools listed below only depend on the tool options
+    # and on the input contents. When GenFds runs them itself, for the compressed
+    # sections of FDF FILE statements such as a compressed FV image, of binary modules,
+    # and of all the modules when EnableGenfdsMultiThread is False, their output is
+    # kept in OutputCacheDir, named by the hash of those, and reused when the same
+    # section is generated again. The least recently used outputs are removed when
+    # the cache exceeds OutputCacheSize bytes at the start of GenFds.
+    #
+    OutputCacheDir = ''
+    OutputCacheSize = 0x20000000
+    CacheableGuidTools = ('LzmaCompress', 'LzmaF86Compress', 'LzmaChunkedCompress', 'TianoCompress', 'BrotliCompress')
+
     #
     # The list whose element are flags to indicate if large FFS or SECTION files exist in FV.
     # At the beginning of each generation of FV, false flag is appended to the list,
@@ -288,6 +315,8 @@ class GenFdsGlobalVariable:
         GenFdsGlobalVariable.FfsDir = os.path.join(GenFdsGlobalVariable.FvDir, 'Ffs')
         if not os.path.exists(GenFdsGlobalVariable.FfsDir):
             os.makedirs(GenFdsGlobalVariable.FfsDir)
+        GenFdsGlobalVariable.OutputCacheDir = os.path.join(GenFdsGlobalVariable.FvDir, 'OutputCache')
+        GenFdsGlobalVariable.TrimOutputCache()
 
         #
         # Create FV Address inf file
@@ -686,6 +715,107 @@ class GenFdsGlobalVariable:
         else:
             GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to generate option rom")
 
+    ## Get the cache key of a tool invocation
+    #
+    #   The key is the hash of the tool, of its options and of the contents of
+    #   its input files, so that an unchanged input with a newer timestamp still
+    #   hits the cache.
+    #
+    #   @param  ToolPath        Path of the tool
+    #   @param  Options         Options passed to the tool, without the input and output paths
+    #   @param  Input           Path list of input files
+    #
+    #   @retval string          The cache key
+    #   @retval None            if the tool output can not be cached
+    #
+    @staticmethod
+    def GetCacheKey(ToolPath, Options, Input):
+        if not GenFdsGlobalVariable.OutputCacheDir:
+            return None
+
+        Hash = hashlib.sha256()
+        Hash.update(os.path.splitext(os.path.basename(ToolPath))[0].encode('utf-8'))
+        Hash.update('\0'.join(Options).encode('utf-8'))
+        #
+        # A rebuilt tool may produce a different output for the same input.
+        #
+        ToolFile = shutil.which(ToolPath)
+        if ToolFile:
+            Hash.update(str(os.path.getmtime(ToolFile)).encode('utf-8'))
+        for File in Input:
+            if not os.path.isfile(File):
+                return None
+            with open(File, 'rb') as Fd:
+                Hash.update(Fd.read())
+        return Hash.hexdigest()
+
+    ## Restore the output of a tool invocation from the cache
+    #
+    #   @param  Key             The cache key returned by GetCacheKey()
+    #   @param  Output          Path of the output file
+    #
+    #   @retval True            The output has been restored
+    #   @retval False           The output is not in the cache
+    #
+    @staticmethod
+    def RestoreFromCache(Key, Output):
+        if not Key:
+            return False
+        CacheFile = os.path.join(GenFdsGlobalVariable.OutputCacheDir, Key)
+        if not os.path.isfile(CacheFile):
+            return False
+        CopyLongFilePath(CacheFile, Output)
+        #
+        # The time stamp of the cache file is the last use of the entry, see TrimOutputCache().
+        #
+        os.utime(CacheFile, None)
+        GenFdsGlobalVariable.DebugLogger(EdkLogger.DEBUG_5, "%s is restored from cache %s" % (Output, Key))
+        return True
+
+    ## Save the output of a tool invocation to the cache
+    #
+    #   @param  Key             The cache key returned by GetCacheKey()
+    #   @param  Output          Path of the output file
+    #
+    @staticmethod
+    def SaveToCache(Key, Output):
+        if not Key or not os.path.isfile(Output):
+            return
+        CreateDirectory(GenFdsGlobalVariable.OutputCacheDir)
+        #
+        # Copy through a private file so that a concurrent lookup never sees a partial cache file.
+        #
+        CacheFile = os.path.join(GenFdsGlobalVariable.OutputCacheDir, Key)
+        TempFile = "%s.%d.%d.tmp" % (CacheFile, getpid(), get_ident())
+        CopyLongFilePath(Output, TempFile)
+        os.replace(TempFile, CacheFile)
+
+    ## Trim the cache to OutputCacheSize
+    #
+    #   The least recently used entries are removed first. The private files
+    #   left by an interrupted SaveToCache() are removed too.
+    #
+    @staticmethod
+    def TrimOutputCache():
+        if not os.path.isdir(GenFdsGlobalVariable.OutputCacheDir):
+            return
+        EntryList = []
+        for FileName in os.listdir(GenFdsGlobalVariable.OutputCacheDir):
+            File = os.path.join(GenFdsGlobalVariable.OutputCacheDir, FileName)
+            if not os.path.isfile(File):
+                continue
+            if FileName.endswith('.tmp'):
+                os.remove(File)
+                continue
+            EntryList.append((os.path.getmtime(File), os.path.getsize(File), File))
+
+        TotalSize = sum(Size for LastUse, Size, File in EntryList)
+        for LastUse, Size, File in sorted(EntryList):
+            if TotalSize <= GenFdsGlobalVariable.OutputCacheSize:
+                break
+            os.remove(File)
+            TotalSize -= Size
+
     @staticmethod
     def GuidTool(Output, Input, ToolPath, Options='', returnValue=[], IsMakefile=False):
         if not GenFdsGlobalVariable.NeedsUpdate(Output, Input) and not IsMakefile:
@@ -700,7 +830,14 @@ class GenFdsGlobalVariable:
             if " ".join(Cmd).strip() not in GenFdsGlobalVariable.SecCmdList:
                 GenFdsGlobalVariable.SecCmdList.append(" ".join(Cmd).strip())
         else:
+            CacheKey = None
+            if os.path.splitext(os.path.basename(ToolPath))[0] in GenFdsGlobalVariable.CacheableGuidTools:
+                CacheKey = GenFdsGlobalVariable.GetCacheKey(ToolPath, Options.split(' '), Input)
+            if GenFdsGlobalVariable.RestoreFromCache(CacheKey, Output):
+                return
             GenFdsGlobalVariable.CallExternalTool(Cmd, "Failed to call " + ToolPath, returnValue)
+            if returnValue == [] or returnValue[0] == 0:
+                GenFdsGlobalVariable.SaveToCache(CacheKey, Output)
 
     @staticmethod
     def CallExternalTool (cmd, errorMess, returnValue=[]):
@@ -812,24 +949,10 @@ class GenFdsGlobalVariable:
         TokenSpace = PcdPair[0]
         TokenCName = PcdPair[1]
 
-        for Arch in GenFdsGlobalVariable.ArchList:
-            Platform = GenFdsGlobalVariable.WorkSpace.BuildObject[GenFdsGlobalVariable.ActivePlatform, Arch, GenFdsGlobalVariable.TargetName, GenFdsGlobalVariable.ToolChainTag]
-            PcdDict = Platform.Pcds
-            for Key in PcdDict:
-                PcdObj = PcdDict[Key]
-                if (PcdObj.TokenCName == TokenCName) and (PcdObj.TokenSpaceGuidCName == TokenSpace):
-                    if PcdObj.Type != DataType.TAB_PCDS_FIXED_AT_BUILD:
-                        EdkLogger.error("GenFds", GENFDS_ERROR, "%s is not FixedAtBuild type." % PcdPattern)
-                    if PcdObj.DatumType != DataType.TAB_VOID:
-                        EdkLogger.error("GenFds", GENFDS_ERROR, "%s is not VOID* datum type." % PcdPattern)
-
-                    return PcdObj.DefaultValue
-
-            for Package in GenFdsGlobalVariable.WorkSpace.GetPackageList(GenFdsGlobalVariable.ActivePlatform,
-                                                                         Arch,
-                                                                         GenFdsGlobalVariable.TargetName,
-                                                                         GenFdsGlobalVariable.ToolChainTag):
-                PcdDict = Package.Pcds
+        with GenFdsGlobalVariable.DatabaseLock:
+            for Arch in GenFdsGlobalVariable.ArchList:
+                Platform = GenFdsGlobalVariable.WorkSpace.BuildObject[GenFdsGlobalVariable.ActivePlatform, Arch, GenFdsGlobalVariable.TargetName, GenFdsGlobalVariable.ToolChainTag]
+                PcdDict = Platform.Pcds
                 for Key in PcdDict:
                     PcdObj = PcdDict[Key]
                     if (PcdObj.TokenCName == TokenCName) and (PcdObj.TokenSpaceGuidCName == TokenSpace):
@@ -840,6 +963,21 @@ class GenFdsGlobalVariable:
 
                         return PcdObj.DefaultValue
 
+                for Package in GenFdsGlobalVariable.WorkSpace.GetPackageList(GenFdsGlobalVariable.ActivePlatform,
+                                                                             Arch,
+                                                                             GenFdsGlobalVariable.TargetName,
+                                                                             GenFdsGlobalVariable.ToolChainTag):
+                    PcdDict = Package.Pcds
+                    for Key in PcdDict:
+                        PcdObj = PcdDict[Key]
+                        if (PcdObj.TokenCName == TokenCName) and (PcdObj.TokenSpaceGuidCName == TokenSpace):
+                            if PcdObj.Type != DataType.TAB_PCDS_FIXED_AT_BUILD:
+                                EdkLogger.error("GenFds", GENFDS_ERROR, "%s is not FixedAtBuild type." % PcdPattern)
+                            if PcdObj.DatumType != DataType.TAB_VOID:
+                                EdkLogger.error("GenFds", GENFDS_ERROR, "%s is not VOID* datum type." % PcdPattern)
+
+                            return PcdObj.DefaultValue
+
         return ''
 
 ## FindExtendTool()
@@ -955,8 +1093,9 @@ def FindExtendTool(KeyStringList, CurrentArchList, NameGuid):
             KeyStringBuildTarget, KeyStringToolChain, KeyStringArch = KeyString.split('_')
             if KeyStringArch != Arch:
                 continue
-            Platform = GenFdsGlobalVariable.WorkSpace.BuildObject[GenFdsGlobalVariable.ActivePlatform, Arch, KeyStringBuildTarget, KeyStringToolChain]
-            for Item in Platform.BuildOptions:
+            with GenFdsGlobalVariable.DatabaseLock:
+                BuildOptions = GenFdsGlobalVariable.WorkSpace.BuildObject[GenFdsGlobalVariable.ActivePlatform, Arch, KeyStringBuildTarget, KeyStringToolChain].BuildOptions
+            for Item in BuildOptions:
                 if len(Item[1].split('_')) < 5:
                     continue
                 ItemTarget, ItemToolChain, ItemArch, ItemTool, ItemAttr = Item[1].split('_')
@@ -975,7 +1114,7 @@ def FindExtendTool(KeyStringList, CurrentArchList, NameGuid):
                 if ItemAttr != DataType.TAB_GUID:
                     # Not GUID attribute match
                     continue
-                if Platform.BuildOptions[Item].lower() != NameGuid.lower():
+                if BuildOptions[Item].lower() != NameGuid.lower():
                     # No GUID value match
                     continue
                 if MatchItem:
@@ -989,7 +1128,7 @@ def FindExtendTool(KeyStringList, CurrentArchList, NameGuid):
             if not MatchItem:
                 continue
             ToolName = MatchItem[1].split('_')[3]
-            for Item in Platform.BuildOptions:
+            for Item in BuildOptions:
                 if len(Item[1].split('_')) < 5:
                     continue
                 ItemTarget, ItemToolChain, ItemArch, ItemTool, ItemAttr = Item[1].split('_')
@@ -1020,8 +1159,8 @@ def FindExtendTool(KeyStringList, CurrentArchList, NameGuid):
                     else:
                         MatchOptionsItem = Item
     if MatchPathItem:
-        ToolPathTmp = Platform.BuildOptions[MatchPathItem]
+        ToolPathTmp = BuildOptions[MatchPathItem]
     if MatchOptionsItem:
-        ToolOption = Platform.BuildOptions[MatchOptionsItem]
+        ToolOption = BuildOptions[MatchOptionsItem]
     GenFdsGlobalVariable.GuidToolDefinition[NameGuid] = (ToolPathTmp, ToolOption)
     return ToolPathTmp, ToolOption
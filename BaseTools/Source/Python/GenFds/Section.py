@@ -127,7 +127,8 @@ class Section (SectionClassObject):
                                                  and FileType == 'DXE_DPEX' and File.Type == BINARY_FILE_TYPE_SMM_DEPEX) \
                                                  or (FileType == BINARY_FILE_TYPE_TE and File.Type == BINARY_FILE_TYPE_PE32):
                         if TAB_STAR in FfsInf.TargetOverrideList or File.Target == TAB_STAR or File.Target in FfsInf.TargetOverrideList or FfsInf.TargetOverrideList == []:
-                            FileList.append(FfsInf.PatchEfiFile(File.Path, File.Type))
+                            with GenFdsGlobalVariable.DatabaseLock:
+                                FileList.append(FfsInf.PatchEfiFile(File.Path, File.Type))
                         else:
                             GenFdsGlobalVariable.InfLogger ("\nBuild Target \'%s\' of File %s is not in the Scope of %s specified by INF %s in FDF" %(File.Target, File.File, FfsInf.TargetOverrideList, FfsInf.InfFileName))
                     else:
@@ -142,7 +143,8 @@ class Section (SectionClassObject):
 
         if (not IsMakefile and Suffix is not None and os.path.exists(FfsInf.EfiOutputPath)) or (IsMakefile and Suffix is not None):
             if not FileList:
-                SuffixMap = FfsInf.GetFinalTargetSuffixMap()
+                with GenFdsGlobalVariable.DatabaseLock:
+                    SuffixMap = FfsInf.GetFinalTargetSuffixMap()
                 if Suffix in SuffixMap:
                     FileList.extend(SuffixMap[Suffix])
 
@@ -0,0 +1,155 @@
+## @file
+# This file is used to keep the parsed INF and DEC files across build invocations
+#
+# Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+from __future__ import absolute_import
+import Common.LongFilePathOs as os
+import pickle
+from hashlib import md5
+from os import getpid
+from threading import get_ident
+
+import Common.EdkLogger as EdkLogger
+import Common.GlobalData as GlobalData
+from Common.LongFilePathSupport import OpenLongFilePath as open
+from CommonDataClass.DataClass import MODEL_FILE_INF, MODEL_FILE_DEC
+
+## MetaFileCache
+#
+#   The raw records of INF and DEC files only depend on the file content: the
+#   macros they use are defined in the file itself, and the build options,
+#   macros and PCDs of the platform are only applied when the records are
+#   queried. The records are therefore saved to disk, indexed by the file path
+#   and validated with the hash of the file content, so that the next build
+#   does not parse the unchanged files again.
+#
+#   The parser also rejects the macros defined by a file that are global
+#   macros, such as WORKSPACE or TARGET, which may be defined differently by
+#   the next build. The names of the macros defined by a file are therefore
+#   saved with its records, and the file is parsed again, so that the error
+#   is reported, if one of them is a global macro of the current build.
+#
+#   The cache is tagged with the hash of the parser sources, so that a
+#   BaseTools update drops the records produced by the old parser.
+#
+class MetaFileCache(object):
+    _FILE_TYPE_ = (MODEL_FILE_INF, MODEL_FILE_DEC)
+
+    def __init__(self):
+        self.CachePath = None
+        self.Version = None
+        self.Records = {}       # FilePath : (Digest, [Record], [MacroName])
+        self.Modified = False
+
+    ## Load the cache file
+    #
+    #   @param  CachePath   Path of the cache file
+    #
+    def Load(self, CachePath):
+        self.CachePath = CachePath
+        self.Version = self._GetParserVersion()
+        self.Records = {}
+        self.Modified = False
+        if not os.path.isfile(CachePath):
+            return
+        try:
+            with open(CachePath, 'rb') as File:
+                Version, Records = pickle.load(File)
+        except Exception as Exc:
+            EdkLogger.debug(EdkLogger.DEBUG_5, "Failed to load %s: %s" % (CachePath, str(Exc)))
+            return
+        if Version == self.Version:
+            self.Records = Records
+
+    ## Save the cache file if any record has been added since it was loaded
+    def Save(self):
+        if not self.CachePath or not self.Modified:
+            return
+        #
+        # Write a private file then rename it, so that concurrent builds sharing the
+        # cache never read a partial file nor write into the same temporary file.
+        #
+        TempPath = "%s.%d.%d.tmp" % (self.CachePath, getpid(), get_ident())
+        try:
+            with open(TempPath, 'wb') as File:
+                pickle.dump((self.Version, self.Records), File, pickle.HIGHEST_PROTOCOL)
+            os.replace(TempPath, self.CachePath)
+            self.Modified = False
+        except Exception as Exc:
+            EdkLogger.debug(EdkLogger.DEBUG_5, "Failed to save %s: %s" % (self.CachePath, str(Exc)))
+            if os.path.isfile(TempPath):
+                os.remove(TempPath)
+
+    def _IsEnabled(self, FileType):
+        if not self.CachePath or FileType not in self._FILE_TYPE_:
+            return False
+        # INF usage checks are only done when the file is parsed
+        if GlobalData.gOptions and GlobalData.gOptions.CheckUsage:
+            return False
+        return True
+
+    @staticmethod
+    def _GetParserVersion():
+        Hash = md5()
+        for Name in ('MetaFileParser.py', 'MetaFileTable.py', 'MetaFileCache.py'):
+            with open(os.path.join(os.path.dirname(os.path.abspath(__file__)), Name), 'rb') as File:
+                Hash.update(File.read())
+        return Hash.hexdigest()
+
+    @staticmethod
+    def _GetDigest(MetaFile):
+        try:
+            with open(str(MetaFile), 'rb') as File:
+                return md5(File.read()).hexdigest()
+        except:
+            return None
+
+    ## Fill a meta file table with the cached records of its file
+    #
+    #   The records are inserted again, so that the record IDs are the same as
+    #   if the file was parsed in this build.
+    #
+    #   @param  Table       The raw MetaFileTable of the file
+    #   @param  FileType    The model type of the file
+    #
+    #   @retval True        The table holds all the records of the file
+    #   @retval False       The file must be parsed
+    #
+    def Restore(self, Table, FileType):
+        if not self._IsEnabled(FileType):
+            return False
+        Entry = self.Records.get(Table.MetaFile.Path)
+        if Entry is None or Entry[0] != self._GetDigest(Table.MetaFile):
+            return False
+        if any(Name in GlobalData.gGlobalDefines for Name in Entry[2]):
+            return False
+
+        IdMap = {}
+        for Record in Entry[1]:
+            BelongsToItem = IdMap.get(Record[7], Record[7])
+            IdMap[Record[0]] = Table.Insert(*(Record[1:7] + [BelongsToItem] + Record[8:]))
+        Table.SetEndFlag()
+        return True
+
+    ## Add the records of a file that was just parsed
+    #
+    #   @param  Table       The raw MetaFileTable of the file
+    #   @param  FileType    The model type of the file
+    #   @param  MacroNames  The names of the macros defined by the file
+    #
+    def Update(self, Table, FileType, MacroNames):
+        if not self._IsEnabled(FileType) or not Table.IsIntegrity():
+            return
+        Digest = self._GetDigest(Table.MetaFile)
+        if Digest is None:
+            return
+        self.Records[Table.MetaFile.Path] = (Digest, [list(Record) for Record in Table.CurrentContent if Record[0] >= 0], sorted(MacroNames))
+        self.Modified = True
+
+MetaFileParseCache = MetaFileCache()
@@ -29,6 +29,7 @@ from CommonDataClass.Exceptions import *
 from Common.LongFilePathSupport import OpenLongFilePath as open
 from collections import defaultdict
 from .MetaFileTable import MetaFileStorage
+from .MetaFileCache import MetaFileParseCache
 from .MetaFileCommentParser import CheckInfComment
 from Common.DataType import TAB_COMMENT_EDK_START, TAB_COMMENT_EDK_END
 
@@ -258,7 +259,14 @@ class MetaFileParser(object):
             else:
                 self._Table = self._RawTable
                 self._PostProcessed = False
-                self.Start()
+                if MetaFileParseCache.Restore(self._RawTable, self._FileType):
+                    self._Finished = True
+                else:
+                    self.Start()
+                    MacroNames = set(self._FileLocalMacros)
+                    for Macros in self._SectionsMacroDict.values():
+                        MacroNames.update(Macros)
+                    MetaFileParseCache.Update(self._RawTable, self._FileType, MacroNames)
     ## Data parser for the common format in different type of file
     #
     #   The common format in the meatfile is like
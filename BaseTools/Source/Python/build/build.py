@@ -48,6 +48,7 @@ from Common.DataType import *
 import Common.EdkLogger as EdkLogger
 
 from Workspace.WorkspaceDatabase import BuildDB
+from Workspace.MetaFileCache import MetaFileParseCache
 
 from BuildReport import BuildReport
 from GenPatchPcdTable.GenPatchPcdTable import PeImageClass,parsePcdInfoFromMapFile
@@ -779,6 +780,8 @@ class Build():
         GlobalData.gDatabasePath = os.path.normpath(os.path.join(GlobalData.gConfDirectory, GlobalData.gDatabasePath))
         if not os.path.exists(os.path.join(GlobalData.gConfDirectory, '.cache')):
             os.makedirs(os.path.join(GlobalData.gConfDirectory, '.cache'))
+        if self.Target not in ['clean', 'cleanall']:
+            MetaFileParseCache.Load(GlobalData.gDatabasePath)
         self.Db = BuildDB
         self.BuildDatabase = self.Db.BuildObject
         self.Platform = None
@@ -996,6 +999,7 @@ class Build():
         self.ToolChainFamily = ToolChainFamily
 
         self.ThreadNumber   = ThreadNum()
+        GlobalData.gThreadNumber = self.ThreadNumber
     ## Initialize build configuration
     #
     #   This method will parse DSC file and merge the configurations from
@@ -2693,6 +2697,7 @@ def Main():
         GlobalData.gCommandLineDefines['ARCH'] = ' '.join(MyBuild.ArchList)
         if not (MyBuild.LaunchPrebuildFlag and os.path.exists(MyBuild.PlatformBuildPath)):
             MyBuild.Launch()
+        MetaFileParseCache.Save()
 
         #
         # All job done, no error found and no exception raised
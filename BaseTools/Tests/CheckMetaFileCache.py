@@ -0,0 +1,109 @@
+## @file
+#  Unit tests for Workspace.MetaFileCache
+#
+#  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+#
+#  SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+
+##
+# Import Modules
+#
+import os
+import unittest
+
+import TestTools
+
+from Common.Misc import PathClass
+from Common.DataType import TAB_ARCH_COMMON
+import Common.GlobalData as GlobalData
+from CommonDataClass.DataClass import MODEL_FILE_INF
+from Workspace.MetaFileCache import MetaFileParseCache
+from Workspace.MetaFileParser import InfParser
+from Workspace.MetaFileTable import MetaFileStorage
+from Workspace.WorkspaceDatabase import WorkspaceDatabase
+
+from Common import EdkLogger
+EdkLogger.InitializeForUnitTest()
+
+class Tests(TestTools.BaseToolsTest):
+
+    SampleData = '''
+        [Defines]
+          INF_VERSION    = 0x00010005
+          BASE_NAME      = Sample
+          FILE_GUID      = 6B0E5B0A-4D3B-4E43-9A4A-8E0B5F2C1D70
+          MODULE_TYPE    = BASE
+          DEFINE SRC_DIR = Source
+
+        [Sources]
+          $(SRC_DIR)/Sample.c
+
+        [Packages]
+          MdePkg/MdePkg.dec
+    '''
+
+    def setUp(self):
+        TestTools.BaseToolsTest.setUp(self)
+        self.SavedGlobalDefines = GlobalData.gGlobalDefines
+        self.SavedCommandLineDefines = GlobalData.gCommandLineDefines
+        self.WriteTmpFile('Sample.inf', self.SampleData)
+        self.InfPath = PathClass(self.GetTmpFilePath('Sample.inf'))
+        self.CachePath = self.GetTmpFilePath('MetaFileCache')
+
+    def tearDown(self):
+        GlobalData.gGlobalDefines = self.SavedGlobalDefines
+        GlobalData.gCommandLineDefines = self.SavedCommandLineDefines
+        MetaFileParseCache.Load(self.CachePath)
+        MetaFileParseCache.CachePath = None
+        TestTools.BaseToolsTest.tearDown(self)
+
+    #
+    # Start a build with the given global and command line macros, loading the
+    # cache saved by the previous one. The parser objects of a build are not
+    # kept by the next one.
+    #
+    def StartBuild(self, GlobalDefines, CommandLineDefines):
+        GlobalData.gGlobalDefines = dict(GlobalDefines)
+        GlobalData.gCommandLineDefines = dict(CommandLineDefines)
+        InfParser.MetaFiles.pop(self.InfPath, None)
+        MetaFileParseCache.Load(self.CachePath)
+        self.Table = MetaFileStorage(WorkspaceDatabase(), self.InfPath, MODEL_FILE_INF, True)
+
+    def ParseInf(self):
+        Parser = InfParser(self.InfPath, MODEL_FILE_INF, TAB_ARCH_COMMON, self.Table)
+        Parser.StartParse()
+        MetaFileParseCache.Save()
+        return [Record[1:] for Record in self.Table.CurrentContent]
+
+    def testRebuildWithOtherCommandLineMacros(self):
+        self.StartBuild({'WORKSPACE': self.GetTmpFilePath('')}, {'FEATURE_ENABLE': 'TRUE'})
+        Records = self.ParseInf()
+        self.assertTrue(os.path.isfile(self.CachePath))
+
+        #
+        # The -D macros of the platform are only applied when the records are
+        # queried: the records are restored.
+        #
+        self.StartBuild({'WORKSPACE': self.GetTmpFilePath('')}, {'FEATURE_ENABLE': 'FALSE', 'SRC_DIR': 'Other'})
+        self.assertTrue(MetaFileParseCache.Restore(self.Table, MODEL_FILE_INF))
+        self.assertEqual([Record[1:] for Record in self.Table.CurrentContent], Records)
+
+    def testRebuildWithGlobalMacroDefinedByFile(self):
+        self.StartBuild({'WORKSPACE': self.GetTmpFilePath('')}, {})
+        self.ParseInf()
+
+        #
+        # GenFds takes the -D WORKSPACE, TARGET and TOOLCHAIN macros as global
+        # macros, which the INF file cannot define: the file is parsed again to
+        # report the error.
+        #
+        self.StartBuild({'WORKSPACE': self.GetTmpFilePath(''), 'SRC_DIR': 'Other'}, {})
+        self.assertFalse(MetaFileParseCache.Restore(self.Table, MODEL_FILE_INF))
+        self.assertRaises(EdkLogger.FatalError, self.ParseInf)
+
+TheTestSuite = TestTools.MakeTheTestSuite(locals())
+
+if __name__ == '__main__':
+    allTests = TheTestSuite()
+    unittest.TextTestRunner().run(allTests)
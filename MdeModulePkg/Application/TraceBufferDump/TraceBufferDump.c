@@ -0,0 +1,292 @@
+/** @file
+  Shell application to write the binary trace buffers of TraceLib to a file.
+
+  The PEI and DXE trace buffers are found in the EFI System Configuration
+  Table, and the MM trace buffer is read through its MMI handler. Each buffer
+  is written as its header followed by its records, and the file is converted
+  to the Chrome trace event JSON format by BaseTools/Scripts/TraceBufferDecode.py.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/Shell.h>
+#include <Protocol/ShellParameters.h>
+#include <Protocol/SmmCommunication.h>
+#include <Guid/PiSmmCommunicationRegionTable.h>
+#include <Guid/TraceBuffer.h>
+
+/**
+  Return the size of the header and of the records written in a trace buffer.
+
+  @param  Buffer  The header of the trace buffer.
+
+  @return The number of bytes to write.
+
+**/
+UINTN
+TraceBufferSize (
+  IN EDKII_TRACE_BUFFER  *Buffer
+  )
+{
+  return Buffer->HeaderSize + (UINTN)MIN (Buffer->Count, Buffer->Capacity) * Buffer->RecordSize;
+}
+
+/**
+  Write a trace buffer to the file, and display its statistics.
+
+  The record count of the copy written is clamped to the capacity of the
+  buffer.
+
+  @param  Shell       The shell protocol.
+  @param  FileHandle  The file.
+  @param  Buffer      The trace buffer.
+
+  @retval EFI_SUCCESS  The trace buffer was written.
+  @retval other        The file could not be written.
+
+**/
+EFI_STATUS
+WriteTraceBuffer (
+  IN EFI_SHELL_PROTOCOL   *Shell,
+  IN SHELL_FILE_HANDLE    FileHandle,
+  IN EDKII_TRACE_BUFFER   *Buffer
+  )
+{
+  EFI_STATUS          Status;
+  EDKII_TRACE_BUFFER  Header;
+  UINTN               Size;
+
+  if ((Buffer->Signature != EDKII_TRACE_BUFFER_SIGNATURE) || (Buffer->HeaderSize < sizeof (Header))) {
+    return EFI_COMPROMISED_DATA;
+  }
+
+  CopyMem (&Header, Buffer, sizeof (Header));
+  Header.Count = MIN (Header.Count, Header.Capacity);
+
+  Print (
+    L"Phase %d: %d of %d records, %d dropped\n",
+    Header.Phase,
+    Header.Count,
+    Header.Capacity,
+    Header.Dropped
+    );
+
+  Size   = sizeof (Header);
+  Status = Shell->WriteFile (FileHandle, &Size, &Header);
+  if (!EFI_ERROR (Status)) {
+    Size   = TraceBufferSize (&Header) - sizeof (Header);
+    Status = Shell->WriteFile (FileHandle, &Size, (UINT8 *)Buffer + sizeof (Header));
+  }
+
+  return Status;
+}
+
+/**
+  Read the MM trace buffer through its MMI handler.
+
+  @return The copy of the MM trace buffer, or NULL if there is none.
+
+**/
+EDKII_TRACE_BUFFER *
+GetMmTraceBuffer (
+  VOID
+  )
+{
+  EFI_STATUS                               Status;
+  EFI_SMM_COMMUNICATION_PROTOCOL           *SmmCommunication;
+  EDKII_PI_SMM_COMMUNICATION_REGION_TABLE  *PiSmmCommunicationRegionTable;
+  EFI_MEMORY_DESCRIPTOR                    *Entry;
+  EFI_SMM_COMMUNICATE_HEADER               *CommHeader;
+  EDKII_TRACE_BUFFER_COMMUNICATE           *CommTrace;
+  UINT8                                    *CommBuffer;
+  UINTN                                    CommSize;
+  UINTN                                    RegionSize;
+  UINT32                                   Index;
+  EDKII_TRACE_BUFFER                       Header;
+  EDKII_TRACE_BUFFER                       *Buffer;
+  UINTN                                    BufferSize;
+  UINTN                                    Offset;
+
+  Status = gBS->LocateProtocol (&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **)&SmmCommunication);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Status = EfiGetSystemConfigurationTable (
+             &gEdkiiPiSmmCommunicationRegionTableGuid,
+             (VOID **)&PiSmmCommunicationRegionTable
+             );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Entry      = (EFI_MEMORY_DESCRIPTOR *)(PiSmmCommunicationRegionTable + 1);
+  RegionSize = 0;
+  for (Index = 0; Index < PiSmmCommunicationRegionTable->NumberOfEntries; Index++) {
+    if (Entry->Type == EfiConventionalMemory) {
+      RegionSize = EFI_PAGES_TO_SIZE ((UINTN)Entry->NumberOfPages);
+      if (RegionSize >= EFI_PAGE_SIZE) {
+        break;
+      }
+    }
+
+    Entry = (EFI_MEMORY_DESCRIPTOR *)((UINT8 *)Entry + PiSmmCommunicationRegionTable->DescriptorSize);
+  }
+
+  if (Index == PiSmmCommunicationRegionTable->NumberOfEntries) {
+    return NULL;
+  }
+
+  CommBuffer = (UINT8 *)(UINTN)Entry->PhysicalStart;
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *)CommBuffer;
+  CommTrace  = (EDKII_TRACE_BUFFER_COMMUNICATE *)CommHeader->Data;
+  Buffer     = NULL;
+  BufferSize = sizeof (Header);
+  Offset     = 0;
+
+  //
+  // Read the header first, it gives the size of the rest of the buffer.
+  //
+  while (Offset < BufferSize) {
+    CopyGuid (&CommHeader->HeaderGuid, &gEdkiiTraceBufferGuid);
+    CommHeader->MessageLength = RegionSize - OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data);
+    CommTrace->ReturnStatus   = (UINT64)-1;
+    CommTrace->Offset         = Offset;
+    CommTrace->Size           = BufferSize - Offset;
+
+    CommSize = RegionSize;
+    Status   = SmmCommunication->Communicate (SmmCommunication, CommBuffer, &CommSize);
+    if (EFI_ERROR (Status) || (CommTrace->ReturnStatus != 0) || (CommTrace->Size == 0) ||
+        (CommTrace->Size > BufferSize - Offset))
+    {
+      break;
+    }
+
+    if (Buffer == NULL) {
+      CopyMem ((UINT8 *)&Header + Offset, CommTrace + 1, (UINTN)CommTrace->Size);
+      Offset += (UINTN)CommTrace->Size;
+      if (Offset < sizeof (Header)) {
+        continue;
+      }
+
+      if ((Header.Signature != EDKII_TRACE_BUFFER_SIGNATURE) || (Header.HeaderSize < sizeof (Header))) {
+        return NULL;
+      }
+
+      BufferSize = TraceBufferSize (&Header);
+      Buffer     = AllocatePool (BufferSize);
+      if (Buffer == NULL) {
+        return NULL;
+      }
+
+      CopyMem (Buffer, &Header, sizeof (Header));
+      continue;
+    }
+
+    CopyMem ((UINT8 *)Buffer + Offset, CommTrace + 1, (UINTN)CommTrace->Size);
+    Offset += (UINTN)CommTrace->Size;
+  }
+
+  if ((Buffer != NULL) && (Offset < BufferSize)) {
+    Print (L"TraceBufferDump: MM trace buffer read failed - %r\n", Status);
+    FreePool (Buffer);
+    Buffer = NULL;
+  }
+
+  return Buffer;
+}
+
+/**
+  The user Entry Point for the application. It writes the trace buffers to
+  the file given on the command line.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS            The trace buffers were written.
+  @retval EFI_INVALID_PARAMETER  The command line is invalid.
+  @retval other                  The file could not be written.
+
+**/
+EFI_STATUS
+EFIAPI
+TraceBufferDumpEntrypoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  EFI_SHELL_PROTOCOL             *Shell;
+  SHELL_FILE_HANDLE              FileHandle;
+  EDKII_TRACE_BUFFER_TABLE       *Table;
+  EFI_PHYSICAL_ADDRESS           *Address;
+  EDKII_TRACE_BUFFER             *MmBuffer;
+  UINT32                         Index;
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **)&ShellParameters);
+  if (EFI_ERROR (Status) || (ShellParameters->Argc != 2)) {
+    Print (L"Usage: TraceBufferDump <FileName>\n");
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiShellProtocolGuid, NULL, (VOID **)&Shell);
+  if (EFI_ERROR (Status)) {
+    Print (L"TraceBufferDump: Locate Shell protocol - %r\n", Status);
+    return Status;
+  }
+
+  Status = EfiGetSystemConfigurationTable (&gEdkiiTraceBufferGuid, (VOID **)&Table);
+  if (EFI_ERROR (Status) || (Table->Signature != EDKII_TRACE_BUFFER_TABLE_SIGNATURE)) {
+    Table = NULL;
+  }
+
+  MmBuffer = GetMmTraceBuffer ();
+  if ((Table == NULL) && (MmBuffer == NULL)) {
+    Print (L"TraceBufferDump: no trace buffer\n");
+    return EFI_NOT_FOUND;
+  }
+
+  Shell->DeleteFileByName (ShellParameters->Argv[1]);
+  Status = Shell->OpenFileByName (
+                    ShellParameters->Argv[1],
+                    &FileHandle,
+                    EFI_FILE_MODE_CREATE | EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE
+                    );
+  if (EFI_ERROR (Status)) {
+    Print (L"TraceBufferDump: Open %s - %r\n", ShellParameters->Argv[1], Status);
+    goto Done;
+  }
+
+  if (Table != NULL) {
+    Address = (EFI_PHYSICAL_ADDRESS *)(Table + 1);
+    for (Index = 0; Index < Table->NumberOfBuffers && !EFI_ERROR (Status); Index++) {
+      Status = WriteTraceBuffer (Shell, FileHandle, (EDKII_TRACE_BUFFER *)(UINTN)Address[Index]);
+    }
+  }
+
+  if ((MmBuffer != NULL) && !EFI_ERROR (Status)) {
+    Status = WriteTraceBuffer (Shell, FileHandle, MmBuffer);
+  }
+
+  Shell->CloseFile (FileHandle);
+  if (EFI_ERROR (Status)) {
+    Print (L"TraceBufferDump: Write %s - %r\n", ShellParameters->Argv[1], Status);
+  }
+
+Done:
+  if (MmBuffer != NULL) {
+    FreePool (MmBuffer);
+  }
+
+  return Status;
+}
@@ -13,6 +13,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <IndustryStandard/Scsi.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/UsbIo.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/DiskInfo.h>
@@ -172,6 +173,7 @@ struct _USB_MASS_DEVICE {
   EFI_USB_IO_PROTOCOL         *UsbIo;
   EFI_DEVICE_PATH_PROTOCOL    *DevicePath;
   EFI_BLOCK_IO_PROTOCOL       BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL      BlockIo2;
   EFI_BLOCK_IO_MEDIA          BlockIoMedia;
   BOOLEAN                     OpticalStorage;
   UINT8                       Lun;        ///< Logical Unit Number
@@ -181,6 +183,14 @@ struct _USB_MASS_DEVICE {
   EFI_DISK_INFO_PROTOCOL      DiskInfo;
   USB_BOOT_INQUIRY_DATA       InquiryData;
   BOOLEAN                     Cdb16Byte;
+  UINT32                      MaxTransferSize;  ///< Max data length of a READ/WRITE command
+  LIST_ENTRY                  AsyncQueue;       ///< Pending Block I/O 2 requests
+  EFI_EVENT                   AsyncTimer;       ///< Processes the pending Block I/O 2 requests
+  UINT8                       *ReadAheadBuffer;
+  UINT32                      ReadAheadMediaId;
+  EFI_LBA                     ReadAheadLba;
+  UINTN                       ReadAheadBlocks;  ///< 0 if no block is read ahead
+  EFI_LBA                     NextLba;          ///< The block following the last read
 };
 
 #endif
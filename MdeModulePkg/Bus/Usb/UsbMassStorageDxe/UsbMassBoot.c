@@ -754,7 +754,7 @@ UsbBootDetectMedia (
   {
     //
     // This function is called from:
-    //   Block I/O Protocol APIs, which run at TPL_CALLBACK.
+    //   Block I/O and Block I/O 2 Protocol APIs, which run at TPL_CALLBACK.
     //   DriverBindingStart(), which raises to TPL_CALLBACK.
     ASSERT (EfiGetCurrentTpl () == TPL_CALLBACK);
 
@@ -768,6 +768,12 @@ UsbBootDetectMedia (
            &UsbMass->BlockIo,
            &UsbMass->BlockIo
            );
+    gBS->ReinstallProtocolInterface (
+           UsbMass->Controller,
+           &gEfiBlockIo2ProtocolGuid,
+           &UsbMass->BlockIo2,
+           &UsbMass->BlockIo2
+           );
 
     //
     // Reset MediaId after reinstalling Block I/O Protocol.
@@ -824,7 +830,7 @@ UsbBootReadWriteBlocks (
   UINT32                      Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
-  CountMax  = USB_BOOT_MAX_CARRY_SIZE / BlockSize;
+  CountMax  = UsbMass->MaxTransferSize / BlockSize;
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -910,7 +916,7 @@ UsbBootReadWriteBlocks16 (
   UINT32      Timeout;
 
   BlockSize = UsbMass->BlockIoMedia.BlockSize;
-  CountMax  = USB_BOOT_MAX_CARRY_SIZE / BlockSize;
+  CountMax  = UsbMass->MaxTransferSize / BlockSize;
   Status    = EFI_SUCCESS;
 
   while (TotalBlock > 0) {
@@ -63,6 +63,13 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define USB_BOOT_MAX_CARRY_SIZE  SIZE_64KB
 
+//
+// SuperSpeed devices, whose bulk endpoints have a max packet size of 1024
+// bytes, get up to 1MB per READ/WRITE command.
+//
+#define USB_BOOT_SUPER_SPEED_PACKET_SIZE     1024
+#define USB_BOOT_SUPER_SPEED_MAX_CARRY_SIZE  SIZE_1MB
+
 //
 // Retry mass command times, set by experience
 //
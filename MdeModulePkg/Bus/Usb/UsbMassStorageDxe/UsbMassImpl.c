@@ -27,6 +27,521 @@ EFI_DRIVER_BINDING_PROTOCOL  gUSBMassDriverBinding = {
   NULL
 };
 
+/**
+  Get the max data length of the READ/WRITE commands of a device.
+
+  @param  Transport              The transport protocol of the device.
+  @param  Context                The context of the transport protocol.
+
+  @return The max data length in bytes.
+
+**/
+UINT32
+UsbMassGetMaxTransferSize (
+  IN USB_MASS_TRANSPORT  *Transport,
+  IN VOID                *Context
+  )
+{
+  USB_BOT_PROTOCOL  *UsbBot;
+
+  if (Transport->Protocol == USB_MASS_STORE_BOT) {
+    UsbBot = (USB_BOT_PROTOCOL *)Context;
+    if (UsbBot->BulkInEndpoint->MaxPacketSize >= USB_BOOT_SUPER_SPEED_PACKET_SIZE) {
+      return USB_BOOT_SUPER_SPEED_MAX_CARRY_SIZE;
+    }
+  }
+
+  return USB_BOOT_MAX_CARRY_SIZE;
+}
+
+/**
+  Check the parameters of a read or write request.
+
+  If it is a removable media, the media is detected first.
+
+  @param  UsbMass                The USB mass storage device.
+  @param  MediaId                The media ID that the request is for.
+  @param  Lba                    The starting logical block address of the request.
+  @param  BufferSize             The size of the Buffer in bytes.
+  @param  Buffer                 The buffer of the request.
+
+  @retval EFI_SUCCESS            The request is valid.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The request contains LBAs that are not valid.
+  @retval Others                 Failed to detect the media.
+
+**/
+EFI_STATUS
+UsbMassCheckRequest (
+  IN USB_MASS_DEVICE  *UsbMass,
+  IN UINT32           MediaId,
+  IN EFI_LBA          Lba,
+  IN UINTN            BufferSize,
+  IN VOID             *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  EFI_STATUS          Status;
+
+  Media = &UsbMass->BlockIoMedia;
+
+  //
+  // If it is a removable media, such as CD-Rom or Usb-Floppy,
+  // need to detect the media before each read/write. While some of
+  // Usb-Flash is marked as removable media.
+  //
+  if (Media->RemovableMedia) {
+    Status = UsbBootDetectMedia (UsbMass);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  if (!(Media->MediaPresent)) {
+    return EFI_NO_MEDIA;
+  }
+
+  if (MediaId != Media->MediaId) {
+    return EFI_MEDIA_CHANGED;
+  }
+
+  if (BufferSize == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // BufferSize must be a multiple of the intrinsic block size of the device.
+  //
+  if ((BufferSize % Media->BlockSize) != 0) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  //
+  // Make sure the range to access is valid.
+  //
+  if (Lba + BufferSize / Media->BlockSize - 1 > Media->LastBlock) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read or write some blocks from the device with the READ/WRITE commands
+  supported by the device.
+
+  @param  UsbMass                The USB mass storage device to access
+  @param  Write                  TRUE for write operation.
+  @param  Lba                    The start block number
+  @param  TotalBlock             Total block number to read or write
+  @param  Buffer                 The buffer to read to or write from
+
+  @retval EFI_SUCCESS            Data are read into the buffer or writen into the device.
+  @retval Others                 Failed to read or write all the data
+
+**/
+EFI_STATUS
+UsbMassReadWriteDevice (
+  IN  USB_MASS_DEVICE  *UsbMass,
+  IN  BOOLEAN          Write,
+  IN  EFI_LBA          Lba,
+  IN  UINTN            TotalBlock,
+  IN OUT UINT8         *Buffer
+  )
+{
+  if (UsbMass->Cdb16Byte) {
+    return UsbBootReadWriteBlocks16 (UsbMass, Write, Lba, TotalBlock, Buffer);
+  }
+
+  return UsbBootReadWriteBlocks (UsbMass, Write, (UINT32)Lba, TotalBlock, Buffer);
+}
+
+/**
+  Check whether some blocks of the current media are all read ahead.
+
+  @param  UsbMass                The USB mass storage device.
+  @param  Lba                    The start block number
+  @param  TotalBlock             Total block number
+
+  @retval TRUE                   The blocks can be read without a command.
+  @retval FALSE                  Some of the blocks are not read ahead.
+
+**/
+BOOLEAN
+UsbMassIsReadAhead (
+  IN USB_MASS_DEVICE  *UsbMass,
+  IN EFI_LBA          Lba,
+  IN UINTN            TotalBlock
+  )
+{
+  return (BOOLEAN)((UsbMass->ReadAheadBlocks != 0) &&
+                   (UsbMass->ReadAheadMediaId == UsbMass->BlockIoMedia.MediaId) &&
+                   (Lba >= UsbMass->ReadAheadLba) &&
+                   (Lba + TotalBlock <= UsbMass->ReadAheadLba + UsbMass->ReadAheadBlocks));
+}
+
+/**
+  Read or write some blocks, through the blocks read ahead.
+
+  A read is served from the blocks read ahead if they hold all the blocks to
+  read. Otherwise a small read following the previous one is rounded up to
+  USB_MASS_READ_AHEAD_SIZE, so that the next sequential reads do not need a
+  command each. A write drops the blocks read ahead it overlaps. The device
+  is reset if the read or write fails.
+
+  @param  UsbMass                The USB mass storage device to access
+  @param  Write                  TRUE for write operation.
+  @param  Lba                    The start block number
+  @param  TotalBlock             Total block number to read or write
+  @param  Buffer                 The buffer to read to or write from
+
+  @retval EFI_SUCCESS            Data are read into the buffer or writen into the device.
+  @retval Others                 Failed to read or write all the data
+
+**/
+EFI_STATUS
+UsbMassTransferBlocks (
+  IN  USB_MASS_DEVICE  *UsbMass,
+  IN  BOOLEAN          Write,
+  IN  EFI_LBA          Lba,
+  IN  UINTN            TotalBlock,
+  IN OUT UINT8         *Buffer
+  )
+{
+  EFI_BLOCK_IO_MEDIA  *Media;
+  EFI_STATUS          Status;
+  UINTN               BlockSize;
+  UINTN               Count;
+
+  Media     = &UsbMass->BlockIoMedia;
+  BlockSize = Media->BlockSize;
+
+  if (UsbMass->ReadAheadMediaId != Media->MediaId) {
+    UsbMass->ReadAheadBlocks = 0;
+  }
+
+  if (Write) {
+    if ((UsbMass->ReadAheadBlocks != 0) &&
+        (Lba < UsbMass->ReadAheadLba + UsbMass->ReadAheadBlocks) &&
+        (UsbMass->ReadAheadLba < Lba + TotalBlock))
+    {
+      UsbMass->ReadAheadBlocks = 0;
+    }
+
+    Status = UsbMassReadWriteDevice (UsbMass, TRUE, Lba, TotalBlock, Buffer);
+  } else if (UsbMassIsReadAhead (UsbMass, Lba, TotalBlock)) {
+    CopyMem (
+      Buffer,
+      UsbMass->ReadAheadBuffer + (UINTN)(Lba - UsbMass->ReadAheadLba) * BlockSize,
+      TotalBlock * BlockSize
+      );
+    Status = EFI_SUCCESS;
+  } else {
+    Status = EFI_NOT_STARTED;
+    Count  = USB_MASS_READ_AHEAD_SIZE / BlockSize;
+    if ((UsbMass->ReadAheadBuffer != NULL) && (Lba == UsbMass->NextLba) && (TotalBlock < Count)) {
+      UsbMass->ReadAheadBlocks = 0;
+      Count                    = (UINTN)MIN (Count, Media->LastBlock - Lba + 1);
+      Status                   = UsbMassReadWriteDevice (UsbMass, FALSE, Lba, Count, UsbMass->ReadAheadBuffer);
+      if (!EFI_ERROR (Status)) {
+        UsbMass->ReadAheadMediaId = Media->MediaId;
+        UsbMass->ReadAheadLba     = Lba;
+        UsbMass->ReadAheadBlocks  = Count;
+        CopyMem (Buffer, UsbMass->ReadAheadBuffer, TotalBlock * BlockSize);
+      }
+    }
+
+    //
+    // The blocks following the ones to read may not be readable, so read
+    // only the requested blocks when the read ahead fails.
+    //
+    if (EFI_ERROR (Status)) {
+      Status = UsbMassReadWriteDevice (UsbMass, FALSE, Lba, TotalBlock, Buffer);
+    }
+  }
+
+  if (!Write) {
+    UsbMass->NextLba = Lba + TotalBlock;
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "UsbMassTransferBlocks: UsbBoot%sBlocks (%r) -> Reset\n", Write ? L"Write" : L"Read", Status));
+    UsbMass->ReadAheadBlocks = 0;
+    UsbMass->Transport->Reset (UsbMass->Context, TRUE);
+  }
+
+  return Status;
+}
+
+/**
+  Queue a Block I/O 2 request, and start the timer processing the queue if
+  it is the only request.
+
+  @param  UsbMass                The USB mass storage device.
+  @param  Write                  TRUE for write operation.
+  @param  MediaId                The media ID that the request is for.
+  @param  Lba                    The start block number
+  @param  TotalBlock             Total block number to read or write, 0 for a flush.
+  @param  Buffer                 The buffer to read to or write from
+  @param  Token                  The token of the request.
+
+  @retval EFI_SUCCESS            The request is queued.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued due to a lack of resources.
+
+**/
+EFI_STATUS
+UsbMassQueueRequest (
+  IN USB_MASS_DEVICE      *UsbMass,
+  IN BOOLEAN              Write,
+  IN UINT32               MediaId,
+  IN EFI_LBA              Lba,
+  IN UINTN                TotalBlock,
+  IN UINT8                *Buffer,
+  IN EFI_BLOCK_IO2_TOKEN  *Token
+  )
+{
+  USB_MASS_ASYNC_REQUEST  *Request;
+  EFI_STATUS              Status;
+
+  Request = AllocateZeroPool (sizeof (USB_MASS_ASYNC_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Signature  = USB_MASS_ASYNC_REQUEST_SIGNATURE;
+  Request->Token      = Token;
+  Request->Write      = Write;
+  Request->MediaId    = MediaId;
+  Request->Lba        = Lba;
+  Request->BlockCount = TotalBlock;
+  Request->Buffer     = Buffer;
+
+  if (IsListEmpty (&UsbMass->AsyncQueue)) {
+    Status = gBS->SetTimer (UsbMass->AsyncTimer, TimerPeriodic, USB_MASS_ASYNC_TIMER_PERIOD);
+    if (EFI_ERROR (Status)) {
+      FreePool (Request);
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  Token->TransactionStatus = EFI_SUCCESS;
+  InsertTailList (&UsbMass->AsyncQueue, &Request->Link);
+  return EFI_SUCCESS;
+}
+
+/**
+  Remove a Block I/O 2 request from the queue, and signal its completion.
+
+  @param  Request                The request.
+  @param  Status                 The status of the request.
+
+**/
+VOID
+UsbMassCompleteRequest (
+  IN USB_MASS_ASYNC_REQUEST  *Request,
+  IN EFI_STATUS              Status
+  )
+{
+  RemoveEntryList (&Request->Link);
+  Request->Token->TransactionStatus = Status;
+  gBS->SignalEvent (Request->Token->Event);
+  FreePool (Request);
+}
+
+/**
+  Process the first pending Block I/O 2 request, with at most a single
+  READ/WRITE command. The request is completed once all its blocks are
+  transferred, or when the transfer fails.
+
+  @param  UsbMass                The USB mass storage device.
+
+  @retval TRUE                   A READ/WRITE command was sent to the device.
+  @retval FALSE                  The request was processed without command.
+
+**/
+BOOLEAN
+UsbMassProcessRequest (
+  IN USB_MASS_DEVICE  *UsbMass
+  )
+{
+  USB_MASS_ASYNC_REQUEST  *Request;
+  EFI_BLOCK_IO_MEDIA      *Media;
+  EFI_STATUS              Status;
+  UINTN                   Count;
+  BOOLEAN                 Command;
+
+  Request = USB_MASS_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&UsbMass->AsyncQueue));
+  Media   = &UsbMass->BlockIoMedia;
+  Status  = EFI_SUCCESS;
+  Command = FALSE;
+
+  if (Request->BlockCount != 0) {
+    if (!(Media->MediaPresent)) {
+      Status = EFI_NO_MEDIA;
+    } else if (Request->MediaId != Media->MediaId) {
+      Status = EFI_MEDIA_CHANGED;
+    } else {
+      Count   = MIN (Request->BlockCount, UsbMass->MaxTransferSize / Media->BlockSize);
+      Command = (BOOLEAN)(Request->Write || !UsbMassIsReadAhead (UsbMass, Request->Lba, Count));
+      Status  = UsbMassTransferBlocks (UsbMass, Request->Write, Request->Lba, Count, Request->Buffer);
+
+      Request->Lba        += Count;
+      Request->BlockCount -= Count;
+      Request->Buffer     += Count * Media->BlockSize;
+    }
+  }
+
+  if (EFI_ERROR (Status) || (Request->BlockCount == 0)) {
+    UsbMassCompleteRequest (Request, Status);
+  }
+
+  return Command;
+}
+
+/**
+  Timer handler processing the pending Block I/O 2 requests, until the queue
+  is empty or USB_MASS_ASYNC_COMMANDS_PER_TICK READ/WRITE commands are sent.
+
+  @param  Event                  The timer event.
+  @param  Context                The USB mass storage device.
+
+**/
+VOID
+EFIAPI
+UsbMassAsyncTimerHandler (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  USB_MASS_DEVICE  *UsbMass;
+  UINTN            Commands;
+
+  UsbMass  = (USB_MASS_DEVICE *)Context;
+  Commands = 0;
+  while (!IsListEmpty (&UsbMass->AsyncQueue) && (Commands < USB_MASS_ASYNC_COMMANDS_PER_TICK)) {
+    if (UsbMassProcessRequest (UsbMass)) {
+      Commands++;
+    }
+  }
+
+  if (IsListEmpty (&UsbMass->AsyncQueue)) {
+    gBS->SetTimer (UsbMass->AsyncTimer, TimerCancel, 0);
+  }
+}
+
+/**
+  Complete all the pending Block I/O 2 requests, so that a blocking request
+  is processed after them.
+
+  @param  UsbMass                The USB mass storage device.
+
+**/
+VOID
+UsbMassDrainQueue (
+  IN USB_MASS_DEVICE  *UsbMass
+  )
+{
+  if (IsListEmpty (&UsbMass->AsyncQueue)) {
+    return;
+  }
+
+  while (!IsListEmpty (&UsbMass->AsyncQueue)) {
+    UsbMassProcessRequest (UsbMass);
+  }
+
+  gBS->SetTimer (UsbMass->AsyncTimer, TimerCancel, 0);
+}
+
+/**
+  Abort all the pending Block I/O 2 requests.
+
+  @param  UsbMass                The USB mass storage device.
+
+**/
+VOID
+UsbMassAbortQueue (
+  IN USB_MASS_DEVICE  *UsbMass
+  )
+{
+  gBS->SetTimer (UsbMass->AsyncTimer, TimerCancel, 0);
+  while (!IsListEmpty (&UsbMass->AsyncQueue)) {
+    UsbMassCompleteRequest (
+      USB_MASS_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&UsbMass->AsyncQueue)),
+      EFI_ABORTED
+      );
+  }
+}
+
+/**
+  Initialize the Block I/O and Block I/O 2 Protocols of a device, once its
+  transport is set.
+
+  @param  UsbMass                The USB mass storage device.
+
+  @retval EFI_SUCCESS            The protocols are initialized.
+  @retval Others                 Failed to create the timer of the Block I/O 2 requests.
+
+**/
+EFI_STATUS
+UsbMassInitBlockIo (
+  IN USB_MASS_DEVICE  *UsbMass
+  )
+{
+  UsbMass->BlockIo.Media          = &UsbMass->BlockIoMedia;
+  UsbMass->BlockIo.Reset          = UsbMassReset;
+  UsbMass->BlockIo.ReadBlocks     = UsbMassReadBlocks;
+  UsbMass->BlockIo.WriteBlocks    = UsbMassWriteBlocks;
+  UsbMass->BlockIo.FlushBlocks    = UsbMassFlushBlocks;
+  UsbMass->BlockIo2.Media         = &UsbMass->BlockIoMedia;
+  UsbMass->BlockIo2.Reset         = UsbMassResetEx;
+  UsbMass->BlockIo2.ReadBlocksEx  = UsbMassReadBlocksEx;
+  UsbMass->BlockIo2.WriteBlocksEx = UsbMassWriteBlocksEx;
+  UsbMass->BlockIo2.FlushBlocksEx = UsbMassFlushBlocksEx;
+  UsbMass->MaxTransferSize        = UsbMassGetMaxTransferSize (UsbMass->Transport, UsbMass->Context);
+
+  //
+  // The device still works without reading ahead.
+  //
+  UsbMass->ReadAheadBuffer = AllocatePool (USB_MASS_READ_AHEAD_SIZE);
+
+  InitializeListHead (&UsbMass->AsyncQueue);
+  return gBS->CreateEvent (
+                EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                TPL_CALLBACK,
+                UsbMassAsyncTimerHandler,
+                UsbMass,
+                &UsbMass->AsyncTimer
+                );
+}
+
+/**
+  Free a device. Its pending Block I/O 2 requests must have been aborted.
+
+  @param  UsbMass                The USB mass storage device.
+
+**/
+VOID
+UsbMassFreeDevice (
+  IN USB_MASS_DEVICE  *UsbMass
+  )
+{
+  if (UsbMass->AsyncTimer != NULL) {
+    gBS->CloseEvent (UsbMass->AsyncTimer);
+  }
+
+  if (UsbMass->ReadAheadBuffer != NULL) {
+    FreePool (UsbMass->ReadAheadBuffer);
+  }
+
+  FreePool (UsbMass);
+}
+
 /**
   Reset the block device.
 
@@ -59,8 +574,9 @@ UsbMassReset (
   //
   OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
 
-  UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO (This);
-  Status  = UsbMass->Transport->Reset (UsbMass->Context, ExtendedVerification);
+  UsbMass                  = USB_MASS_DEVICE_FROM_BLOCK_IO (This);
+  UsbMass->ReadAheadBlocks = 0;
+  Status                   = UsbMass->Transport->Reset (UsbMass->Context, ExtendedVerification);
 
   gBS->RestoreTPL (OldTpl);
 
@@ -101,11 +617,9 @@ UsbMassReadBlocks (
   OUT VOID                  *Buffer
   )
 {
-  USB_MASS_DEVICE     *UsbMass;
-  EFI_BLOCK_IO_MEDIA  *Media;
-  EFI_STATUS          Status;
-  EFI_TPL             OldTpl;
-  UINTN               TotalBlock;
+  USB_MASS_DEVICE  *UsbMass;
+  EFI_STATUS       Status;
+  EFI_TPL          OldTpl;
 
   //
   // Raise TPL to TPL_CALLBACK to serialize all its operations
@@ -113,68 +627,19 @@ UsbMassReadBlocks (
   //
   OldTpl  = gBS->RaiseTPL (TPL_CALLBACK);
   UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO (This);
-  Media   = &UsbMass->BlockIoMedia;
 
   //
-  // If it is a removable media, such as CD-Rom or Usb-Floppy,
-  // need to detect the media before each read/write. While some of
-  // Usb-Flash is marked as removable media.
+  // Complete the pending Block I/O 2 requests first, so that the requests
+  // are processed in order.
   //
-  if (Media->RemovableMedia) {
-    Status = UsbBootDetectMedia (UsbMass);
-    if (EFI_ERROR (Status)) {
-      goto ON_EXIT;
-    }
-  }
-
-  if (!(Media->MediaPresent)) {
-    Status = EFI_NO_MEDIA;
-    goto ON_EXIT;
-  }
+  UsbMassDrainQueue (UsbMass);
 
-  if (MediaId != Media->MediaId) {
-    Status = EFI_MEDIA_CHANGED;
+  Status = UsbMassCheckRequest (UsbMass, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status) || (BufferSize == 0)) {
     goto ON_EXIT;
   }
 
-  if (BufferSize == 0) {
-    Status = EFI_SUCCESS;
-    goto ON_EXIT;
-  }
-
-  if (Buffer == NULL) {
-    Status = EFI_INVALID_PARAMETER;
-    goto ON_EXIT;
-  }
-
-  //
-  // BufferSize must be a multiple of the intrinsic block size of the device.
-  //
-  if ((BufferSize % Media->BlockSize) != 0) {
-    Status = EFI_BAD_BUFFER_SIZE;
-    goto ON_EXIT;
-  }
-
-  TotalBlock = BufferSize / Media->BlockSize;
-
-  //
-  // Make sure the range to read is valid.
-  //
-  if (Lba + TotalBlock - 1 > Media->LastBlock) {
-    Status = EFI_INVALID_PARAMETER;
-    goto ON_EXIT;
-  }
-
-  if (UsbMass->Cdb16Byte) {
-    Status = UsbBootReadWriteBlocks16 (UsbMass, FALSE, Lba, TotalBlock, Buffer);
-  } else {
-    Status = UsbBootReadWriteBlocks (UsbMass, FALSE, (UINT32)Lba, TotalBlock, Buffer);
-  }
-
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "UsbMassReadBlocks: UsbBootReadBlocks (%r) -> Reset\n", Status));
-    UsbMassReset (This, TRUE);
-  }
+  Status = UsbMassTransferBlocks (UsbMass, FALSE, Lba, BufferSize / UsbMass->BlockIoMedia.BlockSize, Buffer);
 
 ON_EXIT:
   gBS->RestoreTPL (OldTpl);
@@ -216,11 +681,9 @@ UsbMassWriteBlocks (
   IN VOID                   *Buffer
   )
 {
-  USB_MASS_DEVICE     *UsbMass;
-  EFI_BLOCK_IO_MEDIA  *Media;
-  EFI_STATUS          Status;
-  EFI_TPL             OldTpl;
-  UINTN               TotalBlock;
+  USB_MASS_DEVICE  *UsbMass;
+  EFI_STATUS       Status;
+  EFI_TPL          OldTpl;
 
   //
   // Raise TPL to TPL_CALLBACK to serialize all its operations
@@ -228,71 +691,116 @@ UsbMassWriteBlocks (
   //
   OldTpl  = gBS->RaiseTPL (TPL_CALLBACK);
   UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO (This);
-  Media   = &UsbMass->BlockIoMedia;
 
   //
-  // If it is a removable media, such as CD-Rom or Usb-Floppy,
-  // need to detect the media before each read/write. Some of
-  // USB Flash is marked as removable media.
+  // Complete the pending Block I/O 2 requests first, so that the requests
+  // are processed in order.
   //
-  if (Media->RemovableMedia) {
-    Status = UsbBootDetectMedia (UsbMass);
-    if (EFI_ERROR (Status)) {
-      goto ON_EXIT;
-    }
-  }
+  UsbMassDrainQueue (UsbMass);
 
-  if (!(Media->MediaPresent)) {
-    Status = EFI_NO_MEDIA;
+  Status = UsbMassCheckRequest (UsbMass, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status) || (BufferSize == 0)) {
     goto ON_EXIT;
   }
 
-  if (MediaId != Media->MediaId) {
-    Status = EFI_MEDIA_CHANGED;
-    goto ON_EXIT;
-  }
+  //
+  // Try to write the data even the device is marked as ReadOnly,
+  // and clear the status should the write succeed.
+  //
+  Status = UsbMassTransferBlocks (UsbMass, TRUE, Lba, BufferSize / UsbMass->BlockIoMedia.BlockSize, Buffer);
 
-  if (BufferSize == 0) {
-    Status = EFI_SUCCESS;
-    goto ON_EXIT;
-  }
+ON_EXIT:
+  gBS->RestoreTPL (OldTpl);
+  return Status;
+}
 
-  if (Buffer == NULL) {
-    Status = EFI_INVALID_PARAMETER;
-    goto ON_EXIT;
-  }
+/**
+  Flushes all modified data to a physical block device.
 
-  //
-  // BufferSize must be a multiple of the intrinsic block size of the device.
-  //
-  if ((BufferSize % Media->BlockSize) != 0) {
-    Status = EFI_BAD_BUFFER_SIZE;
-    goto ON_EXIT;
-  }
+  This function implements EFI_BLOCK_IO_PROTOCOL.FlushBlocks().
+  USB mass storage device doesn't support write cache,
+  so only the pending Block I/O 2 requests are completed.
 
-  TotalBlock = BufferSize / Media->BlockSize;
+  @param  This                   Indicates a pointer to the calling context.
 
-  //
-  // Make sure the range to write is valid.
-  //
-  if (Lba + TotalBlock - 1 > Media->LastBlock) {
-    Status = EFI_INVALID_PARAMETER;
-    goto ON_EXIT;
-  }
+  @retval EFI_SUCCESS            All outstanding data were written correctly to the device.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to write data.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+
+**/
+EFI_STATUS
+EFIAPI
+UsbMassFlushBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL  *This
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  UsbMassDrainQueue (USB_MASS_DEVICE_FROM_BLOCK_IO (This));
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Reads or writes the requested number of blocks, queuing the request if
+  Token->Event is not NULL.
+
+  @param  UsbMass                The USB mass storage device.
+  @param  Write                  TRUE for write operation.
+  @param  MediaId                The media ID that the request is for.
+  @param  Lba                    The starting logical block address of the request.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+  @param  Buffer                 The buffer to read to or write from.
+
+  @retval EFI_SUCCESS            The request was queued if Token->Event is not NULL.
+                                 The data was transferred correctly if Token->Event is NULL.
+  @retval Others                 The request is not valid, or failed.
+
+**/
+EFI_STATUS
+UsbMassReadWriteBlocksEx (
+  IN     USB_MASS_DEVICE      *UsbMass,
+  IN     BOOLEAN              Write,
+  IN     UINT32               MediaId,
+  IN     EFI_LBA              Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN  *Token,
+  IN     UINTN                BufferSize,
+  IN OUT VOID                 *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
 
   //
-  // Try to write the data even the device is marked as ReadOnly,
-  // and clear the status should the write succeed.
+  // Raise TPL to TPL_CALLBACK to serialize all its operations
+  // to protect shared data structures.
   //
-  if (UsbMass->Cdb16Byte) {
-    Status = UsbBootReadWriteBlocks16 (UsbMass, TRUE, Lba, TotalBlock, Buffer);
-  } else {
-    Status = UsbBootReadWriteBlocks (UsbMass, TRUE, (UINT32)Lba, TotalBlock, Buffer);
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  if ((Token == NULL) || (Token->Event == NULL)) {
+    UsbMassDrainQueue (UsbMass);
   }
 
+  Status = UsbMassCheckRequest (UsbMass, MediaId, Lba, BufferSize, Buffer);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "UsbMassWriteBlocks: UsbBootWriteBlocks (%r) -> Reset\n", Status));
-    UsbMassReset (This, TRUE);
+    goto ON_EXIT;
+  }
+
+  if ((Token != NULL) && (Token->Event != NULL)) {
+    Status = UsbMassQueueRequest (
+               UsbMass,
+               Write,
+               MediaId,
+               Lba,
+               BufferSize / UsbMass->BlockIoMedia.BlockSize,
+               Buffer,
+               Token
+               );
+  } else if (BufferSize != 0) {
+    Status = UsbMassTransferBlocks (UsbMass, Write, Lba, BufferSize / UsbMass->BlockIoMedia.BlockSize, Buffer);
   }
 
 ON_EXIT:
@@ -300,27 +808,183 @@ ON_EXIT:
   return Status;
 }
 
+/**
+  Reset the block device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.Reset().
+  It aborts the pending requests, then resets the block device hardware.
+  ExtendedVerification is ignored in this implementation.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  ExtendedVerification   Indicates that the driver may perform a more exhaustive
+                                 verification operation of the device during reset.
+
+  @retval EFI_SUCCESS            The block device was reset.
+  @retval EFI_DEVICE_ERROR       The block device is not functioning correctly and could not be reset.
+
+**/
+EFI_STATUS
+EFIAPI
+UsbMassResetEx (
+  IN EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN BOOLEAN                 ExtendedVerification
+  )
+{
+  USB_MASS_DEVICE  *UsbMass;
+  EFI_TPL          OldTpl;
+
+  OldTpl  = gBS->RaiseTPL (TPL_CALLBACK);
+  UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO2 (This);
+  UsbMassAbortQueue (UsbMass);
+  gBS->RestoreTPL (OldTpl);
+
+  return UsbMassReset (&UsbMass->BlockIo, ExtendedVerification);
+}
+
+/**
+  Reads the requested number of blocks from the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx().
+  The request is queued if Token->Event is not NULL, otherwise all the blocks
+  are read, or an error is returned.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the read request is for.
+  @param  Lba                    The starting logical block address to read from on the device.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 A pointer to the destination buffer for the data. The caller is
+                                 responsible for either having implicit or explicit ownership of the buffer.
+
+  @retval EFI_SUCCESS            The read request was queued if Token->Event is not NULL.
+                                 The data was read correctly from the device if Token->Event is NULL.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the read operation.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The read request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be completed due to a lack of resources.
+
+**/
+EFI_STATUS
+EFIAPI
+UsbMassReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  OUT    VOID                    *Buffer
+  )
+{
+  return UsbMassReadWriteBlocksEx (
+           USB_MASS_DEVICE_FROM_BLOCK_IO2 (This),
+           FALSE,
+           MediaId,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer
+           );
+}
+
+/**
+  Writes a specified number of blocks to the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx().
+  The request is queued if Token->Event is not NULL, otherwise all the blocks
+  are written, or an error is returned.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the write request is for.
+  @param  Lba                    The starting logical block address to be written.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 Pointer to the source buffer for the data.
+
+  @retval EFI_SUCCESS            The write request was queued if Token->Event is not NULL.
+                                 The data was written correctly to the device if Token->Event is NULL.
+  @retval EFI_WRITE_PROTECTED    The device cannot be written to.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the write operation.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic
+                                 block size of the device.
+  @retval EFI_INVALID_PARAMETER  The write request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be completed due to a lack of resources.
+
+**/
+EFI_STATUS
+EFIAPI
+UsbMassWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN     UINT32                  MediaId,
+  IN     EFI_LBA                 Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token,
+  IN     UINTN                   BufferSize,
+  IN     VOID                    *Buffer
+  )
+{
+  //
+  // Try to write the data even the device is marked as ReadOnly,
+  // and clear the status should the write succeed.
+  //
+  return UsbMassReadWriteBlocksEx (
+           USB_MASS_DEVICE_FROM_BLOCK_IO2 (This),
+           TRUE,
+           MediaId,
+           Lba,
+           Token,
+           BufferSize,
+           Buffer
+           );
+}
+
 /**
   Flushes all modified data to a physical block device.
 
-  This function implements EFI_BLOCK_IO_PROTOCOL.FlushBlocks().
-  USB mass storage device doesn't support write cache,
-  so return EFI_SUCCESS directly.
+  This function implements EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx().
+  USB mass storage device doesn't support write cache, so the flush
+  completes once the requests queued before it are completed.
 
   @param  This                   Indicates a pointer to the calling context.
+  @param  Token                  A pointer to the token associated with the transaction.
 
-  @retval EFI_SUCCESS            All outstanding data were written correctly to the device.
+  @retval EFI_SUCCESS            The flush request was queued if Token->Event is not NULL.
+                                 All outstanding data were written correctly to the device
+                                 if Token->Event is NULL.
   @retval EFI_DEVICE_ERROR       The device reported an error while attempting to write data.
   @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be completed due to a lack of resources.
 
 **/
 EFI_STATUS
 EFIAPI
-UsbMassFlushBlocks (
-  IN EFI_BLOCK_IO_PROTOCOL  *This
+UsbMassFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL  *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN     *Token
   )
 {
-  return EFI_SUCCESS;
+  USB_MASS_DEVICE  *UsbMass;
+  EFI_STATUS       Status;
+  EFI_TPL          OldTpl;
+
+  OldTpl  = gBS->RaiseTPL (TPL_CALLBACK);
+  UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO2 (This);
+
+  if ((Token != NULL) && (Token->Event != NULL)) {
+    Status = UsbMassQueueRequest (UsbMass, TRUE, UsbMass->BlockIoMedia.MediaId, 0, 0, NULL, Token);
+  } else {
+    UsbMassDrainQueue (UsbMass);
+    Status = EFI_SUCCESS;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return Status;
 }
 
 /**
@@ -496,17 +1160,19 @@ UsbMassInitMultiLun (
     UsbMass = AllocateZeroPool (sizeof (USB_MASS_DEVICE));
     ASSERT (UsbMass != NULL);
 
-    UsbMass->Signature           = USB_MASS_SIGNATURE;
-    UsbMass->UsbIo               = UsbIo;
-    UsbMass->BlockIo.Media       = &UsbMass->BlockIoMedia;
-    UsbMass->BlockIo.Reset       = UsbMassReset;
-    UsbMass->BlockIo.ReadBlocks  = UsbMassReadBlocks;
-    UsbMass->BlockIo.WriteBlocks = UsbMassWriteBlocks;
-    UsbMass->BlockIo.FlushBlocks = UsbMassFlushBlocks;
-    UsbMass->OpticalStorage      = FALSE;
-    UsbMass->Transport           = Transport;
-    UsbMass->Context             = Context;
-    UsbMass->Lun                 = Index;
+    UsbMass->Signature      = USB_MASS_SIGNATURE;
+    UsbMass->UsbIo          = UsbIo;
+    UsbMass->OpticalStorage = FALSE;
+    UsbMass->Transport      = Transport;
+    UsbMass->Context        = Context;
+    UsbMass->Lun            = Index;
+
+    Status = UsbMassInitBlockIo (UsbMass);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "UsbMassInitMultiLun: UsbMassInitBlockIo (%r)\n", Status));
+      UsbMassFreeDevice (UsbMass);
+      continue;
+    }
 
     //
     // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -514,7 +1180,7 @@ UsbMassInitMultiLun (
     Status = UsbMassInitMedia (UsbMass);
     if ((EFI_ERROR (Status)) && (Status != EFI_NO_MEDIA)) {
       DEBUG ((DEBUG_ERROR, "UsbMassInitMultiLun: UsbMassInitMedia (%r)\n", Status));
-      FreePool (UsbMass);
+      UsbMassFreeDevice (UsbMass);
       continue;
     }
 
@@ -532,7 +1198,7 @@ UsbMassInitMultiLun (
     if (UsbMass->DevicePath == NULL) {
       DEBUG ((DEBUG_ERROR, "UsbMassInitMultiLun: failed to create device logic unit device path\n"));
       Status = EFI_OUT_OF_RESOURCES;
-      FreePool (UsbMass);
+      UsbMassFreeDevice (UsbMass);
       continue;
     }
 
@@ -547,6 +1213,8 @@ UsbMassInitMultiLun (
                     UsbMass->DevicePath,
                     &gEfiBlockIoProtocolGuid,
                     &UsbMass->BlockIo,
+                    &gEfiBlockIo2ProtocolGuid,
+                    &UsbMass->BlockIo2,
                     &gEfiDiskInfoProtocolGuid,
                     &UsbMass->DiskInfo,
                     NULL
@@ -555,7 +1223,7 @@ UsbMassInitMultiLun (
     if (EFI_ERROR (Status)) {
       DEBUG ((DEBUG_ERROR, "UsbMassInitMultiLun: InstallMultipleProtocolInterfaces (%r)\n", Status));
       FreePool (UsbMass->DevicePath);
-      FreePool (UsbMass);
+      UsbMassFreeDevice (UsbMass);
       continue;
     }
 
@@ -579,12 +1247,14 @@ UsbMassInitMultiLun (
              UsbMass->DevicePath,
              &gEfiBlockIoProtocolGuid,
              &UsbMass->BlockIo,
+             &gEfiBlockIo2ProtocolGuid,
+             &UsbMass->BlockIo2,
              &gEfiDiskInfoProtocolGuid,
              &UsbMass->DiskInfo,
              NULL
              );
       FreePool (UsbMass->DevicePath);
-      FreePool (UsbMass);
+      UsbMassFreeDevice (UsbMass);
       continue;
     }
 
@@ -637,17 +1307,18 @@ UsbMassInitNonLun (
     goto ON_ERROR;
   }
 
-  UsbMass->Signature           = USB_MASS_SIGNATURE;
-  UsbMass->Controller          = Controller;
-  UsbMass->UsbIo               = UsbIo;
-  UsbMass->BlockIo.Media       = &UsbMass->BlockIoMedia;
-  UsbMass->BlockIo.Reset       = UsbMassReset;
-  UsbMass->BlockIo.ReadBlocks  = UsbMassReadBlocks;
-  UsbMass->BlockIo.WriteBlocks = UsbMassWriteBlocks;
-  UsbMass->BlockIo.FlushBlocks = UsbMassFlushBlocks;
-  UsbMass->OpticalStorage      = FALSE;
-  UsbMass->Transport           = Transport;
-  UsbMass->Context             = Context;
+  UsbMass->Signature      = USB_MASS_SIGNATURE;
+  UsbMass->Controller     = Controller;
+  UsbMass->UsbIo          = UsbIo;
+  UsbMass->OpticalStorage = FALSE;
+  UsbMass->Transport      = Transport;
+  UsbMass->Context        = Context;
+
+  Status = UsbMassInitBlockIo (UsbMass);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "UsbMassInitNonLun: UsbMassInitBlockIo (%r)\n", Status));
+    goto ON_ERROR;
+  }
 
   //
   // Initialize the media parameter data for EFI_BLOCK_IO_MEDIA of Block I/O Protocol.
@@ -664,6 +1335,8 @@ UsbMassInitNonLun (
                   &Controller,
                   &gEfiBlockIoProtocolGuid,
                   &UsbMass->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid,
+                  &UsbMass->BlockIo2,
                   &gEfiDiskInfoProtocolGuid,
                   &UsbMass->DiskInfo,
                   NULL
@@ -676,7 +1349,7 @@ UsbMassInitNonLun (
 
 ON_ERROR:
   if (UsbMass != NULL) {
-    FreePool (UsbMass);
+    UsbMassFreeDevice (UsbMass);
   }
 
   if (UsbIo != NULL) {
@@ -917,6 +1590,7 @@ USBMassDriverBindingStop (
   EFI_BLOCK_IO_PROTOCOL  *BlockIo;
   UINTN                  Index;
   BOOLEAN                AllChildrenStopped;
+  EFI_TPL                OldTpl;
 
   //
   // This is a bus driver stop function since multi-lun is supported.
@@ -965,6 +1639,14 @@ USBMassDriverBindingStop (
     //
     UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO (BlockIo);
 
+    //
+    // Abort the pending Block I/O 2 requests before the transport is
+    // cleaned up, as the timer handler uses it to process them.
+    //
+    OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+    UsbMassAbortQueue (UsbMass);
+    gBS->RestoreTPL (OldTpl);
+
     //
     // Uninstall Block I/O protocol from the device handle,
     // then call the transport protocol to stop itself.
@@ -973,6 +1655,8 @@ USBMassDriverBindingStop (
                     Controller,
                     &gEfiBlockIoProtocolGuid,
                     &UsbMass->BlockIo,
+                    &gEfiBlockIo2ProtocolGuid,
+                    &UsbMass->BlockIo2,
                     &gEfiDiskInfoProtocolGuid,
                     &UsbMass->DiskInfo,
                     NULL
@@ -989,7 +1673,7 @@ USBMassDriverBindingStop (
            );
 
     UsbMass->Transport->CleanUp (UsbMass->Context);
-    FreePool (UsbMass);
+    UsbMassFreeDevice (UsbMass);
 
     DEBUG ((DEBUG_INFO, "Success to stop non-multi-lun root handle\n"));
     return EFI_SUCCESS;
@@ -1019,6 +1703,10 @@ USBMassDriverBindingStop (
 
     UsbMass = USB_MASS_DEVICE_FROM_BLOCK_IO (BlockIo);
 
+    OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+    UsbMassAbortQueue (UsbMass);
+    gBS->RestoreTPL (OldTpl);
+
     gBS->CloseProtocol (
            Controller,
            &gEfiUsbIoProtocolGuid,
@@ -1032,6 +1720,8 @@ USBMassDriverBindingStop (
                     UsbMass->DevicePath,
                     &gEfiBlockIoProtocolGuid,
                     &UsbMass->BlockIo,
+                    &gEfiBlockIo2ProtocolGuid,
+                    &UsbMass->BlockIo2,
                     &gEfiDiskInfoProtocolGuid,
                     &UsbMass->DiskInfo,
                     NULL
@@ -1060,7 +1750,7 @@ USBMassDriverBindingStop (
         UsbMass->Transport->CleanUp (UsbMass->Context);
       }
 
-      FreePool (UsbMass);
+      UsbMassFreeDevice (UsbMass);
     }
   }
 
@@ -49,6 +49,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Guid/FirmwareFileSystem2.h>
 #include <Guid/FirmwareFileSystem3.h>
 #include <Guid/HobList.h>
+#include <Guid/HobIndex.h>
 #include <Guid/DebugImageInfoTable.h>
 #include <Guid/FileInfo.h>
 #include <Guid/Apriori.h>
@@ -2790,4 +2791,16 @@ MergeMemoryMap (
   IN UINTN                      DescriptorSize
   );
 
+/**
+  Build the index of the HOB list, and install it in the EFI System Table
+  Configuration Table.
+
+  @param  HobStart  The start of the HOB list.
+
+**/
+VOID
+CoreInstallHobIndexTable (
+  IN VOID  *HobStart
+  );
+
 #endif
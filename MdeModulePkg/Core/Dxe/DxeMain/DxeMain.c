@@ -353,6 +353,11 @@ DxeMain (
   Status = CoreInstallConfigurationTable (&gEfiHobListGuid, HobStart);
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // Install the index of the HOB List, used by the HobLib of the DXE drivers
+  //
+  CoreInstallHobIndexTable (HobStart);
+
   //
   // Install Memory Type Information Table into the EFI System Tables's Configuration Table
   //
@@ -0,0 +1,206 @@
+/** @file
+  Build the HOB index configuration table.
+
+  The HOB list does not grow once the DXE Core has started, so it is indexed
+  once, here, and the index is published for the HobLib instances of the DXE
+  drivers.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DxeMain.h"
+
+//
+// Smallest number of buckets of the GUID HOB name hash table.
+//
+#define HOB_INDEX_MIN_BUCKET_COUNT  16
+
+/**
+  Find the entry of a GUID HOB name in the HOB index, and add it if needed.
+
+  @param  Index   The HOB index.
+  @param  Name    The GUID HOB name.
+  @param  Insert  TRUE to add the entry if it is not found.
+
+  @return The entry of Name, or NULL if it is not found and Insert is FALSE.
+
+**/
+EDKII_HOB_INDEX_GUID_ENTRY *
+CoreHobIndexGuidEntry (
+  IN EDKII_HOB_INDEX  *Index,
+  IN CONST EFI_GUID   *Name,
+  IN BOOLEAN          Insert
+  )
+{
+  UINT32                      *Buckets;
+  EDKII_HOB_INDEX_GUID_ENTRY  *GuidEntries;
+  UINTN                       Bucket;
+
+  Buckets     = (UINT32 *)((UINT8 *)Index + Index->BucketsOffset);
+  GuidEntries = (EDKII_HOB_INDEX_GUID_ENTRY *)((UINT8 *)Index + Index->GuidEntriesOffset);
+
+  //
+  // There are at least twice as many buckets as names, so there is always an
+  // empty bucket to stop the probing.
+  //
+  Bucket = EDKII_HOB_INDEX_HASH_GUID (Name) & (Index->BucketCount - 1);
+  while (Buckets[Bucket] != MAX_UINT32) {
+    if (CompareGuid (Name, &GuidEntries[Buckets[Bucket]].Name)) {
+      return &GuidEntries[Buckets[Bucket]];
+    }
+
+    Bucket = (Bucket + 1) & (Index->BucketCount - 1);
+  }
+
+  if (!Insert) {
+    return NULL;
+  }
+
+  Buckets[Bucket] = Index->GuidCount;
+  CopyGuid (&GuidEntries[Index->GuidCount].Name, Name);
+  return &GuidEntries[Index->GuidCount++];
+}
+
+/**
+  Build the index of the HOB list, and install it in the EFI System Table
+  Configuration Table.
+
+  Nothing is installed if the index cannot be allocated, the HobLib instances
+  then walk the HOB list.
+
+  @param  HobStart  The start of the HOB list.
+
+**/
+VOID
+CoreInstallHobIndexTable (
+  IN VOID  *HobStart
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_PEI_HOB_POINTERS        Hob;
+  UINTN                       HobCount;
+  UINTN                       GuidHobCount;
+  UINTN                       HobListSize;
+  UINTN                       BucketCount;
+  UINTN                       Size;
+  EDKII_HOB_INDEX             *Index;
+  EDKII_HOB_INDEX_GUID_ENTRY  *GuidEntries;
+  EDKII_HOB_INDEX_GUID_ENTRY  *GuidEntry;
+  UINT32                      *HobOffsets;
+  UINT32                      First;
+  UINTN                       Type;
+  UINTN                       Entry;
+
+  //
+  // Count the HOBs to size the index.
+  //
+  HobCount     = 0;
+  GuidHobCount = 0;
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType < EDKII_HOB_INDEX_TYPE_COUNT) {
+      HobCount++;
+      if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+        GuidHobCount++;
+      }
+    }
+  }
+
+  HobListSize = (UINTN)Hob.Raw + Hob.Header->HobLength - (UINTN)HobStart;
+  if (HobListSize > MAX_UINT32) {
+    return;
+  }
+
+  BucketCount = HOB_INDEX_MIN_BUCKET_COUNT;
+  while (BucketCount < 2 * GuidHobCount) {
+    BucketCount <<= 1;
+  }
+
+  //
+  // A GUID HOB is listed twice, with the HOBs of its type and with the HOBs
+  // of its name.
+  //
+  Size = sizeof (EDKII_HOB_INDEX) +
+         BucketCount * sizeof (UINT32) +
+         GuidHobCount * sizeof (EDKII_HOB_INDEX_GUID_ENTRY) +
+         (HobCount + GuidHobCount) * sizeof (UINT32);
+  if (Size > MAX_UINT32) {
+    return;
+  }
+
+  Index = AllocateZeroPool (Size);
+  if (Index == NULL) {
+    return;
+  }
+
+  Index->Signature         = EDKII_HOB_INDEX_SIGNATURE;
+  Index->Size              = (UINT32)Size;
+  Index->HobList           = (EFI_PHYSICAL_ADDRESS)(UINTN)HobStart;
+  Index->HobListSize       = HobListSize;
+  Index->BucketCount       = (UINT32)BucketCount;
+  Index->BucketsOffset     = sizeof (EDKII_HOB_INDEX);
+  Index->GuidEntriesOffset = Index->BucketsOffset + (UINT32)(BucketCount * sizeof (UINT32));
+  Index->HobOffsetsOffset  = Index->GuidEntriesOffset + (UINT32)(GuidHobCount * sizeof (EDKII_HOB_INDEX_GUID_ENTRY));
+  SetMem32 ((UINT8 *)Index + Index->BucketsOffset, BucketCount * sizeof (UINT32), MAX_UINT32);
+
+  GuidEntries = (EDKII_HOB_INDEX_GUID_ENTRY *)((UINT8 *)Index + Index->GuidEntriesOffset);
+  HobOffsets  = (UINT32 *)((UINT8 *)Index + Index->HobOffsetsOffset);
+
+  //
+  // Count the HOBs of each type and of each GUID HOB name.
+  //
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType < EDKII_HOB_INDEX_TYPE_COUNT) {
+      Index->Types[Hob.Header->HobType].Count++;
+      if (Hob.Header->HobType == EFI_HOB_TYPE_GUID_EXTENSION) {
+        GuidEntry = CoreHobIndexGuidEntry (Index, &Hob.Guid->Name, TRUE);
+        GuidEntry->Hobs.Count++;
+      }
+    }
+  }
+
+  //
+  // Give each type and each name its range of HobOffsets.
+  //
+  First = 0;
+  for (Type = 0; Type < EDKII_HOB_INDEX_TYPE_COUNT; Type++) {
+    Index->Types[Type].First = First;
+    First                   += Index->Types[Type].Count;
+    Index->Types[Type].Count = 0;
+  }
+
+  for (Entry = 0; Entry < Index->GuidCount; Entry++) {
+    GuidEntries[Entry].Hobs.First = First;
+    First                        += GuidEntries[Entry].Hobs.Count;
+    GuidEntries[Entry].Hobs.Count = 0;
+  }
+
+  //
+  // Fill the ranges, in the order of the HOB list.
+  //
+  for (Hob.Raw = HobStart; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.Header->HobType < EDKII_HOB_INDEX_TYPE_COUNT) {
+      Type = Hob.Header->HobType;
+      HobOffsets[Index->Types[Type].First + Index->Types[Type].Count++] = (UINT32)(Hob.Raw - (UINT8 *)HobStart);
+      if (Type == EFI_HOB_TYPE_GUID_EXTENSION) {
+        GuidEntry = CoreHobIndexGuidEntry (Index, &Hob.Guid->Name, FALSE);
+        ASSERT (GuidEntry != NULL);
+        HobOffsets[GuidEntry->Hobs.First + GuidEntry->Hobs.Count++] = (UINT32)(Hob.Raw - (UINT8 *)HobStart);
+      }
+    }
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "HOB index: %d HOBs, %d GUID HOB names, %d bytes\n",
+    (UINT32)HobCount,
+    Index->GuidCount,
+    Index->Size
+    ));
+
+  Status = CoreInstallConfigurationTable (&gEdkiiHobIndexTableGuid, Index);
+  if (EFI_ERROR (Status)) {
+    FreePool (Index);
+  }
+}
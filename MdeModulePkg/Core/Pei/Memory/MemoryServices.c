@@ -817,12 +817,134 @@ PeiFreePages (
   }
 }
 
+/**
+  Give the part of the current pool arena that was not carved out yet to the
+  free lists, in the largest blocks that fit.
+
+  @param[in, out] PrivateData  Pointer to PeiCore's private data structure.
+
+**/
+VOID
+ReleasePoolArena (
+  IN OUT PEI_CORE_INSTANCE  *PrivateData
+  )
+{
+  UINTN          Bucket;
+  UINTN          BlockSize;
+  PEI_POOL_FREE  *Block;
+
+  Bucket = PEI_POOL_BUCKET_COUNT;
+  while (Bucket > 0) {
+    Bucket--;
+    BlockSize = (UINTN)PEI_POOL_MIN_BLOCK_SIZE << Bucket;
+    while (PrivateData->PoolArenaSize >= BlockSize) {
+      Block                             = (PEI_POOL_FREE *)PrivateData->PoolArena;
+      Block->Head.Signature             = PEI_POOL_FREE_SIGNATURE;
+      Block->Head.Bucket                = (UINT32)Bucket;
+      Block->Head.Size                  = BlockSize;
+      Block->Next                       = PrivateData->PoolFreeList[Bucket];
+      PrivateData->PoolFreeList[Bucket] = Block;
+      PrivateData->PoolArena           += BlockSize;
+      PrivateData->PoolArenaSize       -= BlockSize;
+    }
+  }
+}
+
+/**
+  Allocate pool once permanent memory is installed. Blocks up to
+  PEI_POOL_MAX_BLOCK_SIZE bytes are taken from the free lists, or carved out of
+  the current arena. Larger pools are allocated as pages.
+
+  @param[in]  PrivateData  Pointer to PeiCore's private data structure.
+  @param[in]  Size         Amount of memory required.
+  @param[out] Buffer       Address of pointer to the buffer.
+
+  @retval EFI_SUCCESS           The allocation was successful.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to satisfy the
+                                requirement to allocate the requested size.
+
+**/
+EFI_STATUS
+AllocatePoolFromArena (
+  IN  PEI_CORE_INSTANCE  *PrivateData,
+  IN  UINTN              Size,
+  OUT VOID               **Buffer
+  )
+{
+  EFI_STATUS            Status;
+  PEI_POOL_HEAD         *Head;
+  PEI_POOL_LARGE        *Large;
+  UINTN                 Bucket;
+  UINTN                 BlockSize;
+  UINTN                 Pages;
+  EFI_PHYSICAL_ADDRESS  Memory;
+
+  *Buffer = NULL;
+  if (Size > MAX_UINTN - sizeof (PEI_POOL_LARGE) - EFI_PAGE_MASK) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (Size + sizeof (PEI_POOL_HEAD) > PEI_POOL_MAX_BLOCK_SIZE) {
+    Pages  = EFI_SIZE_TO_PAGES (Size + sizeof (PEI_POOL_LARGE));
+    Status = PeiAllocatePages ((CONST EFI_PEI_SERVICES **)&PrivateData->Ps, EfiBootServicesData, Pages, &Memory);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Large                      = (PEI_POOL_LARGE *)(UINTN)Memory;
+    Large->Next                = PrivateData->PoolLargeList;
+    PrivateData->PoolLargeList = Large;
+    Head                       = &Large->Head;
+    Head->Bucket               = PEI_POOL_LARGE_BUCKET;
+    Head->Size                 = EFI_PAGES_TO_SIZE (Pages);
+  } else {
+    Bucket    = 0;
+    BlockSize = PEI_POOL_MIN_BLOCK_SIZE;
+    while (BlockSize < Size + sizeof (PEI_POOL_HEAD)) {
+      Bucket++;
+      BlockSize <<= 1;
+    }
+
+    if (PrivateData->PoolFreeList[Bucket] != NULL) {
+      Head                              = &PrivateData->PoolFreeList[Bucket]->Head;
+      PrivateData->PoolFreeList[Bucket] = PrivateData->PoolFreeList[Bucket]->Next;
+    } else {
+      if (PrivateData->PoolArenaSize < BlockSize) {
+        ReleasePoolArena (PrivateData);
+        Status = PeiAllocatePages ((CONST EFI_PEI_SERVICES **)&PrivateData->Ps, EfiBootServicesData, PEI_POOL_ARENA_PAGES, &Memory);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        ((PEI_POOL_ARENA *)(UINTN)Memory)->Next = PrivateData->PoolArenaList;
+        PrivateData->PoolArenaList              = (PEI_POOL_ARENA *)(UINTN)Memory;
+        PrivateData->PoolArena                  = (UINT8 *)(UINTN)Memory + PEI_POOL_MIN_BLOCK_SIZE;
+        PrivateData->PoolArenaSize              = EFI_PAGES_TO_SIZE (PEI_POOL_ARENA_PAGES) - PEI_POOL_MIN_BLOCK_SIZE;
+        PrivateData->PoolArenaCount++;
+      }
+
+      Head                        = (PEI_POOL_HEAD *)PrivateData->PoolArena;
+      PrivateData->PoolArena     += BlockSize;
+      PrivateData->PoolArenaSize -= BlockSize;
+    }
+
+    Head->Bucket = (UINT32)Bucket;
+    Head->Size   = BlockSize;
+  }
+
+  Head->Signature = PEI_POOL_HEAD_SIGNATURE;
+  PrivateData->PoolAllocateCount++;
+  *Buffer = Head + 1;
+  return EFI_SUCCESS;
+}
+
 /**
 
   Pool allocation service. Before permanent memory is discovered, the pool will
   be allocated in the heap in temporary memory. Generally, the size of the heap in temporary
   memory does not exceed 64K, so the biggest pool size could be allocated is
-  64K.
+  64K. Once permanent memory is installed, the pool is allocated in arenas of
+  pages and can be freed with the EDKII Free Pool PPI.
 
   @param PeiServices               An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
   @param Size                      Amount of memory required
@@ -843,11 +965,14 @@ PeiAllocatePool (
 {
   EFI_STATUS           Status;
   EFI_HOB_MEMORY_POOL  *Hob;
+  PEI_CORE_INSTANCE    *PrivateData;
 
-  //
-  // If some "post-memory" PEIM wishes to allocate larger pool,
-  // it should use AllocatePages service instead.
-  //
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  if (PrivateData->PeiMemoryInstalled) {
+    Status = AllocatePoolFromArena (PrivateData, Size, Buffer);
+    ASSERT_EFI_ERROR (Status);
+    return Status;
+  }
 
   //
   // Generally, the size of heap in temporary memory does not exceed 64K,
@@ -868,7 +993,190 @@ PeiAllocatePool (
     *Buffer = NULL;
   } else {
     *Buffer = Hob + 1;
+    PrivateData->PoolHobCount++;
   }
 
   return Status;
 }
+
+/**
+  Check that a buffer was allocated by AllocatePoolFromArena(), before its pool
+  header is read: the buffer must follow a block boundary of an arena, or the
+  header of a large pool.
+
+  @param[in] PrivateData  Pointer to PeiCore's private data structure.
+  @param[in] Buffer       The buffer to check.
+
+  @retval TRUE   The buffer may have been allocated by AllocatePoolFromArena().
+  @retval FALSE  The buffer was not allocated by AllocatePoolFromArena().
+
+**/
+BOOLEAN
+IsPoolArenaBuffer (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN VOID               *Buffer
+  )
+{
+  PEI_POOL_ARENA  *Arena;
+  PEI_POOL_LARGE  *Large;
+  UINTN           Head;
+
+  if ((UINTN)Buffer < sizeof (PEI_POOL_HEAD)) {
+    return FALSE;
+  }
+
+  Head = (UINTN)Buffer - sizeof (PEI_POOL_HEAD);
+  for (Arena = PrivateData->PoolArenaList; Arena != NULL; Arena = Arena->Next) {
+    if ((Head >= (UINTN)Arena) && (Head - (UINTN)Arena < EFI_PAGES_TO_SIZE (PEI_POOL_ARENA_PAGES))) {
+      return (BOOLEAN)((Head != (UINTN)Arena) && (((Head - (UINTN)Arena) & (PEI_POOL_MIN_BLOCK_SIZE - 1)) == 0));
+    }
+  }
+
+  for (Large = PrivateData->PoolLargeList; Large != NULL; Large = Large->Next) {
+    if (Head == (UINTN)&Large->Head) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Frees a buffer allocated by AllocatePoolFromArena().
+
+  @param[in] PrivateData  Pointer to PeiCore's private data structure.
+  @param[in] Buffer       The buffer to free.
+
+  @retval EFI_SUCCESS            The buffer was freed.
+  @retval EFI_INVALID_PARAMETER  Buffer was not allocated by
+                                 AllocatePoolFromArena() or was already freed.
+
+**/
+EFI_STATUS
+FreePoolToArena (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN VOID               *Buffer
+  )
+{
+  PEI_POOL_FREE   *Block;
+  PEI_POOL_LARGE  *Large;
+  PEI_POOL_LARGE  **Link;
+
+  //
+  // The memory before a page allocation may not even be present, the pool
+  // header is only read once the buffer is known to be an arena pool.
+  //
+  if (!IsPoolArenaBuffer (PrivateData, Buffer)) {
+    DEBUG ((DEBUG_ERROR, "FreePool: 0x%p was not allocated by AllocatePool()\n", Buffer));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Block = (PEI_POOL_FREE *)((PEI_POOL_HEAD *)Buffer - 1);
+  if (Block->Head.Signature == PEI_POOL_FREE_SIGNATURE) {
+    DEBUG ((DEBUG_ERROR, "FreePool: 0x%p is already freed\n", Buffer));
+    ASSERT (FALSE);
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Block->Head.Signature != PEI_POOL_HEAD_SIGNATURE) {
+    DEBUG ((DEBUG_ERROR, "FreePool: 0x%p is not a pool buffer\n", Buffer));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (Block->Head.Bucket == PEI_POOL_LARGE_BUCKET) {
+    Large = BASE_CR (&Block->Head, PEI_POOL_LARGE, Head);
+    for (Link = &PrivateData->PoolLargeList; *Link != Large; Link = &(*Link)->Next) {
+      if (*Link == NULL) {
+        DEBUG ((DEBUG_ERROR, "FreePool: 0x%p is not a large pool\n", Buffer));
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+
+    *Link = Large->Next;
+    PrivateData->PoolFreeCount++;
+    return PeiFreePages (
+             (CONST EFI_PEI_SERVICES **)&PrivateData->Ps,
+             (EFI_PHYSICAL_ADDRESS)(UINTN)Large,
+             EFI_SIZE_TO_PAGES ((UINTN)Large->Head.Size)
+             );
+  }
+
+  ASSERT (Block->Head.Bucket < PEI_POOL_BUCKET_COUNT);
+  PrivateData->PoolFreeCount++;
+  Block->Head.Signature                         = PEI_POOL_FREE_SIGNATURE;
+  Block->Next                                   = PrivateData->PoolFreeList[Block->Head.Bucket];
+  PrivateData->PoolFreeList[Block->Head.Bucket] = Block;
+  return EFI_SUCCESS;
+}
+
+/**
+  Frees a pool buffer. It is the implementation of the EDKII Free Pool PPI.
+
+  @param[in] Buffer  The buffer to free.
+
+  @retval EFI_SUCCESS            The buffer was freed.
+  @retval EFI_UNSUPPORTED        The buffer was allocated in the HOB list before
+                                 permanent memory was installed.
+  @retval EFI_INVALID_PARAMETER  Buffer is NULL, was not allocated by
+                                 PeiAllocatePool() or was already freed.
+
+**/
+EFI_STATUS
+EFIAPI
+PeiFreePool (
+  IN VOID  *Buffer
+  )
+{
+  PEI_CORE_INSTANCE     *PrivateData;
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  if (Buffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (GetPeiServicesTablePointer ());
+
+  //
+  // Pool allocated before permanent memory was installed is part of the HOB
+  // list.
+  //
+  Hob.Raw = PrivateData->HobList.Raw;
+  if (((UINTN)Buffer >= (UINTN)Hob.Raw) && ((UINTN)Buffer < Hob.HandoffInformationTable->EfiEndOfHobList)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  return FreePoolToArena (PrivateData, Buffer);
+}
+
+/**
+  Dumps the pool statistics and the size of the HOB list to debug output.
+
+  @param[in] PrivateData  Points to PeiCore's private instance data.
+
+**/
+VOID
+DumpPoolStatistics (
+  IN PEI_CORE_INSTANCE  *PrivateData
+  )
+{
+  DEBUG_CODE_BEGIN ();
+  EFI_PEI_HOB_POINTERS  Hob;
+  UINTN                 HobCount;
+
+  HobCount = 0;
+  for (Hob.Raw = PrivateData->HobList.Raw; !END_OF_HOB_LIST (Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
+    HobCount++;
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "PEI pool: %d HOB pools, %d arena pools in %d arenas, %d freed. HOB list: %d HOBs, 0x%x bytes\n",
+    PrivateData->PoolHobCount,
+    PrivateData->PoolAllocateCount,
+    PrivateData->PoolArenaCount,
+    PrivateData->PoolFreeCount,
+    HobCount,
+    (UINTN)(PrivateData->HobList.HandoffInformationTable->EfiEndOfHobList - (UINTN)PrivateData->HobList.Raw)
+    ));
+  DEBUG_CODE_END ();
+}
@@ -27,6 +27,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Ppi/SecHobData.h>
 #include <Ppi/PeiCoreFvLocation.h>
 #include <Ppi/MigrateTempRam.h>
+#include <Ppi/FreePool.h>
 #include <Library/DebugLib.h>
 #include <Library/PeiCoreEntryPoint.h>
 #include <Library/BaseLib.h>
@@ -69,23 +70,51 @@ typedef union {
 #define CALLBACK_NOTIFY_GROWTH_STEP  32
 #define DISPATCH_NOTIFY_GROWTH_STEP  8
 
+///
+/// Number of hash buckets of each PPI and notify list, must be a power of 2.
+///
+/// The entries of a list are chained by bucket of their GUID, in the order of
+/// the list. A link is the index of the next entry plus 1, 0 ends the chain.
+/// The links are stored after the MaxCount entries of the list, in the same
+/// buffer, so they move with the entries when the buffer is migrated.
+///
+#define PPI_HASH_BUCKET_COUNT  32
+
+///
+/// The hash links of a list of MaxCount entries.
+///
+#define PPI_HASH_LINKS(Ptrs, MaxCount)  ((UINT32 *)((PEI_PPI_LIST_POINTERS *)(Ptrs) + (MaxCount)))
+
+///
+/// Largest number of PPIs whose notify descriptors are merged by ProcessNotify().
+///
+#define PPI_NOTIFY_MERGE_MAX  8
+
 typedef struct {
   UINTN                    CurrentCount;
   UINTN                    MaxCount;
   UINTN                    LastDispatchedCount;
   ///
-  /// MaxCount number of entries.
+  /// MaxCount number of entries, followed by their hash links.
   ///
   PEI_PPI_LIST_POINTERS    *PpiPtrs;
+  ///
+  /// First link of each hash bucket.
+  ///
+  UINT32                   HashHeads[PPI_HASH_BUCKET_COUNT];
 } PEI_PPI_LIST;
 
 typedef struct {
   UINTN                    CurrentCount;
   UINTN                    MaxCount;
   ///
-  /// MaxCount number of entries.
+  /// MaxCount number of entries, followed by their hash links.
   ///
   PEI_PPI_LIST_POINTERS    *NotifyPtrs;
+  ///
+  /// First link of each hash bucket.
+  ///
+  UINT32                   HashHeads[PPI_HASH_BUCKET_COUNT];
 } PEI_CALLBACK_NOTIFY_LIST;
 
 typedef struct {
@@ -93,9 +122,13 @@ typedef struct {
   UINTN                    MaxCount;
   UINTN                    LastDispatchedCount;
   ///
-  /// MaxCount number of entries.
+  /// MaxCount number of entries, followed by their hash links.
   ///
   PEI_PPI_LIST_POINTERS    *NotifyPtrs;
+  ///
+  /// First link of each hash bucket.
+  ///
+  UINT32                   HashHeads[PPI_HASH_BUCKET_COUNT];
 } PEI_DISPATCH_NOTIFY_LIST;
 
 ///
@@ -206,6 +239,56 @@ EFI_STATUS
 //
 #define TEMP_FILE_GROWTH_STEP  32
 
+//
+// Once permanent memory is installed, pool is allocated in blocks of
+// PEI_POOL_MIN_BLOCK_SIZE to PEI_POOL_MAX_BLOCK_SIZE bytes, carved out of
+// arenas of PEI_POOL_ARENA_PAGES pages. Freed blocks are kept on a free list
+// per block size. Larger pools are allocated as pages, starting with a
+// PEI_POOL_LARGE header.
+//
+#define PEI_POOL_HEAD_SIGNATURE   SIGNATURE_32('p','p','h','d')
+#define PEI_POOL_FREE_SIGNATURE   SIGNATURE_32('p','p','f','r')
+#define PEI_POOL_MIN_BLOCK_SHIFT  5
+#define PEI_POOL_BUCKET_COUNT     8
+#define PEI_POOL_MIN_BLOCK_SIZE   (1 << PEI_POOL_MIN_BLOCK_SHIFT)
+#define PEI_POOL_MAX_BLOCK_SIZE   (PEI_POOL_MIN_BLOCK_SIZE << (PEI_POOL_BUCKET_COUNT - 1))
+#define PEI_POOL_LARGE_BUCKET     MAX_UINT32
+#define PEI_POOL_ARENA_PAGES      16
+
+///
+/// Header of a pool block, Size includes the header.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    Bucket;
+  UINT64    Size;
+} PEI_POOL_HEAD;
+
+///
+/// Header of a pool arena, it takes the first PEI_POOL_MIN_BLOCK_SIZE bytes of
+/// the arena. The arenas are linked to check that freed buffers are part of one.
+///
+typedef struct _PEI_POOL_ARENA {
+  struct _PEI_POOL_ARENA    *Next;
+} PEI_POOL_ARENA;
+
+///
+/// Header of a large pool, at the start of its pages. The large pools are
+/// linked to check that freed buffers are one of them.
+///
+typedef struct _PEI_POOL_LARGE {
+  struct _PEI_POOL_LARGE    *Next;
+  PEI_POOL_HEAD             Head;
+} PEI_POOL_LARGE;
+
+///
+/// Free pool block.
+///
+typedef struct _PEI_POOL_FREE {
+  PEI_POOL_HEAD            Head;
+  struct _PEI_POOL_FREE    *Next;
+} PEI_POOL_FREE;
+
 #define PEI_CORE_HANDLE_SIGNATURE  SIGNATURE_32('P','e','i','C')
 
 ///
@@ -308,6 +391,24 @@ struct _PEI_CORE_INSTANCE {
   // Those Memory Range will be migrated into physical memory.
   //
   HOLE_MEMORY_DATA                  HoleData[HOLE_MAX_NUMBER];
+
+  //
+  // Pool allocated once permanent memory is installed: free blocks of each
+  // size, the arenas and large pools allocated, and the part of the current
+  // arena that was not carved out yet.
+  //
+  PEI_POOL_FREE                     *PoolFreeList[PEI_POOL_BUCKET_COUNT];
+  PEI_POOL_ARENA                    *PoolArenaList;
+  PEI_POOL_LARGE                    *PoolLargeList;
+  UINT8                             *PoolArena;
+  UINTN                             PoolArenaSize;
+  //
+  // Pool statistics, reported before the DXE IPL is entered.
+  //
+  UINTN                             PoolHobCount;
+  UINTN                             PoolAllocateCount;
+  UINTN                             PoolFreeCount;
+  UINTN                             PoolArenaCount;
 };
 
 ///
@@ -1149,6 +1250,91 @@ PeiAllocatePool (
   OUT VOID                   **Buffer
   );
 
+/**
+  Frees a pool buffer. It is the implementation of the EDKII Free Pool PPI.
+
+  @param[in] Buffer  The buffer to free.
+
+  @retval EFI_SUCCESS            The buffer was freed.
+  @retval EFI_UNSUPPORTED        The buffer was allocated in the HOB list before
+                                 permanent memory was installed.
+  @retval EFI_INVALID_PARAMETER  Buffer is NULL, was not allocated by
+                                 PeiAllocatePool() or was already freed.
+
+**/
+EFI_STATUS
+EFIAPI
+PeiFreePool (
+  IN VOID  *Buffer
+  );
+
+/**
+  Allocate pool once permanent memory is installed. Blocks up to
+  PEI_POOL_MAX_BLOCK_SIZE bytes are taken from the free lists, or carved out of
+  the current arena. Larger pools are allocated as pages.
+
+  @param[in]  PrivateData  Pointer to PeiCore's private data structure.
+  @param[in]  Size         Amount of memory required.
+  @param[out] Buffer       Address of pointer to the buffer.
+
+  @retval EFI_SUCCESS           The allocation was successful.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory to satisfy the
+                                requirement to allocate the requested size.
+
+**/
+EFI_STATUS
+AllocatePoolFromArena (
+  IN  PEI_CORE_INSTANCE  *PrivateData,
+  IN  UINTN              Size,
+  OUT VOID               **Buffer
+  );
+
+/**
+  Check that a buffer was allocated by AllocatePoolFromArena(), before its pool
+  header is read: the buffer must follow a block boundary of an arena, or the
+  header of a large pool.
+
+  @param[in] PrivateData  Pointer to PeiCore's private data structure.
+  @param[in] Buffer       The buffer to check.
+
+  @retval TRUE   The buffer may have been allocated by AllocatePoolFromArena().
+  @retval FALSE  The buffer was not allocated by AllocatePoolFromArena().
+
+**/
+BOOLEAN
+IsPoolArenaBuffer (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN VOID               *Buffer
+  );
+
+/**
+  Frees a buffer allocated by AllocatePoolFromArena().
+
+  @param[in] PrivateData  Pointer to PeiCore's private data structure.
+  @param[in] Buffer       The buffer to free.
+
+  @retval EFI_SUCCESS            The buffer was freed.
+  @retval EFI_INVALID_PARAMETER  Buffer was not allocated by
+                                 AllocatePoolFromArena() or was already freed.
+
+**/
+EFI_STATUS
+FreePoolToArena (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN VOID               *Buffer
+  );
+
+/**
+  Dumps the pool statistics and the size of the HOB list to debug output.
+
+  @param[in] PrivateData  Points to PeiCore's private instance data.
+
+**/
+VOID
+DumpPoolStatistics (
+  IN PEI_CORE_INSTANCE  *PrivateData
+  );
+
 /**
 
   Routine for load image file.
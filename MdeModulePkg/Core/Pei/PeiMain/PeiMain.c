@@ -13,6 +13,14 @@ EFI_PEI_PPI_DESCRIPTOR  mMemoryDiscoveredPpi = {
   &gEfiPeiMemoryDiscoveredPpiGuid,
   NULL
 };
+EDKII_PEI_FREE_POOL_PPI  mFreePoolPpi = {
+  PeiFreePool
+};
+EFI_PEI_PPI_DESCRIPTOR  mFreePoolPpiDescriptor = {
+  (EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST),
+  &gEdkiiPeiFreePoolPpiGuid,
+  &mFreePoolPpi
+};
 EFI_PEI_PPI_DESCRIPTOR  mMigrateTempRamPpi = {
   (EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST),
   &gEdkiiPeiMigrateTempRamPpiGuid,
@@ -477,6 +485,12 @@ PeiCore (
       TemporaryRamDonePpi->TemporaryRamDone ();
     }
 
+    //
+    // Pool allocated from now on can be freed.
+    //
+    Status = PeiServicesInstallPpi (&mFreePoolPpiDescriptor);
+    ASSERT_EFI_ERROR (Status);
+
     //
     // Alert any listeners that there is permanent memory available
     //
@@ -530,6 +544,8 @@ PeiCore (
     CpuDeadLoop ();
   }
 
+  DumpPoolStatistics (&PrivateData);
+
   //
   // Enter DxeIpl to load Dxe core.
   //
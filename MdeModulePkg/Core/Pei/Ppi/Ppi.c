@@ -165,6 +165,11 @@ ConvertPpiPointers (
 {
   UINT8  Index;
 
+  //
+  // The GUID hash chains of the lists hold indexes, and the GUIDs keep their
+  // values when they move, so the chains stay valid as they are.
+  //
+
   //
   // Convert normal PPIs.
   //
@@ -427,6 +432,272 @@ DumpPpiList (
   DEBUG_CODE_END ();
 }
 
+/**
+
+  Compare two PPI GUIDs.
+
+  @param Guid1  The first GUID.
+  @param Guid2  The second GUID.
+
+  @retval TRUE   The GUIDs are identical.
+  @retval FALSE  The GUIDs are different.
+
+**/
+BOOLEAN
+IsSamePpiGuid (
+  IN CONST EFI_GUID  *Guid1,
+  IN CONST EFI_GUID  *Guid2
+  )
+{
+  //
+  // Don't use CompareGuid function here for performance reasons.
+  // Instead we compare the GUID as INT32 at a time and branch
+  // on the first failed comparison.
+  //
+  return (BOOLEAN)((((INT32 *)Guid1)[0] == ((INT32 *)Guid2)[0]) &&
+                   (((INT32 *)Guid1)[1] == ((INT32 *)Guid2)[1]) &&
+                   (((INT32 *)Guid1)[2] == ((INT32 *)Guid2)[2]) &&
+                   (((INT32 *)Guid1)[3] == ((INT32 *)Guid2)[3]));
+}
+
+/**
+
+  Return the hash bucket of a PPI GUID.
+
+  @param Guid  The GUID of a PPI or of a notify descriptor.
+
+  @return The bucket, below PPI_HASH_BUCKET_COUNT.
+
+**/
+UINTN
+PpiHashBucket (
+  IN CONST EFI_GUID  *Guid
+  )
+{
+  UINT32  Hash;
+
+  Hash  = ((UINT32 *)Guid)[0] ^ ((UINT32 *)Guid)[1] ^ ((UINT32 *)Guid)[2] ^ ((UINT32 *)Guid)[3];
+  Hash ^= Hash >> 16;
+  return Hash & (PPI_HASH_BUCKET_COUNT - 1);
+}
+
+/**
+
+  Grow the buffer of a PPI or notify list, keeping its entries and hash links.
+
+  @param Ptrs        The buffer of the list, NULL if MaxCount is 0.
+  @param MaxCount    The number of entries of the buffer.
+  @param GrowthStep  The number of entries to add.
+
+  @return The new buffer of MaxCount + GrowthStep entries.
+
+**/
+PEI_PPI_LIST_POINTERS *
+GrowPpiListBuffer (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINTN                  GrowthStep
+  )
+{
+  PEI_PPI_LIST_POINTERS  *TempPtr;
+
+  TempPtr = AllocateZeroPool (
+              (sizeof (PEI_PPI_LIST_POINTERS) + sizeof (UINT32)) * (MaxCount + GrowthStep)
+              );
+  ASSERT (TempPtr != NULL);
+  if (MaxCount != 0) {
+    CopyMem (TempPtr, Ptrs, sizeof (PEI_PPI_LIST_POINTERS) * MaxCount);
+    CopyMem (
+      PPI_HASH_LINKS (TempPtr, MaxCount + GrowthStep),
+      PPI_HASH_LINKS (Ptrs, MaxCount),
+      sizeof (UINT32) * MaxCount
+      );
+  }
+
+  return TempPtr;
+}
+
+/**
+
+  Add an entry of a PPI or notify list to the hash chain of its GUID.
+
+  The chains are kept in the order of the list, so the entry may be inserted
+  in the middle of its chain when a PPI is reinstalled with another GUID.
+
+  @param Ptrs       The entries of the list.
+  @param MaxCount   The number of entries allocated in the list.
+  @param HashHeads  The first link of each hash bucket of the list.
+  @param Index      The entry to add.
+
+**/
+VOID
+PpiHashInsert (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINT32                 *HashHeads,
+  IN UINTN                  Index
+  )
+{
+  UINT32  *Links;
+  UINT32  *Link;
+
+  Links = PPI_HASH_LINKS (Ptrs, MaxCount);
+  Link  = &HashHeads[PpiHashBucket (Ptrs[Index].Ppi->Guid)];
+  while ((*Link != 0) && (*Link - 1 < Index)) {
+    Link = &Links[*Link - 1];
+  }
+
+  Links[Index] = *Link;
+  *Link        = (UINT32)(Index + 1);
+}
+
+/**
+
+  Remove an entry of a PPI or notify list from the hash chain of its GUID.
+
+  @param Ptrs       The entries of the list.
+  @param MaxCount   The number of entries allocated in the list.
+  @param HashHeads  The first link of each hash bucket of the list.
+  @param Index      The entry to remove.
+
+**/
+VOID
+PpiHashRemove (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINT32                 *HashHeads,
+  IN UINTN                  Index
+  )
+{
+  UINT32  *Links;
+  UINT32  *Link;
+
+  Links = PPI_HASH_LINKS (Ptrs, MaxCount);
+  Link  = &HashHeads[PpiHashBucket (Ptrs[Index].Ppi->Guid)];
+  while (*Link != 0) {
+    if (*Link - 1 == Index) {
+      *Link = Links[Index];
+      return;
+    }
+
+    Link = &Links[*Link - 1];
+  }
+}
+
+/**
+
+  Return the next entry of a PPI or notify list with a given GUID.
+
+  @param Ptrs       The entries of the list.
+  @param MaxCount   The number of entries allocated in the list.
+  @param HashHeads  The first link of each hash bucket of the list.
+  @param Guid       The GUID to look for.
+  @param Index      MAX_UINTN to get the first entry with Guid, or an entry
+                    returned by a previous call to get the next one.
+
+  @return The index of the entry, or MAX_UINTN if there are no more entries.
+
+**/
+UINTN
+PpiHashNext (
+  IN PEI_PPI_LIST_POINTERS  *Ptrs,
+  IN UINTN                  MaxCount,
+  IN UINT32                 *HashHeads,
+  IN CONST EFI_GUID         *Guid,
+  IN UINTN                  Index
+  )
+{
+  UINT32  *Links;
+  UINT32  Link;
+
+  Links = PPI_HASH_LINKS (Ptrs, MaxCount);
+  if (Index == MAX_UINTN) {
+    Link = HashHeads[PpiHashBucket (Guid)];
+  } else {
+    Link = Links[Index];
+  }
+
+  while (Link != 0) {
+    if (IsSamePpiGuid (Ptrs[Link - 1].Ppi->Guid, Guid)) {
+      return Link - 1;
+    }
+
+    Link = Links[Link - 1];
+  }
+
+  return MAX_UINTN;
+}
+
+/**
+
+  Return the next installed PPI with a given GUID.
+
+  @param PrivateData  PeiCore's private data structure.
+  @param Guid         The GUID of the PPI.
+  @param Index        MAX_UINTN to get the first PPI, or a PPI returned by a
+                      previous call to get the next one.
+
+  @return The index of the PPI in the PPI list, or MAX_UINTN if there are no
+          more PPIs with Guid.
+
+**/
+UINTN
+NextPpiByGuid (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN CONST EFI_GUID     *Guid,
+  IN UINTN              Index
+  )
+{
+  return PpiHashNext (
+           PrivateData->PpiData.PpiList.PpiPtrs,
+           PrivateData->PpiData.PpiList.MaxCount,
+           PrivateData->PpiData.PpiList.HashHeads,
+           Guid,
+           Index
+           );
+}
+
+/**
+
+  Return the next notify descriptor of a given type registered on a PPI GUID.
+
+  @param PrivateData  PeiCore's private data structure.
+  @param NotifyType   Type of the notify list.
+  @param Guid         The GUID of the PPI.
+  @param Index        MAX_UINTN to get the first notify descriptor, or one
+                      returned by a previous call to get the next one.
+
+  @return The index of the notify descriptor in its list, or MAX_UINTN if there
+          are no more notify descriptors on Guid.
+
+**/
+UINTN
+NextNotifyByGuid (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN UINTN              NotifyType,
+  IN CONST EFI_GUID     *Guid,
+  IN UINTN              Index
+  )
+{
+  if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
+    return PpiHashNext (
+             PrivateData->PpiData.CallbackNotifyList.NotifyPtrs,
+             PrivateData->PpiData.CallbackNotifyList.MaxCount,
+             PrivateData->PpiData.CallbackNotifyList.HashHeads,
+             Guid,
+             Index
+             );
+  }
+
+  return PpiHashNext (
+           PrivateData->PpiData.DispatchNotifyList.NotifyPtrs,
+           PrivateData->PpiData.DispatchNotifyList.MaxCount,
+           PrivateData->PpiData.DispatchNotifyList.HashHeads,
+           Guid,
+           Index
+           );
+}
+
 /**
 
   This function installs an interface in the PEI PPI database by GUID.
@@ -456,7 +727,6 @@ InternalPeiInstallPpi (
   PEI_PPI_LIST       *PpiListPointer;
   UINTN              Index;
   UINTN              LastCount;
-  VOID               *TempPtr;
 
   if (PpiList == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -490,16 +760,11 @@ InternalPeiInstallPpi (
       //
       // Run out of room, grow the buffer.
       //
-      TempPtr = AllocateZeroPool (
-                  sizeof (PEI_PPI_LIST_POINTERS) * (PpiListPointer->MaxCount + PPI_GROWTH_STEP)
-                  );
-      ASSERT (TempPtr != NULL);
-      CopyMem (
-        TempPtr,
-        PpiListPointer->PpiPtrs,
-        sizeof (PEI_PPI_LIST_POINTERS) * PpiListPointer->MaxCount
-        );
-      PpiListPointer->PpiPtrs  = TempPtr;
+      PpiListPointer->PpiPtrs = GrowPpiListBuffer (
+                                  PpiListPointer->PpiPtrs,
+                                  PpiListPointer->MaxCount,
+                                  PPI_GROWTH_STEP
+                                  );
       PpiListPointer->MaxCount = PpiListPointer->MaxCount + PPI_GROWTH_STEP;
     }
 
@@ -528,6 +793,13 @@ InternalPeiInstallPpi (
     PpiList++;
   }
 
+  //
+  // Index the newly installed PPIs by GUID, now that the whole list is valid.
+  //
+  for (Index = LastCount; Index < PpiListPointer->CurrentCount; Index++) {
+    PpiHashInsert (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, Index);
+  }
+
   //
   // Process any callback level notifies for newly installed PPIs.
   //
@@ -594,7 +866,9 @@ PeiReInstallPpi (
   )
 {
   PEI_CORE_INSTANCE  *PrivateData;
+  PEI_PPI_LIST       *PpiListPointer;
   UINTN              Index;
+  BOOLEAN            SameGuid;
 
   if ((OldPpi == NULL) || (NewPpi == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -604,27 +878,40 @@ PeiReInstallPpi (
     return EFI_INVALID_PARAMETER;
   }
 
-  PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PrivateData    = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
+  PpiListPointer = &PrivateData->PpiData.PpiList;
 
   //
   // Find the old PPI instance in the database.  If we can not find it,
   // return the EFI_NOT_FOUND error.
   //
-  for (Index = 0; Index < PrivateData->PpiData.PpiList.CurrentCount; Index++) {
-    if (OldPpi == PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi) {
+  for (Index = NextPpiByGuid (PrivateData, OldPpi->Guid, MAX_UINTN);
+       Index != MAX_UINTN;
+       Index = NextPpiByGuid (PrivateData, OldPpi->Guid, Index))
+  {
+    if (OldPpi == PpiListPointer->PpiPtrs[Index].Ppi) {
       break;
     }
   }
 
-  if (Index == PrivateData->PpiData.PpiList.CurrentCount) {
+  if (Index == MAX_UINTN) {
     return EFI_NOT_FOUND;
   }
 
   //
-  // Replace the old PPI with the new one.
+  // Replace the old PPI with the new one, and move it to the hash chain of
+  // its GUID if it changed.
   //
   DEBUG ((DEBUG_INFO, "Reinstall PPI: %g\n", NewPpi->Guid));
-  PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *)NewPpi;
+  SameGuid = IsSamePpiGuid (OldPpi->Guid, NewPpi->Guid);
+  if (!SameGuid) {
+    PpiHashRemove (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, Index);
+  }
+
+  PpiListPointer->PpiPtrs[Index].Ppi = (EFI_PEI_PPI_DESCRIPTOR *)NewPpi;
+  if (!SameGuid) {
+    PpiHashInsert (PpiListPointer->PpiPtrs, PpiListPointer->MaxCount, PpiListPointer->HashHeads, Index);
+  }
 
   //
   // Process any callback level notifies for the newly installed PPI.
@@ -669,42 +956,32 @@ PeiLocatePpi (
 {
   PEI_CORE_INSTANCE       *PrivateData;
   UINTN                   Index;
-  EFI_GUID                *CheckGuid;
   EFI_PEI_PPI_DESCRIPTOR  *TempPtr;
 
   PrivateData = PEI_CORE_INSTANCE_FROM_PS_THIS (PeiServices);
 
   //
-  // Search the data base for the matching instance of the GUIDed PPI.
+  // Search the hash chain of the GUID for the matching instance of the
+  // GUIDed PPI. The chain is in install order.
   //
-  for (Index = 0; Index < PrivateData->PpiData.PpiList.CurrentCount; Index++) {
-    TempPtr   = PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi;
-    CheckGuid = TempPtr->Guid;
-
-    //
-    // Don't use CompareGuid function here for performance reasons.
-    // Instead we compare the GUID as INT32 at a time and branch
-    // on the first failed comparison.
-    //
-    if ((((INT32 *)Guid)[0] == ((INT32 *)CheckGuid)[0]) &&
-        (((INT32 *)Guid)[1] == ((INT32 *)CheckGuid)[1]) &&
-        (((INT32 *)Guid)[2] == ((INT32 *)CheckGuid)[2]) &&
-        (((INT32 *)Guid)[3] == ((INT32 *)CheckGuid)[3]))
-    {
-      if (Instance == 0) {
-        if (PpiDescriptor != NULL) {
-          *PpiDescriptor = TempPtr;
-        }
-
-        if (Ppi != NULL) {
-          *Ppi = TempPtr->Ppi;
-        }
+  for (Index = NextPpiByGuid (PrivateData, Guid, MAX_UINTN);
+       Index != MAX_UINTN;
+       Index = NextPpiByGuid (PrivateData, Guid, Index))
+  {
+    if (Instance == 0) {
+      TempPtr = PrivateData->PpiData.PpiList.PpiPtrs[Index].Ppi;
+      if (PpiDescriptor != NULL) {
+        *PpiDescriptor = TempPtr;
+      }
 
-        return EFI_SUCCESS;
+      if (Ppi != NULL) {
+        *Ppi = TempPtr->Ppi;
       }
 
-      Instance--;
+      return EFI_SUCCESS;
     }
+
+    Instance--;
   }
 
   return EFI_NOT_FOUND;
@@ -741,7 +1018,6 @@ InternalPeiNotifyPpi (
   PEI_DISPATCH_NOTIFY_LIST  *DispatchNotifyListPointer;
   UINTN                     DispatchNotifyIndex;
   UINTN                     LastDispatchNotifyCount;
-  VOID                      *TempPtr;
 
   if (NotifyList == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -779,17 +1055,12 @@ InternalPeiNotifyPpi (
         //
         // Run out of room, grow the buffer.
         //
-        TempPtr = AllocateZeroPool (
-                    sizeof (PEI_PPI_LIST_POINTERS) * (CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP)
-                    );
-        ASSERT (TempPtr != NULL);
-        CopyMem (
-          TempPtr,
-          CallbackNotifyListPointer->NotifyPtrs,
-          sizeof (PEI_PPI_LIST_POINTERS) * CallbackNotifyListPointer->MaxCount
-          );
-        CallbackNotifyListPointer->NotifyPtrs = TempPtr;
-        CallbackNotifyListPointer->MaxCount   = CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP;
+        CallbackNotifyListPointer->NotifyPtrs = GrowPpiListBuffer (
+                                                  CallbackNotifyListPointer->NotifyPtrs,
+                                                  CallbackNotifyListPointer->MaxCount,
+                                                  CALLBACK_NOTIFY_GROWTH_STEP
+                                                  );
+        CallbackNotifyListPointer->MaxCount = CallbackNotifyListPointer->MaxCount + CALLBACK_NOTIFY_GROWTH_STEP;
       }
 
       CallbackNotifyListPointer->NotifyPtrs[CallbackNotifyIndex].Notify = (EFI_PEI_NOTIFY_DESCRIPTOR *)NotifyList;
@@ -800,17 +1071,12 @@ InternalPeiNotifyPpi (
         //
         // Run out of room, grow the buffer.
         //
-        TempPtr = AllocateZeroPool (
-                    sizeof (PEI_PPI_LIST_POINTERS) * (DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP)
-                    );
-        ASSERT (TempPtr != NULL);
-        CopyMem (
-          TempPtr,
-          DispatchNotifyListPointer->NotifyPtrs,
-          sizeof (PEI_PPI_LIST_POINTERS) * DispatchNotifyListPointer->MaxCount
-          );
-        DispatchNotifyListPointer->NotifyPtrs = TempPtr;
-        DispatchNotifyListPointer->MaxCount   = DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP;
+        DispatchNotifyListPointer->NotifyPtrs = GrowPpiListBuffer (
+                                                  DispatchNotifyListPointer->NotifyPtrs,
+                                                  DispatchNotifyListPointer->MaxCount,
+                                                  DISPATCH_NOTIFY_GROWTH_STEP
+                                                  );
+        DispatchNotifyListPointer->MaxCount = DispatchNotifyListPointer->MaxCount + DISPATCH_NOTIFY_GROWTH_STEP;
       }
 
       DispatchNotifyListPointer->NotifyPtrs[DispatchNotifyIndex].Notify = (EFI_PEI_NOTIFY_DESCRIPTOR *)NotifyList;
@@ -840,6 +1106,27 @@ InternalPeiNotifyPpi (
     NotifyList++;
   }
 
+  //
+  // Index the newly registered notifies by GUID, now that the whole list is valid.
+  //
+  for (CallbackNotifyIndex = LastCallbackNotifyCount; CallbackNotifyIndex < CallbackNotifyListPointer->CurrentCount; CallbackNotifyIndex++) {
+    PpiHashInsert (
+      CallbackNotifyListPointer->NotifyPtrs,
+      CallbackNotifyListPointer->MaxCount,
+      CallbackNotifyListPointer->HashHeads,
+      CallbackNotifyIndex
+      );
+  }
+
+  for (DispatchNotifyIndex = LastDispatchNotifyCount; DispatchNotifyIndex < DispatchNotifyListPointer->CurrentCount; DispatchNotifyIndex++) {
+    PpiHashInsert (
+      DispatchNotifyListPointer->NotifyPtrs,
+      DispatchNotifyListPointer->MaxCount,
+      DispatchNotifyListPointer->HashHeads,
+      DispatchNotifyIndex
+      );
+  }
+
   //
   // Process any callback level notifies for all previously installed PPIs.
   //
@@ -944,10 +1231,57 @@ ProcessDispatchNotifyList (
   return;
 }
 
+/**
+
+  Call a notify function for an installed PPI.
+
+  @param PrivateData   PeiCore's private data structure.
+  @param NotifyType    Type of the notify list.
+  @param NotifyIndex   Index of the notify descriptor in its list.
+  @param InstallIndex  Index of the PPI in the PPI list.
+
+**/
+VOID
+InvokePpiNotify (
+  IN PEI_CORE_INSTANCE  *PrivateData,
+  IN UINTN              NotifyType,
+  IN UINTN              NotifyIndex,
+  IN UINTN              InstallIndex
+  )
+{
+  EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyDescriptor;
+  EFI_PEI_PPI_DESCRIPTOR     *PpiDescriptor;
+
+  if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
+    NotifyDescriptor = PrivateData->PpiData.CallbackNotifyList.NotifyPtrs[NotifyIndex].Notify;
+  } else {
+    NotifyDescriptor = PrivateData->PpiData.DispatchNotifyList.NotifyPtrs[NotifyIndex].Notify;
+  }
+
+  PpiDescriptor = PrivateData->PpiData.PpiList.PpiPtrs[InstallIndex].Ppi;
+
+  DEBUG ((
+    DEBUG_INFO,
+    "Notify: PPI Guid: %g, Peim notify entry point: %p\n",
+    PpiDescriptor->Guid,
+    NotifyDescriptor->Notify
+    ));
+  NotifyDescriptor->Notify (
+                      (EFI_PEI_SERVICES **)GetPeiServicesTablePointer (),
+                      NotifyDescriptor,
+                      PpiDescriptor->Ppi
+                      );
+}
+
 /**
 
   Process notifications.
 
+  The notify functions are called in the order of the notify list, and for a
+  notify descriptor, in the order of the PPI list. The pairs are found with
+  the GUID hash chains of the smaller range: the PPIs of each notify
+  descriptor, or the notify descriptors of each PPI merged in list order.
+
   @param PrivateData        PeiCore's private data structure
   @param NotifyType         Type of notify to fire.
   @param InstallStartIndex  Install Beginning index.
@@ -966,46 +1300,76 @@ ProcessNotify (
   IN INTN               NotifyStopIndex
   )
 {
-  INTN                       Index1;
-  INTN                       Index2;
-  EFI_GUID                   *SearchGuid;
-  EFI_GUID                   *CheckGuid;
-  EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyDescriptor;
+  INTN      Index1;
+  UINTN     Index2;
+  INTN      InstallCount;
+  EFI_GUID  *CheckGuid;
+  UINTN     NotifyIndex[PPI_NOTIFY_MERGE_MAX];
+  UINTN     Next;
+  INTN      Lowest;
+
+  if ((NotifyStartIndex >= NotifyStopIndex) || (InstallStartIndex >= InstallStopIndex)) {
+    return;
+  }
 
-  for (Index1 = NotifyStartIndex; Index1 < NotifyStopIndex; Index1++) {
-    if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
-      NotifyDescriptor = PrivateData->PpiData.CallbackNotifyList.NotifyPtrs[Index1].Notify;
-    } else {
-      NotifyDescriptor = PrivateData->PpiData.DispatchNotifyList.NotifyPtrs[Index1].Notify;
+  InstallCount = InstallStopIndex - InstallStartIndex;
+  if ((NotifyStopIndex - NotifyStartIndex <= InstallCount) || (InstallCount > PPI_NOTIFY_MERGE_MAX)) {
+    //
+    // Walk the PPIs installed on the GUID of each notify descriptor.
+    //
+    for (Index1 = NotifyStartIndex; Index1 < NotifyStopIndex; Index1++) {
+      if (NotifyType == EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) {
+        CheckGuid = PrivateData->PpiData.CallbackNotifyList.NotifyPtrs[Index1].Notify->Guid;
+      } else {
+        CheckGuid = PrivateData->PpiData.DispatchNotifyList.NotifyPtrs[Index1].Notify->Guid;
+      }
+
+      for (Index2 = NextPpiByGuid (PrivateData, CheckGuid, MAX_UINTN);
+           Index2 != MAX_UINTN && Index2 < (UINTN)InstallStopIndex;
+           Index2 = NextPpiByGuid (PrivateData, CheckGuid, Index2))
+      {
+        if (Index2 >= (UINTN)InstallStartIndex) {
+          InvokePpiNotify (PrivateData, NotifyType, Index1, Index2);
+        }
+      }
     }
 
-    CheckGuid = NotifyDescriptor->Guid;
+    return;
+  }
 
-    for (Index2 = InstallStartIndex; Index2 < InstallStopIndex; Index2++) {
-      SearchGuid = PrivateData->PpiData.PpiList.PpiPtrs[Index2].Ppi->Guid;
-      //
-      // Don't use CompareGuid function here for performance reasons.
-      // Instead we compare the GUID as INT32 at a time and branch
-      // on the first failed comparison.
-      //
-      if ((((INT32 *)SearchGuid)[0] == ((INT32 *)CheckGuid)[0]) &&
-          (((INT32 *)SearchGuid)[1] == ((INT32 *)CheckGuid)[1]) &&
-          (((INT32 *)SearchGuid)[2] == ((INT32 *)CheckGuid)[2]) &&
-          (((INT32 *)SearchGuid)[3] == ((INT32 *)CheckGuid)[3]))
-      {
-        DEBUG ((
-          DEBUG_INFO,
-          "Notify: PPI Guid: %g, Peim notify entry point: %p\n",
-          SearchGuid,
-          NotifyDescriptor->Notify
-          ));
-        NotifyDescriptor->Notify (
-                            (EFI_PEI_SERVICES **)GetPeiServicesTablePointer (),
-                            NotifyDescriptor,
-                            (PrivateData->PpiData.PpiList.PpiPtrs[Index2].Ppi)->Ppi
-                            );
+  //
+  // Few PPIs for many notify descriptors: find the first notify descriptor
+  // in the range of each PPI, then repeatedly process the lowest one.
+  //
+  for (Index1 = 0; Index1 < InstallCount; Index1++) {
+    CheckGuid = PrivateData->PpiData.PpiList.PpiPtrs[InstallStartIndex + Index1].Ppi->Guid;
+    Next      = NextNotifyByGuid (PrivateData, NotifyType, CheckGuid, MAX_UINTN);
+    while (Next != MAX_UINTN && Next < (UINTN)NotifyStartIndex) {
+      Next = NextNotifyByGuid (PrivateData, NotifyType, CheckGuid, Next);
+    }
+
+    NotifyIndex[Index1] = Next;
+  }
+
+  for ( ; ;) {
+    //
+    // On ties, the lowest PPI goes first.
+    //
+    Lowest = 0;
+    for (Index1 = 1; Index1 < InstallCount; Index1++) {
+      if (NotifyIndex[Index1] < NotifyIndex[Lowest]) {
+        Lowest = Index1;
       }
     }
+
+    if ((NotifyIndex[Lowest] == MAX_UINTN) || (NotifyIndex[Lowest] >= (UINTN)NotifyStopIndex)) {
+      break;
+    }
+
+    InvokePpiNotify (PrivateData, NotifyType, NotifyIndex[Lowest], InstallStartIndex + Lowest);
+
+    CheckGuid           = PrivateData->PpiData.PpiList.PpiPtrs[InstallStartIndex + Lowest].Ppi->Guid;
+    NotifyIndex[Lowest] = NextNotifyByGuid (PrivateData, NotifyType, CheckGuid, NotifyIndex[Lowest]);
   }
 }
 
@@ -0,0 +1,241 @@
+/** @file
+  Host based unit tests of the PEI Core pool allocated once permanent memory is
+  installed.
+
+  The Free Pool PPI may be given any buffer. The PEI Core must only read the
+  pool header of the buffers it allocated, and reject the other ones, even
+  when the memory before them looks like a pool header.
+
+  The pages are allocated in the HOB list of UnitTestPeiServicesTablePointerLib.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "../PeiMain.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "PEI Core Pool Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_SMALL_POOL_SIZE  100
+#define TEST_LARGE_POOL_SIZE  SIZE_16KB
+
+PEI_CORE_INSTANCE  mPeiCore;
+
+/**
+  Initialize a PEI Core instance with permanent memory installed, and no pool
+  allocated.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED  The PEI Core instance is initialized.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  ZeroMem (&mPeiCore, sizeof (mPeiCore));
+  mPeiCore.Signature          = PEI_CORE_HANDLE_SIGNATURE;
+  mPeiCore.Ps                 = (EFI_PEI_SERVICES *)*GetPeiServicesTablePointer ();
+  mPeiCore.HobList.Raw        = GetHobList ();
+  mPeiCore.PeiMemoryInstalled = TRUE;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Allocate pages that are not a pool.
+
+  @param[in] Pages  The number of pages to allocate.
+
+  @return  The pages, or NULL if they could not be allocated.
+
+**/
+VOID *
+AllocateTestPages (
+  IN UINTN  Pages
+  )
+{
+  EFI_PHYSICAL_ADDRESS  Memory;
+
+  if (EFI_ERROR (PeiAllocatePages ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, EfiBootServicesData, Pages, &Memory))) {
+    return NULL;
+  }
+
+  return (VOID *)(UINTN)Memory;
+}
+
+/**
+  Check that a pool carved out of an arena is accepted at the start of its
+  block only, and is reused once freed.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The arena pool is checked.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestArenaPool (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID  *Buffer;
+  VOID  *Buffer2;
+
+  UT_ASSERT_NOT_EFI_ERROR (AllocatePoolFromArena (&mPeiCore, TEST_SMALL_POOL_SIZE, &Buffer));
+  UT_ASSERT_TRUE (IsPoolArenaBuffer (&mPeiCore, Buffer));
+  UT_ASSERT_FALSE (IsPoolArenaBuffer (&mPeiCore, (UINT8 *)Buffer + sizeof (UINT64)));
+  UT_ASSERT_STATUS_EQUAL (FreePoolToArena (&mPeiCore, (UINT8 *)Buffer + sizeof (UINT64)), EFI_INVALID_PARAMETER);
+
+  UT_ASSERT_NOT_EFI_ERROR (FreePoolToArena (&mPeiCore, Buffer));
+  UT_ASSERT_NOT_EFI_ERROR (AllocatePoolFromArena (&mPeiCore, TEST_SMALL_POOL_SIZE, &Buffer2));
+  UT_ASSERT_EQUAL ((UINTN)Buffer2, (UINTN)Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (FreePoolToArena (&mPeiCore, Buffer2));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that a pool allocated as pages is accepted until it is freed.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The large pool is checked.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestLargePool (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID  *Buffer;
+  VOID  *Buffer2;
+
+  UT_ASSERT_NOT_EFI_ERROR (AllocatePoolFromArena (&mPeiCore, TEST_LARGE_POOL_SIZE, &Buffer));
+  UT_ASSERT_NOT_EFI_ERROR (AllocatePoolFromArena (&mPeiCore, TEST_LARGE_POOL_SIZE, &Buffer2));
+  UT_ASSERT_TRUE (IsPoolArenaBuffer (&mPeiCore, Buffer));
+  UT_ASSERT_TRUE (IsPoolArenaBuffer (&mPeiCore, Buffer2));
+
+  UT_ASSERT_NOT_EFI_ERROR (FreePoolToArena (&mPeiCore, Buffer));
+  UT_ASSERT_FALSE (IsPoolArenaBuffer (&mPeiCore, Buffer));
+  UT_ASSERT_STATUS_EQUAL (FreePoolToArena (&mPeiCore, Buffer), EFI_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (IsPoolArenaBuffer (&mPeiCore, Buffer2));
+
+  UT_ASSERT_NOT_EFI_ERROR (FreePoolToArena (&mPeiCore, Buffer2));
+  UT_ASSERT_TRUE (mPeiCore.PoolLargeList == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that page aligned buffers that were not allocated as pool are rejected,
+  and left untouched, even when they follow a valid large pool header.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The buffers are rejected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestForeignBuffer (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID            *Buffer;
+  PEI_POOL_HEAD   *Head;
+  PEI_POOL_LARGE  *Large;
+
+  UT_ASSERT_NOT_EFI_ERROR (AllocatePoolFromArena (&mPeiCore, TEST_LARGE_POOL_SIZE, &Buffer));
+
+  Head = AllocateTestPages (1);
+  UT_ASSERT_NOT_NULL (Head);
+  Head->Signature = PEI_POOL_HEAD_SIGNATURE;
+  Head->Bucket    = PEI_POOL_LARGE_BUCKET;
+  Head->Size      = EFI_PAGE_SIZE;
+  UT_ASSERT_FALSE (IsPoolArenaBuffer (&mPeiCore, Head + 1));
+  UT_ASSERT_STATUS_EQUAL (FreePoolToArena (&mPeiCore, Head + 1), EFI_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (Head->Signature, PEI_POOL_HEAD_SIGNATURE);
+
+  Large = AllocateTestPages (1);
+  UT_ASSERT_NOT_NULL (Large);
+  Large->Next           = mPeiCore.PoolLargeList;
+  Large->Head.Signature = PEI_POOL_HEAD_SIGNATURE;
+  Large->Head.Bucket    = PEI_POOL_LARGE_BUCKET;
+  Large->Head.Size      = EFI_PAGE_SIZE;
+  UT_ASSERT_FALSE (IsPoolArenaBuffer (&mPeiCore, &Large->Head + 1));
+  UT_ASSERT_STATUS_EQUAL (FreePoolToArena (&mPeiCore, &Large->Head + 1), EFI_INVALID_PARAMETER);
+  UT_ASSERT_EQUAL (Large->Head.Signature, PEI_POOL_HEAD_SIGNATURE);
+
+  UT_ASSERT_TRUE (IsPoolArenaBuffer (&mPeiCore, Buffer));
+  UT_ASSERT_NOT_EFI_ERROR (FreePoolToArena (&mPeiCore, Buffer));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the PEI Core
+  pool, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PoolTestSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&PoolTestSuite, Framework, "PEI Core pool test suite", "PeiCore.Pool", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for PEI Core pool test suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (PoolTestSuite, "Arena pool", "ArenaPool", TestArenaPool, TestSetup, NULL, NULL);
+  AddTestCase (PoolTestSuite, "Large pool", "LargePool", TestLargePool, TestSetup, NULL, NULL);
+  AddTestCase (PoolTestSuite, "Page aligned buffers that are not pool", "ForeignBuffer", TestForeignBuffer, TestSetup, NULL, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
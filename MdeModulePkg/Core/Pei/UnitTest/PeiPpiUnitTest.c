@@ -0,0 +1,729 @@
+/** @file
+  Host based unit tests of the PEI Core PPI database.
+
+  The PPI and notify lists are chained by GUID hash bucket. Random sequences of
+  installs, notifies, reinstalls, locates and dispatches are run on the PEI
+  Core, and on a linear model of the PPI database that compares the GUID of
+  every entry. Both must locate the same PPIs, and call the same notify
+  functions in the same order.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "../PeiMain.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "PEI Core PPI Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_GUID_COUNT    8
+#define TEST_STEP_COUNT    2000
+#define TEST_MAX_PPIS      (TEST_STEP_COUNT * 12)
+#define TEST_MAX_NOTIFIES  (TEST_STEP_COUNT * 3)
+#define TEST_MAX_CALLS     0x10000
+
+///
+/// A call of a notify function.
+///
+typedef struct {
+  EFI_PEI_NOTIFY_DESCRIPTOR    *Notify;
+  VOID                         *Ppi;
+} TEST_NOTIFY_CALL;
+
+///
+/// A PPI or notify list of the linear model, in install order.
+///
+typedef struct {
+  VOID     **Entries;
+  UINTN    Count;
+  UINTN    LastDispatchedCount;
+} REFERENCE_LIST;
+
+///
+/// The random sequence of a test case.
+///
+typedef struct {
+  UINT32    Seed;
+} TEST_CONTEXT;
+
+PEI_CORE_INSTANCE  mPeiCore;
+UINT32             mRandom;
+
+//
+// The GUIDs come in pairs that have the same hash bucket.
+//
+EFI_GUID  mTestGuids[TEST_GUID_COUNT];
+
+EFI_PEI_PPI_DESCRIPTOR     *mPpis;
+UINTN                      mPpiCount;
+EFI_PEI_NOTIFY_DESCRIPTOR  *mNotifies;
+UINTN                      mNotifyCount;
+
+//
+// The notify descriptors whose index is a multiple of TEST_REENTRANT_NOTIFY
+// install mReentrantPpis[Index] the first time they are called.
+//
+#define TEST_REENTRANT_NOTIFY  5
+
+EFI_PEI_PPI_DESCRIPTOR  *mReentrantPpis;
+BOOLEAN                 *mReentrantDone;
+BOOLEAN                 *mReferenceReentrantDone;
+
+TEST_NOTIFY_CALL  *mCalls;
+UINTN             mCallCount;
+TEST_NOTIFY_CALL  *mReferenceCalls;
+UINTN             mReferenceCallCount;
+
+REFERENCE_LIST  mReferencePpis;
+REFERENCE_LIST  mReferenceCallbackNotifies;
+REFERENCE_LIST  mReferenceDispatchNotifies;
+
+/**
+  Return the PEI Services Table pointer of the PEI Core instance under test.
+
+  @return  The pointer to PeiServices.
+**/
+CONST EFI_PEI_SERVICES **
+EFIAPI
+GetPeiServicesTablePointer (
+  VOID
+  )
+{
+  return (CONST EFI_PEI_SERVICES **)&mPeiCore.Ps;
+}
+
+/**
+  Stub of the PEI Core HOB service. ProcessPpiListFromSec() is not tested.
+
+  @param[in] PeiServices  Unused.
+  @param[in] SecHobList   Unused.
+
+  @retval EFI_UNSUPPORTED  Always.
+**/
+EFI_STATUS
+PeiInstallSecHobData (
+  IN CONST EFI_PEI_SERVICES  **PeiServices,
+  IN EFI_HOB_GENERIC_HEADER  *SecHobList
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Stub of the PEI Core image service. ConvertPeiCorePpiPointers() is not
+  tested.
+
+  @param[in]  FileHandle  Unused.
+  @param[out] Pe32Data    Unused.
+
+  @retval EFI_NOT_FOUND  Always.
+**/
+EFI_STATUS
+PeiGetPe32Data (
+  IN     EFI_PEI_FILE_HANDLE  FileHandle,
+  OUT    VOID                 **Pe32Data
+  )
+{
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Stub of the PEI Core entry point. ConvertPeiCorePpiPointers() is not tested.
+
+  @param[in] SecCoreData  Unused.
+  @param[in] PpiList      Unused.
+**/
+VOID
+EFIAPI
+_ModuleEntryPoint (
+  IN CONST  EFI_SEC_PEI_HAND_OFF    *SecCoreData,
+  IN CONST  EFI_PEI_PPI_DESCRIPTOR  *PpiList
+  )
+{
+}
+
+/**
+  Return the next number of the pseudo random sequence of the test case.
+
+  @return A pseudo random number below 0x8000.
+**/
+UINT32
+TestRandom (
+  VOID
+  )
+{
+  mRandom = mRandom * 1103515245 + 12345;
+  return (mRandom >> 16) & 0x7FFF;
+}
+
+/**
+  Record a call of a notify function.
+
+  @param[in, out] Calls      The calls recorded.
+  @param[in, out] CallCount  The number of calls recorded.
+  @param[in]      Notify     The notify descriptor called.
+  @param[in]      Ppi        The PPI passed to the notify function.
+**/
+VOID
+RecordCall (
+  IN OUT TEST_NOTIFY_CALL           *Calls,
+  IN OUT UINTN                      *CallCount,
+  IN     EFI_PEI_NOTIFY_DESCRIPTOR  *Notify,
+  IN     VOID                       *Ppi
+  )
+{
+  ASSERT (*CallCount < TEST_MAX_CALLS);
+  Calls[*CallCount].Notify = Notify;
+  Calls[*CallCount].Ppi    = Ppi;
+  (*CallCount)++;
+}
+
+/**
+  Notify function of the PEI Core under test.
+
+  @param[in] PeiServices       An indirect pointer to the EFI_PEI_SERVICES table.
+  @param[in] NotifyDescriptor  The notify descriptor called.
+  @param[in] Ppi               The PPI installed.
+
+  @retval EFI_SUCCESS  Always.
+**/
+EFI_STATUS
+EFIAPI
+TestNotify (
+  IN EFI_PEI_SERVICES           **PeiServices,
+  IN EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyDescriptor,
+  IN VOID                       *Ppi
+  )
+{
+  UINTN  Index;
+
+  RecordCall (mCalls, &mCallCount, NotifyDescriptor, Ppi);
+
+  Index = NotifyDescriptor - mNotifies;
+  if (((Index % TEST_REENTRANT_NOTIFY) == 0) && !mReentrantDone[Index]) {
+    mReentrantDone[Index] = TRUE;
+    PeiInstallPpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, &mReentrantPpis[Index]);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Install a list of PPIs in the linear model.
+
+  @param[in] PpiList  The PPI descriptors, the last one has the
+                      EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST flag.
+**/
+VOID
+ReferenceInstallPpi (
+  IN EFI_PEI_PPI_DESCRIPTOR  *PpiList
+  );
+
+/**
+  Call the notify functions of a range of notify descriptors for a range of
+  PPIs in the linear model, comparing the GUID of every pair.
+
+  @param[in] NotifyList    The notify list.
+  @param[in] NotifyStart   The first notify descriptor of the range.
+  @param[in] NotifyStop    The end of the notify descriptor range.
+  @param[in] InstallStart  The first PPI of the range.
+  @param[in] InstallStop   The end of the PPI range.
+**/
+VOID
+ReferenceProcessNotify (
+  IN REFERENCE_LIST  *NotifyList,
+  IN UINTN           NotifyStart,
+  IN UINTN           NotifyStop,
+  IN UINTN           InstallStart,
+  IN UINTN           InstallStop
+  )
+{
+  UINTN                      Index1;
+  UINTN                      Index2;
+  EFI_PEI_NOTIFY_DESCRIPTOR  *Notify;
+  EFI_PEI_PPI_DESCRIPTOR     *Ppi;
+  UINTN                      Index;
+
+  for (Index1 = NotifyStart; Index1 < NotifyStop; Index1++) {
+    Notify = NotifyList->Entries[Index1];
+    for (Index2 = InstallStart; Index2 < InstallStop; Index2++) {
+      Ppi = mReferencePpis.Entries[Index2];
+      if (!CompareGuid (Notify->Guid, Ppi->Guid)) {
+        continue;
+      }
+
+      RecordCall (mReferenceCalls, &mReferenceCallCount, Notify, Ppi->Ppi);
+
+      Index = Notify - mNotifies;
+      if (((Index % TEST_REENTRANT_NOTIFY) == 0) && !mReferenceReentrantDone[Index]) {
+        mReferenceReentrantDone[Index] = TRUE;
+        ReferenceInstallPpi (&mReentrantPpis[Index]);
+      }
+    }
+  }
+}
+
+/**
+  Install a list of PPIs in the linear model.
+
+  @param[in] PpiList  The PPI descriptors, the last one has the
+                      EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST flag.
+**/
+VOID
+ReferenceInstallPpi (
+  IN EFI_PEI_PPI_DESCRIPTOR  *PpiList
+  )
+{
+  UINTN  LastCount;
+
+  LastCount = mReferencePpis.Count;
+  for ( ; ; PpiList++) {
+    mReferencePpis.Entries[mReferencePpis.Count++] = PpiList;
+    if ((PpiList->Flags & EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST) != 0) {
+      break;
+    }
+  }
+
+  ReferenceProcessNotify (&mReferenceCallbackNotifies, 0, mReferenceCallbackNotifies.Count, LastCount, mReferencePpis.Count);
+}
+
+/**
+  Install a list of notify descriptors in the linear model.
+
+  @param[in] NotifyList  The notify descriptors, the last one has the
+                         EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST flag.
+**/
+VOID
+ReferenceNotifyPpi (
+  IN EFI_PEI_NOTIFY_DESCRIPTOR  *NotifyList
+  )
+{
+  UINTN  LastCount;
+
+  LastCount = mReferenceCallbackNotifies.Count;
+  for ( ; ; NotifyList++) {
+    if ((NotifyList->Flags & EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK) != 0) {
+      mReferenceCallbackNotifies.Entries[mReferenceCallbackNotifies.Count++] = NotifyList;
+    } else {
+      mReferenceDispatchNotifies.Entries[mReferenceDispatchNotifies.Count++] = NotifyList;
+    }
+
+    if ((NotifyList->Flags & EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST) != 0) {
+      break;
+    }
+  }
+
+  ReferenceProcessNotify (&mReferenceCallbackNotifies, LastCount, mReferenceCallbackNotifies.Count, 0, mReferencePpis.Count);
+}
+
+/**
+  Reinstall a PPI in the linear model.
+
+  @param[in] OldPpi  The PPI descriptor to replace.
+  @param[in] NewPpi  The new PPI descriptor.
+
+  @retval TRUE   The PPI is reinstalled.
+  @retval FALSE  OldPpi is not installed.
+**/
+BOOLEAN
+ReferenceReInstallPpi (
+  IN EFI_PEI_PPI_DESCRIPTOR  *OldPpi,
+  IN EFI_PEI_PPI_DESCRIPTOR  *NewPpi
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mReferencePpis.Count; Index++) {
+    if (mReferencePpis.Entries[Index] == OldPpi) {
+      mReferencePpis.Entries[Index] = NewPpi;
+      ReferenceProcessNotify (&mReferenceCallbackNotifies, 0, mReferenceCallbackNotifies.Count, Index, Index + 1);
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/**
+  Locate a PPI in the linear model.
+
+  @param[in] Guid      The GUID of the PPI.
+  @param[in] Instance  The instance of the PPI to locate.
+
+  @return The PPI descriptor, or NULL if it is not installed.
+**/
+EFI_PEI_PPI_DESCRIPTOR *
+ReferenceLocatePpi (
+  IN EFI_GUID  *Guid,
+  IN UINTN     Instance
+  )
+{
+  UINTN                   Index;
+  EFI_PEI_PPI_DESCRIPTOR  *Ppi;
+
+  for (Index = 0; Index < mReferencePpis.Count; Index++) {
+    Ppi = mReferencePpis.Entries[Index];
+    if (CompareGuid (Ppi->Guid, Guid)) {
+      if (Instance == 0) {
+        return Ppi;
+      }
+
+      Instance--;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Process the dispatch level notify descriptors in the linear model, as
+  ProcessDispatchNotifyList() does.
+**/
+VOID
+ReferenceDispatchNotifyList (
+  VOID
+  )
+{
+  UINTN  TempValue;
+
+  while (TRUE) {
+    while (mReferenceDispatchNotifies.LastDispatchedCount != mReferenceDispatchNotifies.Count) {
+      TempValue = mReferenceDispatchNotifies.Count;
+      ReferenceProcessNotify (
+        &mReferenceDispatchNotifies,
+        mReferenceDispatchNotifies.LastDispatchedCount,
+        mReferenceDispatchNotifies.Count,
+        0,
+        mReferencePpis.LastDispatchedCount
+        );
+      mReferenceDispatchNotifies.LastDispatchedCount = TempValue;
+    }
+
+    while (mReferencePpis.LastDispatchedCount != mReferencePpis.Count) {
+      TempValue = mReferencePpis.Count;
+      ReferenceProcessNotify (
+        &mReferenceDispatchNotifies,
+        0,
+        mReferenceDispatchNotifies.LastDispatchedCount,
+        mReferencePpis.LastDispatchedCount,
+        mReferencePpis.Count
+        );
+      mReferencePpis.LastDispatchedCount = TempValue;
+    }
+
+    if (mReferenceDispatchNotifies.LastDispatchedCount == mReferenceDispatchNotifies.Count) {
+      break;
+    }
+  }
+}
+
+/**
+  Return the GUID of a new descriptor.
+
+  @return One of mTestGuids.
+**/
+EFI_GUID *
+RandomGuid (
+  VOID
+  )
+{
+  return &mTestGuids[TestRandom () % TEST_GUID_COUNT];
+}
+
+/**
+  Create a PPI descriptor. The PPI of the descriptor is the descriptor itself.
+
+  @param[out] Ppi   The descriptor to initialize.
+  @param[in]  Last  TRUE if the descriptor ends its list.
+**/
+VOID
+InitPpiDescriptor (
+  OUT EFI_PEI_PPI_DESCRIPTOR  *Ppi,
+  IN  BOOLEAN                 Last
+  )
+{
+  Ppi->Flags = EFI_PEI_PPI_DESCRIPTOR_PPI | (Last ? EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST : 0);
+  Ppi->Guid  = RandomGuid ();
+  Ppi->Ppi   = Ppi;
+}
+
+/**
+  Initialize an empty PEI Core PPI database and linear model, and the GUIDs of
+  the test case.
+
+  @param  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED                      The databases are initialized.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The buffers can not be allocated.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN  Index;
+
+  ZeroMem (&mPeiCore, sizeof (mPeiCore));
+  mPeiCore.Signature = PEI_CORE_HANDLE_SIGNATURE;
+  mPeiCore.Ps        = &mPeiCore.ServiceTableShadow;
+
+  mRandom = ((TEST_CONTEXT *)Context)->Seed;
+  for (Index = 0; Index < TEST_GUID_COUNT; Index += 2) {
+    mTestGuids[Index].Data1 = (TestRandom () << 16) | TestRandom ();
+    mTestGuids[Index].Data2 = (UINT16)TestRandom ();
+    mTestGuids[Index].Data3 = (UINT16)TestRandom ();
+    WriteUnaligned32 ((UINT32 *)mTestGuids[Index].Data4, (TestRandom () << 16) | TestRandom ());
+    WriteUnaligned32 ((UINT32 *)&mTestGuids[Index].Data4[4], (TestRandom () << 16) | TestRandom ());
+
+    //
+    // Swapping the 32-bit words of a GUID keeps its hash bucket.
+    //
+    ((UINT32 *)&mTestGuids[Index + 1])[0] = ((UINT32 *)&mTestGuids[Index])[1];
+    ((UINT32 *)&mTestGuids[Index + 1])[1] = ((UINT32 *)&mTestGuids[Index])[0];
+    ((UINT32 *)&mTestGuids[Index + 1])[2] = ((UINT32 *)&mTestGuids[Index])[3];
+    ((UINT32 *)&mTestGuids[Index + 1])[3] = ((UINT32 *)&mTestGuids[Index])[2];
+  }
+
+  mPpis                              = AllocateZeroPool (sizeof (EFI_PEI_PPI_DESCRIPTOR) * TEST_MAX_PPIS);
+  mNotifies                          = AllocateZeroPool (sizeof (EFI_PEI_NOTIFY_DESCRIPTOR) * TEST_MAX_NOTIFIES);
+  mReentrantPpis                     = AllocateZeroPool (sizeof (EFI_PEI_PPI_DESCRIPTOR) * TEST_MAX_NOTIFIES);
+  mReentrantDone                     = AllocateZeroPool (sizeof (BOOLEAN) * TEST_MAX_NOTIFIES);
+  mReferenceReentrantDone            = AllocateZeroPool (sizeof (BOOLEAN) * TEST_MAX_NOTIFIES);
+  mCalls                             = AllocateZeroPool (sizeof (TEST_NOTIFY_CALL) * TEST_MAX_CALLS);
+  mReferenceCalls                    = AllocateZeroPool (sizeof (TEST_NOTIFY_CALL) * TEST_MAX_CALLS);
+  mReferencePpis.Entries             = AllocateZeroPool (sizeof (VOID *) * (TEST_MAX_PPIS + TEST_MAX_NOTIFIES));
+  mReferenceCallbackNotifies.Entries = AllocateZeroPool (sizeof (VOID *) * TEST_MAX_NOTIFIES);
+  mReferenceDispatchNotifies.Entries = AllocateZeroPool (sizeof (VOID *) * TEST_MAX_NOTIFIES);
+  if ((mPpis == NULL) || (mNotifies == NULL) || (mReentrantPpis == NULL) ||
+      (mReentrantDone == NULL) || (mReferenceReentrantDone == NULL) ||
+      (mCalls == NULL) || (mReferenceCalls == NULL) || (mReferencePpis.Entries == NULL) ||
+      (mReferenceCallbackNotifies.Entries == NULL) || (mReferenceDispatchNotifies.Entries == NULL))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mPpiCount                                      = 0;
+  mNotifyCount                                   = 0;
+  mCallCount                                     = 0;
+  mReferenceCallCount                            = 0;
+  mReferencePpis.Count                           = 0;
+  mReferencePpis.LastDispatchedCount             = 0;
+  mReferenceCallbackNotifies.Count               = 0;
+  mReferenceDispatchNotifies.Count               = 0;
+  mReferenceDispatchNotifies.LastDispatchedCount = 0;
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the PEI Core PPI database and the linear model.
+
+  @param  Context  Unused.
+
+**/
+VOID
+EFIAPI
+TestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  VOID  **Buffers[] = {
+    (VOID **)&mPeiCore.PpiData.PpiList.PpiPtrs,
+    (VOID **)&mPeiCore.PpiData.CallbackNotifyList.NotifyPtrs,
+    (VOID **)&mPeiCore.PpiData.DispatchNotifyList.NotifyPtrs,
+    (VOID **)&mPpis,
+    (VOID **)&mNotifies,
+    (VOID **)&mReentrantPpis,
+    (VOID **)&mReentrantDone,
+    (VOID **)&mReferenceReentrantDone,
+    (VOID **)&mCalls,
+    (VOID **)&mReferenceCalls,
+    (VOID **)&mReferencePpis.Entries,
+    (VOID **)&mReferenceCallbackNotifies.Entries,
+    (VOID **)&mReferenceDispatchNotifies.Entries
+  };
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (Buffers); Index++) {
+    if (*Buffers[Index] != NULL) {
+      FreePool (*Buffers[Index]);
+      *Buffers[Index] = NULL;
+    }
+  }
+}
+
+/**
+  Check that random sequences of installs, notifies, reinstalls, locates and
+  dispatches locate the same PPIs, and call the same notify functions in the
+  same order, in the PEI Core and in the linear model.
+
+  Most PPI lists are shorter than the notify list, and the notify functions
+  are found from the PPIs. The longer ones find the PPIs from the notify
+  descriptors.
+
+  @param  Context  The TEST_CONTEXT of the test case.
+
+  @retval UNIT_TEST_PASSED             The PEI Core matches the linear model.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRandomSequence (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN                   Step;
+  UINTN                   Count;
+  UINTN                   Index;
+  UINTN                   Instance;
+  EFI_PEI_PPI_DESCRIPTOR  *OldPpi;
+  EFI_PEI_PPI_DESCRIPTOR  *Descriptor;
+  EFI_PEI_PPI_DESCRIPTOR  *Expected;
+  EFI_GUID                *Guid;
+  VOID                    *Ppi;
+  EFI_STATUS              Status;
+
+  for (Step = 0; Step < TEST_STEP_COUNT; Step++) {
+    switch (TestRandom () % 10) {
+      case 0:
+      case 1:
+      case 2:
+      case 3:
+        Count = 1 + TestRandom () % ((TestRandom () % 4 == 0) ? 12 : 2);
+        for (Index = 0; Index < Count; Index++) {
+          InitPpiDescriptor (&mPpis[mPpiCount + Index], (BOOLEAN)(Index == Count - 1));
+        }
+
+        UT_ASSERT_NOT_EFI_ERROR (PeiInstallPpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, &mPpis[mPpiCount]));
+        ReferenceInstallPpi (&mPpis[mPpiCount]);
+        mPpiCount += Count;
+        break;
+
+      case 4:
+      case 5:
+      case 6:
+        Count = 1 + TestRandom () % 3;
+        for (Index = mNotifyCount; Index < mNotifyCount + Count; Index++) {
+          mNotifies[Index].Flags  = (TestRandom () % 2 == 0) ? EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK : EFI_PEI_PPI_DESCRIPTOR_NOTIFY_DISPATCH;
+          mNotifies[Index].Guid   = RandomGuid ();
+          mNotifies[Index].Notify = TestNotify;
+          InitPpiDescriptor (&mReentrantPpis[Index], TRUE);
+        }
+
+        mNotifies[mNotifyCount + Count - 1].Flags |= EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST;
+        UT_ASSERT_NOT_EFI_ERROR (PeiNotifyPpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, &mNotifies[mNotifyCount]));
+        ReferenceNotifyPpi (&mNotifies[mNotifyCount]);
+        mNotifyCount += Count;
+        break;
+
+      case 7:
+        if (mReferencePpis.Count == 0) {
+          break;
+        }
+
+        OldPpi = mReferencePpis.Entries[TestRandom () % mReferencePpis.Count];
+        InitPpiDescriptor (&mPpis[mPpiCount], TRUE);
+        UT_ASSERT_NOT_EFI_ERROR (PeiReInstallPpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, OldPpi, &mPpis[mPpiCount]));
+        UT_ASSERT_TRUE (ReferenceReInstallPpi (OldPpi, &mPpis[mPpiCount]));
+        UT_ASSERT_STATUS_EQUAL (PeiReInstallPpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, OldPpi, &mPpis[mPpiCount]), EFI_NOT_FOUND);
+        mPpiCount++;
+        break;
+
+      case 8:
+        ProcessDispatchNotifyList (&mPeiCore);
+        ReferenceDispatchNotifyList ();
+        break;
+
+      default:
+        Guid     = RandomGuid ();
+        Instance = TestRandom () % 4;
+        Expected = ReferenceLocatePpi (Guid, Instance);
+        Status   = PeiLocatePpi ((CONST EFI_PEI_SERVICES **)&mPeiCore.Ps, Guid, Instance, &Descriptor, &Ppi);
+        if (Expected == NULL) {
+          UT_ASSERT_STATUS_EQUAL (Status, EFI_NOT_FOUND);
+        } else {
+          UT_ASSERT_NOT_EFI_ERROR (Status);
+          UT_ASSERT_EQUAL ((UINTN)Descriptor, (UINTN)Expected);
+          UT_ASSERT_EQUAL ((UINTN)Ppi, (UINTN)Expected->Ppi);
+        }
+
+        break;
+    }
+
+    UT_ASSERT_EQUAL (mPeiCore.PpiData.PpiList.CurrentCount, mReferencePpis.Count);
+    UT_ASSERT_EQUAL (mCallCount, mReferenceCallCount);
+    UT_ASSERT_MEM_EQUAL (mCalls, mReferenceCalls, sizeof (TEST_NOTIFY_CALL) * mCallCount);
+    mCallCount          = 0;
+    mReferenceCallCount = 0;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the PEI Core
+  PPI database, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      PpiTestSuite;
+  STATIC TEST_CONTEXT         Seed1 = { 1 };
+  STATIC TEST_CONTEXT         Seed2 = { 2 };
+  STATIC TEST_CONTEXT         Seed3 = { 3 };
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&PpiTestSuite, Framework, "PEI Core PPI test suite", "PeiCore.Ppi", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for PEI Core PPI test suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (PpiTestSuite, "Random sequence 1 against the linear model", "RandomSequence1", TestRandomSequence, TestSetup, TestCleanup, &Seed1);
+  AddTestCase (PpiTestSuite, "Random sequence 2 against the linear model", "RandomSequence2", TestRandomSequence, TestSetup, TestCleanup, &Seed2);
+  AddTestCase (PpiTestSuite, "Random sequence 3 against the linear model", "RandomSequence3", TestRandomSequence, TestSetup, TestCleanup, &Seed3);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,75 @@
+/** @file
+  GUID and layout of the debug message ring buffer.
+
+  The DXE Core instance of DxeDebugLibSerialPortRingBuffer allocates the ring
+  buffer and installs it in the System Configuration Table. The DebugLib
+  instances of the DXE drivers append their messages to it, and the messages
+  are written to the serial port when the UART can take them without waiting.
+
+  The counters of the ring buffer can be read from the table, for example with
+  the dmem shell command.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef EDKII_DEBUG_RING_BUFFER_H_
+#define EDKII_DEBUG_RING_BUFFER_H_
+
+#define EDKII_DEBUG_RING_BUFFER_GUID \
+  { \
+    0x38b03900, 0x2103, 0x4e34, { 0xaf, 0xa2, 0x15, 0x59, 0x27, 0x4a, 0x9c, 0xfc } \
+  }
+
+#define EDKII_DEBUG_RING_BUFFER_SIGNATURE  SIGNATURE_32 ('D', 'B', 'G', 'R')
+
+///
+/// A record starts with a UINT32 holding the length of the message and the
+/// committed flag, followed by the message. Records are aligned on 4 bytes,
+/// and the ring buffer is filled with zeroes where there is no record.
+///
+#define EDKII_DEBUG_RING_RECORD_COMMITTED  BIT31
+
+typedef struct {
+  UINT32             Signature;
+  ///
+  /// Size in bytes of Data, a power of 2.
+  ///
+  UINT32             Size;
+  ///
+  /// Free running offsets of the end of the last reserved record, and of the
+  /// first record not written to the serial port yet.
+  ///
+  volatile UINT32    Head;
+  volatile UINT32    Tail;
+  ///
+  /// Number of bytes of the record at Tail already written to the serial port.
+  ///
+  UINT32             TailWritten;
+  ///
+  /// Nonzero while a processor writes records to the serial port.
+  ///
+  volatile UINT32    DrainLock;
+  ///
+  /// Nonzero once the messages are written to the serial port directly, after
+  /// ExitBootServices().
+  ///
+  volatile UINT32    Bypass;
+  ///
+  /// Largest number of bytes used in Data.
+  ///
+  volatile UINT32    HighWater;
+  ///
+  /// Messages, and their bytes, dropped because Data was full.
+  ///
+  volatile UINT64    DroppedMessages;
+  volatile UINT64    DroppedBytes;
+  ///
+  /// UINT8  Data[Size];
+  ///
+} EDKII_DEBUG_RING_BUFFER;
+
+extern EFI_GUID  gEdkiiDebugRingBufferGuid;
+
+#endif
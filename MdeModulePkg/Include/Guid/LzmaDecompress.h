@@ -23,7 +23,40 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define LZMAF86_CUSTOM_DECOMPRESS_GUID  \
   { 0xD42AE6BD, 0x1352, 0x4bfb, { 0x90, 0x9A, 0xCA, 0x72, 0xA6, 0xEA, 0xE8, 0x89 } }
 
+///
+/// The Global ID used to identify a section of an FFS file of type
+/// EFI_SECTION_GUID_DEFINED, whose contents are a table of independently
+/// LZMA compressed chunks that may be decoded concurrently.
+///
+#define LZMA_CHUNKED_CUSTOM_DECOMPRESS_GUID  \
+  { 0xA62455E4, 0xC1CB, 0x469B, { 0x85, 0x2B, 0xB2, 0x2A, 0xDD, 0xBF, 0xBF, 0xAB } }
+
+#define LZMA_CHUNKED_SIGNATURE  SIGNATURE_32 ('L', 'Z', 'C', 'K')
+
+///
+/// Header of the LZMA chunked section payload. It is followed by ChunkCount
+/// LZMA_CHUNK_ENTRY structures and then by the compressed chunk data. Every
+/// chunk is a complete LZMA stream (properties, 64-bit decoded size and data)
+/// that decodes to ChunkSize bytes, except the last one that decodes to the
+/// remainder of DecodedSize.
+///
+typedef struct {
+  UINT32    Signature;
+  UINT32    ChunkCount;
+  UINT32    ChunkSize;
+  UINT32    DecodedSize;
+} LZMA_CHUNKED_HEADER;
+
+///
+/// Location of one compressed chunk, relative to the start of LZMA_CHUNKED_HEADER.
+///
+typedef struct {
+  UINT32    Offset;
+  UINT32    Size;
+} LZMA_CHUNK_ENTRY;
+
 extern GUID  gLzmaCustomDecompressGuid;
 extern GUID  gLzmaF86CustomDecompressGuid;
+extern GUID  gLzmaChunkedCustomDecompressGuid;
 
 #endif
@@ -0,0 +1,135 @@
+/** @file
+  GUID and layout of the binary trace buffers of TraceLib.
+
+  A trace buffer is a header followed by fixed-size timestamped records. Each
+  phase has its own trace buffer:
+  - The PEI buffer is the data of a GUIDed HOB, so that it is carried over to
+    DXE with the HOB list.
+  - The DXE Core allocates the DXE buffer and installs a table listing the PEI
+    and DXE buffers in the EFI System Configuration Table.
+  - The MM buffer is in SMRAM. It is read through an MMI handler registered
+    with the same GUID.
+
+  TraceBufferDump writes the buffers to a file, and the file is converted to
+  the Chrome trace event JSON format by BaseTools/Scripts/TraceBufferDecode.py.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+
+SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef EDKII_TRACE_BUFFER_H_
+#define EDKII_TRACE_BUFFER_H_
+
+#define EDKII_TRACE_BUFFER_GUID \
+  { \
+    0x5b9d2a47, 0x6e0c, 0x4f3b, { 0x9a, 0x51, 0x2c, 0x7e, 0x84, 0xd3, 0x16, 0xb0 } \
+  }
+
+#define EDKII_TRACE_BUFFER_SIGNATURE        SIGNATURE_32 ('T', 'R', 'C', 'B')
+#define EDKII_TRACE_BUFFER_TABLE_SIGNATURE  SIGNATURE_32 ('T', 'R', 'C', 'T')
+
+///
+/// Phase that wrote a trace buffer.
+///
+#define EDKII_TRACE_PHASE_PEI  1
+#define EDKII_TRACE_PHASE_DXE  2
+#define EDKII_TRACE_PHASE_MM   3
+
+///
+/// Type of a record, matching the phases of the Chrome trace event format.
+///
+#define EDKII_TRACE_TYPE_INSTANT  0
+#define EDKII_TRACE_TYPE_BEGIN    1
+#define EDKII_TRACE_TYPE_END      2
+#define EDKII_TRACE_TYPE_COUNTER  3
+
+typedef struct {
+  ///
+  /// Value of the performance counter when the record was written.
+  ///
+  UINT64    Timestamp;
+  ///
+  /// The single TRACE_CATEGORY_* bit of the trace point.
+  ///
+  UINT32    Category;
+  ///
+  /// Identifier of the event within its category.
+  ///
+  UINT16    Event;
+  ///
+  /// EDKII_TRACE_TYPE_*.
+  ///
+  UINT8     Type;
+  UINT8     Reserved;
+  UINT64    Arg0;
+  UINT64    Arg1;
+} EDKII_TRACE_RECORD;
+
+typedef struct {
+  UINT32             Signature;
+  ///
+  /// Size in bytes of this header, the records start right after it.
+  ///
+  UINT32             HeaderSize;
+  ///
+  /// Size in bytes of a record.
+  ///
+  UINT32             RecordSize;
+  ///
+  /// EDKII_TRACE_PHASE_*.
+  ///
+  UINT32             Phase;
+  ///
+  /// Number of records the buffer can hold.
+  ///
+  UINT32             Capacity;
+  ///
+  /// Number of records reserved. It may exceed Capacity by the number of
+  /// processors racing to write the last record, the records past Capacity
+  /// are not written.
+  ///
+  volatile UINT32    Count;
+  ///
+  /// Number of records dropped because the buffer was full.
+  ///
+  volatile UINT32    Dropped;
+  UINT32             Reserved;
+  ///
+  /// Properties of the performance counter, as returned by
+  /// GetPerformanceCounterProperties().
+  ///
+  UINT64             Frequency;
+  UINT64             StartValue;
+  UINT64             EndValue;
+  ///
+  /// EDKII_TRACE_RECORD  Record[Capacity];
+  ///
+} EDKII_TRACE_BUFFER;
+
+///
+/// Table installed in the EFI System Configuration Table by the DXE Core.
+///
+typedef struct {
+  UINT32                  Signature;
+  UINT32                  NumberOfBuffers;
+  ///
+  /// EFI_PHYSICAL_ADDRESS  Buffer[NumberOfBuffers];
+  ///
+} EDKII_TRACE_BUFFER_TABLE;
+
+///
+/// Request of the MMI handler, followed by the data read. The handler copies
+/// up to Size bytes of the MM buffer from Offset, and sets Size to the number
+/// of bytes copied. Offset 0 starts with the header, which gives the size of
+/// the rest of the buffer.
+///
+typedef struct {
+  UINT64    ReturnStatus;
+  UINT64    Offset;
+  UINT64    Size;
+} EDKII_TRACE_BUFFER_COMMUNICATE;
+
+extern GUID  gEdkiiTraceBufferGuid;
+
+#endif
@@ -0,0 +1,133 @@
+/** @file
+  Provides services to write timestamped records in a binary trace buffer.
+
+  The trace points are filtered at compile time: a TRACE_* macro expands to
+  nothing unless its category is set in EDKII_TRACE_CATEGORIES, which is
+  defined to a mask of TRACE_CATEGORY_* bits in the build options of the
+  platform, for example:
+
+    [BuildOptions]
+      *_*_*_CC_FLAGS = -D EDKII_TRACE_CATEGORIES=0x3
+
+  The records are written in the trace buffer of the current phase, see
+  Guid/TraceBuffer.h. Writing a record takes one interlocked operation and a
+  read of the performance counter, so trace points may be placed on hot paths,
+  on any processor and at any TPL. In PEI, this holds once the module runs
+  from permanent memory; before, the trace buffer is searched in the HOB list
+  for each record, so the application processors must not write records.
+
+Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TRACE_LIB_H_
+#define TRACE_LIB_H_
+
+#include <Guid/TraceBuffer.h>
+
+///
+/// Categories of trace points. The bits from TRACE_CATEGORY_PLATFORM are
+/// free for platform specific trace points.
+///
+#define TRACE_CATEGORY_PROTOCOL     BIT0
+#define TRACE_CATEGORY_MEMORY       BIT1
+#define TRACE_CATEGORY_EVENT        BIT2
+#define TRACE_CATEGORY_IMAGE        BIT3
+#define TRACE_CATEGORY_STATUS_CODE  BIT4
+#define TRACE_CATEGORY_PERFORMANCE  BIT5
+#define TRACE_CATEGORY_MM           BIT6
+#define TRACE_CATEGORY_PLATFORM     BIT16
+
+#ifndef EDKII_TRACE_CATEGORIES
+#define EDKII_TRACE_CATEGORIES  0
+#endif
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  );
+
+/**
+  Internal worker macro that calls TraceRecord() if Category is enabled.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+#define _TRACE(Category, Event, Type, Arg0, Arg1)                                       \
+  do {                                                                                  \
+    if (((EDKII_TRACE_CATEGORIES) & (Category)) != 0) {                                 \
+      TraceRecord ((Category), (UINT16)(Event), (Type), (UINT64)(Arg0), (UINT64)(Arg1)); \
+    }                                                                                   \
+  } while (FALSE)
+
+/**
+  Trace an event without duration.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+#define TRACE_INSTANT(Category, Event, Arg0, Arg1)  \
+  _TRACE (Category, Event, EDKII_TRACE_TYPE_INSTANT, Arg0, Arg1)
+
+/**
+  Trace the start of an event with a duration. The event ends with the next
+  TRACE_END() of the same category and identifier.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+#define TRACE_BEGIN(Category, Event, Arg0, Arg1)  \
+  _TRACE (Category, Event, EDKII_TRACE_TYPE_BEGIN, Arg0, Arg1)
+
+/**
+  Trace the end of an event started with TRACE_BEGIN().
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+#define TRACE_END(Category, Event, Arg0, Arg1)  \
+  _TRACE (Category, Event, EDKII_TRACE_TYPE_END, Arg0, Arg1)
+
+/**
+  Trace the value of a counter, such as the number of pages allocated.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the counter within its category.
+  @param  Value     Value of the counter.
+
+**/
+#define TRACE_COUNTER(Category, Event, Value)  \
+  _TRACE (Category, Event, EDKII_TRACE_TYPE_COUNTER, Value, 0)
+
+#endif
@@ -0,0 +1,34 @@
+/** @file
+  Null instance of the Trace library. The records are dropped.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/TraceLib.h>
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  )
+{
+}
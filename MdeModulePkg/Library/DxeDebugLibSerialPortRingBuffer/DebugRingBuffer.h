@@ -0,0 +1,69 @@
+/** @file
+  Internal definitions of the Debug library instance based on a ring buffer
+  drained to the Serial Port library.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef DEBUG_RING_BUFFER_H_
+#define DEBUG_RING_BUFFER_H_
+
+#include <Uefi.h>
+#include <Guid/DebugRingBuffer.h>
+#include <Library/DebugLib.h>
+#include <Library/DebugPrintErrorLevelLib.h>
+#include <Library/BaseLib.h>
+#include <Library/PrintLib.h>
+#include <Library/PcdLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/SerialPortLib.h>
+#include <Library/SynchronizationLib.h>
+
+//
+// The ring buffer shared by the modules, NULL if the messages are written to
+// the serial port directly.
+//
+extern EDKII_DEBUG_RING_BUFFER  *mDebugRingBuffer;
+
+/**
+  Append a message to the ring buffer.
+
+  It may be called on any processor and at any TPL, including while another
+  caller is interrupted in the middle of an append.
+
+  @param  RingBuffer  The ring buffer.
+  @param  Message     The message.
+  @param  Length      The length in bytes of the message.
+
+  @retval TRUE   The message was appended.
+  @retval FALSE  The ring buffer is full, the message was dropped.
+
+**/
+BOOLEAN
+DebugRingBufferAppend (
+  IN EDKII_DEBUG_RING_BUFFER  *RingBuffer,
+  IN CONST UINT8              *Message,
+  IN UINT32                   Length
+  );
+
+/**
+  Write the messages of the ring buffer to the serial port.
+
+  Nothing is done if another caller is writing the ring buffer, or when a
+  message is still being appended.
+
+  @param  RingBuffer  The ring buffer.
+  @param  Flush       TRUE to write all the messages, waiting for the UART.
+                      FALSE to only write while the transmit buffer of the UART
+                      is empty, so that the serial port writes do not wait.
+
+**/
+VOID
+DebugRingBufferDrain (
+  IN EDKII_DEBUG_RING_BUFFER  *RingBuffer,
+  IN BOOLEAN                  Flush
+  );
+
+#endif
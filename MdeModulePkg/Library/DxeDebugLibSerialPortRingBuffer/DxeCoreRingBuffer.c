@@ -0,0 +1,158 @@
+/** @file
+  Create the debug message ring buffer in the DXE Core, and write it to the
+  serial port from a periodic timer.
+
+  The DXE Core owns the ring buffer and its events as it is never unloaded.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DebugRingBuffer.h"
+#include <Library/MemoryAllocationLib.h>
+
+STATIC EFI_EVENT  mDrainTimerEvent;
+STATIC EFI_EVENT  mExitBootServicesEvent;
+
+/**
+  Write the messages of the ring buffer to the serial port while the UART is
+  idle.
+
+  @param[in]  Event   The Event that is being processed.
+  @param[in]  Context The Event Context.
+
+**/
+STATIC
+VOID
+EFIAPI
+DrainTimerEvent (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  DebugRingBufferDrain (mDebugRingBuffer, FALSE);
+}
+
+/**
+  Write all the messages of the ring buffer, and write the later messages to
+  the serial port directly, as there are no more timer events.
+
+  @param[in]  Event   The Event that is being processed.
+  @param[in]  Context The Event Context.
+
+**/
+STATIC
+VOID
+EFIAPI
+ExitBootServicesEvent (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mDebugRingBuffer->Bypass = 1;
+  DebugRingBufferDrain (mDebugRingBuffer, TRUE);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "DebugRingBuffer: high water %d of %d bytes, %ld messages (%ld bytes) dropped\n",
+    mDebugRingBuffer->HighWater,
+    mDebugRingBuffer->Size,
+    mDebugRingBuffer->DroppedMessages,
+    mDebugRingBuffer->DroppedBytes
+    ));
+}
+
+/**
+  The constructor function initializes the Serial Port library, creates the
+  ring buffer and installs it in the EFI System Configuration Table.
+
+  The messages are written to the serial port directly if the ring buffer
+  cannot be created.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The operation completed successfully.
+  @retval other         The serial port failed to initialize.
+**/
+EFI_STATUS
+EFIAPI
+DxeCoreDebugLibSerialPortRingBufferConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS               Status;
+  EDKII_DEBUG_RING_BUFFER  *RingBuffer;
+  UINT32                   Size;
+
+  Status = SerialPortInitialize ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Size = PcdGet32 (PcdDebugRingBufferSize);
+  if ((Size < SIZE_4KB) || ((Size & (Size - 1)) != 0)) {
+    DEBUG ((DEBUG_ERROR, "DebugRingBuffer: invalid size 0x%x\n", Size));
+    return EFI_SUCCESS;
+  }
+
+  RingBuffer = AllocateZeroPool (sizeof (EDKII_DEBUG_RING_BUFFER) + Size);
+  if (RingBuffer == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  RingBuffer->Signature = EDKII_DEBUG_RING_BUFFER_SIGNATURE;
+  RingBuffer->Size      = Size;
+
+  //
+  // The event services are not initialized yet, but creating events and
+  // arming timers only uses lists that are statically initialized. The timer
+  // runs once the Timer Architectural Protocol is installed.
+  //
+  Status = SystemTable->BootServices->CreateEvent (
+                                        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                                        TPL_CALLBACK,
+                                        DrainTimerEvent,
+                                        NULL,
+                                        &mDrainTimerEvent
+                                        );
+  if (!EFI_ERROR (Status)) {
+    Status = SystemTable->BootServices->CreateEvent (
+                                          EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                                          TPL_NOTIFY,
+                                          ExitBootServicesEvent,
+                                          NULL,
+                                          &mExitBootServicesEvent
+                                          );
+    if (EFI_ERROR (Status)) {
+      SystemTable->BootServices->CloseEvent (mDrainTimerEvent);
+    }
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = SystemTable->BootServices->SetTimer (
+                                          mDrainTimerEvent,
+                                          TimerPeriodic,
+                                          PcdGet32 (PcdDebugRingBufferDrainPeriod)
+                                          );
+  }
+
+  if (!EFI_ERROR (Status)) {
+    Status = SystemTable->BootServices->InstallConfigurationTable (&gEdkiiDebugRingBufferGuid, RingBuffer);
+  }
+
+  if (EFI_ERROR (Status)) {
+    if (mExitBootServicesEvent != NULL) {
+      SystemTable->BootServices->CloseEvent (mExitBootServicesEvent);
+      SystemTable->BootServices->CloseEvent (mDrainTimerEvent);
+    }
+
+    FreePool (RingBuffer);
+    return EFI_SUCCESS;
+  }
+
+  mDebugRingBuffer = RingBuffer;
+  return EFI_SUCCESS;
+}
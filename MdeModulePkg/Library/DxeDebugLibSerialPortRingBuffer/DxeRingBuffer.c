@@ -0,0 +1,44 @@
+/** @file
+  Find the debug message ring buffer created by the DXE Core.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DebugRingBuffer.h"
+
+/**
+  The constructor function looks for the ring buffer in the EFI System
+  Configuration Table. If the DXE Core did not create it, the messages are
+  written to the serial port directly, and the Serial Port library is
+  initialized.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The operation completed successfully.
+  @retval other         The serial port failed to initialize.
+**/
+EFI_STATUS
+EFIAPI
+DxeDebugLibSerialPortRingBufferConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  UINTN                    Index;
+  EDKII_DEBUG_RING_BUFFER  *RingBuffer;
+
+  for (Index = 0; Index < SystemTable->NumberOfTableEntries; Index++) {
+    if (CompareGuid (&gEdkiiDebugRingBufferGuid, &SystemTable->ConfigurationTable[Index].VendorGuid)) {
+      RingBuffer = SystemTable->ConfigurationTable[Index].VendorTable;
+      if (RingBuffer->Signature == EDKII_DEBUG_RING_BUFFER_SIGNATURE) {
+        mDebugRingBuffer = RingBuffer;
+        return EFI_SUCCESS;
+      }
+    }
+  }
+
+  return SerialPortInitialize ();
+}
@@ -0,0 +1,234 @@
+/** @file
+  Lock-free ring buffer of debug messages.
+
+  The writers reserve their record by moving Head with a compare exchange,
+  copy the message, then set the committed flag of the record. The serial
+  port is written by one caller at a time, which owns Tail. It stops at the
+  first record that is not committed yet, and zeroes the records it consumed
+  so that a record header never holds stale data.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "DebugRingBuffer.h"
+
+#define RECORD_HEADER_SIZE  sizeof (UINT32)
+
+/**
+  Return the data of the ring buffer.
+
+  @param  RingBuffer  The ring buffer.
+
+  @return The data that follows the header of the ring buffer.
+
+**/
+UINT8 *
+DebugRingBufferData (
+  IN EDKII_DEBUG_RING_BUFFER  *RingBuffer
+  )
+{
+  return (UINT8 *)(RingBuffer + 1);
+}
+
+/**
+  Add to a 64-bit counter of the ring buffer.
+
+  @param  Counter  The counter.
+  @param  Value    The value to add.
+
+**/
+VOID
+DebugRingBufferAddCounter (
+  IN volatile UINT64  *Counter,
+  IN UINT64           Value
+  )
+{
+  UINT64  Old;
+
+  do {
+    Old = *Counter;
+  } while (InterlockedCompareExchange64 (Counter, Old, Old + Value) != Old);
+}
+
+/**
+  Append a message to the ring buffer.
+
+  It may be called on any processor and at any TPL, including while another
+  caller is interrupted in the middle of an append.
+
+  @param  RingBuffer  The ring buffer.
+  @param  Message     The message.
+  @param  Length      The length in bytes of the message.
+
+  @retval TRUE   The message was appended.
+  @retval FALSE  The ring buffer is full, the message was dropped.
+
+**/
+BOOLEAN
+DebugRingBufferAppend (
+  IN EDKII_DEBUG_RING_BUFFER  *RingBuffer,
+  IN CONST UINT8              *Message,
+  IN UINT32                   Length
+  )
+{
+  UINT8   *Data;
+  UINT32  Mask;
+  UINT32  RecordSize;
+  UINT32  Head;
+  UINT32  Used;
+  UINT32  HighWater;
+  UINT32  Start;
+  UINT32  Count;
+
+  Data       = DebugRingBufferData (RingBuffer);
+  Mask       = RingBuffer->Size - 1;
+  RecordSize = ALIGN_VALUE (RECORD_HEADER_SIZE + Length, RECORD_HEADER_SIZE);
+
+  //
+  // Reserve the record. Tail only grows, so a stale value of it only makes
+  // the ring buffer look fuller than it is.
+  //
+  do {
+    Head = RingBuffer->Head;
+    Used = Head - RingBuffer->Tail;
+    if ((RecordSize > RingBuffer->Size) || (Used + RecordSize > RingBuffer->Size)) {
+      DebugRingBufferAddCounter (&RingBuffer->DroppedMessages, 1);
+      DebugRingBufferAddCounter (&RingBuffer->DroppedBytes, Length);
+      return FALSE;
+    }
+  } while (InterlockedCompareExchange32 (&RingBuffer->Head, Head, Head + RecordSize) != Head);
+
+  do {
+    HighWater = RingBuffer->HighWater;
+  } while ((Used + RecordSize > HighWater) &&
+           (InterlockedCompareExchange32 (&RingBuffer->HighWater, HighWater, Used + RecordSize) != HighWater));
+
+  //
+  // Copy the message, which may wrap around the end of the ring buffer. The
+  // record headers are aligned, so they never wrap.
+  //
+  Start = (Head + RECORD_HEADER_SIZE) & Mask;
+  Count = MIN (Length, RingBuffer->Size - Start);
+  CopyMem (&Data[Start], Message, Count);
+  CopyMem (Data, Message + Count, Length - Count);
+
+  //
+  // Commit the record once its message is visible.
+  //
+  MemoryFence ();
+  *(volatile UINT32 *)&Data[Head & Mask] = Length | EDKII_DEBUG_RING_RECORD_COMMITTED;
+  return TRUE;
+}
+
+/**
+  Check if the serial port can be written without waiting.
+
+  @retval TRUE   The transmit buffer of the UART is empty, or its state is
+                 not known.
+  @retval FALSE  The transmit buffer of the UART is not empty.
+
+**/
+BOOLEAN
+DebugRingBufferSerialPortReady (
+  VOID
+  )
+{
+  UINT32         Control;
+  RETURN_STATUS  Status;
+
+  Status = SerialPortGetControl (&Control);
+  if (RETURN_ERROR (Status)) {
+    return TRUE;
+  }
+
+  return (BOOLEAN)((Control & EFI_SERIAL_OUTPUT_BUFFER_EMPTY) != 0);
+}
+
+/**
+  Write the messages of the ring buffer to the serial port.
+
+  Nothing is done if another caller is writing the ring buffer, or when a
+  message is still being appended.
+
+  @param  RingBuffer  The ring buffer.
+  @param  Flush       TRUE to write all the messages, waiting for the UART.
+                      FALSE to only write while the transmit buffer of the UART
+                      is empty, so that the serial port writes do not wait.
+
+**/
+VOID
+DebugRingBufferDrain (
+  IN EDKII_DEBUG_RING_BUFFER  *RingBuffer,
+  IN BOOLEAN                  Flush
+  )
+{
+  UINT8   *Data;
+  UINT32  Mask;
+  UINT32  Tail;
+  UINT32  Header;
+  UINT32  Length;
+  UINT32  RecordSize;
+  UINT32  Start;
+  UINT32  Count;
+  UINT32  Chunk;
+
+  if (InterlockedCompareExchange32 (&RingBuffer->DrainLock, 0, 1) != 0) {
+    return;
+  }
+
+  Data = DebugRingBufferData (RingBuffer);
+  Mask = RingBuffer->Size - 1;
+
+  while (RingBuffer->Tail != RingBuffer->Head) {
+    Tail   = RingBuffer->Tail;
+    Header = *(volatile UINT32 *)&Data[Tail & Mask];
+    if ((Header & EDKII_DEBUG_RING_RECORD_COMMITTED) == 0) {
+      break;
+    }
+
+    Length = Header & ~EDKII_DEBUG_RING_RECORD_COMMITTED;
+
+    //
+    // Write the rest of the message, a UART FIFO at a time unless flushing.
+    //
+    while (RingBuffer->TailWritten < Length) {
+      if (!Flush && !DebugRingBufferSerialPortReady ()) {
+        goto Done;
+      }
+
+      Chunk = Length - RingBuffer->TailWritten;
+      if (!Flush) {
+        Chunk = MIN (Chunk, PcdGet32 (PcdDebugRingBufferDrainChunkSize));
+      }
+
+      Start = (Tail + RECORD_HEADER_SIZE + RingBuffer->TailWritten) & Mask;
+      Count = MIN (Chunk, RingBuffer->Size - Start);
+      SerialPortWrite (&Data[Start], Count);
+      if (Chunk > Count) {
+        SerialPortWrite (Data, Chunk - Count);
+      }
+
+      RingBuffer->TailWritten += Chunk;
+    }
+
+    //
+    // Release the record. It is zeroed first, so that the header of a later
+    // record reserved over it reads as not committed.
+    //
+    RecordSize = ALIGN_VALUE (RECORD_HEADER_SIZE + Length, RECORD_HEADER_SIZE);
+    Start      = Tail & Mask;
+    Count      = MIN (RecordSize, RingBuffer->Size - Start);
+    ZeroMem (&Data[Start], Count);
+    ZeroMem (Data, RecordSize - Count);
+
+    RingBuffer->TailWritten = 0;
+    MemoryFence ();
+    RingBuffer->Tail = Tail + RecordSize;
+  }
+
+Done:
+  MemoryFence ();
+  RingBuffer->DrainLock = 0;
+}
@@ -0,0 +1,368 @@
+/** @file
+  LZMA Chunked Decompress GUIDed Section Extraction Library.
+  It decodes sections whose payload is a table of independently LZMA
+  compressed chunks. The phase specific constructors register the handlers
+  into GUIDed handler table.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaChunkedDecompressLibInternal.h"
+
+///
+/// Size of the LZMA stream header: 5 bytes of properties and 8 bytes of decoded size.
+///
+#define LZMA_CHUNK_HEADER_SIZE  13
+
+/**
+  Locate and validate the chunk table of an LZMA chunked GUIDed section.
+
+  Every chunk must lie within the section and must decode to exactly the number
+  of bytes its position in the output buffer leaves room for, so the chunks can
+  be decoded in any order and on any processor.
+
+  @param[in]  InputSection      A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] Header            The header of the chunk table.
+  @param[out] SectionAttribute  The attributes of the GUIDed section. Optional.
+
+  @retval  RETURN_SUCCESS            The chunk table is valid.
+  @retval  RETURN_INVALID_PARAMETER  The section is not an LZMA chunked section,
+                                     or its chunk table is malformed.
+**/
+STATIC
+RETURN_STATUS
+LzmaChunkedGetHeader (
+  IN  CONST VOID                  *InputSection,
+  OUT CONST LZMA_CHUNKED_HEADER   **Header,
+  OUT UINT16                      *SectionAttribute OPTIONAL
+  )
+{
+  CONST UINT8             *Payload;
+  UINT32                  PayloadSize;
+  CONST LZMA_CHUNK_ENTRY  *Entries;
+  UINT32                  Index;
+  UINT32                  ExpectedSize;
+  UINT32                  ChunkDecodedSize;
+  UINT32                  ChunkScratchSize;
+  RETURN_STATUS           Status;
+
+  if (IS_SECTION2 (InputSection)) {
+    if (!CompareGuid (
+           &gLzmaChunkedCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION2 *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if (SectionAttribute != NULL) {
+      *SectionAttribute = ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->Attributes;
+    }
+
+    Payload     = (UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset;
+    PayloadSize = SECTION2_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION2 *)InputSection)->DataOffset;
+  } else {
+    if (!CompareGuid (
+           &gLzmaChunkedCustomDecompressGuid,
+           &(((EFI_GUID_DEFINED_SECTION *)InputSection)->SectionDefinitionGuid)
+           ))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if (SectionAttribute != NULL) {
+      *SectionAttribute = ((EFI_GUID_DEFINED_SECTION *)InputSection)->Attributes;
+    }
+
+    Payload     = (UINT8 *)InputSection + ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset;
+    PayloadSize = SECTION_SIZE (InputSection) - ((EFI_GUID_DEFINED_SECTION *)InputSection)->DataOffset;
+  }
+
+  if (PayloadSize < sizeof (LZMA_CHUNKED_HEADER)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  *Header = (CONST LZMA_CHUNKED_HEADER *)Payload;
+  if (((*Header)->Signature != LZMA_CHUNKED_SIGNATURE) ||
+      ((*Header)->ChunkCount == 0) ||
+      ((*Header)->ChunkSize == 0) ||
+      ((*Header)->ChunkCount != (*Header)->DecodedSize / (*Header)->ChunkSize +
+       ((((*Header)->DecodedSize % (*Header)->ChunkSize) != 0) ? 1 : 0)) ||
+      ((*Header)->ChunkCount > (PayloadSize - sizeof (LZMA_CHUNKED_HEADER)) / sizeof (LZMA_CHUNK_ENTRY)))
+  {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Entries = (CONST LZMA_CHUNK_ENTRY *)(*Header + 1);
+  for (Index = 0; Index < (*Header)->ChunkCount; Index++) {
+    if ((Entries[Index].Size < LZMA_CHUNK_HEADER_SIZE) ||
+        (Entries[Index].Offset > PayloadSize) ||
+        (Entries[Index].Size > PayloadSize - Entries[Index].Offset))
+    {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if (Index == (*Header)->ChunkCount - 1) {
+      ExpectedSize = (*Header)->DecodedSize - Index * (*Header)->ChunkSize;
+    } else {
+      ExpectedSize = (*Header)->ChunkSize;
+    }
+
+    Status = LzmaUefiDecompressGetInfo (
+               Payload + Entries[Index].Offset,
+               Entries[Index].Size,
+               &ChunkDecodedSize,
+               &ChunkScratchSize
+               );
+    if (RETURN_ERROR (Status) || (ChunkDecodedSize != ExpectedSize)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Return the number of processors that decode the chunks of a section.
+
+  @param[in] Header  The header of the chunk table.
+
+  @return The number of LZMA scratch buffers required to decode the section.
+**/
+STATIC
+UINT32
+LzmaChunkedGetWorkerCount (
+  IN CONST LZMA_CHUNKED_HEADER  *Header
+  )
+{
+  return MAX (1, MIN (Header->ChunkCount, PcdGet32 (PcdLzmaChunkedDecompressMaxWorkers)));
+}
+
+/**
+  Decode chunks of a chunked section until none is left.
+
+  It is run concurrently by the BSP and by the APs. Each processor claims a
+  private scratch buffer slot, then repeatedly claims the next undecoded chunk.
+  A processor that finds no free scratch buffer slot returns immediately.
+
+  @param[in, out] Buffer  Pointer to the LZMA_CHUNKED_CONTEXT of the section.
+**/
+VOID
+EFIAPI
+LzmaChunkedDecompressWorker (
+  IN OUT VOID  *Buffer
+  )
+{
+  LZMA_CHUNKED_CONTEXT  *Context;
+  UINT32                Worker;
+  UINT32                Chunk;
+  UINT8                 *Scratch;
+  RETURN_STATUS         Status;
+
+  Context = (LZMA_CHUNKED_CONTEXT *)Buffer;
+
+  Worker = InterlockedIncrement (&Context->NextWorker) - 1;
+  if (Worker >= Context->MaxWorkers) {
+    return;
+  }
+
+  Scratch = Context->Scratch + Worker * Context->ScratchSizePerWorker;
+
+  while (Context->Failed == 0) {
+    Chunk = InterlockedIncrement (&Context->NextChunk) - 1;
+    if (Chunk >= Context->ChunkCount) {
+      break;
+    }
+
+    Status = LzmaUefiDecompress (
+               Context->Payload + Context->Entries[Chunk].Offset,
+               Context->Entries[Chunk].Size,
+               Context->Destination + (UINTN)Chunk * Context->ChunkSize,
+               Scratch
+               );
+    if (RETURN_ERROR (Status)) {
+      InterlockedCompareExchange32 (&Context->Failed, 0, 1);
+    }
+  }
+}
+
+/**
+  Examines a GUIDed section and returns the size of the decoded buffer and the
+  size of an scratch buffer required to actually decode the data in a GUIDed section.
+
+  Examines a GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports,
+  then RETURN_UNSUPPORTED is returned.
+  If the required information can not be retrieved from InputSection,
+  then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports,
+  then the size required to hold the decoded buffer is returned in OututBufferSize,
+  the size of an optional scratch buffer is returned in ScratchSize, and the Attributes field
+  from EFI_GUID_DEFINED_SECTION header of InputSection is returned in SectionAttribute.
+
+  The scratch buffer holds one LZMA scratch buffer per processor that takes
+  part in decoding the section.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBufferSize is NULL, then ASSERT().
+  If ScratchBufferSize is NULL, then ASSERT().
+  If SectionAttribute is NULL, then ASSERT().
+
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section. See the Attributes
+                                 field of EFI_GUID_DEFINED_SECTION in the PI Specification.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  )
+{
+  CONST LZMA_CHUNKED_HEADER  *Header;
+  CONST LZMA_CHUNK_ENTRY     *Entries;
+  UINT32                     ChunkDecodedSize;
+  UINT32                     ChunkScratchSize;
+  RETURN_STATUS              Status;
+
+  ASSERT (InputSection != NULL);
+  ASSERT (OutputBufferSize != NULL);
+  ASSERT (ScratchBufferSize != NULL);
+  ASSERT (SectionAttribute != NULL);
+
+  Status = LzmaChunkedGetHeader (InputSection, &Header, SectionAttribute);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Entries = (CONST LZMA_CHUNK_ENTRY *)(Header + 1);
+  Status  = LzmaUefiDecompressGetInfo (
+              (CONST UINT8 *)Header + Entries[0].Offset,
+              Entries[0].Size,
+              &ChunkDecodedSize,
+              &ChunkScratchSize
+              );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  *OutputBufferSize  = Header->DecodedSize;
+  *ScratchBufferSize = ChunkScratchSize * LzmaChunkedGetWorkerCount (Header);
+  return RETURN_SUCCESS;
+}
+
+/**
+  Decompress a LZMA chunked GUIDed section into a caller allocated output buffer.
+
+  Decodes the GUIDed section specified by InputSection.
+  If GUID for InputSection does not match the GUID that this handler supports, then RETURN_UNSUPPORTED is returned.
+  If the data in InputSection can not be decoded, then RETURN_INVALID_PARAMETER is returned.
+  If the GUID of InputSection does match the GUID that this handler supports, then InputSection
+  is decoded into the buffer specified by OutputBuffer and the authentication status of this
+  decode operation is returned in AuthenticationStatus.  If the decoded buffer is identical to the
+  data in InputSection, then OutputBuffer is set to point at the data in InputSection.  Otherwise,
+  the decoded data will be placed in caller allocated buffer specified by OutputBuffer.
+
+  The chunks are decoded concurrently on the processors of the system when
+  multi-processor services are available, and on the BSP otherwise.
+
+  If InputSection is NULL, then ASSERT().
+  If OutputBuffer is NULL, then ASSERT().
+  If ScratchBuffer is NULL and this decode operation requires a scratch buffer, then ASSERT().
+  If AuthenticationStatus is NULL, then ASSERT().
+
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer that may be required by this function
+                            as a scratch buffer to perform the decode operation.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+                            See the definition of authentication status in the EFI_PEI_GUIDED_SECTION_EXTRACTION_PPI
+                            section of the PI Specification. EFI_AUTH_STATUS_PLATFORM_OVERRIDE must
+                            never be set by this handler.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_UNSUPPORTED        The section specified by InputSection does not match the GUID this handler supports.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  )
+{
+  CONST LZMA_CHUNKED_HEADER  *Header;
+  LZMA_CHUNKED_CONTEXT       Context;
+  UINT32                     ChunkDecodedSize;
+  RETURN_STATUS              Status;
+
+  ASSERT (OutputBuffer != NULL);
+  ASSERT (InputSection != NULL);
+  ASSERT (ScratchBuffer != NULL);
+
+  Status = LzmaChunkedGetHeader (InputSection, &Header, NULL);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Authentication is set to Zero, which may be ignored.
+  //
+  *AuthenticationStatus = 0;
+
+  ZeroMem (&Context, sizeof (Context));
+  Context.Payload     = (CONST UINT8 *)Header;
+  Context.Entries     = (CONST LZMA_CHUNK_ENTRY *)(Header + 1);
+  Context.ChunkCount  = Header->ChunkCount;
+  Context.ChunkSize   = Header->ChunkSize;
+  Context.Destination = *OutputBuffer;
+  Context.Scratch     = ScratchBuffer;
+  Context.MaxWorkers  = LzmaChunkedGetWorkerCount (Header);
+  Status              = LzmaUefiDecompressGetInfo (
+                          Context.Payload + Context.Entries[0].Offset,
+                          Context.Entries[0].Size,
+                          &ChunkDecodedSize,
+                          &Context.ScratchSizePerWorker
+                          );
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  PERF_INMODULE_BEGIN ("LzmaChunkedDecompress");
+  LzmaChunkedDecompressDispatch (&Context);
+  PERF_INMODULE_END ("LzmaChunkedDecompress");
+
+  DEBUG ((
+    DEBUG_VERBOSE,
+    "%a: %d chunks of 0x%x bytes decoded by up to %d processors\n",
+    __func__,
+    Context.ChunkCount,
+    Context.ChunkSize,
+    MIN (Context.NextWorker, Context.MaxWorkers)
+    ));
+
+  if (Context.Failed != 0) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return RETURN_SUCCESS;
+}
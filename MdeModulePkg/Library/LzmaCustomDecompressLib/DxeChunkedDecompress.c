@@ -0,0 +1,102 @@
+/** @file
+  DXE phase dispatch of the LZMA chunked section decoder.
+
+  The chunks are decoded by the BSP and the APs together through the MP
+  services protocol. The BSP decodes the section by itself when the protocol
+  is not installed yet, or when the caller runs at a TPL that prevents the
+  completion of non-blocking AP procedures from being signaled.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaChunkedDecompressLibInternal.h"
+#include <Protocol/MpService.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+/**
+  Run LzmaChunkedDecompressWorker() on as many processors as available.
+
+  The function returns only when all the chunks of Context have been decoded,
+  or when a chunk failed to decode.
+
+  @param[in, out] Context  The chunked section decode context.
+**/
+VOID
+LzmaChunkedDecompressDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  EFI_STATUS                Status;
+  EFI_MP_SERVICES_PROTOCOL  *MpServices;
+  EFI_EVENT                 ApDoneEvent;
+  EFI_TPL                   OldTpl;
+
+  ApDoneEvent = NULL;
+
+  if ((Context->MaxWorkers > 1) && (gBS != NULL)) {
+    OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    gBS->RestoreTPL (OldTpl);
+
+    if (OldTpl < TPL_NOTIFY) {
+      Status = gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices);
+      if (!EFI_ERROR (Status)) {
+        Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &ApDoneEvent);
+        if (!EFI_ERROR (Status)) {
+          Status = MpServices->StartupAllAPs (
+                                 MpServices,
+                                 LzmaChunkedDecompressWorker,
+                                 FALSE,
+                                 ApDoneEvent,
+                                 0,
+                                 Context,
+                                 NULL
+                                 );
+          if (EFI_ERROR (Status)) {
+            DEBUG ((DEBUG_VERBOSE, "%a: StartupAllAPs - %r\n", __func__, Status));
+            gBS->CloseEvent (ApDoneEvent);
+            ApDoneEvent = NULL;
+          }
+        }
+      }
+    }
+  }
+
+  //
+  // The BSP takes its share of the chunks while the APs are running.
+  //
+  LzmaChunkedDecompressWorker (Context);
+
+  if (ApDoneEvent != NULL) {
+    while (gBS->CheckEvent (ApDoneEvent) == EFI_NOT_READY) {
+      CpuPause ();
+    }
+
+    gBS->CloseEvent (ApDoneEvent);
+  }
+}
+
+/**
+  Register LzmaChunkedDecompress and LzmaChunkedDecompressGetInfo handlers with
+  LzmaChunkedCustomDecompressGuid.
+
+  @param  ImageHandle  The firmware allocated handle for the EFI image.
+  @param  SystemTable  A pointer to the EFI System Table.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+DxeLzmaChunkedDecompressLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  return ExtractGuidedSectionRegisterHandlers (
+           &gLzmaChunkedCustomDecompressGuid,
+           LzmaChunkedGuidedSectionGetInfo,
+           LzmaChunkedGuidedSectionExtraction
+           );
+}
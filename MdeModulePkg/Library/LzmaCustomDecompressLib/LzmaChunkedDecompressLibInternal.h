@@ -0,0 +1,110 @@
+/** @file
+  LZMA Chunked Decompress Library internal header file.
+
+  The chunked section payload is a table of independent LZMA streams. The
+  common code validates the table and decodes chunks, while the phase specific
+  code hands the decode worker to the other processors of the system.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef __LZMA_CHUNKED_DECOMPRESS_LIB_INTERNAL_H__
+#define __LZMA_CHUNKED_DECOMPRESS_LIB_INTERNAL_H__
+
+#include "LzmaDecompressLibInternal.h"
+#include <Library/PcdLib.h>
+#include <Library/PerformanceLib.h>
+#include <Library/SynchronizationLib.h>
+
+///
+/// State shared by all processors decoding one chunked section.
+///
+typedef struct {
+  CONST UINT8               *Payload;
+  CONST LZMA_CHUNK_ENTRY    *Entries;
+  UINT32                    ChunkCount;
+  UINT32                    ChunkSize;
+  UINT8                     *Destination;
+  UINT8                     *Scratch;
+  UINT32                    ScratchSizePerWorker;
+  UINT32                    MaxWorkers;
+  volatile UINT32           NextChunk;
+  volatile UINT32           NextWorker;
+  volatile UINT32           Failed;
+} LZMA_CHUNKED_CONTEXT;
+
+/**
+  Decode chunks of a chunked section until none is left.
+
+  It is run concurrently by the BSP and by the APs. Each processor claims a
+  private scratch buffer slot, then repeatedly claims the next undecoded chunk.
+  A processor that finds no free scratch buffer slot returns immediately.
+
+  @param[in, out] Buffer  Pointer to the LZMA_CHUNKED_CONTEXT of the section.
+**/
+VOID
+EFIAPI
+LzmaChunkedDecompressWorker (
+  IN OUT VOID  *Buffer
+  );
+
+/**
+  Examines an LZMA chunked GUIDed section and returns the size of the decoded
+  buffer and the size of the scratch buffer required to decode it.
+
+  @param[in]  InputSection       A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBufferSize   A pointer to the size, in bytes, of an output buffer required
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] ScratchBufferSize  A pointer to the size, in bytes, required as scratch space
+                                 if the buffer specified by InputSection were decoded.
+  @param[out] SectionAttribute   A pointer to the attributes of the GUIDed section.
+
+  @retval  RETURN_SUCCESS            The information about InputSection was returned.
+  @retval  RETURN_INVALID_PARAMETER  The information can not be retrieved from the section specified by InputSection.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionGetInfo (
+  IN  CONST VOID  *InputSection,
+  OUT UINT32      *OutputBufferSize,
+  OUT UINT32      *ScratchBufferSize,
+  OUT UINT16      *SectionAttribute
+  );
+
+/**
+  Decompress an LZMA chunked GUIDed section into a caller allocated output buffer.
+
+  @param[in]  InputSection  A pointer to a GUIDed section of an FFS formatted file.
+  @param[out] OutputBuffer  A pointer to a buffer that contains the result of a decode operation.
+  @param[out] ScratchBuffer A caller allocated buffer used as a scratch buffer.
+  @param[out] AuthenticationStatus
+                            A pointer to the authentication status of the decoded output buffer.
+
+  @retval  RETURN_SUCCESS            The buffer specified by InputSection was decoded.
+  @retval  RETURN_INVALID_PARAMETER  The section specified by InputSection can not be decoded.
+**/
+RETURN_STATUS
+EFIAPI
+LzmaChunkedGuidedSectionExtraction (
+  IN CONST  VOID    *InputSection,
+  OUT       VOID    **OutputBuffer,
+  OUT       VOID    *ScratchBuffer         OPTIONAL,
+  OUT       UINT32  *AuthenticationStatus
+  );
+
+/**
+  Run LzmaChunkedDecompressWorker() on as many processors as available.
+
+  The function returns only when all the chunks of Context have been decoded,
+  or when a chunk failed to decode.
+
+  @param[in, out] Context  The chunked section decode context.
+**/
+VOID
+LzmaChunkedDecompressDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  );
+
+#endif
@@ -0,0 +1,87 @@
+/** @file
+  PEI phase dispatch of the LZMA chunked section decoder.
+
+  The chunks are decoded by the APs through the PEI multi-processor services
+  PPI. The BSP decodes the section by itself when the PPI is not installed,
+  e.g. before permanent memory is discovered.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "LzmaChunkedDecompressLibInternal.h"
+#include <Ppi/MpServices.h>
+#include <Library/PeiServicesLib.h>
+#include <Library/PeiServicesTablePointerLib.h>
+
+/**
+  Run LzmaChunkedDecompressWorker() on as many processors as available.
+
+  The function returns only when all the chunks of Context have been decoded,
+  or when a chunk failed to decode.
+
+  @param[in, out] Context  The chunked section decode context.
+**/
+VOID
+LzmaChunkedDecompressDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  EFI_STATUS               Status;
+  EFI_PEI_MP_SERVICES_PPI  *MpServices;
+
+  if (Context->MaxWorkers > 1) {
+    Status = PeiServicesLocatePpi (
+               &gEfiPeiMpServicesPpiGuid,
+               0,
+               NULL,
+               (VOID **)&MpServices
+               );
+    if (!EFI_ERROR (Status)) {
+      //
+      // StartupAllAPs() of the PEI PPI only supports blocking mode, the BSP
+      // waits here until the APs have decoded all the chunks.
+      //
+      Status = MpServices->StartupAllAPs (
+                             GetPeiServicesTablePointer (),
+                             MpServices,
+                             LzmaChunkedDecompressWorker,
+                             FALSE,
+                             0,
+                             Context
+                             );
+      DEBUG ((DEBUG_VERBOSE, "%a: StartupAllAPs - %r\n", __func__, Status));
+    }
+  }
+
+  //
+  // Decode on the BSP whatever the APs did not, including the whole section
+  // when no AP is available.
+  //
+  LzmaChunkedDecompressWorker (Context);
+}
+
+/**
+  Register LzmaChunkedDecompress and LzmaChunkedDecompressGetInfo handlers with
+  LzmaChunkedCustomDecompressGuid.
+
+  @param  FileHandle   The handle of FFS header the loaded driver.
+  @param  PeiServices  The pointer to the PEI services.
+
+  @retval  RETURN_SUCCESS            Register successfully.
+  @retval  RETURN_OUT_OF_RESOURCES   No enough memory to store this handler.
+**/
+EFI_STATUS
+EFIAPI
+PeiLzmaChunkedDecompressLibConstructor (
+  IN EFI_PEI_FILE_HANDLE     FileHandle,
+  IN CONST EFI_PEI_SERVICES  **PeiServices
+  )
+{
+  return ExtractGuidedSectionRegisterHandlers (
+           &gLzmaChunkedCustomDecompressGuid,
+           LzmaChunkedGuidedSectionGetInfo,
+           LzmaChunkedGuidedSectionExtraction
+           );
+}
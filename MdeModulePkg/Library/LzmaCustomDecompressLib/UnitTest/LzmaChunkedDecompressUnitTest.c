@@ -0,0 +1,410 @@
+/** @file
+  Host based unit tests of the LZMA chunked GUIDed section decoder.
+
+  A chunked section must decode to the same data as a plain LZMA stream of the
+  same input, and sections whose chunk table does not match their chunks must
+  be rejected before any chunk is decoded.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "../LzmaChunkedDecompressLibInternal.h"
+
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "LZMA Chunked Decompress Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_DECODED_SIZE  0x2800
+#define TEST_CHUNK_SIZE    0x1000
+#define TEST_CHUNK_COUNT   3
+
+///
+/// TEST_DECODED_SIZE bytes of TestData(), compressed by
+/// "LzmaCompress -e --chunked --chunk-size 0x1000".
+///
+CONST UINT8  mChunkedPayload[] = {
+  0x4C, 0x5A, 0x43, 0x4B, 0x03, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x28, 0x00, 0x00,
+  0x28, 0x00, 0x00, 0x00, 0x5D, 0x00, 0x00, 0x00, 0x85, 0x00, 0x00, 0x00, 0x5E, 0x00, 0x00, 0x00,
+  0xE3, 0x00, 0x00, 0x00, 0x49, 0x00, 0x00, 0x00, 0x5D, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x52, 0x50, 0x0A, 0x84, 0xF9, 0x9B, 0xB2, 0x80,
+  0x21, 0xA9, 0x69, 0xD6, 0x27, 0xE0, 0x3E, 0x06, 0x5A, 0x5F, 0x04, 0x8D, 0x53, 0xD4, 0x04, 0xBA,
+  0x39, 0x57, 0x05, 0x09, 0xC9, 0x35, 0xFE, 0x1D, 0xEC, 0x80, 0x85, 0x51, 0x4A, 0x06, 0xE5, 0xB9,
+  0x76, 0xEE, 0xDA, 0x8E, 0xCB, 0xA9, 0xB0, 0x26, 0xB8, 0x12, 0x2B, 0x9C, 0x96, 0xB6, 0x56, 0x2B,
+  0x3F, 0x16, 0x45, 0x2D, 0x05, 0xD6, 0x1A, 0x7E, 0x61, 0x7F, 0xCD, 0xB8, 0x55, 0x76, 0xFB, 0xEE,
+  0x0D, 0xB8, 0x8F, 0x3A, 0xB6, 0x5D, 0x00, 0x00, 0x00, 0x01, 0x00, 0x10, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x04, 0x02, 0x80, 0xB9, 0x42, 0xEE, 0xC4, 0xD6, 0x8A, 0x37, 0x12, 0xFA, 0xBC,
+  0x90, 0x20, 0x94, 0xDA, 0x86, 0xC8, 0xC9, 0x56, 0x51, 0xC8, 0xDF, 0xCB, 0x75, 0xD8, 0x4A, 0x20,
+  0xE1, 0x94, 0xC9, 0xD9, 0xE1, 0x78, 0xFA, 0x4F, 0x50, 0x9C, 0x9F, 0x8C, 0x13, 0xEF, 0x5E, 0xAC,
+  0x77, 0x04, 0x16, 0x3E, 0x47, 0x01, 0xBE, 0xF0, 0xFF, 0x29, 0xE4, 0x1F, 0x3B, 0x00, 0xDE, 0x79,
+  0x2D, 0x82, 0xA8, 0x76, 0x33, 0xBE, 0xD2, 0x6C, 0xB2, 0xE2, 0x31, 0xD5, 0x79, 0x0E, 0x65, 0xC2,
+  0x60, 0x0F, 0xB8, 0x5D, 0x00, 0x00, 0x00, 0x01, 0x00, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x08, 0x04, 0x90, 0xF6, 0x72, 0x89, 0x53, 0x97, 0x9F, 0xA5, 0xD8, 0xC6, 0xEB, 0xCF, 0x0E,
+  0xFF, 0xE9, 0xEF, 0x0C, 0xF1, 0x8A, 0xDB, 0xD8, 0x9F, 0x95, 0x03, 0x01, 0xBD, 0x7C, 0x53, 0x73,
+  0xFE, 0xD4, 0x3E, 0x26, 0x26, 0xB2, 0x67, 0xAE, 0xD7, 0xCC, 0xF0, 0x5C, 0x03, 0x79, 0x01, 0x61,
+  0x92, 0x81, 0xDF, 0x6A, 0xF8, 0x77, 0x36, 0x27, 0x08, 0xF3, 0xAF, 0xE2,
+};
+
+///
+/// The same data compressed by "LzmaCompress -e" as a single LZMA stream.
+///
+CONST UINT8  mLzmaPayload[] = {
+  0x5D, 0x00, 0x00, 0x00, 0x01, 0x00, 0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x52, 0x50, 0x0A, 0x84, 0xF9, 0x9B, 0xB2, 0x80, 0x21, 0xA9, 0x69, 0xD6, 0x27, 0xE0, 0x3E, 0x06,
+  0x5A, 0x5F, 0x04, 0x8D, 0x53, 0xD4, 0x04, 0xBA, 0x39, 0x57, 0x05, 0x09, 0xC9, 0x35, 0xFE, 0x1D,
+  0xEC, 0x80, 0x85, 0x51, 0x4A, 0x06, 0xE5, 0xB9, 0x76, 0xEE, 0xDA, 0x8E, 0xCB, 0xA9, 0xB0, 0x26,
+  0xB8, 0x12, 0x2B, 0x9C, 0x96, 0xB6, 0x56, 0x2B, 0x3F, 0x16, 0x45, 0x2D, 0x05, 0xD6, 0x1A, 0x7E,
+  0x61, 0x7F, 0xCD, 0xB8, 0x55, 0x76, 0xFB, 0xEE, 0x0E, 0x06, 0xE1, 0xCE, 0x9D, 0xE6, 0x8B, 0xCB,
+  0x0D, 0xB8, 0xE0, 0xE3, 0x1C, 0x93, 0x1F, 0xC2, 0xEB, 0xFB, 0xF3, 0x78, 0xF5, 0xCF, 0x47, 0x48,
+  0xD4, 0xC1, 0xA7, 0x4B, 0x7D, 0xE2, 0x0D, 0x13, 0x32, 0xB4, 0x39, 0x90, 0xA6, 0x22, 0xA1, 0x16,
+  0x53, 0x0F, 0x76, 0xA6, 0x84, 0x8B, 0xA0, 0xB8, 0x50, 0x1D, 0x71, 0xAE, 0xEE, 0xC8,
+};
+
+EFI_GUID_DEFINED_SECTION  *mSection;
+
+/**
+  Return a byte of the data compressed in the test payloads. Every chunk of the
+  data is different, so a chunk decoded at the wrong place is detected.
+
+  @param[in] Index  The offset of the byte in the data.
+
+  @return The byte.
+**/
+UINT8
+TestData (
+  IN UINTN  Index
+  )
+{
+  return (UINT8)((Index & 0x1F) + (Index >> 9));
+}
+
+/**
+  Run LzmaChunkedDecompressWorker() as the processors of the system would.
+
+  The host has a single processor. The worker is run once more than there are
+  scratch buffer slots: the first run decodes all the chunks, and the last one
+  finds no free slot.
+
+  @param[in, out] Context  The chunked section decode context.
+**/
+VOID
+LzmaChunkedDecompressDispatch (
+  IN OUT LZMA_CHUNKED_CONTEXT  *Context
+  )
+{
+  UINT32  Index;
+
+  for (Index = 0; Index <= Context->MaxWorkers; Index++) {
+    LzmaChunkedDecompressWorker (Context);
+  }
+}
+
+/**
+  Return the chunk table of the LZMA chunked section under test.
+
+  @return The header of the chunk table.
+**/
+LZMA_CHUNKED_HEADER *
+GetChunkedHeader (
+  VOID
+  )
+{
+  return (LZMA_CHUNKED_HEADER *)((UINT8 *)mSection + mSection->DataOffset);
+}
+
+/**
+  Decode the LZMA chunked section under test.
+
+  @param[out] Output  The decoded data, to be freed by the caller.
+
+  @return The status returned by the GUIDed section handlers.
+**/
+RETURN_STATUS
+DecodeSection (
+  OUT VOID  **Output
+  )
+{
+  RETURN_STATUS  Status;
+  UINT32         OutputSize;
+  UINT32         ScratchSize;
+  UINT16         Attribute;
+  VOID           *Scratch;
+  UINT32         AuthenticationStatus;
+
+  *Output = NULL;
+  Status  = LzmaChunkedGuidedSectionGetInfo (mSection, &OutputSize, &ScratchSize, &Attribute);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  *Output = AllocateZeroPool (OutputSize);
+  Scratch = AllocatePool (ScratchSize);
+  if ((*Output == NULL) || (Scratch == NULL)) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Status = LzmaChunkedGuidedSectionExtraction (mSection, Output, Scratch, &AuthenticationStatus);
+  FreePool (Scratch);
+  return Status;
+}
+
+/**
+  Wrap the chunked payload into a GUIDed section.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED                      The section is created.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The section can not be allocated.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT32  SectionSize;
+
+  SectionSize = sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (mChunkedPayload);
+  mSection    = AllocateZeroPool (SectionSize);
+  if (mSection == NULL) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mSection->CommonHeader.Size[0] = (UINT8)SectionSize;
+  mSection->CommonHeader.Size[1] = (UINT8)(SectionSize >> 8);
+  mSection->CommonHeader.Size[2] = (UINT8)(SectionSize >> 16);
+  mSection->CommonHeader.Type    = EFI_SECTION_GUID_DEFINED;
+  CopyGuid (&mSection->SectionDefinitionGuid, &gLzmaChunkedCustomDecompressGuid);
+  mSection->DataOffset = sizeof (EFI_GUID_DEFINED_SECTION);
+  mSection->Attributes = EFI_GUIDED_SECTION_PROCESSING_REQUIRED;
+  CopyMem (mSection + 1, mChunkedPayload, sizeof (mChunkedPayload));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the section created by TestSetup().
+
+  @param  Context  Unused.
+
+**/
+VOID
+EFIAPI
+TestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  FreePool (mSection);
+}
+
+/**
+  Check that a section of several chunks decodes to the same data as the plain
+  LZMA decoder.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The section is decoded.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestMultiChunk (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINT32  OutputSize;
+  UINT32  ScratchSize;
+  UINT16  Attribute;
+  UINT8   *Output;
+  UINT8   *Expected;
+  VOID    *Scratch;
+  UINTN   Index;
+
+  UT_ASSERT_EQUAL (GetChunkedHeader ()->ChunkCount, TEST_CHUNK_COUNT);
+  UT_ASSERT_NOT_EFI_ERROR (LzmaChunkedGuidedSectionGetInfo (mSection, &OutputSize, &ScratchSize, &Attribute));
+  UT_ASSERT_EQUAL (OutputSize, TEST_DECODED_SIZE);
+  UT_ASSERT_EQUAL (Attribute, EFI_GUIDED_SECTION_PROCESSING_REQUIRED);
+
+  UT_ASSERT_NOT_EFI_ERROR (LzmaUefiDecompressGetInfo (mLzmaPayload, sizeof (mLzmaPayload), &OutputSize, &ScratchSize));
+  UT_ASSERT_EQUAL (OutputSize, TEST_DECODED_SIZE);
+  Expected = AllocatePool (OutputSize);
+  Scratch  = AllocatePool (ScratchSize);
+  UT_ASSERT_NOT_NULL (Expected);
+  UT_ASSERT_NOT_NULL (Scratch);
+  UT_ASSERT_NOT_EFI_ERROR (LzmaUefiDecompress (mLzmaPayload, sizeof (mLzmaPayload), Expected, Scratch));
+  FreePool (Scratch);
+  for (Index = 0; Index < TEST_DECODED_SIZE; Index++) {
+    UT_ASSERT_EQUAL (Expected[Index], TestData (Index));
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (DecodeSection ((VOID **)&Output));
+  UT_ASSERT_MEM_EQUAL (Output, Expected, TEST_DECODED_SIZE);
+  FreePool (Output);
+  FreePool (Expected);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that sections cut short in their chunk table or in their chunks are
+  rejected.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The sections are rejected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestTruncatedSection (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  LZMA_CHUNK_ENTRY  *Entries;
+  UINT32            SectionSize;
+  VOID              *Output;
+
+  //
+  // The last chunk goes beyond the end of the section.
+  //
+  SectionSize                    = SECTION_SIZE (mSection) - 1;
+  mSection->CommonHeader.Size[0] = (UINT8)SectionSize;
+  mSection->CommonHeader.Size[1] = (UINT8)(SectionSize >> 8);
+  mSection->CommonHeader.Size[2] = (UINT8)(SectionSize >> 16);
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (Output == NULL);
+
+  //
+  // The chunk table goes beyond the end of the section.
+  //
+  SectionSize                    = sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (LZMA_CHUNKED_HEADER) + sizeof (LZMA_CHUNK_ENTRY);
+  mSection->CommonHeader.Size[0] = (UINT8)SectionSize;
+  mSection->CommonHeader.Size[1] = (UINT8)(SectionSize >> 8);
+  mSection->CommonHeader.Size[2] = (UINT8)(SectionSize >> 16);
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+
+  //
+  // The data of the last chunk is cut short within the section. It is only
+  // detected when the chunk is decoded.
+  //
+  SectionSize                    = sizeof (EFI_GUID_DEFINED_SECTION) + sizeof (mChunkedPayload);
+  mSection->CommonHeader.Size[0] = (UINT8)SectionSize;
+  mSection->CommonHeader.Size[1] = (UINT8)(SectionSize >> 8);
+  mSection->CommonHeader.Size[2] = (UINT8)(SectionSize >> 16);
+  Entries                        = (LZMA_CHUNK_ENTRY *)(GetChunkedHeader () + 1);
+  Entries[TEST_CHUNK_COUNT - 1].Size -= 8;
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+  FreePool (Output);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that sections whose chunk size does not match the chunk count or the
+  size their chunks decode to are rejected.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The sections are rejected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestChunkSizeMismatch (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  LZMA_CHUNKED_HEADER  *Header;
+  VOID                 *Output;
+
+  Header = GetChunkedHeader ();
+
+  //
+  // DecodedSize is split into more chunks than the table holds.
+  //
+  Header->ChunkSize = TEST_CHUNK_SIZE / 2;
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (Output == NULL);
+
+  //
+  // The chunk count matches, but the chunks decode to fewer bytes than
+  // ChunkSize, so the output would have holes.
+  //
+  Header->ChunkSize = TEST_CHUNK_SIZE + 0x100;
+  UT_ASSERT_EQUAL (Header->ChunkCount, (Header->DecodedSize + Header->ChunkSize - 1) / Header->ChunkSize);
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (Output == NULL);
+
+  //
+  // The last chunk decodes to more bytes than the remainder of DecodedSize.
+  //
+  Header->ChunkSize    = TEST_CHUNK_SIZE;
+  Header->DecodedSize -= 0x100;
+  UT_ASSERT_STATUS_EQUAL (DecodeSection (&Output), RETURN_INVALID_PARAMETER);
+  UT_ASSERT_TRUE (Output == NULL);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the LZMA
+  chunked section decoder, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ChunkedTestSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&ChunkedTestSuite, Framework, "LZMA chunked section test suite", "LzmaCustomDecompressLib.Chunked", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for LZMA chunked section test suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ChunkedTestSuite, "Section of several chunks", "MultiChunk", TestMultiChunk, TestSetup, TestCleanup, NULL);
+  AddTestCase (ChunkedTestSuite, "Truncated section", "TruncatedSection", TestTruncatedSection, TestSetup, TestCleanup, NULL);
+  AddTestCase (ChunkedTestSuite, "Chunk size mismatch", "ChunkSizeMismatch", TestChunkSizeMismatch, TestSetup, TestCleanup, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -0,0 +1,116 @@
+/** @file
+  Trace library instance of the DXE Core. It creates the DXE trace buffer, and
+  installs the table of the PEI and DXE trace buffers in the EFI System
+  Configuration Table.
+
+  The DXE Core owns the trace buffer as it is never unloaded.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include "TraceBufferLibInternal.h"
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+STATIC EDKII_TRACE_BUFFER  *mTraceBuffer;
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  )
+{
+  if (mTraceBuffer != NULL) {
+    TraceBufferWrite (mTraceBuffer, Category, Event, Type, Arg0, Arg1);
+  }
+}
+
+/**
+  The constructor function creates the DXE trace buffer, and installs the
+  table of the trace buffers in the EFI System Configuration Table.
+
+  The records are dropped if the trace buffer cannot be created.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+DxeCoreTraceBufferLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS                Status;
+  EDKII_TRACE_BUFFER        *Buffer;
+  EDKII_TRACE_BUFFER_TABLE  *Table;
+  EFI_PHYSICAL_ADDRESS      *Address;
+  EFI_HOB_GUID_TYPE         *GuidHob;
+  UINT32                    Capacity;
+
+  Capacity = PcdGet32 (PcdTraceDxeRecordCount);
+  if (Capacity == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Buffer = AllocatePool (sizeof (EDKII_TRACE_BUFFER) + (UINTN)Capacity * sizeof (EDKII_TRACE_RECORD));
+  Table  = AllocatePool (sizeof (EDKII_TRACE_BUFFER_TABLE) + 2 * sizeof (EFI_PHYSICAL_ADDRESS));
+  if ((Buffer == NULL) || (Table == NULL)) {
+    goto Error;
+  }
+
+  TraceBufferInitialize (Buffer, EDKII_TRACE_PHASE_DXE, Capacity);
+
+  //
+  // The PEI trace buffer stays in the HOB list.
+  //
+  Table->Signature       = EDKII_TRACE_BUFFER_TABLE_SIGNATURE;
+  Table->NumberOfBuffers = 0;
+  Address                = (EFI_PHYSICAL_ADDRESS *)(Table + 1);
+  GuidHob                = GetFirstGuidHob (&gEdkiiTraceBufferGuid);
+  if (GuidHob != NULL) {
+    Address[Table->NumberOfBuffers++] = (EFI_PHYSICAL_ADDRESS)(UINTN)GET_GUID_HOB_DATA (GuidHob);
+  }
+
+  Address[Table->NumberOfBuffers++] = (EFI_PHYSICAL_ADDRESS)(UINTN)Buffer;
+
+  Status = SystemTable->BootServices->InstallConfigurationTable (&gEdkiiTraceBufferGuid, Table);
+  if (EFI_ERROR (Status)) {
+    goto Error;
+  }
+
+  mTraceBuffer = Buffer;
+  return EFI_SUCCESS;
+
+Error:
+  if (Buffer != NULL) {
+    FreePool (Buffer);
+  }
+
+  if (Table != NULL) {
+    FreePool (Table);
+  }
+
+  return EFI_SUCCESS;
+}
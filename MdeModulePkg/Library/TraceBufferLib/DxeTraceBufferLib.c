@@ -0,0 +1,87 @@
+/** @file
+  Trace library instance of the DXE drivers, writing the DXE trace buffer
+  created by the DXE Core.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include "TraceBufferLibInternal.h"
+
+STATIC EDKII_TRACE_BUFFER  *mTraceBuffer;
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  )
+{
+  if (mTraceBuffer != NULL) {
+    TraceBufferWrite (mTraceBuffer, Category, Event, Type, Arg0, Arg1);
+  }
+}
+
+/**
+  The constructor function looks for the DXE trace buffer in the table
+  installed by the DXE Core in the EFI System Configuration Table.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+DxeTraceBufferLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  UINTN                     Index;
+  UINT32                    BufferIndex;
+  EDKII_TRACE_BUFFER_TABLE  *Table;
+  EFI_PHYSICAL_ADDRESS      *Address;
+  EDKII_TRACE_BUFFER        *Buffer;
+
+  for (Index = 0; Index < SystemTable->NumberOfTableEntries; Index++) {
+    if (!CompareGuid (&gEdkiiTraceBufferGuid, &SystemTable->ConfigurationTable[Index].VendorGuid)) {
+      continue;
+    }
+
+    Table = SystemTable->ConfigurationTable[Index].VendorTable;
+    if (Table->Signature != EDKII_TRACE_BUFFER_TABLE_SIGNATURE) {
+      break;
+    }
+
+    Address = (EFI_PHYSICAL_ADDRESS *)(Table + 1);
+    for (BufferIndex = 0; BufferIndex < Table->NumberOfBuffers; BufferIndex++) {
+      Buffer = (EDKII_TRACE_BUFFER *)(UINTN)Address[BufferIndex];
+      if (Buffer->Phase == EDKII_TRACE_PHASE_DXE) {
+        mTraceBuffer = Buffer;
+        break;
+      }
+    }
+
+    break;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,178 @@
+/** @file
+  Trace library instance writing the PEI trace buffer, which is the data of a
+  GUIDed HOB so that the DXE Core finds it.
+
+  The trace buffer is created by the constructor of the first PEIM linked with
+  this instance, on the boot processor. The modules running from permanent
+  memory, where the HOB list does not move anymore, cache the trace buffer on
+  their first record, so their records only take the interlocked reservation.
+  The other modules search the HOB list for each record. The trace points run
+  before the trace buffer is created are dropped.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TraceBufferLibInternal.h"
+#include <Ppi/MemoryDiscovered.h>
+#include <Library/HobLib.h>
+#include <Library/PeiServicesLib.h>
+
+//
+// Largest number of records that fit in the data of a GUIDed HOB.
+//
+#define PEI_TRACE_BUFFER_MAX_RECORDS  2040
+
+//
+// The trace buffer, once cached. It is only written when the module runs
+// from permanent memory.
+//
+EDKII_TRACE_BUFFER  *mTraceBuffer = NULL;
+
+/**
+  Find the PEI trace buffer in the HOB list.
+
+  @param  HobList  The HOB list.
+
+  @return The trace buffer, NULL if it does not exist yet.
+
+**/
+EDKII_TRACE_BUFFER *
+PeiTraceBufferFind (
+  IN VOID  *HobList
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+
+  GuidHob = GetNextGuidHob (&gEdkiiTraceBufferGuid, HobList);
+  if (GuidHob == NULL) {
+    return NULL;
+  }
+
+  return GET_GUID_HOB_DATA (GuidHob);
+}
+
+/**
+  Check whether the trace buffer can be cached in mTraceBuffer: the permanent
+  memory is installed, so the HOB list does not move anymore, and the module
+  runs from it, so its global variables are writable.
+
+  @param  HandoffHob  The PHIT HOB, first of the HOB list.
+
+  @retval TRUE   The trace buffer can be cached.
+  @retval FALSE  The trace buffer must be searched for each record.
+
+**/
+BOOLEAN
+PeiTraceBufferIsCacheable (
+  IN EFI_HOB_HANDOFF_INFO_TABLE  *HandoffHob
+  )
+{
+  EFI_STATUS  Status;
+  VOID        *Ppi;
+
+  if (((UINTN)&mTraceBuffer < HandoffHob->EfiMemoryBottom) ||
+      ((UINTN)&mTraceBuffer >= HandoffHob->EfiMemoryTop))
+  {
+    return FALSE;
+  }
+
+  Status = PeiServicesLocatePpi (&gEfiPeiMemoryDiscoveredPpiGuid, 0, NULL, &Ppi);
+  return (BOOLEAN)!EFI_ERROR (Status);
+}
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  )
+{
+  EFI_STATUS          Status;
+  VOID                *HobList;
+  EDKII_TRACE_BUFFER  *Buffer;
+
+  Buffer = mTraceBuffer;
+  if (Buffer == NULL) {
+    Status = PeiServicesGetHobList (&HobList);
+    if (EFI_ERROR (Status) || (HobList == NULL)) {
+      return;
+    }
+
+    Buffer = PeiTraceBufferFind (HobList);
+    if (Buffer == NULL) {
+      return;
+    }
+
+    if (PeiTraceBufferIsCacheable (HobList)) {
+      mTraceBuffer = Buffer;
+    }
+  }
+
+  TraceBufferWrite (Buffer, Category, Event, Type, Arg0, Arg1);
+}
+
+/**
+  The constructor function creates the PEI trace buffer if it does not exist.
+
+  The PEI Core does not create it, its constructors run before the HOB list is
+  created, or while it is migrated to permanent memory.
+
+  @param  FileHandle   The handle of FFS header the loaded driver, NULL for
+                       the PEI Core.
+  @param  PeiServices  The pointer to the PEI services.
+
+  @retval EFI_SUCCESS  The constructor always returns EFI_SUCCESS.
+
+**/
+EFI_STATUS
+EFIAPI
+PeiTraceBufferLibConstructor (
+  IN       EFI_PEI_FILE_HANDLE  FileHandle,
+  IN CONST EFI_PEI_SERVICES     **PeiServices
+  )
+{
+  EFI_STATUS          Status;
+  VOID                *HobList;
+  EDKII_TRACE_BUFFER  *Buffer;
+  UINT32              Capacity;
+
+  if (FileHandle == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  Status = PeiServicesGetHobList (&HobList);
+  if (EFI_ERROR (Status) || (HobList == NULL) || (PeiTraceBufferFind (HobList) != NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  Capacity = PcdGet32 (PcdTracePeiRecordCount);
+  ASSERT (Capacity <= PEI_TRACE_BUFFER_MAX_RECORDS);
+  Capacity = MIN (Capacity, PEI_TRACE_BUFFER_MAX_RECORDS);
+
+  Buffer = BuildGuidHob (
+             &gEdkiiTraceBufferGuid,
+             sizeof (EDKII_TRACE_BUFFER) + Capacity * sizeof (EDKII_TRACE_RECORD)
+             );
+  if (Buffer != NULL) {
+    TraceBufferInitialize (Buffer, EDKII_TRACE_PHASE_PEI, Capacity);
+  }
+
+  return EFI_SUCCESS;
+}
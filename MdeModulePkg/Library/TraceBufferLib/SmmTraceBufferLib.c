@@ -0,0 +1,191 @@
+/** @file
+  Trace library instance of the SMM drivers, writing the MM trace buffer in
+  SMRAM.
+
+  The first driver linked with this instance creates the MM trace buffer, and
+  installs it in the SMM System Configuration Table for the drivers loaded
+  after it. It also registers the MMI handler reading the buffer, as the SMM
+  drivers are not unloaded once they started.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiSmm.h>
+#include "TraceBufferLibInternal.h"
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SmmServicesTableLib.h>
+
+STATIC EDKII_TRACE_BUFFER  *mTraceBuffer;
+STATIC EFI_HANDLE          mMmiHandle;
+
+/**
+  Write a record in the trace buffer of the current phase.
+
+  The record is dropped if the trace buffer is full or does not exist.
+
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+EFIAPI
+TraceRecord (
+  IN UINT32  Category,
+  IN UINT16  Event,
+  IN UINT8   Type,
+  IN UINT64  Arg0,
+  IN UINT64  Arg1
+  )
+{
+  if (mTraceBuffer != NULL) {
+    TraceBufferWrite (mTraceBuffer, Category, Event, Type, Arg0, Arg1);
+  }
+}
+
+/**
+  Copy a part of the MM trace buffer to the communication buffer.
+
+  The communication buffer starts with an EDKII_TRACE_BUFFER_COMMUNICATE
+  request, followed by the data copied. The request is copied first, so that
+  changes of the communication buffer during the copy do not matter.
+
+  @param[in]     DispatchHandle  The unique handle assigned to this handler by SmiHandlerRegister().
+  @param[in]     Context         Points to an optional handler context which was specified when the
+                                 handler was registered.
+  @param[in,out] CommBuffer      A pointer to a collection of data in memory that will
+                                 be conveyed from a non-SMM environment into an SMM environment.
+  @param[in,out] CommBufferSize  The size of the CommBuffer.
+
+  @retval EFI_SUCCESS            The interrupt was handled and quiesced. No other handlers
+                                 should still be called.
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+TraceBufferMmiHandler (
+  IN     EFI_HANDLE  DispatchHandle,
+  IN     CONST VOID  *Context         OPTIONAL,
+  IN OUT VOID        *CommBuffer      OPTIONAL,
+  IN OUT UINTN       *CommBufferSize  OPTIONAL
+  )
+{
+  EDKII_TRACE_BUFFER_COMMUNICATE  Request;
+  EDKII_TRACE_BUFFER_COMMUNICATE  *Reply;
+  UINT64                          BufferSize;
+  UINT64                          Size;
+
+  if ((CommBuffer == NULL) || (CommBufferSize == NULL) || (*CommBufferSize < sizeof (Request))) {
+    return EFI_SUCCESS;
+  }
+
+  CopyMem (&Request, CommBuffer, sizeof (Request));
+  Reply = CommBuffer;
+
+  BufferSize = mTraceBuffer->HeaderSize +
+               MultU64x32 (MIN (mTraceBuffer->Count, mTraceBuffer->Capacity), mTraceBuffer->RecordSize);
+  if (Request.Offset > BufferSize) {
+    Reply->ReturnStatus = (UINT64)(INT64)(INTN)EFI_INVALID_PARAMETER;
+    return EFI_SUCCESS;
+  }
+
+  Size = MIN (Request.Size, BufferSize - Request.Offset);
+  Size = MIN (Size, *CommBufferSize - sizeof (Request));
+  CopyMem (Reply + 1, (UINT8 *)mTraceBuffer + Request.Offset, (UINTN)Size);
+
+  Reply->Size         = Size;
+  Reply->ReturnStatus = 0;
+  return EFI_SUCCESS;
+}
+
+/**
+  The constructor function looks for the MM trace buffer in the SMM System
+  Configuration Table, and creates it if it is not there.
+
+  The records are dropped if the trace buffer cannot be created.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+SmmTraceBufferLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS          Status;
+  UINTN               Index;
+  EDKII_TRACE_BUFFER  *Buffer;
+  UINT32              Capacity;
+
+  for (Index = 0; Index < gSmst->NumberOfTableEntries; Index++) {
+    if (CompareGuid (&gEdkiiTraceBufferGuid, &gSmst->SmmConfigurationTable[Index].VendorGuid)) {
+      Buffer = gSmst->SmmConfigurationTable[Index].VendorTable;
+      if (Buffer->Signature == EDKII_TRACE_BUFFER_SIGNATURE) {
+        mTraceBuffer = Buffer;
+      }
+
+      return EFI_SUCCESS;
+    }
+  }
+
+  Capacity = PcdGet32 (PcdTraceMmRecordCount);
+  if (Capacity == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Buffer = AllocatePool (sizeof (EDKII_TRACE_BUFFER) + (UINTN)Capacity * sizeof (EDKII_TRACE_RECORD));
+  if (Buffer == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  TraceBufferInitialize (Buffer, EDKII_TRACE_PHASE_MM, Capacity);
+  mTraceBuffer = Buffer;
+
+  Status = gSmst->SmiHandlerRegister (TraceBufferMmiHandler, &gEdkiiTraceBufferGuid, &mMmiHandle);
+  if (!EFI_ERROR (Status)) {
+    Status = gSmst->SmmInstallConfigurationTable (gSmst, &gEdkiiTraceBufferGuid, Buffer, sizeof (EDKII_TRACE_BUFFER));
+    if (EFI_ERROR (Status)) {
+      gSmst->SmiHandlerUnRegister (mMmiHandle);
+      mMmiHandle = NULL;
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    mTraceBuffer = NULL;
+    FreePool (Buffer);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The destructor function unregisters the MMI handler if the driver fails to
+  start and is unloaded. The MM trace buffer is left to the drivers that found
+  it, but it cannot be read anymore.
+
+  @param[in]  ImageHandle   The firmware allocated handle for the EFI image.
+  @param[in]  SystemTable   A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS   The destructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+SmmTraceBufferLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mMmiHandle != NULL) {
+    gSmst->SmiHandlerUnRegister (mMmiHandle);
+  }
+
+  return EFI_SUCCESS;
+}
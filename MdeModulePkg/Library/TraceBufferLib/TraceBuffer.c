@@ -0,0 +1,94 @@
+/** @file
+  Write fixed-size records in a binary trace buffer.
+
+  A writer reserves its record with an interlocked increment of the record
+  count, so the records of concurrent writers never overlap. The timestamp is
+  read before the reservation, the records of different processors may not be
+  in timestamp order and the decoder sorts them.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "TraceBufferLibInternal.h"
+
+/**
+  Initialize the header of a trace buffer.
+
+  @param  Buffer    The trace buffer, with room for Capacity records after its
+                    header.
+  @param  Phase     EDKII_TRACE_PHASE_* phase writing the trace buffer.
+  @param  Capacity  Number of records the buffer can hold.
+
+**/
+VOID
+TraceBufferInitialize (
+  OUT EDKII_TRACE_BUFFER  *Buffer,
+  IN  UINT32              Phase,
+  IN  UINT32              Capacity
+  )
+{
+  ZeroMem (Buffer, sizeof (*Buffer));
+  Buffer->Signature  = EDKII_TRACE_BUFFER_SIGNATURE;
+  Buffer->HeaderSize = sizeof (EDKII_TRACE_BUFFER);
+  Buffer->RecordSize = sizeof (EDKII_TRACE_RECORD);
+  Buffer->Phase      = Phase;
+  Buffer->Capacity   = Capacity;
+  Buffer->Frequency  = GetPerformanceCounterProperties (&Buffer->StartValue, &Buffer->EndValue);
+}
+
+/**
+  Write a record in a trace buffer.
+
+  It may be called on any processor and at any TPL, including while another
+  caller is interrupted in the middle of a write.
+
+  @param  Buffer    The trace buffer.
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+TraceBufferWrite (
+  IN EDKII_TRACE_BUFFER  *Buffer,
+  IN UINT32              Category,
+  IN UINT16              Event,
+  IN UINT8               Type,
+  IN UINT64              Arg0,
+  IN UINT64              Arg1
+  )
+{
+  UINT64              Timestamp;
+  UINT32              Index;
+  EDKII_TRACE_RECORD  *Record;
+
+  Timestamp = GetPerformanceCounter ();
+
+  //
+  // Check the count first, so that it stops growing once the buffer is full
+  // and never wraps around.
+  //
+  if (Buffer->Count >= Buffer->Capacity) {
+    InterlockedIncrement (&Buffer->Dropped);
+    return;
+  }
+
+  Index = InterlockedIncrement (&Buffer->Count) - 1;
+  if (Index >= Buffer->Capacity) {
+    InterlockedIncrement (&Buffer->Dropped);
+    return;
+  }
+
+  Record            = (EDKII_TRACE_RECORD *)((UINT8 *)Buffer + Buffer->HeaderSize) + Index;
+  Record->Timestamp = Timestamp;
+  Record->Category  = Category;
+  Record->Event     = Event;
+  Record->Type      = Type;
+  Record->Reserved  = 0;
+  Record->Arg0      = Arg0;
+  Record->Arg1      = Arg1;
+}
@@ -0,0 +1,63 @@
+/** @file
+  Internal definitions of the Trace library instances writing the binary trace
+  buffers.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TRACE_BUFFER_LIB_INTERNAL_H_
+#define TRACE_BUFFER_LIB_INTERNAL_H_
+
+#include <PiPei.h>
+#include <Guid/TraceBuffer.h>
+#include <Library/TraceLib.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+
+/**
+  Initialize the header of a trace buffer.
+
+  @param  Buffer    The trace buffer, with room for Capacity records after its
+                    header.
+  @param  Phase     EDKII_TRACE_PHASE_* phase writing the trace buffer.
+  @param  Capacity  Number of records the buffer can hold.
+
+**/
+VOID
+TraceBufferInitialize (
+  OUT EDKII_TRACE_BUFFER  *Buffer,
+  IN  UINT32              Phase,
+  IN  UINT32              Capacity
+  );
+
+/**
+  Write a record in a trace buffer.
+
+  It may be called on any processor and at any TPL, including while another
+  caller is interrupted in the middle of a write.
+
+  @param  Buffer    The trace buffer.
+  @param  Category  The TRACE_CATEGORY_* bit of the trace point.
+  @param  Event     Identifier of the event within its category.
+  @param  Type      EDKII_TRACE_TYPE_* type of the record.
+  @param  Arg0      First argument of the event.
+  @param  Arg1      Second argument of the event.
+
+**/
+VOID
+TraceBufferWrite (
+  IN EDKII_TRACE_BUFFER  *Buffer,
+  IN UINT32              Category,
+  IN UINT16              Event,
+  IN UINT8               Type,
+  IN UINT64              Arg0,
+  IN UINT64              Arg1
+  );
+
+#endif
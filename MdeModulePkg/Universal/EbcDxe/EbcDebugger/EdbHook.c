@@ -494,6 +494,22 @@ EbcDebuggerHookEbcUnloadImage (
   return;
 }
 
+/**
+
+  The hook in EbcRegisterImage.
+  The debugger must see every instruction, so nothing is translated.
+
+  @retval FALSE  All the instructions of the image must be interpreted.
+
+**/
+BOOLEAN
+EbcDebuggerHookTranslateImage (
+  VOID
+  )
+{
+  return FALSE;
+}
+
 /**
 
   The hook in ExecuteEbcImageEntryPoint.
@@ -58,6 +58,22 @@ EbcDebuggerHookEbcUnloadImage (
   return;
 }
 
+/**
+
+  The hook in EbcRegisterImage.
+
+  @retval TRUE   The instructions of the image may be run from a translation
+                 cache, without calling the hooks of each instruction.
+
+**/
+BOOLEAN
+EbcDebuggerHookTranslateImage (
+  VOID
+  )
+{
+  return TRUE;
+}
+
 /**
 
   The hook in ExecuteEbcImageEntryPoint.
@@ -69,6 +69,20 @@ EbcDebuggerHookEbcUnloadImage (
   IN EFI_HANDLE  Handle
   );
 
+/**
+
+  The hook in EbcRegisterImage.
+
+  @retval TRUE   The instructions of the image may be run from a translation
+                 cache, without calling the hooks of each instruction.
+  @retval FALSE  All the instructions of the image must be interpreted.
+
+**/
+BOOLEAN
+EbcDebuggerHookTranslateImage (
+  VOID
+  );
+
 /**
 
   Hooks in EbcSupport.c
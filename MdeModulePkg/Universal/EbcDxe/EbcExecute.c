@@ -10,16 +10,6 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "EbcExecute.h"
 #include "EbcDebuggerHook.h"
 
-//
-// Define some useful data size constants to allow switch statements based on
-// size of operands or data.
-//
-#define DATA_SIZE_INVALID  0
-#define DATA_SIZE_8        1
-#define DATA_SIZE_16       2
-#define DATA_SIZE_32       4
-#define DATA_SIZE_64       8
-#define DATA_SIZE_N        48 // 4 or 8
 //
 // Structure we'll use to dispatch opcodes to execute functions.
 //
@@ -29,398 +19,6 @@ typedef struct {
     );
 } VM_TABLE_ENTRY;
 
-typedef
-UINT64
-(*DATA_MANIP_EXEC_FUNCTION) (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT64      Op1,
-  IN UINT64      Op2
-  );
-
-/**
-  Decode a 16-bit index to determine the offset. Given an index value:
-
-    b15     - sign bit
-    b14:12  - number of bits in this index assigned to natural units (=a)
-    ba:11   - constant units = ConstUnits
-    b0:a    - natural units = NaturalUnits
-
-  Given this info, the offset can be computed by:
-    offset = sign_bit * (ConstUnits + NaturalUnits * sizeof(UINTN))
-
-  Max offset is achieved with index = 0x7FFF giving an offset of
-  0x27B (32-bit machine) or 0x477 (64-bit machine).
-  Min offset is achieved with index =
-
-  @param  VmPtr             A pointer to VM context.
-  @param  CodeOffset        Offset from IP of the location of the 16-bit index
-                            to decode.
-
-  @return The decoded offset.
-
-**/
-INT16
-VmReadIndex16 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      CodeOffset
-  );
-
-/**
-  Decode a 32-bit index to determine the offset.
-
-  @param  VmPtr             A pointer to VM context.
-  @param  CodeOffset        Offset from IP of the location of the 32-bit index
-                            to decode.
-
-  @return Converted index per EBC VM specification.
-
-**/
-INT32
-VmReadIndex32 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      CodeOffset
-  );
-
-/**
-  Decode a 64-bit index to determine the offset.
-
-  @param  VmPtr             A pointer to VM context.s
-  @param  CodeOffset        Offset from IP of the location of the 64-bit index
-                            to decode.
-
-  @return Converted index per EBC VM specification
-
-**/
-INT64
-VmReadIndex64 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      CodeOffset
-  );
-
-/**
-  Reads 8-bit data form the memory address.
-
-  @param  VmPtr             A pointer to VM context.
-  @param  Addr              The memory address.
-
-  @return The 8-bit value from the memory address.
-
-**/
-UINT8
-VmReadMem8 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
-/**
-  Reads 16-bit data form the memory address.
-
-  @param  VmPtr             A pointer to VM context.
-  @param  Addr              The memory address.
-
-  @return The 16-bit value from the memory address.
-
-**/
-UINT16
-VmReadMem16 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
-/**
-  Reads 32-bit data form the memory address.
-
-  @param  VmPtr             A pointer to VM context.
-  @param  Addr              The memory address.
-
-  @return The 32-bit value from the memory address.
-
-**/
-UINT32
-VmReadMem32 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
-/**
-  Reads 64-bit data form the memory address.
-
-  @param  VmPtr             A pointer to VM context.
-  @param  Addr              The memory address.
-
-  @return The 64-bit value from the memory address.
-
-**/
-UINT64
-VmReadMem64 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
-/**
-  Read a natural value from memory. May or may not be aligned.
-
-  @param  VmPtr             current VM context
-  @param  Addr              the address to read from
-
-  @return The natural value at address Addr.
-
-**/
-UINTN
-VmReadMemN (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
-/**
-  Writes 8-bit data to memory address.
-
-  This routine is called by the EBC data
-  movement instructions that write to memory. Since these writes
-  may be to the stack, which looks like (high address on top) this,
-
-  [EBC entry point arguments]
-  [VM stack]
-  [EBC stack]
-
-  we need to detect all attempts to write to the EBC entry point argument
-  stack area and adjust the address (which will initially point into the
-  VM stack) to point into the EBC entry point arguments.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Addr              Address to write to.
-  @param  Data              Value to write to Addr.
-
-  @retval EFI_SUCCESS       The instruction is executed successfully.
-  @retval Other             Some error occurs when writing data to the address.
-
-**/
-EFI_STATUS
-VmWriteMem8 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr,
-  IN UINT8       Data
-  );
-
-/**
-  Writes 16-bit data to memory address.
-
-  This routine is called by the EBC data
-  movement instructions that write to memory. Since these writes
-  may be to the stack, which looks like (high address on top) this,
-
-  [EBC entry point arguments]
-  [VM stack]
-  [EBC stack]
-
-  we need to detect all attempts to write to the EBC entry point argument
-  stack area and adjust the address (which will initially point into the
-  VM stack) to point into the EBC entry point arguments.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Addr              Address to write to.
-  @param  Data              Value to write to Addr.
-
-  @retval EFI_SUCCESS       The instruction is executed successfully.
-  @retval Other             Some error occurs when writing data to the address.
-
-**/
-EFI_STATUS
-VmWriteMem16 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr,
-  IN UINT16      Data
-  );
-
-/**
-  Writes 32-bit data to memory address.
-
-  This routine is called by the EBC data
-  movement instructions that write to memory. Since these writes
-  may be to the stack, which looks like (high address on top) this,
-
-  [EBC entry point arguments]
-  [VM stack]
-  [EBC stack]
-
-  we need to detect all attempts to write to the EBC entry point argument
-  stack area and adjust the address (which will initially point into the
-  VM stack) to point into the EBC entry point arguments.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Addr              Address to write to.
-  @param  Data              Value to write to Addr.
-
-  @retval EFI_SUCCESS       The instruction is executed successfully.
-  @retval Other             Some error occurs when writing data to the address.
-
-**/
-EFI_STATUS
-VmWriteMem32 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr,
-  IN UINT32      Data
-  );
-
-/**
-  Reads 16-bit unsigned data from the code stream.
-
-  This routine provides the ability to read raw unsigned data from the code
-  stream.
-
-  @param  VmPtr             A pointer to VM context
-  @param  Offset            Offset from current IP to the raw data to read.
-
-  @return The raw unsigned 16-bit value from the code stream.
-
-**/
-UINT16
-VmReadCode16 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 32-bit unsigned data from the code stream.
-
-  This routine provides the ability to read raw unsigned data from the code
-  stream.
-
-  @param  VmPtr             A pointer to VM context
-  @param  Offset            Offset from current IP to the raw data to read.
-
-  @return The raw unsigned 32-bit value from the code stream.
-
-**/
-UINT32
-VmReadCode32 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 64-bit unsigned data from the code stream.
-
-  This routine provides the ability to read raw unsigned data from the code
-  stream.
-
-  @param  VmPtr             A pointer to VM context
-  @param  Offset            Offset from current IP to the raw data to read.
-
-  @return The raw unsigned 64-bit value from the code stream.
-
-**/
-UINT64
-VmReadCode64 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 8-bit immediate value at the offset.
-
-  This routine is called by the EBC execute
-  functions to read EBC immediate values from the code stream.
-  Since we can't assume alignment, each tries to read in the biggest
-  chunks size available, but will revert to smaller reads if necessary.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Offset            offset from IP of the code bytes to read.
-
-  @return Signed data of the requested size from the specified address.
-
-**/
-INT8
-VmReadImmed8 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 16-bit immediate value at the offset.
-
-  This routine is called by the EBC execute
-  functions to read EBC immediate values from the code stream.
-  Since we can't assume alignment, each tries to read in the biggest
-  chunks size available, but will revert to smaller reads if necessary.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Offset            offset from IP of the code bytes to read.
-
-  @return Signed data of the requested size from the specified address.
-
-**/
-INT16
-VmReadImmed16 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 32-bit immediate value at the offset.
-
-  This routine is called by the EBC execute
-  functions to read EBC immediate values from the code stream.
-  Since we can't assume alignment, each tries to read in the biggest
-  chunks size available, but will revert to smaller reads if necessary.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Offset            offset from IP of the code bytes to read.
-
-  @return Signed data of the requested size from the specified address.
-
-**/
-INT32
-VmReadImmed32 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Reads 64-bit immediate value at the offset.
-
-  This routine is called by the EBC execute
-  functions to read EBC immediate values from the code stream.
-  Since we can't assume alignment, each tries to read in the biggest
-  chunks size available, but will revert to smaller reads if necessary.
-
-  @param  VmPtr             A pointer to a VM context.
-  @param  Offset            offset from IP of the code bytes to read.
-
-  @return Signed data of the requested size from the specified address.
-
-**/
-INT64
-VmReadImmed64 (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINT32      Offset
-  );
-
-/**
-  Given an address that EBC is going to read from or write to, return
-  an appropriate address that accounts for a gap in the stack.
-  The stack for this application looks like this (high addr on top)
-  [EBC entry point arguments]
-  [VM stack]
-  [EBC stack]
-  The EBC assumes that its arguments are at the top of its stack, which
-  is where the VM stack is really. Therefore if the EBC does memory
-  accesses into the VM stack area, then we need to convert the address
-  to point to the EBC entry point arguments area. Do this here.
-
-  @param  VmPtr             A Pointer to VM context.
-  @param  Addr              Address of interest
-
-  @return The unchanged address if it's not in the VM stack region. Otherwise,
-          adjust for the stack gap and return the modified address.
-
-**/
-UINTN
-ConvertStackAddr (
-  IN VM_CONTEXT  *VmPtr,
-  IN UINTN       Addr
-  );
-
 /**
   Execute all the EBC data manipulation instructions.
   Since the EBC data manipulation instructions all have the same basic form,
@@ -1477,36 +1075,46 @@ EbcExecute (
     DEBUG_CODE_END ();
 
     //
-    // Use the opcode bits to index into the opcode dispatch table. If the
-    // function pointer is null then generate an exception.
+    // Run the instructions from the translation cache of the image, unless
+    // a debugger needs to see each of them. Fall back to the interpreter for
+    // the instructions that are not translated.
     //
-    ExecFunc = (UINTN)mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction;
-    if (ExecFunc == (UINTN)NULL) {
-      EbcDebugSignalException (EXCEPT_EBC_INVALID_OPCODE, EXCEPTION_FLAG_FATAL, VmPtr);
-      Status = EFI_UNSUPPORTED;
-      goto Done;
-    }
+    if ((EbcSimpleDebugger != NULL) ||
+        VMFLAG_ISSET (VmPtr, VMFLAGS_STEP) ||
+        (EbcExecuteTranslated (VmPtr) == 0))
+    {
+      //
+      // Use the opcode bits to index into the opcode dispatch table. If the
+      // function pointer is null then generate an exception.
+      //
+      ExecFunc = (UINTN)mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction;
+      if (ExecFunc == (UINTN)NULL) {
+        EbcDebugSignalException (EXCEPT_EBC_INVALID_OPCODE, EXCEPTION_FLAG_FATAL, VmPtr);
+        Status = EFI_UNSUPPORTED;
+        goto Done;
+      }
 
-    EbcDebuggerHookExecuteStart (VmPtr);
+      EbcDebuggerHookExecuteStart (VmPtr);
 
-    //
-    // The EBC VM is a strongly ordered processor, so perform a fence operation before
-    // and after each instruction is executed.
-    //
-    MemoryFence ();
+      //
+      // The EBC VM is a strongly ordered processor, so perform a fence operation before
+      // and after each instruction is executed.
+      //
+      MemoryFence ();
 
-    mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction (VmPtr);
+      mVmOpcodeTable[(*VmPtr->Ip & OPCODE_M_OPCODE)].ExecuteFunction (VmPtr);
 
-    MemoryFence ();
+      MemoryFence ();
 
-    EbcDebuggerHookExecuteEnd (VmPtr);
+      EbcDebuggerHookExecuteEnd (VmPtr);
 
-    //
-    // If the step flag is set, signal an exception and continue. We don't
-    // clear it here. Assuming the debugger is responsible for clearing it.
-    //
-    if (VMFLAG_ISSET (VmPtr, VMFLAGS_STEP)) {
-      EbcDebugSignalException (EXCEPT_EBC_STEP, EXCEPTION_FLAG_NONE, VmPtr);
+      //
+      // If the step flag is set, signal an exception and continue. We don't
+      // clear it here. Assuming the debugger is responsible for clearing it.
+      //
+      if (VMFLAG_ISSET (VmPtr, VMFLAGS_STEP)) {
+        EbcDebugSignalException (EXCEPT_EBC_STEP, EXCEPTION_FLAG_NONE, VmPtr);
+      }
     }
 
     //
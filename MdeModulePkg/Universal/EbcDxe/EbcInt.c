@@ -405,9 +405,10 @@ EbcRegisterImage (
   IN  OUT EFI_IMAGE_ENTRY_POINT                 *EntryPoint
   )
 {
+  EFI_STATUS  Status;
+
   DEBUG_CODE_BEGIN ();
   PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
-  EFI_STATUS                    Status;
 
   ZeroMem (&ImageContext, sizeof (ImageContext));
 
@@ -431,12 +432,25 @@ EbcRegisterImage (
     (EBC_ICACHE_FLUSH)InvalidateInstructionCacheRange
     );
 
-  return EbcCreateThunk (
-           NULL,
-           (VOID *)(UINTN)ImageBase,
-           (VOID *)(UINTN)*EntryPoint,
-           (VOID **)EntryPoint
-           );
+  Status = EbcCreateThunk (
+             NULL,
+             (VOID *)(UINTN)ImageBase,
+             (VOID *)(UINTN)*EntryPoint,
+             (VOID **)EntryPoint
+             );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Run the image from a translation cache when possible. The image is
+  // interpreted if the cache cannot be created.
+  //
+  if (EbcDebuggerHookTranslateImage ()) {
+    EbcAddImageTranslationCache ((UINTN)ImageBase, (UINTN)ImageSize);
+  }
+
+  return EFI_SUCCESS;
 }
 
 /**
@@ -457,6 +471,7 @@ EbcUnregisterImage (
   IN  EFI_PHYSICAL_ADDRESS                  ImageBase
   )
 {
+  EbcRemoveImageTranslationCache ((UINTN)ImageBase);
   return EbcUnloadImage (NULL, (VOID *)(UINTN)ImageBase);
 }
 
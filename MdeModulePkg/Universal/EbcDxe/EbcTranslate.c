@@ -0,0 +1,1794 @@
+/** @file
+  Contains the translation engine of the EBC virtual machine.
+
+  The instructions of the registered EBC images are decoded once, the first
+  time they run, into a translation cache holding per instruction the handler
+  executing it and its decoded operands. The next runs of the instruction call
+  the handler directly, without the opcode dispatch and the decoding of the
+  operands done by the interpreter.
+
+  The instructions changing the control flow across functions (CALL, RET),
+  the stack gap (LOADSP, STORESP), or stopping the VM (BREAK), as well as the
+  invalid encodings, are always left to the interpreter.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "EbcInt.h"
+#include "EbcExecute.h"
+
+typedef struct _EBC_TRANSLATED_INSTRUCTION EBC_TRANSLATED_INSTRUCTION;
+
+/**
+  Execute a translated instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction at the IP of the VM.
+
+  @retval TRUE              The instruction is executed.
+  @retval FALSE             The instruction must be executed by the
+                            interpreter. The VM context is not changed.
+
+**/
+typedef
+BOOLEAN
+(*EBC_TRANSLATED_HANDLER) (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  );
+
+struct _EBC_TRANSLATED_INSTRUCTION {
+  EBC_TRANSLATED_HANDLER    Handler;
+  INT64                     Index1;   // Index of operand 1
+  INT64                     Index2;   // Index or immediate data of operand 2, target of a jump
+  UINT8                     Opcode;
+  UINT8                     Operands;
+  UINT8                     Size;     // Size of the instruction in bytes
+  UINT8                     Variant;  // See TranslateInstruction()
+};
+
+//
+// Number of translated instructions per block of a translation cache. The
+// blocks never move, so that the instruction run by a VM interrupted by an
+// event stays valid while the event adds instructions to the cache.
+//
+#define TRANSLATION_BLOCK_SIZE  256
+
+//
+// Each 16-bit aligned address of an image has a slot telling whether an
+// instruction at this address has been translated. Other values of a slot
+// are the number of the translated instruction plus one.
+//
+#define SLOT_NOT_TRANSLATED  0
+#define SLOT_INTERPRETED     MAX_UINT32
+
+#define SLOTS_PER_PAGE  (EFI_PAGE_SIZE / sizeof (UINT16))
+
+typedef struct _EBC_TRANSLATION_CACHE EBC_TRANSLATION_CACHE;
+
+struct _EBC_TRANSLATION_CACHE {
+  EBC_TRANSLATION_CACHE         *Next;
+  UINTN                         ImageBase;
+  UINTN                         ImageSize;
+  //
+  // Slots of the image per page, NULL for the pages where no instruction
+  // has run yet.
+  //
+  UINT32                        **Slots;
+  UINTN                         PageCount;
+  //
+  // Translated instructions per block of TRANSLATION_BLOCK_SIZE.
+  //
+  EBC_TRANSLATED_INSTRUCTION    **Blocks;
+  UINTN                         BlockCount;
+  UINTN                         InstructionCount;
+};
+
+EBC_TRANSLATION_CACHE  *mEbcTranslationCacheList = NULL;
+
+//
+// TRUE while a translation cache is being updated. A VM started by an event
+// interrupting the update only runs the instructions already translated.
+//
+BOOLEAN  mEbcTranslating = FALSE;
+
+/**
+  Get the mask of the bits of a data size.
+
+  @param  DataSize          DATA_SIZE_8, DATA_SIZE_16, DATA_SIZE_32,
+                            DATA_SIZE_64 or DATA_SIZE_N.
+
+  @return The mask of the data.
+
+**/
+UINT64
+TranslatedDataMask (
+  IN UINT8  DataSize
+  )
+{
+  switch (DataSize) {
+    case DATA_SIZE_8:
+      return 0xFF;
+
+    case DATA_SIZE_16:
+      return 0xFFFF;
+
+    case DATA_SIZE_32:
+      return 0xFFFFFFFF;
+
+    case DATA_SIZE_N:
+      return (UINT64) ~0 >> (64 - 8 * sizeof (UINTN));
+
+    default:
+      return (UINT64) ~0;
+  }
+}
+
+/**
+  Read data from memory, zero extended to 64 bits.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  DataSize          The size of the data.
+  @param  Addr              The address to read from.
+
+  @return The data read.
+
+**/
+UINT64
+TranslatedReadMem (
+  IN VM_CONTEXT  *VmPtr,
+  IN UINT8       DataSize,
+  IN UINTN       Addr
+  )
+{
+  switch (DataSize) {
+    case DATA_SIZE_8:
+      return (UINT64)(UINT8)VmReadMem8 (VmPtr, Addr);
+
+    case DATA_SIZE_16:
+      return (UINT64)(UINT16)VmReadMem16 (VmPtr, Addr);
+
+    case DATA_SIZE_32:
+      return (UINT64)(UINT32)VmReadMem32 (VmPtr, Addr);
+
+    case DATA_SIZE_N:
+      return (UINT64)(UINTN)VmReadMemN (VmPtr, Addr);
+
+    default:
+      return (UINT64)VmReadMem64 (VmPtr, Addr);
+  }
+}
+
+/**
+  Write data to memory.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  DataSize          The size of the data.
+  @param  Addr              The address to write to.
+  @param  Data              The data to write, truncated to DataSize.
+
+**/
+VOID
+TranslatedWriteMem (
+  IN VM_CONTEXT  *VmPtr,
+  IN UINT8       DataSize,
+  IN UINTN       Addr,
+  IN UINT64      Data
+  )
+{
+  switch (DataSize) {
+    case DATA_SIZE_8:
+      VmWriteMem8 (VmPtr, Addr, (UINT8)Data);
+      break;
+
+    case DATA_SIZE_16:
+      VmWriteMem16 (VmPtr, Addr, (UINT16)Data);
+      break;
+
+    case DATA_SIZE_32:
+      VmWriteMem32 (VmPtr, Addr, (UINT32)Data);
+      break;
+
+    case DATA_SIZE_N:
+      VmWriteMemN (VmPtr, Addr, (UINTN)Data);
+      break;
+
+    default:
+      VmWriteMem64 (VmPtr, Addr, Data);
+      break;
+  }
+}
+
+/**
+  Execute a translated MOVxx instruction. Variant is the size of the move.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedMOVxx (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8   Operands;
+  UINT64  Data64;
+
+  Operands = Instruction->Operands;
+  if (OPERAND2_INDIRECT (Operands)) {
+    Data64 = TranslatedReadMem (
+               VmPtr,
+               Instruction->Variant,
+               (UINTN)(VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2)
+               );
+  } else {
+    Data64 = (UINT64)(VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2);
+    //
+    // Same special case of the address of a function parameter as ExecuteMOVxx().
+    //
+    if (((Instruction->Opcode & OPCODE_M_IMMED_OP2) != 0) &&
+        (OPERAND2_REGNUM (Operands) == 0) &&
+        (Instruction->Index2 > 0) &&
+        (OPERAND1_REGNUM (Operands) == 0) &&
+        (OPERAND1_INDIRECT (Operands))
+        )
+    {
+      Data64 = (UINT64)ConvertStackAddr (VmPtr, (UINTN)(INT64)Data64);
+    }
+  }
+
+  if (OPERAND1_INDIRECT (Operands)) {
+    TranslatedWriteMem (
+      VmPtr,
+      Instruction->Variant,
+      (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Instruction->Index1),
+      Data64
+      );
+  } else {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Data64 & TranslatedDataMask (Instruction->Variant);
+  }
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Execute a translated MOVsnw or MOVsnd instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedMOVsn (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8   Operands;
+  UINT64  Op2;
+
+  Operands = Instruction->Operands;
+  Op2      = (UINT64)(INT64)(INTN)(VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2);
+  if (OPERAND2_INDIRECT (Operands)) {
+    Op2 = (UINT64)(INT64)(INTN)VmReadMemN (VmPtr, (UINTN)Op2);
+  }
+
+  if (!OPERAND1_INDIRECT (Operands)) {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Op2;
+  } else {
+    VmWriteMemN (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Instruction->Index1), (UINTN)Op2);
+  }
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Execute a translated MOVI instruction. Index2 is the sign extended immediate
+  data, Variant the size of the move.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedMOVI (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Operands;
+
+  Operands = Instruction->Operands;
+  if (!OPERAND1_INDIRECT (Operands)) {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Instruction->Index2 & TranslatedDataMask (Instruction->Variant);
+  } else {
+    TranslatedWriteMem (
+      VmPtr,
+      Instruction->Variant,
+      (UINTN)((UINT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + (INT16)Instruction->Index1),
+      (UINT64)Instruction->Index2
+      );
+  }
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Execute a translated MOVIn or MOVREL instruction. Index2 is the natural
+  value to move.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedMOVIn (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Operands;
+
+  Operands = Instruction->Operands;
+  if (!OPERAND1_INDIRECT (Operands)) {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Instruction->Index2;
+  } else {
+    VmWriteMemN (
+      VmPtr,
+      (UINTN)((UINT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + (INT16)Instruction->Index1),
+      (UINTN)(INTN)Instruction->Index2
+      );
+  }
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Execute a translated data manipulation instruction. Variant is TRUE for the
+  signed operations.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedDataManip (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8    Opcode;
+  UINT8    Operands;
+  BOOLEAN  IsSignedOp;
+  UINT64   Op1;
+  UINT64   Op2;
+
+  Opcode     = Instruction->Opcode;
+  Operands   = Instruction->Operands;
+  IsSignedOp = (BOOLEAN)(Instruction->Variant != 0);
+
+  Op2 = (UINT64)VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + (INT16)Instruction->Index2;
+  if (OPERAND2_INDIRECT (Operands)) {
+    if ((Opcode & DATAMANIP_M_64) != 0) {
+      Op2 = VmReadMem64 (VmPtr, (UINTN)Op2);
+    } else if (IsSignedOp) {
+      Op2 = (UINT64)(INT64)((INT32)VmReadMem32 (VmPtr, (UINTN)Op2));
+    } else {
+      Op2 = (UINT64)VmReadMem32 (VmPtr, (UINTN)Op2);
+    }
+  } else if ((Opcode & DATAMANIP_M_64) == 0) {
+    if (IsSignedOp) {
+      Op2 = (UINT64)(INT64)((INT32)Op2);
+    } else {
+      Op2 = (UINT64)((UINT32)Op2);
+    }
+  }
+
+  Op1 = (UINT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)];
+  if (OPERAND1_INDIRECT (Operands)) {
+    if ((Opcode & DATAMANIP_M_64) != 0) {
+      Op1 = VmReadMem64 (VmPtr, (UINTN)Op1);
+    } else if (IsSignedOp) {
+      Op1 = (UINT64)(INT64)((INT32)VmReadMem32 (VmPtr, (UINTN)Op1));
+    } else {
+      Op1 = (UINT64)VmReadMem32 (VmPtr, (UINTN)Op1);
+    }
+  } else if ((Opcode & DATAMANIP_M_64) == 0) {
+    if (IsSignedOp) {
+      Op1 = (UINT64)(INT64)((INT32)Op1);
+    } else {
+      Op1 = (UINT64)((UINT32)Op1);
+    }
+  }
+
+  //
+  // The operation reads the opcode at the IP, which must not move before.
+  //
+  Op2 = mDataManipDispatchTable[(Opcode & OPCODE_M_OPCODE) - OPCODE_NOT](VmPtr, Op1, Op2);
+
+  if (OPERAND1_INDIRECT (Operands)) {
+    Op1 = (UINT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)];
+    if ((Opcode & DATAMANIP_M_64) != 0) {
+      VmWriteMem64 (VmPtr, (UINTN)Op1, Op2);
+    } else {
+      VmWriteMem32 (VmPtr, (UINTN)Op1, (UINT32)Op2);
+    }
+  } else {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Op2;
+    if ((Opcode & DATAMANIP_M_64) == 0) {
+      VmPtr->Gpr[OPERAND1_REGNUM (Operands)] &= 0xFFFFFFFF;
+    }
+  }
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Set the condition code of the VM from the comparison of two operands.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Comparison        OPCODE_CMPEQ, OPCODE_CMPLTE, OPCODE_CMPGTE,
+                            OPCODE_CMPULTE or OPCODE_CMPUGTE.
+  @param  Is64Bit           TRUE to compare the 64-bit operands, FALSE to
+                            compare their lower 32 bits.
+  @param  Op1               Operand 1.
+  @param  Op2               Operand 2.
+
+**/
+VOID
+TranslatedCompare (
+  IN VM_CONTEXT  *VmPtr,
+  IN UINT8       Comparison,
+  IN BOOLEAN     Is64Bit,
+  IN INT64       Op1,
+  IN INT64       Op2
+  )
+{
+  BOOLEAN  Flag;
+
+  if (Is64Bit) {
+    switch (Comparison) {
+      case OPCODE_CMPEQ:
+        Flag = (BOOLEAN)(Op1 == Op2);
+        break;
+
+      case OPCODE_CMPLTE:
+        Flag = (BOOLEAN)(Op1 <= Op2);
+        break;
+
+      case OPCODE_CMPGTE:
+        Flag = (BOOLEAN)(Op1 >= Op2);
+        break;
+
+      case OPCODE_CMPULTE:
+        Flag = (BOOLEAN)((UINT64)Op1 <= (UINT64)Op2);
+        break;
+
+      default:
+        Flag = (BOOLEAN)((UINT64)Op1 >= (UINT64)Op2);
+        break;
+    }
+  } else {
+    switch (Comparison) {
+      case OPCODE_CMPEQ:
+        Flag = (BOOLEAN)((INT32)Op1 == (INT32)Op2);
+        break;
+
+      case OPCODE_CMPLTE:
+        Flag = (BOOLEAN)((INT32)Op1 <= (INT32)Op2);
+        break;
+
+      case OPCODE_CMPGTE:
+        Flag = (BOOLEAN)((INT32)Op1 >= (INT32)Op2);
+        break;
+
+      case OPCODE_CMPULTE:
+        Flag = (BOOLEAN)((UINT32)Op1 <= (UINT32)Op2);
+        break;
+
+      default:
+        Flag = (BOOLEAN)((UINT32)Op1 >= (UINT32)Op2);
+        break;
+    }
+  }
+
+  if (Flag) {
+    VMFLAG_SET (VmPtr, VMFLAGS_CC);
+  } else {
+    VMFLAG_CLEAR (VmPtr, (UINT64)VMFLAGS_CC);
+  }
+}
+
+/**
+  Execute a translated CMP instruction. Variant is the comparison.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedCMP (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+  INT64  Op2;
+
+  Opcode   = Instruction->Opcode;
+  Operands = Instruction->Operands;
+  if (OPERAND2_INDIRECT (Operands)) {
+    if ((Opcode & OPCODE_M_64BIT) != 0) {
+      Op2 = (INT64)VmReadMem64 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2));
+    } else {
+      Op2 = (INT64)(UINT64)((UINT32)VmReadMem32 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2)));
+    }
+  } else {
+    Op2 = VmPtr->Gpr[OPERAND2_REGNUM (Operands)] + Instruction->Index2;
+  }
+
+  TranslatedCompare (
+    VmPtr,
+    Instruction->Variant,
+    (BOOLEAN)((Opcode & OPCODE_M_64BIT) != 0),
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)],
+    Op2
+    );
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Execute a translated CMPI instruction. Index2 is the immediate data, Variant
+  the comparison.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedCMPI (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+  INT64  Op1;
+
+  Opcode   = Instruction->Opcode;
+  Operands = Instruction->Operands;
+  Op1      = (INT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)];
+  if (OPERAND1_INDIRECT (Operands)) {
+    if ((Opcode & OPCODE_M_CMPI64) != 0) {
+      Op1 = (INT64)VmReadMem64 (VmPtr, (UINTN)Op1 + (INT16)Instruction->Index1);
+    } else {
+      Op1 = (INT64)VmReadMem32 (VmPtr, (UINTN)Op1 + (INT16)Instruction->Index1);
+    }
+  }
+
+  TranslatedCompare (
+    VmPtr,
+    Instruction->Variant,
+    (BOOLEAN)((Opcode & OPCODE_M_CMPI64) != 0),
+    Op1,
+    Instruction->Index2
+    );
+
+  VmPtr->Ip += Instruction->Size;
+  return TRUE;
+}
+
+/**
+  Check whether the condition of a jump is met. Variant holds the condition
+  bits of the jump.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated jump.
+
+  @retval TRUE              The jump is taken.
+  @retval FALSE             The jump is not taken.
+
+**/
+BOOLEAN
+TranslatedJumpTaken (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  if ((Instruction->Variant & CONDITION_M_CONDITIONAL) == 0) {
+    return TRUE;
+  }
+
+  return (BOOLEAN)(((Instruction->Variant & JMP_M_CS) != 0) == (VMFLAG_ISSET (VmPtr, VMFLAGS_CC) != 0));
+}
+
+/**
+  Execute a translated JMP or JMP8 instruction of a static target. Index2 is
+  the target.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedJMP (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  if (TranslatedJumpTaken (VmPtr, Instruction)) {
+    VmPtr->Ip = (VMIP)(UINTN)Instruction->Index2;
+  } else {
+    VmPtr->Ip += Instruction->Size;
+  }
+
+  return TRUE;
+}
+
+/**
+  Execute a translated JMP32 instruction of a target computed from a register.
+  Index1 is the immediate data or index of operand 1.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+  @retval FALSE             The target is not aligned.
+
+**/
+BOOLEAN
+TranslatedJMP32 (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8   Operands;
+  UINT64  Data64;
+  UINTN   Addr;
+
+  if (!TranslatedJumpTaken (VmPtr, Instruction)) {
+    VmPtr->Ip += Instruction->Size;
+    return TRUE;
+  }
+
+  Operands = Instruction->Operands;
+  if (OPERAND1_REGNUM (Operands) == 0) {
+    Data64 = 0;
+  } else {
+    Data64 = (UINT64)OPERAND1_REGDATA (VmPtr, Operands);
+  }
+
+  if (OPERAND1_INDIRECT (Operands)) {
+    Addr = VmReadMemN (VmPtr, (UINTN)Data64 + (INT32)Instruction->Index1);
+  } else {
+    Addr = (UINTN)(Data64 + (INT32)Instruction->Index1);
+  }
+
+  //
+  // Let the interpreter signal the alignment exception.
+  //
+  if (!ADDRESS_IS_ALIGNED (Addr, sizeof (UINT16))) {
+    return FALSE;
+  }
+
+  if ((Operands & JMP_M_RELATIVE) != 0) {
+    VmPtr->Ip += Addr + Instruction->Size;
+  } else {
+    VmPtr->Ip = (VMIP)Addr;
+  }
+
+  return TRUE;
+}
+
+/**
+  Execute a translated PUSH instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedPUSH (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8   Operands;
+  INT16   Index16;
+  UINT32  Data32;
+  UINT64  Data64;
+
+  Operands   = Instruction->Operands;
+  Index16    = (INT16)Instruction->Index1;
+  VmPtr->Ip += Instruction->Size;
+
+  if ((Instruction->Opcode & PUSHPOP_M_64) != 0) {
+    if (OPERAND1_INDIRECT (Operands)) {
+      Data64 = VmReadMem64 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16));
+    } else {
+      Data64 = (UINT64)VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16;
+    }
+
+    VmPtr->Gpr[0] -= sizeof (UINT64);
+    VmWriteMem64 (VmPtr, (UINTN)VmPtr->Gpr[0], Data64);
+  } else {
+    if (OPERAND1_INDIRECT (Operands)) {
+      Data32 = VmReadMem32 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16));
+    } else {
+      Data32 = (UINT32)VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16;
+    }
+
+    VmPtr->Gpr[0] -= sizeof (UINT32);
+    VmWriteMem32 (VmPtr, (UINTN)VmPtr->Gpr[0], Data32);
+  }
+
+  return TRUE;
+}
+
+/**
+  Execute a translated POP instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedPOP (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8   Operands;
+  INT16   Index16;
+  INT32   Data32;
+  UINT64  Data64;
+
+  Operands   = Instruction->Operands;
+  Index16    = (INT16)Instruction->Index1;
+  VmPtr->Ip += Instruction->Size;
+
+  if ((Instruction->Opcode & PUSHPOP_M_64) != 0) {
+    Data64         = VmReadMem64 (VmPtr, (UINTN)VmPtr->Gpr[0]);
+    VmPtr->Gpr[0] += sizeof (UINT64);
+    if (OPERAND1_INDIRECT (Operands)) {
+      VmWriteMem64 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16), Data64);
+    } else {
+      VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = Data64 + Index16;
+    }
+  } else {
+    Data32         = (INT32)VmReadMem32 (VmPtr, (UINTN)VmPtr->Gpr[0]);
+    VmPtr->Gpr[0] += sizeof (UINT32);
+    if (OPERAND1_INDIRECT (Operands)) {
+      VmWriteMem32 (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16), Data32);
+    } else {
+      VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = (INT64)Data32 + Index16;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Execute a translated PUSHn instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedPUSHn (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Operands;
+  INT16  Index16;
+  UINTN  DataN;
+
+  Operands   = Instruction->Operands;
+  Index16    = (INT16)Instruction->Index1;
+  VmPtr->Ip += Instruction->Size;
+
+  if (OPERAND1_INDIRECT (Operands)) {
+    DataN = VmReadMemN (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16));
+  } else {
+    DataN = (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16);
+  }
+
+  VmPtr->Gpr[0] -= sizeof (UINTN);
+  VmWriteMemN (VmPtr, (UINTN)VmPtr->Gpr[0], DataN);
+  return TRUE;
+}
+
+/**
+  Execute a translated POPn instruction.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction.
+
+  @retval TRUE              The instruction is executed.
+
+**/
+BOOLEAN
+TranslatedPOPn (
+  IN VM_CONTEXT                        *VmPtr,
+  IN CONST EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Operands;
+  INT16  Index16;
+  UINTN  DataN;
+
+  Operands   = Instruction->Operands;
+  Index16    = (INT16)Instruction->Index1;
+  VmPtr->Ip += Instruction->Size;
+
+  DataN          = VmReadMemN (VmPtr, (UINTN)VmPtr->Gpr[0]);
+  VmPtr->Gpr[0] += sizeof (UINTN);
+
+  if (OPERAND1_INDIRECT (Operands)) {
+    VmWriteMemN (VmPtr, (UINTN)(VmPtr->Gpr[OPERAND1_REGNUM (Operands)] + Index16), DataN);
+  } else {
+    VmPtr->Gpr[OPERAND1_REGNUM (Operands)] = (INT64)(UINT64)(UINTN)(DataN + Index16);
+  }
+
+  return TRUE;
+}
+
+/**
+  Decode the MOVxx instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+  @retval FALSE             The instruction must be interpreted.
+
+**/
+BOOLEAN
+TranslateMOVxx (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  OpcMasked;
+
+  Opcode    = Instruction->Opcode;
+  OpcMasked = (UINT8)(Opcode & OPCODE_M_OPCODE);
+
+  switch (OpcMasked) {
+    case OPCODE_MOVBW:
+    case OPCODE_MOVBD:
+      Instruction->Variant = DATA_SIZE_8;
+      break;
+
+    case OPCODE_MOVWW:
+    case OPCODE_MOVWD:
+      Instruction->Variant = DATA_SIZE_16;
+      break;
+
+    case OPCODE_MOVDW:
+    case OPCODE_MOVDD:
+      Instruction->Variant = DATA_SIZE_32;
+      break;
+
+    case OPCODE_MOVQW:
+    case OPCODE_MOVQD:
+    case OPCODE_MOVQQ:
+      Instruction->Variant = DATA_SIZE_64;
+      break;
+
+    default:
+      Instruction->Variant = DATA_SIZE_N;
+      break;
+  }
+
+  //
+  // Operand 1 direct with an index is an invalid encoding.
+  //
+  if (!OPERAND1_INDIRECT (Instruction->Operands) && ((Opcode & OPCODE_M_IMMED_OP1) != 0)) {
+    return FALSE;
+  }
+
+  Instruction->Size = 2;
+  if ((OpcMasked <= OPCODE_MOVQW) || (OpcMasked == OPCODE_MOVNW)) {
+    if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+      Instruction->Index1 = VmReadIndex16 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT16);
+    }
+
+    if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+      Instruction->Index2 = VmReadIndex16 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT16);
+    }
+  } else if ((OpcMasked <= OPCODE_MOVQD) || (OpcMasked == OPCODE_MOVND)) {
+    if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+      Instruction->Index1 = VmReadIndex32 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT32);
+    }
+
+    if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+      Instruction->Index2 = VmReadIndex32 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT32);
+    }
+  } else {
+    if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+      Instruction->Index1 = VmReadIndex64 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT64);
+    }
+
+    if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+      Instruction->Index2 = VmReadIndex64 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT64);
+    }
+  }
+
+  Instruction->Handler = TranslatedMOVxx;
+  return TRUE;
+}
+
+/**
+  Decode the MOVsnw or MOVsnd instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+  @retval FALSE             The instruction must be interpreted.
+
+**/
+BOOLEAN
+TranslateMOVsn (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+
+  Opcode   = Instruction->Opcode;
+  Operands = Instruction->Operands;
+  if (!OPERAND1_INDIRECT (Operands) && ((Opcode & OPCODE_M_IMMED_OP1) != 0)) {
+    return FALSE;
+  }
+
+  Instruction->Size = 2;
+  if ((Opcode & OPCODE_M_OPCODE) == OPCODE_MOVSNW) {
+    if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+      Instruction->Index1 = VmReadIndex16 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT16);
+    }
+
+    if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+      if (OPERAND2_INDIRECT (Operands)) {
+        Instruction->Index2 = VmReadIndex16 (VmPtr, Instruction->Size);
+      } else {
+        Instruction->Index2 = VmReadImmed16 (VmPtr, Instruction->Size);
+      }
+
+      Instruction->Size += sizeof (UINT16);
+    }
+  } else {
+    if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+      Instruction->Index1 = VmReadIndex32 (VmPtr, Instruction->Size);
+      Instruction->Size  += sizeof (UINT32);
+    }
+
+    if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+      if (OPERAND2_INDIRECT (Operands)) {
+        Instruction->Index2 = VmReadIndex32 (VmPtr, Instruction->Size);
+      } else {
+        Instruction->Index2 = VmReadImmed32 (VmPtr, Instruction->Size);
+      }
+
+      Instruction->Size += sizeof (UINT32);
+    }
+  }
+
+  Instruction->Handler = TranslatedMOVsn;
+  return TRUE;
+}
+
+/**
+  Decode the MOVI, MOVIn or MOVREL instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+  @retval FALSE             The instruction must be interpreted.
+
+**/
+BOOLEAN
+TranslateMOVI (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+  UINT8  OpcMasked;
+  INT64  ImmData64;
+
+  Opcode    = Instruction->Opcode;
+  Operands  = Instruction->Operands;
+  OpcMasked = (UINT8)(Opcode & OPCODE_M_OPCODE);
+
+  if ((Operands & MOVI_M_IMMDATA) != 0) {
+    if (!OPERAND1_INDIRECT (Operands)) {
+      return FALSE;
+    }
+
+    Instruction->Index1 = VmReadIndex16 (VmPtr, 2);
+    Instruction->Size   = 4;
+  } else {
+    Instruction->Size = 2;
+  }
+
+  //
+  // MOVI sign extends the immediate data, MOVIn decodes it as an index.
+  //
+  switch (Opcode & MOVI_M_DATAWIDTH) {
+    case MOVI_DATAWIDTH16:
+      if (OpcMasked == OPCODE_MOVIN) {
+        ImmData64 = VmReadIndex16 (VmPtr, Instruction->Size);
+      } else {
+        ImmData64 = (INT16)VmReadImmed16 (VmPtr, Instruction->Size);
+      }
+
+      Instruction->Size += 2;
+      break;
+
+    case MOVI_DATAWIDTH32:
+      if (OpcMasked == OPCODE_MOVIN) {
+        ImmData64 = VmReadIndex32 (VmPtr, Instruction->Size);
+      } else {
+        ImmData64 = (INT32)VmReadImmed32 (VmPtr, Instruction->Size);
+      }
+
+      Instruction->Size += 4;
+      break;
+
+    case MOVI_DATAWIDTH64:
+      if (OpcMasked == OPCODE_MOVIN) {
+        ImmData64 = VmReadIndex64 (VmPtr, Instruction->Size);
+      } else {
+        ImmData64 = VmReadImmed64 (VmPtr, Instruction->Size);
+      }
+
+      Instruction->Size += 8;
+      break;
+
+    default:
+      return FALSE;
+  }
+
+  switch (OpcMasked) {
+    case OPCODE_MOVI:
+      switch (Operands & MOVI_M_MOVEWIDTH) {
+        case MOVI_MOVEWIDTH8:
+          Instruction->Variant = DATA_SIZE_8;
+          break;
+
+        case MOVI_MOVEWIDTH16:
+          Instruction->Variant = DATA_SIZE_16;
+          break;
+
+        case MOVI_MOVEWIDTH32:
+          Instruction->Variant = DATA_SIZE_32;
+          break;
+
+        default:
+          Instruction->Variant = DATA_SIZE_64;
+          break;
+      }
+
+      Instruction->Index2  = ImmData64;
+      Instruction->Handler = TranslatedMOVI;
+      break;
+
+    case OPCODE_MOVIN:
+      Instruction->Index2  = ImmData64;
+      Instruction->Handler = TranslatedMOVIn;
+      break;
+
+    default:
+      //
+      // MOVREL moves the address relative to the IP, known from now on.
+      //
+      Instruction->Index2  = (INT64)((INT64)((UINT64)(UINTN)VmPtr->Ip) + ImmData64 + Instruction->Size);
+      Instruction->Handler = TranslatedMOVIn;
+      break;
+  }
+
+  return TRUE;
+}
+
+/**
+  Decode the data manipulation instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+
+**/
+BOOLEAN
+TranslateDataManip (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  if ((Instruction->Opcode & DATAMANIP_M_IMMDATA) != 0) {
+    if (OPERAND2_INDIRECT (Instruction->Operands)) {
+      Instruction->Index2 = VmReadIndex16 (VmPtr, 2);
+    } else {
+      Instruction->Index2 = VmReadImmed16 (VmPtr, 2);
+    }
+
+    Instruction->Size = 4;
+  } else {
+    Instruction->Size = 2;
+  }
+
+  switch (Instruction->Opcode & OPCODE_M_OPCODE) {
+    case OPCODE_NEG:
+    case OPCODE_ADD:
+    case OPCODE_SUB:
+    case OPCODE_MUL:
+    case OPCODE_DIV:
+    case OPCODE_MOD:
+    case OPCODE_ASHR:
+      Instruction->Variant = TRUE;
+      break;
+
+    default:
+      Instruction->Variant = FALSE;
+      break;
+  }
+
+  Instruction->Handler = TranslatedDataManip;
+  return TRUE;
+}
+
+/**
+  Decode the CMP or CMPI instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+  @retval FALSE             The instruction must be interpreted.
+
+**/
+BOOLEAN
+TranslateCompare (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+  UINT8  OpcMasked;
+
+  Opcode    = Instruction->Opcode;
+  Operands  = Instruction->Operands;
+  OpcMasked = (UINT8)(Opcode & OPCODE_M_OPCODE);
+
+  if (OpcMasked <= OPCODE_CMPUGTE) {
+    if ((Opcode & OPCODE_M_IMMDATA) != 0) {
+      if (OPERAND2_INDIRECT (Operands)) {
+        Instruction->Index2 = VmReadIndex16 (VmPtr, 2);
+      } else {
+        Instruction->Index2 = VmReadImmed16 (VmPtr, 2);
+      }
+
+      Instruction->Size = 4;
+    } else {
+      Instruction->Size = 2;
+    }
+
+    Instruction->Variant = OpcMasked;
+    Instruction->Handler = TranslatedCMP;
+    return TRUE;
+  }
+
+  Instruction->Size = 2;
+  if ((Operands & OPERAND_M_CMPI_INDEX) != 0) {
+    if (!OPERAND1_INDIRECT (Operands)) {
+      return FALSE;
+    }
+
+    Instruction->Index1 = VmReadIndex16 (VmPtr, 2);
+    Instruction->Size  += 2;
+  }
+
+  if ((Opcode & OPCODE_M_CMPI32_DATA) != 0) {
+    Instruction->Index2 = VmReadImmed32 (VmPtr, Instruction->Size);
+    Instruction->Size  += 4;
+  } else {
+    Instruction->Index2 = (INT16)VmReadImmed16 (VmPtr, Instruction->Size);
+    Instruction->Size  += 2;
+  }
+
+  Instruction->Variant = (UINT8)(OpcMasked - OPCODE_CMPIEQ + OPCODE_CMPEQ);
+
+  //
+  // The unsigned 64-bit comparisons zero extend the immediate data.
+  //
+  if (((Opcode & OPCODE_M_CMPI64) != 0) &&
+      ((Instruction->Variant == OPCODE_CMPULTE) || (Instruction->Variant == OPCODE_CMPUGTE)))
+  {
+    Instruction->Index2 = (INT64)(UINT64)(UINT32)Instruction->Index2;
+  }
+
+  Instruction->Handler = TranslatedCMPI;
+  return TRUE;
+}
+
+/**
+  Decode the JMP or JMP8 instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+  @retval FALSE             The instruction must be interpreted.
+
+**/
+BOOLEAN
+TranslateJMP (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+  INT32  Index32;
+  UINTN  Addr;
+
+  Opcode   = Instruction->Opcode;
+  Operands = Instruction->Operands;
+
+  if ((Opcode & OPCODE_M_OPCODE) == OPCODE_JMP8) {
+    Instruction->Variant = (UINT8)(Opcode & (CONDITION_M_CONDITIONAL | JMP_M_CS));
+    Instruction->Size    = 2;
+    Instruction->Index2  = (INT64)((UINTN)VmPtr->Ip + VmReadImmed8 (VmPtr, 1) * 2 + 2);
+    Instruction->Handler = TranslatedJMP;
+    return TRUE;
+  }
+
+  Instruction->Variant = (UINT8)(Operands & (CONDITION_M_CONDITIONAL | JMP_M_CS));
+  if ((Opcode & OPCODE_M_IMMDATA64) != 0) {
+    if ((Opcode & OPCODE_M_IMMDATA) == 0) {
+      return FALSE;
+    }
+
+    Instruction->Size = 10;
+    Addr              = (UINTN)VmReadImmed64 (VmPtr, 2);
+  } else {
+    if ((Opcode & OPCODE_M_IMMDATA) != 0) {
+      if (OPERAND1_INDIRECT (Operands)) {
+        Index32 = VmReadIndex32 (VmPtr, 2);
+      } else {
+        Index32 = VmReadImmed32 (VmPtr, 2);
+      }
+
+      Instruction->Size = 6;
+    } else {
+      Index32           = 0;
+      Instruction->Size = 2;
+    }
+
+    //
+    // The target depends on a register or on the memory.
+    //
+    if ((OPERAND1_REGNUM (Operands) != 0) || OPERAND1_INDIRECT (Operands)) {
+      Instruction->Index1  = Index32;
+      Instruction->Handler = TranslatedJMP32;
+      return TRUE;
+    }
+
+    Addr = (UINTN)(INT64)Index32;
+  }
+
+  //
+  // Let the interpreter signal the alignment exception.
+  //
+  if (!ADDRESS_IS_ALIGNED (Addr, sizeof (UINT16))) {
+    return FALSE;
+  }
+
+  if ((Operands & JMP_M_RELATIVE) != 0) {
+    Addr += (UINTN)VmPtr->Ip + Instruction->Size;
+  }
+
+  Instruction->Index2  = (INT64)Addr;
+  Instruction->Handler = TranslatedJMP;
+  return TRUE;
+}
+
+/**
+  Decode the PUSH, POP, PUSHn or POPn instruction at the IP of the VM.
+
+  @param  VmPtr             A pointer to a VM context.
+  @param  Instruction       The translated instruction to fill.
+
+  @retval TRUE              The instruction is translated.
+
+**/
+BOOLEAN
+TranslatePushPop (
+  IN     VM_CONTEXT                  *VmPtr,
+  IN OUT EBC_TRANSLATED_INSTRUCTION  *Instruction
+  )
+{
+  if ((Instruction->Opcode & PUSHPOP_M_IMMDATA) != 0) {
+    if (OPERAND1_INDIRECT (Instruction->Operands)) {
+      Instruction->Index1 = VmReadIndex16 (VmPtr, 2);
+    } else {
+      Instruction->Index1 = VmReadImmed16 (VmPtr, 2);
+    }
+
+    Instruction->Size = 4;
+  } else {
+    Instruction->Size = 2;
+  }
+
+  switch (Instruction->Opcode & OPCODE_M_OPCODE) {
+    case OPCODE_PUSH:
+      Instruction->Handler = TranslatedPUSH;
+      break;
+
+    case OPCODE_POP:
+      Instruction->Handler = TranslatedPOP;
+      break;
+
+    case OPCODE_PUSHN:
+      Instruction->Handler = TranslatedPUSHn;
+      break;
+
+    default:
+      Instruction->Handler = TranslatedPOPn;
+      break;
+  }
+
+  return TRUE;
+}
+
+/**
+  Translate the instruction at the IP of the VM and add it to the translation
+  cache of its image.
+
+  The Variant of a translated instruction is the size of the data of a move,
+  TRUE for a signed data manipulation, the comparison of a compare, and the
+  condition bits of a jump.
+
+  @param  Cache             The translation cache of the image containing the
+                            IP of the VM.
+  @param  VmPtr             A pointer to a VM context.
+
+  @return The slot of the IP of the VM.
+
+**/
+UINT32
+TranslateInstruction (
+  IN EBC_TRANSLATION_CACHE  *Cache,
+  IN VM_CONTEXT             *VmPtr
+  )
+{
+  EBC_TRANSLATED_INSTRUCTION  *Instruction;
+  EBC_TRANSLATED_INSTRUCTION  *Block;
+  BOOLEAN                     Translated;
+  UINTN                       BlockIndex;
+
+  if (Cache->InstructionCount >= MAX_UINT32 - 1) {
+    return SLOT_INTERPRETED;
+  }
+
+  BlockIndex = Cache->InstructionCount / TRANSLATION_BLOCK_SIZE;
+  if (BlockIndex >= Cache->BlockCount) {
+    return SLOT_INTERPRETED;
+  }
+
+  Block = Cache->Blocks[BlockIndex];
+  if (Block == NULL) {
+    Block = AllocatePool (TRANSLATION_BLOCK_SIZE * sizeof (EBC_TRANSLATED_INSTRUCTION));
+    if (Block == NULL) {
+      return SLOT_INTERPRETED;
+    }
+
+    Cache->Blocks[BlockIndex] = Block;
+  }
+
+  Instruction = &Block[Cache->InstructionCount % TRANSLATION_BLOCK_SIZE];
+  ZeroMem (Instruction, sizeof (EBC_TRANSLATED_INSTRUCTION));
+  Instruction->Opcode   = GETOPCODE (VmPtr);
+  Instruction->Operands = GETOPERANDS (VmPtr);
+
+  switch (Instruction->Opcode & OPCODE_M_OPCODE) {
+    case OPCODE_JMP:
+    case OPCODE_JMP8:
+      Translated = TranslateJMP (VmPtr, Instruction);
+      break;
+
+    case OPCODE_CMPEQ:
+    case OPCODE_CMPLTE:
+    case OPCODE_CMPGTE:
+    case OPCODE_CMPULTE:
+    case OPCODE_CMPUGTE:
+    case OPCODE_CMPIEQ:
+    case OPCODE_CMPILTE:
+    case OPCODE_CMPIGTE:
+    case OPCODE_CMPIULTE:
+    case OPCODE_CMPIUGTE:
+      Translated = TranslateCompare (VmPtr, Instruction);
+      break;
+
+    case OPCODE_NOT:
+    case OPCODE_NEG:
+    case OPCODE_ADD:
+    case OPCODE_SUB:
+    case OPCODE_MUL:
+    case OPCODE_MULU:
+    case OPCODE_DIV:
+    case OPCODE_DIVU:
+    case OPCODE_MOD:
+    case OPCODE_MODU:
+    case OPCODE_AND:
+    case OPCODE_OR:
+    case OPCODE_XOR:
+    case OPCODE_SHL:
+    case OPCODE_SHR:
+    case OPCODE_ASHR:
+    case OPCODE_EXTNDB:
+    case OPCODE_EXTNDW:
+    case OPCODE_EXTNDD:
+      Translated = TranslateDataManip (VmPtr, Instruction);
+      break;
+
+    case OPCODE_MOVBW:
+    case OPCODE_MOVWW:
+    case OPCODE_MOVDW:
+    case OPCODE_MOVQW:
+    case OPCODE_MOVBD:
+    case OPCODE_MOVWD:
+    case OPCODE_MOVDD:
+    case OPCODE_MOVQD:
+    case OPCODE_MOVQQ:
+    case OPCODE_MOVNW:
+    case OPCODE_MOVND:
+      Translated = TranslateMOVxx (VmPtr, Instruction);
+      break;
+
+    case OPCODE_MOVSNW:
+    case OPCODE_MOVSND:
+      Translated = TranslateMOVsn (VmPtr, Instruction);
+      break;
+
+    case OPCODE_MOVI:
+    case OPCODE_MOVIN:
+    case OPCODE_MOVREL:
+      Translated = TranslateMOVI (VmPtr, Instruction);
+      break;
+
+    case OPCODE_PUSH:
+    case OPCODE_POP:
+    case OPCODE_PUSHN:
+    case OPCODE_POPN:
+      Translated = TranslatePushPop (VmPtr, Instruction);
+      break;
+
+    default:
+      Translated = FALSE;
+      break;
+  }
+
+  //
+  // The whole instruction must be in the image.
+  //
+  if (!Translated ||
+      ((UINTN)VmPtr->Ip - Cache->ImageBase + Instruction->Size > Cache->ImageSize))
+  {
+    return SLOT_INTERPRETED;
+  }
+
+  Cache->InstructionCount++;
+  return (UINT32)Cache->InstructionCount;
+}
+
+/**
+  Find the translation cache of the image containing an address.
+
+  @param  Address           The address.
+
+  @return The translation cache, NULL if no cache contains the address.
+
+**/
+EBC_TRANSLATION_CACHE *
+FindTranslationCache (
+  IN UINTN  Address
+  )
+{
+  EBC_TRANSLATION_CACHE  *Cache;
+
+  for (Cache = mEbcTranslationCacheList; Cache != NULL; Cache = Cache->Next) {
+    if (Address - Cache->ImageBase < Cache->ImageSize) {
+      return Cache;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  Create the translation cache of an EBC image, so that the instructions of
+  the image run from the cache instead of being decoded again each time.
+
+  @param  ImageBase             The base address of the EBC image.
+  @param  ImageSize             The size of the EBC image in bytes.
+
+  @retval EFI_SUCCESS           The translation cache is created.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory for the cache, the
+                                image is interpreted.
+
+**/
+EFI_STATUS
+EbcAddImageTranslationCache (
+  IN UINTN  ImageBase,
+  IN UINTN  ImageSize
+  )
+{
+  EBC_TRANSLATION_CACHE  *Cache;
+
+  if ((ImageSize == 0) || (FindTranslationCache (ImageBase) != NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  Cache = AllocateZeroPool (sizeof (EBC_TRANSLATION_CACHE));
+  if (Cache == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Cache->ImageBase  = ImageBase;
+  Cache->ImageSize  = ImageSize;
+  Cache->PageCount  = EFI_SIZE_TO_PAGES (ImageSize);
+  Cache->BlockCount = (ImageSize / sizeof (UINT16) + TRANSLATION_BLOCK_SIZE - 1) / TRANSLATION_BLOCK_SIZE;
+  Cache->Slots      = AllocateZeroPool (Cache->PageCount * sizeof (UINT32 *));
+  Cache->Blocks     = AllocateZeroPool (Cache->BlockCount * sizeof (EBC_TRANSLATED_INSTRUCTION *));
+  if ((Cache->Slots == NULL) || (Cache->Blocks == NULL)) {
+    if (Cache->Slots != NULL) {
+      FreePool (Cache->Slots);
+    }
+
+    if (Cache->Blocks != NULL) {
+      FreePool (Cache->Blocks);
+    }
+
+    FreePool (Cache);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Cache->Next              = mEbcTranslationCacheList;
+  mEbcTranslationCacheList = Cache;
+  return EFI_SUCCESS;
+}
+
+/**
+  Free the translation cache of an EBC image, if any.
+
+  @param  ImageBase             The base address of the EBC image.
+
+**/
+VOID
+EbcRemoveImageTranslationCache (
+  IN UINTN  ImageBase
+  )
+{
+  EBC_TRANSLATION_CACHE  **Link;
+  EBC_TRANSLATION_CACHE  *Cache;
+  UINTN                  Index;
+
+  for (Link = &mEbcTranslationCacheList; *Link != NULL; Link = &(*Link)->Next) {
+    if ((*Link)->ImageBase == ImageBase) {
+      break;
+    }
+  }
+
+  Cache = *Link;
+  if (Cache == NULL) {
+    return;
+  }
+
+  *Link = Cache->Next;
+
+  for (Index = 0; Index < Cache->PageCount; Index++) {
+    if (Cache->Slots[Index] != NULL) {
+      FreePool (Cache->Slots[Index]);
+    }
+  }
+
+  for (Index = 0; Index < Cache->BlockCount; Index++) {
+    if (Cache->Blocks[Index] != NULL) {
+      FreePool (Cache->Blocks[Index]);
+    }
+  }
+
+  FreePool (Cache->Slots);
+  FreePool (Cache->Blocks);
+  FreePool (Cache);
+}
+
+/**
+  Get the slot of the IP of the VM, translating the instruction at the IP if
+  it has not been translated yet.
+
+  @param  Cache             The translation cache of the image containing the
+                            IP of the VM.
+  @param  VmPtr             A pointer to a VM context.
+
+  @return The slot of the IP of the VM.
+
+**/
+UINT32
+GetTranslationSlot (
+  IN EBC_TRANSLATION_CACHE  *Cache,
+  IN VM_CONTEXT             *VmPtr
+  )
+{
+  UINTN   Offset;
+  UINT32  *Slots;
+  UINT32  Slot;
+
+  Offset = (UINTN)VmPtr->Ip - Cache->ImageBase;
+  Slots  = Cache->Slots[Offset / EFI_PAGE_SIZE];
+  if (Slots != NULL) {
+    Slot = Slots[(Offset % EFI_PAGE_SIZE) / sizeof (UINT16)];
+    if (Slot != SLOT_NOT_TRANSLATED) {
+      return Slot;
+    }
+  }
+
+  //
+  // Do not update the cache while another VM is updating it.
+  //
+  if (mEbcTranslating) {
+    return SLOT_INTERPRETED;
+  }
+
+  mEbcTranslating = TRUE;
+
+  if (Slots == NULL) {
+    Slots = AllocateZeroPool (SLOTS_PER_PAGE * sizeof (UINT32));
+    if (Slots == NULL) {
+      mEbcTranslating = FALSE;
+      return SLOT_INTERPRETED;
+    }
+
+    Cache->Slots[Offset / EFI_PAGE_SIZE] = Slots;
+  }
+
+  Slot = TranslateInstruction (Cache, VmPtr);
+  Slots[(Offset % EFI_PAGE_SIZE) / sizeof (UINT16)] = Slot;
+
+  mEbcTranslating = FALSE;
+  return Slot;
+}
+
+/**
+  Execute the instructions at the IP of the VM from the translation cache of
+  the image containing them, until an instruction that must be interpreted is
+  reached.
+
+  Instructions are translated when they are run for the first time. BREAK,
+  CALL, RET, LOADSP, STORESP, the instructions of invalid encodings and the
+  jumps to misaligned targets are always left to the interpreter.
+
+  @param  VmPtr                 A pointer to a VM context.
+
+  @return The number of instructions executed. 0 if the instruction at the IP
+          must be interpreted.
+
+**/
+UINTN
+EbcExecuteTranslated (
+  IN VM_CONTEXT  *VmPtr
+  )
+{
+  EBC_TRANSLATION_CACHE             *Cache;
+  CONST EBC_TRANSLATED_INSTRUCTION  *Instruction;
+  UINT32                            Slot;
+  UINTN                             Count;
+
+  Count = 0;
+  Cache = NULL;
+  while (TRUE) {
+    if ((Cache == NULL) || ((UINTN)VmPtr->Ip - Cache->ImageBase >= Cache->ImageSize)) {
+      Cache = FindTranslationCache ((UINTN)VmPtr->Ip);
+      if (Cache == NULL) {
+        break;
+      }
+    }
+
+    //
+    // All the instructions are 16-bit aligned, let the interpreter handle a
+    // misaligned IP.
+    //
+    if (!ADDRESS_IS_ALIGNED ((UINTN)VmPtr->Ip, sizeof (UINT16))) {
+      break;
+    }
+
+    Slot = GetTranslationSlot (Cache, VmPtr);
+    if (Slot == SLOT_INTERPRETED) {
+      break;
+    }
+
+    Instruction = &Cache->Blocks[(Slot - 1) / TRANSLATION_BLOCK_SIZE][(Slot - 1) % TRANSLATION_BLOCK_SIZE];
+
+    //
+    // The EBC VM is a strongly ordered processor, so perform a fence operation before
+    // and after each instruction is executed.
+    //
+    MemoryFence ();
+
+    if (!Instruction->Handler (VmPtr, Instruction)) {
+      break;
+    }
+
+    MemoryFence ();
+
+    Count++;
+
+    //
+    // A fatal exception, like a division by zero, stops the application.
+    //
+    if ((VmPtr->StopFlags & STOPFLAG_APP_DONE) != 0) {
+      break;
+    }
+
+    //
+    // Let the interpreter report a corrupted stack.
+    //
+    if ((*VmPtr->StackMagicPtr != (UINTN)VM_STACK_KEY_VALUE) ||
+        ((UINT64)VmPtr->Gpr[0] <= (UINT64)(UINTN)VmPtr->StackTop))
+    {
+      break;
+    }
+  }
+
+  return Count;
+}
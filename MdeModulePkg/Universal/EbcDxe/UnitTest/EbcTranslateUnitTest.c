@@ -0,0 +1,1385 @@
+/** @file
+  Host based unit tests of the translation engine of the EBC virtual machine.
+
+  Each test program runs twice from the same initial state, once interpreted
+  only, and once from the translation cache of the image holding it. Both runs
+  must leave the same registers, flags, stack and memory. Besides a few hand
+  assembled programs, random programs mixing all the translated instructions
+  with the interpreted CALL, RET and STORESP are checked.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "../EbcInt.h"
+#include "../EbcExecute.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "EBC Translation Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_IMAGE_SIZE  (2 * EFI_PAGE_SIZE)
+#define TEST_STACK_SIZE  (4 * EFI_PAGE_SIZE)
+#define TEST_DATA_SIZE   512
+
+//
+// Largest offset of the memory accesses relative to R1, which points to the
+// middle of the data buffer.
+//
+#define TEST_DATA_OFFSET_MAX  200
+
+#define RANDOM_PROGRAM_COUNT     500
+#define RANDOM_BLOCK_ITEM_COUNT  24
+#define RANDOM_LOOP_COUNT        3
+#define RANDOM_JUMP_DISTANCE     8
+#define TEST_ITEM_COUNT_MAX      128
+
+///
+/// Instructions of a test program, with the relative target to patch once
+/// the layout of the program is known.
+///
+typedef struct {
+  UINT8      Bytes[32];
+  UINT8      Length;
+  BOOLEAN    IsStackOp;
+  INTN       Target;      // Index of the target item, -1 if none
+  UINT8      PatchOffset;
+  UINT8      PatchSize;
+  UINT8      PatchEnd;    // Offset in the item the relative target is computed from
+  UINT8      PatchScale;
+  UINTN      Start;       // Offset of the item in the image
+} TEST_ITEM;
+
+///
+/// State of the VM after a test program ran.
+///
+typedef struct {
+  VM_CONTEXT    VmContext;
+  UINT8         Data[TEST_DATA_SIZE];
+  UINT8         Stack[TEST_STACK_SIZE];
+} TEST_RESULT;
+
+VM_CONTEXT  *mVmPtr = NULL;
+
+UINT8        *mImage;
+UINT8        *mStack;
+UINT8        *mData;
+UINT8        mInitialData[TEST_DATA_SIZE];
+UINT64       mInitialGpr[8];
+TEST_RESULT  *mInterpreted;
+TEST_RESULT  *mTranslated;
+
+TEST_ITEM  mItems[TEST_ITEM_COUNT_MAX];
+UINTN      mItemCount;
+UINT64     mRandomState;
+
+/**
+  Record an exception of the VM, as the EBC driver does.
+
+  @param  ExceptionType          Specifies the processor exception detected.
+  @param  ExceptionFlags         Specifies the exception context.
+  @param  VmPtr                  Pointer to a VM context.
+
+  @retval EFI_SUCCESS            This function completed successfully.
+
+**/
+EFI_STATUS
+EbcDebugSignalException (
+  IN EFI_EXCEPTION_TYPE  ExceptionType,
+  IN EXCEPTION_FLAGS     ExceptionFlags,
+  IN VM_CONTEXT          *VmPtr
+  )
+{
+  VmPtr->ExceptionFlags |= ExceptionFlags;
+  VmPtr->LastException   = (UINTN)ExceptionType;
+  if ((ExceptionFlags & EXCEPTION_FLAG_FATAL) != 0) {
+    VmPtr->StopFlags |= STOPFLAG_APP_DONE;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The test programs do not call native code.
+
+  @param  VmPtr            The pointer to current VM context.
+  @param  FuncAddr         The address of the function to call.
+  @param  NewStackPointer  New stack pointer.
+  @param  FramePtr         New frame pointer.
+  @param  Size             The size of the CALLEX instruction.
+
+**/
+VOID
+EbcLLCALLEX (
+  IN VM_CONTEXT  *VmPtr,
+  IN UINTN       FuncAddr,
+  IN UINTN       NewStackPointer,
+  IN VOID        *FramePtr,
+  IN UINT8       Size
+  )
+{
+  ASSERT (FALSE);
+}
+
+/**
+  The test programs do not create thunks.
+
+  @param  ImageHandle     The image handle to which the thunk is tied.
+  @param  EbcEntryPoint   Address of the actual EBC entry point.
+  @param  Thunk           Returned thunk.
+  @param  Flags           Flags indicating options for creating the thunk.
+
+  @retval EFI_UNSUPPORTED  Always.
+
+**/
+EFI_STATUS
+EbcCreateThunks (
+  IN EFI_HANDLE  ImageHandle,
+  IN VOID        *EbcEntryPoint,
+  OUT VOID       **Thunk,
+  IN  UINT32     Flags
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  Get a pseudo random number.
+
+  @return The next number of a xorshift sequence.
+
+**/
+UINT64
+TestRandom (
+  VOID
+  )
+{
+  mRandomState ^= LShiftU64 (mRandomState, 13);
+  mRandomState ^= RShiftU64 (mRandomState, 7);
+  mRandomState ^= LShiftU64 (mRandomState, 17);
+  return mRandomState;
+}
+
+/**
+  Get a pseudo random number in a range.
+
+  @param  Count  The number of values of the range.
+
+  @return A number from 0 to Count - 1.
+
+**/
+UINTN
+TestRandomBelow (
+  IN UINTN  Count
+  )
+{
+  return (UINTN)(TestRandom () % Count);
+}
+
+/**
+  Run the test program at the start of the image, and save the state of the
+  VM when it stops.
+
+  @param  Translate  TRUE to run the program from a translation cache.
+  @param  Result     The state of the VM.
+
+**/
+VOID
+RunTestProgram (
+  IN  BOOLEAN      Translate,
+  OUT TEST_RESULT  *Result
+  )
+{
+  VM_CONTEXT  VmContext;
+
+  if (Translate) {
+    EbcAddImageTranslationCache ((UINTN)mImage, TEST_IMAGE_SIZE);
+  }
+
+  ZeroMem (mStack, TEST_STACK_SIZE);
+  CopyMem (mData, mInitialData, TEST_DATA_SIZE);
+
+  //
+  // Same stack layout as EbcInterpret().
+  //
+  ZeroMem (&VmContext, sizeof (VmContext));
+  VmContext.Ip                = (VMIP)mImage;
+  VmContext.StackPool         = mStack;
+  VmContext.StackTop          = mStack + EFI_PAGE_SIZE;
+  VmContext.Gpr[0]            = (UINT64)(UINTN)(mStack + TEST_STACK_SIZE);
+  VmContext.HighStackBottom   = (UINTN)VmContext.Gpr[0];
+  VmContext.Gpr[0]           -= sizeof (UINTN);
+  *(UINTN *)(UINTN)VmContext.Gpr[0] = (UINTN)VM_STACK_KEY_VALUE;
+  VmContext.StackMagicPtr     = (UINTN *)(UINTN)VmContext.Gpr[0];
+  VmContext.Gpr[0]           &= ~(VM_REGISTER)(sizeof (UINTN) - 1);
+  VmContext.LowStackTop       = (UINTN)VmContext.Gpr[0];
+  VmContext.Gpr[0]           -= 2 * sizeof (UINT64);
+  VmContext.StackRetAddr      = (UINT64)VmContext.Gpr[0];
+  CopyMem (&VmContext.Gpr[1], &mInitialGpr[1], 7 * sizeof (UINT64));
+  VmContext.Gpr[1] = (UINT64)(UINTN)(mData + TEST_DATA_SIZE / 2);
+
+  EbcExecute (&VmContext);
+
+  if (Translate) {
+    EbcRemoveImageTranslationCache ((UINTN)mImage);
+  }
+
+  CopyMem (&Result->VmContext, &VmContext, sizeof (VmContext));
+  CopyMem (Result->Data, mData, TEST_DATA_SIZE);
+  CopyMem (Result->Stack, mStack, TEST_STACK_SIZE);
+}
+
+/**
+  Run the test program at the start of the image interpreted, then translated,
+  and check that both runs give the same results.
+
+  @retval UNIT_TEST_PASSED             Both runs give the same results.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The results differ.
+
+**/
+UNIT_TEST_STATUS
+CheckTestProgram (
+  VOID
+  )
+{
+  VM_CONTEXT  *Interpreted;
+  VM_CONTEXT  *Translated;
+  UINTN       Index;
+
+  RunTestProgram (FALSE, mInterpreted);
+  RunTestProgram (TRUE, mTranslated);
+
+  Interpreted = &mInterpreted->VmContext;
+  Translated  = &mTranslated->VmContext;
+  for (Index = 0; Index < ARRAY_SIZE (Interpreted->Gpr); Index++) {
+    UT_ASSERT_EQUAL (Translated->Gpr[Index], Interpreted->Gpr[Index]);
+  }
+
+  UT_ASSERT_EQUAL (Translated->Flags, Interpreted->Flags);
+  UT_ASSERT_EQUAL ((UINTN)Translated->Ip, (UINTN)Interpreted->Ip);
+  UT_ASSERT_EQUAL (Translated->LastException, Interpreted->LastException);
+  UT_ASSERT_EQUAL (Translated->ExceptionFlags, Interpreted->ExceptionFlags);
+  UT_ASSERT_EQUAL (Translated->StopFlags, Interpreted->StopFlags);
+  UT_ASSERT_EQUAL ((UINTN)Translated->FramePtr, (UINTN)Interpreted->FramePtr);
+  UT_ASSERT_MEM_EQUAL (mTranslated->Data, mInterpreted->Data, TEST_DATA_SIZE);
+  UT_ASSERT_MEM_EQUAL (mTranslated->Stack, mInterpreted->Stack, TEST_STACK_SIZE);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Load a hand assembled program at the start of the image.
+
+  @param  Program  The program.
+  @param  Size     The size of the program in bytes.
+
+**/
+VOID
+LoadTestProgram (
+  IN CONST UINT8  *Program,
+  IN UINTN        Size
+  )
+{
+  ZeroMem (mImage, TEST_IMAGE_SIZE);
+  CopyMem (mImage, Program, Size);
+}
+
+/**
+  Start a new item of the program being generated.
+
+  @return The new item.
+
+**/
+TEST_ITEM *
+NewItem (
+  VOID
+  )
+{
+  TEST_ITEM  *Item;
+
+  ASSERT (mItemCount < TEST_ITEM_COUNT_MAX);
+  Item = &mItems[mItemCount++];
+  ZeroMem (Item, sizeof (*Item));
+  Item->Target = -1;
+  return Item;
+}
+
+/**
+  Append bytes to an item.
+
+  @param  Item    The item.
+  @param  Value   The value to append, little endian.
+  @param  Length  The number of bytes to append.
+
+**/
+VOID
+Emit (
+  IN OUT TEST_ITEM  *Item,
+  IN     UINT64     Value,
+  IN     UINTN      Length
+  )
+{
+  ASSERT (Item->Length + Length <= sizeof (Item->Bytes));
+  while (Length-- > 0) {
+    Item->Bytes[Item->Length++] = (UINT8)Value;
+    Value                       = RShiftU64 (Value, 8);
+  }
+}
+
+/**
+  Set the relative target of the last bytes emitted in an item.
+
+  @param  Item    The item.
+  @param  Target  The index of the target item.
+  @param  Size    The size of the relative target emitted last.
+  @param  End     The offset in the item the relative target is computed from.
+  @param  Scale   The unit of the relative target.
+
+**/
+VOID
+SetTarget (
+  IN OUT TEST_ITEM  *Item,
+  IN     UINTN      Target,
+  IN     UINT8      Size,
+  IN     UINT8      End,
+  IN     UINT8      Scale
+  )
+{
+  Item->Target      = (INTN)Target;
+  Item->PatchOffset = (UINT8)(Item->Length - Size);
+  Item->PatchSize   = Size;
+  Item->PatchEnd    = End;
+  Item->PatchScale  = Scale;
+}
+
+/**
+  Encode a memory offset as an index of 16, 32 or 64 bits, with random
+  natural units.
+
+  @param  Offset  The offset.
+  @param  Size    The size of the index in bytes.
+
+  @return The index.
+
+**/
+UINT64
+EncodeIndex (
+  IN INT32  Offset,
+  IN UINTN  Size
+  )
+{
+  UINT64  Magnitude;
+  UINT64  Natural;
+  UINT64  Index;
+
+  Magnitude = (Offset < 0) ? (UINT64)-Offset : (UINT64)Offset;
+  Natural   = TestRandomBelow ((UINTN)(MIN (Magnitude / sizeof (UINTN), 3) + 1));
+  Magnitude = Magnitude - Natural * sizeof (UINTN);
+
+  //
+  // One unit of the field of the number of natural bits is 2, 4 or 8 bits,
+  // that is Size bits, and a single unit holds Natural.
+  //
+  Index = LShiftU64 (1, Size * 8 - 4) | LShiftU64 (Magnitude, Size) | Natural;
+  if (Offset < 0) {
+    Index |= LShiftU64 (1, Size * 8 - 1);
+  }
+
+  return Index;
+}
+
+/**
+  Get a random offset of a memory access relative to R1.
+
+  @return The offset.
+
+**/
+INT32
+RandomOffset (
+  VOID
+  )
+{
+  return (INT32)TestRandomBelow (2 * TEST_DATA_OFFSET_MAX + 1) - TEST_DATA_OFFSET_MAX;
+}
+
+/**
+  Get the operands of a random destination: R2 to R5, or @R1.
+
+  @return The operand 1 bits.
+
+**/
+UINT8
+RandomDestination (
+  VOID
+  )
+{
+  if (TestRandomBelow (3) == 0) {
+    return OPERAND_M_INDIRECT1 | 1;
+  }
+
+  return (UINT8)(2 + TestRandomBelow (4));
+}
+
+/**
+  Emit MOVIqw Register, Value.
+
+  @param  Item      The item.
+  @param  Register  The register.
+  @param  Value     The value.
+
+**/
+VOID
+EmitLoadRegister (
+  IN OUT TEST_ITEM  *Item,
+  IN     UINT8      Register,
+  IN     INT16      Value
+  )
+{
+  Emit (Item, OPCODE_MOVI | MOVI_DATAWIDTH16, 1);
+  Emit (Item, MOVI_MOVEWIDTH64 | Register, 1);
+  Emit (Item, (UINT16)Value, 2);
+}
+
+/**
+  Generate a random data manipulation instruction.
+
+  @param  Item  The item.
+
+**/
+VOID
+GenerateDataManip (
+  IN OUT TEST_ITEM  *Item
+  )
+{
+  UINT8  OpcMasked;
+  UINT8  Opcode;
+  UINT8  Operands;
+  INT16  Divisor;
+
+  OpcMasked = (UINT8)(OPCODE_NOT + TestRandomBelow (OPCODE_EXTNDD - OPCODE_NOT + 1));
+  Opcode    = OpcMasked;
+  if (TestRandomBelow (2) == 0) {
+    Opcode |= DATAMANIP_M_64;
+  }
+
+  Operands = RandomDestination ();
+
+  //
+  // Keep the shift counts in range and the divisors away from 0 and -1.
+  //
+  switch (OpcMasked) {
+    case OPCODE_SHL:
+    case OPCODE_SHR:
+    case OPCODE_ASHR:
+      EmitLoadRegister (Item, 7, (INT16)TestRandomBelow (((Opcode & DATAMANIP_M_64) != 0) ? 64 : 32));
+      Emit (Item, Opcode, 1);
+      Emit (Item, Operands | (7 << 4), 1);
+      return;
+
+    case OPCODE_DIV:
+    case OPCODE_DIVU:
+    case OPCODE_MOD:
+    case OPCODE_MODU:
+      Divisor = (INT16)(2 + TestRandomBelow (1000));
+      if (TestRandomBelow (2) == 0) {
+        Divisor = -Divisor;
+      }
+
+      EmitLoadRegister (Item, 7, Divisor);
+      Emit (Item, Opcode, 1);
+      Emit (Item, Operands | (7 << 4), 1);
+      return;
+
+    default:
+      break;
+  }
+
+  if (TestRandomBelow (3) == 0) {
+    Operands |= OPERAND_M_INDIRECT2 | (1 << 4);
+    if (TestRandomBelow (2) == 0) {
+      Emit (Item, Opcode | DATAMANIP_M_IMMDATA, 1);
+      Emit (Item, Operands, 1);
+      Emit (Item, EncodeIndex (RandomOffset (), 2), 2);
+    } else {
+      Emit (Item, Opcode, 1);
+      Emit (Item, Operands, 1);
+    }
+  } else {
+    Operands |= (UINT8)(TestRandomBelow (8) << 4);
+    if (TestRandomBelow (2) == 0) {
+      Emit (Item, Opcode | DATAMANIP_M_IMMDATA, 1);
+      Emit (Item, Operands, 1);
+      Emit (Item, TestRandom (), 2);
+    } else {
+      Emit (Item, Opcode, 1);
+      Emit (Item, Operands, 1);
+    }
+  }
+}
+
+/**
+  Generate a random CMP or CMPI instruction.
+
+  @param  Item  The item.
+
+**/
+VOID
+GenerateCompare (
+  IN OUT TEST_ITEM  *Item
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+
+  if (TestRandomBelow (2) == 0) {
+    Opcode   = (UINT8)(OPCODE_CMPEQ + TestRandomBelow (5));
+    Operands = (UINT8)TestRandomBelow (8);
+    if (TestRandomBelow (2) == 0) {
+      Opcode |= OPCODE_M_64BIT;
+    }
+
+    if (TestRandomBelow (3) == 0) {
+      Operands |= OPERAND_M_INDIRECT2 | (1 << 4);
+      if (TestRandomBelow (2) == 0) {
+        Emit (Item, Opcode | OPCODE_M_IMMDATA, 1);
+        Emit (Item, Operands, 1);
+        Emit (Item, EncodeIndex (RandomOffset (), 2), 2);
+        return;
+      }
+    } else {
+      Operands |= (UINT8)(TestRandomBelow (8) << 4);
+      if (TestRandomBelow (2) == 0) {
+        Emit (Item, Opcode | OPCODE_M_IMMDATA, 1);
+        Emit (Item, Operands, 1);
+        Emit (Item, TestRandom (), 2);
+        return;
+      }
+    }
+
+    Emit (Item, Opcode, 1);
+    Emit (Item, Operands, 1);
+    return;
+  }
+
+  Opcode = (UINT8)(OPCODE_CMPIEQ + TestRandomBelow (5));
+  if (TestRandomBelow (2) == 0) {
+    Opcode |= OPCODE_M_CMPI64;
+  }
+
+  if (TestRandomBelow (2) == 0) {
+    Opcode |= OPCODE_M_CMPI32_DATA;
+  }
+
+  Emit (Item, Opcode, 1);
+  if (TestRandomBelow (3) == 0) {
+    if (TestRandomBelow (2) == 0) {
+      Emit (Item, OPERAND_M_INDIRECT1 | OPERAND_M_CMPI_INDEX | 1, 1);
+      Emit (Item, EncodeIndex (RandomOffset (), 2), 2);
+    } else {
+      Emit (Item, OPERAND_M_INDIRECT1 | 1, 1);
+    }
+  } else {
+    Emit (Item, TestRandomBelow (8), 1);
+  }
+
+  Emit (Item, TestRandom (), ((Opcode & OPCODE_M_CMPI32_DATA) != 0) ? 4 : 2);
+}
+
+/**
+  Generate a random MOVxx or MOVsn instruction.
+
+  @param  Item  The item.
+
+**/
+VOID
+GenerateMove (
+  IN OUT TEST_ITEM  *Item
+  )
+{
+  STATIC CONST UINT8  MoveOpcodes[] = {
+    OPCODE_MOVBW,  OPCODE_MOVWW, OPCODE_MOVDW, OPCODE_MOVQW,
+    OPCODE_MOVBD,  OPCODE_MOVWD, OPCODE_MOVDD, OPCODE_MOVQD,
+    OPCODE_MOVQQ,  OPCODE_MOVNW, OPCODE_MOVND, OPCODE_MOVSNW,
+    OPCODE_MOVSND
+  };
+  UINT8               OpcMasked;
+  UINT8               Opcode;
+  UINT8               Operands;
+  UINTN               IndexSize;
+  UINT64              Index1;
+  UINT64              Index2;
+
+  OpcMasked = MoveOpcodes[TestRandomBelow (ARRAY_SIZE (MoveOpcodes))];
+  Opcode    = OpcMasked;
+  switch (OpcMasked) {
+    case OPCODE_MOVBW:
+    case OPCODE_MOVWW:
+    case OPCODE_MOVDW:
+    case OPCODE_MOVQW:
+    case OPCODE_MOVNW:
+    case OPCODE_MOVSNW:
+      IndexSize = 2;
+      break;
+
+    case OPCODE_MOVQQ:
+      IndexSize = 8;
+      break;
+
+    default:
+      IndexSize = 4;
+      break;
+  }
+
+  Index1   = 0;
+  Index2   = 0;
+  Operands = RandomDestination ();
+  if (OPERAND1_INDIRECT (Operands) && (TestRandomBelow (2) == 0)) {
+    Opcode |= OPCODE_M_IMMED_OP1;
+    Index1  = EncodeIndex (RandomOffset (), IndexSize);
+  }
+
+  if (TestRandomBelow (3) == 0) {
+    Operands |= OPERAND_M_INDIRECT2 | (1 << 4);
+    if (TestRandomBelow (2) == 0) {
+      Opcode |= OPCODE_M_IMMED_OP2;
+      Index2  = EncodeIndex (RandomOffset (), IndexSize);
+    }
+  } else {
+    Operands |= (UINT8)(TestRandomBelow (8) << 4);
+    if (TestRandomBelow (2) == 0) {
+      Opcode |= OPCODE_M_IMMED_OP2;
+      //
+      // MOVsn takes immediate data for a direct operand 2, the others an index.
+      //
+      if ((OpcMasked == OPCODE_MOVSNW) || (OpcMasked == OPCODE_MOVSND)) {
+        Index2 = TestRandom ();
+      } else {
+        Index2 = EncodeIndex (RandomOffset (), IndexSize);
+      }
+    }
+  }
+
+  Emit (Item, Opcode, 1);
+  Emit (Item, Operands, 1);
+  if ((Opcode & OPCODE_M_IMMED_OP1) != 0) {
+    Emit (Item, Index1, IndexSize);
+  }
+
+  if ((Opcode & OPCODE_M_IMMED_OP2) != 0) {
+    Emit (Item, Index2, IndexSize);
+  }
+}
+
+/**
+  Generate a random MOVI, MOVIn or MOVREL instruction.
+
+  @param  Item  The item.
+
+**/
+VOID
+GenerateMoveImmediate (
+  IN OUT TEST_ITEM  *Item
+  )
+{
+  UINT8  OpcMasked;
+  UINT8  Operands;
+  UINTN  DataSize;
+
+  OpcMasked = (UINT8)(OPCODE_MOVI + TestRandomBelow (3));
+  DataSize  = (UINTN)1 << (1 + TestRandomBelow (3));
+  Operands  = RandomDestination ();
+  if (OpcMasked == OPCODE_MOVI) {
+    Operands |= (UINT8)(TestRandomBelow (4) << 4);
+  }
+
+  if (OPERAND1_INDIRECT (Operands) && (TestRandomBelow (2) == 0)) {
+    Operands |= MOVI_M_IMMDATA;
+  }
+
+  Emit (Item, OpcMasked | ((DataSize == 2) ? MOVI_DATAWIDTH16 : ((DataSize == 4) ? MOVI_DATAWIDTH32 : MOVI_DATAWIDTH64)), 1);
+  Emit (Item, Operands, 1);
+  if ((Operands & MOVI_M_IMMDATA) != 0) {
+    Emit (Item, EncodeIndex (RandomOffset (), 2), 2);
+  }
+
+  if (OpcMasked == OPCODE_MOVIN) {
+    Emit (Item, EncodeIndex ((INT32)TestRandomBelow (0x400) - 0x200, DataSize), DataSize);
+  } else {
+    Emit (Item, TestRandom (), DataSize);
+  }
+}
+
+/**
+  Generate a random PUSH, PUSHn, POP or POPn instruction.
+
+  @param  Item      The item.
+  @param  Push      TRUE for a push, FALSE for a pop.
+  @param  DataSize  The size of the data pushed or popped, 4, 8 or 0 for a
+                    natural size.
+
+**/
+VOID
+GenerateStackOp (
+  IN OUT TEST_ITEM  *Item,
+  IN     BOOLEAN    Push,
+  IN     UINTN      DataSize
+  )
+{
+  UINT8  Opcode;
+  UINT8  Operands;
+
+  if (DataSize == 0) {
+    Opcode = Push ? OPCODE_PUSHN : OPCODE_POPN;
+  } else {
+    Opcode = Push ? OPCODE_PUSH : OPCODE_POP;
+    if (DataSize == 8) {
+      Opcode |= PUSHPOP_M_64;
+    }
+  }
+
+  if (Push) {
+    Operands = (UINT8)TestRandomBelow (8);
+    if (TestRandomBelow (3) == 0) {
+      Operands = OPERAND_M_INDIRECT1 | 1;
+    }
+  } else {
+    Operands = RandomDestination ();
+  }
+
+  Item->IsStackOp = TRUE;
+  if (TestRandomBelow (2) == 0) {
+    Emit (Item, Opcode | PUSHPOP_M_IMMDATA, 1);
+    Emit (Item, Operands, 1);
+    if (OPERAND1_INDIRECT (Operands)) {
+      Emit (Item, EncodeIndex (RandomOffset (), 2), 2);
+    } else {
+      Emit (Item, TestRandom (), 2);
+    }
+  } else {
+    Emit (Item, Opcode, 1);
+    Emit (Item, Operands, 1);
+  }
+}
+
+/**
+  Generate a random forward jump, possibly conditional, to a later item of
+  the same block.
+
+  @param  Item    The item.
+  @param  Target  The index of the target item.
+
+**/
+VOID
+GenerateJump (
+  IN OUT TEST_ITEM  *Item,
+  IN     UINTN      Target
+  )
+{
+  UINT8  Condition;
+  INT32  Offset;
+
+  Condition = (UINT8)(TestRandomBelow (4) << 6);
+  switch (TestRandomBelow (6)) {
+    case 0:
+      //
+      // JMP8 Offset/2
+      //
+      Emit (Item, OPCODE_JMP8 | Condition, 1);
+      Emit (Item, 0, 1);
+      SetTarget (Item, Target, 1, 2, 2);
+      break;
+
+    case 1:
+      //
+      // JMP32 Immed32, relative
+      //
+      Emit (Item, OPCODE_JMP | OPCODE_M_IMMDATA, 1);
+      Emit (Item, Condition | JMP_M_RELATIVE, 1);
+      Emit (Item, 0, 4);
+      SetTarget (Item, Target, 4, 6, 1);
+      break;
+
+    case 2:
+      //
+      // JMP64 Immed64, relative
+      //
+      Emit (Item, OPCODE_JMP | OPCODE_M_IMMDATA | OPCODE_M_IMMDATA64, 1);
+      Emit (Item, Condition | JMP_M_RELATIVE, 1);
+      Emit (Item, 0, 8);
+      SetTarget (Item, Target, 8, 10, 1);
+      break;
+
+    case 3:
+      //
+      // MOVRELd R7, Target; JMP32 R7
+      //
+      Emit (Item, OPCODE_MOVREL | MOVI_DATAWIDTH32, 1);
+      Emit (Item, 7, 1);
+      Emit (Item, 0, 4);
+      SetTarget (Item, Target, 4, 6, 1);
+      Emit (Item, OPCODE_JMP, 1);
+      Emit (Item, Condition | 7, 1);
+      break;
+
+    case 4:
+      //
+      // MOVIqd R7, Target - End; JMP32 R7, relative
+      //
+      Emit (Item, OPCODE_MOVI | MOVI_DATAWIDTH32, 1);
+      Emit (Item, MOVI_MOVEWIDTH64 | 7, 1);
+      Emit (Item, 0, 4);
+      SetTarget (Item, Target, 4, 8, 1);
+      Emit (Item, OPCODE_JMP, 1);
+      Emit (Item, Condition | JMP_M_RELATIVE | 7, 1);
+      break;
+
+    default:
+      //
+      // MOVRELd R7, Target; MOVnw @R1(Offset), R7; JMP32 @R1(Offset)
+      //
+      Offset = RandomOffset ();
+      Emit (Item, OPCODE_MOVREL | MOVI_DATAWIDTH32, 1);
+      Emit (Item, 7, 1);
+      Emit (Item, 0, 4);
+      SetTarget (Item, Target, 4, 6, 1);
+      Emit (Item, OPCODE_MOVNW | OPCODE_M_IMMED_OP1, 1);
+      Emit (Item, (7 << 4) | OPERAND_M_INDIRECT1 | 1, 1);
+      Emit (Item, EncodeIndex (Offset, 2), 2);
+      Emit (Item, OPCODE_JMP | OPCODE_M_IMMDATA, 1);
+      Emit (Item, Condition | OPERAND_M_INDIRECT1 | 1, 1);
+      Emit (Item, EncodeIndex (Offset, 4), 4);
+      break;
+  }
+}
+
+/**
+  Generate a random block of items. The pushes and pops of the block are
+  balanced, and the jumps stay in the block without skipping any of them.
+
+  @param  ItemCount  The number of items to generate, excluding the pops
+                     balancing the pushes at the end of the block.
+
+**/
+VOID
+GenerateBlock (
+  IN UINTN  ItemCount
+  )
+{
+  UINTN      PushedSizes[RANDOM_BLOCK_ITEM_COUNT];
+  UINTN      PushCount;
+  UINTN      First;
+  UINTN      Index;
+  UINTN      Limit;
+  TEST_ITEM  *Item;
+
+  First     = mItemCount;
+  PushCount = 0;
+  for (Index = 0; Index < ItemCount; Index++) {
+    Item = NewItem ();
+    switch (TestRandomBelow (8)) {
+      case 0:
+        GenerateDataManip (Item);
+        break;
+
+      case 1:
+        GenerateCompare (Item);
+        break;
+
+      case 2:
+        GenerateMove (Item);
+        break;
+
+      case 3:
+        GenerateMoveImmediate (Item);
+        break;
+
+      case 4:
+        if ((PushCount > 0) && (TestRandomBelow (2) == 0)) {
+          GenerateStackOp (Item, FALSE, PushedSizes[--PushCount]);
+        } else {
+          PushedSizes[PushCount] = 4 * TestRandomBelow (3);
+          GenerateStackOp (Item, TRUE, PushedSizes[PushCount++]);
+        }
+
+        break;
+
+      case 5:
+        //
+        // STORESP R1, [FLAGS|IP]
+        //
+        Emit (Item, OPCODE_STORESP, 1);
+        Emit (Item, (TestRandomBelow (2) << 4) | (2 + TestRandomBelow (4)), 1);
+        break;
+
+      default:
+        //
+        // Jumps are patched once the block is complete.
+        //
+        Item->Target = (INTN)mItemCount;
+        break;
+    }
+  }
+
+  while (PushCount > 0) {
+    GenerateStackOp (NewItem (), FALSE, PushedSizes[--PushCount]);
+  }
+
+  for (Index = First; Index < mItemCount; Index++) {
+    Item = &mItems[Index];
+    if ((Item->Length != 0) || (Item->Target < 0)) {
+      continue;
+    }
+
+    //
+    // The target is up to the next push or pop, or the item after the block.
+    //
+    for (Limit = Index + 1; Limit < mItemCount && Limit < Index + RANDOM_JUMP_DISTANCE; Limit++) {
+      if (mItems[Limit].IsStackOp) {
+        break;
+      }
+    }
+
+    GenerateJump (Item, Index + 1 + TestRandomBelow (Limit - Index));
+  }
+}
+
+/**
+  Generate a random program at the start of the image:
+
+      MOVIqw  R6, RANDOM_LOOP_COUNT
+    Loop:
+      [block]
+      CALL32  Subroutine
+      [block]
+      MOVIqw  R7, 1
+      SUB64   R6, R7
+      CMPI64wgte R6, 1
+      JMPcs   Loop
+      RET
+    Subroutine:
+      [block]
+      RET
+
+  The blocks only write R2 to R5, R7 and the data buffer.
+
+**/
+VOID
+GenerateProgram (
+  VOID
+  )
+{
+  TEST_ITEM  *Item;
+  TEST_ITEM  *Call;
+  UINTN      Loop;
+  UINTN      Index;
+  UINTN      Offset;
+  INT64      Relative;
+
+  mItemCount = 0;
+  EmitLoadRegister (NewItem (), 6, RANDOM_LOOP_COUNT);
+
+  Loop = mItemCount;
+  GenerateBlock (1 + TestRandomBelow (RANDOM_BLOCK_ITEM_COUNT / 2));
+
+  Call = NewItem ();
+  Emit (Call, OPCODE_CALL | OPCODE_M_IMMDATA, 1);
+  Emit (Call, OPERAND_M_RELATIVE_ADDR, 1);
+  Emit (Call, 0, 4);
+
+  GenerateBlock (1 + TestRandomBelow (RANDOM_BLOCK_ITEM_COUNT / 2));
+
+  Item = NewItem ();
+  EmitLoadRegister (Item, 7, 1);
+  Emit (Item, OPCODE_SUB | DATAMANIP_M_64, 1);
+  Emit (Item, (7 << 4) | 6, 1);
+  Emit (Item, OPCODE_CMPIGTE | OPCODE_M_CMPI64, 1);
+  Emit (Item, 6, 1);
+  Emit (Item, 1, 2);
+  Emit (Item, OPCODE_JMP | OPCODE_M_IMMDATA, 1);
+  Emit (Item, JMP_M_CONDITIONAL | JMP_M_CS | JMP_M_RELATIVE, 1);
+  Emit (Item, 0, 4);
+  SetTarget (Item, Loop, 4, Item->Length, 1);
+  Emit (Item, OPCODE_RET, 1);
+  Emit (Item, 0, 1);
+
+  SetTarget (Call, mItemCount, 4, 6, 1);
+  GenerateBlock (1 + TestRandomBelow (RANDOM_BLOCK_ITEM_COUNT / 2));
+  Item = NewItem ();
+  Emit (Item, OPCODE_RET, 1);
+  Emit (Item, 0, 1);
+
+  //
+  // Lay the items out, then patch the relative targets.
+  //
+  ZeroMem (mImage, TEST_IMAGE_SIZE);
+  Offset = 0;
+  for (Index = 0; Index < mItemCount; Index++) {
+    ASSERT (Offset + mItems[Index].Length <= TEST_IMAGE_SIZE);
+    mItems[Index].Start = Offset;
+    CopyMem (mImage + Offset, mItems[Index].Bytes, mItems[Index].Length);
+    Offset += mItems[Index].Length;
+  }
+
+  for (Index = 0; Index < mItemCount; Index++) {
+    Item = &mItems[Index];
+    if (Item->Target < 0) {
+      continue;
+    }
+
+    Relative = (INT64)mItems[Item->Target].Start - (INT64)(Item->Start + Item->PatchEnd);
+    Relative = DivS64x64Remainder (Relative, Item->PatchScale, NULL);
+    CopyMem (mImage + Item->Start + Item->PatchOffset, &Relative, Item->PatchSize);
+  }
+}
+
+/**
+  Initialize the registers and the data buffer of the test programs with
+  random values.
+
+**/
+VOID
+RandomizeInitialState (
+  VOID
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mInitialGpr); Index++) {
+    mInitialGpr[Index] = TestRandom ();
+  }
+
+  for (Index = 0; Index < TEST_DATA_SIZE; Index++) {
+    mInitialData[Index] = (UINT8)TestRandom ();
+  }
+}
+
+/**
+  Allocate the image, stack and data buffers shared by all the tests.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED                      The buffers are allocated.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  Out of memory.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  mImage       = AllocatePages (EFI_SIZE_TO_PAGES (TEST_IMAGE_SIZE));
+  mStack       = AllocatePool (TEST_STACK_SIZE);
+  mData        = AllocatePool (TEST_DATA_SIZE);
+  mInterpreted = AllocatePool (sizeof (TEST_RESULT));
+  mTranslated  = AllocatePool (sizeof (TEST_RESULT));
+  if ((mImage == NULL) || (mStack == NULL) || (mData == NULL) ||
+      (mInterpreted == NULL) || (mTranslated == NULL))
+  {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  mRandomState = 0x2545F4914F6CDD1DULL;
+  RandomizeInitialState ();
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Run a loop summing 1 to 100 through the stack and the data buffer:
+
+      MOVIqw  R2, 0
+      MOVIqw  R3, 100
+    Loop:
+      PUSH64  R3
+      POP64   R4
+      ADD64   R2, R4
+      MOVqw   @R1(+8), R2
+      MOVIqw  R7, 1
+      SUB64   R3, R7
+      CMPI64wgte R3, 1
+      JMP8cs  Loop
+      RET
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The translated loop gives the right sum.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestLoop (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8  Program[] = {
+    0x77, 0x32, 0x00, 0x00,                // MOVIqw R2, 0
+    0x77, 0x33, 0x64, 0x00,                // MOVIqw R3, 100
+    0x6B, 0x03,                            // PUSH64 R3
+    0x6C, 0x04,                            // POP64 R4
+    0x4C, 0x42,                            // ADD64 R2, R4
+    0xA0, 0x29, 0x01, 0x10,                // MOVqw @R1(+8), R2
+    0x77, 0x37, 0x01, 0x00,                // MOVIqw R7, 1
+    0x4D, 0x73,                            // SUB64 R3, R7
+    0x6F, 0x03, 0x01, 0x00,                // CMPI64wgte R3, 1
+    0xC2, 0xF5,                            // JMP8cs Loop
+    0x04, 0x00                             // RET
+  };
+  UNIT_TEST_STATUS    Status;
+
+  LoadTestProgram (Program, sizeof (Program));
+  Status = CheckTestProgram ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  UT_ASSERT_EQUAL (mTranslated->VmContext.Gpr[2], 5050);
+  UT_ASSERT_EQUAL (ReadUnaligned64 ((UINT64 *)(mTranslated->Data + TEST_DATA_SIZE / 2 + 8)), 5050);
+  UT_ASSERT_EQUAL (mTranslated->VmContext.LastException, 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that EbcExecuteTranslated() runs the instructions of a registered
+  image up to the first one left to the interpreter, and nothing once the
+  image is unregistered.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The instructions ran as expected.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestExecuteTranslated (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8  Program[] = {
+    0x77, 0x32, 0x05, 0x00,                // MOVIqw R2, 5
+    0x4C, 0x22,                            // ADD64 R2, R2
+    0x02, 0x00,                            // JMP8 +0
+    0x04, 0x00                             // RET
+  };
+  VM_CONTEXT          VmContext;
+  UINTN               Index;
+
+  LoadTestProgram (Program, sizeof (Program));
+  ZeroMem (&VmContext, sizeof (VmContext));
+  VmContext.Ip                = (VMIP)mImage;
+  VmContext.StackTop          = mStack;
+  VmContext.Gpr[0]            = (UINT64)(UINTN)(mStack + TEST_STACK_SIZE - sizeof (UINTN));
+  VmContext.StackMagicPtr     = (UINTN *)(UINTN)VmContext.Gpr[0];
+  *VmContext.StackMagicPtr    = (UINTN)VM_STACK_KEY_VALUE;
+
+  UT_ASSERT_EQUAL (EbcExecuteTranslated (&VmContext), 0);
+  UT_ASSERT_EQUAL ((UINTN)VmContext.Ip, (UINTN)mImage);
+
+  //
+  // The second run takes the translated instructions from the cache.
+  //
+  UT_ASSERT_NOT_EFI_ERROR (EbcAddImageTranslationCache ((UINTN)mImage, TEST_IMAGE_SIZE));
+  for (Index = 0; Index < 2; Index++) {
+    VmContext.Ip     = (VMIP)mImage;
+    VmContext.Gpr[2] = 0;
+    UT_ASSERT_EQUAL (EbcExecuteTranslated (&VmContext), 3);
+    UT_ASSERT_EQUAL ((UINTN)VmContext.Ip, (UINTN)mImage + 8);
+    UT_ASSERT_EQUAL (VmContext.Gpr[2], 10);
+  }
+
+  EbcRemoveImageTranslationCache ((UINTN)mImage);
+  VmContext.Ip = (VMIP)mImage;
+  UT_ASSERT_EQUAL (EbcExecuteTranslated (&VmContext), 0);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that a jump to a misaligned register target is left to the
+  interpreter, which signals the alignment exception.
+
+      MOVIqw  R7, 3
+      JMP32   R7
+      RET
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The exception is signaled.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestMisalignedJump (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8  Program[] = {
+    0x77, 0x37, 0x03, 0x00,                // MOVIqw R7, 3
+    0x01, 0x07,                            // JMP32 R7
+    0x04, 0x00                             // RET
+  };
+  UNIT_TEST_STATUS    Status;
+
+  LoadTestProgram (Program, sizeof (Program));
+  Status = CheckTestProgram ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  UT_ASSERT_EQUAL (mTranslated->VmContext.LastException, EXCEPT_EBC_ALIGNMENT_CHECK);
+  UT_ASSERT_EQUAL ((UINTN)mTranslated->VmContext.Ip, (UINTN)mImage + 4);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that a division by zero stops the program at the same point
+  interpreted and translated, for each division and each width:
+
+      MOVIqw  R2, 7
+      MOVIqw  R7, 0
+      DIV64   R2, R7
+      MOVIqw  R3, 1
+      RET
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The program stops at the division.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestDivideByZero (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  STATIC CONST UINT8  Opcodes[] = {
+    OPCODE_DIV, OPCODE_DIVU, OPCODE_MOD, OPCODE_MODU
+  };
+  UINT8               Program[] = {
+    0x77, 0x32, 0x07, 0x00,                // MOVIqw R2, 7
+    0x77, 0x37, 0x00, 0x00,                // MOVIqw R7, 0
+    0x50, 0x72,                            // DIV64 R2, R7
+    0x77, 0x33, 0x01, 0x00,                // MOVIqw R3, 1
+    0x04, 0x00                             // RET
+  };
+  UNIT_TEST_STATUS    Status;
+  UINTN               Index;
+
+  for (Index = 0; Index < 2 * ARRAY_SIZE (Opcodes); Index++) {
+    Program[8] = Opcodes[Index / 2];
+    if ((Index % 2) != 0) {
+      Program[8] |= DATAMANIP_M_64;
+    }
+
+    LoadTestProgram (Program, sizeof (Program));
+    Status = CheckTestProgram ();
+    if (Status != UNIT_TEST_PASSED) {
+      UT_LOG_ERROR ("Division opcode 0x%x differs\n", Program[8]);
+      return Status;
+    }
+
+    UT_ASSERT_EQUAL (mTranslated->VmContext.LastException, EXCEPT_EBC_DIVIDE_ERROR);
+    UT_ASSERT_NOT_EQUAL (mTranslated->VmContext.StopFlags & STOPFLAG_APP_DONE, 0);
+    UT_ASSERT_EQUAL (mTranslated->VmContext.Gpr[3], mInitialGpr[3]);
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Check that random programs give the same results interpreted and
+  translated.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             All the programs give the same results.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The results of a program differ.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRandomPrograms (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UNIT_TEST_STATUS  Status;
+  UINTN             Index;
+
+  for (Index = 0; Index < RANDOM_PROGRAM_COUNT; Index++) {
+    RandomizeInitialState ();
+    GenerateProgram ();
+    Status = CheckTestProgram ();
+    if (Status != UNIT_TEST_PASSED) {
+      UT_LOG_ERROR ("Random program %d differs\n", Index);
+      return Status;
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the EBC
+  translation engine, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      TranslateTestSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&TranslateTestSuite, Framework, "EBC translation test suite", "EbcDxe.Translate", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for EBC translation test suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (TranslateTestSuite, "Translated loop", "Loop", TestLoop, TestSetup, NULL, NULL);
+  AddTestCase (TranslateTestSuite, "Execute from the translation cache", "ExecuteTranslated", TestExecuteTranslated, TestSetup, NULL, NULL);
+  AddTestCase (TranslateTestSuite, "Misaligned jump", "MisalignedJump", TestMisalignedJump, TestSetup, NULL, NULL);
+  AddTestCase (TranslateTestSuite, "Division by zero", "DivideByZero", TestDivideByZero, TestSetup, NULL, NULL);
+  AddTestCase (TranslateTestSuite, "Random programs", "RandomPrograms", TestRandomPrograms, TestSetup, NULL, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
@@ -9,6 +9,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "HiiDatabase.h"
 extern HII_DATABASE_PRIVATE_DATA  mPrivate;
 
+GLOBAL_REMOVE_IF_UNREFERENCED CONST CHAR16  mHexDigit[] = L"0123456789abcdef";
+
 /**
   Calculate the number of Unicode characters of the incoming Configuration string,
   not including NULL terminator.
@@ -446,6 +448,49 @@ AppendToMultiString (
   return EFI_SUCCESS;
 }
 
+/**
+  Make sure that a string allocated from the pool can hold a number of
+  characters, growing it if needed. The size of the string is at least doubled
+  when it grows, so that appending to the string costs a linear time.
+
+  This is a internal function.
+
+  @param  String                 The string, its content is kept.
+  @param  StringSize             On input, the size of the string buffer in bytes.
+                                 On output, the updated size.
+  @param  Length                 The number of characters the string must hold,
+                                 not including the NULL terminator.
+
+  @retval EFI_SUCCESS            The string can hold Length characters.
+  @retval EFI_OUT_OF_RESOURCES   The string cannot grow. It is left unchanged.
+
+**/
+EFI_STATUS
+ReserveStringLength (
+  IN OUT EFI_STRING  *String,
+  IN OUT UINTN       *StringSize,
+  IN     UINTN       Length
+  )
+{
+  EFI_STRING  NewString;
+  UINTN       NewSize;
+
+  if ((Length + 1) * sizeof (CHAR16) <= *StringSize) {
+    return EFI_SUCCESS;
+  }
+
+  NewSize   = MAX ((Length + 1) * sizeof (CHAR16), *StringSize * 2);
+  NewString = (EFI_STRING)ReallocatePool (*StringSize, NewSize, *String);
+  if (NewString == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  *String     = NewString;
+  *StringSize = NewSize;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Get the value of <Number> in <BlockConfig> format, i.e. the value of OFFSET
   or WIDTH or VALUE.
@@ -474,48 +519,45 @@ GetValueOfNumber (
 {
   EFI_STRING  TmpPtr;
   UINTN       Length;
-  EFI_STRING  Str;
   UINT8       *Buf;
-  EFI_STATUS  Status;
   UINT8       DigitUint8;
   UINTN       Index;
-  CHAR16      TemStr[2];
+  CHAR16      Digit;
 
   if ((StringPtr == NULL) || (*StringPtr == L'\0') || (Number == NULL) || (Len == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Buf = NULL;
-
   TmpPtr = StringPtr;
   while (*StringPtr != L'\0' && *StringPtr != L'&') {
     StringPtr++;
   }
 
   *Len   = StringPtr - TmpPtr;
-  Length = *Len + 1;
-
-  Str = (EFI_STRING)AllocateZeroPool (Length * sizeof (CHAR16));
-  if (Str == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Exit;
-  }
+  Length = (*Len + 2) / 2;
 
-  CopyMem (Str, TmpPtr, *Len * sizeof (CHAR16));
-  *(Str + *Len) = L'\0';
-
-  Length = (Length + 1) / 2;
-  Buf    = (UINT8 *)AllocateZeroPool (Length);
+  Buf = (UINT8 *)AllocateZeroPool (Length);
   if (Buf == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Exit;
+    return EFI_OUT_OF_RESOURCES;
   }
 
+  //
+  // Convert the digits from the last one, the least significant, the
+  // characters which are not hex digits count as 0.
+  //
   Length = *Len;
-  ZeroMem (TemStr, sizeof (TemStr));
   for (Index = 0; Index < Length; Index++) {
-    TemStr[0]  = Str[Length - Index - 1];
-    DigitUint8 = (UINT8)StrHexToUint64 (TemStr);
+    Digit = TmpPtr[Length - Index - 1];
+    if ((Digit >= L'0') && (Digit <= L'9')) {
+      DigitUint8 = (UINT8)(Digit - L'0');
+    } else if ((Digit >= L'a') && (Digit <= L'f')) {
+      DigitUint8 = (UINT8)(Digit - L'a' + 10);
+    } else if ((Digit >= L'A') && (Digit <= L'F')) {
+      DigitUint8 = (UINT8)(Digit - L'A' + 10);
+    } else {
+      DigitUint8 = 0;
+    }
+
     if ((Index & 1) == 0) {
       Buf[Index/2] = DigitUint8;
     } else {
@@ -524,14 +566,8 @@ GetValueOfNumber (
   }
 
   *Number = Buf;
-  Status  = EFI_SUCCESS;
 
-Exit:
-  if (Str != NULL) {
-    FreePool (Str);
-  }
-
-  return Status;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -5678,12 +5714,9 @@ HiiBlockToConfig (
   UINT8                      *TmpBuffer;
   UINTN                      Offset;
   UINTN                      Width;
-  UINT8                      *Value;
-  EFI_STRING                 ValueStr;
-  EFI_STRING                 ConfigElement;
   UINTN                      Index;
-  UINT8                      *TemBuffer;
-  CHAR16                     *TemString;
+  UINTN                      ConfigSize;
+  UINTN                      ConfigLength;
 
   TmpBuffer = NULL;
 
@@ -5699,16 +5732,14 @@ HiiBlockToConfig (
   Private = CONFIG_ROUTING_DATABASE_PRIVATE_DATA_FROM_THIS (This);
   ASSERT (Private != NULL);
 
-  StringPtr     = ConfigRequest;
-  ValueStr      = NULL;
-  Value         = NULL;
-  ConfigElement = NULL;
+  StringPtr = ConfigRequest;
 
   //
   // Allocate a fix length of memory to store Results. Reallocate memory for
   // Results if this fix length is insufficient.
   //
-  *Config = (EFI_STRING)AllocateZeroPool (MAX_STRING_LENGTH);
+  ConfigSize = MAX_STRING_LENGTH;
+  *Config    = (EFI_STRING)AllocateZeroPool (ConfigSize);
   if (*Config == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
@@ -5753,14 +5784,14 @@ HiiBlockToConfig (
   //
   // Copy <ConfigHdr> and an additional '&' to <ConfigResp>
   //
-  TemString = AllocateCopyPool (sizeof (CHAR16) * (StringPtr - ConfigRequest + 1), ConfigRequest);
-  if (TemString == NULL) {
-    return EFI_OUT_OF_RESOURCES;
+  ConfigLength = StringPtr - ConfigRequest;
+  Status       = ReserveStringLength (Config, &ConfigSize, ConfigLength);
+  if (EFI_ERROR (Status)) {
+    *Progress = ConfigRequest;
+    goto Exit;
   }
 
-  TemString[StringPtr - ConfigRequest] = '\0';
-  AppendToMultiString (Config, TemString);
-  FreePool (TemString);
+  CopyMem (*Config, ConfigRequest, ConfigLength * sizeof (CHAR16));
 
   //
   // Parse each <RequestElement> if exists
@@ -5833,65 +5864,31 @@ HiiBlockToConfig (
       goto Exit;
     }
 
-    Value = (UINT8 *)AllocateZeroPool (Width);
-    if (Value == NULL) {
-      *Progress = ConfigRequest;
-      Status    = EFI_OUT_OF_RESOURCES;
-      goto Exit;
-    }
-
-    CopyMem (Value, (UINT8 *)Block + Offset, Width);
-
-    Length   = Width * 2 + 1;
-    ValueStr = (EFI_STRING)AllocateZeroPool (Length  * sizeof (CHAR16));
-    if (ValueStr == NULL) {
-      *Progress = ConfigRequest;
-      Status    = EFI_OUT_OF_RESOURCES;
-      goto Exit;
-    }
-
-    TemString = ValueStr;
-    TemBuffer = Value + Width - 1;
-    for (Index = 0; Index < Width; Index++, TemBuffer--) {
-      UnicodeValueToStringS (
-        TemString,
-        Length  * sizeof (CHAR16) - ((UINTN)TemString - (UINTN)ValueStr),
-        PREFIX_ZERO | RADIX_HEX,
-        *TemBuffer,
-        2
-        );
-      TemString += StrnLenS (TemString, Length - ((UINTN)TemString - (UINTN)ValueStr) / sizeof (CHAR16));
-    }
-
-    FreePool (Value);
-    Value = NULL;
-
     //
-    // Build a ConfigElement
+    // Build a ConfigElement: the <BlockName>, '&VALUE=' and the hex digits of
+    // the bytes of the block from the last one, appended to <ConfigResp>
+    // with an additional '&' when more <BlockName> follow.
     //
-    Length       += StringPtr - TmpPtr + 1 + StrLen (L"VALUE=");
-    ConfigElement = (EFI_STRING)AllocateZeroPool (Length * sizeof (CHAR16));
-    if (ConfigElement == NULL) {
-      Status = EFI_OUT_OF_RESOURCES;
+    Length = StringPtr - TmpPtr;
+    Status = ReserveStringLength (
+               Config,
+               &ConfigSize,
+               ConfigLength + Length + StrLen (L"&VALUE=") + Width * 2 + 1
+               );
+    if (EFI_ERROR (Status)) {
+      *Progress = ConfigRequest;
       goto Exit;
     }
 
-    CopyMem (ConfigElement, TmpPtr, (StringPtr - TmpPtr + 1) * sizeof (CHAR16));
-    if (*StringPtr == 0) {
-      *(ConfigElement + (StringPtr - TmpPtr)) = L'&';
+    CopyMem (*Config + ConfigLength, TmpPtr, Length * sizeof (CHAR16));
+    ConfigLength += Length;
+    CopyMem (*Config + ConfigLength, L"&VALUE=", StrLen (L"&VALUE=") * sizeof (CHAR16));
+    ConfigLength += StrLen (L"&VALUE=");
+    for (Index = Width; Index > 0; Index--) {
+      (*Config)[ConfigLength++] = mHexDigit[Block[Offset + Index - 1] >> 4];
+      (*Config)[ConfigLength++] = mHexDigit[Block[Offset + Index - 1] & 0x0F];
     }
 
-    *(ConfigElement + (StringPtr - TmpPtr) + 1) = 0;
-    StrCatS (ConfigElement, Length, L"VALUE=");
-    StrCatS (ConfigElement, Length, ValueStr);
-
-    AppendToMultiString (Config, ConfigElement);
-
-    FreePool (ConfigElement);
-    FreePool (ValueStr);
-    ConfigElement = NULL;
-    ValueStr      = NULL;
-
     //
     // If '\0', parsing is finished. Otherwise skip '&' to continue
     //
@@ -5899,7 +5896,7 @@ HiiBlockToConfig (
       break;
     }
 
-    AppendToMultiString (Config, L"&");
+    (*Config)[ConfigLength++] = L'&';
     StringPtr++;
   }
 
@@ -5909,6 +5906,7 @@ HiiBlockToConfig (
     goto Exit;
   }
 
+  (*Config)[ConfigLength] = 0;
   HiiToLower (*Config);
   *Progress = StringPtr;
   return EFI_SUCCESS;
@@ -5919,18 +5917,6 @@ Exit:
     *Config = NULL;
   }
 
-  if (ValueStr != NULL) {
-    FreePool (ValueStr);
-  }
-
-  if (Value != NULL) {
-    FreePool (Value);
-  }
-
-  if (ConfigElement != NULL) {
-    FreePool (ConfigElement);
-  }
-
   return Status;
 }
 
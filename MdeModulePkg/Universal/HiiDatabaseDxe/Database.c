@@ -1537,6 +1537,7 @@ AdjustStringPackage (
       //
       *BlockPtr = EFI_HII_SIBT_END;
       FreePool (StringPackage->StringBlock);
+      FreeStringIndex (StringPackage);
       StringPackage->StringBlock                  = StringBlock;
       StringPackage->StringPkgHdr->Header.Length += Skip2BlockSize;
       PackageList->PackageListHdr.PackageLength  += Skip2BlockSize;
@@ -1678,6 +1679,7 @@ RemoveStringPackages (
     PackageList->PackageListHdr.PackageLength -= Package->StringPkgHdr->Header.Length;
     FreePool (Package->StringBlock);
     FreePool (Package->StringPkgHdr);
+    FreeStringIndex (Package);
     //
     // Delete font information
     //
@@ -1968,6 +1970,9 @@ RemoveFontPackages (
   HII_GLOBAL_FONT_INFO       *GlobalFont;
 
   ListHead = &PackageList->FontPkgHdr;
+  if (!IsListEmpty (ListHead)) {
+    FlushGlyphCache (Private);
+  }
 
   while (!IsListEmpty (ListHead)) {
     Package = CR (
@@ -1995,6 +2000,7 @@ RemoveFontPackages (
     }
 
     FreePool (Package->FontPkgHdr);
+    FreeGlyphIndex (&Package->GlyphIndex);
     //
     // Delete default character cell information
     //
@@ -2484,6 +2490,9 @@ RemoveSimpleFontPackages (
   EFI_STATUS                        Status;
 
   ListHead = &PackageList->SimpleFontPkgHdr;
+  if (!IsListEmpty (ListHead)) {
+    FlushGlyphCache (Private);
+  }
 
   while (!IsListEmpty (ListHead)) {
     Package = CR (
@@ -2506,6 +2515,7 @@ RemoveSimpleFontPackages (
     RemoveEntryList (&Package->SimpleFontEntry);
     PackageList->PackageListHdr.PackageLength -= Package->SimpleFontPkgHdr->Header.Length;
     FreePool (Package->SimpleFontPkgHdr);
+    FreeGlyphIndex (&Package->GlyphIndex);
     FreePool (Package);
   }
 
@@ -3125,6 +3135,7 @@ AddPackages (
         StringPkgIsAdd = TRUE;
         break;
       case EFI_HII_PACKAGE_FONTS:
+        FlushGlyphCache (Private);
         Status = InsertFontPackage (
                    Private,
                    PackageHdrPtr,
@@ -3164,6 +3175,7 @@ AddPackages (
                    );
         break;
       case EFI_HII_PACKAGE_SIMPLE_FONTS:
+        FlushGlyphCache (Private);
         Status = InsertSimpleFontPackage (
                    PackageHdrPtr,
                    NotifyType,
@@ -3390,6 +3402,74 @@ ExportPackageList (
   return EFI_SUCCESS;
 }
 
+/**
+  Free the copy of a package list exported to the HII database configuration
+  table, so that the package list is exported again by the next
+  HiiGetDatabaseInfo (). It must be called before the package list is changed.
+
+  This is a internal function.
+
+  @param  PackageList            The package list.
+
+**/
+VOID
+InvalidatePackageListExport (
+  IN HII_DATABASE_PACKAGE_LIST_INSTANCE  *PackageList
+  )
+{
+  if (PackageList->ExportBuffer != NULL) {
+    FreePool (PackageList->ExportBuffer);
+    PackageList->ExportBuffer     = NULL;
+    PackageList->ExportBufferSize = 0;
+  }
+}
+
+/**
+  Export a package list to its copy used to build the HII database
+  configuration table, if the package list changed since its last export.
+
+  This is a internal function.
+
+  @param  Private                Hii database private structure.
+  @param  DatabaseRecord         The database record of the package list.
+
+  @retval EFI_SUCCESS            The copy of the package list is up to date.
+  @retval EFI_OUT_OF_RESOURCES   Not enough memory to export the package list.
+
+**/
+EFI_STATUS
+UpdatePackageListExport (
+  IN HII_DATABASE_PRIVATE_DATA  *Private,
+  IN HII_DATABASE_RECORD        *DatabaseRecord
+  )
+{
+  EFI_STATUS                          Status;
+  HII_DATABASE_PACKAGE_LIST_INSTANCE  *PackageList;
+  UINTN                               BufferSize;
+  UINTN                               UsedSize;
+
+  PackageList = DatabaseRecord->PackageList;
+  if (PackageList->ExportBuffer != NULL) {
+    return EFI_SUCCESS;
+  }
+
+  BufferSize = 0;
+  Status     = ExportPackageList (Private, DatabaseRecord->Handle, PackageList, &BufferSize, 0, NULL);
+  ASSERT_EFI_ERROR (Status);
+
+  PackageList->ExportBuffer = AllocatePool (BufferSize);
+  if (PackageList->ExportBuffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  UsedSize = 0;
+  Status   = ExportPackageList (Private, DatabaseRecord->Handle, PackageList, &UsedSize, BufferSize, PackageList->ExportBuffer);
+  ASSERT_EFI_ERROR (Status);
+  PackageList->ExportBufferSize = BufferSize;
+
+  return EFI_SUCCESS;
+}
+
 /**
 This function mainly use to get and update ConfigResp string.
 
@@ -3414,6 +3494,11 @@ HiiGetConfigRespInfo (
 
   Private = HII_DATABASE_DATABASE_PRIVATE_DATA_FROM_THIS (This);
 
+  //
+  // The ConfigResp string is exported again only when form packages change.
+  //
+  gExportConfigResp = FALSE;
+
   //
   // Get ConfigResp string
   //
@@ -3457,6 +3542,9 @@ HiiGetConfigRespInfo (
 /**
 This is an internal function,mainly use to get HiiDatabase information.
 
+Only the package lists changed since the last call are exported, the copies
+of the other package lists are reused.
+
 @param  This                   A pointer to the EFI_HII_DATABASE_PROTOCOL instance.
 
 @retval EFI_SUCCESS            Get the information successfully.
@@ -3468,19 +3556,34 @@ HiiGetDatabaseInfo (
   IN CONST EFI_HII_DATABASE_PROTOCOL  *This
   )
 {
-  EFI_STATUS                   Status;
-  EFI_HII_PACKAGE_LIST_HEADER  *DatabaseInfo;
-  UINTN                        DatabaseInfoSize;
+  EFI_STATUS                          Status;
+  HII_DATABASE_PRIVATE_DATA           *Private;
+  LIST_ENTRY                          *Link;
+  HII_DATABASE_RECORD                 *Node;
+  HII_DATABASE_PACKAGE_LIST_INSTANCE  *PackageList;
+  UINT8                               *DatabaseInfo;
+  UINTN                               DatabaseInfoSize;
 
-  DatabaseInfo     = NULL;
+  Private          = HII_DATABASE_DATABASE_PRIVATE_DATA_FROM_THIS (This);
   DatabaseInfoSize = 0;
 
   //
-  // Get HiiDatabase information.
+  // Get HiiDatabase information, exporting the package lists changed since
+  // the last export.
   //
-  Status = HiiExportPackageLists (This, NULL, &DatabaseInfoSize, DatabaseInfo);
+  for (Link = Private->DatabaseList.ForwardLink; Link != &Private->DatabaseList; Link = Link->ForwardLink) {
+    Node   = CR (Link, HII_DATABASE_RECORD, DatabaseEntry, HII_DATABASE_RECORD_SIGNATURE);
+    Status = UpdatePackageListExport (Private, Node);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "[HiiDatabase]: No enough memory resource to export the HiiDatabase info.\n"));
+      gBS->InstallConfigurationTable (&gEfiHiiDatabaseProtocolGuid, NULL);
+      return Status;
+    }
 
-  ASSERT (Status == EFI_BUFFER_TOO_SMALL);
+    DatabaseInfoSize += Node->PackageList->ExportBufferSize;
+  }
+
+  ASSERT (DatabaseInfoSize != 0);
 
   if (DatabaseInfoSize > gDatabaseInfoSize ) {
     //
@@ -3506,8 +3609,14 @@ HiiGetDatabaseInfo (
     ZeroMem (gRTDatabaseInfoBuffer, gDatabaseInfoSize);
   }
 
-  Status = HiiExportPackageLists (This, NULL, &DatabaseInfoSize, gRTDatabaseInfoBuffer);
-  ASSERT_EFI_ERROR (Status);
+  DatabaseInfo = (UINT8 *)gRTDatabaseInfoBuffer;
+  for (Link = Private->DatabaseList.ForwardLink; Link != &Private->DatabaseList; Link = Link->ForwardLink) {
+    Node        = CR (Link, HII_DATABASE_RECORD, DatabaseEntry, HII_DATABASE_RECORD_SIGNATURE);
+    PackageList = Node->PackageList;
+    CopyMem (DatabaseInfo, PackageList->ExportBuffer, PackageList->ExportBufferSize);
+    DatabaseInfo += PackageList->ExportBufferSize;
+  }
+
   gBS->InstallConfigurationTable (&gEfiHiiDatabaseProtocolGuid, gRTDatabaseInfoBuffer);
 
   return EFI_SUCCESS;
@@ -3690,6 +3799,7 @@ HiiRemovePackageList (
     if (Node->Handle == Handle) {
       PackageList = (HII_DATABASE_PACKAGE_LIST_INSTANCE *)(Node->PackageList);
       ASSERT (PackageList != NULL);
+      InvalidatePackageListExport (PackageList);
 
       //
       // Call registered functions with REMOVE_PACK before removing packages
@@ -3849,6 +3959,7 @@ HiiUpdatePackageList (
     Node = CR (Link, HII_DATABASE_RECORD, DatabaseEntry, HII_DATABASE_RECORD_SIGNATURE);
     if (Node->Handle == Handle) {
       OldPackageList = Node->PackageList;
+      InvalidatePackageListExport (OldPackageList);
       //
       // Remove the package if its type matches one of the package types which is
       // contained in the new package list.
@@ -127,6 +127,389 @@ GetCell (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Free the glyph index of a font or simple font package.
+
+  @param  GlyphIndex              The glyph index.
+
+**/
+VOID
+FreeGlyphIndex (
+  IN OUT HII_GLYPH_INDEX  *GlyphIndex
+  )
+{
+  if (GlyphIndex->Entries != NULL) {
+    FreePool (GlyphIndex->Entries);
+    GlyphIndex->Entries = NULL;
+    GlyphIndex->Mask    = 0;
+  }
+}
+
+/**
+  Allocate the entries of a glyph index, at most half full with CharCount
+  characters.
+
+  This is a internal function.
+
+  @param  GlyphIndex              The glyph index.
+  @param  CharCount               The number of characters of the index.
+
+  @retval EFI_SUCCESS             The entries are allocated.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task.
+
+**/
+EFI_STATUS
+AllocateGlyphIndex (
+  OUT HII_GLYPH_INDEX  *GlyphIndex,
+  IN  UINTN            CharCount
+  )
+{
+  UINTN  EntryCount;
+
+  EntryCount          = MAX (GetPowerOfTwo32 ((UINT32)CharCount * 4), 16);
+  GlyphIndex->Entries = AllocateZeroPool (EntryCount * sizeof (HII_GLYPH_INDEX_ENTRY));
+  if (GlyphIndex->Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  GlyphIndex->Mask = EntryCount - 1;
+  return EFI_SUCCESS;
+}
+
+/**
+  Add a character to a glyph index. The first glyph added for a character is
+  kept.
+
+  This is a internal function.
+
+  @param  GlyphIndex              The glyph index.
+  @param  CharValue               The character, 0 is never added.
+  @param  DuplicateOf             The character duplicated by this one, or 0.
+  @param  Offset                  The offset of the glyph.
+  @param  Cell                    The cell information of the glyph.
+
+**/
+VOID
+AddGlyphIndexEntry (
+  IN OUT HII_GLYPH_INDEX           *GlyphIndex,
+  IN     CHAR16                    CharValue,
+  IN     CHAR16                    DuplicateOf,
+  IN     UINT32                    Offset,
+  IN     CONST EFI_HII_GLYPH_INFO  *Cell
+  )
+{
+  UINTN                  Slot;
+  HII_GLYPH_INDEX_ENTRY  *Entry;
+
+  if (CharValue == 0) {
+    return;
+  }
+
+  for (Slot = CharValue & GlyphIndex->Mask; ; Slot = (Slot + 1) & GlyphIndex->Mask) {
+    Entry = &GlyphIndex->Entries[Slot];
+    if (Entry->CharValue == CharValue) {
+      return;
+    }
+
+    if (Entry->CharValue == 0) {
+      Entry->CharValue   = CharValue;
+      Entry->DuplicateOf = DuplicateOf;
+      Entry->Offset      = Offset;
+      CopyMem (&Entry->Cell, Cell, sizeof (EFI_HII_GLYPH_INFO));
+      return;
+    }
+  }
+}
+
+/**
+  Find a character in a glyph index.
+
+  This is a internal function.
+
+  @param  GlyphIndex              The glyph index.
+  @param  CharValue               The character.
+
+  @return The entry of the character, or NULL if it is not in the index.
+
+**/
+HII_GLYPH_INDEX_ENTRY *
+FindGlyphIndexEntry (
+  IN HII_GLYPH_INDEX  *GlyphIndex,
+  IN CHAR16           CharValue
+  )
+{
+  UINTN                  Slot;
+  HII_GLYPH_INDEX_ENTRY  *Entry;
+
+  if (CharValue == 0) {
+    return NULL;
+  }
+
+  for (Slot = CharValue & GlyphIndex->Mask; ; Slot = (Slot + 1) & GlyphIndex->Mask) {
+    Entry = &GlyphIndex->Entries[Slot];
+    if (Entry->CharValue == CharValue) {
+      return Entry;
+    }
+
+    if (Entry->CharValue == 0) {
+      return NULL;
+    }
+  }
+}
+
+/**
+  Parse all glyph blocks of a font package to count its characters, and add
+  them to its glyph index when the entries of the index are allocated.
+
+  This is a internal function.
+
+  @param  FontPackage             Hii font package instance.
+  @param  CharCount               Output the number of characters.
+
+  @retval EFI_SUCCESS             The glyph blocks are parsed.
+  @retval EFI_UNSUPPORTED         The glyph blocks contain an unknown block.
+  @retval EFI_NOT_FOUND           The default cell of a glyph is not found. The
+                                  characters found before it are counted.
+
+**/
+EFI_STATUS
+IndexGlyphBlocks (
+  IN OUT HII_FONT_PACKAGE_INSTANCE  *FontPackage,
+  OUT    UINTN                      *CharCount
+  )
+{
+  EFI_STATUS          Status;
+  UINT8               *BlockPtr;
+  UINT16              CharCurrent;
+  UINT16              Length16;
+  UINT32              Length32;
+  UINT16              Count;
+  UINT16              Index;
+  UINTN               BufferLen;
+  CHAR16              DuplicateOf;
+  EFI_HII_GLYPH_INFO  LocalCell;
+  HII_GLYPH_INDEX     *GlyphIndex;
+
+  GlyphIndex  = &FontPackage->GlyphIndex;
+  BlockPtr    = FontPackage->GlyphBlock;
+  CharCurrent = 1;
+  *CharCount  = 0;
+  ZeroMem (&LocalCell, sizeof (EFI_HII_GLYPH_INFO));
+
+  while (*BlockPtr != EFI_HII_GIBT_END) {
+    switch (*BlockPtr) {
+      case EFI_HII_GIBT_DEFAULTS:
+        BlockPtr += sizeof (EFI_HII_GIBT_DEFAULTS_BLOCK);
+        break;
+
+      case EFI_HII_GIBT_DUPLICATE:
+        CopyMem (&DuplicateOf, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (CHAR16));
+        if (GlyphIndex->Entries != NULL) {
+          AddGlyphIndexEntry (GlyphIndex, CharCurrent, DuplicateOf, 0, &LocalCell);
+        }
+
+        (*CharCount)++;
+        CharCurrent++;
+        BlockPtr += sizeof (EFI_HII_GIBT_DUPLICATE_BLOCK);
+        break;
+
+      case EFI_HII_GIBT_EXT1:
+        BlockPtr += *(UINT8 *)((UINTN)BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8));
+        break;
+      case EFI_HII_GIBT_EXT2:
+        CopyMem (
+          &Length16,
+          (UINT8 *)((UINTN)BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8)),
+          sizeof (UINT16)
+          );
+        BlockPtr += Length16;
+        break;
+      case EFI_HII_GIBT_EXT4:
+        CopyMem (
+          &Length32,
+          (UINT8 *)((UINTN)BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (UINT8)),
+          sizeof (UINT32)
+          );
+        BlockPtr += Length32;
+        break;
+
+      case EFI_HII_GIBT_GLYPH:
+        CopyMem (&LocalCell, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (EFI_HII_GLYPH_INFO));
+        BufferLen = BITMAP_LEN_1_BIT (LocalCell.Width, LocalCell.Height);
+        BlockPtr += sizeof (EFI_HII_GIBT_GLYPH_BLOCK) - sizeof (UINT8);
+        if (GlyphIndex->Entries != NULL) {
+          AddGlyphIndexEntry (GlyphIndex, CharCurrent, 0, (UINT32)(BlockPtr - FontPackage->GlyphBlock), &LocalCell);
+        }
+
+        (*CharCount)++;
+        CharCurrent++;
+        BlockPtr += BufferLen;
+        break;
+
+      case EFI_HII_GIBT_GLYPHS:
+        CopyMem (&LocalCell, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (EFI_HII_GLYPH_INFO));
+        CopyMem (&Count, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (EFI_HII_GLYPH_INFO), sizeof (UINT16));
+        BufferLen = BITMAP_LEN_1_BIT (LocalCell.Width, LocalCell.Height);
+        BlockPtr += sizeof (EFI_HII_GLYPH_BLOCK) + sizeof (EFI_HII_GLYPH_INFO) + sizeof (UINT16);
+        for (Index = 0; Index < Count; Index++) {
+          if (GlyphIndex->Entries != NULL) {
+            AddGlyphIndexEntry (GlyphIndex, (CHAR16)(CharCurrent + Index), 0, (UINT32)(BlockPtr - FontPackage->GlyphBlock), &LocalCell);
+          }
+
+          BlockPtr += BufferLen;
+        }
+
+        *CharCount += Count;
+        CharCurrent = (UINT16)(CharCurrent + Count);
+        break;
+
+      case EFI_HII_GIBT_GLYPH_DEFAULT:
+        Status = GetCell (CharCurrent, &FontPackage->GlyphInfoList, &LocalCell);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        BufferLen = BITMAP_LEN_1_BIT (LocalCell.Width, LocalCell.Height);
+        BlockPtr += sizeof (EFI_HII_GLYPH_BLOCK);
+        if (GlyphIndex->Entries != NULL) {
+          AddGlyphIndexEntry (GlyphIndex, CharCurrent, 0, (UINT32)(BlockPtr - FontPackage->GlyphBlock), &LocalCell);
+        }
+
+        (*CharCount)++;
+        CharCurrent++;
+        BlockPtr += BufferLen;
+        break;
+
+      case EFI_HII_GIBT_GLYPHS_DEFAULT:
+        CopyMem (&Count, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (UINT16));
+        Status = GetCell (CharCurrent, &FontPackage->GlyphInfoList, &LocalCell);
+        if (EFI_ERROR (Status)) {
+          return Status;
+        }
+
+        BufferLen = BITMAP_LEN_1_BIT (LocalCell.Width, LocalCell.Height);
+        BlockPtr += sizeof (EFI_HII_GIBT_GLYPHS_DEFAULT_BLOCK) - sizeof (UINT8);
+        for (Index = 0; Index < Count; Index++) {
+          if (GlyphIndex->Entries != NULL) {
+            AddGlyphIndexEntry (GlyphIndex, (CHAR16)(CharCurrent + Index), 0, (UINT32)(BlockPtr - FontPackage->GlyphBlock), &LocalCell);
+          }
+
+          BlockPtr += BufferLen;
+        }
+
+        *CharCount += Count;
+        CharCurrent = (UINT16)(CharCurrent + Count);
+        break;
+
+      case EFI_HII_GIBT_SKIP1:
+        CharCurrent = (UINT16)(CharCurrent + (UINT16)(*(BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK))));
+        BlockPtr   += sizeof (EFI_HII_GIBT_SKIP1_BLOCK);
+        break;
+      case EFI_HII_GIBT_SKIP2:
+        CopyMem (&Length16, BlockPtr + sizeof (EFI_HII_GLYPH_BLOCK), sizeof (UINT16));
+        CharCurrent = (UINT16)(CharCurrent + Length16);
+        BlockPtr   += sizeof (EFI_HII_GIBT_SKIP2_BLOCK);
+        break;
+      default:
+        return EFI_UNSUPPORTED;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the glyph index of a font package, parsing its glyph blocks twice: to
+  count the characters, then to add them to the index.
+
+  This is a internal function.
+
+  @param  FontPackage             Hii font package instance.
+
+  @retval EFI_SUCCESS             The glyph index is built.
+  @retval EFI_UNSUPPORTED         The glyph blocks contain an unknown block.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task.
+
+**/
+EFI_STATUS
+BuildGlyphIndex (
+  IN OUT HII_FONT_PACKAGE_INSTANCE  *FontPackage
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       CharCount;
+
+  Status = IndexGlyphBlocks (FontPackage, &CharCount);
+  if (Status == EFI_UNSUPPORTED) {
+    return Status;
+  }
+
+  Status = AllocateGlyphIndex (&FontPackage->GlyphIndex, CharCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // A glyph whose default cell is not found ends the parsing, as it ends the
+  // search of the characters following it in FindGlyphBlock().
+  //
+  IndexGlyphBlocks (FontPackage, &CharCount);
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the glyph index of a simple font package. The narrow glyphs are added
+  before the wide glyphs, so the first glyph of a character in the search order
+  of GetGlyphBuffer() is kept.
+
+  This is a internal function.
+
+  @param  SimpleFont              Hii simple font package instance.
+
+  @retval EFI_SUCCESS             The glyph index is built.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task.
+
+**/
+EFI_STATUS
+BuildSimpleGlyphIndex (
+  IN OUT HII_SIMPLE_FONT_PACKAGE_INSTANCE  *SimpleFont
+  )
+{
+  EFI_STATUS          Status;
+  EFI_NARROW_GLYPH    *NarrowPtr;
+  EFI_WIDE_GLYPH      *WidePtr;
+  UINT16              NarrowCount;
+  UINT16              WideCount;
+  UINT16              Index;
+  CHAR16              CharValue;
+  EFI_HII_GLYPH_INFO  LocalCell;
+
+  NarrowCount = SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs;
+  WideCount   = SimpleFont->SimpleFontPkgHdr->NumberOfWideGlyphs;
+  Status      = AllocateGlyphIndex (&SimpleFont->GlyphIndex, NarrowCount + WideCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ZeroMem (&LocalCell, sizeof (EFI_HII_GLYPH_INFO));
+  NarrowPtr = (EFI_NARROW_GLYPH *)((UINT8 *)(SimpleFont->SimpleFontPkgHdr) + sizeof (EFI_HII_SIMPLE_FONT_PACKAGE_HDR));
+  for (Index = 0; Index < NarrowCount; Index++) {
+    CopyMem (&CharValue, &NarrowPtr[Index].UnicodeWeight, sizeof (CHAR16));
+    AddGlyphIndexEntry (&SimpleFont->GlyphIndex, CharValue, 0, Index, &LocalCell);
+  }
+
+  WidePtr = (EFI_WIDE_GLYPH *)(NarrowPtr + NarrowCount);
+  for (Index = 0; Index < WideCount; Index++) {
+    CopyMem (&CharValue, &WidePtr[Index].UnicodeWeight, sizeof (CHAR16));
+    AddGlyphIndexEntry (&SimpleFont->GlyphIndex, CharValue, 0, (UINT32)NarrowCount + Index, &LocalCell);
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Convert the glyph for a single character into a bitmap.
 
@@ -168,6 +551,10 @@ GetGlyphBuffer (
   UINTN                             HeaderSize;
   EFI_NARROW_GLYPH                  *NarrowPtr;
   EFI_WIDE_GLYPH                    *WidePtr;
+  HII_GLYPH_INDEX_ENTRY             *Entry;
+  UINT32                            NarrowEnd;
+  UINT16                            WideStart;
+  UINT32                            WideEnd;
 
   if ((GlyphBuffer == NULL) || (Cell == NULL)) {
     return EFI_INVALID_PARAMETER;
@@ -206,11 +593,39 @@ GetGlyphBuffer (
            )
       {
         SimpleFont = CR (Link1, HII_SIMPLE_FONT_PACKAGE_INSTANCE, SimpleFontEntry, HII_S_FONT_PACKAGE_SIGNATURE);
+        NarrowEnd  = SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs;
+        WideStart  = 0;
+        WideEnd    = SimpleFont->SimpleFontPkgHdr->NumberOfWideGlyphs;
+        Index      = 0;
+
+        //
+        // Look up the character in the glyph index of the package, the glyph
+        // arrays are searched if the index cannot be built.
+        //
+        if ((Char != 0) &&
+            ((SimpleFont->GlyphIndex.Entries != NULL) || !EFI_ERROR (BuildSimpleGlyphIndex (SimpleFont))))
+        {
+          Entry = FindGlyphIndexEntry (&SimpleFont->GlyphIndex, Char);
+          if (Entry == NULL) {
+            continue;
+          }
+
+          if (Entry->Offset < NarrowEnd) {
+            Index     = (UINT16)Entry->Offset;
+            NarrowEnd = Index + 1;
+            WideEnd   = 0;
+          } else {
+            Index     = NarrowEnd;
+            WideStart = (UINT16)(Entry->Offset - NarrowEnd);
+            WideEnd   = WideStart + 1;
+          }
+        }
+
         //
         // Search the narrow glyph array
         //
         NarrowPtr = (EFI_NARROW_GLYPH *)((UINT8 *)(SimpleFont->SimpleFontPkgHdr) + HeaderSize);
-        for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs; Index++) {
+        for ( ; Index < NarrowEnd; Index++) {
           CopyMem (&Narrow, NarrowPtr + Index, sizeof (EFI_NARROW_GLYPH));
           if (Narrow.UnicodeWeight == Char) {
             *GlyphBuffer = (UINT8 *)AllocateZeroPool (EFI_GLYPH_HEIGHT);
@@ -234,7 +649,7 @@ GetGlyphBuffer (
         // Search the wide glyph array
         //
         WidePtr = (EFI_WIDE_GLYPH *)(NarrowPtr + SimpleFont->SimpleFontPkgHdr->NumberOfNarrowGlyphs);
-        for (Index = 0; Index < SimpleFont->SimpleFontPkgHdr->NumberOfWideGlyphs; Index++) {
+        for (Index = WideStart; Index < WideEnd; Index++) {
           CopyMem (&Wide, WidePtr + Index, sizeof (EFI_WIDE_GLYPH));
           if (Wide.UnicodeWeight == Char) {
             *GlyphBuffer = (UINT8 *)AllocateZeroPool (EFI_GLYPH_HEIGHT * 2);
@@ -577,6 +992,226 @@ GlyphToImage (
   }
 }
 
+/**
+  Flush the rendered-glyph cache. It must be called when a font or simple font
+  package is added or removed.
+
+  @param  Private                 Hii database private structure.
+
+**/
+VOID
+FlushGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA  *Private
+  )
+{
+  UINTN  Index;
+
+  if (Private->GlyphCache == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < HII_GLYPH_CACHE_SIZE; Index++) {
+    if (Private->GlyphCache[Index].Pixels != NULL) {
+      FreePool (Private->GlyphCache[Index].Pixels);
+    }
+  }
+
+  ZeroMem (Private->GlyphCache, HII_GLYPH_CACHE_SIZE * sizeof (HII_GLYPH_CACHE_ENTRY));
+}
+
+/**
+  Convert bitmap data of the glyph to blt structure, copying the pixels of the
+  glyph from the rendered-glyph cache when it is drawn opaque and not clipped.
+  The other glyphs are converted by GlyphToImage().
+
+  This is a internal function.
+
+  @param  Private                 Hii database private structure.
+  @param  FontPackage             The font package of the glyph, NULL for the
+                                  system font.
+  @param  CharValue               The character of the glyph.
+  @param  GlyphBuffer             Buffer points to bitmap data of glyph.
+  @param  Foreground              The color of the "on" pixels in the glyph in the
+                                  bitmap.
+  @param  Background              The color of the "off" pixels in the glyph in the
+                                  bitmap.
+  @param  ImageWidth              Width of the whole image in pixels.
+  @param  BaseLine                BaseLine in the line.
+  @param  RowWidth                The width of the text on the line, in pixels.
+  @param  RowHeight               The height of the line, in pixels.
+  @param  Transparent             If TRUE, the Background color is ignored and all
+                                  "off" pixels in the character's drawn will use the
+                                  pixel value from BltBuffer.
+  @param  Cell                    Points to EFI_HII_GLYPH_INFO structure.
+  @param  Attributes              The attribute of incoming glyph in GlyphBuffer.
+  @param  Origin                  On input, points to the origin of the to be
+                                  displayed character, on output, points to the
+                                  next glyph's origin.
+
+**/
+VOID
+CachedGlyphToImage (
+  IN     HII_DATABASE_PRIVATE_DATA      *Private,
+  IN     HII_FONT_PACKAGE_INSTANCE      *FontPackage OPTIONAL,
+  IN     CHAR16                         CharValue,
+  IN     UINT8                          *GlyphBuffer,
+  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Foreground,
+  IN     EFI_GRAPHICS_OUTPUT_BLT_PIXEL  Background,
+  IN     UINT16                         ImageWidth,
+  IN     UINT16                         BaseLine,
+  IN     UINTN                          RowWidth,
+  IN     UINTN                          RowHeight,
+  IN     BOOLEAN                        Transparent,
+  IN     CONST EFI_HII_GLYPH_INFO       *Cell,
+  IN     UINT8                          Attributes,
+  IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL  **Origin
+  )
+{
+  HII_GLYPH_CACHE_ENTRY          *Entry;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Buffer;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *Pixels;
+  EFI_HII_GLYPH_INFO             LocalCell;
+  UINT16                         Width;
+  UINT16                         Height;
+  UINT16                         YposOffset;
+  UINTN                          Advance;
+  UINTN                          Hash;
+  UINTN                          Ypos;
+
+  ASSERT (Origin != NULL && *Origin != NULL && Cell != NULL);
+
+  //
+  // Locate the cell of the glyph in BltBuffer as GlyphToImage() does, and
+  // check it is drawn whole.
+  //
+  Width   = 0;
+  Height  = 0;
+  Advance = 0;
+  if (  (GlyphBuffer == NULL) || Transparent
+     || ((Attributes & EFI_GLYPH_NON_SPACING) == EFI_GLYPH_NON_SPACING))
+  {
+    Buffer = NULL;
+  } else if ((Attributes & (EFI_GLYPH_WIDE | NARROW_GLYPH)) != 0) {
+    Width   = (UINT16)(((Attributes & EFI_GLYPH_WIDE) == EFI_GLYPH_WIDE) ? EFI_GLYPH_WIDTH * 2 : EFI_GLYPH_WIDTH);
+    Height  = EFI_GLYPH_HEIGHT;
+    Advance = Width;
+    Buffer  = *Origin - EFI_GLYPH_HEIGHT * ImageWidth;
+    if ((RowWidth < Width) || (RowHeight < Height)) {
+      Buffer = NULL;
+    }
+  } else if ((Attributes & PROPORTIONAL_GLYPH) == PROPORTIONAL_GLYPH) {
+    Width      = Cell->Width;
+    Height     = Cell->Height;
+    Advance    = Cell->AdvanceX;
+    Buffer     = *Origin + Cell->OffsetX - (Cell->OffsetY + Cell->Height) * ImageWidth;
+    YposOffset = (UINT16)(BaseLine - (Cell->OffsetY + Cell->Height));
+    if (  (Cell->OffsetX < 0)
+       || ((UINTN)Cell->OffsetX + Width > RowWidth)
+       || ((UINTN)YposOffset + Height > RowHeight))
+    {
+      Buffer = NULL;
+    }
+  } else {
+    Buffer = NULL;
+  }
+
+  if (  (Buffer == NULL) || (Width == 0) || (Height == 0)
+     || ((UINTN)Width * Height > HII_GLYPH_CACHE_MAX_PIXELS))
+  {
+    GlyphToImage (
+      GlyphBuffer,
+      Foreground,
+      Background,
+      ImageWidth,
+      BaseLine,
+      RowWidth,
+      RowHeight,
+      Transparent,
+      Cell,
+      Attributes,
+      Origin
+      );
+    return;
+  }
+
+  if (Private->GlyphCache == NULL) {
+    Private->GlyphCache = AllocateZeroPool (HII_GLYPH_CACHE_SIZE * sizeof (HII_GLYPH_CACHE_ENTRY));
+  }
+
+  Entry = NULL;
+  if (Private->GlyphCache != NULL) {
+    Hash = CharValue ^ ((UINTN)FontPackage >> 4) ^
+           (Foreground.Blue | Foreground.Green << 8 | Foreground.Red << 16) * 7 ^
+           (Background.Blue | Background.Green << 8 | Background.Red << 16) * 13;
+    Entry = &Private->GlyphCache[Hash % HII_GLYPH_CACHE_SIZE];
+    if (  (Entry->CharValue != CharValue) || (Entry->FontPackage != FontPackage)
+       || (Entry->Attributes != Attributes) || (Entry->Width != Width) || (Entry->Height != Height)
+       || (CompareMem (&Entry->Foreground, &Foreground, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0)
+       || (CompareMem (&Entry->Background, &Background, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)) != 0))
+    {
+      //
+      // Render the glyph in the entry, at the top-left corner of an image of
+      // the size of the cell.
+      //
+      if ((Entry->Pixels != NULL) && ((UINTN)Entry->Width * Entry->Height != (UINTN)Width * Height)) {
+        FreePool (Entry->Pixels);
+        Entry->Pixels = NULL;
+      }
+
+      if (Entry->Pixels == NULL) {
+        Entry->Pixels = AllocatePool ((UINTN)Width * Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+      }
+
+      Entry->CharValue = 0;
+      if (Entry->Pixels == NULL) {
+        Entry = NULL;
+      } else {
+        CopyMem (&LocalCell, Cell, sizeof (EFI_HII_GLYPH_INFO));
+        if ((Attributes & (EFI_GLYPH_WIDE | NARROW_GLYPH)) != 0) {
+          Pixels = Entry->Pixels + Height * Width;
+        } else {
+          LocalCell.OffsetX = 0;
+          LocalCell.OffsetY = (INT16)(-(INT16)Height);
+          Pixels            = Entry->Pixels;
+        }
+
+        GlyphToImage (GlyphBuffer, Foreground, Background, Width, 0, Width, Height, FALSE, &LocalCell, Attributes, &Pixels);
+
+        Entry->FontPackage = FontPackage;
+        Entry->CharValue   = CharValue;
+        Entry->Attributes  = Attributes;
+        Entry->Width       = Width;
+        Entry->Height      = Height;
+        CopyMem (&Entry->Foreground, &Foreground, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+        CopyMem (&Entry->Background, &Background, sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+      }
+    }
+  }
+
+  if (Entry == NULL) {
+    GlyphToImage (
+      GlyphBuffer,
+      Foreground,
+      Background,
+      ImageWidth,
+      BaseLine,
+      RowWidth,
+      RowHeight,
+      Transparent,
+      Cell,
+      Attributes,
+      Origin
+      );
+    return;
+  }
+
+  for (Ypos = 0; Ypos < Height; Ypos++) {
+    CopyMem (Buffer + Ypos * ImageWidth, Entry->Pixels + Ypos * Width, Width * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  }
+
+  *Origin = *Origin + Advance;
+}
+
 /**
   Write the output parameters of FindGlyphBlock().
 
@@ -675,6 +1310,8 @@ FindGlyphBlock (
   EFI_HII_GLYPH_INFO         LocalCell;
   INT16                      MinOffsetY;
   UINT16                     BaseLine;
+  HII_GLYPH_INDEX_ENTRY      *Entry;
+  UINTN                      Count;
 
   ASSERT (FontPackage != NULL);
   ASSERT (FontPackage->Signature == HII_FONT_PACKAGE_SIGNATURE);
@@ -700,6 +1337,33 @@ FindGlyphBlock (
       (UINT8 *)FontPackage->FontPkgHdr + 3 * sizeof (UINT32),
       sizeof (EFI_HII_GLYPH_INFO)
       );
+  } else if ((FontPackage->GlyphIndex.Entries != NULL) || !EFI_ERROR (BuildGlyphIndex (FontPackage))) {
+    //
+    // Look up the character in the glyph index of the package, following the
+    // duplicate glyphs at most once per entry to stop on loops. The glyph
+    // blocks are parsed if the index cannot be built.
+    //
+    for (Count = 0; Count <= FontPackage->GlyphIndex.Mask; Count++) {
+      Entry = FindGlyphIndexEntry (&FontPackage->GlyphIndex, CharValue);
+      if (Entry == NULL) {
+        return EFI_NOT_FOUND;
+      }
+
+      if (Entry->DuplicateOf == 0) {
+        return WriteOutputParam (
+                 FontPackage->GlyphBlock + Entry->Offset,
+                 BITMAP_LEN_1_BIT (Entry->Cell.Width, Entry->Cell.Height),
+                 &Entry->Cell,
+                 GlyphBuffer,
+                 Cell,
+                 GlyphBufferLen
+                 );
+      }
+
+      CharValue = Entry->DuplicateOf;
+    }
+
+    return EFI_NOT_FOUND;
   }
 
   BlockPtr    = FontPackage->GlyphBlock;
@@ -1672,6 +2336,7 @@ HiiStringToImage (
   UINTN                          StrLength;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL  *RowBufferPtr;
   HII_GLOBAL_FONT_INFO           *GlobalFont;
+  HII_FONT_PACKAGE_INSTANCE      *FontPackage;
   UINT32                         PreInitBkgnd;
 
   //
@@ -1751,6 +2416,7 @@ HiiStringToImage (
   StringIn2     = NULL;
   SystemDefault = NULL;
   StringIn      = NULL;
+  FontPackage   = NULL;
 
   //
   // Calculate the string output information, including specified color and font .
@@ -1789,7 +2455,8 @@ HiiStringToImage (
     } else if (Status == EFI_SUCCESS) {
       FontInfo = &StringInfoOut->FontInfo;
       if (IsFontInfoExisted (Private, FontInfo, NULL, NULL, &GlobalFont)) {
-        Height     = GlobalFont->FontPackage->Height;
+        FontPackage = GlobalFont->FontPackage;
+        Height      = GlobalFont->FontPackage->Height;
         BaseLine   = GlobalFont->FontPackage->BaseLine;
         Foreground = StringInfoOut->ForegroundColor;
         Background = StringInfoOut->BackgroundColor;
@@ -2149,7 +2816,10 @@ HiiStringToImage (
           //
           // Only BLT these character which have corresponding glyph in font database.
           //
-          GlyphToImage (
+          CachedGlyphToImage (
+            Private,
+            FontPackage,
+            StringPtr[Index1],
             GlyphBuf[Index1],
             Foreground,
             Background,
@@ -2213,7 +2883,10 @@ HiiStringToImage (
           //
           // Only BLT these character which have corresponding glyph in font database.
           //
-          GlyphToImage (
+          CachedGlyphToImage (
+            Private,
+            FontPackage,
+            StringPtr[Index1],
             GlyphBuf[Index1],
             Foreground,
             Background,
@@ -150,6 +150,19 @@ typedef struct {
 // String Package definitions
 //
 #define HII_STRING_PACKAGE_SIGNATURE  SIGNATURE_32 ('h','i','s','p')
+
+//
+// Entry of the string index of a string package, the offsets of the string
+// block and of the string text of a string ID. BlockOffset is
+// HII_STRING_INDEX_NONE for the string IDs of the skip blocks.
+//
+#define HII_STRING_INDEX_NONE  MAX_UINT32
+
+typedef struct {
+  UINT32    BlockOffset;
+  UINT32    TextOffset;
+} HII_STRING_INDEX_ENTRY;
+
 typedef struct _HII_STRING_PACKAGE_INSTANCE {
   UINTN                         Signature;
   EFI_HII_STRING_PACKAGE_HDR    *StringPkgHdr;
@@ -158,6 +171,7 @@ typedef struct _HII_STRING_PACKAGE_INSTANCE {
   LIST_ENTRY                    FontInfoList;          // local font info list
   UINT8                         FontId;
   EFI_STRING_ID                 MaxStringId;           // record StringId
+  HII_STRING_INDEX_ENTRY        *StringIndex;          // indexed by StringId, NULL until the first lookup
 } HII_STRING_PACKAGE_INSTANCE;
 
 //
@@ -171,6 +185,26 @@ typedef struct _HII_IFR_PACKAGE_INSTANCE {
   LIST_ENTRY                IfrEntry;
 } HII_IFR_PACKAGE_INSTANCE;
 
+//
+// Hash table of the glyphs of a font or simple font package, open addressed
+// on the character value. CharValue is 0 for the free entries. Offset is the
+// offset of the bitmap in the glyph blocks of a font package, and the index
+// of the glyph in the narrow glyphs followed by the wide glyphs of a simple
+// font package. DuplicateOf is the character of an EFI_HII_GIBT_DUPLICATE
+// block, 0 for the other glyphs.
+//
+typedef struct {
+  CHAR16                CharValue;
+  CHAR16                DuplicateOf;
+  UINT32                Offset;
+  EFI_HII_GLYPH_INFO    Cell;
+} HII_GLYPH_INDEX_ENTRY;
+
+typedef struct {
+  UINTN                    Mask;        // number of entries - 1, the number of entries is a power of 2
+  HII_GLYPH_INDEX_ENTRY    *Entries;    // NULL until the first lookup
+} HII_GLYPH_INDEX;
+
 //
 // Simple Font Package definitions
 //
@@ -179,6 +213,7 @@ typedef struct _HII_SIMPLE_FONT_PACKAGE_INSTANCE {
   UINTN                              Signature;
   EFI_HII_SIMPLE_FONT_PACKAGE_HDR    *SimpleFontPkgHdr;
   LIST_ENTRY                         SimpleFontEntry;
+  HII_GLYPH_INDEX                    GlyphIndex;
 } HII_SIMPLE_FONT_PACKAGE_INSTANCE;
 
 //
@@ -193,6 +228,7 @@ typedef struct _HII_FONT_PACKAGE_INSTANCE {
   UINT8                       *GlyphBlock;
   LIST_ENTRY                  FontEntry;
   LIST_ENTRY                  GlyphInfoList;
+  HII_GLYPH_INDEX             GlyphIndex;
 } HII_FONT_PACKAGE_INSTANCE;
 
 #define HII_GLYPH_INFO_SIGNATURE  SIGNATURE_32 ('h','g','i','s')
@@ -268,6 +304,12 @@ typedef struct _HII_DATABASE_PACKAGE_LIST_INSTANCE {
   HII_IMAGE_PACKAGE_INSTANCE     *ImagePkg;
   LIST_ENTRY                     SimpleFontPkgHdr;
   UINT8                          *DevicePathPkg;
+  //
+  // The copy of the package list exported to the HII database configuration
+  // table after ReadyToBoot, NULL when the package list changed since then.
+  //
+  EFI_HII_PACKAGE_LIST_HEADER    *ExportBuffer;
+  UINTN                          ExportBufferSize;
 } HII_DATABASE_PACKAGE_LIST_INSTANCE;
 
 #define HII_HANDLE_SIGNATURE  SIGNATURE_32 ('h','i','h','l')
@@ -300,6 +342,25 @@ typedef struct _HII_DATABASE_NOTIFY {
   LIST_ENTRY                      DatabaseNotifyEntry;
 } HII_DATABASE_NOTIFY;
 
+//
+// Rendered-glyph cache, direct mapped. An entry holds the pixels of the cell
+// of a glyph drawn opaque with the given colors. FontPackage is NULL for the
+// glyphs of the system font, CharValue is 0 for the free entries.
+//
+#define HII_GLYPH_CACHE_SIZE        256
+#define HII_GLYPH_CACHE_MAX_PIXELS  (64 * 64)
+
+typedef struct {
+  HII_FONT_PACKAGE_INSTANCE        *FontPackage;
+  CHAR16                           CharValue;
+  UINT8                            Attributes;
+  UINT16                           Width;
+  UINT16                           Height;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    Foreground;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    Background;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    *Pixels;
+} HII_GLYPH_CACHE_ENTRY;
+
 #define HII_DATABASE_PRIVATE_DATA_SIGNATURE  SIGNATURE_32 ('H', 'i', 'D', 'p')
 
 typedef struct _HII_DATABASE_PRIVATE_DATA {
@@ -319,6 +380,7 @@ typedef struct _HII_DATABASE_PRIVATE_DATA {
   UINTN                                  Attribute;    // default system color
   EFI_GUID                               CurrentLayoutGuid;
   EFI_HII_KEYBOARD_LAYOUT                *CurrentLayout;
+  HII_GLYPH_CACHE_ENTRY                  *GlyphCache;  // HII_GLYPH_CACHE_SIZE entries, NULL until the first draw
 } HII_DATABASE_PRIVATE_DATA;
 
 #define HII_FONT_DATABASE_PRIVATE_DATA_FROM_THIS(a) \
@@ -565,6 +627,42 @@ FindGlyphBlock (
   OUT UINTN                      *GlyphBufferLen OPTIONAL
   );
 
+/**
+  Free the string index of a string package. It must be called when the string
+  blocks of the package are changed, the index is built again on the next
+  lookup.
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+FreeStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  );
+
+/**
+  Free the glyph index of a font or simple font package.
+
+  @param  GlyphIndex              The glyph index.
+
+**/
+VOID
+FreeGlyphIndex (
+  IN OUT HII_GLYPH_INDEX  *GlyphIndex
+  );
+
+/**
+  Flush the rendered-glyph cache. It must be called when a font or simple font
+  package is added or removed.
+
+  @param  Private                 Hii database private structure.
+
+**/
+VOID
+FlushGlyphCache (
+  IN HII_DATABASE_PRIVATE_DATA  *Private
+  );
+
 /**
   This function exports Form packages to a buffer.
   This is a internal function.
@@ -2294,6 +2392,21 @@ HiiGetDatabaseInfo (
   IN CONST EFI_HII_DATABASE_PROTOCOL  *This
   );
 
+/**
+  Free the copy of a package list exported to the HII database configuration
+  table, so that the package list is exported again by the next
+  HiiGetDatabaseInfo (). It must be called before the package list is changed.
+
+  This is a internal function.
+
+  @param  PackageList            The package list.
+
+**/
+VOID
+InvalidatePackageListExport (
+  IN HII_DATABASE_PACKAGE_LIST_INSTANCE  *PackageList
+  );
+
 /**
 This function mainly use to get and update ConfigResp string.
 
@@ -641,6 +641,7 @@ HiiNewImage (
   }
 
   EfiAcquireLock (&mHiiDatabaseLock);
+  InvalidatePackageListExport (PackageListNode);
 
   //
   // Calcuate the size of new image.
@@ -1167,6 +1168,8 @@ HiiSetImage (
       return EFI_NOT_FOUND;
   }
 
+  InvalidatePackageListExport (PackageListNode);
+
   //
   // Create the new image block according to input image.
   //
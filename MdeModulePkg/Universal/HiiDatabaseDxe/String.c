@@ -225,6 +225,249 @@ GetStringFontInfo (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Free the string index of a string package. It must be called when the string
+  blocks of the package are changed, the index is built again on the next
+  lookup.
+
+  @param  StringPackage           Hii string package instance.
+
+**/
+VOID
+FreeStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  )
+{
+  if (StringPackage->StringIndex != NULL) {
+    FreePool (StringPackage->StringIndex);
+    StringPackage->StringIndex = NULL;
+  }
+}
+
+/**
+  Parse all string blocks of a string package once to build its string index,
+  the offsets of the block and of the text of each string ID.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+
+  @retval EFI_SUCCESS             The string index is built.
+  @retval EFI_UNSUPPORTED         The string blocks contain an unknown block.
+  @retval EFI_OUT_OF_RESOURCES    The system is out of resources to accomplish the
+                                  task.
+
+**/
+EFI_STATUS
+BuildStringIndex (
+  IN OUT HII_STRING_PACKAGE_INSTANCE  *StringPackage
+  )
+{
+  HII_STRING_INDEX_ENTRY   *StringIndex;
+  UINT8                    *BlockHdr;
+  UINT8                    *StringTextPtr;
+  EFI_STRING_ID            CurrentStringId;
+  UINT16                   StringCount;
+  UINT16                   SkipCount;
+  UINT16                   Index;
+  BOOLEAN                  Ucs2;
+  UINTN                    StringSize;
+  UINT8                    Length8;
+  EFI_HII_SIBT_EXT2_BLOCK  Ext2;
+  UINT32                   Length32;
+
+  StringIndex = AllocatePool ((StringPackage->MaxStringId + 1) * sizeof (HII_STRING_INDEX_ENTRY));
+  if (StringIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem (StringIndex, (StringPackage->MaxStringId + 1) * sizeof (HII_STRING_INDEX_ENTRY), 0xFF);
+
+  BlockHdr        = StringPackage->StringBlock;
+  CurrentStringId = 1;
+  StringSize      = 0;
+  while (*BlockHdr != EFI_HII_SIBT_END) {
+    StringCount = 1;
+    Ucs2        = FALSE;
+    switch (*BlockHdr) {
+      case EFI_HII_SIBT_STRING_SCSU:
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_STRING_BLOCK);
+        break;
+
+      case EFI_HII_SIBT_STRING_SCSU_FONT:
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRING_SCSU_FONT_BLOCK) - sizeof (UINT8);
+        break;
+
+      case EFI_HII_SIBT_STRINGS_SCSU:
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_BLOCK) - sizeof (UINT8);
+        break;
+
+      case EFI_HII_SIBT_STRINGS_SCSU_FONT:
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_SCSU_FONT_BLOCK) - sizeof (UINT8);
+        break;
+
+      case EFI_HII_SIBT_STRING_UCS2:
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_STRING_BLOCK);
+        Ucs2          = TRUE;
+        break;
+
+      case EFI_HII_SIBT_STRING_UCS2_FONT:
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRING_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+        Ucs2          = TRUE;
+        break;
+
+      case EFI_HII_SIBT_STRINGS_UCS2:
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_BLOCK) - sizeof (CHAR16);
+        Ucs2          = TRUE;
+        break;
+
+      case EFI_HII_SIBT_STRINGS_UCS2_FONT:
+        CopyMem (&StringCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT16));
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_STRINGS_UCS2_FONT_BLOCK) - sizeof (CHAR16);
+        Ucs2          = TRUE;
+        break;
+
+      case EFI_HII_SIBT_DUPLICATE:
+        //
+        // The duplicate blocks are recorded with their own offset, the lookup
+        // follows them to the string they refer to.
+        //
+        if ((CurrentStringId != 0) && (CurrentStringId <= StringPackage->MaxStringId)) {
+          StringIndex[CurrentStringId].BlockOffset = (UINT32)(BlockHdr - StringPackage->StringBlock);
+          StringIndex[CurrentStringId].TextOffset  = 0;
+        }
+
+        CurrentStringId++;
+        StringCount   = 0;
+        StringTextPtr = BlockHdr + sizeof (EFI_HII_SIBT_DUPLICATE_BLOCK);
+        break;
+
+      case EFI_HII_SIBT_SKIP1:
+        CurrentStringId = (UINT16)(CurrentStringId + *(BlockHdr + sizeof (EFI_HII_STRING_BLOCK)));
+        StringCount     = 0;
+        StringTextPtr   = BlockHdr + sizeof (EFI_HII_SIBT_SKIP1_BLOCK);
+        break;
+
+      case EFI_HII_SIBT_SKIP2:
+        CopyMem (&SkipCount, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (UINT16));
+        CurrentStringId = (UINT16)(CurrentStringId + SkipCount);
+        StringCount     = 0;
+        StringTextPtr   = BlockHdr + sizeof (EFI_HII_SIBT_SKIP2_BLOCK);
+        break;
+
+      case EFI_HII_SIBT_EXT1:
+        CopyMem (&Length8, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT8));
+        StringCount   = 0;
+        StringTextPtr = BlockHdr + Length8;
+        break;
+
+      case EFI_HII_SIBT_EXT2:
+        CopyMem (&Ext2, BlockHdr, sizeof (EFI_HII_SIBT_EXT2_BLOCK));
+        StringCount   = 0;
+        StringTextPtr = BlockHdr + Ext2.Length;
+        break;
+
+      case EFI_HII_SIBT_EXT4:
+        CopyMem (&Length32, BlockHdr + sizeof (EFI_HII_STRING_BLOCK) + sizeof (UINT8), sizeof (UINT32));
+        StringCount   = 0;
+        StringTextPtr = BlockHdr + Length32;
+        break;
+
+      default:
+        FreePool (StringIndex);
+        return EFI_UNSUPPORTED;
+    }
+
+    for (Index = 0; Index < StringCount; Index++) {
+      if ((CurrentStringId != 0) && (CurrentStringId <= StringPackage->MaxStringId)) {
+        StringIndex[CurrentStringId].BlockOffset = (UINT32)(BlockHdr - StringPackage->StringBlock);
+        StringIndex[CurrentStringId].TextOffset  = (UINT32)(StringTextPtr - BlockHdr);
+      }
+
+      if (Ucs2) {
+        GetUnicodeStringTextOrSize (NULL, StringTextPtr, &StringSize);
+        StringTextPtr += StringSize;
+      } else {
+        StringTextPtr += AsciiStrSize ((CHAR8 *)StringTextPtr);
+      }
+
+      CurrentStringId++;
+    }
+
+    BlockHdr = StringTextPtr;
+  }
+
+  StringPackage->StringIndex = StringIndex;
+  return EFI_SUCCESS;
+}
+
+/**
+  Look up a string in the string index of a string package, building the index
+  if it does not exist yet.
+
+  This is a internal function.
+
+  @param  StringPackage           Hii string package instance.
+  @param  StringId                The string's id, which is unique within
+                                  PackageList.
+  @param  BlockType               Output the block type of found string block.
+  @param  StringBlockAddr         Output the block address of found string block.
+  @param  StringTextOffset        Offset, relative to the found block address, of
+                                  the  string text information.
+
+  @retval TRUE                    The string block is found.
+  @retval FALSE                   The string is not found in the index, or the
+                                  index cannot be built. The string blocks must
+                                  be parsed.
+
+**/
+BOOLEAN
+LookupStringIndex (
+  IN  HII_STRING_PACKAGE_INSTANCE  *StringPackage,
+  IN  EFI_STRING_ID                StringId,
+  OUT UINT8                        *BlockType,
+  OUT UINT8                        **StringBlockAddr,
+  OUT UINTN                        *StringTextOffset
+  )
+{
+  HII_STRING_INDEX_ENTRY  *Entry;
+  UINT8                   *BlockHdr;
+  UINTN                   Count;
+
+  if ((StringPackage->StringIndex == NULL) && EFI_ERROR (BuildStringIndex (StringPackage))) {
+    return FALSE;
+  }
+
+  //
+  // Follow the duplicate blocks, at most once per string ID to stop on loops.
+  //
+  for (Count = 0; Count <= StringPackage->MaxStringId; Count++) {
+    if ((StringId == 0) || (StringId > StringPackage->MaxStringId)) {
+      return FALSE;
+    }
+
+    Entry = &StringPackage->StringIndex[StringId];
+    if (Entry->BlockOffset == HII_STRING_INDEX_NONE) {
+      return FALSE;
+    }
+
+    BlockHdr = StringPackage->StringBlock + Entry->BlockOffset;
+    if (*BlockHdr != EFI_HII_SIBT_DUPLICATE) {
+      *BlockType        = *BlockHdr;
+      *StringBlockAddr  = BlockHdr;
+      *StringTextOffset = Entry->TextOffset;
+      return TRUE;
+    }
+
+    CopyMem (&StringId, BlockHdr + sizeof (EFI_HII_STRING_BLOCK), sizeof (EFI_STRING_ID));
+  }
+
+  return FALSE;
+}
+
 /**
   Parse all string blocks to find a String block specified by StringId.
   If StringId = (EFI_STRING_ID) (-1), find out all EFI_HII_SIBT_FONT blocks
@@ -295,6 +538,16 @@ FindStringBlock (
     if (StringId > StringPackage->MaxStringId) {
       return EFI_NOT_FOUND;
     }
+
+    //
+    // The strings are looked up in the string index of the package. The string
+    // IDs of skip blocks fall back to the parsing, which reports the skip block.
+    //
+    if ((StartStringId == NULL) &&
+        LookupStringIndex (StringPackage, StringId, BlockType, StringBlockAddr, StringTextOffset))
+    {
+      return EFI_SUCCESS;
+    }
   } else {
     ASSERT (Private != NULL && Private->Signature == HII_DATABASE_PRIVATE_DATA_SIGNATURE);
     if ((StringId == 0) && (LastStringId != NULL)) {
@@ -913,6 +1166,10 @@ SetStringWorker (
   ASSERT (Private != NULL && StringPackage != NULL && String != NULL);
   ASSERT (Private->Signature == HII_DATABASE_PRIVATE_DATA_SIGNATURE);
   //
+  // The string blocks are changed below.
+  //
+  FreeStringIndex (StringPackage);
+  //
   // Find the specified string block
   //
   Status = FindStringBlock (
@@ -1230,6 +1487,10 @@ HiiNewString (
   NextStringId            = 0;
   StringPackage           = NULL;
   MatchStringPackage      = NULL;
+  //
+  // The new string changes the existing string packages, or adds a new one.
+  //
+  InvalidatePackageListExport (PackageListNode);
   for (Link = PackageListNode->StringPkgHdr.ForwardLink;
        Link != &PackageListNode->StringPkgHdr;
        Link = Link->ForwardLink
@@ -1237,6 +1498,10 @@ HiiNewString (
   {
     StringPackage = CR (Link, HII_STRING_PACKAGE_INSTANCE, StringEntry, HII_STRING_PACKAGE_SIGNATURE);
     //
+    // The new string is appended to the string blocks of all the packages.
+    //
+    FreeStringIndex (StringPackage);
+    //
     // Create a string block and corresponding font block if exists, then append them
     // to the end of the string package.
     //
@@ -1788,6 +2053,7 @@ HiiSetString (
     {
       StringPackage = CR (Link, HII_STRING_PACKAGE_INSTANCE, StringEntry, HII_STRING_PACKAGE_SIGNATURE);
       if (HiiCompareLanguage (StringPackage->StringPkgHdr->Language, (CHAR8 *)Language)) {
+        InvalidatePackageListExport (PackageListNode);
         OldPackageLen = StringPackage->StringPkgHdr->Header.Length;
         Status        = SetStringWorker (
                           Private,
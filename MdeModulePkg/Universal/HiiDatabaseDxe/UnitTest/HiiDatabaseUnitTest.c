@@ -0,0 +1,253 @@
+/** @file
+  Host based unit tests of the HII database configuration table.
+
+  HiiGetDatabaseInfo() only exports the package lists changed since its last
+  call, and copies the other ones from their previous export. After each
+  change of a package list, the configuration table must still match a full
+  export of the database by ExportPackageLists().
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "../HiiDatabase.h"
+
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "HII Database Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+extern HII_DATABASE_PRIVATE_DATA    mPrivate;
+extern EFI_HII_PACKAGE_LIST_HEADER  *gRTDatabaseInfoBuffer;
+extern UINTN                        gDatabaseInfoSize;
+
+//
+// The HII database does not use the runtime services in these tests.
+//
+EFI_RUNTIME_SERVICES  MockRuntime;
+
+///
+/// A package list without any package.
+///
+typedef struct {
+  EFI_HII_PACKAGE_LIST_HEADER    Header;
+  EFI_HII_PACKAGE_HEADER         End;
+} TEST_PACKAGE_LIST;
+
+TEST_PACKAGE_LIST  mEmptyPackageList = {
+  {
+    { 0x5a1c0fb3, 0x2e4c, 0x4a9e, { 0x8d, 0x61, 0x0b, 0x37, 0xc2, 0x95, 0x4f, 0x18 }
+    },
+    sizeof (TEST_PACKAGE_LIST)
+  },
+  { sizeof (EFI_HII_PACKAGE_HEADER), EFI_HII_PACKAGE_END }
+};
+
+EFI_HII_HANDLE  mHiiHandle;
+
+/**
+  Export the HII database to the configuration table, and check that the table
+  matches a full export of the database.
+
+  @retval UNIT_TEST_PASSED             The configuration table is up to date.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The configuration table differs.
+
+**/
+UNIT_TEST_STATUS
+CheckDatabaseInfo (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       BufferSize;
+  VOID        *Buffer;
+
+  Status = HiiGetDatabaseInfo (&mPrivate.HiiDatabase);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  BufferSize = 0;
+  Status     = HiiExportPackageLists (&mPrivate.HiiDatabase, NULL, &BufferSize, NULL);
+  UT_ASSERT_STATUS_EQUAL (Status, EFI_BUFFER_TOO_SMALL);
+  Buffer = AllocatePool (BufferSize);
+  UT_ASSERT_NOT_NULL (Buffer);
+  Status = HiiExportPackageLists (&mPrivate.HiiDatabase, NULL, &BufferSize, Buffer);
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+
+  UT_ASSERT_TRUE (BufferSize <= gDatabaseInfoSize);
+  UT_ASSERT_MEM_EQUAL (gRTDatabaseInfoBuffer, Buffer, BufferSize);
+  FreePool (Buffer);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Add a package list without any package to an empty HII database, and export
+  it to the configuration table.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED                      The package list is added.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  The package list is not added.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STATUS  Status;
+
+  InitializeListHead (&mPrivate.DatabaseList);
+  InitializeListHead (&mPrivate.DatabaseNotifyList);
+  InitializeListHead (&mPrivate.HiiHandleList);
+  InitializeListHead (&mPrivate.FontInfoList);
+
+  Status = HiiNewPackageList (
+             &mPrivate.HiiDatabase,
+             (EFI_HII_PACKAGE_LIST_HEADER *)&mEmptyPackageList,
+             NULL,
+             &mHiiHandle
+             );
+  if (EFI_ERROR (Status)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  if (CheckDatabaseInfo () != UNIT_TEST_PASSED) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Remove the package list added by TestSetup().
+
+  @param  Context  Unused.
+
+**/
+VOID
+EFIAPI
+TestCleanup (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  HiiRemovePackageList (&mPrivate.HiiDatabase, mHiiHandle);
+}
+
+/**
+  Check that the first string of a package list, which adds a string package
+  to it, is exported to the configuration table.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The string package is exported.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestNewStringPackage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  EFI_STRING_ID  StringId;
+
+  UT_ASSERT_NOT_EFI_ERROR (HiiNewString (&mPrivate.HiiString, mHiiHandle, &StringId, "en-US", L"English", L"First", NULL));
+  return CheckDatabaseInfo ();
+}
+
+/**
+  Check that the strings added to or changed in the existing string packages
+  of a package list are exported to the configuration table.
+
+  @param  Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The strings are exported.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestNewString (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UNIT_TEST_STATUS  Status;
+  EFI_STRING_ID     StringId;
+
+  UT_ASSERT_NOT_EFI_ERROR (HiiNewString (&mPrivate.HiiString, mHiiHandle, &StringId, "en-US", L"English", L"First", NULL));
+  UT_ASSERT_NOT_EFI_ERROR (HiiNewString (&mPrivate.HiiString, mHiiHandle, &StringId, "fr-FR", L"Francais", L"Premier", NULL));
+  Status = CheckDatabaseInfo ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (HiiNewString (&mPrivate.HiiString, mHiiHandle, &StringId, "en-US", NULL, L"Second", NULL));
+  Status = CheckDatabaseInfo ();
+  if (Status != UNIT_TEST_PASSED) {
+    return Status;
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (HiiSetString (&mPrivate.HiiString, mHiiHandle, StringId, "fr-FR", L"Deuxieme", NULL));
+  return CheckDatabaseInfo ();
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the HII
+  database, and run them.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      ExportTestSuite;
+
+  Framework = NULL;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&ExportTestSuite, Framework, "HII database export test suite", "HiiDatabaseDxe.Export", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in CreateUnitTestSuite for HII database export test suite\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto EXIT;
+  }
+
+  AddTestCase (ExportTestSuite, "New string package", "NewStringPackage", TestNewStringPackage, TestSetup, TestCleanup, NULL);
+  AddTestCase (ExportTestSuite, "New and changed strings", "NewString", TestNewString, TestSetup, TestCleanup, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
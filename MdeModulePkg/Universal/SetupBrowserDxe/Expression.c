@@ -827,58 +827,273 @@ IdToQuestion2 (
 }
 
 /**
-  Search a Question in Formset scope using its QuestionId.
+  Check whether an entry of the Question index sorts before another one, by
+  QuestionId then by order.
+
+  @param  Entry1                 The first entry.
+  @param  Entry2                 The second entry.
+
+  @retval TRUE                   Entry1 sorts before Entry2.
+  @retval FALSE                  Entry1 sorts after Entry2.
+
+**/
+BOOLEAN
+IsQuestionIndexEntryBefore (
+  IN QUESTION_INDEX_ENTRY  *Entry1,
+  IN QUESTION_INDEX_ENTRY  *Entry2
+  )
+{
+  if (Entry1->QuestionId != Entry2->QuestionId) {
+    return (BOOLEAN)(Entry1->QuestionId < Entry2->QuestionId);
+  }
+
+  return (BOOLEAN)(Entry1->Order < Entry2->Order);
+}
+
+/**
+  Sort the entries of the Question index with a heap sort, which does not
+  degrade on the mostly sorted QuestionIds of the formsets.
+
+  @param  Index                  The entries.
+  @param  Count                  The number of entries.
+
+**/
+VOID
+SortQuestionIndex (
+  IN OUT QUESTION_INDEX_ENTRY  *Index,
+  IN     UINTN                 Count
+  )
+{
+  QUESTION_INDEX_ENTRY  Swap;
+  UINTN                 Start;
+  UINTN                 End;
+  UINTN                 Root;
+  UINTN                 Child;
+
+  for (Start = Count / 2, End = Count; End > 1; ) {
+    if (Start > 0) {
+      //
+      // Build the heap.
+      //
+      Start--;
+    } else {
+      //
+      // Move the largest entry to the end and restore the heap.
+      //
+      End--;
+      CopyMem (&Swap, &Index[End], sizeof (QUESTION_INDEX_ENTRY));
+      CopyMem (&Index[End], &Index[0], sizeof (QUESTION_INDEX_ENTRY));
+      CopyMem (&Index[0], &Swap, sizeof (QUESTION_INDEX_ENTRY));
+    }
+
+    for (Root = Start; Root * 2 + 1 < End; Root = Child) {
+      Child = Root * 2 + 1;
+      if ((Child + 1 < End) && IsQuestionIndexEntryBefore (&Index[Child], &Index[Child + 1])) {
+        Child++;
+      }
+
+      if (!IsQuestionIndexEntryBefore (&Index[Root], &Index[Child])) {
+        break;
+      }
+
+      CopyMem (&Swap, &Index[Root], sizeof (QUESTION_INDEX_ENTRY));
+      CopyMem (&Index[Root], &Index[Child], sizeof (QUESTION_INDEX_ENTRY));
+      CopyMem (&Index[Child], &Swap, sizeof (QUESTION_INDEX_ENTRY));
+    }
+  }
+}
+
+/**
+  Build the index of the Questions of a parsed FormSet by QuestionId, used by
+  IdToQuestion() instead of searching all the Forms.
+
+  The FormSet is searched without index if the index cannot be allocated.
+
+  @param  FormSet                The formset.
+
+**/
+VOID
+BuildQuestionIndex (
+  IN OUT FORM_BROWSER_FORMSET  *FormSet
+  )
+{
+  LIST_ENTRY              *Link;
+  LIST_ENTRY              *QuestionLink;
+  FORM_BROWSER_FORM       *Form;
+  FORM_BROWSER_STATEMENT  *Question;
+  QUESTION_INDEX_ENTRY    *Index;
+  UINTN                   Count;
+
+  ASSERT (FormSet->QuestionIndex == NULL);
+
+  //
+  // Count the Questions, then fill the index in the order of the FormSet.
+  //
+  Index = NULL;
+  do {
+    Count = 0;
+    Link  = GetFirstNode (&FormSet->FormListHead);
+    while (!IsNull (&FormSet->FormListHead, Link)) {
+      Form = FORM_BROWSER_FORM_FROM_LINK (Link);
+      Link = GetNextNode (&FormSet->FormListHead, Link);
+
+      QuestionLink = GetFirstNode (&Form->StatementListHead);
+      while (!IsNull (&Form->StatementListHead, QuestionLink)) {
+        Question     = FORM_BROWSER_STATEMENT_FROM_LINK (QuestionLink);
+        QuestionLink = GetNextNode (&Form->StatementListHead, QuestionLink);
+        if (Question->QuestionId == 0) {
+          continue;
+        }
+
+        if (Index != NULL) {
+          Index[Count].QuestionId = Question->QuestionId;
+          Index[Count].Order      = Count;
+          Index[Count].Question   = Question;
+          Index[Count].Form       = Form;
+        }
+
+        Count++;
+      }
+    }
+
+    if ((Index != NULL) || (Count == 0)) {
+      break;
+    }
+
+    Index = AllocatePool (Count * sizeof (QUESTION_INDEX_ENTRY));
+  } while (Index != NULL);
+
+  if (Index == NULL) {
+    return;
+  }
+
+  SortQuestionIndex (Index, Count);
+  FormSet->QuestionIndex      = Index;
+  FormSet->QuestionIndexCount = Count;
+}
+
+/**
+  Search a Question in Formset scope using its QuestionId, in the form
+  scope first.
 
   @param  FormSet                The formset which contains this form.
   @param  Form                   The form which contains this Question.
   @param  QuestionId             Id of this Question.
+  @param  QuestionForm           The form where the Question is found.
 
   @retval Pointer                The Question.
-  @retval NULL                   Specified Question not found in the form.
+  @retval NULL                   Specified Question not found in the formset.
 
 **/
 FORM_BROWSER_STATEMENT *
-IdToQuestion (
-  IN FORM_BROWSER_FORMSET  *FormSet,
-  IN FORM_BROWSER_FORM     *Form,
-  IN UINT16                QuestionId
+LookupQuestion (
+  IN  FORM_BROWSER_FORMSET  *FormSet,
+  IN  FORM_BROWSER_FORM     *Form,
+  IN  UINT16                QuestionId,
+  OUT FORM_BROWSER_FORM     **QuestionForm
   )
 {
   LIST_ENTRY              *Link;
   FORM_BROWSER_STATEMENT  *Question;
+  QUESTION_INDEX_ENTRY    *Index;
+  UINTN                   Low;
+  UINTN                   High;
+  UINTN                   Middle;
+
+  if (FormSet->QuestionIndex == NULL) {
+    //
+    // Search in the form scope first
+    //
+    Question = IdToQuestion2 (Form, QuestionId);
+    if (Question != NULL) {
+      *QuestionForm = Form;
+      return Question;
+    }
+
+    //
+    // Search in the formset scope
+    //
+    Link = GetFirstNode (&FormSet->FormListHead);
+    while (!IsNull (&FormSet->FormListHead, Link)) {
+      *QuestionForm = FORM_BROWSER_FORM_FROM_LINK (Link);
+
+      Question = IdToQuestion2 (*QuestionForm, QuestionId);
+      if (Question != NULL) {
+        return Question;
+      }
+
+      Link = GetNextNode (&FormSet->FormListHead, Link);
+    }
+
+    return NULL;
+  }
 
   //
-  // Search in the form scope first
+  // Find the first entry of the QuestionId in the index.
   //
-  Question = IdToQuestion2 (Form, QuestionId);
-  if (Question != NULL) {
-    return Question;
+  Index = FormSet->QuestionIndex;
+  Low   = 0;
+  High  = FormSet->QuestionIndexCount;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (Index[Middle].QuestionId < QuestionId) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  if ((QuestionId == 0) || (Low == FormSet->QuestionIndexCount) || (Index[Low].QuestionId != QuestionId)) {
+    return NULL;
   }
 
   //
-  // Search in the formset scope
+  // The Question in the form scope first, the first one of the formset otherwise.
   //
-  Link = GetFirstNode (&FormSet->FormListHead);
-  while (!IsNull (&FormSet->FormListHead, Link)) {
-    Form = FORM_BROWSER_FORM_FROM_LINK (Link);
+  for (Middle = Low; Middle < FormSet->QuestionIndexCount && Index[Middle].QuestionId == QuestionId; Middle++) {
+    if (Index[Middle].Form == Form) {
+      *QuestionForm = Form;
+      return Index[Middle].Question;
+    }
+  }
 
-    Question = IdToQuestion2 (Form, QuestionId);
-    if (Question != NULL) {
-      //
-      // EFI variable storage may be updated by Callback() asynchronous,
-      // to keep synchronous, always reload the Question Value.
-      //
-      if (Question->Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE) {
-        GetQuestionValue (FormSet, Form, Question, GetSetValueWithHiiDriver);
-      }
+  *QuestionForm = Index[Low].Form;
+  return Index[Low].Question;
+}
 
-      return Question;
-    }
+/**
+  Search a Question in Formset scope using its QuestionId.
 
-    Link = GetNextNode (&FormSet->FormListHead, Link);
+  @param  FormSet                The formset which contains this form.
+  @param  Form                   The form which contains this Question.
+  @param  QuestionId             Id of this Question.
+
+  @retval Pointer                The Question.
+  @retval NULL                   Specified Question not found in the form.
+
+**/
+FORM_BROWSER_STATEMENT *
+IdToQuestion (
+  IN FORM_BROWSER_FORMSET  *FormSet,
+  IN FORM_BROWSER_FORM     *Form,
+  IN UINT16                QuestionId
+  )
+{
+  FORM_BROWSER_STATEMENT  *Question;
+  FORM_BROWSER_FORM       *QuestionForm;
+
+  Question = LookupQuestion (FormSet, Form, QuestionId, &QuestionForm);
+  if ((Question != NULL) && (QuestionForm != Form)) {
+    //
+    // EFI variable storage may be updated by Callback() asynchronous,
+    // to keep synchronous, always reload the Question Value.
+    //
+    if (Question->Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE) {
+      GetQuestionValue (FormSet, QuestionForm, Question, GetSetValueWithHiiDriver);
+    }
   }
 
-  return NULL;
+  return Question;
 }
 
 /**
@@ -2514,6 +2729,238 @@ Done:
   return GetTheVal;
 }
 
+/**
+  Check whether the result of an expression can be cached, and allocate the
+  dependencies of the result.
+
+  The result can be cached if the expression only consists of constants,
+  operators and references to the values of Questions.
+
+  @param  Expression             The expression.
+
+**/
+VOID
+InitializeExpressionCache (
+  IN OUT FORM_EXPRESSION  *Expression
+  )
+{
+  LIST_ENTRY         *Link;
+  EXPRESSION_OPCODE  *OpCode;
+  UINTN              Count;
+
+  Count = 0;
+  Link  = GetFirstNode (&Expression->OpCodeListHead);
+  while (!IsNull (&Expression->OpCodeListHead, Link)) {
+    OpCode = EXPRESSION_OPCODE_FROM_LINK (Link);
+    Link   = GetNextNode (&Expression->OpCodeListHead, Link);
+
+    switch (OpCode->Operand) {
+      case EFI_IFR_EQ_ID_ID_OP:
+        Count++;
+      //
+      // Fall through
+      //
+      case EFI_IFR_EQ_ID_VAL_OP:
+      case EFI_IFR_EQ_ID_VAL_LIST_OP:
+      case EFI_IFR_QUESTION_REF1_OP:
+      case EFI_IFR_THIS_OP:
+        Count++;
+        break;
+
+      case EFI_IFR_DUP_OP:
+      case EFI_IFR_TRUE_OP:
+      case EFI_IFR_FALSE_OP:
+      case EFI_IFR_ONE_OP:
+      case EFI_IFR_ONES_OP:
+      case EFI_IFR_UINT8_OP:
+      case EFI_IFR_UINT16_OP:
+      case EFI_IFR_UINT32_OP:
+      case EFI_IFR_UINT64_OP:
+      case EFI_IFR_UNDEFINED_OP:
+      case EFI_IFR_VERSION_OP:
+      case EFI_IFR_ZERO_OP:
+      case EFI_IFR_NOT_OP:
+      case EFI_IFR_TO_BOOLEAN_OP:
+      case EFI_IFR_BITWISE_NOT_OP:
+      case EFI_IFR_ADD_OP:
+      case EFI_IFR_SUBTRACT_OP:
+      case EFI_IFR_MULTIPLY_OP:
+      case EFI_IFR_DIVIDE_OP:
+      case EFI_IFR_MODULO_OP:
+      case EFI_IFR_BITWISE_AND_OP:
+      case EFI_IFR_BITWISE_OR_OP:
+      case EFI_IFR_SHIFT_LEFT_OP:
+      case EFI_IFR_SHIFT_RIGHT_OP:
+      case EFI_IFR_AND_OP:
+      case EFI_IFR_OR_OP:
+      case EFI_IFR_EQUAL_OP:
+      case EFI_IFR_NOT_EQUAL_OP:
+      case EFI_IFR_GREATER_EQUAL_OP:
+      case EFI_IFR_GREATER_THAN_OP:
+      case EFI_IFR_LESS_EQUAL_OP:
+      case EFI_IFR_LESS_THAN_OP:
+      case EFI_IFR_CONDITIONAL_OP:
+        break;
+
+      default:
+        //
+        // The result depends on storage, strings, rules or user privileges.
+        //
+        Expression->CacheState = EXPRESSION_CACHE_DISABLED;
+        return;
+    }
+  }
+
+  if (Count != 0) {
+    Expression->Dependency = AllocatePool (Count * sizeof (EXPRESSION_DEPENDENCY));
+    if (Expression->Dependency == NULL) {
+      Expression->CacheState = EXPRESSION_CACHE_DISABLED;
+      return;
+    }
+  }
+
+  Expression->DependencyCount = Count;
+  Expression->CacheState      = EXPRESSION_CACHE_EMPTY;
+}
+
+/**
+  Check whether the cached result of an expression is still valid, that is the
+  values of the Questions it depends on have not changed since it was evaluated.
+
+  @param  Form                   Form associated with this expression.
+  @param  Expression             The expression.
+
+  @retval TRUE                   The cached result is valid.
+  @retval FALSE                  The expression must be evaluated.
+
+**/
+BOOLEAN
+IsExpressionResultCached (
+  IN FORM_BROWSER_FORM  *Form,
+  IN FORM_EXPRESSION    *Expression
+  )
+{
+  UINTN                  Index;
+  EXPRESSION_DEPENDENCY  *Dependency;
+
+  if ((Expression->CacheState != EXPRESSION_CACHE_VALID) || (Expression->CacheForm != Form)) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Expression->DependencyCount; Index++) {
+    Dependency = &Expression->Dependency[Index];
+    if ((Dependency->Question->HiiValue.Type != Dependency->Type) ||
+        (CompareMem (&Dependency->Question->HiiValue.Value, &Dependency->Value, sizeof (EFI_IFR_TYPE_VALUE)) != 0))
+    {
+      Expression->CacheState = EXPRESSION_CACHE_EMPTY;
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Cache the result of an expression evaluated successfully, along with the
+  values of the Questions it depends on.
+
+  @param  FormSet                FormSet associated with this expression.
+  @param  Form                   Form associated with this expression.
+  @param  Expression             The expression.
+
+**/
+VOID
+CacheExpressionResult (
+  IN     FORM_BROWSER_FORMSET  *FormSet,
+  IN     FORM_BROWSER_FORM     *Form,
+  IN OUT FORM_EXPRESSION       *Expression
+  )
+{
+  LIST_ENTRY              *Link;
+  EXPRESSION_OPCODE       *OpCode;
+  FORM_BROWSER_STATEMENT  *Question;
+  FORM_BROWSER_FORM       *QuestionForm;
+  UINT16                  QuestionId[2];
+  UINTN                   IdCount;
+  UINTN                   IdIndex;
+  UINTN                   Count;
+
+  //
+  // The Questions may still be added to a FormSet being parsed.
+  //
+  if (FormSet->QuestionIndex == NULL) {
+    return;
+  }
+
+  if (Expression->CacheState == EXPRESSION_CACHE_UNKNOWN) {
+    InitializeExpressionCache (Expression);
+  }
+
+  if (Expression->CacheState == EXPRESSION_CACHE_DISABLED) {
+    return;
+  }
+
+  Expression->CacheState = EXPRESSION_CACHE_EMPTY;
+  if ((Expression->Result.Type > EFI_IFR_TYPE_BOOLEAN) && (Expression->Result.Type != EFI_IFR_TYPE_UNDEFINED)) {
+    return;
+  }
+
+  Count = 0;
+  Link  = GetFirstNode (&Expression->OpCodeListHead);
+  while (!IsNull (&Expression->OpCodeListHead, Link)) {
+    OpCode = EXPRESSION_OPCODE_FROM_LINK (Link);
+    Link   = GetNextNode (&Expression->OpCodeListHead, Link);
+
+    switch (OpCode->Operand) {
+      case EFI_IFR_EQ_ID_ID_OP:
+        QuestionId[0] = OpCode->QuestionId;
+        QuestionId[1] = OpCode->QuestionId2;
+        IdCount       = 2;
+        break;
+
+      case EFI_IFR_EQ_ID_VAL_OP:
+      case EFI_IFR_EQ_ID_VAL_LIST_OP:
+      case EFI_IFR_QUESTION_REF1_OP:
+      case EFI_IFR_THIS_OP:
+        QuestionId[0] = OpCode->QuestionId;
+        IdCount       = 1;
+        break;
+
+      default:
+        IdCount = 0;
+        break;
+    }
+
+    for (IdIndex = 0; IdIndex < IdCount; IdIndex++) {
+      Question = LookupQuestion (FormSet, Form, QuestionId[IdIndex], &QuestionForm);
+      if (Question == NULL) {
+        return;
+      }
+
+      //
+      // The values of EFI variable storage are reloaded by IdToQuestion().
+      //
+      if ((Question->Storage != NULL) && (Question->Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE)) {
+        Expression->CacheState = EXPRESSION_CACHE_DISABLED;
+        return;
+      }
+
+      if (Question->HiiValue.Type > EFI_IFR_TYPE_DATE) {
+        return;
+      }
+
+      ASSERT (Count < Expression->DependencyCount);
+      Expression->Dependency[Count].Question = Question;
+      Expression->Dependency[Count].Type     = Question->HiiValue.Type;
+      CopyMem (&Expression->Dependency[Count].Value, &Question->HiiValue.Value, sizeof (EFI_IFR_TYPE_VALUE));
+      Count++;
+    }
+  }
+
+  Expression->CacheForm  = Form;
+  Expression->CacheState = EXPRESSION_CACHE_VALID;
+}
+
 /**
   Evaluate the result of a HII expression.
 
@@ -2573,6 +3020,16 @@ EvaluateExpression (
   StackOffset = SaveExpressionEvaluationStackOffset ();
 
   ASSERT (Expression != NULL);
+
+  //
+  // The cached result is still valid if the values of the Questions it
+  // depends on have not changed.
+  //
+  if (IsExpressionResultCached (Form, Expression)) {
+    RestoreExpressionEvaluationStackOffset (StackOffset);
+    return EFI_SUCCESS;
+  }
+
   Expression->Result.Type = EFI_IFR_TYPE_OTHER;
 
   Link = GetFirstNode (&Expression->OpCodeListHead);
@@ -3671,6 +4128,7 @@ Done:
   RestoreExpressionEvaluationStackOffset (StackOffset);
   if (!EFI_ERROR (Status)) {
     CopyMem (&Expression->Result, Value, sizeof (EFI_HII_VALUE));
+    CacheExpressionResult (FormSet, Form, Expression);
   }
 
   return Status;
@@ -257,4 +257,18 @@ IdToForm (
   IN UINT16                FormId
   );
 
+/**
+  Build the index of the Questions of a parsed FormSet by QuestionId, used by
+  IdToQuestion() instead of searching all the Forms.
+
+  The FormSet is searched without index if the index cannot be allocated.
+
+  @param  FormSet                The formset.
+
+**/
+VOID
+BuildQuestionIndex (
+  IN OUT FORM_BROWSER_FORMSET  *FormSet
+  );
+
 #endif // _EXPRESSION_H
@@ -739,6 +739,10 @@ DestroyExpression (
     }
   }
 
+  if (Expression->Dependency != NULL) {
+    FreePool (Expression->Dependency);
+  }
+
   //
   // Free this Expression
   //
@@ -1021,6 +1025,10 @@ DestroyFormSet (
     FreePool (FormSet->ExpressionBuffer);
   }
 
+  if (FormSet->QuestionIndex != NULL) {
+    FreePool (FormSet->QuestionIndex);
+  }
+
   FreePool (FormSet);
 }
 
@@ -2447,6 +2447,58 @@ NoSubmitCheck (
   return EFI_SUCCESS;
 }
 
+/**
+  Copy the blocks of the "&OFFSET=####&WIDTH=####" elements of a ConfigRequest
+  from one buffer to another.
+
+  @param  ConfigRequest          The config request string.
+  @param  Src                    The buffer to copy the blocks from.
+  @param  Dst                    The buffer to copy the blocks to, or NULL to only
+                                 check the blocks.
+  @param  BufferSize             The size of Src and Dst.
+
+  @retval EFI_SUCCESS            The blocks are checked, and copied if Dst is not NULL.
+  @retval EFI_INVALID_PARAMETER  An OFFSET element has no WIDTH element.
+  @retval EFI_DEVICE_ERROR       A block is out of the buffers.
+
+**/
+EFI_STATUS
+CopyConfigRequestBlocks (
+  IN  CHAR16  *ConfigRequest,
+  IN  UINT8   *Src,
+  OUT UINT8   *Dst OPTIONAL,
+  IN  UINTN   BufferSize
+  )
+{
+  CHAR16  *StrPtr;
+  UINTN   Offset;
+  UINTN   Width;
+
+  StrPtr = StrStr (ConfigRequest, L"&OFFSET=");
+  while (StrPtr != NULL) {
+    StrPtr += StrLen (L"&OFFSET=");
+    Offset  = StrHexToUintn (StrPtr);
+    StrPtr  = StrStr (StrPtr, L"&WIDTH=");
+    if (StrPtr == NULL) {
+      return EFI_INVALID_PARAMETER;
+    }
+
+    StrPtr += StrLen (L"&WIDTH=");
+    Width   = StrHexToUintn (StrPtr);
+    if ((Offset > BufferSize) || (Width > BufferSize - Offset)) {
+      return EFI_DEVICE_ERROR;
+    }
+
+    if (Dst != NULL) {
+      CopyMem (Dst + Offset, Src + Offset, Width);
+    }
+
+    StrPtr = StrStr (StrPtr, L"&OFFSET=");
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Fill storage's edit copy with settings requested from Configuration Driver.
 
@@ -2468,8 +2520,6 @@ SynchronizeStorage (
   )
 {
   EFI_STATUS       Status;
-  EFI_STRING       Progress;
-  EFI_STRING       Result;
   UINTN            BufferSize;
   LIST_ENTRY       *Link;
   NAME_VALUE_NODE  *Node;
@@ -2477,7 +2527,6 @@ SynchronizeStorage (
   UINT8            *Dst;
 
   Status = EFI_SUCCESS;
-  Result = NULL;
 
   if ((Storage->Type == EFI_HII_VARSTORE_BUFFER) ||
       (Storage->Type == EFI_HII_VARSTORE_EFI_VARIABLE_BUFFER))
@@ -2493,28 +2542,18 @@ SynchronizeStorage (
     }
 
     if (ConfigRequest != NULL) {
-      Status = mHiiConfigRouting->BlockToConfig (
-                                    mHiiConfigRouting,
-                                    ConfigRequest,
-                                    Src,
-                                    BufferSize,
-                                    &Result,
-                                    &Progress
-                                    );
+      //
+      // Copy the blocks of the "&OFFSET=####&WIDTH=####" elements of the
+      // ConfigRequest directly, instead of converting them to a <ConfigResp>
+      // with BlockToConfig () and back with ConfigToBlock (). All the blocks
+      // are checked first, so that an invalid element leaves Dst unchanged.
+      //
+      Status = CopyConfigRequestBlocks (ConfigRequest, Src, NULL, BufferSize);
       if (EFI_ERROR (Status)) {
         return Status;
       }
 
-      Status = mHiiConfigRouting->ConfigToBlock (
-                                    mHiiConfigRouting,
-                                    Result,
-                                    Dst,
-                                    &BufferSize,
-                                    &Progress
-                                    );
-      if (Result != NULL) {
-        FreePool (Result);
-      }
+      CopyConfigRequestBlocks (ConfigRequest, Src, Dst, BufferSize);
     } else {
       CopyMem (Dst, Src, BufferSize);
     }
@@ -6053,6 +6092,9 @@ InitializeFormSet (
   // Parse the IFR binary OpCodes
   //
   Status = ParseOpCodes (FormSet);
+  if (!EFI_ERROR (Status)) {
+    BuildQuestionIndex (FormSet);
+  }
 
   return Status;
 }
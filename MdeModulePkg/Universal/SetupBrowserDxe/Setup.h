@@ -213,23 +213,49 @@ typedef struct {
 
 #define EXPRESSION_OPCODE_FROM_LINK(a)  CR (a, EXPRESSION_OPCODE, Link, EXPRESSION_OPCODE_SIGNATURE)
 
+//
+// A Question value the cached result of an expression depends on.
+//
+typedef struct {
+  struct _FORM_BROWSER_STATEMENT    *Question;
+  UINT8                             Type;  // Type of the Question value when the result was evaluated
+  EFI_IFR_TYPE_VALUE                Value; // Question value when the result was evaluated
+} EXPRESSION_DEPENDENCY;
+
+//
+// State of the result cache of an expression.
+//
+#define EXPRESSION_CACHE_UNKNOWN   0        // The expression has not been checked yet
+#define EXPRESSION_CACHE_DISABLED  1        // The result of the expression is never cached
+#define EXPRESSION_CACHE_EMPTY     2        // No result is cached
+#define EXPRESSION_CACHE_VALID     3        // The result is cached
+
 #define FORM_EXPRESSION_SIGNATURE  SIGNATURE_32 ('F', 'E', 'X', 'P')
 
 typedef struct {
-  UINTN                Signature;
-  LIST_ENTRY           Link;
+  UINTN                    Signature;
+  LIST_ENTRY               Link;
 
-  UINT8                Type;         // Type for this expression
+  UINT8                    Type;     // Type for this expression
 
-  UINT8                RuleId;       // For EFI_IFR_RULE only
-  EFI_STRING_ID        Error;        // For EFI_IFR_NO_SUBMIT_IF, EFI_IFR_INCONSISTENT_IF only
+  UINT8                    RuleId;   // For EFI_IFR_RULE only
+  EFI_STRING_ID            Error;    // For EFI_IFR_NO_SUBMIT_IF, EFI_IFR_INCONSISTENT_IF only
 
-  EFI_HII_VALUE        Result;       // Expression evaluation result
+  EFI_HII_VALUE            Result;   // Expression evaluation result
 
-  UINT8                TimeOut;      // For EFI_IFR_WARNING_IF
-  EFI_IFR_OP_HEADER    *OpCode;      // Save the opcode buffer.
+  UINT8                    TimeOut;  // For EFI_IFR_WARNING_IF
+  EFI_IFR_OP_HEADER        *OpCode;  // Save the opcode buffer.
 
-  LIST_ENTRY           OpCodeListHead; // OpCodes consist of this expression (EXPRESSION_OPCODE)
+  LIST_ENTRY               OpCodeListHead; // OpCodes consist of this expression (EXPRESSION_OPCODE)
+
+  //
+  // The result of an expression which only depends on the values of Questions
+  // is kept until one of these values changes.
+  //
+  UINT8                    CacheState;      // EXPRESSION_CACHE_*
+  VOID                     *CacheForm;      // The Form the cached result was evaluated in
+  UINTN                    DependencyCount; // Number of Question references of the expression
+  EXPRESSION_DEPENDENCY    *Dependency;     // Array[DependencyCount] of Question values
 } FORM_EXPRESSION;
 
 #define FORM_EXPRESSION_FROM_LINK(a)  CR (a, FORM_EXPRESSION, Link, FORM_EXPRESSION_SIGNATURE)
@@ -416,6 +442,17 @@ typedef struct {
 
 #define FORM_BROWSER_FORM_FROM_LINK(a)  CR (a, FORM_BROWSER_FORM, Link, FORM_BROWSER_FORM_SIGNATURE)
 
+//
+// Entry of the index of the Questions of a FormSet, sorted by QuestionId and
+// then by the order of the Questions in the FormSet.
+//
+typedef struct {
+  EFI_QUESTION_ID           QuestionId;
+  UINTN                     Order;
+  FORM_BROWSER_STATEMENT    *Question;
+  FORM_BROWSER_FORM         *Form;
+} QUESTION_INDEX_ENTRY;
+
 #define FORMSET_DEFAULTSTORE_SIGNATURE  SIGNATURE_32 ('F', 'D', 'F', 'S')
 
 typedef struct {
@@ -465,6 +502,9 @@ typedef struct {
   LIST_ENTRY                        DefaultStoreListHead;    // DefaultStore list (FORMSET_DEFAULTSTORE)
   LIST_ENTRY                        FormListHead;            // Form list (FORM_BROWSER_FORM)
   LIST_ENTRY                        ExpressionListHead;      // List of Expressions (FORM_EXPRESSION)
+
+  UINTN                             QuestionIndexCount;      // Number of entries of QuestionIndex
+  QUESTION_INDEX_ENTRY              *QuestionIndex;          // Questions sorted by QuestionId, NULL if not built
 } FORM_BROWSER_FORMSET;
 #define FORM_BROWSER_FORMSET_FROM_LINK(a)  CR (a, FORM_BROWSER_FORMSET, Link, FORM_BROWSER_FORMSET_SIGNATURE)
 
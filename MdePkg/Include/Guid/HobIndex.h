@@ -0,0 +1,84 @@
+/** @file
+  GUID and layout of the HOB index configuration table.
+
+  The HOB list is not modified once the DXE Core has started, so the DXE Core
+  can build an index of it once, and publish it in the System Configuration
+  Table. HobLib instances use it to find the HOBs of a type, or the GUID HOBs
+  of a name, without walking the whole HOB list.
+
+  The index only lists HOB offsets. A HOB may still be marked unused after the
+  index was built, so users must check the type of the HOBs it returns.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef EDKII_HOB_INDEX_GUID_H_
+#define EDKII_HOB_INDEX_GUID_H_
+
+#define EDKII_HOB_INDEX_TABLE_GUID \
+  { \
+    0x5620aa13, 0x27e4, 0x4c92, { 0xad, 0x53, 0x00, 0x28, 0x7e, 0x5d, 0x2d, 0x71 } \
+  }
+
+#define EDKII_HOB_INDEX_SIGNATURE  SIGNATURE_32 ('H', 'O', 'B', 'I')
+
+///
+/// HOB types indexed, from 0 to EFI_HOB_TYPE_FV3.
+///
+#define EDKII_HOB_INDEX_TYPE_COUNT  (EFI_HOB_TYPE_FV3 + 1)
+
+///
+/// Hash of a GUID HOB name, used to select its bucket.
+///
+#define EDKII_HOB_INDEX_HASH_GUID(Guid) \
+  (((CONST UINT32 *)(Guid))[0] ^ ((CONST UINT32 *)(Guid))[1] ^ \
+   ((CONST UINT32 *)(Guid))[2] ^ ((CONST UINT32 *)(Guid))[3])
+
+///
+/// A range of the HobOffsets array.
+///
+typedef struct {
+  UINT32    First;
+  UINT32    Count;
+} EDKII_HOB_INDEX_RANGE;
+
+///
+/// The GUID HOBs of a name.
+///
+typedef struct {
+  EFI_GUID                 Name;
+  EDKII_HOB_INDEX_RANGE    Hobs;
+} EDKII_HOB_INDEX_GUID_ENTRY;
+
+///
+/// The HOB index table. It is followed by:
+///   UINT32                      Buckets[BucketCount];
+///   EDKII_HOB_INDEX_GUID_ENTRY  GuidEntries[GuidCount];
+///   UINT32                      HobOffsets[];
+/// whose offsets from the start of the table are given in the header.
+///
+/// Buckets is an open addressing hash table of the GuidEntries indexes,
+/// MAX_UINT32 marks an empty bucket. BucketCount is a power of 2.
+///
+/// HobOffsets holds the offsets of the HOBs from HobList, in the order of the
+/// HOB list, grouped by type and then by GUID HOB name.
+///
+typedef struct {
+  UINT32                   Signature;
+  UINT32                   Size;
+  EFI_PHYSICAL_ADDRESS     HobList;
+  UINT64                   HobListSize;
+  UINT32                   BucketCount;
+  UINT32                   BucketsOffset;
+  UINT32                   GuidCount;
+  UINT32                   GuidEntriesOffset;
+  UINT32                   HobOffsetsOffset;
+  UINT32                   Reserved;
+  EDKII_HOB_INDEX_RANGE    Types[EDKII_HOB_INDEX_TYPE_COUNT];
+} EDKII_HOB_INDEX;
+
+extern EFI_GUID  gEdkiiHobIndexTableGuid;
+
+#endif
@@ -0,0 +1,50 @@
+/** @file
+  This file declares the EDKII Free Pool PPI.
+
+  The PEI Services Table has an AllocatePool() service but no matching
+  FreePool() service. Once permanent memory is installed, the PEI Foundation
+  serves pool allocations from page arenas instead of the HOB list, and
+  publishes this PPI so that those allocations can be freed.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef EDKII_FREE_POOL_PPI_H_
+#define EDKII_FREE_POOL_PPI_H_
+
+#define EDKII_PEI_FREE_POOL_PPI_GUID \
+  { 0xba7dbe67, 0xb6f7, 0x42b6, { 0xa3, 0x2b, 0xac, 0x1f, 0x39, 0x6c, 0x02, 0x54 } }
+
+typedef struct _EDKII_PEI_FREE_POOL_PPI EDKII_PEI_FREE_POOL_PPI;
+
+/**
+  Frees a buffer allocated with the AllocatePool() PEI service.
+
+  @param[in] Buffer  The buffer to free.
+
+  @retval EFI_SUCCESS            The buffer was freed.
+  @retval EFI_UNSUPPORTED        The buffer was allocated before permanent
+                                 memory was installed and is part of the HOB
+                                 list, it cannot be freed.
+  @retval EFI_INVALID_PARAMETER  Buffer is NULL, was not allocated with the
+                                 AllocatePool() PEI service, or was already
+                                 freed.
+**/
+typedef
+EFI_STATUS
+(EFIAPI *EDKII_PEI_FREE_POOL)(
+  IN VOID  *Buffer
+  );
+
+///
+/// This PPI is installed by the PEI Foundation once permanent memory is
+/// installed.
+///
+struct _EDKII_PEI_FREE_POOL_PPI {
+  EDKII_PEI_FREE_POOL    FreePool;
+};
+
+extern EFI_GUID  gEdkiiPeiFreePoolPpiGuid;
+
+#endif
@@ -0,0 +1,190 @@
+/** @file
+  Detection of the processor features used by CopyMem() and SetMem().
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MemLibInternals.h"
+#include <Register/Intel/Cpuid.h>
+
+//
+// Keep in sync with MemLibFeatures.inc.
+//
+#define MEM_LIB_FEATURE_INITIALIZED  BIT0
+#define MEM_LIB_FEATURE_ERMS         BIT1
+#define MEM_LIB_FEATURE_AVX2         BIT2
+#define MEM_LIB_FEATURE_USER_MODE    BIT3
+
+//
+// CPUID.(EAX=07H, ECX=0):EDX[4], Fast Short REP MOV.
+//
+#define CPUID_FAST_SHORT_REP_MOV  BIT4
+
+//
+// rep movsb/stosb threshold. On processors with fast short rep mov, the start
+// up cost of the string instructions is lower, so they are used earlier.
+//
+#define MEM_LIB_REP_STRING_THRESHOLD       SIZE_2KB
+#define MEM_LIB_REP_STRING_THRESHOLD_FSRM  SIZE_1KB
+
+//
+// Non-temporal threshold when the cache size cannot be read. Smaller caches are
+// not trusted either, the threshold must stay well above the AVX2 sizes.
+//
+#define MEM_LIB_DEFAULT_NON_TEMPORAL_THRESHOLD  SIZE_4MB
+#define MEM_LIB_MIN_CACHE_SIZE                  SIZE_256KB
+
+//
+// Read by CopyMem.nasm and SetMem.nasm. The thresholds are written before the
+// features, which marks them valid.
+//
+volatile UINT32  mMemLibFeatures             = 0;
+UINTN            mMemLibRepStringThreshold   = MAX_UINTN;
+UINTN            mMemLibNonTemporalThreshold = MAX_UINTN;
+
+/**
+  Return the size of the largest data cache of the processor.
+
+  @return  The size in bytes of the largest cache, or 0 if it is unknown.
+**/
+UINTN
+InternalMemGetLargestCacheSize (
+  VOID
+  )
+{
+  UINT32                  MaxLeaf;
+  UINT32                  Index;
+  CPUID_CACHE_PARAMS_EAX  Eax;
+  CPUID_CACHE_PARAMS_EBX  Ebx;
+  UINT32                  Sets;
+  UINT32                  Edx;
+  UINTN                   CacheSize;
+  UINTN                   Size;
+
+  CacheSize = 0;
+
+  //
+  // Intel processors enumerate their caches with the deterministic cache
+  // parameters leaf.
+  //
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf >= CPUID_CACHE_PARAMS) {
+    for (Index = 0; Index < 8; Index++) {
+      AsmCpuidEx (CPUID_CACHE_PARAMS, Index, &Eax.Uint32, &Ebx.Uint32, &Sets, NULL);
+      if (Eax.Bits.CacheType == CPUID_CACHE_PARAMS_CACHE_TYPE_NULL) {
+        break;
+      }
+
+      if (Eax.Bits.CacheType == CPUID_CACHE_PARAMS_CACHE_TYPE_INSTRUCTION) {
+        continue;
+      }
+
+      Size = (UINTN)(Ebx.Bits.Ways + 1) * (Ebx.Bits.LinePartitions + 1) * (Ebx.Bits.LineSize + 1) * (Sets + 1);
+      if (Size > CacheSize) {
+        CacheSize = Size;
+      }
+    }
+  }
+
+  if (CacheSize != 0) {
+    return CacheSize;
+  }
+
+  //
+  // AMD processors report the L3 size in 512KB units in EDX[31:18] and the
+  // L2 size in KB in ECX[31:16] of the extended cache leaf.
+  //
+  AsmCpuid (CPUID_EXTENDED_FUNCTION, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf >= CPUID_EXTENDED_CACHE_INFO) {
+    AsmCpuid (CPUID_EXTENDED_CACHE_INFO, NULL, NULL, &Sets, &Edx);
+    CacheSize = (UINTN)(Edx >> 18) * SIZE_512KB;
+    if (CacheSize == 0) {
+      CacheSize = (UINTN)(Sets >> 16) * SIZE_1KB;
+    }
+  }
+
+  return CacheSize;
+}
+
+/**
+  Detect the processor features used by CopyMem() and SetMem(), and compute
+  the size thresholds of the copy and fill strategies.
+
+  It is called by the first CopyMem() or SetMem() larger than 32 bytes. The
+  processors may run it concurrently, they all compute the same values.
+**/
+VOID
+EFIAPI
+InternalMemInitializeFeatures (
+  VOID
+  )
+{
+  UINT32                                       MaxLeaf;
+  CPUID_VERSION_INFO_ECX                       VersionEcx;
+  CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_EBX  ExtendedEbx;
+  UINT32                                       ExtendedEdx;
+  UINT32                                       Features;
+  UINTN                                        CacheSize;
+
+  Features           = MEM_LIB_FEATURE_INITIALIZED;
+  VersionEcx.Uint32  = 0;
+  ExtendedEbx.Uint32 = 0;
+  ExtendedEdx        = 0;
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf >= CPUID_VERSION_INFO) {
+    AsmCpuid (CPUID_VERSION_INFO, NULL, NULL, &VersionEcx.Uint32, NULL);
+  }
+
+  if (MaxLeaf >= CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS) {
+    AsmCpuidEx (
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS,
+      CPUID_STRUCTURED_EXTENDED_FEATURE_FLAGS_SUB_LEAF_INFO,
+      NULL,
+      &ExtendedEbx.Uint32,
+      NULL,
+      &ExtendedEdx
+      );
+  }
+
+  mMemLibRepStringThreshold = MAX_UINTN;
+  if (ExtendedEbx.Bits.EnhancedRepMovsbStosb != 0) {
+    Features                 |= MEM_LIB_FEATURE_ERMS;
+    mMemLibRepStringThreshold = ((ExtendedEdx & CPUID_FAST_SHORT_REP_MOV) != 0) ?
+                                MEM_LIB_REP_STRING_THRESHOLD_FSRM :
+                                MEM_LIB_REP_STRING_THRESHOLD;
+  }
+
+  //
+  // AVX2 can only be used if the OS (here the firmware) enabled the YMM state
+  // in XCR0.
+  //
+  if ((ExtendedEbx.Bits.AVX2 != 0) && (VersionEcx.Bits.AVX != 0) && (VersionEcx.Bits.OSXSAVE != 0)) {
+    if ((AsmXGetBv (0) & (BIT1 | BIT2)) == (BIT1 | BIT2)) {
+      Features |= MEM_LIB_FEATURE_AVX2;
+    }
+  }
+
+  //
+  // In ring 3 (host based unit tests), interrupts cannot be masked and the OS
+  // saves the full register state anyway.
+  //
+  if ((AsmReadCs () & 3) != 0) {
+    Features |= MEM_LIB_FEATURE_USER_MODE;
+  }
+
+  //
+  // Copies and fills larger than most of the last level cache would evict the
+  // data the caller works on, so they bypass the caches.
+  //
+  CacheSize = InternalMemGetLargestCacheSize ();
+  if (CacheSize < MEM_LIB_MIN_CACHE_SIZE) {
+    mMemLibNonTemporalThreshold = MEM_LIB_DEFAULT_NON_TEMPORAL_THRESHOLD;
+  } else {
+    mMemLibNonTemporalThreshold = CacheSize / 4 * 3;
+  }
+
+  mMemLibFeatures = Features;
+}
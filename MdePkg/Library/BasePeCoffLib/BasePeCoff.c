@@ -975,6 +975,7 @@ PeCoffLoaderRelocateImage (
   PHYSICAL_ADDRESS                     BaseAddress;
   UINT32                               NumberOfRvaAndSizes;
   UINT32                               TeStrippedOffset;
+  BOOLEAN                              FixupBlockInImage;
 
   ASSERT (ImageContext != NULL);
 
@@ -1109,14 +1110,42 @@ PeCoffLoaderRelocateImage (
         return RETURN_LOAD_ERROR;
       }
 
+      //
+      // A relocation record addresses at most 4KB after the block address. When
+      // all of them are inside the image, check the block once instead of each record.
+      //
+      FixupBlockInImage = (BOOLEAN)((UINT64)RelocBase->VirtualAddress + 0xFFF < (UINT64)ImageContext->ImageSize + TeStrippedOffset);
+
+      //
+      // DIR64 is the only relocation type emitted for X64 and AARCH64 images, so
+      // handle it in a tight loop when no fixup log is kept. Other types fall
+      // through to the generic loop below.
+      //
+      if (FixupBlockInImage && (FixupData == NULL)) {
+        while ((UINTN)Reloc < (UINTN)RelocEnd) {
+          if (((*Reloc) >> 12) == EFI_IMAGE_REL_BASED_DIR64) {
+            Fixup64  = (UINT64 *)(FixupBase + (*Reloc & 0xFFF));
+            *Fixup64 = *Fixup64 + (UINT64)Adjust;
+          } else if (((*Reloc) >> 12) != EFI_IMAGE_REL_BASED_ABSOLUTE) {
+            break;
+          }
+
+          Reloc += 1;
+        }
+      }
+
       //
       // Run this relocation record
       //
       while ((UINTN)Reloc < (UINTN)RelocEnd) {
-        Fixup = PeCoffLoaderImageAddress (ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), TeStrippedOffset);
-        if (Fixup == NULL) {
-          ImageContext->ImageError = IMAGE_ERROR_FAILED_RELOCATION;
-          return RETURN_LOAD_ERROR;
+        if (FixupBlockInImage) {
+          Fixup = FixupBase + (*Reloc & 0xFFF);
+        } else {
+          Fixup = PeCoffLoaderImageAddress (ImageContext, RelocBase->VirtualAddress + (*Reloc & 0xFFF), TeStrippedOffset);
+          if (Fixup == NULL) {
+            ImageContext->ImageError = IMAGE_ERROR_FAILED_RELOCATION;
+            return RETURN_LOAD_ERROR;
+          }
         }
 
         switch ((*Reloc) >> 12) {
@@ -1208,6 +1237,74 @@ PeCoffLoaderRelocateImage (
   return RETURN_SUCCESS;
 }
 
+/**
+  Checks whether the section raw data of an image is stored in the image file
+  with the same layout as in the loaded image, so that all the sections can be
+  read with a single ImageRead () call.
+
+  This is the case when the raw data of every section starts at its virtual
+  address, and the sections are in ascending address order without overlapping
+  each other once zero filled.
+
+  @param  FirstSection      The first section header of the image.
+  @param  NumberOfSections  The number of sections of the image.
+  @param  SizeOfHeaders     The size of the image headers.
+  @param  TeStrippedOffset  Stripped offset for TE image.
+  @param  SpanStart         Returns the virtual address of the first section raw data byte.
+  @param  SpanEnd           Returns the virtual address following the last section raw data byte.
+
+  @retval TRUE   The section raw data can be read at once.
+  @retval FALSE  The sections must be read one by one.
+
+**/
+BOOLEAN
+PeCoffLoaderIsImageFileContiguous (
+  IN  EFI_IMAGE_SECTION_HEADER  *FirstSection,
+  IN  UINTN                     NumberOfSections,
+  IN  UINTN                     SizeOfHeaders,
+  IN  UINT32                    TeStrippedOffset,
+  OUT UINT32                    *SpanStart,
+  OUT UINT32                    *SpanEnd
+  )
+{
+  EFI_IMAGE_SECTION_HEADER  *Section;
+  UINTN                     Index;
+  UINT64                    End;
+
+  *SpanStart = 0;
+  *SpanEnd   = 0;
+  End        = (UINT64)SizeOfHeaders + TeStrippedOffset;
+
+  Section = FirstSection;
+  for (Index = 0; Index < NumberOfSections; Index++, Section++) {
+    if (Section->VirtualAddress < End) {
+      return FALSE;
+    }
+
+    if (Section->SizeOfRawData == 0) {
+      End = (UINT64)Section->VirtualAddress + Section->Misc.VirtualSize;
+      continue;
+    }
+
+    if (Section->PointerToRawData != Section->VirtualAddress) {
+      return FALSE;
+    }
+
+    if (*SpanEnd == 0) {
+      *SpanStart = Section->VirtualAddress;
+    }
+
+    End = (UINT64)Section->VirtualAddress + MAX (Section->Misc.VirtualSize, Section->SizeOfRawData);
+    if ((UINT64)Section->VirtualAddress + Section->SizeOfRawData > MAX_UINT32) {
+      return FALSE;
+    }
+
+    *SpanEnd = Section->VirtualAddress + Section->SizeOfRawData;
+  }
+
+  return (BOOLEAN)(*SpanEnd != 0);
+}
+
 /**
   Loads a PE/COFF image into memory.
 
@@ -1266,6 +1363,9 @@ PeCoffLoaderLoadImage (
   CHAR16                               *String;
   UINT32                               Offset;
   UINT32                               TeStrippedOffset;
+  UINT32                               SpanStart;
+  UINT32                               SpanEnd;
+  BOOLEAN                              SectionsLoaded;
 
   ASSERT (ImageContext != NULL);
 
@@ -1380,6 +1480,25 @@ PeCoffLoaderLoadImage (
     return RETURN_LOAD_ERROR;
   }
 
+  //
+  // When the image file has the same layout as the loaded image, read the raw
+  // data of all the sections at once instead of one section at a time. If that
+  // read fails, fall back to the per section reads below.
+  //
+  SectionsLoaded = FALSE;
+  if (PeCoffLoaderIsImageFileContiguous (FirstSection, NumberOfSections, ImageContext->SizeOfHeaders, TeStrippedOffset, &SpanStart, &SpanEnd) &&
+      ((UINT64)SpanEnd <= (UINT64)ImageContext->ImageSize + TeStrippedOffset))
+  {
+    Size   = SpanEnd - SpanStart;
+    Status = ImageContext->ImageRead (
+                             ImageContext->Handle,
+                             SpanStart - TeStrippedOffset,
+                             &Size,
+                             (VOID *)(UINTN)(ImageContext->ImageAddress + SpanStart - TeStrippedOffset)
+                             );
+    SectionsLoaded = (BOOLEAN)(!RETURN_ERROR (Status) && (Size == SpanEnd - SpanStart));
+  }
+
   //
   // Load each section of the image
   //
@@ -1407,7 +1526,7 @@ PeCoffLoaderLoadImage (
       return RETURN_LOAD_ERROR;
     }
 
-    if (Section->SizeOfRawData > 0) {
+    if ((Section->SizeOfRawData > 0) && !SectionsLoaded) {
       Status = ImageContext->ImageRead (
                                ImageContext->Handle,
                                Section->PointerToRawData - TeStrippedOffset,
@@ -9,13 +9,15 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiDxe.h>
 
 #include <Guid/HobList.h>
+#include <Guid/HobIndex.h>
 
 #include <Library/HobLib.h>
 #include <Library/UefiLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 
-VOID  *mHobList = NULL;
+VOID             *mHobList  = NULL;
+EDKII_HOB_INDEX  *mHobIndex = NULL;
 
 /**
   Returns the pointer to the HOB list.
@@ -53,8 +55,83 @@ GetHobList (
 }
 
 /**
-  The constructor function caches the pointer to HOB list by calling GetHobList()
-  and will always return EFI_SUCCESS.
+  Returns TRUE if the HOB index can be used to search from a HOB.
+
+  @param  HobStart      The starting HOB pointer to search from.
+
+  @retval TRUE   The HOB index was published for the HOB list of HobStart.
+  @retval FALSE  There is no HOB index, or HobStart is not in the HOB list.
+
+**/
+BOOLEAN
+InternalHobIndexCovers (
+  IN CONST VOID  *HobStart
+  )
+{
+  return (BOOLEAN)((mHobIndex != NULL) &&
+                   ((UINTN)HobStart >= (UINTN)mHobIndex->HobList) &&
+                   ((UINTN)HobStart - (UINTN)mHobIndex->HobList < mHobIndex->HobListSize));
+}
+
+/**
+  Returns the first HOB of a range of the HOB index, at or after the starting HOB,
+  that still has the expected type.
+
+  @param  Range         The range of the HobOffsets array of the HOB index.
+  @param  Type          The HOB type of the range.
+  @param  HobStart      The starting HOB pointer to search from.
+
+  @return The first HOB of the range from the starting HOB, or NULL.
+
+**/
+VOID *
+InternalHobIndexFind (
+  IN CONST EDKII_HOB_INDEX_RANGE  *Range,
+  IN UINT16                       Type,
+  IN CONST VOID                   *HobStart
+  )
+{
+  CONST UINT32          *HobOffsets;
+  UINTN                 Start;
+  UINTN                 Low;
+  UINTN                 High;
+  UINTN                 Middle;
+  EFI_PEI_HOB_POINTERS  Hob;
+
+  HobOffsets = (CONST UINT32 *)((UINT8 *)mHobIndex + mHobIndex->HobOffsetsOffset) + Range->First;
+  Start      = (UINTN)HobStart - (UINTN)mHobIndex->HobList;
+
+  //
+  // The offsets of a range are sorted, find the first one at or after HobStart.
+  //
+  Low  = 0;
+  High = Range->Count;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (HobOffsets[Middle] < Start) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  //
+  // HOBs may have been marked unused after the index was built.
+  //
+  for ( ; Low < Range->Count; Low++) {
+    Hob.Raw = (UINT8 *)(UINTN)mHobIndex->HobList + HobOffsets[Low];
+    if (Hob.Header->HobType == Type) {
+      return Hob.Raw;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+  The constructor function caches the pointer to HOB list by calling GetHobList(),
+  and the HOB index published by the DXE Core for this HOB list if any.
+  It will always return EFI_SUCCESS.
 
   @param  ImageHandle   The firmware allocated handle for the EFI image.
   @param  SystemTable   A pointer to the EFI System Table.
@@ -69,8 +146,18 @@ HobLibConstructor (
   IN EFI_SYSTEM_TABLE  *SystemTable
   )
 {
+  EFI_STATUS  Status;
+
   GetHobList ();
 
+  Status = EfiGetSystemConfigurationTable (&gEdkiiHobIndexTableGuid, (VOID **)&mHobIndex);
+  if (EFI_ERROR (Status) ||
+      (mHobIndex->Signature != EDKII_HOB_INDEX_SIGNATURE) ||
+      (mHobIndex->HobList != (EFI_PHYSICAL_ADDRESS)(UINTN)mHobList))
+  {
+    mHobIndex = NULL;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -102,6 +189,10 @@ GetNextHob (
 
   ASSERT (HobStart != NULL);
 
+  if ((Type < EDKII_HOB_INDEX_TYPE_COUNT) && InternalHobIndexCovers (HobStart)) {
+    return InternalHobIndexFind (&mHobIndex->Types[Type], Type, HobStart);
+  }
+
   Hob.Raw = (UINT8 *)HobStart;
   //
   // Parse the HOB list until end of list or matching type is found.
@@ -171,7 +262,25 @@ GetNextGuidHob (
   IN CONST VOID      *HobStart
   )
 {
-  EFI_PEI_HOB_POINTERS  GuidHob;
+  EFI_PEI_HOB_POINTERS              GuidHob;
+  CONST UINT32                      *Buckets;
+  CONST EDKII_HOB_INDEX_GUID_ENTRY  *GuidEntries;
+  UINTN                             Bucket;
+
+  if (InternalHobIndexCovers (HobStart)) {
+    Buckets     = (CONST UINT32 *)((UINT8 *)mHobIndex + mHobIndex->BucketsOffset);
+    GuidEntries = (CONST EDKII_HOB_INDEX_GUID_ENTRY *)((UINT8 *)mHobIndex + mHobIndex->GuidEntriesOffset);
+    Bucket      = EDKII_HOB_INDEX_HASH_GUID (Guid) & (mHobIndex->BucketCount - 1);
+    while (Buckets[Bucket] != MAX_UINT32) {
+      if (CompareGuid (Guid, &GuidEntries[Buckets[Bucket]].Name)) {
+        return InternalHobIndexFind (&GuidEntries[Buckets[Bucket]].Hobs, EFI_HOB_TYPE_GUID_EXTENSION, HobStart);
+      }
+
+      Bucket = (Bucket + 1) & (mHobIndex->BucketCount - 1);
+    }
+
+    return NULL;
+  }
 
   GuidHob.Raw = (UINT8 *)HobStart;
   while ((GuidHob.Raw = GetNextHob (EFI_HOB_TYPE_GUID_EXTENSION, GuidHob.Raw)) != NULL) {
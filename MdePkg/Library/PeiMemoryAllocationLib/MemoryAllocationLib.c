@@ -9,6 +9,8 @@
 
 #include <PiPei.h>
 
+#include <Ppi/FreePool.h>
+
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PeiServicesLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -842,7 +844,24 @@ FreePool (
   IN VOID  *Buffer
   )
 {
+  EFI_STATUS               Status;
+  EDKII_PEI_FREE_POOL_PPI  *FreePoolPpi;
+
   //
-  // PEI phase does not support to free pool, so leave it as NOP.
+  // The runtime and reserved pools are allocated as pages by this library, and
+  // are the only page aligned pool buffers: the PEI Core pool buffers follow a
+  // header. Their size is not recorded, so they are left allocated.
   //
+  if (((UINTN)Buffer & EFI_PAGE_MASK) == 0) {
+    return;
+  }
+
+  //
+  // The PEI Core can only free the pool allocated once permanent memory is
+  // installed, and then publishes the Free Pool PPI. Before, leave it as NOP.
+  //
+  Status = PeiServicesLocatePpi (&gEdkiiPeiFreePoolPpiGuid, 0, NULL, (VOID **)&FreePoolPpi);
+  if (!EFI_ERROR (Status)) {
+    FreePoolPpi->FreePool (Buffer);
+  }
 }
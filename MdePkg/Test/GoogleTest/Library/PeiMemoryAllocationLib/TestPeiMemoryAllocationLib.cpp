@@ -0,0 +1,147 @@
+/** @file
+  Unit tests of the FreePool() function of PeiMemoryAllocationLib.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Library/GoogleTestLib.h>
+#include <GoogleTest/Library/MockPeiServicesLib.h>
+extern "C" {
+  #include <PiPei.h>
+  #include <Ppi/FreePool.h>
+  #include <Library/MemoryAllocationLib.h>
+}
+
+using namespace testing;
+
+//
+// Pages of the memory served by the mocked page and pool services.
+//
+#define TEST_MEMORY_PAGES  4
+
+class FreePoolTest : public Test {
+protected:
+  MockPeiServicesLib PeiServicesMock;
+  UINT8 *Memory;
+  EDKII_PEI_FREE_POOL_PPI FreePoolPpi;
+
+  //
+  // Buffers passed to the Free Pool PPI.
+  //
+  static VOID *mFreedBuffer;
+  static UINTN mFreeCount;
+
+  static
+  EFI_STATUS
+  EFIAPI
+  MockFreePool (
+    IN VOID  *Buffer
+    )
+  {
+    mFreedBuffer = Buffer;
+    mFreeCount++;
+    return EFI_SUCCESS;
+  }
+
+  void
+  SetUp (
+    ) override
+  {
+    Memory = (UINT8 *)aligned_alloc (EFI_PAGE_SIZE, EFI_PAGES_TO_SIZE (TEST_MEMORY_PAGES));
+    ASSERT_NE (Memory, nullptr);
+
+    mFreedBuffer         = NULL;
+    mFreeCount           = 0;
+    FreePoolPpi.FreePool = MockFreePool;
+
+    //
+    // The pages are page aligned, the PEI Core pool buffers follow a header.
+    //
+    ON_CALL (PeiServicesMock, PeiServicesAllocatePages (_, _, _))
+      .WillByDefault (
+         DoAll (
+           SetArgPointee<2>((EFI_PHYSICAL_ADDRESS)(UINTN)Memory),
+           Return (EFI_SUCCESS)
+           )
+         );
+    ON_CALL (PeiServicesMock, PeiServicesAllocatePool (_, _))
+      .WillByDefault (
+         DoAll (
+           SetArgPointee<1>((VOID *)(Memory + 16)),
+           Return (EFI_SUCCESS)
+           )
+         );
+    ON_CALL (PeiServicesMock, PeiServicesLocatePpi (_, _, _, _))
+      .WillByDefault (
+         DoAll (
+           SetArgPointee<3>((VOID *)&FreePoolPpi),
+           Return (EFI_SUCCESS)
+           )
+         );
+  }
+
+  void
+  TearDown (
+    ) override
+  {
+    free (Memory);
+  }
+};
+
+VOID   *FreePoolTest::mFreedBuffer;
+UINTN  FreePoolTest::mFreeCount;
+
+//
+// Pool allocated by the PEI Core is freed through the Free Pool PPI.
+//
+TEST_F (FreePoolTest, FreeBootServicesPool) {
+  VOID  *Buffer;
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesAllocatePool (40, _));
+  Buffer = AllocatePool (40);
+  ASSERT_EQ (Buffer, (VOID *)(Memory + 16));
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesLocatePpi (BufferEq (&gEdkiiPeiFreePoolPpiGuid, sizeof (EFI_GUID)), 0, _, _));
+  FreePool (Buffer);
+  EXPECT_EQ (mFreeCount, 1U);
+  EXPECT_EQ (mFreedBuffer, Buffer);
+}
+
+//
+// Reserved and runtime pools are allocated as pages, they have no PEI Core
+// pool header and must not reach the Free Pool PPI.
+//
+TEST_F (FreePoolTest, FreeReservedPool) {
+  VOID  *Buffer;
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesAllocatePages (EfiReservedMemoryType, 1, _));
+  Buffer = AllocateReservedPool (40);
+  ASSERT_EQ (Buffer, (VOID *)Memory);
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesLocatePpi (_, _, _, _)).Times (0);
+  FreePool (Buffer);
+  EXPECT_EQ (mFreeCount, 0U);
+}
+
+TEST_F (FreePoolTest, FreeRuntimePool) {
+  VOID  *Buffer;
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesAllocatePages (EfiRuntimeServicesData, 1, _));
+  Buffer = AllocateRuntimePool (40);
+  ASSERT_EQ (Buffer, (VOID *)Memory);
+
+  EXPECT_CALL (PeiServicesMock, PeiServicesLocatePpi (_, _, _, _)).Times (0);
+  FreePool (Buffer);
+  EXPECT_EQ (mFreeCount, 0U);
+}
+
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  testing::InitGoogleTest (&argc, argv);
+  return RUN_ALL_TESTS ();
+}
@@ -0,0 +1,483 @@
+/** @file
+  Host based unit tests and benchmark for the BaseMemoryLib instances.
+
+  The same test application is built once per BaseMemoryLib instance by
+  MdePkgHostTest.dsc. The unit tests compare CopyMem(), SetMem() and ZeroMem()
+  against the C library for all the small sizes and alignments, for overlapping
+  buffers, and for buffers large enough to use non-temporal stores.
+
+  The benchmark test case is skipped unless the MEMORY_LIB_BENCHMARK
+  environment variable is set. It then reports the throughput of CopyMem() and
+  SetMem() for a range of sizes, so the instances can be compared.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "BaseMemoryLib Unit Test Application"
+#define UNIT_TEST_VERSION  "1.0"
+
+//
+// Sizes up to SMALL_SIZE_LIMIT are all tested, with every alignment of the
+// buffers up to ALIGNMENT_LIMIT. They cover all the size tiers of the
+// instances below the non-temporal threshold.
+//
+#define SMALL_SIZE_LIMIT  640
+#define ALIGNMENT_LIMIT   16
+#define OVERLAP_LIMIT     72
+
+//
+// Guard bytes around the destination buffers.
+//
+#define GUARD_SIZE   64
+#define GUARD_VALUE  0xCC
+
+//
+// The large sizes go up to LARGE_SIZE_LIMIT, above the cache size of current
+// processors.
+//
+#define LARGE_SIZE_MIN    SIZE_64KB
+#define LARGE_SIZE_LIMIT  SIZE_64MB
+
+//
+// Bytes moved by the benchmark for each size.
+//
+#define BENCHMARK_BYTES  SIZE_1GB
+
+typedef struct {
+  UINT8    *Source;
+  UINT8    *Destination;
+  UINT8    *Expected;
+  UINTN    Size;
+} MEMORY_TEST_CONTEXT;
+
+MEMORY_TEST_CONTEXT  mSmallContext = { NULL, NULL, NULL, SMALL_SIZE_LIMIT + ALIGNMENT_LIMIT + 2 * GUARD_SIZE };
+MEMORY_TEST_CONTEXT  mLargeContext = { NULL, NULL, NULL, LARGE_SIZE_LIMIT + ALIGNMENT_LIMIT + 2 * GUARD_SIZE };
+
+//
+// The first call to the library is a large CopyMem() made by main(), before
+// the unit test framework calls any other function of the library. Instances
+// that detect the processor features on their first large copy or fill run
+// the detection in this call.
+//
+UINT8  mFirstCopySource[SIZE_4KB];
+UINT8  mFirstCopyDestination[SIZE_4KB];
+VOID   *mFirstCopyResult;
+
+/**
+  Fill a buffer with a pattern that differs at each offset and for each seed.
+
+  @param[out] Buffer  The buffer to fill.
+  @param[in]  Size    The size of the buffer in bytes.
+  @param[in]  Seed    The seed of the pattern.
+**/
+VOID
+FillPattern (
+  OUT UINT8   *Buffer,
+  IN  UINTN   Size,
+  IN  UINT32  Seed
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < Size; Index++) {
+    Buffer[Index] = (UINT8)(((UINT32)Index * 2654435761u + Seed) >> 24);
+  }
+}
+
+/**
+  Allocate the buffers of a test context.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED                      The buffers are allocated.
+  @retval UNIT_TEST_ERROR_PREREQUISITE_NOT_MET  There is not enough memory.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+AllocateTestBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+
+  TestContext              = (MEMORY_TEST_CONTEXT *)Context;
+  TestContext->Source      = malloc (TestContext->Size);
+  TestContext->Destination = malloc (TestContext->Size);
+  TestContext->Expected    = malloc (TestContext->Size);
+  if ((TestContext->Source == NULL) || (TestContext->Destination == NULL) || (TestContext->Expected == NULL)) {
+    return UNIT_TEST_ERROR_PREREQUISITE_NOT_MET;
+  }
+
+  FillPattern (TestContext->Source, TestContext->Size, 0x5A5A5A5A);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Free the buffers of a test context.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+**/
+VOID
+EFIAPI
+FreeTestBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  free (TestContext->Source);
+  free (TestContext->Destination);
+  free (TestContext->Expected);
+  TestContext->Source      = NULL;
+  TestContext->Destination = NULL;
+  TestContext->Expected    = NULL;
+}
+
+/**
+  Check the first call to the library, a large CopyMem() made by main().
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The copy is right and returned Destination.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The copy or its return value is wrong.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestFirstCopyMem (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UT_ASSERT_EQUAL ((UINTN)mFirstCopyResult, (UINTN)mFirstCopyDestination);
+  UT_ASSERT_MEM_EQUAL (mFirstCopyDestination, mFirstCopySource, sizeof (mFirstCopySource));
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Copy all the small sizes between buffers of all the relative alignments.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED             The copies match memcpy().
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A copy is wrong or overflows.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCopyMemSmall (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Size;
+  UINTN                SourceOffset;
+  UINTN                DestinationOffset;
+  UINTN                CheckSize;
+  VOID                 *Result;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  for (Size = 0; Size <= SMALL_SIZE_LIMIT; Size++) {
+    CheckSize = Size + ALIGNMENT_LIMIT + 2 * GUARD_SIZE;
+    for (SourceOffset = 0; SourceOffset < ALIGNMENT_LIMIT; SourceOffset++) {
+      for (DestinationOffset = 0; DestinationOffset < ALIGNMENT_LIMIT; DestinationOffset++) {
+        memset (TestContext->Destination, GUARD_VALUE, CheckSize);
+        memset (TestContext->Expected, GUARD_VALUE, CheckSize);
+        memcpy (TestContext->Expected + GUARD_SIZE + DestinationOffset, TestContext->Source + SourceOffset, Size);
+
+        Result = CopyMem (TestContext->Destination + GUARD_SIZE + DestinationOffset, TestContext->Source + SourceOffset, Size);
+        UT_ASSERT_EQUAL ((UINTN)Result, (UINTN)(TestContext->Destination + GUARD_SIZE + DestinationOffset));
+        UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Copy all the small sizes within a buffer, with the destination before and
+  after the source.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED             The copies match memmove().
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A copy is wrong.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCopyMemOverlap (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Size;
+  UINTN                Delta;
+  UINT8                *Source;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  Source      = TestContext->Destination + OVERLAP_LIMIT;
+  for (Size = 1; Size <= SMALL_SIZE_LIMIT - 2 * OVERLAP_LIMIT; Size++) {
+    for (Delta = 0; Delta <= 2 * OVERLAP_LIMIT; Delta++) {
+      FillPattern (TestContext->Destination, Size + 2 * OVERLAP_LIMIT, (UINT32)Size);
+      memcpy (TestContext->Expected, TestContext->Destination, Size + 2 * OVERLAP_LIMIT);
+      memmove (TestContext->Expected + Delta, TestContext->Expected + OVERLAP_LIMIT, Size);
+
+      CopyMem (TestContext->Destination + Delta, Source, Size);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, Size + 2 * OVERLAP_LIMIT);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Fill and zero all the small sizes at all the alignments.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED             The buffers match memset().
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A buffer is wrong or overflows.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestSetMemSmall (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Size;
+  UINTN                Offset;
+  UINTN                CheckSize;
+  UINT8                Value;
+  VOID                 *Result;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  for (Size = 0; Size <= SMALL_SIZE_LIMIT; Size++) {
+    CheckSize = Size + ALIGNMENT_LIMIT + 2 * GUARD_SIZE;
+    for (Offset = 0; Offset < ALIGNMENT_LIMIT; Offset++) {
+      Value = (UINT8)(Size + Offset);
+      memset (TestContext->Destination, GUARD_VALUE, CheckSize);
+      memset (TestContext->Expected, GUARD_VALUE, CheckSize);
+      memset (TestContext->Expected + GUARD_SIZE + Offset, Value, Size);
+
+      Result = SetMem (TestContext->Destination + GUARD_SIZE + Offset, Size, Value);
+      UT_ASSERT_EQUAL ((UINTN)Result, (UINTN)(TestContext->Destination + GUARD_SIZE + Offset));
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+
+      memset (TestContext->Expected + GUARD_SIZE + Offset, 0, Size);
+      Result = ZeroMem (TestContext->Destination + GUARD_SIZE + Offset, Size);
+      UT_ASSERT_EQUAL ((UINTN)Result, (UINTN)(TestContext->Destination + GUARD_SIZE + Offset));
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Copy, fill and move buffers of power of two sizes, and of odd sizes at odd
+  addresses, up to LARGE_SIZE_LIMIT.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED             The buffers match the C library.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  A buffer is wrong or overflows.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestLargeBuffers (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Size;
+  UINTN                Offset;
+  UINTN                CheckSize;
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  for (Size = LARGE_SIZE_MIN; Size <= LARGE_SIZE_LIMIT; Size *= 2) {
+    for (Offset = 0; Offset < 2; Offset++) {
+      CheckSize = Size + ALIGNMENT_LIMIT + 2 * GUARD_SIZE;
+
+      //
+      // Copy between distinct buffers.
+      //
+      memset (TestContext->Destination, GUARD_VALUE, CheckSize);
+      memset (TestContext->Expected, GUARD_VALUE, CheckSize);
+      memcpy (TestContext->Expected + GUARD_SIZE + Offset * 3, TestContext->Source + Offset * 5, Size - Offset * 11);
+      CopyMem (TestContext->Destination + GUARD_SIZE + Offset * 3, TestContext->Source + Offset * 5, Size - Offset * 11);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+
+      //
+      // Move forward and backward within a buffer.
+      //
+      memmove (TestContext->Expected + GUARD_SIZE + 1, TestContext->Expected + GUARD_SIZE + Offset * 3, Size - Offset * 11);
+      CopyMem (TestContext->Destination + GUARD_SIZE + 1, TestContext->Destination + GUARD_SIZE + Offset * 3, Size - Offset * 11);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+      memmove (TestContext->Expected + GUARD_SIZE + 7, TestContext->Expected + GUARD_SIZE + 1, Size - Offset * 11);
+      CopyMem (TestContext->Destination + GUARD_SIZE + 7, TestContext->Destination + GUARD_SIZE + 1, Size - Offset * 11);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+
+      //
+      // Fill and zero.
+      //
+      memset (TestContext->Expected + GUARD_SIZE + Offset * 3, 0xA5, Size - Offset * 11);
+      SetMem (TestContext->Destination + GUARD_SIZE + Offset * 3, Size - Offset * 11, 0xA5);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+      memset (TestContext->Expected + GUARD_SIZE + Offset * 3, 0, Size - Offset * 11);
+      ZeroMem (TestContext->Destination + GUARD_SIZE + Offset * 3, Size - Offset * 11);
+      UT_ASSERT_MEM_EQUAL (TestContext->Destination, TestContext->Expected, CheckSize);
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Report the throughput of CopyMem() and SetMem() for sizes from 16 bytes to
+  LARGE_SIZE_LIMIT, if the MEMORY_LIB_BENCHMARK environment variable is set.
+
+  @param[in] Context  The MEMORY_TEST_CONTEXT.
+
+  @retval UNIT_TEST_PASSED   The benchmark ran.
+  @retval UNIT_TEST_SKIPPED  MEMORY_LIB_BENCHMARK is not set.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkCopySetMem (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  MEMORY_TEST_CONTEXT  *TestContext;
+  UINTN                Size;
+  UINTN                Iteration;
+  UINTN                IterationCount;
+  clock_t              Start;
+  double               CopySeconds;
+  double               SetSeconds;
+
+  if (getenv ("MEMORY_LIB_BENCHMARK") == NULL) {
+    return UNIT_TEST_SKIPPED;
+  }
+
+  TestContext = (MEMORY_TEST_CONTEXT *)Context;
+  printf (
+    "BaseMemoryLib test module %08x-%04x-%04x\n",
+    gEfiCallerIdGuid.Data1,
+    gEfiCallerIdGuid.Data2,
+    gEfiCallerIdGuid.Data3
+    );
+  printf ("%10s %12s %12s\n", "Size", "CopyMem MB/s", "SetMem MB/s");
+  for (Size = 16; Size <= LARGE_SIZE_LIMIT; Size *= 4) {
+    IterationCount = MAX (BENCHMARK_BYTES / Size, 1);
+
+    Start = clock ();
+    for (Iteration = 0; Iteration < IterationCount; Iteration++) {
+      CopyMem (TestContext->Destination, TestContext->Source, Size);
+    }
+
+    CopySeconds = (double)(clock () - Start) / CLOCKS_PER_SEC;
+
+    Start = clock ();
+    for (Iteration = 0; Iteration < IterationCount; Iteration++) {
+      SetMem (TestContext->Destination, Size, (UINT8)Iteration);
+    }
+
+    SetSeconds = (double)(clock () - Start) / CLOCKS_PER_SEC;
+
+    printf (
+      "%10u %12.0f %12.0f\n",
+      (unsigned)Size,
+      (double)Size * IterationCount / SIZE_1MB / MAX (CopySeconds, 1e-9),
+      (double)Size * IterationCount / SIZE_1MB / MAX (SetSeconds, 1e-9)
+      );
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  BaseMemoryLib and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      CopySetTestSuite;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTestSuite;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Framework = NULL;
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&CopySetTestSuite, Framework, "CopyMem and SetMem test suite", "Common.MemoryLib.CopySet", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to create CopyMem and SetMem test suite\n"));
+    goto EXIT;
+  }
+
+  AddTestCase (CopySetTestSuite, "First call is a large copy", "TestFirstCopyMem", TestFirstCopyMem, NULL, NULL, NULL);
+  AddTestCase (CopySetTestSuite, "Copy small buffers", "TestCopyMemSmall", TestCopyMemSmall, AllocateTestBuffers, FreeTestBuffers, &mSmallContext);
+  AddTestCase (CopySetTestSuite, "Copy overlapping buffers", "TestCopyMemOverlap", TestCopyMemOverlap, AllocateTestBuffers, FreeTestBuffers, &mSmallContext);
+  AddTestCase (CopySetTestSuite, "Set small buffers", "TestSetMemSmall", TestSetMemSmall, AllocateTestBuffers, FreeTestBuffers, &mSmallContext);
+  AddTestCase (CopySetTestSuite, "Copy and set large buffers", "TestLargeBuffers", TestLargeBuffers, AllocateTestBuffers, FreeTestBuffers, &mLargeContext);
+
+  Status = CreateUnitTestSuite (&BenchmarkTestSuite, Framework, "CopyMem and SetMem benchmark", "Common.MemoryLib.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to create CopyMem and SetMem benchmark suite\n"));
+    goto EXIT;
+  }
+
+  AddTestCase (BenchmarkTestSuite, "CopyMem and SetMem throughput", "BenchmarkCopySetMem", BenchmarkCopySetMem, AllocateTestBuffers, FreeTestBuffers, &mLargeContext);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  FillPattern (mFirstCopySource, sizeof (mFirstCopySource), 0x3C3C3C3C);
+  mFirstCopyResult = CopyMem (mFirstCopyDestination, mFirstCopySource, sizeof (mFirstCopySource));
+
+  return UefiTestMain ();
+}
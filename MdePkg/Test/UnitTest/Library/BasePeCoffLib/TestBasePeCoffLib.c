@@ -0,0 +1,813 @@
+/** @file
+  Host based unit tests and benchmark for the BasePeCoffLib image loader.
+
+  The unit tests synthesize small PE32+ images, load them from memory and
+  relocate them, checking both the single read path used when the file layout
+  matches the memory layout and the per section path used otherwise.
+
+  The benchmark test case is skipped unless the PE_COFF_BENCHMARK_FV
+  environment variable names a firmware volume file. All the PE32 and TE images
+  found in the volume, including in nested volumes, are then loaded and
+  relocated repeatedly, and the time spent is reported.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <Uefi.h>
+#include <Pi/PiFirmwareFile.h>
+#include <Pi/PiFirmwareVolume.h>
+#include <IndustryStandard/PeImage.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PeCoffLib.h>
+#include <Library/UnitTestLib.h>
+
+#define UNIT_TEST_NAME     "BasePeCoffLib Unit Test Application"
+#define UNIT_TEST_VERSION  "0.1"
+
+#define TEST_IMAGE_BASE          0x400000ULL
+#define TEST_SECTION_ALIGNMENT   0x1000
+#define TEST_NUMBER_OF_SECTIONS  3
+#define TEST_IMAGE_SIZE          (4 * TEST_SECTION_ALIGNMENT)
+#define TEST_TEXT_RVA            0x1000
+#define TEST_DATA_RVA            0x2000
+#define TEST_RELOC_RVA           0x3000
+#define TEST_DATA_RAW_SIZE       0x200
+#define TEST_DATA_VIRTUAL_SIZE   0x800
+
+#define BENCHMARK_ITERATIONS  100
+
+///
+/// Headers of the synthesized test images.
+///
+typedef struct {
+  EFI_IMAGE_DOS_HEADER        DosHeader;
+  EFI_IMAGE_NT_HEADERS64      NtHeaders;
+  EFI_IMAGE_SECTION_HEADER    Sections[TEST_NUMBER_OF_SECTIONS];
+} TEST_IMAGE_HEADERS;
+
+///
+/// Layout of the synthesized test images.
+///
+typedef struct {
+  //
+  // File alignment of the sections. The file layout matches the memory layout
+  // when it is equal to TEST_SECTION_ALIGNMENT.
+  //
+  UINT32    FileAlignment;
+  //
+  // Relocation records applied to the .data section, and their count.
+  //
+  UINT16    *Relocs;
+  UINTN     RelocCount;
+  //
+  // Base address the image is linked at.
+  //
+  UINT64    ImageBase;
+} TEST_IMAGE_LAYOUT;
+
+///
+/// A synthesized image file and the buffer it is loaded into.
+///
+typedef struct {
+  VOID                            *File;
+  UINTN                           FileSize;
+  VOID                            *Pages;
+  PE_COFF_LOADER_IMAGE_CONTEXT    ImageContext;
+} TEST_IMAGE;
+
+//
+// The .data section starts with pointers to the .text section, at the offsets
+// addressed by the relocation records below.
+//
+#define DATA_DIR64_0    0x000
+#define DATA_HIGHLOW_0  0x008
+#define DATA_DIR64_1    0x010
+#define DATA_DIR64_2    0x018
+
+UINT16  mDir64Relocs[] = {
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_0,
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_1,
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_2,
+  (EFI_IMAGE_REL_BASED_ABSOLUTE << 12)
+};
+
+UINT16  mMixedRelocs[] = {
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_0,
+  (EFI_IMAGE_REL_BASED_HIGHLOW << 12) | DATA_HIGHLOW_0,
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_1,
+  (EFI_IMAGE_REL_BASED_ABSOLUTE << 12),
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | DATA_DIR64_2,
+  (EFI_IMAGE_REL_BASED_ABSOLUTE << 12)
+};
+
+UINT16  mOutOfImageRelocs[] = {
+  (EFI_IMAGE_REL_BASED_DIR64 << 12) | 0xFFF,
+  (EFI_IMAGE_REL_BASED_ABSOLUTE << 12)
+};
+
+TEST_IMAGE_LAYOUT  mContiguousLayout = {
+  TEST_SECTION_ALIGNMENT, mDir64Relocs, ARRAY_SIZE (mDir64Relocs), TEST_IMAGE_BASE
+};
+
+TEST_IMAGE_LAYOUT  mSparseLayout = {
+  0x200, mDir64Relocs, ARRAY_SIZE (mDir64Relocs), TEST_IMAGE_BASE
+};
+
+TEST_IMAGE_LAYOUT  mMixedLayout = {
+  TEST_SECTION_ALIGNMENT, mMixedRelocs, ARRAY_SIZE (mMixedRelocs), TEST_IMAGE_BASE
+};
+
+TEST_IMAGE_LAYOUT  mOutOfImageLayout = {
+  0x200, mOutOfImageRelocs, ARRAY_SIZE (mOutOfImageRelocs), TEST_IMAGE_BASE
+};
+
+TEST_IMAGE  mTestImage;
+
+/**
+  Returns the value a relocation record of the test images must hold at an
+  offset of the .data section once loaded at a given address.
+
+  @param[in] Offset       Offset of the fixup in the .data section.
+  @param[in] LoadAddress  Address the image is loaded at.
+
+  @return  The expected fixup value.
+**/
+UINT64
+GetExpectedFixup (
+  IN UINTN   Offset,
+  IN UINT64  LoadAddress
+  )
+{
+  return LoadAddress + TEST_TEXT_RVA + Offset;
+}
+
+/**
+  Build a PE32+ image file with a .text, a .data and a .reloc section.
+
+  The raw data of the sections is stored at their virtual address when the
+  file alignment is equal to the section alignment, and packed after the
+  headers otherwise. The .data section is zero filled past its raw data.
+
+  @param[in]  Layout  The layout of the image.
+  @param[out] Image   Receives the image file.
+
+  @retval EFI_SUCCESS           The image was built.
+  @retval EFI_OUT_OF_RESOURCES  The image file could not be allocated.
+**/
+EFI_STATUS
+BuildTestImage (
+  IN  TEST_IMAGE_LAYOUT  *Layout,
+  OUT TEST_IMAGE         *Image
+  )
+{
+  TEST_IMAGE_HEADERS         *Headers;
+  EFI_IMAGE_SECTION_HEADER   *Section;
+  EFI_IMAGE_BASE_RELOCATION  *RelocBlock;
+  UINT8                      *File;
+  UINT32                     SizeOfHeaders;
+  UINT32                     RelocSize;
+  UINT32                     RawOffset;
+  UINTN                      Index;
+
+  ZeroMem (Image, sizeof (*Image));
+
+  SizeOfHeaders = ALIGN_VALUE (sizeof (TEST_IMAGE_HEADERS), Layout->FileAlignment);
+  RelocSize     = (UINT32)(sizeof (EFI_IMAGE_BASE_RELOCATION) + Layout->RelocCount * sizeof (UINT16));
+
+  Image->FileSize = TEST_IMAGE_SIZE;
+  Image->File     = AllocateZeroPool (Image->FileSize);
+  if (Image->File == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  File    = Image->File;
+  Headers = Image->File;
+
+  Headers->DosHeader.e_magic  = EFI_IMAGE_DOS_SIGNATURE;
+  Headers->DosHeader.e_lfanew = OFFSET_OF (TEST_IMAGE_HEADERS, NtHeaders);
+
+  Headers->NtHeaders.Signature                          = EFI_IMAGE_NT_SIGNATURE;
+  Headers->NtHeaders.FileHeader.Machine                 = IMAGE_FILE_MACHINE_X64;
+  Headers->NtHeaders.FileHeader.NumberOfSections        = TEST_NUMBER_OF_SECTIONS;
+  Headers->NtHeaders.FileHeader.SizeOfOptionalHeader    = sizeof (EFI_IMAGE_OPTIONAL_HEADER64);
+  Headers->NtHeaders.FileHeader.Characteristics         = EFI_IMAGE_FILE_EXECUTABLE_IMAGE;
+  Headers->NtHeaders.OptionalHeader.Magic               = EFI_IMAGE_NT_OPTIONAL_HDR64_MAGIC;
+  Headers->NtHeaders.OptionalHeader.AddressOfEntryPoint = TEST_TEXT_RVA;
+  Headers->NtHeaders.OptionalHeader.ImageBase           = Layout->ImageBase;
+  Headers->NtHeaders.OptionalHeader.SectionAlignment    = TEST_SECTION_ALIGNMENT;
+  Headers->NtHeaders.OptionalHeader.FileAlignment       = Layout->FileAlignment;
+  Headers->NtHeaders.OptionalHeader.SizeOfImage         = TEST_IMAGE_SIZE;
+  Headers->NtHeaders.OptionalHeader.SizeOfHeaders       = SizeOfHeaders;
+  Headers->NtHeaders.OptionalHeader.Subsystem           = EFI_IMAGE_SUBSYSTEM_EFI_BOOT_SERVICE_DRIVER;
+  Headers->NtHeaders.OptionalHeader.NumberOfRvaAndSizes = EFI_IMAGE_NUMBER_OF_DIRECTORY_ENTRIES;
+  Headers->NtHeaders.OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].VirtualAddress = TEST_RELOC_RVA;
+  Headers->NtHeaders.OptionalHeader.DataDirectory[EFI_IMAGE_DIRECTORY_ENTRY_BASERELOC].Size           = RelocSize;
+
+  RawOffset = SizeOfHeaders;
+  for (Index = 0; Index < TEST_NUMBER_OF_SECTIONS; Index++) {
+    Section                   = &Headers->Sections[Index];
+    Section->VirtualAddress   = (UINT32)(TEST_TEXT_RVA + Index * TEST_SECTION_ALIGNMENT);
+    Section->SizeOfRawData    = TEST_DATA_RAW_SIZE;
+    Section->PointerToRawData = (Layout->FileAlignment == TEST_SECTION_ALIGNMENT) ? Section->VirtualAddress : RawOffset;
+    RawOffset                 = Section->PointerToRawData + ALIGN_VALUE (TEST_DATA_RAW_SIZE, Layout->FileAlignment);
+  }
+
+  CopyMem (Headers->Sections[0].Name, ".text", sizeof (".text"));
+  Headers->Sections[0].Misc.VirtualSize  = TEST_DATA_RAW_SIZE;
+  Headers->Sections[0].Characteristics   = EFI_IMAGE_SCN_CNT_CODE | EFI_IMAGE_SCN_MEM_EXECUTE | EFI_IMAGE_SCN_MEM_READ;
+  CopyMem (Headers->Sections[1].Name, ".data", sizeof (".data"));
+  Headers->Sections[1].Misc.VirtualSize  = TEST_DATA_VIRTUAL_SIZE;
+  Headers->Sections[1].Characteristics   = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_READ | EFI_IMAGE_SCN_MEM_WRITE;
+  CopyMem (Headers->Sections[2].Name, ".reloc", sizeof (".reloc"));
+  Headers->Sections[2].Misc.VirtualSize  = RelocSize;
+  Headers->Sections[2].Characteristics   = EFI_IMAGE_SCN_CNT_INITIALIZED_DATA | EFI_IMAGE_SCN_MEM_DISCARDABLE | EFI_IMAGE_SCN_MEM_READ;
+
+  //
+  // Fill .text with a pattern, so that misplaced section data is detected.
+  //
+  for (Index = 0; Index < TEST_DATA_RAW_SIZE; Index++) {
+    File[Headers->Sections[0].PointerToRawData + Index] = (UINT8)(Index * 7 + 1);
+  }
+
+  WriteUnaligned64 ((UINT64 *)(File + Headers->Sections[1].PointerToRawData + DATA_DIR64_0), GetExpectedFixup (DATA_DIR64_0, Layout->ImageBase));
+  WriteUnaligned32 ((UINT32 *)(File + Headers->Sections[1].PointerToRawData + DATA_HIGHLOW_0), (UINT32)GetExpectedFixup (DATA_HIGHLOW_0, Layout->ImageBase));
+  WriteUnaligned64 ((UINT64 *)(File + Headers->Sections[1].PointerToRawData + DATA_DIR64_1), GetExpectedFixup (DATA_DIR64_1, Layout->ImageBase));
+  WriteUnaligned64 ((UINT64 *)(File + Headers->Sections[1].PointerToRawData + DATA_DIR64_2), GetExpectedFixup (DATA_DIR64_2, Layout->ImageBase));
+
+  RelocBlock                 = (EFI_IMAGE_BASE_RELOCATION *)(File + Headers->Sections[2].PointerToRawData);
+  RelocBlock->VirtualAddress = TEST_DATA_RVA;
+  RelocBlock->SizeOfBlock    = RelocSize;
+  CopyMem (RelocBlock + 1, Layout->Relocs, Layout->RelocCount * sizeof (UINT16));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Load an image file into a newly allocated buffer.
+
+  @param[in, out] Image  The image to load.
+
+  @return  The status returned by PeCoffLoaderGetImageInfo() or PeCoffLoaderLoadImage().
+**/
+RETURN_STATUS
+LoadTestImage (
+  IN OUT TEST_IMAGE  *Image
+  )
+{
+  RETURN_STATUS  Status;
+
+  ZeroMem (&Image->ImageContext, sizeof (Image->ImageContext));
+  Image->ImageContext.Handle    = Image->File;
+  Image->ImageContext.ImageRead = PeCoffLoaderImageReadFromMemory;
+
+  Status = PeCoffLoaderGetImageInfo (&Image->ImageContext);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Image->Pages = AllocatePages (EFI_SIZE_TO_PAGES ((UINTN)Image->ImageContext.ImageSize));
+  if (Image->Pages == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  //
+  // Fill the buffer with a pattern, so that missing zero fills are detected.
+  //
+  SetMem (Image->Pages, (UINTN)Image->ImageContext.ImageSize, 0xCC);
+  Image->ImageContext.ImageAddress = (PHYSICAL_ADDRESS)(UINTN)Image->Pages;
+
+  return PeCoffLoaderLoadImage (&Image->ImageContext);
+}
+
+/**
+  Free the buffers of a test image.
+
+  @param[in] Context  The TEST_IMAGE to free.
+**/
+VOID
+EFIAPI
+FreeTestImage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_IMAGE  *Image;
+
+  Image = (TEST_IMAGE *)Context;
+  if (Image->Pages != NULL) {
+    FreePages (Image->Pages, EFI_SIZE_TO_PAGES ((UINTN)Image->ImageContext.ImageSize));
+  }
+
+  if (Image->File != NULL) {
+    FreePool (Image->File);
+  }
+
+  ZeroMem (Image, sizeof (*Image));
+}
+
+/**
+  Check the content of the sections of a loaded test image.
+
+  @param[in] Image        The loaded image.
+  @param[in] Layout       The layout of the image.
+  @param[in] FixupBase    The address the fixups are expected to point to.
+
+  @retval TRUE   The sections hold the expected content.
+  @retval FALSE  The sections do not hold the expected content.
+**/
+BOOLEAN
+CheckTestImageSections (
+  IN TEST_IMAGE         *Image,
+  IN TEST_IMAGE_LAYOUT  *Layout,
+  IN UINT64             FixupBase
+  )
+{
+  TEST_IMAGE_HEADERS  *Headers;
+  UINT8               *Loaded;
+  UINT8               *Data;
+  UINTN               Index;
+
+  Headers = Image->File;
+  Loaded  = Image->Pages;
+
+  if (CompareMem (Loaded + TEST_TEXT_RVA, (UINT8 *)Image->File + Headers->Sections[0].PointerToRawData, TEST_DATA_RAW_SIZE) != 0) {
+    UT_LOG_ERROR ("The .text section content does not match the image file\n");
+    return FALSE;
+  }
+
+  Data = Loaded + TEST_DATA_RVA;
+  for (Index = MAX (Headers->Sections[1].SizeOfRawData, DATA_DIR64_2 + sizeof (UINT64)); Index < TEST_DATA_VIRTUAL_SIZE; Index++) {
+    if (Data[Index] != 0) {
+      UT_LOG_ERROR ("The .data section is not zero filled at offset 0x%x\n", (UINT32)Index);
+      return FALSE;
+    }
+  }
+
+  if ((ReadUnaligned64 ((UINT64 *)(Data + DATA_DIR64_0)) != GetExpectedFixup (DATA_DIR64_0, FixupBase)) ||
+      (ReadUnaligned64 ((UINT64 *)(Data + DATA_DIR64_1)) != GetExpectedFixup (DATA_DIR64_1, FixupBase)) ||
+      (ReadUnaligned64 ((UINT64 *)(Data + DATA_DIR64_2)) != GetExpectedFixup (DATA_DIR64_2, FixupBase)))
+  {
+    UT_LOG_ERROR ("A DIR64 fixup does not point to 0x%lx\n", FixupBase);
+    return FALSE;
+  }
+
+  if ((Layout->Relocs == mMixedRelocs) &&
+      (ReadUnaligned32 ((UINT32 *)(Data + DATA_HIGHLOW_0)) != (UINT32)GetExpectedFixup (DATA_HIGHLOW_0, FixupBase)))
+  {
+    UT_LOG_ERROR ("The HIGHLOW fixup does not point to 0x%lx\n", FixupBase);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Build a test image, then load and relocate it at its allocated address.
+
+  @param[in] Image      Receives the test image.
+  @param[in] Layout     The layout of the image.
+  @param[in] LogFixups  TRUE to keep the fixup log while relocating the image.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+TestLoadAndRelocate (
+  IN TEST_IMAGE         *Image,
+  IN TEST_IMAGE_LAYOUT  *Layout,
+  IN BOOLEAN            LogFixups
+  )
+{
+  RETURN_STATUS  Status;
+
+  UT_ASSERT_NOT_EFI_ERROR (BuildTestImage (Layout, Image));
+  UT_ASSERT_NOT_EFI_ERROR (LoadTestImage (Image));
+
+  if (LogFixups) {
+    Image->ImageContext.FixupData = AllocatePool (Image->ImageContext.FixupDataSize);
+    UT_ASSERT_NOT_NULL (Image->ImageContext.FixupData);
+  }
+
+  Status = PeCoffLoaderRelocateImage (&Image->ImageContext);
+  if (Image->ImageContext.FixupData != NULL) {
+    FreePool (Image->ImageContext.FixupData);
+    Image->ImageContext.FixupData = NULL;
+  }
+
+  UT_ASSERT_NOT_EFI_ERROR (Status);
+  UT_ASSERT_TRUE (CheckTestImageSections (Image, Layout, Image->ImageContext.ImageAddress));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Load an image whose file layout matches its memory layout.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestLoadContiguousImage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestLoadAndRelocate ((TEST_IMAGE *)Context, &mContiguousLayout, FALSE);
+}
+
+/**
+  Load an image whose sections are packed in the file.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestLoadSparseImage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestLoadAndRelocate ((TEST_IMAGE *)Context, &mSparseLayout, FALSE);
+}
+
+/**
+  Relocate an image with DIR64, HIGHLOW and ABSOLUTE records interleaved.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRelocateMixedImage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestLoadAndRelocate ((TEST_IMAGE *)Context, &mMixedLayout, FALSE);
+}
+
+/**
+  Relocate an image with mixed records while logging the fixups.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRelocateMixedImageWithFixupData (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  return TestLoadAndRelocate ((TEST_IMAGE *)Context, &mMixedLayout, TRUE);
+}
+
+/**
+  Relocate an image to the address it is linked at, which must leave it unchanged.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRelocateZeroDelta (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_IMAGE  *Image;
+
+  Image = (TEST_IMAGE *)Context;
+
+  UT_ASSERT_NOT_EFI_ERROR (BuildTestImage (&mMixedLayout, Image));
+  UT_ASSERT_NOT_EFI_ERROR (LoadTestImage (Image));
+
+  Image->ImageContext.DestinationAddress = mMixedLayout.ImageBase;
+  UT_ASSERT_NOT_EFI_ERROR (PeCoffLoaderRelocateImage (&Image->ImageContext));
+  UT_ASSERT_TRUE (CheckTestImageSections (Image, &mMixedLayout, TEST_IMAGE_BASE));
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Relocate an image with a record addressing memory past the end of the image.
+
+  @param[in] Context  The TEST_IMAGE used by the test.
+
+  @retval UNIT_TEST_PASSED             The test passed.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  The test failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestRelocateOutOfImage (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  TEST_IMAGE                 *Image;
+  EFI_IMAGE_BASE_RELOCATION  *RelocBlock;
+
+  Image = (TEST_IMAGE *)Context;
+
+  UT_ASSERT_NOT_EFI_ERROR (BuildTestImage (&mOutOfImageLayout, Image));
+  UT_ASSERT_NOT_EFI_ERROR (LoadTestImage (Image));
+
+  //
+  // Move the relocation block into the last page of the image, so that its
+  // record addresses the byte following the image.
+  //
+  RelocBlock                 = (EFI_IMAGE_BASE_RELOCATION *)(UINTN)(Image->ImageContext.ImageAddress + TEST_RELOC_RVA);
+  RelocBlock->VirtualAddress = TEST_RELOC_RVA + 1;
+
+  UT_ASSERT_STATUS_EQUAL (PeCoffLoaderRelocateImage (&Image->ImageContext), RETURN_LOAD_ERROR);
+  UT_ASSERT_EQUAL (Image->ImageContext.ImageError, IMAGE_ERROR_FAILED_RELOCATION);
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Append the PE32 and TE images of a firmware volume to a list.
+
+  @param[in]      Fv          The firmware volume.
+  @param[in]      FvSize      The size of the firmware volume.
+  @param[in, out] Images      The list of image addresses.
+  @param[in, out] ImageCount  The number of images in the list.
+  @param[in]      MaxImages   The capacity of the list.
+**/
+VOID
+CollectFvImages (
+  IN     UINT8  *Fv,
+  IN     UINTN  FvSize,
+  IN OUT VOID   **Images,
+  IN OUT UINTN  *ImageCount,
+  IN     UINTN  MaxImages
+  )
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  EFI_FFS_FILE_HEADER         *FfsHeader;
+  EFI_COMMON_SECTION_HEADER   *SectionHeader;
+  UINTN                       FfsOffset;
+  UINTN                       FfsSize;
+  UINTN                       FfsHeaderSize;
+  UINTN                       SectionOffset;
+  UINTN                       SectionSize;
+  UINTN                       SectionHeaderSize;
+
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)Fv;
+  if ((FvSize < sizeof (EFI_FIRMWARE_VOLUME_HEADER)) || (FvHeader->Signature != EFI_FVH_SIGNATURE) ||
+      (FvHeader->HeaderLength > FvSize) || (FvHeader->FvLength > FvSize))
+  {
+    return;
+  }
+
+  FfsOffset = FvHeader->HeaderLength;
+  if (FvHeader->ExtHeaderOffset != 0) {
+    FfsOffset = FvHeader->ExtHeaderOffset + ((EFI_FIRMWARE_VOLUME_EXT_HEADER *)(Fv + FvHeader->ExtHeaderOffset))->ExtHeaderSize;
+  }
+
+  for (FfsOffset = ALIGN_VALUE (FfsOffset, 8);
+       FfsOffset + sizeof (EFI_FFS_FILE_HEADER) <= FvHeader->FvLength;
+       FfsOffset = ALIGN_VALUE (FfsOffset + FfsSize, 8))
+  {
+    FfsHeader = (EFI_FFS_FILE_HEADER *)(Fv + FfsOffset);
+    if (IS_FFS_FILE2 (FfsHeader)) {
+      FfsSize       = FFS_FILE2_SIZE (FfsHeader);
+      FfsHeaderSize = sizeof (EFI_FFS_FILE_HEADER2);
+    } else {
+      FfsSize       = FFS_FILE_SIZE (FfsHeader);
+      FfsHeaderSize = sizeof (EFI_FFS_FILE_HEADER);
+    }
+
+    if ((FfsSize == 0xFFFFFF) || (FfsSize < FfsHeaderSize) || (FfsOffset + FfsSize > FvHeader->FvLength)) {
+      break;
+    }
+
+    if ((FfsHeader->Type == EFI_FV_FILETYPE_RAW) || (FfsHeader->Type == EFI_FV_FILETYPE_FFS_PAD)) {
+      continue;
+    }
+
+    for (SectionOffset = FfsHeaderSize;
+         SectionOffset + sizeof (EFI_COMMON_SECTION_HEADER) <= FfsSize;
+         SectionOffset = ALIGN_VALUE (SectionOffset + SectionSize, 4))
+    {
+      SectionHeader = (EFI_COMMON_SECTION_HEADER *)((UINT8 *)FfsHeader + SectionOffset);
+      if (IS_SECTION2 (SectionHeader)) {
+        SectionSize       = SECTION2_SIZE (SectionHeader);
+        SectionHeaderSize = sizeof (EFI_COMMON_SECTION_HEADER2);
+      } else {
+        SectionSize       = SECTION_SIZE (SectionHeader);
+        SectionHeaderSize = sizeof (EFI_COMMON_SECTION_HEADER);
+      }
+
+      if ((SectionSize < SectionHeaderSize) || (SectionOffset + SectionSize > FfsSize)) {
+        break;
+      }
+
+      if ((SectionHeader->Type == EFI_SECTION_PE32) || (SectionHeader->Type == EFI_SECTION_TE)) {
+        if (*ImageCount < MaxImages) {
+          Images[(*ImageCount)++] = (UINT8 *)SectionHeader + SectionHeaderSize;
+        }
+      } else if (SectionHeader->Type == EFI_SECTION_FIRMWARE_VOLUME_IMAGE) {
+        CollectFvImages ((UINT8 *)SectionHeader + SectionHeaderSize, SectionSize - SectionHeaderSize, Images, ImageCount, MaxImages);
+      }
+    }
+  }
+}
+
+/**
+  Load and relocate all the images of the firmware volume named by the
+  PE_COFF_BENCHMARK_FV environment variable, and report the time spent.
+
+  @param[in] Context  Unused.
+
+  @retval UNIT_TEST_PASSED             The benchmark ran.
+  @retval UNIT_TEST_SKIPPED            No firmware volume was given.
+  @retval UNIT_TEST_ERROR_TEST_FAILED  An image failed to load.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+BenchmarkLoadFvImages (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  CONST CHAR8                   *FvPath;
+  FILE                          *FvFile;
+  UINT8                         *Fv;
+  long                          FvSize;
+  VOID                          **Images;
+  UINTN                         ImageCount;
+  UINTN                         LoadedCount;
+  UINTN                         Index;
+  UINTN                         Iteration;
+  UINTN                         TotalSize;
+  VOID                          *Pages;
+  UINTN                         PageCount;
+  PE_COFF_LOADER_IMAGE_CONTEXT  ImageContext;
+  RETURN_STATUS                 Status;
+  clock_t                       Start;
+  clock_t                       Elapsed;
+
+  FvPath = getenv ("PE_COFF_BENCHMARK_FV");
+  if (FvPath == NULL) {
+    return UNIT_TEST_SKIPPED;
+  }
+
+  FvFile = fopen (FvPath, "rb");
+  UT_ASSERT_NOT_NULL (FvFile);
+  fseek (FvFile, 0, SEEK_END);
+  FvSize = ftell (FvFile);
+  fseek (FvFile, 0, SEEK_SET);
+  UT_ASSERT_TRUE (FvSize > 0);
+  Fv = AllocatePool ((UINTN)FvSize);
+  UT_ASSERT_NOT_NULL (Fv);
+  UT_ASSERT_EQUAL (fread (Fv, 1, (size_t)FvSize, FvFile), (size_t)FvSize);
+  fclose (FvFile);
+
+  Images = AllocatePool (((UINTN)FvSize / sizeof (EFI_FFS_FILE_HEADER)) * sizeof (VOID *));
+  UT_ASSERT_NOT_NULL (Images);
+  ImageCount = 0;
+  CollectFvImages (Fv, (UINTN)FvSize, Images, &ImageCount, (UINTN)FvSize / sizeof (EFI_FFS_FILE_HEADER));
+  UT_ASSERT_NOT_EQUAL (ImageCount, 0);
+
+  LoadedCount = 0;
+  TotalSize   = 0;
+  Elapsed     = 0;
+  for (Index = 0; Index < ImageCount; Index++) {
+    ZeroMem (&ImageContext, sizeof (ImageContext));
+    ImageContext.Handle    = Images[Index];
+    ImageContext.ImageRead = PeCoffLoaderImageReadFromMemory;
+    Status                 = PeCoffLoaderGetImageInfo (&ImageContext);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+
+    //
+    // Images without relocations, such as XIP PEIMs, can only be loaded at
+    // their link address.
+    //
+    if (ImageContext.RelocationsStripped) {
+      continue;
+    }
+
+    PageCount = EFI_SIZE_TO_PAGES ((UINTN)ImageContext.ImageSize);
+    Pages     = AllocateAlignedPages (PageCount, MAX (ImageContext.SectionAlignment, EFI_PAGE_SIZE));
+    UT_ASSERT_NOT_NULL (Pages);
+    LoadedCount++;
+    TotalSize += (UINTN)ImageContext.ImageSize;
+
+    Start = clock ();
+    for (Iteration = 0; Iteration < BENCHMARK_ITERATIONS; Iteration++) {
+      ImageContext.ImageAddress = (PHYSICAL_ADDRESS)(UINTN)Pages;
+      Status                    = PeCoffLoaderLoadImage (&ImageContext);
+      if (!RETURN_ERROR (Status)) {
+        Status = PeCoffLoaderRelocateImage (&ImageContext);
+      }
+
+      if (RETURN_ERROR (Status)) {
+        break;
+      }
+    }
+
+    Elapsed += clock () - Start;
+    FreeAlignedPages (Pages, PageCount);
+    UT_ASSERT_NOT_EFI_ERROR (Status);
+  }
+
+  UT_ASSERT_NOT_EQUAL (LoadedCount, 0);
+  printf (
+    "Loaded and relocated %u of %u images (%u bytes) %u times in %.3f ms, %.3f us per image\n",
+    (unsigned)LoadedCount,
+    (unsigned)ImageCount,
+    (unsigned)TotalSize,
+    (unsigned)BENCHMARK_ITERATIONS,
+    (double)Elapsed * 1000.0 / CLOCKS_PER_SEC,
+    (double)Elapsed * 1000000.0 / CLOCKS_PER_SEC / BENCHMARK_ITERATIONS / LoadedCount
+    );
+
+  FreePool (Images);
+  FreePool (Fv);
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Initialize the unit test framework, suite, and unit tests for the
+  BasePeCoffLib and run the unit tests.
+
+  @retval  EFI_SUCCESS           All test cases were dispatched.
+  @retval  EFI_OUT_OF_RESOURCES  There are not enough resources available to
+                                 initialize the unit tests.
+**/
+EFI_STATUS
+EFIAPI
+UefiTestMain (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  UNIT_TEST_FRAMEWORK_HANDLE  Framework;
+  UNIT_TEST_SUITE_HANDLE      LoaderTestSuite;
+  UNIT_TEST_SUITE_HANDLE      BenchmarkTestSuite;
+
+  DEBUG ((DEBUG_INFO, "%a v%a\n", UNIT_TEST_NAME, UNIT_TEST_VERSION));
+
+  Framework = NULL;
+
+  Status = InitUnitTestFramework (&Framework, UNIT_TEST_NAME, gEfiCallerBaseName, UNIT_TEST_VERSION);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed in InitUnitTestFramework. Status = %r\n", Status));
+    goto EXIT;
+  }
+
+  Status = CreateUnitTestSuite (&LoaderTestSuite, Framework, "PE/COFF image loader test suite", "Common.PeCoff.Loader", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to create PE/COFF image loader test suite\n"));
+    goto EXIT;
+  }
+
+  AddTestCase (LoaderTestSuite, "Load contiguous image", "TestLoadContiguousImage", TestLoadContiguousImage, NULL, FreeTestImage, &mTestImage);
+  AddTestCase (LoaderTestSuite, "Load sparse image", "TestLoadSparseImage", TestLoadSparseImage, NULL, FreeTestImage, &mTestImage);
+  AddTestCase (LoaderTestSuite, "Relocate mixed records", "TestRelocateMixedImage", TestRelocateMixedImage, NULL, FreeTestImage, &mTestImage);
+  AddTestCase (LoaderTestSuite, "Relocate mixed records with fixup data", "TestRelocateMixedImageWithFixupData", TestRelocateMixedImageWithFixupData, NULL, FreeTestImage, &mTestImage);
+  AddTestCase (LoaderTestSuite, "Relocate to link address", "TestRelocateZeroDelta", TestRelocateZeroDelta, NULL, FreeTestImage, &mTestImage);
+  AddTestCase (LoaderTestSuite, "Relocate record out of image", "TestRelocateOutOfImage", TestRelocateOutOfImage, NULL, FreeTestImage, &mTestImage);
+
+  Status = CreateUnitTestSuite (&BenchmarkTestSuite, Framework, "PE/COFF image loader benchmark", "Common.PeCoff.Benchmark", NULL, NULL);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to create PE/COFF image loader benchmark suite\n"));
+    goto EXIT;
+  }
+
+  AddTestCase (BenchmarkTestSuite, "Load the images of PE_COFF_BENCHMARK_FV", "BenchmarkLoadFvImages", BenchmarkLoadFvImages, NULL, NULL, NULL);
+
+  Status = RunAllTestSuites (Framework);
+
+EXIT:
+  if (Framework != NULL) {
+    FreeUnitTestFramework (Framework);
+  }
+
+  return Status;
+}
+
+/**
+  Standard POSIX C entry point for host based unit test execution.
+**/
+int
+main (
+  int   argc,
+  char  *argv[]
+  )
+{
+  return UefiTestMain ();
+}
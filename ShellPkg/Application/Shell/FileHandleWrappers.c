@@ -2177,6 +2177,10 @@ CreateFileInterfaceFile (
   }
 
   CopyMem (NewOne, Template, sizeof (EFI_FILE_PROTOCOL_FILE));
+  //
+  // The wrapper has no ReadEx(), WriteEx() and FlushEx() members.
+  //
+  NewOne->Revision    = EFI_FILE_REVISION;
   NewOne->Orig        = (EFI_FILE_PROTOCOL *)Template;
   NewOne->Unicode     = Unicode;
   NewOne->Open        = FileInterfaceFileOpen;
@@ -80,6 +80,21 @@ CONST CHAR16         mNoNestingEnvVarName[]  = L"nonesting";
 CONST CHAR16         mNoNestingTrue[]        = L"True";
 CONST CHAR16         mNoNestingFalse[]       = L"False";
 
+//
+// Files of the commands found by FindCommandFile() while a script runs. The
+// cache is valid for the values of the path and of the current directory
+// saved with it, and is flushed when the outermost script ends.
+//
+typedef struct {
+  LIST_ENTRY    Link;
+  CHAR16        *Name;
+  CHAR16        *Path;
+} COMMAND_FILE_CACHE_ENTRY;
+
+STATIC LIST_ENTRY  mCommandFileCache = INITIALIZE_LIST_HEAD_VARIABLE (mCommandFileCache);
+STATIC CHAR16      *mCommandFileCachePath;
+STATIC CHAR16      *mCommandFileCacheCurDir;
+
 /**
   Cleans off leading and trailing spaces and tabs.
 
@@ -2051,6 +2066,138 @@ ShellSubstituteAliases (
   return (EFI_SUCCESS);
 }
 
+/**
+  Flush the cache of the command files.
+**/
+VOID
+FlushCommandFileCache (
+  VOID
+  )
+{
+  COMMAND_FILE_CACHE_ENTRY  *Entry;
+
+  while (!IsListEmpty (&mCommandFileCache)) {
+    Entry = (COMMAND_FILE_CACHE_ENTRY *)GetFirstNode (&mCommandFileCache);
+    RemoveEntryList (&Entry->Link);
+    FreePool (Entry->Name);
+    FreePool (Entry->Path);
+    FreePool (Entry);
+  }
+
+  SHELL_FREE_NON_NULL (mCommandFileCachePath);
+  SHELL_FREE_NON_NULL (mCommandFileCacheCurDir);
+}
+
+/**
+  Compare two strings, either of them possibly NULL.
+
+  @param[in] String1    The first string.
+  @param[in] String2    The second string.
+
+  @retval TRUE          The strings are equal or both NULL.
+  @retval FALSE         The strings are different.
+**/
+BOOLEAN
+IsSameString (
+  IN CONST CHAR16  *String1 OPTIONAL,
+  IN CONST CHAR16  *String2 OPTIONAL
+  )
+{
+  if ((String1 == NULL) || (String2 == NULL)) {
+    return (BOOLEAN)(String1 == String2);
+  }
+
+  return (BOOLEAN)(StrCmp (String1, String2) == 0);
+}
+
+/**
+  Find the file of a command in the current directory and the path, with the
+  executable extensions.
+
+  While a script runs the files found are cached, so that the commands run in
+  the loops of the script do not search the directories of the path again. A
+  cached file is checked to still exist before it is returned.
+
+  @param[in] CmdName    The name of the command.
+
+  @retval NULL          The file was not found.
+  @retval !NULL         The path to the file, to be freed by the caller.
+**/
+CHAR16 *
+FindCommandFile (
+  IN CONST CHAR16  *CmdName
+  )
+{
+  CONST CHAR16              *PathEnv;
+  CONST CHAR16              *CurDir;
+  COMMAND_FILE_CACHE_ENTRY  *Entry;
+  CHAR16                    *FileWithPath;
+
+  if (ShellCommandGetCurrentScriptFile () == NULL) {
+    return (ShellFindFilePathEx (CmdName, mExecutableExtensions));
+  }
+
+  PathEnv = ShellInfoObject.NewEfiShellProtocol->GetEnv (L"path");
+  CurDir  = ShellInfoObject.NewEfiShellProtocol->GetCurDir (NULL);
+  if (  !IsSameString (PathEnv, mCommandFileCachePath)
+     || !IsSameString (CurDir, mCommandFileCacheCurDir))
+  {
+    FlushCommandFileCache ();
+    if (PathEnv != NULL) {
+      mCommandFileCachePath = AllocateCopyPool (StrSize (PathEnv), PathEnv);
+    }
+
+    if (CurDir != NULL) {
+      mCommandFileCacheCurDir = AllocateCopyPool (StrSize (CurDir), CurDir);
+    }
+
+    if (  !IsSameString (PathEnv, mCommandFileCachePath)
+       || !IsSameString (CurDir, mCommandFileCacheCurDir))
+    {
+      FlushCommandFileCache ();
+      return (ShellFindFilePathEx (CmdName, mExecutableExtensions));
+    }
+  }
+
+  for ( Entry = (COMMAND_FILE_CACHE_ENTRY *)GetFirstNode (&mCommandFileCache)
+        ; !IsNull (&mCommandFileCache, &Entry->Link)
+        ; Entry = (COMMAND_FILE_CACHE_ENTRY *)GetNextNode (&mCommandFileCache, &Entry->Link)
+        )
+  {
+    if (StrCmp (Entry->Name, CmdName) == 0) {
+      if (ShellIsFile (Entry->Path) == EFI_SUCCESS) {
+        return (AllocateCopyPool (StrSize (Entry->Path), Entry->Path));
+      }
+
+      RemoveEntryList (&Entry->Link);
+      FreePool (Entry->Name);
+      FreePool (Entry->Path);
+      FreePool (Entry);
+      break;
+    }
+  }
+
+  FileWithPath = ShellFindFilePathEx (CmdName, mExecutableExtensions);
+  if (FileWithPath == NULL) {
+    return (NULL);
+  }
+
+  Entry = AllocateZeroPool (sizeof (COMMAND_FILE_CACHE_ENTRY));
+  if (Entry != NULL) {
+    Entry->Name = AllocateCopyPool (StrSize (CmdName), CmdName);
+    Entry->Path = AllocateCopyPool (StrSize (FileWithPath), FileWithPath);
+    if ((Entry->Name == NULL) || (Entry->Path == NULL)) {
+      SHELL_FREE_NON_NULL (Entry->Name);
+      SHELL_FREE_NON_NULL (Entry->Path);
+      FreePool (Entry);
+    } else {
+      InsertHeadList (&mCommandFileCache, &Entry->Link);
+    }
+  }
+
+  return (FileWithPath);
+}
+
 /**
   Takes the Argv[0] part of the command line and determine the meaning of it.
 
@@ -2096,7 +2243,7 @@ GetOperationType (
   //
   // Test for a file
   //
-  if ((FileWithPath = ShellFindFilePathEx (CmdName, mExecutableExtensions)) != NULL) {
+  if ((FileWithPath = FindCommandFile (CmdName)) != NULL) {
     //
     // See if that file has a script file extension
     //
@@ -2606,7 +2753,7 @@ RunCommandOrFile (
       // Process a relative path and also check in the path environment variable
       //
       if (CommandWithPath == NULL) {
-        CommandWithPath = ShellFindFilePathEx (FirstParameter, mExecutableExtensions);
+        CommandWithPath = FindCommandFile (FirstParameter);
       }
 
       //
@@ -3046,31 +3193,46 @@ RunScriptFileHandle (
         )
   {
     ASSERT (CommandLine2 != NULL);
-    StrnCpyS (
-      CommandLine2,
-      PrintBuffSize/sizeof (CHAR16),
-      NewScriptFile->CurrentCommand->Cl,
-      PrintBuffSize/sizeof (CHAR16) - 1
-      );
-
     SaveBufferList (&OldBufferList);
 
-    //
-    // NULL out comments
-    //
-    for (CommandLine3 = CommandLine2; CommandLine3 != NULL && *CommandLine3 != CHAR_NULL; CommandLine3++) {
-      if (*CommandLine3 == L'^') {
-        if ( *(CommandLine3+1) == L':') {
-          CopyMem (CommandLine3, CommandLine3+1, StrSize (CommandLine3) - sizeof (CommandLine3[0]));
-        } else if (*(CommandLine3+1) == L'#') {
-          CommandLine3++;
+    if (NewScriptFile->CurrentCommand->Text != NULL) {
+      StrnCpyS (
+        CommandLine2,
+        PrintBuffSize/sizeof (CHAR16),
+        NewScriptFile->CurrentCommand->Text,
+        PrintBuffSize/sizeof (CHAR16) - 1
+        );
+    } else {
+      StrnCpyS (
+        CommandLine2,
+        PrintBuffSize/sizeof (CHAR16),
+        NewScriptFile->CurrentCommand->Cl,
+        PrintBuffSize/sizeof (CHAR16) - 1
+        );
+
+      //
+      // NULL out comments
+      //
+      for (CommandLine3 = CommandLine2; CommandLine3 != NULL && *CommandLine3 != CHAR_NULL; CommandLine3++) {
+        if (*CommandLine3 == L'^') {
+          if ( *(CommandLine3+1) == L':') {
+            CopyMem (CommandLine3, CommandLine3+1, StrSize (CommandLine3) - sizeof (CommandLine3[0]));
+          } else if (*(CommandLine3+1) == L'#') {
+            CommandLine3++;
+          }
+        } else if (*CommandLine3 == L'#') {
+          *CommandLine3 = CHAR_NULL;
         }
-      } else if (*CommandLine3 == L'#') {
-        *CommandLine3 = CHAR_NULL;
       }
+
+      //
+      // Save the line without its comments for the next runs of the line, in
+      // the loops of the script.
+      //
+      NewScriptFile->CurrentCommand->Text = AllocateCopyPool (StrSize (CommandLine2), CommandLine2);
     }
 
-    if ((CommandLine2 != NULL) && (StrLen (CommandLine2) >= 1)) {
+    if ((CommandLine2 != NULL) && (StrLen (CommandLine2) >= 1) && (StrStr (CommandLine2, L"%") != NULL)) {
       //
       // Due to variability in starting the find and replace action we need to have both buffers the same.
       //
@@ -3138,7 +3300,12 @@ RunScriptFileHandle (
         CommandLine,
         PrintBuffSize/sizeof (CHAR16) - 1
         );
+    }
 
+    //
+    // The lines without a % have nothing to replace and are run as they are.
+    //
+    if ((CommandLine2 != NULL) && (StrLen (CommandLine2) >= 1)) {
       LastCommand = NewScriptFile->CurrentCommand;
 
       for (CommandLine3 = CommandLine2; CommandLine3[0] == L' '; CommandLine3++) {
@@ -3246,6 +3413,7 @@ RunScriptFileHandle (
   //
   if (ShellCommandGetCurrentScriptFile () == NULL) {
     ShellCommandSetEchoState (PreScriptEchoState);
+    FlushCommandFileCache ();
   }
 
   return (EFI_SUCCESS);
@@ -11,11 +11,73 @@
 #define INIT_NAME_BUFFER_SIZE  128
 #define INIT_DATA_BUFFER_SIZE  1024
 
+//
+// Number of buckets of the hash table of gShellEnvVarList, a power of 2.
+//
+#define ENV_VAR_HASH_SIZE  64
+
 //
 // The list is used to cache the environment variables.
 //
 ENV_VAR_LIST  gShellEnvVarList;
 
+//
+// Hash table of the nodes of gShellEnvVarList, linked by their HashLink, so
+// that scripts reading and setting variables in loops do not walk the list.
+//
+LIST_ENTRY  mShellEnvVarHash[ENV_VAR_HASH_SIZE];
+
+/**
+  Compute the bucket of an environment variable name in mShellEnvVarHash.
+
+  @param[in] Key        The name of the environment variable.
+
+  @return The bucket of the name.
+**/
+LIST_ENTRY *
+ShellEnvVarBucket (
+  IN CONST CHAR16  *Key
+  )
+{
+  UINT32  Hash;
+
+  //
+  // FNV-1a of the characters, the names are compared case sensitively.
+  //
+  for (Hash = 2166136261; *Key != CHAR_NULL; Key++) {
+    Hash = (Hash ^ *Key) * 16777619;
+  }
+
+  return &mShellEnvVarHash[Hash & (ENV_VAR_HASH_SIZE - 1)];
+}
+
+/**
+  Find the node of an environment variable in gShellEnvVarList.
+
+  @param[in] Key        The name of the environment variable.
+
+  @return The node of the variable, NULL if it is not in the list.
+**/
+ENV_VAR_LIST *
+ShellFindEnvVarNode (
+  IN CONST CHAR16  *Key
+  )
+{
+  LIST_ENTRY    *Bucket;
+  LIST_ENTRY    *Link;
+  ENV_VAR_LIST  *Node;
+
+  Bucket = ShellEnvVarBucket (Key);
+  for (Link = GetFirstNode (Bucket); !IsNull (Bucket, Link); Link = GetNextNode (Bucket, Link)) {
+    Node = BASE_CR (Link, ENV_VAR_LIST, HashLink);
+    if ((Node->Key != NULL) && (StrCmp (Key, Node->Key) == 0)) {
+      return Node;
+    }
+  }
+
+  return NULL;
+}
+
 /**
   Reports whether an environment variable is Volatile or Non-Volatile.
 
@@ -436,23 +498,18 @@ ShellFindEnvVarInList (
     return SHELL_INVALID_PARAMETER;
   }
 
-  for ( Node = (ENV_VAR_LIST *)GetFirstNode (&gShellEnvVarList.Link)
-        ; !IsNull (&gShellEnvVarList.Link, &Node->Link)
-        ; Node = (ENV_VAR_LIST *)GetNextNode (&gShellEnvVarList.Link, &Node->Link)
-        )
-  {
-    if ((Node->Key != NULL) && (StrCmp (Key, Node->Key) == 0)) {
-      *Value     = AllocateCopyPool (StrSize (Node->Val), Node->Val);
-      *ValueSize = StrSize (Node->Val);
-      if (Atts != NULL) {
-        *Atts = Node->Atts;
-      }
+  Node = ShellFindEnvVarNode (Key);
+  if (Node == NULL) {
+    return EFI_NOT_FOUND;
+  }
 
-      return EFI_SUCCESS;
-    }
+  *Value     = AllocateCopyPool (StrSize (Node->Val), Node->Val);
+  *ValueSize = StrSize (Node->Val);
+  if (Atts != NULL) {
+    *Atts = Node->Atts;
   }
 
-  return EFI_NOT_FOUND;
+  return EFI_SUCCESS;
 }
 
 /**
@@ -492,17 +549,12 @@ ShellAddEnvVarToList (
   //
   // Update the variable value if it exists in gShellEnvVarList.
   //
-  for ( Node = (ENV_VAR_LIST *)GetFirstNode (&gShellEnvVarList.Link)
-        ; !IsNull (&gShellEnvVarList.Link, &Node->Link)
-        ; Node = (ENV_VAR_LIST *)GetNextNode (&gShellEnvVarList.Link, &Node->Link)
-        )
-  {
-    if ((Node->Key != NULL) && (StrCmp (Key, Node->Key) == 0)) {
-      Node->Atts = Atts;
-      SHELL_FREE_NON_NULL (Node->Val);
-      Node->Val = LocalValue;
-      return EFI_SUCCESS;
-    }
+  Node = ShellFindEnvVarNode (Key);
+  if (Node != NULL) {
+    Node->Atts = Atts;
+    SHELL_FREE_NON_NULL (Node->Val);
+    Node->Val = LocalValue;
+    return EFI_SUCCESS;
   }
 
   //
@@ -526,6 +578,7 @@ ShellAddEnvVarToList (
   Node->Val  = LocalValue;
   Node->Atts = Atts;
   InsertTailList (&gShellEnvVarList.Link, &Node->Link);
+  InsertTailList (ShellEnvVarBucket (Key), &Node->HashLink);
 
   return EFI_SUCCESS;
 }
@@ -550,21 +603,17 @@ ShellRemvoeEnvVarFromList (
     return EFI_INVALID_PARAMETER;
   }
 
-  for ( Node = (ENV_VAR_LIST *)GetFirstNode (&gShellEnvVarList.Link)
-        ; !IsNull (&gShellEnvVarList.Link, &Node->Link)
-        ; Node = (ENV_VAR_LIST *)GetNextNode (&gShellEnvVarList.Link, &Node->Link)
-        )
-  {
-    if ((Node->Key != NULL) && (StrCmp (Key, Node->Key) == 0)) {
-      SHELL_FREE_NON_NULL (Node->Key);
-      SHELL_FREE_NON_NULL (Node->Val);
-      RemoveEntryList (&Node->Link);
-      SHELL_FREE_NON_NULL (Node);
-      return EFI_SUCCESS;
-    }
+  Node = ShellFindEnvVarNode (Key);
+  if (Node == NULL) {
+    return EFI_NOT_FOUND;
   }
 
-  return EFI_NOT_FOUND;
+  SHELL_FREE_NON_NULL (Node->Key);
+  SHELL_FREE_NON_NULL (Node->Val);
+  RemoveEntryList (&Node->Link);
+  RemoveEntryList (&Node->HashLink);
+  SHELL_FREE_NON_NULL (Node);
+  return EFI_SUCCESS;
 }
 
 /**
@@ -577,10 +626,27 @@ ShellInitEnvVarList (
   VOID
   )
 {
-  EFI_STATUS  Status;
+  EFI_STATUS    Status;
+  ENV_VAR_LIST  *Node;
+  UINTN         Index;
+
+  for (Index = 0; Index < ENV_VAR_HASH_SIZE; Index++) {
+    InitializeListHead (&mShellEnvVarHash[Index]);
+  }
 
   InitializeListHead (&gShellEnvVarList.Link);
   Status = GetEnvironmentVariableList (&gShellEnvVarList.Link);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  for ( Node = (ENV_VAR_LIST *)GetFirstNode (&gShellEnvVarList.Link)
+        ; !IsNull (&gShellEnvVarList.Link, &Node->Link)
+        ; Node = (ENV_VAR_LIST *)GetNextNode (&gShellEnvVarList.Link, &Node->Link)
+        )
+  {
+    InsertTailList (ShellEnvVarBucket (Node->Key), &Node->HashLink);
+  }
 
   return Status;
 }
@@ -594,8 +660,13 @@ ShellFreeEnvVarList (
   VOID
   )
 {
+  UINTN  Index;
+
   FreeEnvironmentVariableList (&gShellEnvVarList.Link);
   InitializeListHead (&gShellEnvVarList.Link);
+  for (Index = 0; Index < ENV_VAR_HASH_SIZE; Index++) {
+    InitializeListHead (&mShellEnvVarHash[Index]);
+  }
 
   return;
 }
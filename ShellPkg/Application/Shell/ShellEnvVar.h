@@ -19,6 +19,7 @@ typedef struct {
   CHAR16        *Key;
   CHAR16        *Val;
   UINT32        Atts;
+  LIST_ENTRY    HashLink;   ///< Link in the hash table of gShellEnvVarList, not used by other lists.
 } ENV_VAR_LIST;
 
 //
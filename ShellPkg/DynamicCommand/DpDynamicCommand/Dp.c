@@ -85,6 +85,7 @@ STATIC CONST SHELL_PARAM_ITEM  ParamList[] = {
   { L"-c", TypeValue }, // -c   Display cumulative data.
   { L"-n", TypeValue }, // -n # Number of records to display for A and R
   { L"-t", TypeValue }, // -t # Threshold of interest
+  { L"-o", TypeValue }, // -o   Write the boot performance table to a file
   { NULL,  TypeMax   }
 };
 
@@ -150,6 +151,48 @@ GetBootPerformanceTable (
   return EFI_SUCCESS;
 }
 
+/**
+  Write the boot performance table to a file, for the analysis on the host
+  with BaseTools/Scripts/FpdtAnalyze.py.
+
+  @param  FileName   Name of the file to write.
+
+  @retval EFI_SUCCESS  The boot performance table was written.
+  @retval other        The file could not be written.
+
+**/
+EFI_STATUS
+WriteBootPerformanceTable (
+  IN CONST CHAR16  *FileName
+  )
+{
+  EFI_STATUS         Status;
+  SHELL_FILE_HANDLE  FileHandle;
+  UINTN              Size;
+
+  //
+  // Delete the file first, so that no data of a larger file is left.
+  //
+  if (!EFI_ERROR (ShellFileExists (FileName))) {
+    ShellDeleteFileByName (FileName);
+  }
+
+  Status = ShellOpenFileByName (FileName, &FileHandle, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE, 0);
+  if (!EFI_ERROR (Status)) {
+    Size   = mBootPerformanceTableSize;
+    Status = ShellWriteFile (FileHandle, &Size, mBootPerformanceTable);
+    ShellCloseFile (&FileHandle);
+  }
+
+  if (EFI_ERROR (Status)) {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_WRITE_FILE_FAIL), mDpHiiHandle, FileName, Status);
+  } else {
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_WRITE_FILE), mDpHiiHandle, mBootPerformanceTableSize, FileName);
+  }
+
+  return Status;
+}
+
 /**
   Get Handle form Module Guid.
 
@@ -674,6 +717,7 @@ RunDp (
 {
   LIST_ENTRY    *ParamPackage;
   CONST CHAR16  *CmdLineArg;
+  CONST CHAR16  *OutputFileName;
   EFI_STATUS    Status;
 
   PERFORMANCE_PROPERTY  *PerformanceProperty;
@@ -694,6 +738,7 @@ RunDp (
   UINT64         Intermediate;
 
   StringPtr            = NULL;
+  OutputFileName       = NULL;
   SummaryMode          = FALSE;
   VerboseMode          = FALSE;
   AllMode              = FALSE;
@@ -783,6 +828,14 @@ RunDp (
     mInterestThreshold = DEFAULT_THRESHOLD;  // 1ms := 1,000 us
   }
 
+  if (ShellCommandLineGetFlag (ParamPackage, L"-o")) {
+    OutputFileName = ShellCommandLineGetValue (ParamPackage, L"-o");
+    if (OutputFileName == NULL) {
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_DP_TOO_FEW), mDpHiiHandle);
+      return SHELL_INVALID_PARAMETER;
+    }
+  }
+
   if (ShellCommandLineGetFlag (ParamPackage, L"-c")) {
     CustomCumulativeToken = ShellCommandLineGetValue (ParamPackage, L"-c");
     if (CustomCumulativeToken == NULL) {
@@ -824,6 +877,18 @@ RunDp (
     goto Done;
   }
 
+  //
+  // The raw table is written as is, it is analyzed on the host.
+  //
+  if (OutputFileName != NULL) {
+    Status = WriteBootPerformanceTable (OutputFileName);
+    if (EFI_ERROR (Status)) {
+      ShellStatus = SHELL_DEVICE_ERROR;
+    }
+
+    goto Done;
+  }
+
   //
   // 2. Cache the ModuleGuid and hanlde mapping table.
   //
@@ -382,6 +382,9 @@ typedef struct {
   CHAR16        *Cl;        ///< The original command line.
   VOID          *Data;      ///< The data structure format dependant upon Command. (not always used)
   BOOLEAN       Reset;      ///< Reset the command (it must be treated like a initial run (but it may have data already))
+  CHAR16        *Text;      ///< Cl without its comments, saved the first time the line is run. (not always used)
+  CHAR16        *Name;      ///< The first word of Cl, saved by the searches of the script tags. (not always used)
+  VOID          *Jump;      ///< The last search of a tag from this line, see MoveToTag. (not always used)
 } SCRIPT_COMMAND_LIST;
 
 typedef struct {
@@ -792,4 +795,95 @@ ShellSortFileList (
   IN     SHELL_SORT_FILE_LIST  Order
   );
 
+///
+/// Sequential reader or writer of a file, which keeps several requests in
+/// flight with EFI_FILE_PROTOCOL.ReadEx() and WriteEx() when the file system
+/// supports them, and falls back to synchronous requests otherwise.
+///
+typedef struct _SHELL_FILE_STREAM SHELL_FILE_STREAM;
+
+/**
+  Create a stream reading or writing a file sequentially from its current
+  position.
+
+  The size of the buffers of the stream grows with SizeHint, from
+  PcdShellFileOperationSize up to 1MB. The stream does not own Handle, which
+  must stay open until the stream is closed.
+
+  @param[in] Handle     The file to read or write.
+  @param[in] Write      TRUE to write the file, FALSE to read it.
+  @param[in] SizeHint   The expected number of bytes to read or write, 0 if it
+                        is not known.
+  @param[out] Stream    The created stream.
+
+  @retval EFI_SUCCESS           The stream was created. A reading stream has
+                                started to read ahead.
+  @retval EFI_INVALID_PARAMETER Handle or Stream is NULL.
+  @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamOpen (
+  IN  SHELL_FILE_HANDLE  Handle,
+  IN  BOOLEAN            Write,
+  IN  UINT64             SizeHint,
+  OUT SHELL_FILE_STREAM  **Stream
+  );
+
+/**
+  Read the next chunk of a file from a reading stream.
+
+  @param[in] Stream     The stream, created with Write set to FALSE.
+  @param[out] Data      The chunk. It is valid until the next call to
+                        ShellFileStreamRead() or ShellFileStreamClose().
+  @param[out] Size      The size of the chunk in bytes, 0 at the end of the
+                        file.
+
+  @retval EFI_SUCCESS   The chunk was read.
+  @return Others        The error of the file system.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamRead (
+  IN  SHELL_FILE_STREAM  *Stream,
+  OUT CONST VOID         **Data,
+  OUT UINTN              *Size
+  );
+
+/**
+  Write data to a writing stream.
+
+  The data are copied, and written once a buffer of the stream is full. The
+  errors of the writes are returned by the next calls.
+
+  @param[in] Stream     The stream, created with Write set to TRUE.
+  @param[in] Data       The data to write.
+  @param[in] Size       The size of the data in bytes.
+
+  @retval EFI_SUCCESS   The data were queued for writing.
+  @return Others        The error of a previous write.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamWrite (
+  IN SHELL_FILE_STREAM  *Stream,
+  IN CONST VOID         *Data,
+  IN UINTN              Size
+  );
+
+/**
+  Close a stream, waiting for its requests in flight. The data queued in a
+  writing stream are written first. The file itself is not closed.
+
+  @param[in] Stream     The stream.
+
+  @retval EFI_SUCCESS   All the data were written.
+  @return Others        The error of a write.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamClose (
+  IN SHELL_FILE_STREAM  *Stream
+  );
+
 #endif //_SHELL_COMMAND_LIB_
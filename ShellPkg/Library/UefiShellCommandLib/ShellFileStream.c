@@ -0,0 +1,485 @@
+/** @file
+  Sequential file streams with several requests in flight.
+
+  A stream owns a ring of buffers, each with an EFI_FILE_IO_TOKEN. A reading
+  stream keeps all the buffers but the one returned to the caller queued with
+  EFI_FILE_PROTOCOL.ReadEx(), so that the file system reads ahead while the
+  caller processes the data. A writing stream queues each buffer with
+  WriteEx() once it is full, and fills the next one meanwhile.
+
+  The requests complete in the order they were queued, which is the order of
+  the ring. The file systems without ReadEx() and WriteEx() are accessed with
+  synchronous requests through the first buffer of the ring.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "UefiShellCommandLib.h"
+
+#define SHELL_FILE_STREAM_BUFFER_COUNT     3
+#define SHELL_FILE_STREAM_MAX_BUFFER_SIZE  SIZE_1MB
+
+typedef enum {
+  RequestIdle,
+  RequestPending,
+  RequestCompleted
+} SHELL_FILE_STREAM_REQUEST_STATE;
+
+typedef struct {
+  SHELL_FILE_STREAM_REQUEST_STATE    State;
+  UINTN                              Size;
+  EFI_FILE_IO_TOKEN                  Token;
+} SHELL_FILE_STREAM_REQUEST;
+
+struct _SHELL_FILE_STREAM {
+  EFI_FILE_PROTOCOL            *File;
+  BOOLEAN                      Write;
+  BOOLEAN                      Async;
+  //
+  // A read returned less than a buffer: no read is queued anymore.
+  //
+  BOOLEAN                      EndOfFile;
+  //
+  // The buffer of Current was returned by ShellFileStreamRead().
+  //
+  BOOLEAN                      Returned;
+  //
+  // First error of a write, returned by the next calls.
+  //
+  EFI_STATUS                   Status;
+  UINTN                        BufferSize;
+  UINTN                        Current;
+  UINTN                        Used;
+  SHELL_FILE_STREAM_REQUEST    Requests[SHELL_FILE_STREAM_BUFFER_COUNT];
+};
+
+/**
+  Queue the request of a buffer of the stream.
+
+  A request that cannot be queued is completed with the error.
+
+  @param[in] Stream     The stream.
+  @param[in] Request    The request, whose Size is the number of bytes to
+                        read or write.
+
+  @retval EFI_SUCCESS   The request was queued.
+  @return Others        The error of the file system.
+**/
+EFI_STATUS
+ShellFileStreamSubmit (
+  IN SHELL_FILE_STREAM          *Stream,
+  IN SHELL_FILE_STREAM_REQUEST  *Request
+  )
+{
+  EFI_STATUS  Status;
+
+  Request->Token.Status     = EFI_SUCCESS;
+  Request->Token.BufferSize = Request->Size;
+  if (Stream->Write) {
+    Status = Stream->File->WriteEx (Stream->File, &Request->Token);
+  } else {
+    Status = Stream->File->ReadEx (Stream->File, &Request->Token);
+  }
+
+  if (EFI_ERROR (Status)) {
+    Request->Token.Status = Status;
+    Request->State        = RequestCompleted;
+  } else {
+    Request->State = RequestPending;
+  }
+
+  return Status;
+}
+
+/**
+  Wait for the completion of a request.
+
+  @param[in] Request    The request.
+
+  @return The status of the request, EFI_SUCCESS for an idle request.
+**/
+EFI_STATUS
+ShellFileStreamWait (
+  IN SHELL_FILE_STREAM_REQUEST  *Request
+  )
+{
+  UINTN  Index;
+
+  if (Request->State == RequestPending) {
+    gBS->WaitForEvent (1, &Request->Token.Event, &Index);
+    Request->State = RequestCompleted;
+  }
+
+  if (Request->State == RequestIdle) {
+    return EFI_SUCCESS;
+  }
+
+  return Request->Token.Status;
+}
+
+/**
+  Write the buffer of the current request, and move to the next one.
+
+  @param[in] Stream     The writing stream.
+
+  @retval EFI_SUCCESS   The buffer was queued or written.
+  @return Others        The error of a synchronous write.
+**/
+EFI_STATUS
+ShellFileStreamFlushBuffer (
+  IN SHELL_FILE_STREAM  *Stream
+  )
+{
+  SHELL_FILE_STREAM_REQUEST  *Request;
+  EFI_STATUS                 Status;
+  UINTN                      Size;
+  UINTN                      Index;
+
+  Request       = &Stream->Requests[Stream->Current];
+  Request->Size = Stream->Used;
+  Stream->Used  = 0;
+
+  if (Stream->Async) {
+    Status = ShellFileStreamSubmit (Stream, Request);
+    if (Status != EFI_UNSUPPORTED) {
+      Stream->Current = (Stream->Current + 1) % SHELL_FILE_STREAM_BUFFER_COUNT;
+      return EFI_SUCCESS;
+    }
+
+    //
+    // Fall back to synchronous writes once the requests in flight are done.
+    // Their errors are returned by ShellFileStreamClose().
+    //
+    Request->State = RequestIdle;
+    Stream->Async  = FALSE;
+    for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+      ShellFileStreamWait (&Stream->Requests[Index]);
+    }
+  }
+
+  Size   = Request->Size;
+  Status = Stream->File->Write (Stream->File, &Size, Request->Token.Buffer);
+  if (!EFI_ERROR (Status) && (Size != Request->Size)) {
+    Status = EFI_VOLUME_FULL;
+  }
+
+  return Status;
+}
+
+/**
+  Release the buffers and events of a stream, and the stream itself.
+
+  @param[in] Stream     The stream, with no request in flight.
+**/
+VOID
+ShellFileStreamFree (
+  IN SHELL_FILE_STREAM  *Stream
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+    if (Stream->Requests[Index].Token.Event != NULL) {
+      gBS->CloseEvent (Stream->Requests[Index].Token.Event);
+    }
+
+    SHELL_FREE_NON_NULL (Stream->Requests[Index].Token.Buffer);
+  }
+
+  FreePool (Stream);
+}
+
+/**
+  Create a stream reading or writing a file sequentially from its current
+  position.
+
+  The size of the buffers of the stream grows with SizeHint, from
+  PcdShellFileOperationSize up to 1MB. The stream does not own Handle, which
+  must stay open until the stream is closed.
+
+  @param[in] Handle     The file to read or write.
+  @param[in] Write      TRUE to write the file, FALSE to read it.
+  @param[in] SizeHint   The expected number of bytes to read or write, 0 if it
+                        is not known.
+  @param[out] Stream    The created stream.
+
+  @retval EFI_SUCCESS           The stream was created. A reading stream has
+                                started to read ahead.
+  @retval EFI_INVALID_PARAMETER Handle or Stream is NULL.
+  @retval EFI_OUT_OF_RESOURCES  A memory allocation failed.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamOpen (
+  IN  SHELL_FILE_HANDLE  Handle,
+  IN  BOOLEAN            Write,
+  IN  UINT64             SizeHint,
+  OUT SHELL_FILE_STREAM  **Stream
+  )
+{
+  SHELL_FILE_STREAM  *NewStream;
+  EFI_STATUS         Status;
+  UINTN              MinSize;
+  UINTN              BufferSize;
+  UINTN              Index;
+
+  if ((Handle == NULL) || (Stream == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  NewStream = AllocateZeroPool (sizeof (SHELL_FILE_STREAM));
+  if (NewStream == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  NewStream->File   = ConvertShellHandleToEfiFileProtocol (Handle);
+  NewStream->Write  = Write;
+  NewStream->Async  = (BOOLEAN)(NewStream->File->Revision >= EFI_FILE_PROTOCOL_REVISION2);
+  NewStream->Status = EFI_SUCCESS;
+
+  //
+  // Spread the file over the buffers, within the limits of the buffer size.
+  // The size is halved while the buffers cannot be allocated.
+  //
+  MinSize    = PcdGet32 (PcdShellFileOperationSize);
+  BufferSize = (UINTN)MIN (SizeHint / SHELL_FILE_STREAM_BUFFER_COUNT, SHELL_FILE_STREAM_MAX_BUFFER_SIZE);
+  if (BufferSize > MinSize) {
+    BufferSize = (UINTN)GetPowerOfTwo64 (BufferSize);
+  }
+
+  BufferSize = MAX (BufferSize, MinSize);
+  for ( ; ; ) {
+    for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+      NewStream->Requests[Index].Token.Buffer = AllocatePool (BufferSize);
+      if (NewStream->Requests[Index].Token.Buffer == NULL) {
+        break;
+      }
+    }
+
+    if (Index == SHELL_FILE_STREAM_BUFFER_COUNT) {
+      break;
+    }
+
+    while (Index > 0) {
+      Index--;
+      FreePool (NewStream->Requests[Index].Token.Buffer);
+      NewStream->Requests[Index].Token.Buffer = NULL;
+    }
+
+    if (BufferSize / 2 < MinSize) {
+      ShellFileStreamFree (NewStream);
+      return EFI_OUT_OF_RESOURCES;
+    }
+
+    BufferSize /= 2;
+  }
+
+  NewStream->BufferSize = BufferSize;
+
+  if (NewStream->Async) {
+    for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+      Status = gBS->CreateEvent (0, 0, NULL, NULL, &NewStream->Requests[Index].Token.Event);
+      if (EFI_ERROR (Status)) {
+        ShellFileStreamFree (NewStream);
+        return EFI_OUT_OF_RESOURCES;
+      }
+    }
+  }
+
+  if (!Write && NewStream->Async) {
+    //
+    // Start reading ahead. If the file system rejects the first request, the
+    // stream falls back to synchronous reads.
+    //
+    for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+      NewStream->Requests[Index].Size = NewStream->BufferSize;
+      Status                          = ShellFileStreamSubmit (NewStream, &NewStream->Requests[Index]);
+      if ((Status == EFI_UNSUPPORTED) && (Index == 0)) {
+        NewStream->Requests[Index].State = RequestIdle;
+        NewStream->Async                 = FALSE;
+        break;
+      }
+    }
+  }
+
+  *Stream = NewStream;
+  return EFI_SUCCESS;
+}
+
+/**
+  Read the next chunk of a file from a reading stream.
+
+  @param[in] Stream     The stream, created with Write set to FALSE.
+  @param[out] Data      The chunk. It is valid until the next call to
+                        ShellFileStreamRead() or ShellFileStreamClose().
+  @param[out] Size      The size of the chunk in bytes, 0 at the end of the
+                        file.
+
+  @retval EFI_SUCCESS   The chunk was read.
+  @return Others        The error of the file system.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamRead (
+  IN  SHELL_FILE_STREAM  *Stream,
+  OUT CONST VOID         **Data,
+  OUT UINTN              *Size
+  )
+{
+  SHELL_FILE_STREAM_REQUEST  *Request;
+  EFI_STATUS                 Status;
+
+  ASSERT (!Stream->Write);
+
+  if (!Stream->Async) {
+    Request = &Stream->Requests[0];
+    *Size   = Stream->BufferSize;
+    *Data   = Request->Token.Buffer;
+    return Stream->File->Read (Stream->File, Size, Request->Token.Buffer);
+  }
+
+  //
+  // Queue the buffer returned by the previous call again, at the end of the
+  // ring, unless the end of the file was reached.
+  //
+  if (Stream->Returned) {
+    Request        = &Stream->Requests[Stream->Current];
+    Request->State = RequestIdle;
+    if (!Stream->EndOfFile) {
+      Request->Size = Stream->BufferSize;
+      ShellFileStreamSubmit (Stream, Request);
+    }
+
+    Stream->Current  = (Stream->Current + 1) % SHELL_FILE_STREAM_BUFFER_COUNT;
+    Stream->Returned = FALSE;
+  }
+
+  Request = &Stream->Requests[Stream->Current];
+  if (Request->State == RequestIdle) {
+    *Data = Request->Token.Buffer;
+    *Size = 0;
+    return EFI_SUCCESS;
+  }
+
+  Status = ShellFileStreamWait (Request);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (Request->Token.BufferSize < Stream->BufferSize) {
+    Stream->EndOfFile = TRUE;
+  }
+
+  Stream->Returned = TRUE;
+  *Data            = Request->Token.Buffer;
+  *Size            = Request->Token.BufferSize;
+  return EFI_SUCCESS;
+}
+
+/**
+  Write data to a writing stream.
+
+  The data are copied, and written once a buffer of the stream is full. The
+  errors of the writes are returned by the next calls.
+
+  @param[in] Stream     The stream, created with Write set to TRUE.
+  @param[in] Data       The data to write.
+  @param[in] Size       The size of the data in bytes.
+
+  @retval EFI_SUCCESS   The data were queued for writing.
+  @return Others        The error of a previous write.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamWrite (
+  IN SHELL_FILE_STREAM  *Stream,
+  IN CONST VOID         *Data,
+  IN UINTN              Size
+  )
+{
+  SHELL_FILE_STREAM_REQUEST  *Request;
+  EFI_STATUS                 Status;
+  UINTN                      Count;
+
+  ASSERT (Stream->Write);
+
+  while (Size > 0 && !EFI_ERROR (Stream->Status)) {
+    Request = &Stream->Requests[Stream->Current];
+    if (Stream->Used == 0) {
+      //
+      // Reuse the buffer once its previous write is done.
+      //
+      Status = ShellFileStreamWait (Request);
+      if (!EFI_ERROR (Status) && (Request->State == RequestCompleted) && (Request->Token.BufferSize != Request->Size)) {
+        Status = EFI_VOLUME_FULL;
+      }
+
+      Request->State = RequestIdle;
+      if (EFI_ERROR (Status)) {
+        Stream->Status = Status;
+        break;
+      }
+    }
+
+    Count = MIN (Size, Stream->BufferSize - Stream->Used);
+    CopyMem ((UINT8 *)Request->Token.Buffer + Stream->Used, Data, Count);
+    Stream->Used += Count;
+    Data          = (CONST UINT8 *)Data + Count;
+    Size         -= Count;
+
+    if (Stream->Used == Stream->BufferSize) {
+      Stream->Status = ShellFileStreamFlushBuffer (Stream);
+    }
+  }
+
+  return Stream->Status;
+}
+
+/**
+  Close a stream, waiting for its requests in flight. The data queued in a
+  writing stream are written first. The file itself is not closed.
+
+  @param[in] Stream     The stream.
+
+  @retval EFI_SUCCESS   All the data were written.
+  @return Others        The error of a write.
+**/
+EFI_STATUS
+EFIAPI
+ShellFileStreamClose (
+  IN SHELL_FILE_STREAM  *Stream
+  )
+{
+  SHELL_FILE_STREAM_REQUEST  *Request;
+  EFI_STATUS                 Status;
+  UINTN                      Index;
+
+  if (Stream == NULL) {
+    return EFI_SUCCESS;
+  }
+
+  if (Stream->Write && (Stream->Used > 0) && !EFI_ERROR (Stream->Status)) {
+    Stream->Status = ShellFileStreamFlushBuffer (Stream);
+  }
+
+  //
+  // Wait for the requests in the order they were queued.
+  //
+  for (Index = 0; Index < SHELL_FILE_STREAM_BUFFER_COUNT; Index++) {
+    Request = &Stream->Requests[(Stream->Current + Index) % SHELL_FILE_STREAM_BUFFER_COUNT];
+    Status  = ShellFileStreamWait (Request);
+    if (Stream->Write && !EFI_ERROR (Stream->Status)) {
+      if (!EFI_ERROR (Status) && (Request->State == RequestCompleted) && (Request->Token.BufferSize != Request->Size)) {
+        Status = EFI_VOLUME_FULL;
+      }
+
+      Stream->Status = Status;
+    }
+  }
+
+  Status = Stream->Write ? Stream->Status : EFI_SUCCESS;
+  ShellFileStreamFree (Stream);
+  return Status;
+}
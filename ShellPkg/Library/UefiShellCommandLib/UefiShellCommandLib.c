@@ -1169,6 +1169,9 @@ DeleteScriptFileStruct (
         SHELL_FREE_NON_NULL (Script->CurrentCommand->Data);
       }
 
+      SHELL_FREE_NON_NULL (Script->CurrentCommand->Text);
+      SHELL_FREE_NON_NULL (Script->CurrentCommand->Name);
+      SHELL_FREE_NON_NULL (Script->CurrentCommand->Jump);
       SHELL_FREE_NON_NULL (Script->CurrentCommand);
     }
   }
@@ -22,13 +22,14 @@ typedef enum {
 } READ_STATUS;
 
 //
-// Buffer type, for reading both file operands in chunks.
+// Buffer type, for reading both file operands in chunks. The chunks are read
+// ahead by a SHELL_FILE_STREAM while the bytes of the current one are compared.
 //
 typedef struct {
-  UINT8    *Data;     // dynamically allocated buffer
-  UINTN    Allocated; // the allocated size of Data
-  UINTN    Next;      // next position in Data to fetch a byte at
-  UINTN    Left;      // number of bytes left in Data for fetching at Next
+  SHELL_FILE_STREAM    *Stream; // stream reading the file
+  CONST UINT8          *Data;   // current chunk, owned by Stream
+  UINTN                Next;    // next position in Data to fetch a byte at
+  UINTN                Left;    // number of bytes left in Data for fetching at Next
 } FILE_BUFFER;
 
 /**
@@ -89,20 +90,25 @@ PrintDifferentPoint (
 /**
   Initialize a FILE_BUFFER.
 
+  @param[in] FileHandle   The SHELL_FILE_HANDLE to read.
+  @param[in] FileSize     The size of the file, which sizes the chunks.
   @param[out] FileBuffer  The FILE_BUFFER to initialize. On return, the caller
-                          is responsible for checking FileBuffer->Data: if
-                          FileBuffer->Data is NULL on output, then memory
+                          is responsible for checking FileBuffer->Stream: if
+                          FileBuffer->Stream is NULL on output, then memory
                           allocation failed.
 **/
 STATIC
 VOID
 FileBufferInit (
-  OUT FILE_BUFFER  *FileBuffer
+  IN  SHELL_FILE_HANDLE  FileHandle,
+  IN  UINT64             FileSize,
+  OUT FILE_BUFFER        *FileBuffer
   )
 {
-  FileBuffer->Allocated = PcdGet32 (PcdShellFileOperationSize);
-  FileBuffer->Data      = AllocatePool (FileBuffer->Allocated);
-  FileBuffer->Left      = 0;
+  FileBuffer->Stream = NULL;
+  FileBuffer->Data   = NULL;
+  FileBuffer->Left   = 0;
+  ShellFileStreamOpen (FileHandle, FALSE, FileSize, &FileBuffer->Stream);
 }
 
 /**
@@ -119,18 +125,15 @@ FileBufferUninit (
   IN OUT FILE_BUFFER  *FileBuffer
   )
 {
-  SHELL_FREE_NON_NULL (FileBuffer->Data);
+  ShellFileStreamClose (FileBuffer->Stream);
 }
 
 /**
   Read a byte from a SHELL_FILE_HANDLE, buffered with a FILE_BUFFER.
 
-  @param[in] FileHandle      The SHELL_FILE_HANDLE to replenish FileBuffer
-                             from, if needed.
-
   @param[in,out] FileBuffer  The FILE_BUFFER to read a byte from. If FileBuffer
                              is empty on entry, then FileBuffer is refilled
-                             from FileHandle, before outputting a byte from
+                             from its stream, before outputting a byte from
                              FileBuffer to Byte. The caller is responsible for
                              ensuring that FileBuffer was successfully
                              initialized with FileBufferInit().
@@ -148,28 +151,22 @@ FileBufferUninit (
   @retval EFI_SUCCESS  BytesRead has been set to 0 or 1. In the latter case,
                        Byte has been set as well.
 
-  @return              Error codes propagated from
-                       gEfiShellProtocol->ReadFile().
+  @return              Error codes propagated from ShellFileStreamRead().
 **/
 STATIC
 EFI_STATUS
 FileBufferReadByte (
-  IN     SHELL_FILE_HANDLE  FileHandle,
-  IN OUT FILE_BUFFER        *FileBuffer,
-  OUT UINTN                 *BytesRead,
-  OUT UINT8                 *Byte
+  IN OUT FILE_BUFFER  *FileBuffer,
+  OUT UINTN           *BytesRead,
+  OUT UINT8           *Byte
   )
 {
+  CONST VOID  *Data;
   UINTN       ReadSize;
   EFI_STATUS  Status;
 
   if (FileBuffer->Left == 0) {
-    ReadSize = FileBuffer->Allocated;
-    Status   = gEfiShellProtocol->ReadFile (
-                                    FileHandle,
-                                    &ReadSize,
-                                    FileBuffer->Data
-                                    );
+    Status = ShellFileStreamRead (FileBuffer->Stream, &Data, &ReadSize);
     if (EFI_ERROR (Status)) {
       return Status;
     }
@@ -179,6 +176,7 @@ FileBufferReadByte (
       return EFI_SUCCESS;
     }
 
+    FileBuffer->Data = Data;
     FileBuffer->Next = 0;
     FileBuffer->Left = ReadSize;
   }
@@ -191,6 +189,44 @@ FileBufferReadByte (
   return EFI_SUCCESS;
 }
 
+/**
+  Skip the bytes that are equal in the chunks of two FILE_BUFFERs. The chunks
+  are not refilled.
+
+  @param[in,out] FileBuffer1  The first FILE_BUFFER.
+  @param[in,out] FileBuffer2  The second FILE_BUFFER.
+
+  @return The number of bytes skipped in both FILE_BUFFERs.
+**/
+STATIC
+UINTN
+FileBufferSkipEqualBytes (
+  IN OUT FILE_BUFFER  *FileBuffer1,
+  IN OUT FILE_BUFFER  *FileBuffer2
+  )
+{
+  CONST UINT8  *Data1;
+  CONST UINT8  *Data2;
+  UINTN        Count;
+  UINTN        Equal;
+
+  Data1 = FileBuffer1->Data + FileBuffer1->Next;
+  Data2 = FileBuffer2->Data + FileBuffer2->Next;
+  Count = MIN (FileBuffer1->Left, FileBuffer2->Left);
+  if ((Count == 0) || (CompareMem (Data1, Data2, Count) == 0)) {
+    Equal = Count;
+  } else {
+    for (Equal = 0; Data1[Equal] == Data2[Equal]; Equal++) {
+    }
+  }
+
+  FileBuffer1->Next += Equal;
+  FileBuffer1->Left -= Equal;
+  FileBuffer2->Next += Equal;
+  FileBuffer2->Left -= Equal;
+  return Equal;
+}
+
 /**
   Function for 'comp' command.
 
@@ -353,10 +389,10 @@ ShellCommandRunComp (
       if (ShellStatus == SHELL_SUCCESS) {
         DataFromFile1 = AllocateZeroPool ((UINTN)DifferentBytes);
         DataFromFile2 = AllocateZeroPool ((UINTN)DifferentBytes);
-        FileBufferInit (&FileBuffer1);
-        FileBufferInit (&FileBuffer2);
+        FileBufferInit (FileHandle1, Size1, &FileBuffer1);
+        FileBufferInit (FileHandle2, Size2, &FileBuffer2);
         if ((DataFromFile1 == NULL) || (DataFromFile2 == NULL) ||
-            (FileBuffer1.Data == NULL) || (FileBuffer2.Data == NULL))
+            (FileBuffer1.Stream == NULL) || (FileBuffer2.Stream == NULL))
         {
           ShellStatus = SHELL_OUT_OF_RESOURCES;
           SHELL_FREE_NON_NULL (DataFromFile1);
@@ -368,19 +404,24 @@ ShellCommandRunComp (
 
       if (ShellStatus == SHELL_SUCCESS) {
         while (DiffPointNumber < DifferentCount) {
+          //
+          // Out of a different point, the equal bytes only move the address.
+          //
+          if (ReadStatus == OutOfDiffPoint) {
+            TempAddress += FileBufferSkipEqualBytes (&FileBuffer1, &FileBuffer2);
+          }
+
           DataSizeFromFile1 = 1;
           DataSizeFromFile2 = 1;
           OneByteFromFile1  = 0;
           OneByteFromFile2  = 0;
           Status            = FileBufferReadByte (
-                                FileHandle1,
                                 &FileBuffer1,
                                 &DataSizeFromFile1,
                                 &OneByteFromFile1
                                 );
           ASSERT_EFI_ERROR (Status);
           Status = FileBufferReadByte (
-                     FileHandle2,
                      &FileBuffer2,
                      &DataSizeFromFile2,
                      &OneByteFromFile2
@@ -92,56 +92,46 @@ ShellLevel1CommandsLibDestructor (
   return (EFI_SUCCESS);
 }
 
-/**
-  Test a node to see if meets the criterion.
+//
+// The line found by a search of MoveToTag, saved in the Jump member of the
+// line the search started from.
+//
+typedef struct {
+  LIST_MANIP_FUNC        Function;
+  CONST CHAR16           *DecrementerTag;
+  CONST CHAR16           *IncrementerTag;
+  BOOLEAN                WrapAroundScript;
+  BOOLEAN                HasLabel;
+  SCRIPT_COMMAND_LIST    *Target;
+  CHAR16                 Label[1];
+} SCRIPT_JUMP;
 
-  It functions so that count starts at 1 and it increases or decreases when it
-  hits the specified tags.  when it hits zero the location has been found.
+/**
+  Get the command name of a script line, the first word of its command line.
 
-  DecrementerTag and IncrementerTag are used to get around for/endfor and
-  similar paired types where the entire middle should be ignored.
+  The name is saved in the line the first time it is needed.
 
-  If label is used it will be used instead of the count.
+  @param[in, out] CommandNode  The pointer to the line.
 
-  @param[in] Function          The function to use to enumerate through the
-                               list.  Normally GetNextNode or GetPreviousNode.
-  @param[in] DecrementerTag    The tag to decrement the count at.
-  @param[in] IncrementerTag    The tag to increment the count at.
-  @param[in] Label             A label to look for.
-  @param[in, out] ScriptFile   The pointer to the current script file structure.
-  @param[in] MovePast          TRUE makes function return 1 past the found
-                               location.
-  @param[in] FindOnly          TRUE to not change the ScriptFile.
-  @param[in] CommandNode       The pointer to the Node to test.
-  @param[in, out] TargetCount  The pointer to the current count.
+  @return The command name, NULL if the memory allocation failed.
 **/
-BOOLEAN
-TestNodeForMove (
-  IN CONST LIST_MANIP_FUNC      Function,
-  IN CONST CHAR16               *DecrementerTag,
-  IN CONST CHAR16               *IncrementerTag,
-  IN CONST CHAR16               *Label OPTIONAL,
-  IN OUT SCRIPT_FILE            *ScriptFile,
-  IN CONST BOOLEAN              MovePast,
-  IN CONST BOOLEAN              FindOnly,
-  IN CONST SCRIPT_COMMAND_LIST  *CommandNode,
-  IN OUT UINTN                  *TargetCount
+CONST CHAR16 *
+GetCommandNodeName (
+  IN OUT SCRIPT_COMMAND_LIST  *CommandNode
   )
 {
-  BOOLEAN  Found;
-  CHAR16   *CommandName;
-  CHAR16   *CommandNameWalker;
-  CHAR16   *TempLocation;
+  CHAR16  *CommandName;
+  CHAR16  *CommandNameWalker;
+  CHAR16  *TempLocation;
 
-  Found = FALSE;
+  if (CommandNode->Name != NULL) {
+    return CommandNode->Name;
+  }
 
-  //
-  // get just the first part of the command line...
-  //
   CommandName = NULL;
   CommandName = StrnCatGrow (&CommandName, NULL, CommandNode->Cl, 0);
   if (CommandName == NULL) {
-    return (FALSE);
+    return (NULL);
   }
 
   CommandNameWalker = CommandName;
@@ -159,19 +149,60 @@ TestNodeForMove (
     *TempLocation = CHAR_NULL;
   }
 
+  CommandNode->Name = AllocateCopyPool (StrSize (CommandNameWalker), CommandNameWalker);
+  FreePool (CommandName);
+  return (CommandNode->Name);
+}
+
+/**
+  Test a node to see if meets the criterion.
+
+  It functions so that count starts at 1 and it increases or decreases when it
+  hits the specified tags.  when it hits zero the location has been found.
+
+  DecrementerTag and IncrementerTag are used to get around for/endfor and
+  similar paired types where the entire middle should be ignored.
+
+  If label is used it will be used instead of the count.
+
+  @param[in] DecrementerTag    The tag to decrement the count at.
+  @param[in] IncrementerTag    The tag to increment the count at.
+  @param[in] Label             A label to look for.
+  @param[in, out] CommandNode  The pointer to the Node to test.
+  @param[in, out] TargetCount  The pointer to the current count.
+**/
+BOOLEAN
+TestNodeForMove (
+  IN CONST CHAR16             *DecrementerTag,
+  IN CONST CHAR16             *IncrementerTag,
+  IN CONST CHAR16             *Label OPTIONAL,
+  IN OUT SCRIPT_COMMAND_LIST  *CommandNode,
+  IN OUT UINTN                *TargetCount
+  )
+{
+  CONST CHAR16  *CommandName;
+
+  //
+  // get just the first part of the command line...
+  //
+  CommandName = GetCommandNodeName (CommandNode);
+  if (CommandName == NULL) {
+    return (FALSE);
+  }
+
   //
   // did we find a nested item ?
   //
   if (gUnicodeCollation->StriColl (
                            gUnicodeCollation,
-                           (CHAR16 *)CommandNameWalker,
+                           (CHAR16 *)CommandName,
                            (CHAR16 *)IncrementerTag
                            ) == 0)
   {
     (*TargetCount)++;
   } else if (gUnicodeCollation->StriColl (
                                   gUnicodeCollation,
-                                  (CHAR16 *)CommandNameWalker,
+                                  (CHAR16 *)CommandName,
                                   (CHAR16 *)DecrementerTag
                                   ) == 0)
   {
@@ -184,43 +215,73 @@ TestNodeForMove (
   // did we find the matching one...
   //
   if (Label == NULL) {
-    if (*TargetCount == 0) {
-      Found = TRUE;
-      if (!FindOnly) {
-        if (MovePast) {
-          ScriptFile->CurrentCommand = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link);
-        } else {
-          ScriptFile->CurrentCommand = (SCRIPT_COMMAND_LIST *)CommandNode;
-        }
-      }
-    }
+    return (BOOLEAN)(*TargetCount == 0);
+  }
+
+  return (BOOLEAN)((gUnicodeCollation->StriColl (
+                                         gUnicodeCollation,
+                                         (CHAR16 *)CommandName,
+                                         (CHAR16 *)Label
+                                         ) == 0)
+                   && ((*TargetCount) == 0));
+}
+
+/**
+  Search the line matching a tag from the current line of a script.
+
+  @param[in] Function          The function to use to enumerate through the
+                               list.  Normally GetNextNode or GetPreviousNode.
+  @param[in] DecrementerTag    The tag to decrement the count at.
+  @param[in] IncrementerTag    The tag to increment the count at.
+  @param[in] Label             A label to look for.
+  @param[in] ScriptFile        The pointer to the current script file structure.
+  @param[in] WrapAroundScript  TRUE to wrap end-to-beginning or vise versa in
+                               searching.
+
+  @return The line found, NULL if there is none.
+**/
+SCRIPT_COMMAND_LIST *
+SearchTag (
+  IN CONST LIST_MANIP_FUNC  Function,
+  IN CONST CHAR16           *DecrementerTag,
+  IN CONST CHAR16           *IncrementerTag,
+  IN CONST CHAR16           *Label OPTIONAL,
+  IN SCRIPT_FILE            *ScriptFile,
+  IN CONST BOOLEAN          WrapAroundScript
+  )
+{
+  SCRIPT_COMMAND_LIST  *CommandNode;
+  UINTN                TargetCount;
+
+  if (Label == NULL) {
+    TargetCount = 1;
   } else {
-    if (  (gUnicodeCollation->StriColl (
-                                gUnicodeCollation,
-                                (CHAR16 *)CommandNameWalker,
-                                (CHAR16 *)Label
-                                ) == 0)
-       && ((*TargetCount) == 0))
+    TargetCount = 0;
+  }
+
+  for ( CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &ScriptFile->CurrentCommand->Link)
+        ; !IsNull (&ScriptFile->CommandList, &CommandNode->Link)
+        ; CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link)
+        )
+  {
+    if (TestNodeForMove (DecrementerTag, IncrementerTag, Label, CommandNode, &TargetCount)) {
+      return CommandNode;
+    }
+  }
+
+  if (WrapAroundScript) {
+    for ( CommandNode = (SCRIPT_COMMAND_LIST *)GetFirstNode (&ScriptFile->CommandList)
+          ; CommandNode != ScriptFile->CurrentCommand
+          ; CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link)
+          )
     {
-      Found = TRUE;
-      if (!FindOnly) {
-        //
-        // we found the target label without loops
-        //
-        if (MovePast) {
-          ScriptFile->CurrentCommand = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link);
-        } else {
-          ScriptFile->CurrentCommand = (SCRIPT_COMMAND_LIST *)CommandNode;
-        }
+      if (TestNodeForMove (DecrementerTag, IncrementerTag, Label, CommandNode, &TargetCount)) {
+        return CommandNode;
       }
     }
   }
 
-  //
-  // Free the memory for this loop...
-  //
-  FreePool (CommandName);
-  return (Found);
+  return NULL;
 }
 
 /**
@@ -234,6 +295,10 @@ TestNodeForMove (
 
   If label is used it will be used instead of the count.
 
+  The lines of a script do not change while it runs, so the line found is
+  saved in the current line and the same search done again, as in the loops,
+  does not walk the script.
+
   @param[in] Function          The function to use to enumerate through the
                                list.  Normally GetNextNode or GetPreviousNode.
   @param[in] DecrementerTag    The tag to decrement the count at.
@@ -258,57 +323,59 @@ MoveToTag (
   IN CONST BOOLEAN          WrapAroundScript
   )
 {
-  SCRIPT_COMMAND_LIST  *CommandNode;
-  BOOLEAN              Found;
-  UINTN                TargetCount;
+  SCRIPT_COMMAND_LIST  *Target;
+  SCRIPT_JUMP          *Jump;
 
-  if (Label == NULL) {
-    TargetCount = 1;
-  } else {
-    TargetCount = 0;
-  }
-
-  if (ScriptFile == NULL) {
+  if ((ScriptFile == NULL) || (ScriptFile->CurrentCommand == NULL)) {
     return FALSE;
   }
 
-  for (CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &ScriptFile->CurrentCommand->Link), Found = FALSE
-       ; !IsNull (&ScriptFile->CommandList, &CommandNode->Link) && !Found
-       ; CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link)
-       )
+  Target = NULL;
+  Jump   = ScriptFile->CurrentCommand->Jump;
+  if (  (Jump != NULL)
+     && (Jump->Function == Function)
+     && (Jump->WrapAroundScript == WrapAroundScript)
+     && (StrCmp (Jump->DecrementerTag, DecrementerTag) == 0)
+     && (StrCmp (Jump->IncrementerTag, IncrementerTag) == 0)
+     && (Jump->HasLabel == (BOOLEAN)(Label != NULL))
+     && ((Label == NULL) || (StrCmp (Jump->Label, Label) == 0)))
   {
-    Found = TestNodeForMove (
-              Function,
-              DecrementerTag,
-              IncrementerTag,
-              Label,
-              ScriptFile,
-              MovePast,
-              FindOnly,
-              CommandNode,
-              &TargetCount
-              );
+    Target = Jump->Target;
   }
 
-  if (WrapAroundScript && !Found) {
-    for (CommandNode = (SCRIPT_COMMAND_LIST *)GetFirstNode (&ScriptFile->CommandList), Found = FALSE
-         ; CommandNode != ScriptFile->CurrentCommand && !Found
-         ; CommandNode = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &CommandNode->Link)
-         )
-    {
-      Found = TestNodeForMove (
-                Function,
-                DecrementerTag,
-                IncrementerTag,
-                Label,
-                ScriptFile,
-                MovePast,
-                FindOnly,
-                CommandNode,
-                &TargetCount
-                );
+  if (Target == NULL) {
+    Target = SearchTag (Function, DecrementerTag, IncrementerTag, Label, ScriptFile, WrapAroundScript);
+    if (Target == NULL) {
+      return FALSE;
+    }
+
+    //
+    // Save the line found, replacing the previous search from this line.
+    //
+    Jump = AllocateZeroPool (sizeof (SCRIPT_JUMP) + ((Label == NULL) ? 0 : StrSize (Label)));
+    if (Jump != NULL) {
+      Jump->Function         = Function;
+      Jump->DecrementerTag   = DecrementerTag;
+      Jump->IncrementerTag   = IncrementerTag;
+      Jump->WrapAroundScript = WrapAroundScript;
+      Jump->HasLabel         = (BOOLEAN)(Label != NULL);
+      Jump->Target           = Target;
+      if (Label != NULL) {
+        StrCpyS (Jump->Label, StrLen (Label) + 1, Label);
+      }
+
+      SHELL_FREE_NON_NULL (ScriptFile->CurrentCommand->Jump);
+      ScriptFile->CurrentCommand->Jump = Jump;
+    }
+  }
+
+  if (!FindOnly) {
+    if (MovePast) {
+      ScriptFile->CurrentCommand = (SCRIPT_COMMAND_LIST *)(*Function)(&ScriptFile->CommandList, &Target->Link);
+    } else {
+      ScriptFile->CurrentCommand = Target;
     }
   }
 
-  return (Found);
+  return (TRUE);
 }
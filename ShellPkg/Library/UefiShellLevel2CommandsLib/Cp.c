@@ -37,6 +37,173 @@ ValidateAndCopyFiles (
   IN VOID                       **Resp
   );
 
+/**
+  Print the progress of a copy.
+
+  The elapsed time is measured with the real time clock, which is only read
+  when the progress is printed.
+
+  @param[in] Copied       The number of bytes copied.
+  @param[in] FileSize     The size of the source file.
+  @param[in] StartTime    The time at the start of the copy.
+**/
+VOID
+PrintCopyProgress (
+  IN UINT64    Copied,
+  IN UINT64    FileSize,
+  IN EFI_TIME  *StartTime
+  )
+{
+  EFI_TIME  Now;
+  UINT32    Seconds;
+  UINT64    Milliseconds;
+
+  if (EFI_ERROR (gRT->GetTime (&Now, NULL))) {
+    return;
+  }
+
+  //
+  // The copy may run past midnight, but not for a whole day.
+  //
+  Seconds      = Now.Hour * 3600 + Now.Minute * 60 + Now.Second + 24 * 3600 -
+                 (StartTime->Hour * 3600 + StartTime->Minute * 60 + StartTime->Second);
+  Seconds     %= 24 * 3600;
+  Milliseconds = MultU64x32 (Seconds, 1000) + Now.Nanosecond / 1000000 - StartTime->Nanosecond / 1000000;
+  if ((Seconds == 0) && (Now.Nanosecond < StartTime->Nanosecond)) {
+    Milliseconds = 0;
+  }
+
+  ShellPrintHiiEx (
+    -1,
+    -1,
+    NULL,
+    STRING_TOKEN (STR_CP_PROGRESS),
+    gShellLevel2HiiHandle,
+    RShiftU64 (Copied, 20),
+    RShiftU64 (FileSize, 20),
+    RShiftU64 (DivU64x64Remainder (MultU64x32 (RShiftU64 (Copied, 10), 1000), MAX (Milliseconds, 1), NULL), 10)
+    );
+}
+
+/**
+  Copy the data of a file to another one.
+
+  The source is read ahead and the destination written behind through file
+  streams, so that the reads and the writes overlap on the file systems
+  supporting ReadEx() and WriteEx(). The progress is printed every second, if
+  the real time clock is available.
+
+  @param[in] SourceHandle   The source file.
+  @param[in] DestHandle     The destination file.
+  @param[in] FileSize       The size of the source file.
+  @param[in] ShowProgress   TRUE to print the progress of the copy.
+  @param[in] Source         The name of the source file.
+  @param[in] Dest           The name of the destination file.
+  @param[in] CmdName        The command name.
+
+  @retval SHELL_SUCCESS           The data were copied.
+  @retval SHELL_OUT_OF_RESOURCES  A memory allocation failed.
+  @return Others                  The error of a read or a write.
+**/
+SHELL_STATUS
+CopyFileData (
+  IN SHELL_FILE_HANDLE  SourceHandle,
+  IN SHELL_FILE_HANDLE  DestHandle,
+  IN UINT64             FileSize,
+  IN BOOLEAN            ShowProgress,
+  IN CONST CHAR16       *Source,
+  IN CONST CHAR16       *Dest,
+  IN CONST CHAR16       *CmdName
+  )
+{
+  SHELL_FILE_STREAM  *Reader;
+  SHELL_FILE_STREAM  *Writer;
+  EFI_EVENT          Timer;
+  EFI_STATUS         Status;
+  SHELL_STATUS       ShellStatus;
+  CONST VOID         *Data;
+  UINTN              Size;
+  UINT64             Copied;
+  EFI_TIME           StartTime;
+  BOOLEAN            Printed;
+
+  Reader = NULL;
+  Writer = NULL;
+  Timer  = NULL;
+  Status = ShellFileStreamOpen (SourceHandle, FALSE, FileSize, &Reader);
+  if (!EFI_ERROR (Status)) {
+    Status = ShellFileStreamOpen (DestHandle, TRUE, FileSize, &Writer);
+  }
+
+  if (EFI_ERROR (Status)) {
+    ShellFileStreamClose (Reader);
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_OUT_MEM), gShellLevel2HiiHandle, CmdName);
+    return SHELL_OUT_OF_RESOURCES;
+  }
+
+  if (ShowProgress && !EFI_ERROR (gRT->GetTime (&StartTime, NULL))) {
+    Status = gBS->CreateEvent (EVT_TIMER, 0, NULL, NULL, &Timer);
+    if (!EFI_ERROR (Status)) {
+      gBS->SetTimer (Timer, TimerPeriodic, EFI_TIMER_PERIOD_SECONDS (1));
+    } else {
+      Timer = NULL;
+    }
+  }
+
+  ShellStatus = SHELL_SUCCESS;
+  Copied      = 0;
+  Printed     = FALSE;
+  for ( ; ; ) {
+    Status = ShellFileStreamRead (Reader, &Data, &Size);
+    if (EFI_ERROR (Status)) {
+      ShellStatus = (SHELL_STATUS)(Status & (~MAX_BIT));
+      ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_READ_ERROR), gShellLevel2HiiHandle, CmdName, Source);
+      break;
+    }
+
+    if (Size == 0) {
+      break;
+    }
+
+    Status = ShellFileStreamWrite (Writer, Data, Size);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+
+    Copied += Size;
+    if ((Timer != NULL) && (gBS->CheckEvent (Timer) == EFI_SUCCESS)) {
+      PrintCopyProgress (Copied, FileSize, &StartTime);
+      Printed = TRUE;
+    }
+  }
+
+  //
+  // Closing the writer waits for the last writes, which may fail as well.
+  //
+  if (!EFI_ERROR (Status)) {
+    Status = ShellFileStreamClose (Writer);
+  } else {
+    ShellFileStreamClose (Writer);
+  }
+
+  if (EFI_ERROR (Status) && (ShellStatus == SHELL_SUCCESS)) {
+    ShellStatus = (SHELL_STATUS)(Status & (~MAX_BIT));
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_WRITE_ERROR), gShellLevel2HiiHandle, CmdName, Dest);
+  }
+
+  ShellFileStreamClose (Reader);
+
+  if (Timer != NULL) {
+    gBS->CloseEvent (Timer);
+    if (Printed) {
+      PrintCopyProgress (Copied, FileSize, &StartTime);
+      ShellPrintEx (-1, -1, L"\r\n");
+    }
+  }
+
+  return ShellStatus;
+}
+
 /**
   Function to Copy one file to another location
 
@@ -60,15 +227,14 @@ CopySingleFile (
   )
 {
   VOID                  *Response;
-  UINTN                 ReadSize;
   SHELL_FILE_HANDLE     SourceHandle;
   SHELL_FILE_HANDLE     DestHandle;
   EFI_STATUS            Status;
-  VOID                  *Buffer;
   CHAR16                *TempName;
   UINTN                 Size;
   EFI_SHELL_FILE_INFO   *List;
   SHELL_STATUS          ShellStatus;
+  UINT64                FileSize;
   UINT64                SourceFileSize;
   UINT64                DestFileSize;
   EFI_FILE_PROTOCOL     *DestVolumeFP;
@@ -84,7 +250,6 @@ CopySingleFile (
   DestVolumeInfo = NULL;
   ShellStatus    = SHELL_SUCCESS;
 
-  ReadSize = PcdGet32 (PcdShellFileOperationSize);
   // Why bother copying a file to itself
   if (StrCmp (Source, Dest) == 0) {
     return (SHELL_SUCCESS);
@@ -178,6 +343,7 @@ CopySingleFile (
     //
     ShellGetFileSize (SourceHandle, &SourceFileSize);
     ShellGetFileSize (DestHandle, &DestFileSize);
+    FileSize = SourceFileSize;
 
     //
     // if the destination file already exists then it will be replaced, meaning the sourcefile effectively needs less storage space
@@ -225,27 +391,7 @@ CopySingleFile (
       //
       // copy data between files
       //
-      Buffer = AllocateZeroPool (ReadSize);
-      if (Buffer == NULL) {
-        ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_OUT_MEM), gShellLevel2HiiHandle, CmdName);
-        return SHELL_OUT_OF_RESOURCES;
-      }
-
-      while (ReadSize == PcdGet32 (PcdShellFileOperationSize) && !EFI_ERROR (Status)) {
-        Status = ShellReadFile (SourceHandle, &ReadSize, Buffer);
-        if (!EFI_ERROR (Status)) {
-          Status = ShellWriteFile (DestHandle, &ReadSize, Buffer);
-          if (EFI_ERROR (Status)) {
-            ShellStatus = (SHELL_STATUS)(Status & (~MAX_BIT));
-            ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_WRITE_ERROR), gShellLevel2HiiHandle, CmdName, Dest);
-            break;
-          }
-        } else {
-          ShellStatus = (SHELL_STATUS)(Status & (~MAX_BIT));
-          ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_GEN_CPY_READ_ERROR), gShellLevel2HiiHandle, CmdName, Source);
-          break;
-        }
-      }
+      ShellStatus = CopyFileData (SourceHandle, DestHandle, FileSize, !SilentMode, Source, Dest, CmdName);
     }
 
     SHELL_FREE_NON_NULL (DestVolumeInfo);
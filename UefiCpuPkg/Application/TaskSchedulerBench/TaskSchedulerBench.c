@@ -0,0 +1,262 @@
+/** @file
+  UEFI Application measuring the scaling of the Task Scheduler Library.
+
+  The application runs a compute loop over BENCH_ITEMS items on the BSP only,
+  then with TaskParallelFor() on all the enabled processors with the default
+  grain and with a grain of one item, and prints the speedups. It then
+  measures the time of spawning and running BENCH_TASKS empty tasks.
+
+  In DXE the times include the wait for the periodic check of the APs by the
+  MP services at the end of each run.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TaskSchedulerLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiLib.h>
+
+#define BENCH_ITEMS       SIZE_1MB
+#define BENCH_ITERATIONS  64
+#define BENCH_TASKS       100000
+
+typedef struct {
+  UINT32    *Results;
+  UINTN     Grain;
+  UINTN     WorkerCount;
+} BENCH_CONTEXT;
+
+/**
+  Compute the result of an item, a few rounds of a xorshift generator.
+
+  @param[in] Item  The index of the item.
+
+  @return The result of the item.
+**/
+UINT32
+ComputeItem (
+  IN UINTN  Item
+  )
+{
+  UINT32  Value;
+  UINTN   Index;
+
+  Value = (UINT32)Item + 1;
+  for (Index = 0; Index < BENCH_ITERATIONS; Index++) {
+    Value ^= Value << 13;
+    Value ^= Value >> 17;
+    Value ^= Value << 5;
+  }
+
+  return Value;
+}
+
+/**
+  Compute the results of a part of the items.
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Start      The first item of the part.
+  @param[in] End        The item following the last item of the part.
+  @param[in] Context    The BENCH_CONTEXT.
+**/
+VOID
+EFIAPI
+ComputeRange (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN UINTN           Start,
+  IN UINTN           End,
+  IN VOID            *Context
+  )
+{
+  BENCH_CONTEXT  *Bench;
+
+  Bench = (BENCH_CONTEXT *)Context;
+  for ( ; Start < End; Start++) {
+    Bench->Results[Start] = ComputeItem (Start);
+  }
+}
+
+/**
+  Root task computing all the items with TaskParallelFor().
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Context    The BENCH_CONTEXT.
+**/
+VOID
+EFIAPI
+ParallelForRoot (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN VOID            *Context
+  )
+{
+  BENCH_CONTEXT  *Bench;
+
+  Bench              = (BENCH_CONTEXT *)Context;
+  Bench->WorkerCount = TaskGetWorkerCount (Scheduler);
+  TaskParallelFor (Scheduler, 0, BENCH_ITEMS, Bench->Grain, ComputeRange, Bench);
+}
+
+/**
+  Empty task.
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Context    Not used.
+**/
+VOID
+EFIAPI
+EmptyTask (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN VOID            *Context
+  )
+{
+}
+
+/**
+  Root task spawning BENCH_TASKS empty tasks and waiting for them.
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Context    Not used.
+**/
+VOID
+EFIAPI
+SpawnRoot (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN VOID            *Context
+  )
+{
+  TASK_FUTURE  Future;
+  UINTN        Index;
+
+  Future.Pending = 0;
+  for (Index = 0; Index < BENCH_TASKS; Index++) {
+    TaskSpawn (Scheduler, &Future, EmptyTask, NULL);
+  }
+
+  TaskWait (Scheduler, &Future);
+}
+
+/**
+  Get the time elapsed since a value of the performance counter.
+
+  @param[in] Start  The value of the performance counter.
+
+  @return The time elapsed, in microseconds.
+**/
+UINT64
+ElapsedMicroseconds (
+  IN UINT64  Start
+  )
+{
+  return DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - Start), 1000);
+}
+
+/**
+  Check the results of the items.
+
+  @param[in] Results  The results.
+
+  @retval TRUE   All the results are correct.
+  @retval FALSE  Some results are wrong.
+**/
+BOOLEAN
+CheckResults (
+  IN UINT32  *Results
+  )
+{
+  UINTN  Item;
+
+  for (Item = 0; Item < BENCH_ITEMS; Item++) {
+    if (Results[Item] != ComputeItem (Item)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  The user Entry Point for Application. The user code starts with this function
+  as the real entry point for the application.
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS       The entry point is executed successfully.
+  @retval other             Some error occurs when executing this entry point.
+
+**/
+EFI_STATUS
+EFIAPI
+UefiMain (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS     Status;
+  BENCH_CONTEXT  Bench;
+  UINT64         Start;
+  UINT64         Serial;
+  UINT64         Parallel;
+
+  Bench.Results = AllocatePool (BENCH_ITEMS * sizeof (UINT32));
+  if (Bench.Results == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Start = GetPerformanceCounter ();
+  ComputeRange (NULL, 0, BENCH_ITEMS, &Bench);
+  Serial = MAX (ElapsedMicroseconds (Start), 1);
+  Print (L"BSP only:              %8ld us\n", Serial);
+
+  ZeroMem (Bench.Results, BENCH_ITEMS * sizeof (UINT32));
+  Bench.Grain = 0;
+  Start       = GetPerformanceCounter ();
+  Status      = TaskSchedulerRun (ParallelForRoot, &Bench);
+  Parallel    = MAX (ElapsedMicroseconds (Start), 1);
+  if (EFI_ERROR (Status)) {
+    Print (L"TaskSchedulerRun: %r\n", Status);
+    goto Done;
+  }
+
+  Print (
+    L"Parallel, %4d workers: %8ld us, speedup %ld.%02ld, %a\n",
+    Bench.WorkerCount,
+    Parallel,
+    DivU64x64Remainder (Serial, Parallel, NULL),
+    DivU64x64Remainder (MultU64x32 (Serial, 100), Parallel, NULL) % 100,
+    CheckResults (Bench.Results) ? "correct" : "WRONG"
+    );
+
+  ZeroMem (Bench.Results, BENCH_ITEMS * sizeof (UINT32));
+  Bench.Grain = 1;
+  Start       = GetPerformanceCounter ();
+  Status      = TaskSchedulerRun (ParallelForRoot, &Bench);
+  Parallel    = MAX (ElapsedMicroseconds (Start), 1);
+  Print (
+    L"Grain of 1 item:       %8ld us, speedup %ld.%02ld, %a\n",
+    Parallel,
+    DivU64x64Remainder (Serial, Parallel, NULL),
+    DivU64x64Remainder (MultU64x32 (Serial, 100), Parallel, NULL) % 100,
+    CheckResults (Bench.Results) ? "correct" : "WRONG"
+    );
+
+  Start    = GetPerformanceCounter ();
+  Status   = TaskSchedulerRun (SpawnRoot, NULL);
+  Parallel = ElapsedMicroseconds (Start);
+  Print (
+    L"%d empty tasks:    %8ld us, %ld ns per task\n",
+    BENCH_TASKS,
+    Parallel,
+    DivU64x32 (MultU64x32 (Parallel, 1000), BENCH_TASKS)
+    );
+
+Done:
+  FreePool (Bench.Results);
+  return Status;
+}
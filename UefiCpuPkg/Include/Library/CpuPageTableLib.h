@@ -111,6 +111,65 @@ PageTableMap (
   OUT    BOOLEAN             *IsModified   OPTIONAL
   );
 
+///
+/// A linear address range and the attribute to map it with, one of the requests of PageTableMapBatch().
+///
+typedef struct {
+  UINT64                LinearAddress;
+  UINT64                Length;
+  IA32_MAP_ATTRIBUTE    Attribute;
+  IA32_MAP_ATTRIBUTE    Mask;
+} IA32_MAP_REQUEST;
+
+/**
+  Create or update page table to map multiple linear address ranges with their specified attributes,
+  and replace the page directories and page tables mapping the ranges with 2M or 1G pages where
+  all their entries end up mapping a contiguous physical range with the same attributes.
+
+  Each request is applied as PageTableMap() would apply it. The function doesn't flush the TLB, the caller
+  flushes it once after the function returns with IsModified TRUE.
+
+  The page directories and page tables replaced by 2M or 1G pages that were the last ones allocated from
+  Buffer by this call are returned to it, and BufferSize includes them on return. The other ones are not
+  referenced any more but they are not freed, they stay in the buffers supplied by the caller. The caller
+  must flush the TLB before the memory returned to Buffer is reused.
+
+  @param[in, out] PageTable      The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
+                                 If not pointer to NULL, the value it points to won't be changed in this function.
+  @param[in]      PagingMode     The paging mode.
+  @param[in]      Buffer         The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize     The buffer size.
+                                 On return, the remaining buffer size.
+                                 The free buffer is used from the end so caller can supply the same Buffer pointer with an updated
+                                 BufferSize in the second call to this API.
+  @param[in]      Requests       The requests, sorted by linear address. The linear address ranges cannot overlap.
+  @param[in]      RequestCount   The number of requests.
+  @param[out]     IsModified     TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
+                                 If the output IsModified is FALSE, there is possibility that the page table is changed by hardware. It is ok
+                                 because page table can be changed by hardware anytime, and caller don't need to Flush TLB.
+
+  @retval RETURN_UNSUPPORTED        PagingMode is not supported.
+  @retval RETURN_INVALID_PARAMETER  PageTable or BufferSize is NULL, or Requests is NULL and RequestCount is not 0.
+  @retval RETURN_INVALID_PARAMETER  The requests are not sorted by linear address or overlap.
+  @retval RETURN_INVALID_PARAMETER  The Attribute and Mask of a request are invalid, as for PageTableMap().
+  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
+                                    BufferSize is updated to indicate the expected buffer size.
+                                    The page table is not modified.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or the lengths of all requests are 0.
+**/
+RETURN_STATUS
+EFIAPI
+PageTableMapBatch (
+  IN OUT UINTN             *PageTable  OPTIONAL,
+  IN     PAGING_MODE       PagingMode,
+  IN     VOID              *Buffer,
+  IN OUT UINTN             *BufferSize,
+  IN     IA32_MAP_REQUEST  *Requests,
+  IN     UINTN             RequestCount,
+  OUT    BOOLEAN           *IsModified   OPTIONAL
+  );
+
 typedef struct {
   UINT64                LinearAddress;
   UINT64                Length;
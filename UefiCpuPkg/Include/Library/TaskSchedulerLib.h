@@ -0,0 +1,182 @@
+/** @file
+  Task scheduler running fine-grained tasks on all the enabled processors.
+
+  TaskSchedulerRun() starts a worker on every enabled processor and runs the
+  root task on the BSP. The tasks spawn other tasks with TaskSpawn(), which
+  are pushed on the queue of the processor spawning them, and the idle workers
+  steal the oldest tasks of the queues of the other workers. TaskWait() waits
+  for the completion of the tasks attached to a TASK_FUTURE, running tasks in
+  the meantime. TaskParallelFor() splits a range of indexes in tasks.
+
+  The tasks run on the APs, they must follow the rules of the procedures given
+  to the MP services: no boot service or PEI service can be called.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef TASK_SCHEDULER_LIB_H_
+#define TASK_SCHEDULER_LIB_H_
+
+typedef struct _TASK_SCHEDULER TASK_SCHEDULER;
+
+///
+/// Completion of a group of tasks. It must be zeroed before the first task is
+/// spawned with it.
+///
+typedef struct {
+  volatile UINT32    Pending;        ///< The number of tasks not completed.
+} TASK_FUTURE;
+
+/**
+  Procedure of a task.
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Context    The context given when the task was spawned.
+**/
+typedef
+VOID
+(EFIAPI *TASK_PROCEDURE)(
+  IN TASK_SCHEDULER  *Scheduler,
+  IN VOID            *Context
+  );
+
+/**
+  Procedure of the tasks of TaskParallelFor(), called for a part of the range.
+
+  @param[in] Scheduler  The scheduler running the task.
+  @param[in] Start      The first index of the part.
+  @param[in] End        The index following the last index of the part.
+  @param[in] Context    The context given to TaskParallelFor().
+**/
+typedef
+VOID
+(EFIAPI *TASK_RANGE_PROCEDURE)(
+  IN TASK_SCHEDULER  *Scheduler,
+  IN UINTN           Start,
+  IN UINTN           End,
+  IN VOID            *Context
+  );
+
+/**
+  Run a root task on the BSP with all the enabled processors as workers, and
+  return when the root task and all the tasks it spawned are completed.
+
+  The function must be called on the BSP, while the APs are idle. The tasks
+  run on a single processor if the MP services are not available, or in DXE
+  if the caller is at TPL_NOTIFY or above.
+
+  @param[in] Procedure  The procedure of the root task.
+  @param[in] Context    The context of the root task.
+
+  @retval EFI_SUCCESS            All the tasks are completed.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES   The scheduler cannot be allocated.
+  @retval EFI_NOT_READY          The APs are busy.
+**/
+EFI_STATUS
+EFIAPI
+TaskSchedulerRun (
+  IN TASK_PROCEDURE  Procedure,
+  IN VOID            *Context OPTIONAL
+  );
+
+/**
+  Spawn a task, to be run by the current processor or stolen by another one.
+
+  The task is run immediately if the queue of the current processor is full.
+
+  @param[in]      Scheduler  The scheduler running the current task.
+  @param[in, out] Future     The future completed with the task.
+  @param[in]      Procedure  The procedure of the task.
+  @param[in]      Context    The context of the task.
+**/
+VOID
+EFIAPI
+TaskSpawn (
+  IN     TASK_SCHEDULER  *Scheduler,
+  IN OUT TASK_FUTURE     *Future,
+  IN     TASK_PROCEDURE  Procedure,
+  IN     VOID            *Context OPTIONAL
+  );
+
+/**
+  Wait for the completion of the tasks of a future, running the queued tasks
+  and stealing tasks while they are not completed.
+
+  @param[in] Scheduler  The scheduler running the current task.
+  @param[in] Future     The future to wait for.
+**/
+VOID
+EFIAPI
+TaskWait (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN TASK_FUTURE     *Future
+  );
+
+/**
+  Check if the tasks of a future are completed.
+
+  @param[in] Future  The future.
+
+  @retval TRUE   All the tasks of the future are completed.
+  @retval FALSE  Some tasks of the future are not completed.
+**/
+BOOLEAN
+EFIAPI
+TaskIsCompleted (
+  IN TASK_FUTURE  *Future
+  );
+
+/**
+  Run a procedure on all the indexes of a range, split in parts of at most
+  Grain indexes run in parallel, and return when all the parts are completed.
+
+  @param[in] Scheduler  The scheduler running the current task.
+  @param[in] Start      The first index of the range.
+  @param[in] End        The index following the last index of the range.
+  @param[in] Grain      The maximum number of indexes of a part, 0 to split
+                        the range in a few parts per worker.
+  @param[in] Procedure  The procedure run on the parts.
+  @param[in] Context    The context given to the procedure.
+**/
+VOID
+EFIAPI
+TaskParallelFor (
+  IN TASK_SCHEDULER        *Scheduler,
+  IN UINTN                 Start,
+  IN UINTN                 End,
+  IN UINTN                 Grain,
+  IN TASK_RANGE_PROCEDURE  Procedure,
+  IN VOID                  *Context OPTIONAL
+  );
+
+/**
+  Get the number of workers of the scheduler, the number of enabled processors.
+
+  @param[in] Scheduler  The scheduler running the current task.
+
+  @return The number of workers.
+**/
+UINTN
+EFIAPI
+TaskGetWorkerCount (
+  IN TASK_SCHEDULER  *Scheduler
+  );
+
+/**
+  Get the index of the worker running the current task, lower than the number
+  of workers. The BSP is the worker 0.
+
+  @param[in] Scheduler  The scheduler running the current task.
+
+  @return The index of the worker.
+**/
+UINTN
+EFIAPI
+TaskGetWorkerIndex (
+  IN TASK_SCHEDULER  *Scheduler
+  );
+
+#endif
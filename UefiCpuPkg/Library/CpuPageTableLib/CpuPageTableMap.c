@@ -648,7 +648,159 @@ PageTableLibMapInLevel (
 }
 
 /**
-  Create or update page table to map [LinearAddress, LinearAddress + Length) with specified attribute.
+  Check if all the entries of a page directory or page table are present leaf entries mapping
+  a contiguous physical range, aligned on the length of the region mapped by the page directory
+  or page table, with the same attributes.
+
+  @param[in]  PagingEntry      Pointer to the page directory or page table.
+  @param[in]  Level            Page table level of the entries. Could be 2 or 1.
+  @param[in]  ParentAttribute  The accumulated attribute of all parents' attribute.
+  @param[out] LeafAttribute    Return the attribute of a leaf entry mapping the entire region
+                               when the function returns TRUE.
+
+  @retval TRUE   The entries can be replaced by one leaf entry.
+  @retval FALSE  The entries cannot be replaced by one leaf entry.
+**/
+BOOLEAN
+PageTableLibIsUniformInLevel (
+  IN  IA32_PAGING_ENTRY   *PagingEntry,
+  IN  IA32_PAGE_LEVEL     Level,
+  IN  IA32_MAP_ATTRIBUTE  *ParentAttribute,
+  OUT IA32_MAP_ATTRIBUTE  *LeafAttribute
+  )
+{
+  UINTN               Index;
+  UINT64              RegionLength;
+  IA32_MAP_ATTRIBUTE  Attribute;
+
+  RegionLength = REGION_LENGTH (Level);
+  for (Index = 0; Index < 512; Index++) {
+    if ((PagingEntry[Index].Pce.Present == 0) || !IsPle (&PagingEntry[Index], Level)) {
+      return FALSE;
+    }
+
+    if (Level == 1) {
+      Attribute.Uint64 = PageTableLibGetPte4KMapAttribute (&PagingEntry[Index].Pte4K, ParentAttribute);
+    } else {
+      Attribute.Uint64 = PageTableLibGetPleBMapAttribute (&PagingEntry[Index].PleB, ParentAttribute);
+    }
+
+    if (Index == 0) {
+      if ((IA32_MAP_ATTRIBUTE_PAGE_TABLE_BASE_ADDRESS (&Attribute) & (REGION_LENGTH (Level + 1) - 1)) != 0) {
+        return FALSE;
+      }
+
+      LeafAttribute->Uint64 = Attribute.Uint64;
+    } else if (Attribute.Uint64 != LeafAttribute->Uint64 + MultU64x32 (RegionLength, (UINT32)Index)) {
+      //
+      // The physical address is in the PageTableBaseAddress field, so the attribute of the
+      // entry differs from the first one by the offset of the entry only.
+      //
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/**
+  Replace the page directories and page tables that map [LinearAddress, LinearAddress + Length)
+  with 2M or 1G leaf entries when all their entries map a contiguous physical range with the same attributes.
+
+  The page directories are processed from the lowest level so that a page directory whose page tables
+  are all replaced by 2M leaf entries can be replaced by a 1G leaf entry.
+
+  PageTableLibMapInLevel() allocates the page tables from the end of the buffer in the order of the
+  linear addresses. The entries are processed from the last one so that the replaced page tables that
+  were the last ones allocated from the buffer are returned to it. The other replaced page tables are
+  no longer referenced and stay in the buffers supplied by the caller, as the library cannot track the
+  owner of memory it did not allocate.
+
+  @param[in]      PagingEntry       Pointer to the page table entries of Level.
+  @param[in]      ParentAttribute   The accumulated attribute of all parents' attribute.
+  @param[in]      Level             Page table level. Could be 5, 4, 3, or 2.
+  @param[in]      MaxLeafLevel      Maximum level that can be a leaf entry. Could be 1, 2 or 3 (if Page 1G is supported).
+  @param[in]      LinearAddress     The start of the linear address range.
+                                    The range is within the region mapped by PagingEntry.
+  @param[in]      Length            The length of the linear address range.
+  @param[in]      Buffer            The buffer the page tables were allocated from.
+  @param[in]      MaxBufferSize     The size of the buffer when supplied by the caller.
+  @param[in, out] BufferSize        The remaining buffer size, increased by the size of the page tables returned to the buffer.
+  @param[in, out] IsModified        Change IsModified to TRUE if page table is modified.
+**/
+VOID
+PageTableLibPromoteInLevel (
+  IN     IA32_PAGING_ENTRY   *PagingEntry,
+  IN     IA32_MAP_ATTRIBUTE  *ParentAttribute,
+  IN     IA32_PAGE_LEVEL     Level,
+  IN     IA32_PAGE_LEVEL     MaxLeafLevel,
+  IN     UINT64              LinearAddress,
+  IN     UINT64              Length,
+  IN     VOID                *Buffer,
+  IN     UINTN               MaxBufferSize,
+  IN OUT UINTN               *BufferSize,
+  IN OUT BOOLEAN             *IsModified
+  )
+{
+  UINTN               BitStart;
+  UINTN               Index;
+  UINTN               PagingEntryIndexStart;
+  UINTN               PagingEntryIndexEnd;
+  UINT64              RegionLength;
+  UINT64              RegionStart;
+  UINT64              SubStart;
+  UINT64              SubEnd;
+  IA32_PAGING_ENTRY   *ChildPagingEntry;
+  IA32_MAP_ATTRIBUTE  ChildAttribute;
+  IA32_MAP_ATTRIBUTE  LeafAttribute;
+  IA32_MAP_ATTRIBUTE  AllOneMask;
+  IA32_PAGING_ENTRY   TempPagingEntry;
+
+  ASSERT (Level > 1);
+
+  AllOneMask.Uint64 = MAX_UINT64;
+
+  BitStart              = 12 + (Level - 1) * 9;
+  RegionLength          = REGION_LENGTH (Level);
+  PagingEntryIndexStart = (UINTN)BitFieldRead64 (LinearAddress, BitStart, BitStart + 9 - 1);
+  PagingEntryIndexEnd   = (BitFieldRead64 (LinearAddress + Length - 1, BitStart + 9, 63) != BitFieldRead64 (LinearAddress, BitStart + 9, 63)) ? 511 :
+                          (UINTN)BitFieldRead64 (LinearAddress + Length - 1, BitStart, BitStart + 9 - 1);
+
+  for (Index = PagingEntryIndexEnd + 1; Index-- > PagingEntryIndexStart;) {
+    if ((PagingEntry[Index].Pce.Present == 0) || IsPle (&PagingEntry[Index], Level)) {
+      continue;
+    }
+
+    RegionStart = (LinearAddress & ~(RegionLength - 1)) + LShiftU64 (Index - PagingEntryIndexStart, BitStart);
+
+    ChildAttribute.Uint64 = PageTableLibGetPnleMapAttribute (&PagingEntry[Index].Pnle, ParentAttribute);
+    ChildPagingEntry      = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry[Index].Pnle);
+
+    if (Level - 1 > Pte) {
+      SubStart = MAX (LinearAddress, RegionStart);
+      SubEnd   = MIN (LinearAddress + Length, RegionStart + RegionLength);
+      PageTableLibPromoteInLevel (ChildPagingEntry, &ChildAttribute, Level - 1, MaxLeafLevel, SubStart, SubEnd - SubStart, Buffer, MaxBufferSize, BufferSize, IsModified);
+    }
+
+    if ((Level <= MaxLeafLevel) && PageTableLibIsUniformInLevel (ChildPagingEntry, Level - 1, &ChildAttribute, &LeafAttribute)) {
+      //
+      // The attributes inherited from the parents are already part of LeafAttribute,
+      // which is hence also the attribute to set in the leaf entry.
+      //
+      TempPagingEntry.Uint64 = 0;
+      PageTableLibSetPle (Level, &TempPagingEntry, 0, &LeafAttribute, &AllOneMask);
+      *(volatile UINT64 *)&(PagingEntry[Index].Uint64) = TempPagingEntry.Uint64;
+      *IsModified                                      = TRUE;
+
+      if ((*BufferSize < MaxBufferSize) && ((UINTN)ChildPagingEntry == (UINTN)Buffer + *BufferSize)) {
+        *BufferSize += SIZE_4KB;
+      }
+    }
+  }
+}
+
+/**
+  Create or update page table to map the linear address ranges of the requests with their specified attributes.
 
   @param[in, out] PageTable      The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
                                  If not pointer to NULL, the value it points to won't be changed in this function.
@@ -656,61 +808,46 @@ PageTableLibMapInLevel (
   @param[in]      Buffer         The free buffer to be used for page table creation/updating.
   @param[in, out] BufferSize     The buffer size.
                                  On return, the remaining buffer size.
-                                 The free buffer is used from the end so caller can supply the same Buffer pointer with an updated
-                                 BufferSize in the second call to this API.
-  @param[in]      LinearAddress  The start of the linear address range.
-  @param[in]      Length         The length of the linear address range.
-  @param[in]      Attribute      The attribute of the linear address range.
-                                 All non-reserved fields in IA32_MAP_ATTRIBUTE are supported to set in the page table.
-                                 Page table entries that map the linear address range are reset to 0 before set to the new attribute
-                                 when a new physical base address is set.
-  @param[in]      Mask           The mask used for attribute. The corresponding field in Attribute is ignored if that in Mask is 0.
+  @param[in]      Requests       The requests, sorted by linear address. The linear address ranges cannot overlap.
+  @param[in]      RequestCount   The number of requests.
+  @param[in]      Promote        TRUE to replace the page directories and page tables that map the ranges with 2M or 1G
+                                 leaf entries when possible.
   @param[out]     IsModified     TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
-                                 If the output IsModified is FALSE, there is possibility that the page table is changed by hardware. It is ok
-                                 because page table can be changed by hardware anytime, and caller don't need to Flush TLB.
 
   @retval RETURN_UNSUPPORTED        PagingMode is not supported.
-  @retval RETURN_INVALID_PARAMETER  PageTable, BufferSize, Attribute or Mask is NULL.
-  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 0 but some other attributes are provided.
-  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 1 but some other attributes are not provided.
-  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 0 but some other attributes are provided.
-  @retval RETURN_INVALID_PARAMETER  For present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 0 but some other attributes are provided.
-  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_INVALID_PARAMETER  The parameters are invalid, see PageTableMap() and PageTableMapBatch().
   @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
                                     BufferSize is updated to indicate the expected buffer size.
-                                    Caller may still get RETURN_BUFFER_TOO_SMALL with the new BufferSize.
-  @retval RETURN_SUCCESS            PageTable is created/updated successfully or the input Length is 0.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or the lengths of all requests are 0.
 **/
 RETURN_STATUS
-EFIAPI
-PageTableMap (
-  IN OUT UINTN               *PageTable  OPTIONAL,
-  IN     PAGING_MODE         PagingMode,
-  IN     VOID                *Buffer,
-  IN OUT UINTN               *BufferSize,
-  IN     UINT64              LinearAddress,
-  IN     UINT64              Length,
-  IN     IA32_MAP_ATTRIBUTE  *Attribute,
-  IN     IA32_MAP_ATTRIBUTE  *Mask,
-  OUT    BOOLEAN             *IsModified   OPTIONAL
+PageTableLibMapRequests (
+  IN OUT UINTN             *PageTable  OPTIONAL,
+  IN     PAGING_MODE       PagingMode,
+  IN     VOID              *Buffer,
+  IN OUT UINTN             *BufferSize,
+  IN     IA32_MAP_REQUEST  *Requests,
+  IN     UINTN             RequestCount,
+  IN     BOOLEAN           Promote,
+  OUT    BOOLEAN           *IsModified   OPTIONAL
   )
 {
   RETURN_STATUS       Status;
   IA32_PAGING_ENTRY   TopPagingEntry;
   INTN                RequiredSize;
   UINT64              MaxLinearAddress;
+  UINT64              LinearAddress;
+  UINT64              Length;
   IA32_PAGE_LEVEL     MaxLevel;
   IA32_PAGE_LEVEL     MaxLeafLevel;
   IA32_MAP_ATTRIBUTE  ParentAttribute;
   BOOLEAN             LocalIsModified;
   UINTN               Index;
+  UINTN               MaxBufferSize;
   IA32_PAGING_ENTRY   *PagingEntry;
+  IA32_MAP_REQUEST    *Request;
   UINT8               BufferInStack[SIZE_4KB - 1 + MAX_PAE_PDPTE_NUM * sizeof (IA32_PAGING_ENTRY)];
 
-  if (Length == 0) {
-    return RETURN_SUCCESS;
-  }
-
   if ((PagingMode == Paging32bit) || (PagingMode >= PagingModeMax)) {
     //
     // 32bit paging is never supported.
@@ -718,7 +855,7 @@ PageTableMap (
     return RETURN_UNSUPPORTED;
   }
 
-  if ((PageTable == NULL) || (BufferSize == NULL) || (Attribute == NULL) || (Mask == NULL)) {
+  if ((PageTable == NULL) || (BufferSize == NULL)) {
     return RETURN_INVALID_PARAMETER;
   }
 
@@ -729,34 +866,57 @@ PageTableMap (
     return RETURN_INVALID_PARAMETER;
   }
 
-  if (((UINTN)LinearAddress % SIZE_4KB != 0) || ((UINTN)Length % SIZE_4KB != 0)) {
-    //
-    // LinearAddress and Length should be multiple of 4K.
-    //
-    return RETURN_INVALID_PARAMETER;
-  }
-
   if ((*BufferSize != 0) && (Buffer == NULL)) {
     return RETURN_INVALID_PARAMETER;
   }
 
-  //
-  // If to map [LinearAddress, LinearAddress + Length] as non-present,
-  // all attributes except Present should not be provided.
-  //
-  if ((Attribute->Bits.Present == 0) && (Mask->Bits.Present == 1) && (Mask->Uint64 > 1)) {
-    return RETURN_INVALID_PARAMETER;
-  }
-
   MaxLeafLevel     = (IA32_PAGE_LEVEL)(UINT8)PagingMode;
   MaxLevel         = (IA32_PAGE_LEVEL)(UINT8)(PagingMode >> 8);
   MaxLinearAddress = (PagingMode == PagingPae) ? LShiftU64 (1, 32) : LShiftU64 (1, 12 + MaxLevel * 9);
 
-  if ((LinearAddress > MaxLinearAddress) || (Length > MaxLinearAddress - LinearAddress)) {
+  LinearAddress = 0;
+  Length        = 0;
+  for (Index = 0; Index < RequestCount; Index++) {
+    Request = &Requests[Index];
+    if (Request->Length == 0) {
+      continue;
+    }
+
+    if (((UINTN)Request->LinearAddress % SIZE_4KB != 0) || ((UINTN)Request->Length % SIZE_4KB != 0)) {
+      //
+      // LinearAddress and Length should be multiple of 4K.
+      //
+      return RETURN_INVALID_PARAMETER;
+    }
+
     //
-    // Maximum linear address is (1 << 32), (1 << 48) or (1 << 57)
+    // If to map [LinearAddress, LinearAddress + Length] as non-present,
+    // all attributes except Present should not be provided.
     //
-    return RETURN_INVALID_PARAMETER;
+    if ((Request->Attribute.Bits.Present == 0) && (Request->Mask.Bits.Present == 1) && (Request->Mask.Uint64 > 1)) {
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if ((Request->LinearAddress > MaxLinearAddress) || (Request->Length > MaxLinearAddress - Request->LinearAddress)) {
+      //
+      // Maximum linear address is (1 << 32), (1 << 48) or (1 << 57)
+      //
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    if ((Length != 0) && (Request->LinearAddress < LinearAddress + Length)) {
+      //
+      // The requests should be sorted and should not overlap.
+      //
+      return RETURN_INVALID_PARAMETER;
+    }
+
+    LinearAddress = Request->LinearAddress;
+    Length        = Request->Length;
+  }
+
+  if (Length == 0) {
+    return RETURN_SUCCESS;
   }
 
   TopPagingEntry.Uintn = *PageTable;
@@ -797,26 +957,35 @@ PageTableMap (
 
   //
   // Query the required buffer size without modifying the page table.
+  // Each request is queried against the page table before any request is applied. Applying a request
+  // only adds page directories and page tables, so the sum is enough for all the requests.
   //
   RequiredSize = 0;
-  Status       = PageTableLibMapInLevel (
-                   &TopPagingEntry,
-                   &ParentAttribute,
-                   FALSE,
-                   NULL,
-                   &RequiredSize,
-                   MaxLevel,
-                   MaxLeafLevel,
-                   LinearAddress,
-                   Length,
-                   0,
-                   Attribute,
-                   Mask,
-                   IsModified
-                   );
-  ASSERT (*IsModified == FALSE);
-  if (RETURN_ERROR (Status)) {
-    return Status;
+  for (Index = 0; Index < RequestCount; Index++) {
+    Request = &Requests[Index];
+    if (Request->Length == 0) {
+      continue;
+    }
+
+    Status = PageTableLibMapInLevel (
+               &TopPagingEntry,
+               &ParentAttribute,
+               FALSE,
+               NULL,
+               &RequiredSize,
+               MaxLevel,
+               MaxLeafLevel,
+               Request->LinearAddress,
+               Request->Length,
+               0,
+               &Request->Attribute,
+               &Request->Mask,
+               IsModified
+               );
+    ASSERT (*IsModified == FALSE);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
   }
 
   RequiredSize = -RequiredSize;
@@ -833,25 +1002,67 @@ PageTableMap (
   //
   // Update the page table when the supplied buffer is sufficient.
   //
-  Status = PageTableLibMapInLevel (
-             &TopPagingEntry,
-             &ParentAttribute,
-             TRUE,
-             Buffer,
-             (INTN *)BufferSize,
-             MaxLevel,
-             MaxLeafLevel,
-             LinearAddress,
-             Length,
-             0,
-             Attribute,
-             Mask,
-             IsModified
-             );
+  Status        = RETURN_SUCCESS;
+  MaxBufferSize = *BufferSize;
+  for (Index = 0; Index < RequestCount; Index++) {
+    Request = &Requests[Index];
+    if (Request->Length == 0) {
+      continue;
+    }
+
+    Status = PageTableLibMapInLevel (
+               &TopPagingEntry,
+               &ParentAttribute,
+               TRUE,
+               Buffer,
+               (INTN *)BufferSize,
+               MaxLevel,
+               MaxLeafLevel,
+               Request->LinearAddress,
+               Request->Length,
+               0,
+               &Request->Attribute,
+               &Request->Mask,
+               IsModified
+               );
+    if (RETURN_ERROR (Status)) {
+      break;
+    }
+  }
 
   if (!RETURN_ERROR (Status)) {
     PagingEntry = (IA32_PAGING_ENTRY *)(UINTN)(TopPagingEntry.Uintn & IA32_PE_BASE_ADDRESS_MASK_40);
 
+    if (Promote && (TopPagingEntry.Pce.Present == 1)) {
+      //
+      // Walk the ranges of the requests once all of them are applied, the adjacent ranges together.
+      // The ranges are walked from the last one so that the page tables replaced by large pages are
+      // returned to the buffer in the reverse order of their allocation.
+      //
+      for (Index = RequestCount, Length = 0; Index-- > 0;) {
+        if (Requests[Index].Length == 0) {
+          continue;
+        }
+
+        if ((Length != 0) && (Requests[Index].LinearAddress + Requests[Index].Length == LinearAddress)) {
+          LinearAddress = Requests[Index].LinearAddress;
+          Length       += Requests[Index].Length;
+          continue;
+        }
+
+        if (Length != 0) {
+          PageTableLibPromoteInLevel (PagingEntry, &ParentAttribute, MaxLevel, MaxLeafLevel, LinearAddress, Length, Buffer, MaxBufferSize, BufferSize, IsModified);
+        }
+
+        LinearAddress = Requests[Index].LinearAddress;
+        Length        = Requests[Index].Length;
+      }
+
+      if (Length != 0) {
+        PageTableLibPromoteInLevel (PagingEntry, &ParentAttribute, MaxLevel, MaxLeafLevel, LinearAddress, Length, Buffer, MaxBufferSize, BufferSize, IsModified);
+      }
+    }
+
     if (PagingMode == PagingPae) {
       //
       // These MustBeZero fields are treated as RW and other attributes by the common map logic. So they might be set to 1.
@@ -881,3 +1092,124 @@ PageTableMap (
 
   return Status;
 }
+
+/**
+  Create or update page table to map [LinearAddress, LinearAddress + Length) with specified attribute.
+
+  @param[in, out] PageTable      The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
+                                 If not pointer to NULL, the value it points to won't be changed in this function.
+  @param[in]      PagingMode     The paging mode.
+  @param[in]      Buffer         The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize     The buffer size.
+                                 On return, the remaining buffer size.
+                                 The free buffer is used from the end so caller can supply the same Buffer pointer with an updated
+                                 BufferSize in the second call to this API.
+  @param[in]      LinearAddress  The start of the linear address range.
+  @param[in]      Length         The length of the linear address range.
+  @param[in]      Attribute      The attribute of the linear address range.
+                                 All non-reserved fields in IA32_MAP_ATTRIBUTE are supported to set in the page table.
+                                 Page table entries that map the linear address range are reset to 0 before set to the new attribute
+                                 when a new physical base address is set.
+  @param[in]      Mask           The mask used for attribute. The corresponding field in Attribute is ignored if that in Mask is 0.
+  @param[out]     IsModified     TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
+                                 If the output IsModified is FALSE, there is possibility that the page table is changed by hardware. It is ok
+                                 because page table can be changed by hardware anytime, and caller don't need to Flush TLB.
+
+  @retval RETURN_UNSUPPORTED        PagingMode is not supported.
+  @retval RETURN_INVALID_PARAMETER  PageTable, BufferSize, Attribute or Mask is NULL.
+  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 0 but some other attributes are provided.
+  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 1 but some other attributes are not provided.
+  @retval RETURN_INVALID_PARAMETER  For non-present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 0 but some other attributes are provided.
+  @retval RETURN_INVALID_PARAMETER  For present range, Mask->Bits.Present is 1, Attribute->Bits.Present is 0 but some other attributes are provided.
+  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
+                                    BufferSize is updated to indicate the expected buffer size.
+                                    Caller may still get RETURN_BUFFER_TOO_SMALL with the new BufferSize.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or the input Length is 0.
+**/
+RETURN_STATUS
+EFIAPI
+PageTableMap (
+  IN OUT UINTN               *PageTable  OPTIONAL,
+  IN     PAGING_MODE         PagingMode,
+  IN     VOID                *Buffer,
+  IN OUT UINTN               *BufferSize,
+  IN     UINT64              LinearAddress,
+  IN     UINT64              Length,
+  IN     IA32_MAP_ATTRIBUTE  *Attribute,
+  IN     IA32_MAP_ATTRIBUTE  *Mask,
+  OUT    BOOLEAN             *IsModified   OPTIONAL
+  )
+{
+  IA32_MAP_REQUEST  Request;
+
+  if (Length == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  if ((Attribute == NULL) || (Mask == NULL)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  Request.LinearAddress = LinearAddress;
+  Request.Length        = Length;
+  Request.Attribute     = *Attribute;
+  Request.Mask          = *Mask;
+  return PageTableLibMapRequests (PageTable, PagingMode, Buffer, BufferSize, &Request, 1, FALSE, IsModified);
+}
+
+/**
+  Create or update page table to map multiple linear address ranges with their specified attributes,
+  and replace the page directories and page tables mapping the ranges with 2M or 1G pages where
+  all their entries end up mapping a contiguous physical range with the same attributes.
+
+  Each request is applied as PageTableMap() would apply it. The function doesn't flush the TLB, the caller
+  flushes it once after the function returns with IsModified TRUE.
+
+  The page directories and page tables replaced by 2M or 1G pages that were the last ones allocated from
+  Buffer by this call are returned to it, and BufferSize includes them on return. The other ones are not
+  referenced any more but they are not freed, they stay in the buffers supplied by the caller. The caller
+  must flush the TLB before the memory returned to Buffer is reused.
+
+  @param[in, out] PageTable      The pointer to the page table to update, or pointer to NULL if a new page table is to be created.
+                                 If not pointer to NULL, the value it points to won't be changed in this function.
+  @param[in]      PagingMode     The paging mode.
+  @param[in]      Buffer         The free buffer to be used for page table creation/updating.
+  @param[in, out] BufferSize     The buffer size.
+                                 On return, the remaining buffer size.
+                                 The free buffer is used from the end so caller can supply the same Buffer pointer with an updated
+                                 BufferSize in the second call to this API.
+  @param[in]      Requests       The requests, sorted by linear address. The linear address ranges cannot overlap.
+  @param[in]      RequestCount   The number of requests.
+  @param[out]     IsModified     TRUE means page table is modified by software or hardware. FALSE means page table is not modified by software.
+                                 If the output IsModified is FALSE, there is possibility that the page table is changed by hardware. It is ok
+                                 because page table can be changed by hardware anytime, and caller don't need to Flush TLB.
+
+  @retval RETURN_UNSUPPORTED        PagingMode is not supported.
+  @retval RETURN_INVALID_PARAMETER  PageTable or BufferSize is NULL, or Requests is NULL and RequestCount is not 0.
+  @retval RETURN_INVALID_PARAMETER  The requests are not sorted by linear address or overlap.
+  @retval RETURN_INVALID_PARAMETER  The Attribute and Mask of a request are invalid, as for PageTableMap().
+  @retval RETURN_INVALID_PARAMETER  *BufferSize is not multiple of 4KB.
+  @retval RETURN_BUFFER_TOO_SMALL   The buffer is too small for page table creation/updating.
+                                    BufferSize is updated to indicate the expected buffer size.
+                                    The page table is not modified.
+  @retval RETURN_SUCCESS            PageTable is created/updated successfully or the lengths of all requests are 0.
+**/
+RETURN_STATUS
+EFIAPI
+PageTableMapBatch (
+  IN OUT UINTN             *PageTable  OPTIONAL,
+  IN     PAGING_MODE       PagingMode,
+  IN     VOID              *Buffer,
+  IN OUT UINTN             *BufferSize,
+  IN     IA32_MAP_REQUEST  *Requests,
+  IN     UINTN             RequestCount,
+  OUT    BOOLEAN           *IsModified   OPTIONAL
+  )
+{
+  if ((Requests == NULL) && (RequestCount != 0)) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  return PageTableLibMapRequests (PageTable, PagingMode, Buffer, BufferSize, Requests, RequestCount, TRUE, IsModified);
+}
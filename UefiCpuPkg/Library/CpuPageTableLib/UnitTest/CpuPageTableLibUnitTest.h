@@ -50,6 +50,11 @@
 //
 #define USE_RANDOM_ARRAY  0x00000004
 
+//
+// Map the random ranges in batches with function PageTableMapBatch, and compare with function PageTableMap
+//
+#define BATCH_MAP  0x00000008
+
 typedef struct {
   PAGING_MODE    PagingMode;
   UINTN          TestCount;
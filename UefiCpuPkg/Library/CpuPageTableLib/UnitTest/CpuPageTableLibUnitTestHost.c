@@ -14,6 +14,10 @@
 // static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextPaging5Level    = { Paging5Level, 30, 20, USE_RANDOM_ARRAY };
 // static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextPaging5Level1GB = { Paging5Level1GB, 30, 20, USE_RANDOM_ARRAY };
 // static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextPagingPae       = { PagingPae, 30, 20, USE_RANDOM_ARRAY };
+static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextBatchPaging4Level    = { Paging4Level, 5, 10, USE_RANDOM_ARRAY | BATCH_MAP };
+static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextBatchPaging4Level1GB = { Paging4Level1GB, 5, 10, USE_RANDOM_ARRAY | ONLY_ONE_ONE_MAPPING | BATCH_MAP };
+static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextBatchPaging5Level1GB = { Paging5Level1GB, 5, 10, USE_RANDOM_ARRAY | BATCH_MAP };
+static CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT  mTestContextBatchPagingPae       = { PagingPae, 5, 10, USE_RANDOM_ARRAY | ONLY_ONE_ONE_MAPPING | BATCH_MAP };
 
 /**
   Check if the input parameters are not supported.
@@ -821,6 +825,81 @@ TestCaseToCheckMapMaskAndAttr (
   return UNIT_TEST_PASSED;
 }
 
+/**
+  Check if the page table replaced by a 2M page is returned to the buffer.
+
+  @param[in]  Context    [Optional] An optional parameter that enables:
+                         1) test-case reuse with varied parameters and
+                         2) test-case re-entry for Target tests that need a
+                         reboot.  This parameter is a VOID* and it is the
+                         responsibility of the test author to ensure that the
+                         contents are well understood by all test cases that may
+                         consume it.
+
+  @retval  UNIT_TEST_PASSED             The Unit test has completed and the test
+                                        case was successful.
+  @retval  UNIT_TEST_ERROR_TEST_FAILED  A test case assertion has failed.
+**/
+UNIT_TEST_STATUS
+EFIAPI
+TestCaseManualPromoteReturnBuffer (
+  IN UNIT_TEST_CONTEXT  Context
+  )
+{
+  UINTN              PageTable;
+  PAGING_MODE        PagingMode;
+  VOID               *Buffer;
+  UINTN              PageTableBufferSize;
+  UINTN              RequiredBufferSize;
+  IA32_MAP_REQUEST   Requests[2];
+  RETURN_STATUS      Status;
+  IA32_MAP_ENTRY     Map[2];
+  UINTN              MapCount;
+  IA32_PAGING_ENTRY  *PagingEntry;
+  UINTN              Index;
+
+  //
+  // Map [0, 1M] and [1M, 2M] in a new page table, with attributes that allow a 2M page.
+  //
+  PagingMode = Paging4Level;
+  PageTable  = 0;
+  ZeroMem (Requests, sizeof (Requests));
+  for (Index = 0; Index < ARRAY_SIZE (Requests); Index++) {
+    Requests[Index].LinearAddress            = Index * SIZE_1MB;
+    Requests[Index].Length                   = SIZE_1MB;
+    Requests[Index].Attribute.Uint64         = Index * SIZE_1MB;
+    Requests[Index].Attribute.Bits.Present   = 1;
+    Requests[Index].Attribute.Bits.ReadWrite = 1;
+    Requests[Index].Mask.Uint64              = MAX_UINT64;
+  }
+
+  PageTableBufferSize = 0;
+  Status              = PageTableMapBatch (&PageTable, PagingMode, NULL, &PageTableBufferSize, Requests, ARRAY_SIZE (Requests), NULL);
+  UT_ASSERT_EQUAL (Status, RETURN_BUFFER_TOO_SMALL);
+  RequiredBufferSize = PageTableBufferSize;
+  Buffer             = AllocatePages (EFI_SIZE_TO_PAGES (PageTableBufferSize));
+  Status             = PageTableMapBatch (&PageTable, PagingMode, Buffer, &PageTableBufferSize, Requests, ARRAY_SIZE (Requests), NULL);
+  UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+
+  //
+  // The PML4, PDPT and PD stay in the buffer, the page table replaced by the 2M page is returned to it.
+  //
+  UT_ASSERT_EQUAL (PageTableBufferSize, RequiredBufferSize - 3 * SIZE_4KB);
+
+  PagingEntry = (IA32_PAGING_ENTRY *)PageTable;
+  PagingEntry = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry[0].Pnle);
+  PagingEntry = (IA32_PAGING_ENTRY *)(UINTN)IA32_PNLE_PAGE_TABLE_BASE_ADDRESS (&PagingEntry[0].Pnle);
+  UT_ASSERT_EQUAL (PagingEntry[0].PleB.Bits.MustBeOne, 1);
+
+  MapCount = ARRAY_SIZE (Map);
+  Status   = PageTableParse (PageTable, PagingMode, Map, &MapCount);
+  UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+  UT_ASSERT_EQUAL (MapCount, 1);
+  UT_ASSERT_EQUAL (Map[0].LinearAddress, 0);
+  UT_ASSERT_EQUAL (Map[0].Length, SIZE_2MB);
+  return UNIT_TEST_PASSED;
+}
+
 /**
   Initialize the unit test framework, suite, and unit tests for the
   sample unit tests and run the unit tests.
@@ -871,6 +950,7 @@ UefiTestMain (
   AddTestCase (ManualTestCase, "Check if the parent entry has different Nx attribute", "Manual Test Case6", TestCaseManualChangeNx, NULL, NULL, NULL);
   AddTestCase (ManualTestCase, "Check if the needed size is expected", "Manual Test Case7", TestCaseManualSizeNotMatch, NULL, NULL, NULL);
   AddTestCase (ManualTestCase, "Check MapMask when creating new page table or mapping not-present range", "Manual Test Case8", TestCaseToCheckMapMaskAndAttr, NULL, NULL, NULL);
+  AddTestCase (ManualTestCase, "Check the page table replaced by a large page is returned to the buffer", "Manual Test Case9", TestCaseManualPromoteReturnBuffer, NULL, NULL, NULL);
   //
   // Populate the Random Test Cases.
   //
@@ -886,6 +966,10 @@ UefiTestMain (
   // AddTestCase (RandomTestCase, "Random Test for Paging5Level", "Random Test Case3", TestCaseforRandomTest, NULL, NULL, &mTestContextPaging5Level);
   // AddTestCase (RandomTestCase, "Random Test for Paging5Level1G", "Random Test Case4", TestCaseforRandomTest, NULL, NULL, &mTestContextPaging5Level1GB);
   // AddTestCase (RandomTestCase, "Random Test for PagingPae", "Random Test Case5", TestCaseforRandomTest, NULL, NULL, &mTestContextPagingPae);
+  AddTestCase (RandomTestCase, "Random Batch Test for Paging4Level", "Random Test Case6", TestCaseforRandomTest, NULL, NULL, &mTestContextBatchPaging4Level);
+  AddTestCase (RandomTestCase, "Random Batch Test for Paging4Level1G", "Random Test Case7", TestCaseforRandomTest, NULL, NULL, &mTestContextBatchPaging4Level1GB);
+  AddTestCase (RandomTestCase, "Random Batch Test for Paging5Level1G", "Random Test Case8", TestCaseforRandomTest, NULL, NULL, &mTestContextBatchPaging5Level1GB);
+  AddTestCase (RandomTestCase, "Random Batch Test for PagingPae", "Random Test Case9", TestCaseforRandomTest, NULL, NULL, &mTestContextBatchPagingPae);
 
   //
   // Execute the tests.
@@ -1017,6 +1017,360 @@ MultipleMapEntryTest (
   return UNIT_TEST_PASSED;
 }
 
+/**
+  Sort the requests by linear address and trim them so that they don't overlap.
+  The requests that become empty are removed.
+
+  @param[in, out] Requests      The requests.
+  @param[in, out] RequestCount  The number of requests.
+**/
+VOID
+SortAndTrimRequests (
+  IN OUT IA32_MAP_REQUEST  *Requests,
+  IN OUT UINTN             *RequestCount
+  )
+{
+  UINTN             Index1;
+  UINTN             Index2;
+  UINTN             Count;
+  UINT64            End;
+  IA32_MAP_REQUEST  Request;
+
+  for (Index1 = 1; Index1 < *RequestCount; Index1++) {
+    CopyMem (&Request, &Requests[Index1], sizeof (IA32_MAP_REQUEST));
+    for (Index2 = Index1; (Index2 > 0) && (Requests[Index2 - 1].LinearAddress > Request.LinearAddress); Index2--) {
+      CopyMem (&Requests[Index2], &Requests[Index2 - 1], sizeof (IA32_MAP_REQUEST));
+    }
+
+    CopyMem (&Requests[Index2], &Request, sizeof (IA32_MAP_REQUEST));
+  }
+
+  Count = 0;
+  End   = 0;
+  for (Index1 = 0; Index1 < *RequestCount; Index1++) {
+    if (Requests[Index1].LinearAddress + Requests[Index1].Length <= End) {
+      continue;
+    }
+
+    if (Requests[Index1].LinearAddress < End) {
+      Requests[Index1].Length       -= End - Requests[Index1].LinearAddress;
+      Requests[Index1].LinearAddress = End;
+    }
+
+    End = Requests[Index1].LinearAddress + Requests[Index1].Length;
+    CopyMem (&Requests[Count], &Requests[Index1], sizeof (IA32_MAP_REQUEST));
+    Count++;
+  }
+
+  *RequestCount = Count;
+}
+
+/**
+  Check that the 2M and 1G regions within the requests, which are mapped to a contiguous physical range
+  with the same attribute, are mapped by one 2M or 1G leaf entry.
+
+  @param[in] PageTable     The pointer to the page table.
+  @param[in] PagingMode    The paging mode.
+  @param[in] Requests      The requests.
+  @param[in] RequestCount  The number of requests.
+  @param[in] Map           Pointer to an array that describes multiple linear address ranges.
+  @param[in] MapCount      The number of entries in the Map.
+
+  @retval  UNIT_TEST_PASSED  All such regions are mapped by one leaf entry.
+**/
+UNIT_TEST_STATUS
+IsPageTablePromoted (
+  IN UINTN             PageTable,
+  IN PAGING_MODE       PagingMode,
+  IN IA32_MAP_REQUEST  *Requests,
+  IN UINTN             RequestCount,
+  IN IA32_MAP_ENTRY    *Map,
+  IN UINTN             MapCount
+  )
+{
+  UINTN   Index;
+  UINTN   MapIndex;
+  UINTN   Level;
+  UINTN   RegionLevel;
+  UINT64  RegionLength;
+  UINT64  Address;
+  UINT64  End;
+
+  for (RegionLevel = 2; RegionLevel <= (UINT8)PagingMode; RegionLevel++) {
+    RegionLength = LShiftU64 (1, 12 + (RegionLevel - 1) * 9);
+    for (Index = 0; Index < RequestCount; Index++) {
+      Address = ALIGN_VALUE (Requests[Index].LinearAddress, RegionLength);
+      End     = Requests[Index].LinearAddress + Requests[Index].Length;
+      for ( ; Address + RegionLength <= End; Address += RegionLength) {
+        for (MapIndex = 0; MapIndex < MapCount; MapIndex++) {
+          if ((Address >= Map[MapIndex].LinearAddress) && (Address < Map[MapIndex].LinearAddress + Map[MapIndex].Length)) {
+            break;
+          }
+        }
+
+        if ((MapIndex == MapCount) ||
+            (Address + RegionLength > Map[MapIndex].LinearAddress + Map[MapIndex].Length) ||
+            (((IA32_MAP_ATTRIBUTE_PAGE_TABLE_BASE_ADDRESS (&Map[MapIndex].Attribute) + Address - Map[MapIndex].LinearAddress) & (RegionLength - 1)) != 0))
+        {
+          continue;
+        }
+
+        GetEntryFromPageTable (PageTable, PagingMode, Address, &Level);
+        if (Level < RegionLevel) {
+          DEBUG ((DEBUG_INFO, "Region 0x%lx with length 0x%lx is not mapped by one leaf entry\n", Address, RegionLength));
+          UT_ASSERT_TRUE (Level >= RegionLevel);
+        }
+      }
+    }
+  }
+
+  return UNIT_TEST_PASSED;
+}
+
+/**
+  Generate random ranges with random attributes, map them one by one with PageTableMap in one page table
+  and in a batch with PageTableMapBatch in another page table, and compare both page tables.
+
+  @param[in, out] PageTable     The pointer to the page table updated with PageTableMap.
+  @param[in, out] BatchTable    The pointer to the page table updated with PageTableMapBatch.
+  @param[in]      PagingMode    The paging mode.
+  @param[in]      MaxAddress    Max Address.
+  @param[in]      MapEntrys     Record every memory ranges that is generated
+  @param[in]      PagesRecord   Used to record memory usage for page table.
+
+  @retval  UNIT_TEST_PASSED        The test is successful.
+**/
+UNIT_TEST_STATUS
+BatchMapEntryTest (
+  IN OUT UINTN                  *PageTable,
+  IN OUT UINTN                  *BatchTable,
+  IN     PAGING_MODE            PagingMode,
+  IN     UINT64                 MaxAddress,
+  IN     MAP_ENTRYS             *MapEntrys,
+  IN     ALLOCATE_PAGE_RECORDS  *PagesRecord
+  )
+{
+  RETURN_STATUS     Status;
+  UNIT_TEST_STATUS  TestStatus;
+  IA32_MAP_REQUEST  Requests[BATCH_REQUEST_COUNT];
+  UINTN             RequestCount;
+  UINTN             Count;
+  UINTN             Index;
+  MAP_ENTRY         *MapEntry;
+  UINT64            End;
+  UINTN             PageTableBufferSize;
+  VOID              *Buffer;
+  IA32_MAP_ENTRY    *Map;
+  UINTN             MapCount;
+  IA32_MAP_ENTRY    *Map2;
+  UINTN             MapCount2;
+  BOOLEAN           IsModified;
+
+  Map          = NULL;
+  RequestCount = Random32 (1, BATCH_REQUEST_COUNT);
+  for (Index = 0; Index < RequestCount; Index++) {
+    //
+    // MapEntrys keeps the ranges of the previous batches so that the new ranges are likely close to them.
+    //
+    GenerateSingleRandomMapEntry (MaxAddress, MapEntrys);
+    MapEntry                         = &MapEntrys->Maps[MapEntrys->Count - 1];
+    Requests[Index].LinearAddress    = MapEntry->LinearAddress;
+    Requests[Index].Length           = MapEntry->Length;
+    Requests[Index].Attribute.Uint64 = MapEntry->Attribute.Uint64;
+    Requests[Index].Mask.Uint64      = MapEntry->Mask.Uint64;
+    if (((mRandomOption & ONLY_ONE_ONE_MAPPING) != 0) && RandomBoolean (50)) {
+      //
+      // Extend the range to the 2M regions containing it, which may have been split by the previous ranges.
+      //
+      End                                = MIN (ALIGN_VALUE (Requests[Index].LinearAddress + Requests[Index].Length, SIZE_2MB), MaxAddress);
+      Requests[Index].LinearAddress     &= ~((UINT64)SIZE_2MB - 1);
+      Requests[Index].Length             = End - Requests[Index].LinearAddress;
+      Requests[Index].Attribute.Uint64  &= ~IA32_MAP_ATTRIBUTE_PAGE_TABLE_BASE_ADDRESS_MASK;
+      Requests[Index].Attribute.Uint64  |= Requests[Index].LinearAddress;
+    }
+  }
+
+  SortAndTrimRequests (Requests, &RequestCount);
+
+  //
+  // Map the requests one by one, and drop the requests rejected by PageTableMap.
+  // The requests don't overlap so a request doesn't change whether another one is valid.
+  //
+  for (Index = 0, Count = 0; Index < RequestCount; Index++) {
+    PageTableBufferSize = 0;
+    Status              = PageTableMap (
+                            PageTable,
+                            PagingMode,
+                            NULL,
+                            &PageTableBufferSize,
+                            Requests[Index].LinearAddress,
+                            Requests[Index].Length,
+                            &Requests[Index].Attribute,
+                            &Requests[Index].Mask,
+                            NULL
+                            );
+    if (Status == RETURN_INVALID_PARAMETER) {
+      continue;
+    }
+
+    if (Status == RETURN_BUFFER_TOO_SMALL) {
+      Buffer = PagesRecord->AllocatePagesForPageTable (PagesRecord, EFI_SIZE_TO_PAGES (PageTableBufferSize));
+      UT_ASSERT_NOT_EQUAL (Buffer, NULL);
+      Status = PageTableMap (
+                 PageTable,
+                 PagingMode,
+                 Buffer,
+                 &PageTableBufferSize,
+                 Requests[Index].LinearAddress,
+                 Requests[Index].Length,
+                 &Requests[Index].Attribute,
+                 &Requests[Index].Mask,
+                 NULL
+                 );
+    }
+
+    UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+    CopyMem (&Requests[Count], &Requests[Index], sizeof (IA32_MAP_REQUEST));
+    Count++;
+  }
+
+  RequestCount = Count;
+
+  MapCount = 0;
+  Status   = PageTableParse (*BatchTable, PagingMode, NULL, &MapCount);
+  if (MapCount != 0) {
+    UT_ASSERT_EQUAL (Status, RETURN_BUFFER_TOO_SMALL);
+    Map = AllocatePages (EFI_SIZE_TO_PAGES (MapCount * sizeof (IA32_MAP_ENTRY)));
+    ASSERT (Map != NULL);
+    Status = PageTableParse (*BatchTable, PagingMode, Map, &MapCount);
+    UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+  }
+
+  //
+  // Map the same requests in a batch.
+  //
+  IsModified          = FALSE;
+  PageTableBufferSize = 0;
+  Status              = PageTableMapBatch (BatchTable, PagingMode, NULL, &PageTableBufferSize, Requests, RequestCount, &IsModified);
+  if (PageTableBufferSize != 0) {
+    UT_ASSERT_EQUAL (Status, RETURN_BUFFER_TOO_SMALL);
+    Buffer = PagesRecord->AllocatePagesForPageTable (PagesRecord, EFI_SIZE_TO_PAGES (PageTableBufferSize));
+    UT_ASSERT_NOT_EQUAL (Buffer, NULL);
+    Status = PageTableMapBatch (BatchTable, PagingMode, Buffer, &PageTableBufferSize, Requests, RequestCount, &IsModified);
+  }
+
+  UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+  TestStatus = IsPageTableValid (*BatchTable, PagingMode);
+  if (TestStatus != UNIT_TEST_PASSED) {
+    return TestStatus;
+  }
+
+  //
+  // Both page tables should map the same ranges with the same attributes.
+  //
+  Map2      = NULL;
+  MapCount2 = 0;
+  Status    = PageTableParse (*BatchTable, PagingMode, NULL, &MapCount2);
+  if (MapCount2 != 0) {
+    UT_ASSERT_EQUAL (Status, RETURN_BUFFER_TOO_SMALL);
+    Map2 = AllocatePages (EFI_SIZE_TO_PAGES (MapCount2 * sizeof (IA32_MAP_ENTRY)));
+    ASSERT (Map2 != NULL);
+    Status = PageTableParse (*BatchTable, PagingMode, Map2, &MapCount2);
+    UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+  }
+
+  if ((MapCount2 != MapCount) || (CompareMem (Map, Map2, MapCount2 * sizeof (IA32_MAP_ENTRY)) != 0)) {
+    UT_ASSERT_EQUAL (IsModified, TRUE);
+  }
+
+  if (MapCount != 0) {
+    FreePages (Map, EFI_SIZE_TO_PAGES (MapCount * sizeof (IA32_MAP_ENTRY)));
+  }
+
+  MapCount = 0;
+  Status   = PageTableParse (*PageTable, PagingMode, NULL, &MapCount);
+  UT_ASSERT_EQUAL (MapCount, MapCount2);
+  if (MapCount != 0) {
+    Map = AllocatePages (EFI_SIZE_TO_PAGES (MapCount * sizeof (IA32_MAP_ENTRY)));
+    ASSERT (Map != NULL);
+    Status = PageTableParse (*PageTable, PagingMode, Map, &MapCount);
+    UT_ASSERT_EQUAL (Status, RETURN_SUCCESS);
+    UT_ASSERT_MEM_EQUAL (Map, Map2, MapCount * sizeof (IA32_MAP_ENTRY));
+    FreePages (Map, EFI_SIZE_TO_PAGES (MapCount * sizeof (IA32_MAP_ENTRY)));
+  }
+
+  //
+  // The regions within the requests mapped uniformly should be mapped by 2M or 1G pages.
+  //
+  TestStatus = IsPageTablePromoted (*BatchTable, PagingMode, Requests, RequestCount, Map2, MapCount2);
+  if (MapCount2 != 0) {
+    FreePages (Map2, EFI_SIZE_TO_PAGES (MapCount2 * sizeof (IA32_MAP_ENTRY)));
+  }
+
+  return TestStatus;
+}
+
+/**
+  The function is a whole Random test for PageTableMapBatch, it will call BatchMapEntryTest for ExpctedEntryNumber times
+
+  @param[in]  ExpctedEntryNumber   The count of random batch
+  @param[in]  PagingMode           The paging mode.
+
+  @retval  UNIT_TEST_PASSED        The test is successful.
+**/
+UNIT_TEST_STATUS
+MultipleBatchMapEntryTest (
+  IN UINTN        ExpctedEntryNumber,
+  IN PAGING_MODE  PagingMode
+  )
+{
+  UINTN                  PageTable;
+  UINTN                  BatchTable;
+  UINT64                 MaxAddress;
+  MAP_ENTRYS             *MapEntrys;
+  ALLOCATE_PAGE_RECORDS  *PagesRecord;
+  UINTN                  Index;
+  UNIT_TEST_STATUS       TestStatus;
+
+  MaxAddress = GetMaxAddress (PagingMode);
+  PageTable  = 0;
+  BatchTable = 0;
+  MapEntrys  = AllocatePages (EFI_SIZE_TO_PAGES (ExpctedEntryNumber * BATCH_REQUEST_COUNT * sizeof (MAP_ENTRY) + sizeof (MAP_ENTRYS)));
+  ASSERT (MapEntrys != NULL);
+  MapEntrys->Count     = 0;
+  MapEntrys->InitCount = 0;
+  MapEntrys->MaxCount  = ExpctedEntryNumber * BATCH_REQUEST_COUNT;
+  PagesRecord          = AllocatePages (EFI_SIZE_TO_PAGES (1000*sizeof (ALLOCATE_PAGE_RECORD) + sizeof (ALLOCATE_PAGE_RECORDS)));
+  ASSERT (PagesRecord != NULL);
+  PagesRecord->Count                     = 0;
+  PagesRecord->MaxCount                  = 1000;
+  PagesRecord->AllocatePagesForPageTable = RecordAllocatePages;
+
+  for (Index = 0; Index < ExpctedEntryNumber; Index++) {
+    TestStatus = BatchMapEntryTest (
+                   &PageTable,
+                   &BatchTable,
+                   PagingMode,
+                   MaxAddress,
+                   MapEntrys,
+                   PagesRecord
+                   );
+    if (TestStatus != UNIT_TEST_PASSED) {
+      return TestStatus;
+    }
+  }
+
+  FreePages (MapEntrys, EFI_SIZE_TO_PAGES (ExpctedEntryNumber * BATCH_REQUEST_COUNT * sizeof (MAP_ENTRY) + sizeof (MAP_ENTRYS)));
+
+  for (Index = 0; Index < PagesRecord->Count; Index++) {
+    FreePages (PagesRecord->Records[Index].Buffer, PagesRecord->Records[Index].Pages);
+  }
+
+  FreePages (PagesRecord, EFI_SIZE_TO_PAGES (1000*sizeof (ALLOCATE_PAGE_RECORD) + sizeof (ALLOCATE_PAGE_RECORDS)));
+
+  return UNIT_TEST_PASSED;
+}
+
 /**
   Random Test
 
@@ -1067,10 +1421,18 @@ TestCaseforRandomTest (
   mNumberIndex  = 0;
 
   for (Index = 0; Index < ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->TestCount; Index++) {
-    Status = MultipleMapEntryTest (
-               ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->TestRangeCount,
-               ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->PagingMode
-               );
+    if ((mRandomOption & BATCH_MAP) != 0) {
+      Status = MultipleBatchMapEntryTest (
+                 ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->TestRangeCount,
+                 ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->PagingMode
+                 );
+    } else {
+      Status = MultipleMapEntryTest (
+                 ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->TestRangeCount,
+                 ((CPU_PAGE_TABLE_LIB_RANDOM_TEST_CONTEXT *)Context)->PagingMode
+                 );
+    }
+
     if (Status != UNIT_TEST_PASSED) {
       return Status;
     }
@@ -39,6 +39,11 @@ typedef struct {
   IA32_MAP_ATTRIBUTE    Mask;
 } MAP_ENTRY;
 
+//
+// Maximum number of requests of a random PageTableMapBatch() call.
+//
+#define BATCH_REQUEST_COUNT  10
+
 typedef struct {
   UINTN        Count;
   UINTN        InitCount;
@@ -460,9 +460,10 @@ ApInitializeSync (
   IN OUT VOID  *Buffer
   )
 {
-  CPU_MP_DATA  *CpuMpData;
-  UINTN        ProcessorNumber;
-  EFI_STATUS   Status;
+  CPU_MP_DATA    *CpuMpData;
+  UINTN          ProcessorNumber;
+  EFI_STATUS     Status;
+  MTRR_SETTINGS  MtrrTable;
 
   CpuMpData = (CPU_MP_DATA *)Buffer;
   Status    = GetProcessorNumber (CpuMpData, &ProcessorNumber);
@@ -472,9 +473,15 @@ ApInitializeSync (
   //
   MicrocodeDetect (CpuMpData, ProcessorNumber);
   //
-  // Sync BSP's MTRR table to AP
+  // Sync BSP's MTRR table to AP.
+  // The MTRRs are kept across INIT, so the APs handed off from PEI usually
+  // have them already. Skip MtrrSetAllMtrrs() then, it disables and flushes
+  // the caches.
   //
-  MtrrSetAllMtrrs (&CpuMpData->MtrrTable);
+  MtrrGetAllMtrrs (&MtrrTable);
+  if (CompareMem (&MtrrTable, &CpuMpData->MtrrTable, sizeof (MtrrTable)) != 0) {
+    MtrrSetAllMtrrs (&CpuMpData->MtrrTable);
+  }
 }
 
 /**
@@ -511,6 +518,29 @@ GetProcessorNumber (
   return EFI_NOT_FOUND;
 }
 
+/**
+  Get Processor Resource Data from the GUIDed HOB.
+
+  The HOB is built by the platform from the processor topology of ACPI or FDT.
+
+  @return  The pointer to Processor Resource Data structure, NULL if the HOB
+           is not present.
+**/
+PROCESSOR_RESOURCE_DATA *
+GetProcessorResourceDataFromGuidedHob (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+
+  GuidHob = GetFirstGuidHob (&gProcessorResourceHobGuid);
+  if (GuidHob == NULL) {
+    return NULL;
+  }
+
+  return (PROCESSOR_RESOURCE_DATA *)(*(UINTN *)GET_GUID_HOB_DATA (GuidHob));
+}
+
 /**
   This function will get CPU count in the system.
 
@@ -523,22 +553,44 @@ CollectProcessorCount (
   IN CPU_MP_DATA  *CpuMpData
   )
 {
-  UINTN            Index;
-  CPU_INFO_IN_HOB  *CpuInfoInHob;
-  BOOLEAN          X2Apic;
+  UINTN                    Index;
+  CPU_INFO_IN_HOB          *CpuInfoInHob;
+  BOOLEAN                  X2Apic;
+  PROCESSOR_RESOURCE_DATA  *ProcessorResourceData;
+
+  //
+  // Wait for the number of processors reported by the platform if it is
+  // known, instead of the whole PcdCpuApInitTimeOutInMicroSeconds.
+  //
+  ProcessorResourceData = GetProcessorResourceDataFromGuidedHob ();
+  if ((ProcessorResourceData != NULL) &&
+      (ProcessorResourceData->NumberOfProcessor <= PcdGet32 (PcdCpuMaxLogicalProcessorNumber)))
+  {
+    CpuMpData->ExpectedCpuCount = ProcessorResourceData->NumberOfProcessor;
+  }
 
   //
   // Send 1st broadcast IPI to APs to wakeup APs
   //
+  PERF_INMODULE_BEGIN ("MpInitCollectAps");
   CpuMpData->InitFlag = ApInitConfig;
   WakeUpAP (CpuMpData, TRUE, 0, NULL, NULL, TRUE);
   CpuMpData->InitFlag = ApInitDone;
+  PERF_INMODULE_END ("MpInitCollectAps");
   //
   // When InitFlag == ApInitConfig, WakeUpAP () guarantees all APs are checked in.
   // FinishedCount is the number of check-in APs.
   //
   CpuMpData->CpuCount = CpuMpData->FinishedCount + 1;
   ASSERT (CpuMpData->CpuCount <= PcdGet32 (PcdCpuMaxLogicalProcessorNumber));
+  if ((CpuMpData->ExpectedCpuCount != 0) && (CpuMpData->CpuCount != CpuMpData->ExpectedCpuCount)) {
+    DEBUG ((
+      DEBUG_WARN,
+      "MpInitLib: %d processors found, %d reported by the platform.\n",
+      CpuMpData->CpuCount,
+      CpuMpData->ExpectedCpuCount
+      ));
+  }
 
   //
   // Enable x2APIC mode if
@@ -1349,6 +1401,22 @@ WakeUpAP (
           PcdGet32 (PcdCpuBootLogicalProcessorNumber) - 1,
           MAX_UINT32 // approx. 71 minutes
           );
+      } else if (CpuMpData->ExpectedCpuCount > 1) {
+        //
+        // The platform reported the number of processors from the ACPI or FDT
+        // topology. The wait finishes as soon as all the APs have checked in,
+        // PcdCpuApInitTimeOutInMicroSeconds is only the upper bound in case
+        // some of them fail to start.
+        //
+        TimedWaitForApFinish (
+          CpuMpData,
+          CpuMpData->ExpectedCpuCount - 1,
+          PcdGet32 (PcdCpuApInitTimeOutInMicroSeconds)
+          );
+
+        while (CpuMpData->MpCpuExchangeInfo->NumApsExecuting != 0) {
+          CpuPause ();
+        }
       } else {
         //
         // The AP enumeration algorithm below is suitable for two use cases.
@@ -1653,15 +1721,16 @@ TimedWaitForApFinish (
 
   if (CpuMpData->FinishedCount >= FinishedApLimit) {
     DEBUG ((
-      DEBUG_VERBOSE,
-      "%a: reached FinishedApLimit=%u in %Lu microseconds\n",
+      (CpuMpData->ExpectedCpuCount != 0) ? DEBUG_INFO : DEBUG_VERBOSE,
+      "%a: reached FinishedApLimit=%u in %Lu of %u microseconds\n",
       __func__,
       FinishedApLimit,
       DivU64x64Remainder (
         MultU64x32 (CpuMpData->TotalTime, 1000000),
         GetPerformanceCounterProperties (NULL, NULL),
         NULL
-        )
+        ),
+      TimeLimit
       ));
   }
 }
@@ -2368,6 +2437,7 @@ MpInitLibInitialize (
       CpuMpData->InitFlag = ApInitReconfig;
     }
 
+    PERF_INMODULE_BEGIN ("MpInitSyncAps");
     WakeUpAP (CpuMpData, TRUE, 0, ApInitializeSync, CpuMpData, TRUE);
     //
     // Wait for all APs finished initialization
@@ -2376,6 +2446,8 @@ MpInitLibInitialize (
       CpuPause ();
     }
 
+    PERF_INMODULE_END ("MpInitSyncAps");
+
     if (FirstMpHandOff != NULL) {
       CpuMpData->InitFlag = ApInitDone;
     }
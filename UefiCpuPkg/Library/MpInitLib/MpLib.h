@@ -34,12 +34,14 @@
 #include <Library/PcdLib.h>
 #include <Library/MicrocodeLib.h>
 #include <Library/CpuPageTableLib.h>
+#include <Library/PerformanceLib.h>
 #include <ConfidentialComputingGuestAttr.h>
 
 #include <Register/Amd/SevSnpMsr.h>
 #include <Register/Amd/Ghcb.h>
 
 #include <Guid/MicrocodePatchHob.h>
+#include <Guid/ProcessorResourceHob.h>
 #include "MpHandOff.h"
 
 #define WAKEUP_AP_SIGNAL  SIGNATURE_32 ('S', 'T', 'A', 'P')
@@ -314,6 +316,13 @@ struct _CPU_MP_DATA {
   CPU_MP_DATA    *NewCpuMpData;
 
   UINT64         GhcbBase;
+
+  //
+  // The number of processors reported by the platform in the processor
+  // resource HOB, 0 if the HOB is not present. The first wakeup of the APs
+  // stops waiting when they have all checked in.
+  //
+  UINT32         ExpectedCpuCount;
 };
 
 //
@@ -23,18 +23,32 @@
     BSP: ReleaseOneAp  -->  AP: WaitForBsp
     BSP: WaitForAPs    <--  AP: ReleaseBsp
 
-  Copyright (c) 2023, Intel Corporation. All rights reserved.<BR>
+  The counters of the checked-in CPUs and of the APs releasing the BSP can be split in groups of
+  CPUs selected by PcdCpuSmmSyncTopologyLevel: the threads of a core or the CPUs of a package.
+  The CPUs only update the counters of their group, and the BSP sums the counters of the groups,
+  which avoids all the CPUs of a multi-socket system contending for the same cache lines.
+
+  Copyright (c) 2023 - 2024, Intel Corporation. All rights reserved.<BR>
   SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Library/SafeIntLib.h>
 #include <Library/SmmCpuSyncLib.h>
 #include <Library/SynchronizationLib.h>
+#include <Register/Intel/Cpuid.h>
 #include <Uefi.h>
 
+///
+/// Values of PcdCpuSmmSyncTopologyLevel.
+///
+#define SMM_CPU_SYNC_LEVEL_SYSTEM   0
+#define SMM_CPU_SYNC_LEVEL_CORE     1
+#define SMM_CPU_SYNC_LEVEL_PACKAGE  2
+
 ///
 /// The implementation shall place one semaphore on exclusive cache line for good performance.
 ///
@@ -47,35 +61,54 @@ typedef struct {
   SMM_CPU_SYNC_SEMAPHORE    *Run;
 } SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_CPU;
 
+typedef struct {
+  ///
+  /// Before the door is locked, CpuCount stores the arrived CPU count of the group.
+  /// After the door is locked, CpuCount is set to -1 indicating the door is locked.
+  ///
+  SMM_CPU_SYNC_SEMAPHORE    *CpuCount;
+  ///
+  /// Number of times the APs of the group released the BSP, not yet waited by the BSP.
+  ///
+  SMM_CPU_SYNC_SEMAPHORE    *Arrived;
+} SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_GROUP;
+
 struct SMM_CPU_SYNC_CONTEXT  {
   ///
   /// Indicate all CPUs in the system.
   ///
-  UINTN                                  NumberOfCpus;
+  UINTN                                    NumberOfCpus;
+  ///
+  /// The CPUs are split in groups of CpusPerGroup consecutive CPU indexes. The CPU
+  /// indexes follow the order of the APIC IDs, so the CPUs of a group share a core
+  /// or a package.
+  ///
+  UINTN                                    CpusPerGroup;
+  UINTN                                    NumberOfGroups;
   ///
   /// Address of semaphores.
   ///
-  VOID                                   *SemBuffer;
+  VOID                                     *SemBuffer;
   ///
   /// Size of semaphores.
   ///
-  UINTN                                  SemBufferPages;
+  UINTN                                    SemBufferPages;
   ///
-  /// Before the door is locked, CpuCount stores the arrived CPU count.
-  /// After the door is locked, CpuCount is set to -1 indicating the door is locked.
-  /// ArrivedCpuCountUponLock stores the arrived CPU count then.
+  /// After the door is locked, ArrivedCpuCountUponLock stores the arrived CPU count.
+  /// The groups are locked in order, it stores the arrived CPU count of the groups
+  /// locked so far meanwhile.
   ///
-  UINTN                                  ArrivedCpuCountUponLock;
+  UINTN                                    ArrivedCpuCountUponLock;
   ///
-  /// Indicate CPUs entered SMM before lock door.
+  /// The semaphores of each group, following CpuSem[].
   ///
-  SMM_CPU_SYNC_SEMAPHORE                 *CpuCount;
+  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_GROUP    *GroupSem;
   ///
   /// Define an array of structure for each CPU semaphore due to the size alignment
   /// requirement. With the array of structure for each CPU semaphore, it's easy to
   /// reach the specific CPU with CPU Index for its own semaphore access: CpuSem[CpuIndex].
   ///
-  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_CPU    CpuSem[];
+  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_CPU      CpuSem[];
 };
 
 /**
@@ -188,6 +221,93 @@ InternalLockdownSemaphore (
   return Value;
 }
 
+/**
+  Performs an atomic compare exchange operation to get up to Count from a semaphore,
+  without waiting.
+
+  @param[in,out]  Sem    IN:  32-bit unsigned integer
+                         OUT: original integer - the returned value.
+  @param[in]      Count  The maximum value to get.
+
+  @retval    The value got from the semaphore, 0 if it is 0 or locked.
+
+**/
+STATIC
+UINT32
+InternalTakeSemaphore (
+  IN OUT  volatile UINT32  *Sem,
+  IN      UINT32           Count
+  )
+{
+  UINT32  Value;
+  UINT32  Taken;
+
+  do {
+    Value = *Sem;
+    if ((Value == 0) || (Value == MAX_UINT32)) {
+      return 0;
+    }
+
+    Taken = MIN (Value, Count);
+  } while (InterlockedCompareExchange32 (
+             (UINT32 *)Sem,
+             Value,
+             Value - Taken
+             ) != Value);
+
+  return Taken;
+}
+
+/**
+  Get the number of consecutive CPU indexes sharing the semaphores of a group,
+  following PcdCpuSmmSyncTopologyLevel.
+
+  The number of logical processors of CPUID leaf 0x0B is only a hint of the
+  topology, the grouping does not affect the correctness of the synchronization.
+
+  @param[in]  NumberOfCpus          The number of Logical Processors in the system.
+
+  @return  The number of CPUs of a group.
+
+**/
+STATIC
+UINTN
+InternalGetCpusPerGroup (
+  IN UINTN  NumberOfCpus
+  )
+{
+  UINT32                       MaxLeaf;
+  UINT8                        Level;
+  UINT32                       LevelNumber;
+  CPUID_EXTENDED_TOPOLOGY_EAX  Eax;
+  CPUID_EXTENDED_TOPOLOGY_EBX  Ebx;
+  CPUID_EXTENDED_TOPOLOGY_ECX  Ecx;
+
+  Level = PcdGet8 (PcdCpuSmmSyncTopologyLevel);
+  if (Level == SMM_CPU_SYNC_LEVEL_SYSTEM) {
+    return NumberOfCpus;
+  }
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf < CPUID_EXTENDED_TOPOLOGY) {
+    return NumberOfCpus;
+  }
+
+  //
+  // Sub-leaf 0 describes the threads of a core, sub-leaf 1 the cores of a package.
+  //
+  LevelNumber = (Level == SMM_CPU_SYNC_LEVEL_CORE) ? 0 : 1;
+  AsmCpuidEx (CPUID_EXTENDED_TOPOLOGY, LevelNumber, &Eax.Uint32, &Ebx.Uint32, &Ecx.Uint32, NULL);
+  if ((Ecx.Bits.LevelType == CPUID_EXTENDED_TOPOLOGY_LEVEL_TYPE_INVALID) ||
+      (Ebx.Bits.LogicalProcessors == 0) ||
+      (Ebx.Bits.LogicalProcessors >= NumberOfCpus))
+  {
+    return NumberOfCpus;
+  }
+
+  return Ebx.Bits.LogicalProcessors;
+}
+
 /**
   Create and initialize the SMM CPU Sync context. It is to allocate and initialize the
   SMM CPU Sync context.
@@ -210,17 +330,25 @@ SmmCpuSyncContextInit (
   OUT  SMM_CPU_SYNC_CONTEXT  **Context
   )
 {
-  RETURN_STATUS                        Status;
-  UINTN                                ContextSize;
-  UINTN                                OneSemSize;
-  UINTN                                NumSem;
-  UINTN                                TotalSemSize;
-  UINTN                                SemAddr;
-  UINTN                                CpuIndex;
-  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_CPU  *CpuSem;
+  RETURN_STATUS                          Status;
+  UINTN                                  ContextSize;
+  UINTN                                  GroupSemSize;
+  UINTN                                  CpusPerGroup;
+  UINTN                                  NumberOfGroups;
+  UINTN                                  OneSemSize;
+  UINTN                                  NumSem;
+  UINTN                                  TotalSemSize;
+  UINTN                                  SemAddr;
+  UINTN                                  CpuIndex;
+  UINTN                                  GroupIndex;
+  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_CPU    *CpuSem;
+  SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_GROUP  *GroupSem;
 
   ASSERT (Context != NULL);
 
+  CpusPerGroup   = InternalGetCpusPerGroup (NumberOfCpus);
+  NumberOfGroups = (NumberOfCpus + CpusPerGroup - 1) / CpusPerGroup;
+
   //
   // Calculate ContextSize
   //
@@ -234,6 +362,16 @@ SmmCpuSyncContextInit (
     return Status;
   }
 
+  Status = SafeUintnMult (NumberOfGroups, sizeof (SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_GROUP), &GroupSemSize);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = SafeUintnAdd (ContextSize, GroupSemSize, &ContextSize);
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
   //
   // Allocate Buffer for Context
   //
@@ -245,9 +383,12 @@ SmmCpuSyncContextInit (
   (*Context)->ArrivedCpuCountUponLock = 0;
 
   //
-  // Save NumberOfCpus
+  // Save NumberOfCpus and the groups
   //
-  (*Context)->NumberOfCpus = NumberOfCpus;
+  (*Context)->NumberOfCpus   = NumberOfCpus;
+  (*Context)->CpusPerGroup   = CpusPerGroup;
+  (*Context)->NumberOfGroups = NumberOfGroups;
+  (*Context)->GroupSem       = (SMM_CPU_SYNC_SEMAPHORE_FOR_EACH_GROUP *)&(*Context)->CpuSem[NumberOfCpus];
 
   //
   // Calculate total semaphore size
@@ -255,7 +396,12 @@ SmmCpuSyncContextInit (
   OneSemSize = GetSpinLockProperties ();
   ASSERT (sizeof (SMM_CPU_SYNC_SEMAPHORE) <= OneSemSize);
 
-  Status = SafeUintnAdd (1, NumberOfCpus, &NumSem);
+  Status = SafeUintnMult (2, NumberOfGroups, &NumSem);
+  if (RETURN_ERROR (Status)) {
+    goto ON_ERROR;
+  }
+
+  Status = SafeUintnAdd (NumSem, NumberOfCpus, &NumSem);
   if (RETURN_ERROR (Status)) {
     goto ON_ERROR;
   }
@@ -276,13 +422,21 @@ SmmCpuSyncContextInit (
   }
 
   //
-  // Assign Global Semaphore pointer
+  // Assign Group Semaphore pointer
   //
-  SemAddr               = (UINTN)(*Context)->SemBuffer;
-  (*Context)->CpuCount  = (SMM_CPU_SYNC_SEMAPHORE *)SemAddr;
-  *(*Context)->CpuCount = 0;
-
-  SemAddr += OneSemSize;
+  SemAddr  = (UINTN)(*Context)->SemBuffer;
+  GroupSem = (*Context)->GroupSem;
+  for (GroupIndex = 0; GroupIndex < NumberOfGroups; GroupIndex++) {
+    GroupSem->CpuCount  = (SMM_CPU_SYNC_SEMAPHORE *)SemAddr;
+    *GroupSem->CpuCount = 0;
+    SemAddr            += OneSemSize;
+
+    GroupSem->Arrived  = (SMM_CPU_SYNC_SEMAPHORE *)SemAddr;
+    *GroupSem->Arrived = 0;
+    SemAddr           += OneSemSize;
+
+    GroupSem++;
+  }
 
   //
   // Assign CPU Semaphore pointer
@@ -342,10 +496,14 @@ SmmCpuSyncContextReset (
   IN OUT SMM_CPU_SYNC_CONTEXT  *Context
   )
 {
+  UINTN  GroupIndex;
+
   ASSERT (Context != NULL);
 
   Context->ArrivedCpuCountUponLock = 0;
-  *Context->CpuCount               = 0;
+  for (GroupIndex = 0; GroupIndex < Context->NumberOfGroups; GroupIndex++) {
+    *Context->GroupSem[GroupIndex].CpuCount = 0;
+  }
 }
 
 /**
@@ -368,16 +526,23 @@ SmmCpuSyncGetArrivedCpuCount (
   )
 {
   UINT32  Value;
+  UINTN   GroupIndex;
+  UINTN   Count;
 
   ASSERT (Context != NULL);
 
-  Value = *Context->CpuCount;
-
-  if (Value == (UINT32)-1) {
-    return Context->ArrivedCpuCountUponLock;
+  //
+  // The CPU count of the groups locked is in ArrivedCpuCountUponLock.
+  //
+  Count = 0;
+  for (GroupIndex = 0; GroupIndex < Context->NumberOfGroups; GroupIndex++) {
+    Value = *Context->GroupSem[GroupIndex].CpuCount;
+    if (Value != (UINT32)-1) {
+      Count += Value;
+    }
   }
 
-  return Value;
+  return Context->ArrivedCpuCountUponLock + Count;
 }
 
 /**
@@ -409,7 +574,7 @@ SmmCpuSyncCheckInCpu (
   //
   // Check to return if CpuCount has already been locked.
   //
-  if (InternalReleaseSemaphore (Context->CpuCount) == MAX_UINT32) {
+  if (InternalReleaseSemaphore (Context->GroupSem[CpuIndex / Context->CpusPerGroup].CpuCount) == MAX_UINT32) {
     return RETURN_ABORTED;
   }
 
@@ -443,7 +608,7 @@ SmmCpuSyncCheckOutCpu (
 
   ASSERT (CpuIndex < Context->NumberOfCpus);
 
-  if (InternalWaitForSemaphore (Context->CpuCount) == MAX_UINT32) {
+  if (InternalWaitForSemaphore (Context->GroupSem[CpuIndex / Context->CpusPerGroup].CpuCount) == MAX_UINT32) {
     return RETURN_ABORTED;
   }
 
@@ -475,6 +640,8 @@ SmmCpuSyncLockDoor (
   OUT UINTN                    *CpuCount
   )
 {
+  UINTN  GroupIndex;
+
   ASSERT (Context != NULL);
 
   ASSERT (CpuCount != NULL);
@@ -482,21 +649,14 @@ SmmCpuSyncLockDoor (
   ASSERT (CpuIndex < Context->NumberOfCpus);
 
   //
-  // Temporarily record the CpuCount into the ArrivedCpuCountUponLock before lock door.
-  // Recording before lock door is to avoid the Context->CpuCount is locked but possible
-  // Context->ArrivedCpuCountUponLock is not updated.
+  // Lock door operation, group by group. The CPU count of each group is added to
+  // ArrivedCpuCountUponLock right after the group is locked.
   //
-  Context->ArrivedCpuCountUponLock = *Context->CpuCount;
-
-  //
-  // Lock door operation
-  //
-  *CpuCount = InternalLockdownSemaphore (Context->CpuCount);
+  for (GroupIndex = 0; GroupIndex < Context->NumberOfGroups; GroupIndex++) {
+    Context->ArrivedCpuCountUponLock += InternalLockdownSemaphore (Context->GroupSem[GroupIndex].CpuCount);
+  }
 
-  //
-  // Update the ArrivedCpuCountUponLock
-  //
-  Context->ArrivedCpuCountUponLock = *CpuCount;
+  *CpuCount = Context->ArrivedCpuCountUponLock;
 }
 
 /**
@@ -528,7 +688,8 @@ SmmCpuSyncWaitForAPs (
   IN     UINTN                 BspIndex
   )
 {
-  UINTN  Arrived;
+  UINTN  Remaining;
+  UINTN  GroupIndex;
 
   ASSERT (Context != NULL);
 
@@ -536,8 +697,18 @@ SmmCpuSyncWaitForAPs (
 
   ASSERT (BspIndex < Context->NumberOfCpus);
 
-  for (Arrived = 0; Arrived < NumberOfAPs; Arrived++) {
-    InternalWaitForSemaphore (Context->CpuSem[BspIndex].Run);
+  //
+  // Take the releases of the APs from the groups, as many as arrived at once.
+  //
+  Remaining = NumberOfAPs;
+  while (Remaining != 0) {
+    for (GroupIndex = 0; GroupIndex < Context->NumberOfGroups && Remaining != 0; GroupIndex++) {
+      Remaining -= InternalTakeSemaphore (Context->GroupSem[GroupIndex].Arrived, (UINT32)Remaining);
+    }
+
+    if (Remaining != 0) {
+      CpuPause ();
+    }
   }
 }
 
@@ -648,5 +819,5 @@ SmmCpuSyncReleaseBsp (
 
   ASSERT (BspIndex < Context->NumberOfCpus);
 
-  InternalReleaseSemaphore (Context->CpuSem[BspIndex].Run);
+  InternalReleaseSemaphore (Context->GroupSem[CpuIndex / Context->CpusPerGroup].Arrived);
 }
@@ -0,0 +1,128 @@
+/** @file
+  MP services of the Task Scheduler Library for the DXE phase.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTaskSchedulerLib.h"
+#include <Library/UefiBootServicesTableLib.h>
+
+/**
+  Get EFI_MP_SERVICES_PROTOCOL pointer.
+
+  The completion of the APs started in non-blocking mode is signaled from a
+  timer event of the MP services, which cannot run while the caller is at
+  TPL_NOTIFY or above. The MP services are not used at such a TPL, and the
+  tasks run on the BSP only.
+
+  @param[out] MpServices    A pointer to the buffer where EFI_MP_SERVICES_PROTOCOL is stored
+
+  @retval EFI_SUCCESS       EFI_MP_SERVICES_PROTOCOL interface is returned
+  @retval EFI_NOT_FOUND     EFI_MP_SERVICES_PROTOCOL interface is not found
+  @retval EFI_UNSUPPORTED   The caller is at TPL_NOTIFY or above.
+**/
+EFI_STATUS
+TaskSchedulerGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  )
+{
+  EFI_TPL  Tpl;
+
+  Tpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  gBS->RestoreTPL (Tpl);
+  if (Tpl >= TPL_NOTIFY) {
+    DEBUG ((DEBUG_WARN, "%a: Running on the BSP only at TPL %d\n", __func__, Tpl));
+    return EFI_UNSUPPORTED;
+  }
+
+  return gBS->LocateProtocol (&gEfiMpServiceProtocolGuid, NULL, (VOID **)&MpServices->Protocol);
+}
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfProcessors         The number of logical processors.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval EFI_SUCCESS       The numbers are returned.
+  @retval Others            The numbers cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfProcessors,
+  OUT UINTN        *NumberOfEnabledProcessors
+  )
+{
+  return MpServices.Protocol->GetNumberOfProcessors (MpServices.Protocol, NumberOfProcessors, NumberOfEnabledProcessors);
+}
+
+/**
+  Get detailed information of the requested logical processor.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  ProcessorNum        The requested logical processor number.
+  @param[out] ProcessorInfo       A pointer to the buffer where the processor information is stored
+
+  @retval EFI_SUCCESS       The information is returned.
+  @retval Others            The information cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetProcessorInfo (
+  IN  MP_SERVICES                MpServices,
+  IN  UINTN                      ProcessorNum,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfo
+  )
+{
+  return MpServices.Protocol->GetProcessorInfo (MpServices.Protocol, ProcessorNum, ProcessorInfo);
+}
+
+/**
+  Run a procedure on all the enabled logical processors at the same time, the
+  BSP included, and return when it has returned on all of them.
+
+  The APs are started in non-blocking mode so that the BSP runs the procedure
+  with them. Their completion is reported by the periodic check of the MP
+  services, which adds up to its period to the time of the run.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       The procedure has run on all the processors.
+  @retval EFI_NOT_READY     The APs are busy.
+  @retval Others            The APs cannot be started.
+**/
+EFI_STATUS
+TaskSchedulerStartupAllCPUs (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   Event;
+
+  Status = gBS->CreateEvent (0, TPL_CALLBACK, NULL, NULL, &Event);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = MpServices.Protocol->StartupAllAPs (MpServices.Protocol, Procedure, FALSE, Event, 0, ProcedureArgument, NULL);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (Event);
+    return Status;
+  }
+
+  Procedure (ProcedureArgument);
+
+  while (gBS->CheckEvent (Event) == EFI_NOT_READY) {
+    CpuPause ();
+  }
+
+  gBS->CloseEvent (Event);
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/** @file
+  Internal header file of the Task Scheduler Library.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef INTERNAL_TASK_SCHEDULER_LIB_H_
+#define INTERNAL_TASK_SCHEDULER_LIB_H_
+
+#include <PiPei.h>
+#include <Ppi/MpServices2.h>
+#include <Protocol/MpService.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/LocalApicLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TaskSchedulerLib.h>
+
+//
+// Number of tasks of the queue of a worker. A task spawned on a full queue is
+// run immediately.
+//
+#define TASK_QUEUE_SIZE  256
+
+//
+// Number of parts per worker of the ranges of TaskParallelFor() called with a
+// Grain of 0, which leaves parts to steal to the workers completing their
+// parts early.
+//
+#define TASK_PARTS_PER_WORKER  8
+
+typedef union {
+  EDKII_PEI_MP_SERVICES2_PPI    *Ppi;
+  EFI_MP_SERVICES_PROTOCOL      *Protocol;
+} MP_SERVICES;
+
+typedef struct {
+  TASK_PROCEDURE          Procedure;
+  TASK_RANGE_PROCEDURE    RangeProcedure;
+  VOID                    *Context;
+  TASK_FUTURE             *Future;
+  //
+  // The part of the range of a task of TaskParallelFor().
+  //
+  UINTN                   Start;
+  UINTN                   End;
+  UINTN                   Grain;
+} TASK;
+
+//
+// The queue of the tasks spawned by a worker. The worker pushes and pops its
+// tasks at the tail, the other workers steal the oldest tasks at the head.
+//
+typedef struct {
+  SPIN_LOCK          Lock;
+  volatile UINT32    Head;
+  volatile UINT32    Tail;
+  UINT32             Seed;
+  TASK               Tasks[TASK_QUEUE_SIZE];
+} TASK_WORKER;
+
+struct _TASK_SCHEDULER {
+  MP_SERVICES         MpServices;
+  UINTN               WorkerCount;
+  TASK_WORKER         *Workers;
+  //
+  // The index of the worker of each APIC ID, MAX_UINT32 for the disabled
+  // processors.
+  //
+  UINT32              *WorkerIndex;
+  UINT32              MaxApicId;
+  TASK_PROCEDURE      RootProcedure;
+  VOID                *RootContext;
+  //
+  // The tasks spawned and not completed, the BSP ends the run when it drops
+  // to 0 after the root task is completed.
+  //
+  TASK_FUTURE         Outstanding;
+  volatile BOOLEAN    Done;
+};
+
+/**
+  Get EDKII_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL pointer.
+
+  @param[out] MpServices    A pointer to the buffer where EDKII_PEI_MP_SERVICES2_PPI or
+                            EFI_MP_SERVICES_PROTOCOL is stored
+
+  @retval EFI_SUCCESS       EDKII_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is returned
+  @retval EFI_NOT_FOUND     EDKII_PEI_MP_SERVICES2_PPI or EFI_MP_SERVICES_PROTOCOL interface is not found
+**/
+EFI_STATUS
+TaskSchedulerGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  );
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfProcessors         The number of logical processors.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval EFI_SUCCESS       The numbers are returned.
+  @retval Others            The numbers cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfProcessors,
+  OUT UINTN        *NumberOfEnabledProcessors
+  );
+
+/**
+  Get detailed information of the requested logical processor.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  ProcessorNum        The requested logical processor number.
+  @param[out] ProcessorInfo       A pointer to the buffer where the processor information is stored
+
+  @retval EFI_SUCCESS       The information is returned.
+  @retval Others            The information cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetProcessorInfo (
+  IN  MP_SERVICES                MpServices,
+  IN  UINTN                      ProcessorNum,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfo
+  );
+
+/**
+  Run a procedure on all the enabled logical processors at the same time, the
+  BSP included, and return when it has returned on all of them.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       The procedure has run on all the processors.
+  @retval EFI_NOT_READY     The APs are busy.
+  @retval Others            The APs cannot be started.
+**/
+EFI_STATUS
+TaskSchedulerStartupAllCPUs (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  );
+
+#endif
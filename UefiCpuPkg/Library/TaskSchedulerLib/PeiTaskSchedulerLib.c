@@ -0,0 +1,88 @@
+/** @file
+  MP services of the Task Scheduler Library for the PEI phase.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTaskSchedulerLib.h"
+#include <Library/PeiServicesLib.h>
+
+/**
+  Get EDKII_PEI_MP_SERVICES2_PPI pointer.
+
+  @param[out] MpServices    A pointer to the buffer where EDKII_PEI_MP_SERVICES2_PPI is stored
+
+  @retval EFI_SUCCESS       EDKII_PEI_MP_SERVICES2_PPI interface is returned
+  @retval EFI_NOT_FOUND     EDKII_PEI_MP_SERVICES2_PPI interface is not found
+**/
+EFI_STATUS
+TaskSchedulerGetMpServices (
+  OUT MP_SERVICES  *MpServices
+  )
+{
+  return PeiServicesLocatePpi (&gEdkiiPeiMpServices2PpiGuid, 0, NULL, (VOID **)&MpServices->Ppi);
+}
+
+/**
+  Get the number of logical processors in the platform.
+
+  @param[in]  MpServices                 MP_SERVICES structure.
+  @param[out] NumberOfProcessors         The number of logical processors.
+  @param[out] NumberOfEnabledProcessors  The number of enabled logical processors.
+
+  @retval EFI_SUCCESS       The numbers are returned.
+  @retval Others            The numbers cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetNumberOfProcessors (
+  IN  MP_SERVICES  MpServices,
+  OUT UINTN        *NumberOfProcessors,
+  OUT UINTN        *NumberOfEnabledProcessors
+  )
+{
+  return MpServices.Ppi->GetNumberOfProcessors (MpServices.Ppi, NumberOfProcessors, NumberOfEnabledProcessors);
+}
+
+/**
+  Get detailed information of the requested logical processor.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  ProcessorNum        The requested logical processor number.
+  @param[out] ProcessorInfo       A pointer to the buffer where the processor information is stored
+
+  @retval EFI_SUCCESS       The information is returned.
+  @retval Others            The information cannot be retrieved.
+**/
+EFI_STATUS
+TaskSchedulerGetProcessorInfo (
+  IN  MP_SERVICES                MpServices,
+  IN  UINTN                      ProcessorNum,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfo
+  )
+{
+  return MpServices.Ppi->GetProcessorInfo (MpServices.Ppi, ProcessorNum, ProcessorInfo);
+}
+
+/**
+  Run a procedure on all the enabled logical processors at the same time, the
+  BSP included, and return when it has returned on all of them.
+
+  @param[in]  MpServices          MP_SERVICES structure.
+  @param[in]  Procedure           A pointer to the function to be run on enabled logical processors.
+  @param[in]  ProcedureArgument   The parameter passed into Procedure for all enabled logical processors.
+
+  @retval EFI_SUCCESS       The procedure has run on all the processors.
+  @retval EFI_NOT_READY     The APs are busy.
+  @retval Others            The APs cannot be started.
+**/
+EFI_STATUS
+TaskSchedulerStartupAllCPUs (
+  IN MP_SERVICES       MpServices,
+  IN EFI_AP_PROCEDURE  Procedure,
+  IN VOID              *ProcedureArgument
+  )
+{
+  return MpServices.Ppi->StartupAllCPUs (MpServices.Ppi, Procedure, 0, ProcedureArgument);
+}
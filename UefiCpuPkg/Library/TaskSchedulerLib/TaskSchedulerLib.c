@@ -0,0 +1,561 @@
+/** @file
+  Task scheduler running fine-grained tasks on all the enabled processors.
+
+  Each processor runs a worker owning a queue of tasks. A worker runs the tasks
+  it spawned last first, which keeps their data in its caches, and the idle
+  workers steal the oldest tasks of the queues of randomly chosen workers,
+  which are the largest parts of the work for the recursively split ranges of
+  TaskParallelFor(). The queues are protected by a spin lock, which is only
+  contended when a worker is being stolen from.
+
+  The workers are started on the APs with the MP services for the duration of
+  TaskSchedulerRun(), the APs go back to the MP services loop at its end.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "InternalTaskSchedulerLib.h"
+
+/**
+  Get the number of workers of the scheduler, the number of enabled processors.
+
+  @param[in] Scheduler  The scheduler running the current task.
+
+  @return The number of workers.
+**/
+UINTN
+EFIAPI
+TaskGetWorkerCount (
+  IN TASK_SCHEDULER  *Scheduler
+  )
+{
+  return Scheduler->WorkerCount;
+}
+
+/**
+  Get the index of the worker running the current task, lower than the number
+  of workers. The BSP is the worker 0.
+
+  @param[in] Scheduler  The scheduler running the current task.
+
+  @return The index of the worker.
+**/
+UINTN
+EFIAPI
+TaskGetWorkerIndex (
+  IN TASK_SCHEDULER  *Scheduler
+  )
+{
+  UINT32  ApicId;
+
+  if (Scheduler->WorkerCount == 1) {
+    return 0;
+  }
+
+  ApicId = GetApicId ();
+  ASSERT (ApicId <= Scheduler->MaxApicId);
+  ASSERT (Scheduler->WorkerIndex[ApicId] < Scheduler->WorkerCount);
+  return Scheduler->WorkerIndex[ApicId];
+}
+
+/**
+  Check if the tasks of a future are completed.
+
+  @param[in] Future  The future.
+
+  @retval TRUE   All the tasks of the future are completed.
+  @retval FALSE  Some tasks of the future are not completed.
+**/
+BOOLEAN
+EFIAPI
+TaskIsCompleted (
+  IN TASK_FUTURE  *Future
+  )
+{
+  return (BOOLEAN)(Future->Pending == 0);
+}
+
+/**
+  Push a task at the tail of the queue of a worker.
+
+  @param[in, out] Worker  The worker.
+  @param[in]      Task    The task.
+
+  @retval TRUE   The task is queued.
+  @retval FALSE  The queue is full.
+**/
+BOOLEAN
+PushTask (
+  IN OUT TASK_WORKER  *Worker,
+  IN     CONST TASK   *Task
+  )
+{
+  BOOLEAN  Pushed;
+
+  AcquireSpinLock (&Worker->Lock);
+  Pushed = (BOOLEAN)(Worker->Tail - Worker->Head < TASK_QUEUE_SIZE);
+  if (Pushed) {
+    CopyMem (&Worker->Tasks[Worker->Tail % TASK_QUEUE_SIZE], Task, sizeof (TASK));
+    Worker->Tail++;
+  }
+
+  ReleaseSpinLock (&Worker->Lock);
+  return Pushed;
+}
+
+/**
+  Pop the newest task of the queue of a worker, or the oldest one when
+  stealing from another worker.
+
+  @param[in, out] Worker  The worker.
+  @param[in]      Steal   TRUE to take the oldest task.
+  @param[out]     Task    The task.
+
+  @retval TRUE   A task is returned.
+  @retval FALSE  The queue is empty.
+**/
+BOOLEAN
+PopTask (
+  IN OUT TASK_WORKER  *Worker,
+  IN     BOOLEAN      Steal,
+  OUT    TASK         *Task
+  )
+{
+  BOOLEAN  Popped;
+
+  //
+  // Do not take the lock of an empty queue, the idle workers check the queues
+  // of the other workers in a loop.
+  //
+  if (Worker->Head == Worker->Tail) {
+    return FALSE;
+  }
+
+  AcquireSpinLock (&Worker->Lock);
+  Popped = (BOOLEAN)(Worker->Head != Worker->Tail);
+  if (Popped) {
+    if (Steal) {
+      CopyMem (Task, &Worker->Tasks[Worker->Head % TASK_QUEUE_SIZE], sizeof (TASK));
+      Worker->Head++;
+    } else {
+      Worker->Tail--;
+      CopyMem (Task, &Worker->Tasks[Worker->Tail % TASK_QUEUE_SIZE], sizeof (TASK));
+    }
+  }
+
+  ReleaseSpinLock (&Worker->Lock);
+  return Popped;
+}
+
+/**
+  Find a task to run, in the queue of the current worker first, then in the
+  queues of the other workers starting from a random one.
+
+  @param[in]  Scheduler    The scheduler.
+  @param[in]  WorkerIndex  The index of the current worker.
+  @param[out] Task         The task.
+
+  @retval TRUE   A task is returned.
+  @retval FALSE  All the queues are empty.
+**/
+BOOLEAN
+FindTask (
+  IN  TASK_SCHEDULER  *Scheduler,
+  IN  UINTN           WorkerIndex,
+  OUT TASK            *Task
+  )
+{
+  TASK_WORKER  *Worker;
+  UINTN        Victim;
+  UINTN        Index;
+
+  Worker = &Scheduler->Workers[WorkerIndex];
+  if (PopTask (Worker, FALSE, Task)) {
+    return TRUE;
+  }
+
+  if (Scheduler->WorkerCount == 1) {
+    return FALSE;
+  }
+
+  //
+  // Xorshift generator of the first worker to steal from.
+  //
+  Worker->Seed ^= Worker->Seed << 13;
+  Worker->Seed ^= Worker->Seed >> 17;
+  Worker->Seed ^= Worker->Seed << 5;
+  Victim        = Worker->Seed % Scheduler->WorkerCount;
+
+  for (Index = 0; Index < Scheduler->WorkerCount; Index++) {
+    if ((Victim != WorkerIndex) && PopTask (&Scheduler->Workers[Victim], TRUE, Task)) {
+      return TRUE;
+    }
+
+    Victim = (Victim + 1) % Scheduler->WorkerCount;
+  }
+
+  return FALSE;
+}
+
+/**
+  Queue a task on the current worker, or run it if the queue is full.
+
+  @param[in] Scheduler  The scheduler.
+  @param[in] Task       The task, whose future is incremented.
+**/
+VOID
+QueueTask (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN TASK            *Task
+  );
+
+/**
+  Run a task and complete it.
+
+  The task of a range runs its first half after queueing the other half,
+  until the part left is not larger than the grain.
+
+  @param[in] Scheduler  The scheduler.
+  @param[in] Task       The task.
+**/
+VOID
+RunTask (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN TASK            *Task
+  )
+{
+  TASK   Half;
+  UINTN  Middle;
+
+  if (Task->RangeProcedure != NULL) {
+    while (Task->End - Task->Start > Task->Grain) {
+      Middle = Task->Start + (Task->End - Task->Start) / 2;
+      CopyMem (&Half, Task, sizeof (TASK));
+      Half.Start = Middle;
+      Task->End  = Middle;
+      QueueTask (Scheduler, &Half);
+    }
+
+    Task->RangeProcedure (Scheduler, Task->Start, Task->End, Task->Context);
+  } else {
+    Task->Procedure (Scheduler, Task->Context);
+  }
+
+  InterlockedDecrement (&Task->Future->Pending);
+  InterlockedDecrement (&Scheduler->Outstanding.Pending);
+}
+
+/**
+  Queue a task on the current worker, or run it if the queue is full.
+
+  @param[in] Scheduler  The scheduler.
+  @param[in] Task       The task, whose future is incremented.
+**/
+VOID
+QueueTask (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN TASK            *Task
+  )
+{
+  InterlockedIncrement (&Task->Future->Pending);
+  InterlockedIncrement (&Scheduler->Outstanding.Pending);
+
+  if (!PushTask (&Scheduler->Workers[TaskGetWorkerIndex (Scheduler)], Task)) {
+    RunTask (Scheduler, Task);
+  }
+}
+
+/**
+  Spawn a task, to be run by the current processor or stolen by another one.
+
+  The task is run immediately if the queue of the current processor is full.
+
+  @param[in]      Scheduler  The scheduler running the current task.
+  @param[in, out] Future     The future completed with the task.
+  @param[in]      Procedure  The procedure of the task.
+  @param[in]      Context    The context of the task.
+**/
+VOID
+EFIAPI
+TaskSpawn (
+  IN     TASK_SCHEDULER  *Scheduler,
+  IN OUT TASK_FUTURE     *Future,
+  IN     TASK_PROCEDURE  Procedure,
+  IN     VOID            *Context OPTIONAL
+  )
+{
+  TASK  Task;
+
+  ASSERT (Future != NULL);
+  ASSERT (Procedure != NULL);
+
+  ZeroMem (&Task, sizeof (Task));
+  Task.Procedure = Procedure;
+  Task.Context   = Context;
+  Task.Future    = Future;
+  QueueTask (Scheduler, &Task);
+}
+
+/**
+  Wait for the completion of the tasks of a future, running the queued tasks
+  and stealing tasks while they are not completed.
+
+  @param[in] Scheduler  The scheduler running the current task.
+  @param[in] Future     The future to wait for.
+**/
+VOID
+EFIAPI
+TaskWait (
+  IN TASK_SCHEDULER  *Scheduler,
+  IN TASK_FUTURE     *Future
+  )
+{
+  UINTN  WorkerIndex;
+  TASK   Task;
+
+  WorkerIndex = TaskGetWorkerIndex (Scheduler);
+  while (Future->Pending != 0) {
+    if (FindTask (Scheduler, WorkerIndex, &Task)) {
+      RunTask (Scheduler, &Task);
+    } else {
+      CpuPause ();
+    }
+  }
+}
+
+/**
+  Run a procedure on all the indexes of a range, split in parts of at most
+  Grain indexes run in parallel, and return when all the parts are completed.
+
+  @param[in] Scheduler  The scheduler running the current task.
+  @param[in] Start      The first index of the range.
+  @param[in] End        The index following the last index of the range.
+  @param[in] Grain      The maximum number of indexes of a part, 0 to split
+                        the range in a few parts per worker.
+  @param[in] Procedure  The procedure run on the parts.
+  @param[in] Context    The context given to the procedure.
+**/
+VOID
+EFIAPI
+TaskParallelFor (
+  IN TASK_SCHEDULER        *Scheduler,
+  IN UINTN                 Start,
+  IN UINTN                 End,
+  IN UINTN                 Grain,
+  IN TASK_RANGE_PROCEDURE  Procedure,
+  IN VOID                  *Context OPTIONAL
+  )
+{
+  TASK_FUTURE  Future;
+  TASK         Task;
+
+  ASSERT (Procedure != NULL);
+
+  if (Start >= End) {
+    return;
+  }
+
+  if (Grain == 0) {
+    Grain = MAX ((End - Start) / (Scheduler->WorkerCount * TASK_PARTS_PER_WORKER), 1);
+  }
+
+  ZeroMem (&Future, sizeof (Future));
+  ZeroMem (&Task, sizeof (Task));
+  Task.RangeProcedure = Procedure;
+  Task.Context        = Context;
+  Task.Future         = &Future;
+  Task.Start          = Start;
+  Task.End            = End;
+  Task.Grain          = Grain;
+
+  InterlockedIncrement (&Future.Pending);
+  InterlockedIncrement (&Scheduler->Outstanding.Pending);
+  RunTask (Scheduler, &Task);
+  TaskWait (Scheduler, &Future);
+}
+
+/**
+  Procedure of the workers, run on all the enabled processors.
+
+  The BSP runs the root task, then the tasks left, and ends the run. The APs
+  run the queued tasks until the end of the run.
+
+  @param[in] Buffer  The scheduler.
+**/
+VOID
+EFIAPI
+TaskWorkerProcedure (
+  IN VOID  *Buffer
+  )
+{
+  TASK_SCHEDULER  *Scheduler;
+  UINTN           WorkerIndex;
+  TASK            Task;
+
+  Scheduler   = (TASK_SCHEDULER *)Buffer;
+  WorkerIndex = TaskGetWorkerIndex (Scheduler);
+
+  if (WorkerIndex == 0) {
+    Scheduler->RootProcedure (Scheduler, Scheduler->RootContext);
+    TaskWait (Scheduler, &Scheduler->Outstanding);
+    Scheduler->Done = TRUE;
+    return;
+  }
+
+  while (!Scheduler->Done) {
+    if (FindTask (Scheduler, WorkerIndex, &Task)) {
+      RunTask (Scheduler, &Task);
+    } else {
+      CpuPause ();
+    }
+  }
+}
+
+/**
+  Build the table of the worker indexes of the APIC IDs of the enabled
+  processors, the BSP being the worker 0.
+
+  @param[in, out] Scheduler  The scheduler, whose MP services are set.
+
+  @retval EFI_SUCCESS           The workers are set.
+  @retval EFI_OUT_OF_RESOURCES  The table cannot be allocated.
+  @retval Others                The MP services failed.
+**/
+EFI_STATUS
+InitializeWorkerIndexes (
+  IN OUT TASK_SCHEDULER  *Scheduler
+  )
+{
+  EFI_STATUS                 Status;
+  EFI_PROCESSOR_INFORMATION  ProcessorInfo;
+  UINTN                      ProcessorCount;
+  UINTN                      EnabledCount;
+  UINTN                      Index;
+  UINT32                     NextWorker;
+
+  Status = TaskSchedulerGetNumberOfProcessors (Scheduler->MpServices, &ProcessorCount, &EnabledCount);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Scheduler->MaxApicId = 0;
+  for (Index = 0; Index < ProcessorCount; Index++) {
+    Status = TaskSchedulerGetProcessorInfo (Scheduler->MpServices, Index, &ProcessorInfo);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Scheduler->MaxApicId = MAX (Scheduler->MaxApicId, (UINT32)ProcessorInfo.ProcessorId);
+  }
+
+  Scheduler->WorkerIndex = AllocatePool (((UINTN)Scheduler->MaxApicId + 1) * sizeof (UINT32));
+  if (Scheduler->WorkerIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  SetMem32 (Scheduler->WorkerIndex, ((UINTN)Scheduler->MaxApicId + 1) * sizeof (UINT32), MAX_UINT32);
+
+  NextWorker = 1;
+  for (Index = 0; Index < ProcessorCount; Index++) {
+    Status = TaskSchedulerGetProcessorInfo (Scheduler->MpServices, Index, &ProcessorInfo);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if ((ProcessorInfo.StatusFlag & PROCESSOR_AS_BSP_BIT) != 0) {
+      Scheduler->WorkerIndex[ProcessorInfo.ProcessorId] = 0;
+    } else if ((ProcessorInfo.StatusFlag & PROCESSOR_ENABLED_BIT) != 0) {
+      Scheduler->WorkerIndex[ProcessorInfo.ProcessorId] = NextWorker++;
+    }
+  }
+
+  Scheduler->WorkerCount = NextWorker;
+  ASSERT (Scheduler->WorkerCount == EnabledCount);
+  return EFI_SUCCESS;
+}
+
+/**
+  Run a root task on the BSP with all the enabled processors as workers, and
+  return when the root task and all the tasks it spawned are completed.
+
+  The function must be called on the BSP, while the APs are idle. The tasks
+  run on a single processor if the MP services are not available, or in DXE
+  if the caller is at TPL_NOTIFY or above.
+
+  @param[in] Procedure  The procedure of the root task.
+  @param[in] Context    The context of the root task.
+
+  @retval EFI_SUCCESS            All the tasks are completed.
+  @retval EFI_INVALID_PARAMETER  Procedure is NULL.
+  @retval EFI_OUT_OF_RESOURCES   The scheduler cannot be allocated.
+  @retval EFI_NOT_READY          The APs are busy.
+**/
+EFI_STATUS
+EFIAPI
+TaskSchedulerRun (
+  IN TASK_PROCEDURE  Procedure,
+  IN VOID            *Context OPTIONAL
+  )
+{
+  EFI_STATUS      Status;
+  TASK_SCHEDULER  *Scheduler;
+  UINTN           Index;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Scheduler = AllocateZeroPool (sizeof (TASK_SCHEDULER));
+  if (Scheduler == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Scheduler->RootProcedure = Procedure;
+  Scheduler->RootContext   = Context;
+  Scheduler->WorkerCount   = 1;
+
+  Status = TaskSchedulerGetMpServices (&Scheduler->MpServices);
+  if (!EFI_ERROR (Status)) {
+    Status = InitializeWorkerIndexes (Scheduler);
+    if (Status == EFI_OUT_OF_RESOURCES) {
+      goto Done;
+    }
+
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_WARN, "%a: Running on the BSP only - %r\n", __func__, Status));
+      Scheduler->WorkerCount = 1;
+    }
+  }
+
+  Scheduler->Workers = AllocateZeroPool (Scheduler->WorkerCount * sizeof (TASK_WORKER));
+  if (Scheduler->Workers == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Done;
+  }
+
+  for (Index = 0; Index < Scheduler->WorkerCount; Index++) {
+    InitializeSpinLock (&Scheduler->Workers[Index].Lock);
+    Scheduler->Workers[Index].Seed = (UINT32)(Index + 1) * 0x9E3779B9;
+  }
+
+  if (Scheduler->WorkerCount == 1) {
+    TaskWorkerProcedure (Scheduler);
+    Status = EFI_SUCCESS;
+  } else {
+    Status = TaskSchedulerStartupAllCPUs (Scheduler->MpServices, TaskWorkerProcedure, Scheduler);
+  }
+
+Done:
+  if (Scheduler->Workers != NULL) {
+    FreePool (Scheduler->Workers);
+  }
+
+  if (Scheduler->WorkerIndex != NULL) {
+    FreePool (Scheduler->WorkerIndex);
+  }
+
+  FreePool (Scheduler);
+  return Status;
+}
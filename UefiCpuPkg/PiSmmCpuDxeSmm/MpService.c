@@ -505,6 +505,10 @@ BSPHandler (
   // If Traditional Sync Mode or need to configure MTRRs: gather all available APs.
   //
   if ((SyncMode == SmmCpuSyncModeTradition) || SmmCpuFeaturesNeedConfigureMtrrs ()) {
+    PERF_CODE (
+      MpPerfBegin (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmGatherAps));
+      );
+
     //
     // Wait for APs to arrive
     //
@@ -524,6 +528,10 @@ BSPHandler (
     //
     SmmCpuSyncWaitForAPs (mSmmMpSyncData->SyncContext, ApCount, CpuIndex);
 
+    PERF_CODE (
+      MpPerfEnd (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmGatherAps));
+      );
+
     if (SmmCpuFeaturesNeedConfigureMtrrs ()) {
       //
       // Signal all APs it's time for backup MTRRs
@@ -595,6 +603,10 @@ BSPHandler (
   // will run through freely.
   //
   if ((SyncMode != SmmCpuSyncModeTradition) && !SmmCpuFeaturesNeedConfigureMtrrs ()) {
+    PERF_CODE (
+      MpPerfBegin (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmGatherAps));
+      );
+
     //
     // Lock door for late coming CPU checkin and retrieve the Arrived number of APs
     //
@@ -619,6 +631,10 @@ BSPHandler (
         break;
       }
     }
+
+    PERF_CODE (
+      MpPerfEnd (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmGatherAps));
+      );
   }
 
   //
@@ -679,7 +695,13 @@ BSPHandler (
   // Gather APs to exit SMM synchronously. Note the Present flag is cleared by now but
   // WaitForAllAps does not depend on the Present flag.
   //
+  PERF_CODE (
+    MpPerfBegin (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmReleaseAps));
+    );
   SmmCpuSyncWaitForAPs (mSmmMpSyncData->SyncContext, ApCount, CpuIndex);
+  PERF_CODE (
+    MpPerfEnd (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmReleaseAps));
+    );
 
   //
   // At this point, all APs should have exited from APHandler().
@@ -735,6 +757,9 @@ APHandler (
   //
   // Timeout BSP
   //
+  PERF_CODE (
+    MpPerfBegin (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmWaitForBsp));
+    );
   for (Timer = StartSyncTimer ();
        !IsSyncTimerTimeout (Timer, mTimeoutTicker) &&
        !(*mSmmMpSyncData->InsideSmm);
@@ -743,6 +768,10 @@ APHandler (
     CpuPause ();
   }
 
+  PERF_CODE (
+    MpPerfEnd (CpuIndex, SMM_MP_PERF_PROCEDURE_ID (SmmWaitForBsp));
+    );
+
   if (!(*mSmmMpSyncData->InsideSmm)) {
     //
     // BSP timeout in the first round
@@ -0,0 +1,278 @@
+/** @file
+  Print the samples of the profiler as folded stacks.
+
+  The samples are mapped to the images listed in the EFI_DEBUG_IMAGE_INFO_TABLE
+  and printed on the debug output, one line per distinct call chain:
+
+    PROF: image <Name> <ImageBase> <ImageSize>
+    PROF: <Image>+<Offset>;<Image>+<Offset>;... <Count>
+
+  The call chains go from the outermost frame to the interrupted address, so
+  that the lines stripped of their "PROF: " prefix are the folded stacks read
+  by flamegraph.pl and speedscope. The image lines allow the offsets to be
+  resolved with the symbols of the build.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SamplingProfiler.h"
+
+//
+// Maximum length of a folded stack line.
+//
+#define FOLDED_STACK_LENGTH  240
+
+//
+// Number of addresses of a sample, used by the compare function of the sort.
+//
+UINT32  mCompareDepth;
+
+/**
+  Compare two samples by their addresses.
+
+  @param  Buffer1  The first sample.
+  @param  Buffer2  The second sample.
+
+  @retval <0  The first sample is lower.
+  @retval 0   The samples are equal.
+  @retval >0  The first sample is greater.
+
+**/
+INTN
+EFIAPI
+CompareSamples (
+  IN CONST VOID  *Buffer1,
+  IN CONST VOID  *Buffer2
+  )
+{
+  CONST UINTN  *Sample1;
+  CONST UINTN  *Sample2;
+  UINT32       Index;
+
+  Sample1 = Buffer1;
+  Sample2 = Buffer2;
+  for (Index = 0; Index < mCompareDepth; Index++) {
+    if (Sample1[Index] != Sample2[Index]) {
+      return (Sample1[Index] < Sample2[Index]) ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+  Set the name of an image from the path of its debug information, keeping the
+  file name without its extension.
+
+  @param  Image  The image, whose ImageBase is set.
+
+**/
+VOID
+SetImageName (
+  IN OUT SAMPLING_PROFILER_IMAGE  *Image
+  )
+{
+  CHAR8  *PdbPath;
+  CHAR8  *Start;
+  CHAR8  *End;
+  UINTN  Length;
+
+  PdbPath = PeCoffLoaderGetPdbPointer ((VOID *)Image->ImageBase);
+  if (PdbPath == NULL) {
+    AsciiSPrint (Image->Name, sizeof (Image->Name), "%lx", (UINT64)Image->ImageBase);
+    return;
+  }
+
+  Start = PdbPath;
+  End   = NULL;
+  for ( ; *PdbPath != '\0'; PdbPath++) {
+    if ((*PdbPath == '\\') || (*PdbPath == '/')) {
+      Start = PdbPath + 1;
+      End   = NULL;
+    } else if (*PdbPath == '.') {
+      End = PdbPath;
+    }
+  }
+
+  if (End == NULL) {
+    End = PdbPath;
+  }
+
+  Length = MIN ((UINTN)(End - Start), SAMPLING_PROFILER_NAME_LENGTH);
+  CopyMem (Image->Name, Start, Length);
+  Image->Name[Length] = '\0';
+}
+
+/**
+  Build the list of the loaded images from the EFI_DEBUG_IMAGE_INFO_TABLE.
+
+  @param  ImageCount  Return the number of images.
+
+  @return The images, NULL if the table is not found.
+
+**/
+SAMPLING_PROFILER_IMAGE *
+GetImages (
+  OUT UINTN  *ImageCount
+  )
+{
+  EFI_STATUS                         Status;
+  EFI_DEBUG_IMAGE_INFO_TABLE_HEADER  *Header;
+  EFI_DEBUG_IMAGE_INFO_NORMAL        *NormalImage;
+  EFI_LOADED_IMAGE_PROTOCOL          *LoadedImage;
+  SAMPLING_PROFILER_IMAGE            *Images;
+  UINTN                              Index;
+
+  *ImageCount = 0;
+
+  Status = EfiGetSystemConfigurationTable (&gEfiDebugImageInfoTableGuid, (VOID **)&Header);
+  if (EFI_ERROR (Status) || (Header->EfiDebugImageInfoTable == NULL)) {
+    return NULL;
+  }
+
+  Images = AllocateZeroPool (Header->TableSize * sizeof (SAMPLING_PROFILER_IMAGE));
+  if (Images == NULL) {
+    return NULL;
+  }
+
+  for (Index = 0; Index < Header->TableSize; Index++) {
+    NormalImage = Header->EfiDebugImageInfoTable[Index].NormalImage;
+    if ((NormalImage == NULL) || (NormalImage->ImageInfoType != EFI_DEBUG_IMAGE_INFO_TYPE_NORMAL)) {
+      continue;
+    }
+
+    LoadedImage = NormalImage->LoadedImageProtocolInstance;
+    if ((LoadedImage == NULL) || (LoadedImage->ImageBase == NULL)) {
+      continue;
+    }
+
+    Images[*ImageCount].ImageBase = (UINTN)LoadedImage->ImageBase;
+    Images[*ImageCount].ImageSize = (UINTN)LoadedImage->ImageSize;
+    SetImageName (&Images[*ImageCount]);
+    (*ImageCount)++;
+  }
+
+  return Images;
+}
+
+/**
+  Append a frame to a folded stack line.
+
+  @param  Line        The line.
+  @param  Length      The length of the line, updated.
+  @param  Address     The address of the frame.
+  @param  Images      The loaded images.
+  @param  ImageCount  The number of images.
+
+**/
+VOID
+AppendFrame (
+  IN OUT CHAR8                    *Line,
+  IN OUT UINTN                    *Length,
+  IN     UINTN                    Address,
+  IN     SAMPLING_PROFILER_IMAGE  *Images,
+  IN     UINTN                    ImageCount
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < ImageCount; Index++) {
+    if ((Address >= Images[Index].ImageBase) && (Address - Images[Index].ImageBase < Images[Index].ImageSize)) {
+      break;
+    }
+  }
+
+  if (Index < ImageCount) {
+    *Length += AsciiSPrint (
+                 Line + *Length,
+                 FOLDED_STACK_LENGTH - *Length,
+                 "%a%a+0x%lx",
+                 (*Length == 0) ? "" : ";",
+                 Images[Index].Name,
+                 (UINT64)(Address - Images[Index].ImageBase)
+                 );
+  } else {
+    *Length += AsciiSPrint (
+                 Line + *Length,
+                 FOLDED_STACK_LENGTH - *Length,
+                 "%a0x%lx",
+                 (*Length == 0) ? "" : ";",
+                 (UINT64)Address
+                 );
+  }
+}
+
+/**
+  Print the samples as folded stacks on the debug output.
+
+  @param  Samples      The samples, each one holding Depth addresses.
+  @param  SampleCount  The number of samples.
+  @param  Depth        The number of addresses of a sample.
+
+**/
+VOID
+SamplingProfilerDump (
+  IN UINTN   *Samples,
+  IN UINT32  SampleCount,
+  IN UINT32  Depth
+  )
+{
+  SAMPLING_PROFILER_IMAGE  *Images;
+  UINTN                    ImageCount;
+  UINTN                    *Sample;
+  UINTN                    *Temp;
+  CHAR8                    Line[FOLDED_STACK_LENGTH];
+  UINTN                    Length;
+  UINT32                   Index;
+  UINT32                   Count;
+  UINT32                   Frame;
+
+  Images = GetImages (&ImageCount);
+  for (Index = 0; Index < ImageCount; Index++) {
+    DEBUG ((
+      DEBUG_INFO,
+      "PROF: image %a 0x%lx 0x%lx\n",
+      Images[Index].Name,
+      (UINT64)Images[Index].ImageBase,
+      (UINT64)Images[Index].ImageSize
+      ));
+  }
+
+  Temp = AllocatePool (Depth * sizeof (UINTN));
+  if (Temp == NULL) {
+    goto Done;
+  }
+
+  //
+  // Sort the samples so that the identical call chains are adjacent.
+  //
+  mCompareDepth = Depth;
+  QuickSort (Samples, SampleCount, Depth * sizeof (UINTN), CompareSamples, Temp);
+  FreePool (Temp);
+
+  for (Index = 0; Index < SampleCount; Index += Count) {
+    Sample = &Samples[Index * Depth];
+    for (Count = 1; Index + Count < SampleCount; Count++) {
+      if (CompareSamples (Sample, &Samples[(Index + Count) * Depth]) != 0) {
+        break;
+      }
+    }
+
+    Line[0] = '\0';
+    Length  = 0;
+    for (Frame = Depth; Frame > 0; Frame--) {
+      if (Sample[Frame - 1] != 0) {
+        AppendFrame (Line, &Length, Sample[Frame - 1], Images, ImageCount);
+      }
+    }
+
+    DEBUG ((DEBUG_INFO, "PROF: %a %d\n", Line, Count));
+  }
+
+Done:
+  if (Images != NULL) {
+    FreePool (Images);
+  }
+}
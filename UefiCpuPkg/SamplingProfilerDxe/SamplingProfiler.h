@@ -0,0 +1,134 @@
+/** @file
+  Internal definitions of the DXE sampling profiler.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SAMPLING_PROFILER_H_
+#define SAMPLING_PROFILER_H_
+
+#include <PiDxe.h>
+
+#include <Protocol/Cpu.h>
+#include <Protocol/LoadedImage.h>
+#include <Guid/DebugImageInfoTable.h>
+#include <Guid/EventGroup.h>
+#include <Register/Intel/ArchitecturalMsr.h>
+#include <Register/Intel/Cpuid.h>
+#include <Register/Intel/LocalApic.h>
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IoLib.h>
+#include <Library/LocalApicLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/PeCoffGetEntryPointLib.h>
+#include <Library/PrintLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+//
+// Vector of the sampling interrupt. It is above the vectors of the 8259 and
+// of the local APIC timer driver of OVMF.
+//
+#define SAMPLING_PROFILER_VECTOR  0xE8
+
+//
+// The performance monitor counter entry of the local APIC LVT.
+//
+#define XAPIC_LVT_PERFORMANCE_MONITOR_OFFSET  0x340
+
+//
+// Architectural event counting the unhalted core cycles, and the flags of
+// IA32_PERFEVTSELx enabling the counter in all rings with an interrupt on
+// overflow.
+//
+#define PMU_EVENT_UNHALTED_CORE_CYCLES  0x3C
+#define PMU_EVENTSEL_USR                BIT16
+#define PMU_EVENTSEL_OS                 BIT17
+#define PMU_EVENTSEL_INT                BIT20
+#define PMU_EVENTSEL_EN                 BIT22
+
+//
+// Size of the stack searched for the frames of an interrupted call chain.
+//
+#define SAMPLING_PROFILER_STACK_WINDOW  SIZE_32KB
+
+//
+// Maximum length of the image names printed in the profile, which keeps the
+// folded stacks within the length of a debug message.
+//
+#define SAMPLING_PROFILER_NAME_LENGTH  16
+
+typedef enum {
+  SamplingSourceNone,
+  SamplingSourceApicTimer,
+  SamplingSourcePmu
+} SAMPLING_SOURCE;
+
+typedef struct {
+  UINTN    ImageBase;
+  UINTN    ImageSize;
+  CHAR8    Name[SAMPLING_PROFILER_NAME_LENGTH + 1];
+} SAMPLING_PROFILER_IMAGE;
+
+/**
+  Start the sampling interrupt.
+
+  The local APIC timer is used if it is not used by the timer driver of the
+  platform, the performance monitor counter 0 otherwise.
+
+  @param  Frequency  Number of samples per second.
+
+  @return The source of the sampling interrupt, SamplingSourceNone if none is
+          available.
+
+**/
+SAMPLING_SOURCE
+SamplingStart (
+  IN UINT32  Frequency
+  );
+
+/**
+  Stop the sampling interrupt.
+
+  @param  Source  The source returned by SamplingStart().
+
+**/
+VOID
+SamplingStop (
+  IN SAMPLING_SOURCE  Source
+  );
+
+/**
+  Re-arm the sampling interrupt from its handler, before the EOI.
+
+  @param  Source  The source returned by SamplingStart().
+
+**/
+VOID
+SamplingRearm (
+  IN SAMPLING_SOURCE  Source
+  );
+
+/**
+  Print the samples as folded stacks on the debug output.
+
+  @param  Samples      The samples, each one holding Depth addresses.
+  @param  SampleCount  The number of samples.
+  @param  Depth        The number of addresses of a sample.
+
+**/
+VOID
+SamplingProfilerDump (
+  IN UINTN   *Samples,
+  IN UINT32  SampleCount,
+  IN UINT32  Depth
+  );
+
+#endif
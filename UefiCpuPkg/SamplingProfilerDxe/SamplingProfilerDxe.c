@@ -0,0 +1,246 @@
+/** @file
+  Sampling profiler of the DXE phase.
+
+  The driver samples the address interrupted on the BSP at a fixed frequency,
+  from the local APIC timer or from the overflows of a performance monitor
+  counter, together with the return addresses found by walking the frame
+  pointers. The samples are printed as folded stacks at ReadyToBoot, see
+  SamplingDump.c.
+
+  The call chains are only complete for the code built with frame pointers,
+  and the code running with the interrupts disabled is not sampled. The
+  driver is a debug tool, it should not be included in production builds.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SamplingProfiler.h"
+
+EFI_CPU_ARCH_PROTOCOL  *mCpu;
+SAMPLING_SOURCE        mSource;
+UINTN                  *mSamples;
+UINT32                 mSampleDepth;
+UINT32                 mMaxSamples;
+volatile UINT32        mSampleCount;
+volatile UINT32        mDroppedSamples;
+
+/**
+  Record a sample from the context of the interrupted code.
+
+  The frame pointer chain is followed while the frames are aligned, grow
+  towards the base of the stack and stay within SAMPLING_PROFILER_STACK_WINDOW
+  bytes from the interrupted stack pointer, so that a corrupted or missing
+  frame pointer is never dereferenced outside the stack.
+
+  @param  SystemContext  The context of the interrupted code.
+
+**/
+VOID
+RecordSample (
+  IN EFI_SYSTEM_CONTEXT  SystemContext
+  )
+{
+  UINTN   *Sample;
+  UINTN   Pc;
+  UINTN   StackPointer;
+  UINTN   FramePointer;
+  UINTN   *Frame;
+  UINT32  Index;
+
+  if (mSampleCount >= mMaxSamples) {
+    mDroppedSamples++;
+    return;
+  }
+
+ #if defined (MDE_CPU_X64)
+  Pc           = (UINTN)SystemContext.SystemContextX64->Rip;
+  StackPointer = (UINTN)SystemContext.SystemContextX64->Rsp;
+  FramePointer = (UINTN)SystemContext.SystemContextX64->Rbp;
+ #else
+  Pc           = (UINTN)SystemContext.SystemContextIa32->Eip;
+  StackPointer = (UINTN)SystemContext.SystemContextIa32->Esp;
+  FramePointer = (UINTN)SystemContext.SystemContextIa32->Ebp;
+ #endif
+
+  Sample = &mSamples[mSampleCount * mSampleDepth];
+  ZeroMem (Sample, mSampleDepth * sizeof (UINTN));
+  Sample[0] = Pc;
+
+  for (Index = 1; Index < mSampleDepth; Index++) {
+    if ((FramePointer < StackPointer) ||
+        (FramePointer - StackPointer > SAMPLING_PROFILER_STACK_WINDOW - 2 * sizeof (UINTN)) ||
+        ((FramePointer & (sizeof (UINTN) - 1)) != 0))
+    {
+      break;
+    }
+
+    Frame = (UINTN *)FramePointer;
+    if (Frame[1] == 0) {
+      break;
+    }
+
+    Sample[Index] = Frame[1];
+    StackPointer  = FramePointer + 2 * sizeof (UINTN);
+    FramePointer  = Frame[0];
+  }
+
+  mSampleCount++;
+}
+
+/**
+  Handler of the sampling interrupt.
+
+  @param  InterruptType  The vector of the sampling interrupt.
+  @param  SystemContext  The context of the interrupted code.
+
+**/
+VOID
+EFIAPI
+SamplingInterruptHandler (
+  IN EFI_EXCEPTION_TYPE  InterruptType,
+  IN EFI_SYSTEM_CONTEXT  SystemContext
+  )
+{
+  RecordSample (SystemContext);
+  SamplingRearm (mSource);
+  SendApicEoi ();
+}
+
+/**
+  Stop sampling and release the interrupt vector.
+
+**/
+VOID
+StopProfiler (
+  VOID
+  )
+{
+  if (mSource == SamplingSourceNone) {
+    return;
+  }
+
+  SamplingStop (mSource);
+  mSource = SamplingSourceNone;
+  mCpu->RegisterInterruptHandler (mCpu, SAMPLING_PROFILER_VECTOR, NULL);
+}
+
+/**
+  Stop sampling at ReadyToBoot and print the profile.
+
+  @param  Event    The ReadyToBoot event.
+  @param  Context  Not used.
+
+**/
+VOID
+EFIAPI
+OnReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  gBS->CloseEvent (Event);
+
+  StopProfiler ();
+
+  DEBUG ((
+    DEBUG_INFO,
+    "PROF: %d samples at %d Hz, %d dropped\n",
+    mSampleCount,
+    PcdGet32 (PcdSamplingProfilerFrequency),
+    mDroppedSamples
+    ));
+  SamplingProfilerDump (mSamples, mSampleCount, mSampleDepth);
+}
+
+/**
+  Stop sampling at ExitBootServices, if ReadyToBoot was not signaled.
+
+  @param  Event    The ExitBootServices event.
+  @param  Context  Not used.
+
+**/
+VOID
+EFIAPI
+OnExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  StopProfiler ();
+}
+
+/**
+  Entry point of the sampling profiler.
+
+  @param  ImageHandle  The firmware allocated handle for the EFI image.
+  @param  SystemTable  A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS           Sampling is started.
+  @retval EFI_UNSUPPORTED       No source of sampling interrupt is available.
+  @retval EFI_OUT_OF_RESOURCES  The samples cannot be allocated.
+  @retval Others                The interrupt handler cannot be registered.
+
+**/
+EFI_STATUS
+EFIAPI
+SamplingProfilerEntryPoint (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   Event;
+  UINT32      Frequency;
+
+  Frequency    = PcdGet32 (PcdSamplingProfilerFrequency);
+  mMaxSamples  = PcdGet32 (PcdSamplingProfilerMaxSamples);
+  mSampleDepth = MAX (PcdGet32 (PcdSamplingProfilerStackDepth), 1);
+  if ((Frequency == 0) || (mMaxSamples == 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = gBS->LocateProtocol (&gEfiCpuArchProtocolGuid, NULL, (VOID **)&mCpu);
+  ASSERT_EFI_ERROR (Status);
+
+  mSamples = AllocateZeroPool (mMaxSamples * mSampleDepth * sizeof (UINTN));
+  if (mSamples == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Status = mCpu->RegisterInterruptHandler (mCpu, SAMPLING_PROFILER_VECTOR, SamplingInterruptHandler);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "SamplingProfiler: Vector 0x%x is in use - %r\n", SAMPLING_PROFILER_VECTOR, Status));
+    FreePool (mSamples);
+    return Status;
+  }
+
+  mSource = SamplingStart (Frequency);
+  if (mSource == SamplingSourceNone) {
+    DEBUG ((DEBUG_ERROR, "SamplingProfiler: The local APIC timer is in use and no PMU is available\n"));
+    mCpu->RegisterInterruptHandler (mCpu, SAMPLING_PROFILER_VECTOR, NULL);
+    FreePool (mSamples);
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = EfiCreateEventReadyToBootEx (TPL_CALLBACK, OnReadyToBoot, NULL, &Event);
+  ASSERT_EFI_ERROR (Status);
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  OnExitBootServices,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &Event
+                  );
+  ASSERT_EFI_ERROR (Status);
+
+  DEBUG ((
+    DEBUG_INFO,
+    "SamplingProfiler: Sampling at %d Hz with the %a\n",
+    Frequency,
+    (mSource == SamplingSourceApicTimer) ? "local APIC timer" : "performance monitor counter"
+    ));
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,215 @@
+/** @file
+  Sources of the sampling interrupt: the local APIC timer in periodic mode, or
+  the performance monitor counter 0 counting the unhalted core cycles.
+
+  Copyright (c) 2024, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SamplingProfiler.h"
+
+//
+// Number of core cycles between two samples, when sampling with the PMU.
+//
+UINT64  mPmuPeriod;
+
+//
+// Version of the architectural performance monitoring.
+//
+UINT8  mPmuVersion;
+
+/**
+  Write the performance monitor counter entry of the local APIC LVT.
+
+  @param  Value  The value of the entry.
+
+**/
+VOID
+WriteLvtPerformanceMonitor (
+  IN UINT32  Value
+  )
+{
+  if (GetApicMode () == LOCAL_APIC_MODE_XAPIC) {
+    MmioWrite32 (GetLocalApicBaseAddress () + XAPIC_LVT_PERFORMANCE_MONITOR_OFFSET, Value);
+  } else {
+    AsmWriteMsr32 (X2APIC_MSR_BASE_ADDRESS + (XAPIC_LVT_PERFORMANCE_MONITOR_OFFSET >> 4), Value);
+  }
+}
+
+/**
+  Check if the local APIC timer is free.
+
+  @retval TRUE   The local APIC timer is not used by the platform.
+  @retval FALSE  The local APIC timer is running with its interrupt enabled.
+
+**/
+BOOLEAN
+IsApicTimerFree (
+  VOID
+  )
+{
+  return (BOOLEAN)(!GetApicTimerInterruptState () || (GetApicTimerInitCount () == 0));
+}
+
+/**
+  Check if the performance monitor counter 0 can count the unhalted core
+  cycles.
+
+  @retval TRUE   The counter is available.
+  @retval FALSE  The processor does not support it.
+
+**/
+BOOLEAN
+IsPmuAvailable (
+  VOID
+  )
+{
+  UINT32                                          MaxLeaf;
+  CPUID_ARCHITECTURAL_PERFORMANCE_MONITORING_EAX  Eax;
+  CPUID_ARCHITECTURAL_PERFORMANCE_MONITORING_EBX  Ebx;
+
+  AsmCpuid (CPUID_SIGNATURE, &MaxLeaf, NULL, NULL, NULL);
+  if (MaxLeaf < CPUID_ARCHITECTURAL_PERFORMANCE_MONITORING) {
+    return FALSE;
+  }
+
+  AsmCpuid (CPUID_ARCHITECTURAL_PERFORMANCE_MONITORING, &Eax.Uint32, &Ebx.Uint32, NULL, NULL);
+  if ((Eax.Bits.ArchPerfMonVerID == 0) || (Eax.Bits.PerformanceMonitorCounters == 0)) {
+    return FALSE;
+  }
+
+  //
+  // A set bit of EBX means that the event is not available.
+  //
+  if ((Eax.Bits.EbxBitVectorLength == 0) || (Ebx.Bits.UnhaltedCoreCycles != 0)) {
+    return FALSE;
+  }
+
+  mPmuVersion = (UINT8)Eax.Bits.ArchPerfMonVerID;
+  return TRUE;
+}
+
+/**
+  Load the performance monitor counter 0 so that it overflows after
+  mPmuPeriod cycles. The writes to IA32_PMC0 are sign extended from bit 31.
+
+**/
+VOID
+PmuLoadCounter (
+  VOID
+  )
+{
+  AsmWriteMsr64 (MSR_IA32_PMC0, (UINT64)(-(INT64)mPmuPeriod) & MAX_UINT32);
+}
+
+/**
+  Start the sampling interrupt.
+
+  The local APIC timer is used if it is not used by the timer driver of the
+  platform, the performance monitor counter 0 otherwise.
+
+  @param  Frequency  Number of samples per second.
+
+  @return The source of the sampling interrupt, SamplingSourceNone if none is
+          available.
+
+**/
+SAMPLING_SOURCE
+SamplingStart (
+  IN UINT32  Frequency
+  )
+{
+  UINT64  Start;
+  UINT64  CyclesPerMs;
+
+  if (IsApicTimerFree ()) {
+    InitializeApicTimer (1, PcdGet32 (PcdFSBClock) / Frequency, TRUE, SAMPLING_PROFILER_VECTOR);
+    return SamplingSourceApicTimer;
+  }
+
+  if (!IsPmuAvailable ()) {
+    return SamplingSourceNone;
+  }
+
+  //
+  // The unhalted core cycles count at the frequency of the time stamp counter
+  // when the processor runs at its nominal frequency.
+  //
+  Start = AsmReadTsc ();
+  MicroSecondDelay (1000);
+  CyclesPerMs = AsmReadTsc () - Start;
+  mPmuPeriod  = MIN (DivU64x32 (MultU64x32 (CyclesPerMs, 1000), Frequency), MAX_INT32);
+
+  AsmWriteMsr64 (MSR_IA32_PERFEVTSEL0, 0);
+  PmuLoadCounter ();
+  WriteLvtPerformanceMonitor (SAMPLING_PROFILER_VECTOR);
+  AsmWriteMsr64 (
+    MSR_IA32_PERFEVTSEL0,
+    PMU_EVENT_UNHALTED_CORE_CYCLES | PMU_EVENTSEL_USR | PMU_EVENTSEL_OS | PMU_EVENTSEL_INT | PMU_EVENTSEL_EN
+    );
+  if (mPmuVersion >= 2) {
+    AsmMsrOr64 (MSR_IA32_PERF_GLOBAL_CTRL, BIT0);
+  }
+
+  return SamplingSourcePmu;
+}
+
+/**
+  Stop the sampling interrupt.
+
+  @param  Source  The source returned by SamplingStart().
+
+**/
+VOID
+SamplingStop (
+  IN SAMPLING_SOURCE  Source
+  )
+{
+  switch (Source) {
+    case SamplingSourceApicTimer:
+      InitializeApicTimer (0, 0, FALSE, SAMPLING_PROFILER_VECTOR);
+      DisableApicTimerInterrupt ();
+      break;
+
+    case SamplingSourcePmu:
+      AsmWriteMsr64 (MSR_IA32_PERFEVTSEL0, 0);
+      if (mPmuVersion >= 2) {
+        AsmMsrAnd64 (MSR_IA32_PERF_GLOBAL_CTRL, ~(UINT64)BIT0);
+        AsmWriteMsr64 (MSR_IA32_PERF_GLOBAL_OVF_CTRL, BIT0);
+      }
+
+      WriteLvtPerformanceMonitor (BIT16 | SAMPLING_PROFILER_VECTOR);
+      break;
+
+    default:
+      break;
+  }
+}
+
+/**
+  Re-arm the sampling interrupt from its handler, before the EOI.
+
+  The periodic local APIC timer needs nothing. The performance monitor counter
+  is reloaded, its overflow status cleared, and the LVT entry, which the
+  processor masks when delivering the interrupt, is unmasked.
+
+  @param  Source  The source returned by SamplingStart().
+
+**/
+VOID
+SamplingRearm (
+  IN SAMPLING_SOURCE  Source
+  )
+{
+  if (Source != SamplingSourcePmu) {
+    return;
+  }
+
+  PmuLoadCounter ();
+  if (mPmuVersion >= 2) {
+    AsmWriteMsr64 (MSR_IA32_PERF_GLOBAL_OVF_CTRL, BIT0);
+  }
+
+  WriteLvtPerformanceMonitor (SAMPLING_PROFILER_VECTOR);
+}